@@ -45,6 +45,8 @@ struct ac_thread_trace_data {
    uint32_t buffer_size;
    int start_frame;
    char *trigger_file;
+   /* Trace every frame and only save those that took longer than this. */
+   int hitch_threshold_ms;
 
    struct rgp_code_object rgp_code_object;
    struct rgp_loader_events rgp_loader_events;
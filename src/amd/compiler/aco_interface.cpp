@@ -24,11 +24,13 @@
 #include "aco_interface.h"
 #include "aco_ir.h"
 #include "util/memstream.h"
+#include "util/os_time.h"
 #include "vulkan/radv_shader.h"
 #include "vulkan/radv_shader_args.h"
 
 #include <array>
 #include <iostream>
+#include <mutex>
 
 static const std::array<aco_compiler_statistic_info, aco::num_statistics> statistic_infos = []()
 {
@@ -43,6 +45,14 @@ static const std::array<aco_compiler_statistic_info, aco::num_statistics> statis
    ret[aco::statistic_smem_clauses] = aco_compiler_statistic_info{"SMEM Clause", "Number of SMEM clauses (includes 1-sized clauses)"};
    ret[aco::statistic_sgpr_presched] = aco_compiler_statistic_info{"Pre-Sched SGPRs", "SGPR usage before scheduling"};
    ret[aco::statistic_vgpr_presched] = aco_compiler_statistic_info{"Pre-Sched VGPRs", "VGPR usage before scheduling"};
+   ret[aco::statistic_time_isel] = aco_compiler_statistic_info{"ISel Time", "Instruction selection time in microseconds"};
+   ret[aco::statistic_time_opt] = aco_compiler_statistic_info{"Opt Time", "Phi lowering, optimization and exec mask handling time in microseconds"};
+   ret[aco::statistic_time_spill] = aco_compiler_statistic_info{"Spill Time", "Live variable analysis and spilling time in microseconds"};
+   ret[aco::statistic_time_sched] = aco_compiler_statistic_info{"Sched Time", "Scheduling time in microseconds"};
+   ret[aco::statistic_time_ra] = aco_compiler_statistic_info{"RA Time", "Register allocation and SSA elimination time in microseconds"};
+   ret[aco::statistic_time_lower] = aco_compiler_statistic_info{"Lowering Time", "Lowering to hardware instructions, waitcnt and NOP insertion time in microseconds"};
+   ret[aco::statistic_time_asm] = aco_compiler_statistic_info{"Assembly Time", "Assembly time in microseconds"};
+   ret[aco::statistic_ir_memory] = aco_compiler_statistic_info{"IR Memory", "Memory allocated for instructions in KiB"};
    return ret;
 }();
 
@@ -58,6 +68,27 @@ static void validate(aco::Program *program)
    assert(is_valid);
 }
 
+/* One CSV line per shader, so that slow shaders are easy to find. */
+static void print_compile_time(aco::Program *program, gl_shader_stage stage,
+                               const std::vector<uint32_t>& code)
+{
+   static std::once_flag header_once;
+   std::call_once(header_once, []() {
+      fprintf(stderr, "aco_compile_time,stage,code_dw");
+      for (unsigned i = aco::statistic_time_isel; i <= aco::statistic_ir_memory; i++)
+         fprintf(stderr, ",%s", statistic_infos[i].name);
+      fprintf(stderr, "\n");
+   });
+
+   std::string line = "aco_compile_time,";
+   line += _mesa_shader_stage_to_abbrev(stage);
+   line += "," + std::to_string(code.size());
+   for (unsigned i = aco::statistic_time_isel; i <= aco::statistic_ir_memory; i++)
+      line += "," + std::to_string(program->statistics[i]);
+   /* print the whole line at once, shaders may be compiled concurrently */
+   fprintf(stderr, "%s\n", line.c_str());
+}
+
 void aco_compile_shader(unsigned shader_count,
                         struct nir_shader *const *shaders,
                         struct radv_shader_binary **binary,
@@ -69,8 +100,15 @@ void aco_compile_shader(unsigned shader_count,
    std::unique_ptr<aco::Program> program{new aco::Program};
 
    program->collect_statistics = args->options->record_stats;
-   if (program->collect_statistics)
-      memset(program->statistics, 0, sizeof(program->statistics));
+   memset(program->statistics, 0, sizeof(program->statistics));
+
+   /* The pass times are always recorded, it's cheap. */
+   int64_t pass_start = os_time_get_nano();
+   auto end_pass = [&](aco::statistic stat) {
+      int64_t now = os_time_get_nano();
+      program->statistics[stat] += (now - pass_start) / 1000;
+      pass_start = now;
+   };
 
    program->debug.func = args->options->debug.func;
    program->debug.private_data = args->options->debug.private_data;
@@ -82,6 +120,7 @@ void aco_compile_shader(unsigned shader_count,
       aco::select_trap_handler_shader(program.get(), shaders[0], &config, args);
    else
       aco::select_program(program.get(), shader_count, shaders, &config, args);
+   end_pass(aco::statistic_time_isel);
    if (args->options->dump_preoptir) {
       std::cerr << "After Instruction Selection:\n";
       aco_print_program(program.get(), stderr);
@@ -106,10 +145,12 @@ void aco_compile_shader(unsigned shader_count,
       aco::setup_reduce_temp(program.get());
       aco::insert_exec_mask(program.get());
       validate(program.get());
+      end_pass(aco::statistic_time_opt);
 
       /* spilling and scheduling */
       live_vars = aco::live_var_analysis(program.get());
       aco::spill(program.get(), live_vars);
+      end_pass(aco::statistic_time_spill);
    }
 
    std::string llvm_ir;
@@ -135,13 +176,19 @@ void aco_compile_shader(unsigned shader_count,
       aco_print_program(program.get(), stderr, live_vars, aco::print_live_vars | aco::print_kill);
 
    if (!args->is_trap_handler_shader) {
+      /* don't count the debug output above */
+      pass_start = os_time_get_nano();
+
       if (!args->options->disable_optimizations &&
           !(aco::debug_flags & aco::DEBUG_NO_SCHED))
          aco::schedule_program(program.get(), live_vars);
       validate(program.get());
+      end_pass(aco::statistic_time_sched);
 
       /* Register Allocation */
-      aco::register_allocation(program.get(), live_vars.live_out);
+      aco::ra_test_policy ra_policy;
+      ra_policy.skip_affinities = args->options->disable_optimizations;
+      aco::register_allocation(program.get(), live_vars.live_out, ra_policy);
       if (args->options->dump_shader) {
          std::cerr << "After RA:\n";
          aco_print_program(program.get(), stderr);
@@ -156,6 +203,7 @@ void aco_compile_shader(unsigned shader_count,
       validate(program.get());
 
       aco::ssa_elimination(program.get());
+      end_pass(aco::statistic_time_ra);
    }
 
    /* Lower to HW Instructions */
@@ -167,6 +215,7 @@ void aco_compile_shader(unsigned shader_count,
 
    if (program->chip_class >= GFX10)
       aco::form_hard_clauses(program.get());
+   end_pass(aco::statistic_time_lower);
 
    if (program->collect_statistics || (aco::debug_flags & aco::DEBUG_PERF_INFO))
       aco::collect_preasm_stats(program.get());
@@ -174,10 +223,15 @@ void aco_compile_shader(unsigned shader_count,
    /* Assembly */
    std::vector<uint32_t> code;
    unsigned exec_size = aco::emit_program(program.get(), code);
+   end_pass(aco::statistic_time_asm);
+   program->statistics[aco::statistic_ir_memory] = DIV_ROUND_UP(program->m.allocated_size(), 1024);
 
    if (program->collect_statistics)
       aco::collect_postasm_stats(program.get(), code);
 
+   if (args->options->dump_compile_time)
+      print_compile_time(program.get(), shaders[shader_count - 1]->info.stage, code);
+
    bool get_disasm = args->options->dump_shader || args->options->record_ir;
 
    size_t size = llvm_ir.size();
@@ -30,6 +30,8 @@ namespace aco {
 
 uint64_t debug_flags = 0;
 
+thread_local aco::monotonic_buffer_resource* instruction_buffer = nullptr;
+
 static const struct debug_control aco_debug_options[] = {
    {"validateir", DEBUG_VALIDATE_IR},
    {"validatera", DEBUG_VALIDATE_RA},
@@ -64,6 +66,7 @@ void init_program(Program *program, Stage stage, struct radv_shader_info *info,
                   enum chip_class chip_class, enum radeon_family family,
                   bool wgp_mode, ac_shader_config *config)
 {
+   instruction_buffer = &program->m;
    program->stage = stage;
    program->config = config;
    program->info = info;
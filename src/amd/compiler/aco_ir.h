@@ -1540,9 +1540,14 @@ struct Pseudo_reduction_instruction : public Instruction {
 };
 static_assert(sizeof(Pseudo_reduction_instruction) == sizeof(Instruction) + 4, "Unexpected padding");
 
+/* Instructions are allocated from the monotonic_buffer_resource of the
+ * Program they belong to, and are only freed together with it.
+ */
+extern thread_local aco::monotonic_buffer_resource* instruction_buffer;
+
 struct instr_deleter_functor {
    void operator()(void* p) {
-      free(p);
+      /* Freed with the Program. */
    }
 };
 
@@ -1553,7 +1558,9 @@ template<typename T>
 T* create_instruction(aco_opcode opcode, Format format, uint32_t num_operands, uint32_t num_definitions)
 {
    std::size_t size = sizeof(T) + num_operands * sizeof(Operand) + num_definitions * sizeof(Definition);
-   char *data = (char*) calloc(1, size);
+   void *ptr = instruction_buffer->allocate(size, alignof(T));
+   memset(ptr, 0, size);
+   char *data = (char*) ptr;
    T* inst = (T*) data;
 
    inst->opcode = opcode;
@@ -1838,6 +1845,14 @@ enum statistic {
    statistic_smem_clauses,
    statistic_sgpr_presched,
    statistic_vgpr_presched,
+   statistic_time_isel,
+   statistic_time_opt,
+   statistic_time_spill,
+   statistic_time_sched,
+   statistic_time_ra,
+   statistic_time_lower,
+   statistic_time_asm,
+   statistic_ir_memory,
    num_statistics
 };
 
@@ -1861,6 +1876,10 @@ struct DeviceInfo {
 
 class Program final {
 public:
+   /* Declared first, so that it's destroyed after everything that may
+    * still point into it.
+    */
+   aco::monotonic_buffer_resource m{65536};
    std::vector<Block> blocks;
    std::vector<RegClass> temp_rc = {s1};
    RegisterDemand max_reg_demand = RegisterDemand();
@@ -1957,6 +1976,9 @@ struct live {
 struct ra_test_policy {
    /* Force RA to always use its pessimistic fallback algorithm */
    bool skip_optimistic_path = false;
+   /* Don't collect phi and vector affinities, which saves a hash map
+    * lookup per definition at the cost of more copies */
+   bool skip_affinities = false;
 };
 
 void init();
@@ -2010,6 +2032,10 @@ void perfwarn(Program *program, bool cond, const char *msg, Instruction *instr=N
 
 void collect_presched_stats(Program *program);
 void collect_preasm_stats(Program *program);
+
+/* Machine model shared by the statistics and the scheduler. */
+unsigned get_issue_cycles(Program *program, aco_ptr<Instruction>& instr);
+unsigned get_memory_latency(aco_ptr<Instruction>& instr);
 void collect_postasm_stats(Program *program, const std::vector<uint32_t>& code);
 
 enum print_flags {
@@ -1957,7 +1957,8 @@ void register_allocation(Program *program, std::vector<IDSet>& live_out_per_bloc
       for (rit = block.instructions.rbegin(); rit != block.instructions.rend(); ++rit) {
          aco_ptr<Instruction>& instr = *rit;
          if (is_phi(instr)) {
-            if (instr->definitions[0].isKill() || instr->definitions[0].isFixed()) {
+            if (instr->definitions[0].isKill() || instr->definitions[0].isFixed() ||
+                ctx.policy.skip_affinities) {
                live.erase(instr->definitions[0].tempId());
                continue;
             }
@@ -1975,18 +1976,20 @@ void register_allocation(Program *program, std::vector<IDSet>& live_out_per_bloc
             phi_ressources.emplace_back(std::move(affinity_related));
          } else {
             /* add vector affinities */
-            if (instr->opcode == aco_opcode::p_create_vector) {
-               for (const Operand& op : instr->operands) {
-                  if (op.isTemp() && op.isFirstKill() && op.getTemp().type() == instr->definitions[0].getTemp().type())
-                     ctx.vectors[op.tempId()] = instr.get();
+            if (!ctx.policy.skip_affinities) {
+               if (instr->opcode == aco_opcode::p_create_vector) {
+                  for (const Operand& op : instr->operands) {
+                     if (op.isTemp() && op.isFirstKill() && op.getTemp().type() == instr->definitions[0].getTemp().type())
+                        ctx.vectors[op.tempId()] = instr.get();
+                  }
+               } else if (instr->format == Format::MIMG && instr->operands.size() > 4) {
+                  for (unsigned i = 3; i < instr->operands.size(); i++)
+                     ctx.vectors[instr->operands[i].tempId()] = instr.get();
                }
-            } else if (instr->format == Format::MIMG && instr->operands.size() > 4) {
-               for (unsigned i = 3; i < instr->operands.size(); i++)
-                  ctx.vectors[instr->operands[i].tempId()] = instr.get();
-            }
 
-            if (instr->opcode == aco_opcode::p_split_vector && instr->operands[0].isFirstKillBeforeDef())
-               ctx.split_vectors[instr->operands[0].tempId()] = instr.get();
+               if (instr->opcode == aco_opcode::p_split_vector && instr->operands[0].isFirstKillBeforeDef())
+                  ctx.split_vectors[instr->operands[0].tempId()] = instr.get();
+            }
 
             /* add operands to live variables */
             for (const Operand& op : instr->operands) {
@@ -83,6 +83,7 @@ private:
 };
 
 struct sched_ctx {
+   Program *program;
    int16_t num_waves;
    int16_t last_SMEM_stall;
    int last_SMEM_dep_idx;
@@ -666,6 +667,13 @@ void schedule_VMEM(sched_ctx& ctx, Block* block,
    int clause_max_grab_dist = VMEM_CLAUSE_MAX_GRAB_DIST;
    int16_t k = 0;
 
+   /* The other waves on the SIMD hide part of the latency, stop moving
+    * instructions once this wave has enough independent work to cover
+    * the rest. Moving more would only increase the register pressure.
+    */
+   unsigned latency_to_hide = get_memory_latency(block->instructions[idx]) / ctx.num_waves;
+   unsigned hidden_cycles = 0;
+
    /* first, check if we have instructions before current to move down */
    hazard_query indep_hq;
    hazard_query clause_hq;
@@ -701,6 +709,10 @@ void schedule_VMEM(sched_ctx& ctx, Block* block,
          part_of_clause = same_resource && grab_dist < clause_max_grab_dist;
       }
 
+      /* only keep forming the clause once the latency is hidden */
+      if (!part_of_clause && hidden_cycles >= latency_to_hide)
+         break;
+
       /* if current depends on candidate, add additional dependencies and continue */
       bool can_move_down = !is_vmem || part_of_clause;
 
@@ -720,6 +732,7 @@ void schedule_VMEM(sched_ctx& ctx, Block* block,
       }
 
       Instruction *candidate_ptr = candidate.get();
+      unsigned candidate_cycles = get_issue_cycles(ctx.program, candidate);
       MoveResult res = ctx.mv.downwards_move(part_of_clause);
       if (res == move_fail_ssa || res == move_fail_rar) {
          add_to_hazard_query(&indep_hq, candidate.get());
@@ -729,10 +742,12 @@ void schedule_VMEM(sched_ctx& ctx, Block* block,
       } else if (res == move_fail_pressure) {
          break;
       }
-      if (part_of_clause)
+      if (part_of_clause) {
          add_to_hazard_query(&indep_hq, candidate_ptr);
-      else
+      } else {
          k++;
+         hidden_cycles += candidate_cycles;
+      }
       if (candidate_idx < ctx.last_SMEM_dep_idx)
          ctx.last_SMEM_stall++;
    }
@@ -751,6 +766,9 @@ void schedule_VMEM(sched_ctx& ctx, Block* block,
       if (candidate->opcode == aco_opcode::p_logical_end)
          break;
 
+      if (hidden_cycles >= latency_to_hide)
+         break;
+
       /* check if candidate depends on current */
       bool is_dependency = false;
       if (found_dependency) {
@@ -779,14 +797,18 @@ void schedule_VMEM(sched_ctx& ctx, Block* block,
       }
 
       if (is_dependency || !found_dependency) {
-         if (found_dependency)
+         if (found_dependency) {
             add_to_hazard_query(&indep_hq, candidate.get());
-         else
+         } else {
+            /* already between current and its first use */
             k++;
+            hidden_cycles += get_issue_cycles(ctx.program, candidate);
+         }
          ctx.mv.upwards_skip();
          continue;
       }
 
+      unsigned candidate_cycles = get_issue_cycles(ctx.program, candidate);
       MoveResult res = ctx.mv.upwards_move();
       if (res == move_fail_ssa || res == move_fail_rar) {
          add_to_hazard_query(&indep_hq, candidate.get());
@@ -796,6 +818,7 @@ void schedule_VMEM(sched_ctx& ctx, Block* block,
          break;
       }
       k++;
+      hidden_cycles += candidate_cycles;
    }
 }
 
@@ -895,6 +918,7 @@ void schedule_program(Program *program, live& live_vars)
    demand.vgpr += program->config->num_shared_vgprs / 2;
 
    sched_ctx ctx;
+   ctx.program = program;
    ctx.mv.depends_on.resize(program->peekAllocationId());
    ctx.mv.RAR_dependencies.resize(program->peekAllocationId());
    ctx.mv.RAR_dependencies_clause.resize(program->peekAllocationId());
@@ -61,6 +61,8 @@ struct spill_ctx {
    std::vector<bool> is_reloaded;
    std::map<Temp, remat_info> remat;
    std::map<Instruction *, bool> remat_used;
+   /* per-instruction next-use distances of the block being processed, sorted by temp id */
+   std::vector<std::vector<std::pair<Temp, uint32_t>>> local_next_uses;
    unsigned wave_size;
 
    spill_ctx(const RegisterDemand target_pressure_, Program* program_,
@@ -144,7 +146,14 @@ int32_t get_dominator(int idx_a, int idx_b, Program* program, bool is_linear)
    return idx_a;
 }
 
-void next_uses_per_block(spill_ctx& ctx, unsigned block_idx, std::set<uint32_t>& worklist)
+void add_to_worklist(std::vector<bool>& worklist, unsigned& worklist_end, unsigned block_idx)
+{
+   worklist[block_idx] = true;
+   worklist_end = std::max(worklist_end, block_idx + 1);
+}
+
+void next_uses_per_block(spill_ctx& ctx, unsigned block_idx,
+                         std::vector<bool>& worklist, unsigned& worklist_end)
 {
    Block* block = &ctx.program->blocks[block_idx];
    std::map<Temp, std::pair<uint32_t, uint32_t>> next_uses = ctx.next_use_distances_end[block_idx];
@@ -189,10 +198,12 @@ void next_uses_per_block(spill_ctx& ctx, unsigned block_idx, std::set<uint32_t>&
                              block->logical_preds[i] :
                              block->linear_preds[i];
          if (instr->operands[i].isTemp()) {
-            if (ctx.next_use_distances_end[pred_idx].find(instr->operands[i].getTemp()) == ctx.next_use_distances_end[pred_idx].end() ||
-                ctx.next_use_distances_end[pred_idx][instr->operands[i].getTemp()] != std::pair<uint32_t, uint32_t>{block_idx, 0})
-               worklist.insert(pred_idx);
-            ctx.next_use_distances_end[pred_idx][instr->operands[i].getTemp()] = {block_idx, 0};
+            std::pair<uint32_t, uint32_t> next_use{block_idx, 0};
+            auto res = ctx.next_use_distances_end[pred_idx].emplace(instr->operands[i].getTemp(), next_use);
+            if (res.second || res.first->second != next_use) {
+               res.first->second = next_use;
+               add_to_worklist(worklist, worklist_end, pred_idx);
+            }
          }
       }
       next_uses.erase(instr->definitions[0].getTemp());
@@ -208,13 +219,15 @@ void next_uses_per_block(spill_ctx& ctx, unsigned block_idx, std::set<uint32_t>&
       for (unsigned pred_idx : preds) {
          if (ctx.program->blocks[pred_idx].loop_nest_depth > block->loop_nest_depth)
             distance += 0xFFFF;
-         if (ctx.next_use_distances_end[pred_idx].find(temp) != ctx.next_use_distances_end[pred_idx].end()) {
-            dom = get_dominator(dom, ctx.next_use_distances_end[pred_idx][temp].first, ctx.program, temp.is_linear());
-            distance = std::min(ctx.next_use_distances_end[pred_idx][temp].second, distance);
+         auto res = ctx.next_use_distances_end[pred_idx].emplace(temp, std::pair<uint32_t, uint32_t>{dom, distance});
+         if (!res.second) {
+            dom = get_dominator(dom, res.first->second.first, ctx.program, temp.is_linear());
+            distance = std::min(res.first->second.second, distance);
+            if (res.first->second == std::pair<uint32_t, uint32_t>{dom, distance})
+               continue;
+            res.first->second = {dom, distance};
          }
-         if (ctx.next_use_distances_end[pred_idx][temp] != std::pair<uint32_t, uint32_t>{dom, distance})
-            worklist.insert(pred_idx);
-         ctx.next_use_distances_end[pred_idx][temp] = {dom, distance};
+         add_to_worklist(worklist, worklist_end, pred_idx);
       }
    }
 
@@ -224,15 +237,19 @@ void compute_global_next_uses(spill_ctx& ctx)
 {
    ctx.next_use_distances_start.resize(ctx.program->blocks.size());
    ctx.next_use_distances_end.resize(ctx.program->blocks.size());
-   std::set<uint32_t> worklist;
-   for (Block& block : ctx.program->blocks)
-      worklist.insert(block.index);
-
-   while (!worklist.empty()) {
-      std::set<unsigned>::reverse_iterator b_it = worklist.rbegin();
-      unsigned block_idx = *b_it;
-      worklist.erase(block_idx);
-      next_uses_per_block(ctx, block_idx, worklist);
+
+   /* Blocks are always processed in reverse order, starting from the highest
+    * pending one, so a flag per block and the end of the pending range are
+    * enough to track the worklist.
+    */
+   std::vector<bool> worklist(ctx.program->blocks.size(), true);
+   unsigned worklist_end = ctx.program->blocks.size();
+   while (worklist_end) {
+      unsigned block_idx = --worklist_end;
+      if (!worklist[block_idx])
+         continue;
+      worklist[block_idx] = false;
+      next_uses_per_block(ctx, block_idx, worklist, worklist_end);
    }
 }
 
@@ -321,13 +338,28 @@ void get_rematerialize_info(spill_ctx& ctx)
    }
 }
 
-std::vector<std::map<Temp, uint32_t>> local_next_uses(spill_ctx& ctx, Block* block)
+std::vector<std::pair<Temp, uint32_t>>::iterator
+find_next_use(std::vector<std::pair<Temp, uint32_t>>& next_uses, Temp tmp)
+{
+   return std::lower_bound(next_uses.begin(), next_uses.end(), tmp,
+                           [](const std::pair<Temp, uint32_t>& a, Temp b) { return a.first < b; });
+}
+
+/* Fills ctx.local_next_uses with the next-use distances after each instruction
+ * of the block. The vectors are kept sorted by temp so that they are iterated
+ * in the same order as the global next-use maps, and are reused across blocks
+ * to avoid reallocating them for every instruction.
+ */
+void update_local_next_uses(spill_ctx& ctx, Block* block)
 {
-   std::vector<std::map<Temp, uint32_t>> local_next_uses(block->instructions.size());
+   std::vector<std::vector<std::pair<Temp, uint32_t>>>& local_next_uses = ctx.local_next_uses;
+   if (local_next_uses.size() < block->instructions.size())
+      local_next_uses.resize(block->instructions.size());
 
-   std::map<Temp, uint32_t> next_uses;
-   for (std::pair<Temp, std::pair<uint32_t, uint32_t>> pair : ctx.next_use_distances_end[block->index])
-      next_uses[pair.first] = pair.second.second + block->instructions.size();
+   std::vector<std::pair<Temp, uint32_t>> next_uses;
+   next_uses.reserve(ctx.next_use_distances_end[block->index].size());
+   for (const std::pair<const Temp, std::pair<uint32_t, uint32_t>>& pair : ctx.next_use_distances_end[block->index])
+      next_uses.emplace_back(pair.first, pair.second.second + block->instructions.size());
 
    for (int idx = block->instructions.size() - 1; idx >= 0; idx--) {
       aco_ptr<Instruction>& instr = block->instructions[idx];
@@ -341,16 +373,23 @@ std::vector<std::map<Temp, uint32_t>> local_next_uses(spill_ctx& ctx, Block* blo
             continue;
          if (op.regClass().type() == RegType::vgpr && op.regClass().is_linear())
             continue;
-         if (op.isTemp())
-            next_uses[op.getTemp()] = idx;
+         if (op.isTemp()) {
+            auto it = find_next_use(next_uses, op.getTemp());
+            if (it != next_uses.end() && it->first == op.getTemp())
+               it->second = idx;
+            else
+               next_uses.emplace(it, op.getTemp(), idx);
+         }
       }
       for (const Definition& def : instr->definitions) {
-         if (def.isTemp())
-            next_uses.erase(def.getTemp());
+         if (def.isTemp()) {
+            auto it = find_next_use(next_uses, def.getTemp());
+            if (it != next_uses.end() && it->first == def.getTemp())
+               next_uses.erase(it);
+         }
       }
-      local_next_uses[idx] = next_uses;
+      local_next_uses[idx].assign(next_uses.begin(), next_uses.end());
    }
-   return local_next_uses;
 }
 
 
@@ -381,7 +420,7 @@ RegisterDemand init_live_in_vars(spill_ctx& ctx, Block* block, unsigned block_id
       unsigned loop_end = i;
 
       for (auto spilled : ctx.spills_exit[block_idx - 1]) {
-         auto map = ctx.next_use_distances_end[block_idx - 1];
+         auto& map = ctx.next_use_distances_end[block_idx - 1];
          auto it = map.find(spilled.first);
 
          /* variable is not even live at the predecessor: probably from a phi */
@@ -1081,7 +1120,6 @@ void process_block(spill_ctx& ctx, unsigned block_idx, Block* block,
 {
    assert(!ctx.processed[block_idx]);
 
-   std::vector<std::map<Temp, uint32_t>> local_next_use_distance;
    std::vector<aco_ptr<Instruction>> instructions;
    unsigned idx = 0;
 
@@ -1092,7 +1130,7 @@ void process_block(spill_ctx& ctx, unsigned block_idx, Block* block,
    }
 
    if (block->register_demand.exceeds(ctx.target_pressure))
-      local_next_use_distance = local_next_uses(ctx, block);
+      update_local_next_uses(ctx, block);
 
    while (idx < block->instructions.size()) {
       aco_ptr<Instruction>& instr = block->instructions[idx];
@@ -1127,7 +1165,7 @@ void process_block(spill_ctx& ctx, unsigned block_idx, Block* block,
          RegisterDemand new_demand = ctx.register_demand[block_idx][idx];
          new_demand.update(get_demand_before(ctx, block_idx, idx));
 
-         assert(!local_next_use_distance.empty());
+         assert(ctx.local_next_uses.size() >= block->instructions.size());
 
          /* if reg pressure is too high, spill variable with furthest next use */
          while (RegisterDemand(new_demand - spilled_registers).exceeds(ctx.target_pressure)) {
@@ -1135,7 +1173,7 @@ void process_block(spill_ctx& ctx, unsigned block_idx, Block* block,
             Temp to_spill;
             bool do_rematerialize = false;
             if (new_demand.vgpr - spilled_registers.vgpr > ctx.target_pressure.vgpr) {
-               for (std::pair<Temp, uint32_t> pair : local_next_use_distance[idx]) {
+               for (std::pair<Temp, uint32_t> pair : ctx.local_next_uses[idx]) {
                   bool can_rematerialize = ctx.remat.count(pair.first);
                   if (pair.first.type() == RegType::vgpr &&
                       ((pair.second > distance && can_rematerialize == do_rematerialize) ||
@@ -1148,7 +1186,7 @@ void process_block(spill_ctx& ctx, unsigned block_idx, Block* block,
                   }
                }
             } else {
-               for (std::pair<Temp, uint32_t> pair : local_next_use_distance[idx]) {
+               for (std::pair<Temp, uint32_t> pair : ctx.local_next_uses[idx]) {
                   bool can_rematerialize = ctx.remat.count(pair.first);
                   if (pair.first.type() == RegType::sgpr &&
                       ((pair.second > distance && can_rematerialize == do_rematerialize) ||
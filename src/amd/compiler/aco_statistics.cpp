@@ -270,6 +270,20 @@ static wait_counter_info get_wait_counter_info(aco_ptr<Instruction>& instr)
    return wait_counter_info(0, 0, 0, 0);
 }
 
+/* The number of cycles a single wave occupies the issuing unit with instr. */
+unsigned get_issue_cycles(Program *program, aco_ptr<Instruction>& instr)
+{
+   perf_info perf = get_perf_info(program, instr);
+   return MAX2(perf.cost0, perf.cost1);
+}
+
+/* The number of cycles until the result of a memory instruction is available. */
+unsigned get_memory_latency(aco_ptr<Instruction>& instr)
+{
+   wait_counter_info wait_info = get_wait_counter_info(instr);
+   return MAX2(MAX3(wait_info.vm, wait_info.exp, wait_info.lgkm), wait_info.vs);
+}
+
 static wait_imm get_wait_imm(Program *program, aco_ptr<Instruction>& instr)
 {
    if (instr->opcode == aco_opcode::s_endpgm) {
@@ -26,7 +26,10 @@
 #define ACO_UTIL_H
 
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
 #include <iterator>
+#include <utility>
 #include <vector>
 
 namespace aco {
@@ -380,6 +383,113 @@ inline uint32_t IDSet::Iterator::operator * () const {
    return (word << 6) | bit;
 }
 
+/*
+ * Light-weight memory resource which allows to sequentially allocate from
+ * a buffer. Both, the release() method and the destructor release all managed
+ * memory. Memory can't be freed individually, it's meant for objects which
+ * live exactly as long as the resource.
+ *
+ * The interface resembles a subset of std::pmr::monotonic_buffer_resource.
+ */
+class monotonic_buffer_resource final {
+public:
+   explicit monotonic_buffer_resource(size_t size = initial_size)
+   {
+      /* The size parameter refers to the total size of the buffer. */
+      if (size < minimum_size)
+         size = minimum_size;
+      buffer = (Buffer*)malloc(size);
+      buffer->next = nullptr;
+      buffer->data_size = size - sizeof(Buffer);
+      buffer->current_idx = 0;
+   }
+
+   ~monotonic_buffer_resource()
+   {
+      release();
+      free(buffer);
+   }
+
+   /* Move-constructor and -assignment */
+   monotonic_buffer_resource(monotonic_buffer_resource&& other)
+      : monotonic_buffer_resource()
+   {
+      *this = std::move(other);
+   }
+   monotonic_buffer_resource& operator=(monotonic_buffer_resource&& other)
+   {
+      release();
+      std::swap(buffer, other.buffer);
+      return *this;
+   }
+
+   /* Delete copy-constructor and -assignment to avoid double free() */
+   monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+   monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+
+   void* allocate(size_t size, size_t alignment)
+   {
+      buffer->current_idx = align(buffer->current_idx, alignment);
+      if (buffer->current_idx + size <= buffer->data_size) {
+         uint8_t* ptr = &buffer->data[buffer->current_idx];
+         buffer->current_idx += size;
+         return ptr;
+      }
+
+      /* create new larger buffer */
+      uint32_t total_size = buffer->data_size + sizeof(Buffer);
+      do {
+         total_size *= 2;
+      } while (total_size - sizeof(Buffer) < size);
+
+      Buffer* next = buffer;
+      buffer = (Buffer*)malloc(total_size);
+      buffer->next = next;
+      buffer->data_size = total_size - sizeof(Buffer);
+      buffer->current_idx = 0;
+
+      return allocate(size, alignment);
+   }
+
+   /* The total size of all buffers, in bytes. */
+   size_t allocated_size() const
+   {
+      size_t size = 0;
+      for (const Buffer* b = buffer; b; b = b->next)
+         size += b->data_size + sizeof(Buffer);
+      return size;
+   }
+
+   void release()
+   {
+      while (buffer->next) {
+         Buffer* next = buffer->next;
+         free(buffer);
+         buffer = next;
+      }
+      buffer->current_idx = 0;
+   }
+
+private:
+   struct Buffer {
+      Buffer* next;
+      uint32_t current_idx;
+      uint32_t data_size;
+      uint8_t data[];
+   };
+
+   static size_t align(size_t offset, size_t alignment)
+   {
+      return (offset + alignment - 1) & ~(alignment - 1);
+   }
+
+   static constexpr size_t initial_size = 4096;
+   static constexpr size_t minimum_size = 128;
+   static_assert(minimum_size > sizeof(Buffer), "minimum_size too small");
+
+   Buffer* buffer;
+};
+
 } // namespace aco
 
 #endif // ACO_UTIL_H
@@ -26,6 +26,7 @@
 
 #include "ac_rgp.h"
 #include "ac_sqtt.h"
+#include "util/os_time.h"
 
 static void
 radv_write_begin_general_api_marker(struct radv_cmd_buffer *cmd_buffer,
@@ -359,11 +360,18 @@ radv_handle_thread_trace(VkQueue _queue)
 {
 	RADV_FROM_HANDLE(radv_queue, queue, _queue);
 	static bool thread_trace_enabled = false;
+	static bool hitch_capture = false;
 	static uint64_t num_frames = 0;
+	static int64_t frame_begin_ns = 0;
+	const int hitch_threshold_ms = queue->device->thread_trace.hitch_threshold_ms;
 	bool resize_trigger = false;
 
 	if (thread_trace_enabled) {
 		struct ac_thread_trace thread_trace = {0};
+		/* Don't count the time spent waiting for and saving the
+		 * previous trace, it's not part of the frame.
+		 */
+		int64_t frame_ns = os_time_get_nano() - frame_begin_ns;
 
 		radv_end_thread_trace(queue);
 		thread_trace_enabled = false;
@@ -372,9 +380,20 @@ radv_handle_thread_trace(VkQueue _queue)
 		radv_QueueWaitIdle(_queue);
 
 		if (radv_get_thread_trace(queue, &thread_trace)) {
-			ac_dump_thread_trace(&queue->device->physical_device->rad_info,
-					     &thread_trace,
-					     &queue->device->thread_trace);
+			/* With the hitch trigger every frame is traced, but
+			 * only the slow ones are saved.
+			 */
+			if (!hitch_capture ||
+			    frame_ns > (int64_t)hitch_threshold_ms * 1000000) {
+				if (hitch_capture) {
+					fprintf(stderr, "RADV: frame %"PRIu64" took %.1f ms, "
+						"saving its thread trace\n",
+						num_frames - 1, frame_ns / 1000000.0);
+				}
+				ac_dump_thread_trace(&queue->device->physical_device->rad_info,
+						     &thread_trace,
+						     &queue->device->thread_trace);
+			}
 		} else {
 			/* Trigger a new capture if the driver failed to get
 			 * the trace because the buffer was too small.
@@ -399,9 +418,17 @@ radv_handle_thread_trace(VkQueue _queue)
 		}
 #endif
 
-		if (frame_trigger || file_trigger || resize_trigger) {
+		bool hitch_trigger = hitch_threshold_ms > 0;
+
+		if (frame_trigger || file_trigger || resize_trigger || hitch_trigger) {
+			bool explicit_trigger = frame_trigger || file_trigger || resize_trigger;
+
 			/* FIXME: SQTT on compute hangs. */
 			if (queue->queue_family_index == RADV_QUEUE_COMPUTE) {
+				/* Don't warn about it every frame. */
+				if (!explicit_trigger)
+					return;
+
 				fprintf(stderr, "RADV: Capturing a SQTT trace on the compute "
 						"queue is currently broken and might hang! "
 						"Please, disable presenting on compute if "
@@ -412,6 +439,8 @@ radv_handle_thread_trace(VkQueue _queue)
 			radv_begin_thread_trace(queue);
 			assert(!thread_trace_enabled);
 			thread_trace_enabled = true;
+			hitch_capture = !explicit_trigger;
+			frame_begin_ns = os_time_get_nano();
 		}
 	}
 	num_frames++;
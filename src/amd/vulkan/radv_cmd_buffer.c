@@ -351,6 +351,43 @@ enum ring_type radv_queue_family_to_ring(int f) {
 	}
 }
 
+/* Upload BOs are kept by the pool when a command buffer is reset, because
+ * applications reset and re-record their command buffers every frame and
+ * would otherwise cause a kernel allocation for every BO that has to be
+ * chained. The pool is externally synchronized with the command buffers
+ * allocated from it, so no locking is needed.
+ */
+#define RADV_CMD_POOL_MAX_UPLOAD_BOS 16
+
+static void
+radv_cmd_pool_recycle_upload(struct radv_cmd_pool *pool,
+			     struct radv_device *device,
+			     struct radv_cmd_buffer_upload *upload)
+{
+	if (pool->num_upload_bos >= RADV_CMD_POOL_MAX_UPLOAD_BOS ||
+	    !upload->map) {
+		device->ws->buffer_destroy(device->ws, upload->upload_bo);
+		free(upload);
+		return;
+	}
+
+	list_addtail(&upload->list, &pool->upload_bos);
+	pool->num_upload_bos++;
+}
+
+static void
+radv_cmd_pool_free_uploads(struct radv_cmd_pool *pool,
+			   struct radv_device *device)
+{
+	list_for_each_entry_safe(struct radv_cmd_buffer_upload, up,
+				 &pool->upload_bos, list) {
+		device->ws->buffer_destroy(device->ws, up->upload_bo);
+		list_del(&up->list);
+		free(up);
+	}
+	pool->num_upload_bos = 0;
+}
+
 static void
 radv_destroy_cmd_buffer(struct radv_cmd_buffer *cmd_buffer)
 {
@@ -421,9 +458,8 @@ radv_reset_cmd_buffer(struct radv_cmd_buffer *cmd_buffer)
 
 	list_for_each_entry_safe(struct radv_cmd_buffer_upload, up,
 				 &cmd_buffer->upload.list, list) {
-		cmd_buffer->device->ws->buffer_destroy(cmd_buffer->device->ws, up->upload_bo);
 		list_del(&up->list);
-		free(up);
+		radv_cmd_pool_recycle_upload(cmd_buffer->pool, cmd_buffer->device, up);
 	}
 
 	cmd_buffer->push_constant_stages = 0;
@@ -500,23 +536,45 @@ radv_cmd_buffer_resize_upload_buf(struct radv_cmd_buffer *cmd_buffer,
 	struct radeon_winsys_bo *bo;
 	struct radv_cmd_buffer_upload *upload;
 	struct radv_device *device = cmd_buffer->device;
+	struct radv_cmd_pool *pool = cmd_buffer->pool;
+	uint8_t *map;
 
 	new_size = MAX2(min_needed, 16 * 1024);
 	new_size = MAX2(new_size, 2 * cmd_buffer->upload.size);
 
-	bo = device->ws->buffer_create(device->ws,
-				       new_size, 4096,
-				       radv_cmdbuffer_domain(&device->physical_device->rad_info,
-							     device->instance->perftest_flags),
-				       RADEON_FLAG_CPU_ACCESS|
-				       RADEON_FLAG_NO_INTERPROCESS_SHARING |
-				       RADEON_FLAG_32BIT |
-				       RADEON_FLAG_GTT_WC,
-				       RADV_BO_PRIORITY_UPLOAD_BUFFER);
-
-	if (!bo) {
-		cmd_buffer->record_result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
-		return false;
+	/* Take the smallest recycled BO that is large enough. */
+	struct radv_cmd_buffer_upload *best = NULL;
+	list_for_each_entry(struct radv_cmd_buffer_upload, up,
+			    &pool->upload_bos, list) {
+		if (up->size >= new_size && (!best || up->size < best->size))
+			best = up;
+	}
+
+	if (best) {
+		list_del(&best->list);
+		pool->num_upload_bos--;
+
+		bo = best->upload_bo;
+		map = best->map;
+		new_size = best->size;
+		free(best);
+	} else {
+		bo = device->ws->buffer_create(device->ws,
+					       new_size, 4096,
+					       radv_cmdbuffer_domain(&device->physical_device->rad_info,
+								     device->instance->perftest_flags),
+					       RADEON_FLAG_CPU_ACCESS|
+					       RADEON_FLAG_NO_INTERPROCESS_SHARING |
+					       RADEON_FLAG_32BIT |
+					       RADEON_FLAG_GTT_WC,
+					       RADV_BO_PRIORITY_UPLOAD_BUFFER);
+
+		if (!bo) {
+			cmd_buffer->record_result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+			return false;
+		}
+
+		map = device->ws->buffer_map(bo);
 	}
 
 	radv_cs_add_buffer(device->ws, cmd_buffer->cs, bo);
@@ -536,7 +594,7 @@ radv_cmd_buffer_resize_upload_buf(struct radv_cmd_buffer *cmd_buffer,
 	cmd_buffer->upload.upload_bo = bo;
 	cmd_buffer->upload.size = new_size;
 	cmd_buffer->upload.offset = 0;
-	cmd_buffer->upload.map = device->ws->buffer_map(cmd_buffer->upload.upload_bo);
+	cmd_buffer->upload.map = map;
 
 	if (!cmd_buffer->upload.map) {
 		cmd_buffer->record_result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
@@ -5058,6 +5116,8 @@ VkResult radv_CreateCommandPool(
 
 	list_inithead(&pool->cmd_buffers);
 	list_inithead(&pool->free_cmd_buffers);
+	list_inithead(&pool->upload_bos);
+	pool->num_upload_bos = 0;
 
 	pool->queue_family_index = pCreateInfo->queueFamilyIndex;
 
@@ -5088,6 +5148,8 @@ void radv_DestroyCommandPool(
 		radv_destroy_cmd_buffer(cmd_buffer);
 	}
 
+	radv_cmd_pool_free_uploads(pool, device);
+
 	vk_object_base_finish(&pool->base);
 	vk_free2(&device->vk.alloc, pAllocator, pool);
 }
@@ -5111,10 +5173,11 @@ VkResult radv_ResetCommandPool(
 }
 
 void radv_TrimCommandPool(
-    VkDevice                                    device,
+    VkDevice                                    _device,
     VkCommandPool                               commandPool,
     VkCommandPoolTrimFlags                      flags)
 {
+	RADV_FROM_HANDLE(radv_device, device, _device);
 	RADV_FROM_HANDLE(radv_cmd_pool, pool, commandPool);
 
 	if (!pool)
@@ -5124,6 +5187,8 @@ void radv_TrimCommandPool(
 				 &pool->free_cmd_buffers, pool_link) {
 		radv_destroy_cmd_buffer(cmd_buffer);
 	}
+
+	radv_cmd_pool_free_uploads(pool, device);
 }
 
 static void
@@ -1316,6 +1316,39 @@ void radv_UpdateDescriptorSets(
 			            descriptorCopyCount, pDescriptorCopies);
 }
 
+/* Append next to prev if it continues prev in the template data, the set
+ * and the buffer list. Applications commonly use one entry per binding, so
+ * this turns consecutive bindings of the same type into a single loop.
+ */
+static bool
+radv_merge_template_entries(struct radv_descriptor_update_template_entry *prev,
+			    const struct radv_descriptor_update_template_entry *next)
+{
+	const uint32_t count = prev->descriptor_count;
+
+	if (prev->descriptor_type != next->descriptor_type ||
+	    prev->descriptor_type == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK_EXT ||
+	    prev->immutable_samplers || next->immutable_samplers ||
+	    prev->has_sampler != next->has_sampler ||
+	    prev->sampler_offset != next->sampler_offset ||
+	    prev->src_stride != next->src_stride ||
+	    prev->dst_stride != next->dst_stride)
+		return false;
+
+	/* Dynamic descriptors are indexed by descriptor, the others by dword. */
+	const uint32_t dst_end = prev->descriptor_type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+				 prev->descriptor_type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC ?
+				 prev->dst_offset + count : prev->dst_offset + count * prev->dst_stride;
+
+	if (next->src_offset != prev->src_offset + count * prev->src_stride ||
+	    next->dst_offset != dst_end ||
+	    next->buffer_offset != prev->buffer_offset + count)
+		return false;
+
+	prev->descriptor_count += next->descriptor_count;
+	return true;
+}
+
 VkResult radv_CreateDescriptorUpdateTemplate(VkDevice _device,
                                              const VkDescriptorUpdateTemplateCreateInfo *pCreateInfo,
                                              const VkAllocationCallbacks *pAllocator,
@@ -1336,8 +1369,6 @@ VkResult radv_CreateDescriptorUpdateTemplate(VkDevice _device,
 	vk_object_base_init(&device->vk, &templ->base,
 			    VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE);
 
-	templ->entry_count = entry_count;
-
 	if (pCreateInfo->templateType == VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_PUSH_DESCRIPTORS_KHR) {
 		RADV_FROM_HANDLE(radv_pipeline_layout, pipeline_layout, pCreateInfo->pipelineLayout);
 
@@ -1350,6 +1381,8 @@ VkResult radv_CreateDescriptorUpdateTemplate(VkDevice _device,
 		templ->bind_point = pCreateInfo->pipelineBindPoint;
 	}
 
+	templ->entry_count = 0;
+
 	for (i = 0; i < entry_count; i++) {
 		const VkDescriptorUpdateTemplateEntry *entry = &pCreateInfo->pDescriptorUpdateEntries[i];
 		const struct radv_descriptor_set_binding_layout *binding_layout =
@@ -1391,7 +1424,7 @@ VkResult radv_CreateDescriptorUpdateTemplate(VkDevice _device,
 			break;
 		}
 
-		templ->entry[i] = (struct radv_descriptor_update_template_entry) {
+		struct radv_descriptor_update_template_entry new_entry = {
 			.descriptor_type = entry->descriptorType,
 			.descriptor_count = entry->descriptorCount,
 			.src_offset = entry->offset,
@@ -1403,6 +1436,12 @@ VkResult radv_CreateDescriptorUpdateTemplate(VkDevice _device,
 			.sampler_offset = radv_combined_image_descriptor_sampler_offset(binding_layout),
 			.immutable_samplers = immutable_samplers
 		};
+
+		if (templ->entry_count &&
+		    radv_merge_template_entries(&templ->entry[templ->entry_count - 1], &new_entry))
+			continue;
+
+		templ->entry[templ->entry_count++] = new_entry;
 	}
 
 	*pDescriptorUpdateTemplate = radv_descriptor_update_template_to_handle(templ);
@@ -1433,65 +1472,75 @@ void radv_update_descriptor_set_with_template(struct radv_device *device,
 	uint32_t i;
 
 	for (i = 0; i < templ->entry_count; ++i) {
-		struct radeon_winsys_bo **buffer_list = set->descriptors + templ->entry[i].buffer_offset;
-		uint32_t *pDst = set->header.mapped_ptr + templ->entry[i].dst_offset;
-		const uint8_t *pSrc = ((const uint8_t *) pData) + templ->entry[i].src_offset;
+		const struct radv_descriptor_update_template_entry *entry = &templ->entry[i];
+		struct radeon_winsys_bo **buffer_list = set->descriptors + entry->buffer_offset;
+		uint32_t *pDst = set->header.mapped_ptr + entry->dst_offset;
+		const uint8_t *pSrc = ((const uint8_t *) pData) + entry->src_offset;
+		const uint32_t count = entry->descriptor_count;
+		const size_t src_stride = entry->src_stride;
+		const uint32_t dst_stride = entry->dst_stride;
 		uint32_t j;
 
-		if (templ->entry[i].descriptor_type == VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK_EXT) {
-			memcpy((uint8_t*)pDst, pSrc, templ->entry[i].descriptor_count);
-			continue;
+		/* Switch on the type once per entry, so that each case is a
+		 * tight loop over the range of descriptors.
+		 */
+		switch (entry->descriptor_type) {
+		case VK_DESCRIPTOR_TYPE_INLINE_UNIFORM_BLOCK_EXT:
+			memcpy((uint8_t*)pDst, pSrc, count);
+			break;
+		case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+		case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC: {
+			struct radv_descriptor_range *range =
+				set->header.dynamic_descriptors + entry->dst_offset;
+			assert(!(set->header.layout->flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR));
+			for (j = 0; j < count; ++j, pSrc += src_stride)
+				write_dynamic_buffer_descriptor(device, range + j, buffer_list + j,
+								(struct VkDescriptorBufferInfo *) pSrc);
+			break;
 		}
-
-		for (j = 0; j < templ->entry[i].descriptor_count; ++j) {
-			switch (templ->entry[i].descriptor_type) {
-			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
-			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC: {
-				const unsigned idx = templ->entry[i].dst_offset + j;
-				assert(!(set->header.layout->flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR));
-				write_dynamic_buffer_descriptor(device, set->header.dynamic_descriptors + idx,
-								buffer_list, (struct VkDescriptorBufferInfo *) pSrc);
-				break;
-			}
-			case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
-			case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
-				write_buffer_descriptor(device, cmd_buffer, pDst, buffer_list,
+		case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+		case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+			for (j = 0; j < count; ++j, pSrc += src_stride, pDst += dst_stride)
+				write_buffer_descriptor(device, cmd_buffer, pDst, buffer_list + j,
 				                        (struct VkDescriptorBufferInfo *) pSrc);
-				break;
-			case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
-			case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
-				write_texel_buffer_descriptor(device, cmd_buffer, pDst, buffer_list,
+			break;
+		case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+		case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+			for (j = 0; j < count; ++j, pSrc += src_stride, pDst += dst_stride)
+				write_texel_buffer_descriptor(device, cmd_buffer, pDst, buffer_list + j,
 						              *(VkBufferView *) pSrc);
-				break;
-			case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
-			case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
-			case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
-				write_image_descriptor(device, cmd_buffer, 64, pDst, buffer_list,
-						       templ->entry[i].descriptor_type,
+			break;
+		case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+		case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+		case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+			for (j = 0; j < count; ++j, pSrc += src_stride, pDst += dst_stride)
+				write_image_descriptor(device, cmd_buffer, 64, pDst, buffer_list + j,
+						       entry->descriptor_type,
 					               (struct VkDescriptorImageInfo *) pSrc);
-				break;
-			case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
-				write_combined_image_sampler_descriptor(device, cmd_buffer, templ->entry[i].sampler_offset,
-									pDst, buffer_list, templ->entry[i].descriptor_type,
+			break;
+		case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+			for (j = 0; j < count; ++j, pSrc += src_stride, pDst += dst_stride) {
+				write_combined_image_sampler_descriptor(device, cmd_buffer, entry->sampler_offset,
+									pDst, buffer_list + j, entry->descriptor_type,
 									(struct VkDescriptorImageInfo *) pSrc,
-									templ->entry[i].has_sampler);
-				if (templ->entry[i].immutable_samplers) {
-					memcpy((char*)pDst + templ->entry[i].sampler_offset, templ->entry[i].immutable_samplers + 4 * j, 16);
+									entry->has_sampler);
+				if (entry->immutable_samplers) {
+					memcpy((char*)pDst + entry->sampler_offset, entry->immutable_samplers + 4 * j, 16);
 				}
-				break;
-			case VK_DESCRIPTOR_TYPE_SAMPLER:
-				if (templ->entry[i].has_sampler)
+			}
+			break;
+		case VK_DESCRIPTOR_TYPE_SAMPLER:
+			if (entry->has_sampler) {
+				for (j = 0; j < count; ++j, pSrc += src_stride, pDst += dst_stride)
 					write_sampler_descriptor(device, pDst,
 					                         (struct VkDescriptorImageInfo *) pSrc);
-				else if (templ->entry[i].immutable_samplers)
-					memcpy(pDst, templ->entry[i].immutable_samplers + 4 * j, 16);
-				break;
-			default:
-				break;
+			} else if (entry->immutable_samplers) {
+				for (j = 0; j < count; ++j, pDst += dst_stride)
+					memcpy(pDst, entry->immutable_samplers + 4 * j, 16);
 			}
-		        pSrc += templ->entry[i].src_stride;
-			pDst += templ->entry[i].dst_stride;
-			++buffer_list;
+			break;
+		default:
+			break;
 		}
 	}
 }
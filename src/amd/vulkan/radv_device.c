@@ -53,6 +53,7 @@ typedef void* drmDevicePtr;
 #include "util/mesa-sha1.h"
 #include "util/timespec.h"
 #include "util/u_atomic.h"
+#include "util/u_cpu_detect.h"
 #include "util/driconf.h"
 
 /* The number of IBs per submit isn't infinite, it depends on the ring type
@@ -312,6 +313,7 @@ radv_get_int_debug_option(const char *name, int default_value)
 static bool radv_thread_trace_enabled()
 {
 	return radv_get_int_debug_option("RADV_THREAD_TRACE", -1) >= 0 ||
+	       radv_get_int_debug_option("RADV_THREAD_TRACE_HITCH", 0) > 0 ||
 	       getenv("RADV_THREAD_TRACE_TRIGGER");
 }
 
@@ -797,6 +799,7 @@ static const struct debug_control radv_debug_options[] = {
 	{"invariantgeom", RADV_DEBUG_INVARIANT_GEOM},
 	{"nodisplaydcc", RADV_DEBUG_NO_DISPLAY_DCC},
 	{"notccompatcmask", RADV_DEBUG_NO_TC_COMPAT_CMASK},
+	{"compiletime", RADV_DEBUG_COMPILE_TIME},
 	{NULL, 0}
 };
 
@@ -2871,6 +2874,24 @@ VkResult radv_CreateDevice(
 	device->overallocation_disallowed = overallocation_disallowed;
 	mtx_init(&device->overallocation_mutex, mtx_plain);
 
+	/* A pipeline has at most one backend compilation per stage, and the
+	 * calling thread takes one of them. Failing to create the threads
+	 * isn't fatal, the stages are then compiled serially.
+	 */
+	util_cpu_detect();
+	unsigned num_compile_threads = MIN2(util_get_cpu_caps()->nr_cpus - 1,
+					    MESA_SHADER_FRAGMENT);
+	if (num_compile_threads &&
+	    !(device->instance->debug_flags & RADV_DEBUG_DUMP_SHADERS)) {
+		util_queue_init(&device->shader_compile_queue, "radv_sh", 32,
+				num_compile_threads,
+				UTIL_QUEUE_INIT_RESIZE_IF_FULL |
+				UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY |
+				UTIL_QUEUE_INIT_SHARED_THREADS);
+	}
+
+	radv_nir_cache_init(device);
+
 	/* Create one context per queue priority. */
 	for (unsigned i = 0; i < pCreateInfo->queueCreateInfoCount; i++) {
 		const VkDeviceQueueCreateInfo *queue_create = &pCreateInfo->pQueueCreateInfos[i];
@@ -3095,6 +3116,11 @@ fail:
 	radv_trap_handler_finish(device);
 	radv_finish_trace(device);
 
+	if (util_queue_is_initialized(&device->shader_compile_queue))
+		util_queue_destroy(&device->shader_compile_queue);
+
+	radv_nir_cache_finish(device);
+
 	if (device->gfx_init)
 		device->ws->buffer_destroy(device->ws, device->gfx_init);
 
@@ -3153,6 +3179,11 @@ void radv_DestroyDevice(
 	radv_trap_handler_finish(device);
 	radv_finish_trace(device);
 
+	if (util_queue_is_initialized(&device->shader_compile_queue))
+		util_queue_destroy(&device->shader_compile_queue);
+
+	radv_nir_cache_finish(device);
+
 	radv_destroy_shader_slabs(device);
 
 	u_cnd_monotonic_destroy(&device->timeline_cond);
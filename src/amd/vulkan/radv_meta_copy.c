@@ -127,8 +127,6 @@ copy_buffer_to_image(struct radv_cmd_buffer *cmd_buffer,
 		     VkImageLayout layout,
 		     const VkBufferImageCopy2KHR* region)
 {
-	struct radv_meta_saved_state saved_state;
-	bool old_predicating;
 	bool cs;
 
 	/* The Vulkan 1.0 spec says "dstImage must have a sample count equal to
@@ -139,18 +137,6 @@ copy_buffer_to_image(struct radv_cmd_buffer *cmd_buffer,
 	cs = cmd_buffer->queue_family_index == RADV_QUEUE_COMPUTE ||
 	     !radv_image_is_renderable(cmd_buffer->device, image);
 
-	radv_meta_save(&saved_state, cmd_buffer,
-		       (cs ? RADV_META_SAVE_COMPUTE_PIPELINE :
-			RADV_META_SAVE_GRAPHICS_PIPELINE) |
-		       RADV_META_SAVE_CONSTANTS |
-		       RADV_META_SAVE_DESCRIPTORS);
-
-	/* VK_EXT_conditional_rendering says that copy commands should not be
-	 * affected by conditional rendering.
-	 */
-	old_predicating = cmd_buffer->state.predicating;
-	cmd_buffer->state.predicating = false;
-
 	/**
 	 * From the Vulkan 1.0.6 spec: 18.3 Copying Data Between Images
 	 *    extent is the size in texels of the source image to copy in width,
@@ -246,11 +232,6 @@ copy_buffer_to_image(struct radv_cmd_buffer *cmd_buffer,
 		else
 			slice_array++;
 	}
-
-	/* Restore conditional rendering. */
-	cmd_buffer->state.predicating = old_predicating;
-
-	radv_meta_restore(&saved_state, cmd_buffer);
 }
 
 void radv_CmdCopyBufferToImage2KHR(
@@ -260,12 +241,36 @@ void radv_CmdCopyBufferToImage2KHR(
 	RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
 	RADV_FROM_HANDLE(radv_buffer, src_buffer, pCopyBufferToImageInfo->srcBuffer);
 	RADV_FROM_HANDLE(radv_image, dst_image, pCopyBufferToImageInfo->dstImage);
+	struct radv_meta_saved_state saved_state;
+	bool old_predicating;
+	bool cs;
+
+	cs = cmd_buffer->queue_family_index == RADV_QUEUE_COMPUTE ||
+	     !radv_image_is_renderable(cmd_buffer->device, dst_image);
+
+	/* The state is saved once for all regions rather than per region. */
+	radv_meta_save(&saved_state, cmd_buffer,
+		       (cs ? RADV_META_SAVE_COMPUTE_PIPELINE :
+			RADV_META_SAVE_GRAPHICS_PIPELINE) |
+		       RADV_META_SAVE_CONSTANTS |
+		       RADV_META_SAVE_DESCRIPTORS);
+
+	/* VK_EXT_conditional_rendering says that copy commands should not be
+	 * affected by conditional rendering.
+	 */
+	old_predicating = cmd_buffer->state.predicating;
+	cmd_buffer->state.predicating = false;
 
 	for (unsigned r = 0; r < pCopyBufferToImageInfo->regionCount; r++) {
 		copy_buffer_to_image(cmd_buffer, src_buffer, dst_image,
 				     pCopyBufferToImageInfo->dstImageLayout,
 				     &pCopyBufferToImageInfo->pRegions[r]);
 	}
+
+	/* Restore conditional rendering. */
+	cmd_buffer->state.predicating = old_predicating;
+
+	radv_meta_restore(&saved_state, cmd_buffer);
 }
 
 static void
@@ -275,20 +280,6 @@ copy_image_to_buffer(struct radv_cmd_buffer *cmd_buffer,
 		     VkImageLayout layout,
 		     const VkBufferImageCopy2KHR *region)
 {
-	struct radv_meta_saved_state saved_state;
-	bool old_predicating;
-
-	radv_meta_save(&saved_state, cmd_buffer,
-		       RADV_META_SAVE_COMPUTE_PIPELINE |
-		       RADV_META_SAVE_CONSTANTS |
-		       RADV_META_SAVE_DESCRIPTORS);
-
-	/* VK_EXT_conditional_rendering says that copy commands should not be
-	 * affected by conditional rendering.
-	 */
-	old_predicating = cmd_buffer->state.predicating;
-	cmd_buffer->state.predicating = false;
-
 	/**
 	 * From the Vulkan 1.0.6 spec: 18.3 Copying Data Between Images
 	 *    extent is the size in texels of the source image to copy in width,
@@ -375,11 +366,6 @@ copy_image_to_buffer(struct radv_cmd_buffer *cmd_buffer,
 		else
 			slice_array++;
 	}
-
-	/* Restore conditional rendering. */
-	cmd_buffer->state.predicating = old_predicating;
-
-	radv_meta_restore(&saved_state, cmd_buffer);
 }
 
 void radv_CmdCopyImageToBuffer2KHR(
@@ -389,12 +375,30 @@ void radv_CmdCopyImageToBuffer2KHR(
 	RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
 	RADV_FROM_HANDLE(radv_image, src_image, pCopyImageToBufferInfo->srcImage);
 	RADV_FROM_HANDLE(radv_buffer, dst_buffer, pCopyImageToBufferInfo->dstBuffer);
+	struct radv_meta_saved_state saved_state;
+	bool old_predicating;
+
+	radv_meta_save(&saved_state, cmd_buffer,
+		       RADV_META_SAVE_COMPUTE_PIPELINE |
+		       RADV_META_SAVE_CONSTANTS |
+		       RADV_META_SAVE_DESCRIPTORS);
+
+	/* VK_EXT_conditional_rendering says that copy commands should not be
+	 * affected by conditional rendering.
+	 */
+	old_predicating = cmd_buffer->state.predicating;
+	cmd_buffer->state.predicating = false;
 
 	for (unsigned r = 0; r < pCopyImageToBufferInfo->regionCount; r++) {
 		copy_image_to_buffer(cmd_buffer, dst_buffer, src_image,
 				     pCopyImageToBufferInfo->srcImageLayout,
 				     &pCopyImageToBufferInfo->pRegions[r]);
 	}
+
+	/* Restore conditional rendering. */
+	cmd_buffer->state.predicating = old_predicating;
+
+	radv_meta_restore(&saved_state, cmd_buffer);
 }
 
 static void
@@ -405,8 +409,6 @@ copy_image(struct radv_cmd_buffer *cmd_buffer,
 	   VkImageLayout dst_image_layout,
 	   const VkImageCopy2KHR *region)
 {
-	struct radv_meta_saved_state saved_state;
-	bool old_predicating;
 	bool cs;
 
 	/* From the Vulkan 1.0 spec:
@@ -419,18 +421,6 @@ copy_image(struct radv_cmd_buffer *cmd_buffer,
 	cs = cmd_buffer->queue_family_index == RADV_QUEUE_COMPUTE ||
 	     !radv_image_is_renderable(cmd_buffer->device, dst_image);
 
-	radv_meta_save(&saved_state, cmd_buffer,
-		       (cs ? RADV_META_SAVE_COMPUTE_PIPELINE :
-			RADV_META_SAVE_GRAPHICS_PIPELINE) |
-		       RADV_META_SAVE_CONSTANTS |
-		       RADV_META_SAVE_DESCRIPTORS);
-
-	/* VK_EXT_conditional_rendering says that copy commands should not be
-	 * affected by conditional rendering.
-	 */
-	old_predicating = cmd_buffer->state.predicating;
-	cmd_buffer->state.predicating = false;
-
 	VkImageAspectFlags src_aspects[3] = {VK_IMAGE_ASPECT_PLANE_0_BIT, VK_IMAGE_ASPECT_PLANE_1_BIT, VK_IMAGE_ASPECT_PLANE_2_BIT};
 	VkImageAspectFlags dst_aspects[3] = {VK_IMAGE_ASPECT_PLANE_0_BIT, VK_IMAGE_ASPECT_PLANE_1_BIT, VK_IMAGE_ASPECT_PLANE_2_BIT};
 	unsigned aspect_count = region->srcSubresource.aspectMask == VK_IMAGE_ASPECT_COLOR_BIT ? src_image->plane_count : 1;
@@ -545,11 +535,6 @@ copy_image(struct radv_cmd_buffer *cmd_buffer,
 				slice_array++;
 		}
 	}
-
-	/* Restore conditional rendering. */
-	cmd_buffer->state.predicating = old_predicating;
-
-	radv_meta_restore(&saved_state, cmd_buffer);
 }
 
 void radv_CmdCopyImage2KHR(
@@ -559,6 +544,24 @@ void radv_CmdCopyImage2KHR(
 	RADV_FROM_HANDLE(radv_cmd_buffer, cmd_buffer, commandBuffer);
 	RADV_FROM_HANDLE(radv_image, src_image, pCopyImageInfo->srcImage);
 	RADV_FROM_HANDLE(radv_image, dst_image, pCopyImageInfo->dstImage);
+	struct radv_meta_saved_state saved_state;
+	bool old_predicating;
+	bool cs;
+
+	cs = cmd_buffer->queue_family_index == RADV_QUEUE_COMPUTE ||
+	     !radv_image_is_renderable(cmd_buffer->device, dst_image);
+
+	radv_meta_save(&saved_state, cmd_buffer,
+		       (cs ? RADV_META_SAVE_COMPUTE_PIPELINE :
+			RADV_META_SAVE_GRAPHICS_PIPELINE) |
+		       RADV_META_SAVE_CONSTANTS |
+		       RADV_META_SAVE_DESCRIPTORS);
+
+	/* VK_EXT_conditional_rendering says that copy commands should not be
+	 * affected by conditional rendering.
+	 */
+	old_predicating = cmd_buffer->state.predicating;
+	cmd_buffer->state.predicating = false;
 
 	for (unsigned r = 0; r < pCopyImageInfo->regionCount; r++) {
 		copy_image(cmd_buffer,
@@ -566,4 +569,9 @@ void radv_CmdCopyImage2KHR(
 			   dst_image, pCopyImageInfo->dstImageLayout,
 			   &pCopyImageInfo->pRegions[r]);
 	}
+
+	/* Restore conditional rendering. */
+	cmd_buffer->state.predicating = old_predicating;
+
+	radv_meta_restore(&saved_state, cmd_buffer);
 }
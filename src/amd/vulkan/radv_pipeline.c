@@ -3123,6 +3123,75 @@ void radv_stop_feedback(VkPipelineCreationFeedbackEXT *feedback, bool cache_hit)
 	                   (cache_hit ? VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT : 0);
 }
 
+/* The backend compilation of one hardware stage of a pipeline. */
+struct radv_shader_compile_job {
+	struct radv_device *device;
+	struct vk_shader_module *module;
+	struct nir_shader *nir[2];
+	int nir_count;
+	struct radv_pipeline_layout *layout;
+	struct radv_shader_variant_key key;
+	struct radv_shader_info *info;
+	bool keep_executable_info;
+	bool keep_statistic_info;
+	bool disable_optimizations;
+	VkPipelineCreationFeedbackEXT *feedback;
+	struct radv_shader_variant **variant;
+	struct radv_shader_binary **binary;
+	struct util_queue_fence fence;
+};
+
+static void
+radv_shader_compile_job_execute(void *data, UNUSED int thread_index)
+{
+	struct radv_shader_compile_job *job = data;
+
+	radv_start_feedback(job->feedback);
+
+	*job->variant = radv_shader_variant_compile(job->device, job->module,
+						    job->nir, job->nir_count,
+						    job->layout, &job->key, job->info,
+						    job->keep_executable_info,
+						    job->keep_statistic_info,
+						    job->disable_optimizations,
+						    job->binary);
+
+	radv_stop_feedback(job->feedback, false);
+}
+
+/* The stages only share read-only state after linking, so they can be
+ * compiled concurrently. The calling thread compiles the first one.
+ * LLVM is only used from the calling thread, because it keeps a compiler
+ * per thread.
+ */
+static void
+radv_execute_shader_compile_jobs(struct radv_device *device,
+				 struct radv_shader_compile_job *jobs,
+				 unsigned num_jobs)
+{
+	if (num_jobs < 2 ||
+	    !util_queue_is_initialized(&device->shader_compile_queue) ||
+	    radv_use_llvm_for_stage(device, MESA_SHADER_VERTEX)) {
+		for (unsigned i = 0; i < num_jobs; i++)
+			radv_shader_compile_job_execute(&jobs[i], 0);
+		return;
+	}
+
+	for (unsigned i = 1; i < num_jobs; i++) {
+		util_queue_fence_init(&jobs[i].fence);
+		util_queue_add_job(&device->shader_compile_queue, &jobs[i],
+				   &jobs[i].fence, radv_shader_compile_job_execute,
+				   NULL, 0);
+	}
+
+	radv_shader_compile_job_execute(&jobs[0], 0);
+
+	for (unsigned i = 1; i < num_jobs; i++) {
+		util_queue_fence_wait(&jobs[i].fence);
+		util_queue_fence_destroy(&jobs[i].fence);
+	}
+}
+
 static bool
 mem_vectorize_callback(unsigned align_mul, unsigned align_offset,
                        unsigned bit_size,
@@ -3587,19 +3656,31 @@ VkResult radv_create_shaders(struct radv_pipeline *pipeline,
 		free(gs_copy_binary);
 	}
 
+	struct radv_shader_compile_job jobs[MESA_SHADER_STAGES];
+	unsigned num_jobs = 0;
+
+#define ADD_JOB(stage, first_nir, nir_cnt, job_key) do { \
+		struct radv_shader_compile_job *job = &jobs[num_jobs++]; \
+		memset(job, 0, sizeof(*job)); \
+		job->device = device; \
+		job->module = modules[stage]; \
+		memcpy(job->nir, first_nir, (nir_cnt) * sizeof(job->nir[0])); \
+		job->nir_count = nir_cnt; \
+		job->layout = pipeline->layout; \
+		job->key = job_key; \
+		job->info = &infos[stage]; \
+		job->keep_executable_info = keep_executable_info; \
+		job->keep_statistic_info = keep_statistic_info; \
+		job->disable_optimizations = disable_optimizations; \
+		job->feedback = stage_feedbacks[stage]; \
+		job->variant = &pipeline->shaders[stage]; \
+		job->binary = &binaries[stage]; \
+	} while (0)
+
 	if (nir[MESA_SHADER_FRAGMENT]) {
 		if (!pipeline->shaders[MESA_SHADER_FRAGMENT]) {
-			radv_start_feedback(stage_feedbacks[MESA_SHADER_FRAGMENT]);
-
-			pipeline->shaders[MESA_SHADER_FRAGMENT] =
-			       radv_shader_variant_compile(device, modules[MESA_SHADER_FRAGMENT], &nir[MESA_SHADER_FRAGMENT], 1,
-			                                  pipeline->layout, keys + MESA_SHADER_FRAGMENT,
-							  infos + MESA_SHADER_FRAGMENT,
-			                                  keep_executable_info, keep_statistic_info,
-							  disable_optimizations,
-							  &binaries[MESA_SHADER_FRAGMENT]);
-
-			radv_stop_feedback(stage_feedbacks[MESA_SHADER_FRAGMENT], false);
+			ADD_JOB(MESA_SHADER_FRAGMENT, &nir[MESA_SHADER_FRAGMENT], 1,
+				keys[MESA_SHADER_FRAGMENT]);
 		}
 	}
 
@@ -3609,16 +3690,7 @@ VkResult radv_create_shaders(struct radv_pipeline *pipeline,
 			struct radv_shader_variant_key key = keys[MESA_SHADER_TESS_CTRL];
 			key.tcs.vs_key = keys[MESA_SHADER_VERTEX].vs;
 
-			radv_start_feedback(stage_feedbacks[MESA_SHADER_TESS_CTRL]);
-
-			pipeline->shaders[MESA_SHADER_TESS_CTRL] = radv_shader_variant_compile(device, modules[MESA_SHADER_TESS_CTRL], combined_nir, 2,
-			                                                                      pipeline->layout,
-			                                                                      &key, &infos[MESA_SHADER_TESS_CTRL], keep_executable_info,
-			                                                                      keep_statistic_info,
-											      disable_optimizations,
-											      &binaries[MESA_SHADER_TESS_CTRL]);
-
-			radv_stop_feedback(stage_feedbacks[MESA_SHADER_TESS_CTRL], false);
+			ADD_JOB(MESA_SHADER_TESS_CTRL, combined_nir, 2, key);
 		}
 		modules[MESA_SHADER_VERTEX] = NULL;
 	}
@@ -3628,34 +3700,21 @@ VkResult radv_create_shaders(struct radv_pipeline *pipeline,
 		if (!pipeline->shaders[MESA_SHADER_GEOMETRY]) {
 			struct nir_shader *combined_nir[] = {nir[pre_stage], nir[MESA_SHADER_GEOMETRY]};
 
-			radv_start_feedback(stage_feedbacks[MESA_SHADER_GEOMETRY]);
-
-			pipeline->shaders[MESA_SHADER_GEOMETRY] = radv_shader_variant_compile(device, modules[MESA_SHADER_GEOMETRY], combined_nir, 2,
-			                                                                     pipeline->layout,
-			                                                                     &keys[pre_stage], &infos[MESA_SHADER_GEOMETRY], keep_executable_info,
-			                                                                     keep_statistic_info,
-											     disable_optimizations,
-											     &binaries[MESA_SHADER_GEOMETRY]);
-
-			radv_stop_feedback(stage_feedbacks[MESA_SHADER_GEOMETRY], false);
+			ADD_JOB(MESA_SHADER_GEOMETRY, combined_nir, 2, keys[pre_stage]);
 		}
 		modules[pre_stage] = NULL;
 	}
 
 	for (int i = 0; i < MESA_SHADER_STAGES; ++i) {
-		if(modules[i] && !pipeline->shaders[i]) {
-			radv_start_feedback(stage_feedbacks[i]);
-
-			pipeline->shaders[i] = radv_shader_variant_compile(device, modules[i], &nir[i], 1,
-									  pipeline->layout,
-									  keys + i, infos + i, keep_executable_info,
-									  keep_statistic_info,
-									  disable_optimizations,
-									  &binaries[i]);
-
-			radv_stop_feedback(stage_feedbacks[i], false);
+		if(modules[i] && !pipeline->shaders[i] &&
+		   /* the fragment shader job was added above */
+		   i != MESA_SHADER_FRAGMENT) {
+			ADD_JOB(i, &nir[i], 1, keys[i]);
 		}
 	}
+#undef ADD_JOB
+
+	radv_execute_shader_compile_jobs(device, jobs, num_jobs);
 
 	if (!keep_executable_info) {
 		radv_pipeline_cache_insert_shaders(device, cache, hash, pipeline->shaders,
@@ -43,22 +43,41 @@ struct cache_entry {
 	char code[0];
 };
 
+static struct radv_pipeline_cache_shard *
+radv_pipeline_cache_get_shard(struct radv_pipeline_cache *cache,
+			      const unsigned char *sha1)
+{
+	/* The first dword selects the slot within the shard. */
+	const uint32_t dw1 = ((const uint32_t *) sha1)[1];
+
+	return &cache->shards[dw1 % RADV_PIPELINE_CACHE_NUM_SHARDS];
+}
+
 static void
-radv_pipeline_cache_lock(struct radv_pipeline_cache *cache)
+radv_pipeline_cache_lock(struct radv_pipeline_cache *cache,
+			 struct radv_pipeline_cache_shard *shard)
 {
 	if (cache->flags & VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT_EXT)
 		return;
 
-	mtx_lock(&cache->mutex);
+	mtx_lock(&shard->mutex);
 }
 
 static void
-radv_pipeline_cache_unlock(struct radv_pipeline_cache *cache)
+radv_pipeline_cache_unlock(struct radv_pipeline_cache *cache,
+			   struct radv_pipeline_cache_shard *shard)
 {
 	if (cache->flags & VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT_EXT)
 		return;
 
-	mtx_unlock(&cache->mutex);
+	mtx_unlock(&shard->mutex);
+}
+
+static void
+radv_pipeline_cache_unlock_all(struct radv_pipeline_cache *cache)
+{
+	for (unsigned i = 0; i < RADV_PIPELINE_CACHE_NUM_SHARDS; i++)
+		radv_pipeline_cache_unlock(cache, &cache->shards[i]);
 }
 
 void
@@ -66,40 +85,49 @@ radv_pipeline_cache_init(struct radv_pipeline_cache *cache,
 			 struct radv_device *device)
 {
 	cache->device = device;
-	mtx_init(&cache->mutex, mtx_plain);
 	cache->flags = 0;
 
 	cache->modified = false;
-	cache->kernel_count = 0;
 	cache->total_size = 0;
-	cache->table_size = 1024;
-	const size_t byte_size = cache->table_size * sizeof(cache->hash_table[0]);
-	cache->hash_table = malloc(byte_size);
-
-	/* We don't consider allocation failure fatal, we just start with a 0-sized
-	 * cache. Disable caching when we want to keep shader debug info, since
-	 * we don't get the debug info on cached shaders. */
-	if (cache->hash_table == NULL ||
-	    (device->instance->debug_flags & RADV_DEBUG_NO_CACHE))
-		cache->table_size = 0;
-	else
-		memset(cache->hash_table, 0, byte_size);
+
+	for (unsigned i = 0; i < RADV_PIPELINE_CACHE_NUM_SHARDS; i++) {
+		struct radv_pipeline_cache_shard *shard = &cache->shards[i];
+
+		mtx_init(&shard->mutex, mtx_plain);
+		shard->kernel_count = 0;
+		shard->table_size = 1024 / RADV_PIPELINE_CACHE_NUM_SHARDS;
+		const size_t byte_size = shard->table_size * sizeof(shard->hash_table[0]);
+		shard->hash_table = malloc(byte_size);
+
+		/* We don't consider allocation failure fatal, we just start with a 0-sized
+		 * cache. Disable caching when we want to keep shader debug info, since
+		 * we don't get the debug info on cached shaders. */
+		if (shard->hash_table == NULL ||
+		    (device->instance->debug_flags & RADV_DEBUG_NO_CACHE))
+			shard->table_size = 0;
+		else
+			memset(shard->hash_table, 0, byte_size);
+	}
 }
 
 void
 radv_pipeline_cache_finish(struct radv_pipeline_cache *cache)
 {
-	for (unsigned i = 0; i < cache->table_size; ++i)
-		if (cache->hash_table[i]) {
-			for(int j = 0; j < MESA_SHADER_STAGES; ++j)  {
-				if (cache->hash_table[i]->variants[j])
-					radv_shader_variant_destroy(cache->device,
-								    cache->hash_table[i]->variants[j]);
+	for (unsigned s = 0; s < RADV_PIPELINE_CACHE_NUM_SHARDS; s++) {
+		struct radv_pipeline_cache_shard *shard = &cache->shards[s];
+
+		for (unsigned i = 0; i < shard->table_size; ++i)
+			if (shard->hash_table[i]) {
+				for(int j = 0; j < MESA_SHADER_STAGES; ++j)  {
+					if (shard->hash_table[i]->variants[j])
+						radv_shader_variant_destroy(cache->device,
+									    shard->hash_table[i]->variants[j]);
+				}
+				vk_free(&cache->alloc, shard->hash_table[i]);
 			}
-			vk_free(&cache->alloc, cache->hash_table[i]);
-		}
-	mtx_destroy(&cache->mutex);
-	free(cache->hash_table);
+		mtx_destroy(&shard->mutex);
+		free(shard->hash_table);
+	}
 }
 
 static uint32_t
@@ -148,18 +176,18 @@ radv_hash_shaders(unsigned char *hash,
 
 
 static struct cache_entry *
-radv_pipeline_cache_search_unlocked(struct radv_pipeline_cache *cache,
+radv_pipeline_cache_search_unlocked(struct radv_pipeline_cache_shard *shard,
 				    const unsigned char *sha1)
 {
-	const uint32_t mask = cache->table_size - 1;
+	const uint32_t mask = shard->table_size - 1;
 	const uint32_t start = (*(uint32_t *) sha1);
 
-	if (cache->table_size == 0)
+	if (shard->table_size == 0)
 		return NULL;
 
-	for (uint32_t i = 0; i < cache->table_size; i++) {
+	for (uint32_t i = 0; i < shard->table_size; i++) {
 		const uint32_t index = (start + i) & mask;
-		struct cache_entry *entry = cache->hash_table[index];
+		struct cache_entry *entry = shard->hash_table[index];
 
 		if (!entry)
 			return NULL;
@@ -176,65 +204,65 @@ static struct cache_entry *
 radv_pipeline_cache_search(struct radv_pipeline_cache *cache,
 			   const unsigned char *sha1)
 {
+	struct radv_pipeline_cache_shard *shard = radv_pipeline_cache_get_shard(cache, sha1);
 	struct cache_entry *entry;
 
-	radv_pipeline_cache_lock(cache);
+	radv_pipeline_cache_lock(cache, shard);
 
-	entry = radv_pipeline_cache_search_unlocked(cache, sha1);
+	entry = radv_pipeline_cache_search_unlocked(shard, sha1);
 
-	radv_pipeline_cache_unlock(cache);
+	radv_pipeline_cache_unlock(cache, shard);
 
 	return entry;
 }
 
 static void
-radv_pipeline_cache_set_entry(struct radv_pipeline_cache *cache,
+radv_pipeline_cache_set_entry(struct radv_pipeline_cache_shard *shard,
 			      struct cache_entry *entry)
 {
-	const uint32_t mask = cache->table_size - 1;
+	const uint32_t mask = shard->table_size - 1;
 	const uint32_t start = entry->sha1_dw[0];
 
 	/* We'll always be able to insert when we get here. */
-	assert(cache->kernel_count < cache->table_size / 2);
+	assert(shard->kernel_count < shard->table_size / 2);
 
-	for (uint32_t i = 0; i < cache->table_size; i++) {
+	for (uint32_t i = 0; i < shard->table_size; i++) {
 		const uint32_t index = (start + i) & mask;
-		if (!cache->hash_table[index]) {
-			cache->hash_table[index] = entry;
+		if (!shard->hash_table[index]) {
+			shard->hash_table[index] = entry;
 			break;
 		}
 	}
 
-	cache->total_size += entry_size(entry);
-	cache->kernel_count++;
+	shard->kernel_count++;
 }
 
 
 static VkResult
-radv_pipeline_cache_grow(struct radv_pipeline_cache *cache)
+radv_pipeline_cache_grow(struct radv_pipeline_cache *cache,
+			 struct radv_pipeline_cache_shard *shard)
 {
-	const uint32_t table_size = cache->table_size * 2;
-	const uint32_t old_table_size = cache->table_size;
-	const size_t byte_size = table_size * sizeof(cache->hash_table[0]);
+	const uint32_t table_size = shard->table_size * 2;
+	const uint32_t old_table_size = shard->table_size;
+	const size_t byte_size = table_size * sizeof(shard->hash_table[0]);
 	struct cache_entry **table;
-	struct cache_entry **old_table = cache->hash_table;
+	struct cache_entry **old_table = shard->hash_table;
 
 	table = malloc(byte_size);
 	if (table == NULL)
 		return vk_error(cache->device->instance, VK_ERROR_OUT_OF_HOST_MEMORY);
 
-	cache->hash_table = table;
-	cache->table_size = table_size;
-	cache->kernel_count = 0;
-	cache->total_size = 0;
+	shard->hash_table = table;
+	shard->table_size = table_size;
+	shard->kernel_count = 0;
 
-	memset(cache->hash_table, 0, byte_size);
+	memset(shard->hash_table, 0, byte_size);
 	for (uint32_t i = 0; i < old_table_size; i++) {
 		struct cache_entry *entry = old_table[i];
 		if (!entry)
 			continue;
 
-		radv_pipeline_cache_set_entry(cache, entry);
+		radv_pipeline_cache_set_entry(shard, entry);
 	}
 
 	free(old_table);
@@ -242,18 +270,24 @@ radv_pipeline_cache_grow(struct radv_pipeline_cache *cache)
 	return VK_SUCCESS;
 }
 
+/* The shard of the entry must be locked by the caller. */
 static void
 radv_pipeline_cache_add_entry(struct radv_pipeline_cache *cache,
 			      struct cache_entry *entry)
 {
-	if (cache->kernel_count == cache->table_size / 2)
-		radv_pipeline_cache_grow(cache);
+	struct radv_pipeline_cache_shard *shard =
+		radv_pipeline_cache_get_shard(cache, entry->sha1);
+
+	if (shard->kernel_count == shard->table_size / 2)
+		radv_pipeline_cache_grow(cache, shard);
 
 	/* Failing to grow that hash table isn't fatal, but may mean we don't
 	 * have enough space to add this new kernel. Only add it if there's room.
 	 */
-	if (cache->kernel_count < cache->table_size / 2)
-		radv_pipeline_cache_set_entry(cache, entry);
+	if (shard->kernel_count < shard->table_size / 2) {
+		radv_pipeline_cache_set_entry(shard, entry);
+		p_atomic_add(&cache->total_size, entry_size(entry));
+	}
 }
 
 static bool
@@ -279,9 +313,11 @@ radv_create_shader_variants_from_pipeline_cache(struct radv_device *device,
 		*found_in_application_cache = false;
 	}
 
-	radv_pipeline_cache_lock(cache);
+	struct radv_pipeline_cache_shard *shard = radv_pipeline_cache_get_shard(cache, sha1);
+
+	radv_pipeline_cache_lock(cache, shard);
 
-	entry = radv_pipeline_cache_search_unlocked(cache, sha1);
+	entry = radv_pipeline_cache_search_unlocked(shard, sha1);
 
 	if (!entry) {
 		*found_in_application_cache = false;
@@ -290,7 +326,7 @@ radv_create_shader_variants_from_pipeline_cache(struct radv_device *device,
 		 * present in the cache.
 		 */
 		if (radv_is_cache_disabled(device) || !device->physical_device->disk_cache) {
-			radv_pipeline_cache_unlock(cache);
+			radv_pipeline_cache_unlock(cache, shard);
 			return false;
 		}
 
@@ -302,7 +338,7 @@ radv_create_shader_variants_from_pipeline_cache(struct radv_device *device,
 			disk_cache_get(device->physical_device->disk_cache,
 				       disk_sha1, NULL);
 		if (!entry) {
-			radv_pipeline_cache_unlock(cache);
+			radv_pipeline_cache_unlock(cache, shard);
 			return false;
 		} else {
 			size_t size = entry_size(entry);
@@ -310,7 +346,7 @@ radv_create_shader_variants_from_pipeline_cache(struct radv_device *device,
 								 VK_SYSTEM_ALLOCATION_SCOPE_CACHE);
 			if (!new_entry) {
 				free(entry);
-				radv_pipeline_cache_unlock(cache);
+				radv_pipeline_cache_unlock(cache, shard);
 				return false;
 			}
 
@@ -350,7 +386,7 @@ radv_create_shader_variants_from_pipeline_cache(struct radv_device *device,
 				p_atomic_inc(&entry->variants[i]->ref_count);
 	}
 
-	radv_pipeline_cache_unlock(cache);
+	radv_pipeline_cache_unlock(cache, shard);
 	return true;
 }
 
@@ -364,8 +400,10 @@ radv_pipeline_cache_insert_shaders(struct radv_device *device,
 	if (!cache)
 		cache = device->mem_cache;
 
-	radv_pipeline_cache_lock(cache);
-	struct cache_entry *entry = radv_pipeline_cache_search_unlocked(cache, sha1);
+	struct radv_pipeline_cache_shard *shard = radv_pipeline_cache_get_shard(cache, sha1);
+
+	radv_pipeline_cache_lock(cache, shard);
+	struct cache_entry *entry = radv_pipeline_cache_search_unlocked(shard, sha1);
 	if (entry) {
 		for (int i = 0; i < MESA_SHADER_STAGES; ++i) {
 			if (entry->variants[i]) {
@@ -377,7 +415,7 @@ radv_pipeline_cache_insert_shaders(struct radv_device *device,
 			if (variants[i])
 				p_atomic_inc(&variants[i]->ref_count);
 		}
-		radv_pipeline_cache_unlock(cache);
+		radv_pipeline_cache_unlock(cache, shard);
 		return;
 	}
 
@@ -385,7 +423,7 @@ radv_pipeline_cache_insert_shaders(struct radv_device *device,
 	 * present in the cache.
 	 */
 	if (radv_is_cache_disabled(device)) {
-		radv_pipeline_cache_unlock(cache);
+		radv_pipeline_cache_unlock(cache, shard);
 		return;
 	}
 
@@ -399,7 +437,7 @@ radv_pipeline_cache_insert_shaders(struct radv_device *device,
 	entry = vk_alloc(&cache->alloc, size, 8,
 			   VK_SYSTEM_ALLOCATION_SCOPE_CACHE);
 	if (!entry) {
-		radv_pipeline_cache_unlock(cache);
+		radv_pipeline_cache_unlock(cache, shard);
 		return;
 	}
 
@@ -439,7 +477,7 @@ radv_pipeline_cache_insert_shaders(struct radv_device *device,
 	if (device->instance->debug_flags & RADV_DEBUG_NO_MEMORY_CACHE &&
 	    cache == device->mem_cache) {
 		vk_free2(&cache->alloc, NULL, entry);
-		radv_pipeline_cache_unlock(cache);
+		radv_pipeline_cache_unlock(cache, shard);
 		return;
 	}
 
@@ -457,7 +495,7 @@ radv_pipeline_cache_insert_shaders(struct radv_device *device,
 	radv_pipeline_cache_add_entry(cache, entry);
 
 	cache->modified = true;
-	radv_pipeline_cache_unlock(cache);
+	radv_pipeline_cache_unlock(cache, shard);
 	return;
 }
 
@@ -572,16 +610,17 @@ VkResult radv_GetPipelineCacheData(
 	struct vk_pipeline_cache_header *header;
 	VkResult result = VK_SUCCESS;
 
-	radv_pipeline_cache_lock(cache);
+	for (unsigned s = 0; s < RADV_PIPELINE_CACHE_NUM_SHARDS; s++)
+		radv_pipeline_cache_lock(cache, &cache->shards[s]);
 
 	const size_t size = sizeof(*header) + cache->total_size;
 	if (pData == NULL) {
-		radv_pipeline_cache_unlock(cache);
+		radv_pipeline_cache_unlock_all(cache);
 		*pDataSize = size;
 		return VK_SUCCESS;
 	}
 	if (*pDataSize < sizeof(*header)) {
-		radv_pipeline_cache_unlock(cache);
+		radv_pipeline_cache_unlock_all(cache);
 		*pDataSize = 0;
 		return VK_INCOMPLETE;
 	}
@@ -595,24 +634,28 @@ VkResult radv_GetPipelineCacheData(
 	p = (char *)p + header->header_size;
 
 	struct cache_entry *entry;
-	for (uint32_t i = 0; i < cache->table_size; i++) {
-		if (!cache->hash_table[i])
-			continue;
-		entry = cache->hash_table[i];
-		const uint32_t size_of_entry = entry_size(entry);
-		if ((char *)end < (char *)p + size_of_entry) {
-			result = VK_INCOMPLETE;
-			break;
-		}
+	for (unsigned s = 0; s < RADV_PIPELINE_CACHE_NUM_SHARDS && result == VK_SUCCESS; s++) {
+		struct radv_pipeline_cache_shard *shard = &cache->shards[s];
+
+		for (uint32_t i = 0; i < shard->table_size; i++) {
+			if (!shard->hash_table[i])
+				continue;
+			entry = shard->hash_table[i];
+			const uint32_t size_of_entry = entry_size(entry);
+			if ((char *)end < (char *)p + size_of_entry) {
+				result = VK_INCOMPLETE;
+				break;
+			}
 
-		memcpy(p, entry, size_of_entry);
-		for(int j = 0; j < MESA_SHADER_STAGES; ++j)
-			((struct cache_entry*)p)->variants[j] = NULL;
-		p = (char *)p + size_of_entry;
+			memcpy(p, entry, size_of_entry);
+			for(int j = 0; j < MESA_SHADER_STAGES; ++j)
+				((struct cache_entry*)p)->variants[j] = NULL;
+			p = (char *)p + size_of_entry;
+		}
 	}
 	*pDataSize = (char *)p - (char *)pData;
 
-	radv_pipeline_cache_unlock(cache);
+	radv_pipeline_cache_unlock_all(cache);
 	return result;
 }
 
@@ -620,14 +663,18 @@ static void
 radv_pipeline_cache_merge(struct radv_pipeline_cache *dst,
 			  struct radv_pipeline_cache *src)
 {
-	for (uint32_t i = 0; i < src->table_size; i++) {
-		struct cache_entry *entry = src->hash_table[i];
-		if (!entry || radv_pipeline_cache_search(dst, entry->sha1))
-			continue;
+	for (unsigned s = 0; s < RADV_PIPELINE_CACHE_NUM_SHARDS; s++) {
+		struct radv_pipeline_cache_shard *shard = &src->shards[s];
+
+		for (uint32_t i = 0; i < shard->table_size; i++) {
+			struct cache_entry *entry = shard->hash_table[i];
+			if (!entry || radv_pipeline_cache_search(dst, entry->sha1))
+				continue;
 
-		radv_pipeline_cache_add_entry(dst, entry);
+			radv_pipeline_cache_add_entry(dst, entry);
 
-		src->hash_table[i] = NULL;
+			shard->hash_table[i] = NULL;
+		}
 	}
 }
 
@@ -53,6 +53,7 @@
 #include "util/macros.h"
 #include "util/list.h"
 #include "util/rwlock.h"
+#include "util/u_queue.h"
 #include "util/xmlconfig.h"
 #include "vk_alloc.h"
 #include "vk_debug_report.h"
@@ -338,16 +339,25 @@ void radv_finish_wsi(struct radv_physical_device *physical_device);
 
 struct cache_entry;
 
+/* The entries are spread over several hash tables with their own locks,
+ * so that threads creating pipelines concurrently rarely contend.
+ */
+#define RADV_PIPELINE_CACHE_NUM_SHARDS 16
+
+struct radv_pipeline_cache_shard {
+	mtx_t                                        mutex;
+	uint32_t                                     table_size;
+	uint32_t                                     kernel_count;
+	struct cache_entry **                        hash_table;
+};
+
 struct radv_pipeline_cache {
 	struct vk_object_base                        base;
 	struct radv_device *                         device;
-	mtx_t                                        mutex;
 	VkPipelineCacheCreateFlags                   flags;
 
 	uint32_t                                     total_size;
-	uint32_t                                     table_size;
-	uint32_t                                     kernel_count;
-	struct cache_entry **                        hash_table;
+	struct radv_pipeline_cache_shard             shards[RADV_PIPELINE_CACHE_NUM_SHARDS];
 	bool                                         modified;
 
 	VkAllocationCallbacks                        alloc;
@@ -820,6 +830,14 @@ struct radv_device {
 	uint64_t allocated_memory_size[VK_MAX_MEMORY_HEAPS];
 	mtx_t overallocation_mutex;
 
+	/* Threads compiling the stages of a pipeline in parallel. */
+	struct util_queue shader_compile_queue;
+
+	/* Optimized NIR of the stages compiled so far, see radv_shader.c. */
+	struct hash_table *nir_cache;
+	mtx_t nir_cache_mutex;
+	size_t nir_cache_size;
+
 	/* Track the number of device loss occurs. */
 	int lost;
 };
@@ -1380,6 +1398,10 @@ struct radv_cmd_pool {
 	struct list_head                             cmd_buffers;
 	struct list_head                             free_cmd_buffers;
 	uint32_t queue_family_index;
+
+	/* Upload BOs of reset command buffers, for reuse by the others. */
+	struct list_head                             upload_bos;
+	unsigned                                     num_upload_bos;
 };
 
 struct radv_cmd_buffer_upload {
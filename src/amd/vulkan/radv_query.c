@@ -1429,11 +1429,24 @@ void radv_CmdResetQueryPool(
 	 */
 	cmd_buffer->state.flush_bits |= cmd_buffer->active_query_flush_bits;
 
+	uint64_t reset_size = queryCount * pool->stride;
+
+	/* When the whole pool is reset, the pipeline statistics availability
+	 * dwords directly follow the results, so clear both with one fill.
+	 */
+	bool reset_availability =
+		pool->type == VK_QUERY_TYPE_PIPELINE_STATISTICS;
+	if (reset_availability && firstQuery == 0 &&
+	    reset_size == pool->availability_offset) {
+		reset_size += queryCount * 4;
+		reset_availability = false;
+	}
+
 	flush_bits |= radv_fill_buffer(cmd_buffer, NULL, pool->bo,
 				       firstQuery * pool->stride,
-				       queryCount * pool->stride, value);
+				       reset_size, value);
 
-	if (pool->type == VK_QUERY_TYPE_PIPELINE_STATISTICS) {
+	if (reset_availability) {
 		flush_bits |= radv_fill_buffer(cmd_buffer, NULL, pool->bo,
 					       pool->availability_offset + firstQuery * 4,
 					       queryCount * 4, 0);
@@ -1454,13 +1467,13 @@ void radv_ResetQueryPool(
 {
 	RADV_FROM_HANDLE(radv_query_pool, pool, queryPool);
 
-	uint32_t value = pool->type == VK_QUERY_TYPE_TIMESTAMP
-			 ? (uint32_t)TIMESTAMP_NOT_READY : 0;
-	uint32_t *data =  (uint32_t*)(pool->ptr + firstQuery * pool->stride);
-	uint32_t *data_end = (uint32_t*)(pool->ptr + (firstQuery + queryCount) * pool->stride);
+	/* TIMESTAMP_NOT_READY is all ones, so every reset value is a repeated
+	 * byte and a single memset covers the whole range.
+	 */
+	int value = pool->type == VK_QUERY_TYPE_TIMESTAMP ? 0xff : 0;
 
-	for(uint32_t *p = data; p != data_end; ++p)
-		*p = value;
+	memset(pool->ptr + firstQuery * pool->stride, value,
+	       queryCount * pool->stride);
 
 	if (pool->type == VK_QUERY_TYPE_PIPELINE_STATISTICS) {
 		memset(pool->ptr + pool->availability_offset + firstQuery * 4,
@@ -25,6 +25,7 @@
  * IN THE SOFTWARE.
  */
 
+#include "util/hash_table.h"
 #include "util/memstream.h"
 #include "util/mesa-sha1.h"
 #include "util/u_atomic.h"
@@ -35,6 +36,7 @@
 #include "radv_shader_args.h"
 #include "nir/nir.h"
 #include "nir/nir_builder.h"
+#include "nir/nir_serialize.h"
 #include "spirv/nir_spirv.h"
 
 #include "sid.h"
@@ -47,6 +49,32 @@
 #include "util/debug.h"
 #include "ac_exp_param.h"
 
+static unsigned
+radv_nir_instr_cost(const nir_instr *instr, unsigned default_cost)
+{
+	if (instr->type != nir_instr_type_alu)
+		return default_cost;
+
+	const nir_alu_instr *alu = nir_instr_as_alu(instr);
+	switch (alu->op) {
+	case nir_op_idiv:
+	case nir_op_udiv:
+	case nir_op_imod:
+	case nir_op_umod:
+	case nir_op_irem:
+		/* Lowered by nir_lower_idiv() to a long sequence. */
+		if (nir_dest_bit_size(alu->dest.dest) < 64)
+			return 16;
+		return default_cost;
+	case nir_op_fsin:
+	case nir_op_fcos:
+		/* The source needs to be scaled by 1/(2*pi) first. */
+		return 2;
+	default:
+		return default_cost;
+	}
+}
+
 static const struct nir_shader_compiler_options nir_options = {
 	.vertex_id_zero_based = true,
 	.lower_scmp = true,
@@ -85,6 +113,7 @@ static const struct nir_shader_compiler_options nir_options = {
 	.use_scoped_barrier = true,
 	.max_unroll_iterations = 32,
 	.max_unroll_iterations_aggressive = 128,
+	.instr_cost_cb = radv_nir_instr_cost,
 	.use_interpolated_input_intrinsics = true,
 	.vectorize_vec2_16bit = true,
 	/* nir_lower_int64() isn't actually called for the LLVM backend, but
@@ -135,13 +164,18 @@ radv_optimize_nir(const struct radv_device *device, struct nir_shader *shader,
                 (shader->options->lower_flrp32 ? 32 : 0) |
                 (shader->options->lower_flrp64 ? 64 : 0);
 
+        /* Passes which didn't make progress since the shader last changed. */
+        struct set *skip = _mesa_pointer_set_create(NULL);
+        /* Progress of the lowering passes doesn't require another iteration. */
+        UNUSED bool lower_progress = false;
+
         do {
                 progress = false;
 
-		NIR_PASS(progress, shader, nir_split_array_vars, nir_var_function_temp);
-		NIR_PASS(progress, shader, nir_shrink_vec_array_vars, nir_var_function_temp);
+		NIR_LOOP_PASS(progress, skip, shader, nir_split_array_vars, nir_var_function_temp);
+		NIR_LOOP_PASS(progress, skip, shader, nir_shrink_vec_array_vars, nir_var_function_temp);
 
-                NIR_PASS_V(shader, nir_lower_vars_to_ssa);
+                NIR_LOOP_PASS(lower_progress, skip, shader, nir_lower_vars_to_ssa);
 
 		if (allow_copies) {
 			/* Only run this pass in the first call to
@@ -149,33 +183,36 @@ radv_optimize_nir(const struct radv_device *device, struct nir_shader *shader,
 			 * lowered away any copy_deref instructions and we
 			 *  don't want to introduce any more.
 			*/
-			NIR_PASS(progress, shader, nir_opt_find_array_copies);
+			NIR_LOOP_PASS(progress, skip, shader, nir_opt_find_array_copies);
 		}
 
-		NIR_PASS(progress, shader, nir_opt_copy_prop_vars);
-		NIR_PASS(progress, shader, nir_opt_dead_write_vars);
-		NIR_PASS(progress, shader, nir_remove_dead_variables,
+		NIR_LOOP_PASS(progress, skip, shader, nir_opt_copy_prop_vars);
+		NIR_LOOP_PASS(progress, skip, shader, nir_opt_dead_write_vars);
+		NIR_LOOP_PASS(progress, skip, shader, nir_remove_dead_variables,
 			 nir_var_function_temp | nir_var_shader_in | nir_var_shader_out,
 			 NULL);
 
-                NIR_PASS_V(shader, nir_lower_alu_to_scalar, NULL, NULL);
-                NIR_PASS_V(shader, nir_lower_phis_to_scalar);
+                NIR_LOOP_PASS(lower_progress, skip, shader, nir_lower_alu_to_scalar, NULL, NULL);
+                NIR_LOOP_PASS(lower_progress, skip, shader, nir_lower_phis_to_scalar);
 
-                NIR_PASS(progress, shader, nir_copy_prop);
-                NIR_PASS(progress, shader, nir_opt_remove_phis);
-                NIR_PASS(progress, shader, nir_opt_dce);
-                if (nir_opt_trivial_continues(shader)) {
+                NIR_LOOP_PASS(progress, skip, shader, nir_copy_prop);
+                NIR_LOOP_PASS(progress, skip, shader, nir_opt_remove_phis);
+                NIR_LOOP_PASS(progress, skip, shader, nir_opt_dce);
+                bool trivial_continues_progress = false;
+                NIR_LOOP_PASS_NOT_IDEMPOTENT(trivial_continues_progress, skip,
+                                             shader, nir_opt_trivial_continues);
+                if (trivial_continues_progress) {
                         progress = true;
-                        NIR_PASS(progress, shader, nir_copy_prop);
-			NIR_PASS(progress, shader, nir_opt_remove_phis);
-                        NIR_PASS(progress, shader, nir_opt_dce);
+                        NIR_LOOP_PASS(progress, skip, shader, nir_copy_prop);
+			NIR_LOOP_PASS(progress, skip, shader, nir_opt_remove_phis);
+                        NIR_LOOP_PASS(progress, skip, shader, nir_opt_dce);
                 }
-                NIR_PASS(progress, shader, nir_opt_if, true);
-                NIR_PASS(progress, shader, nir_opt_dead_cf);
-                NIR_PASS(progress, shader, nir_opt_cse);
-                NIR_PASS(progress, shader, nir_opt_peephole_select, 8, true, true);
-                NIR_PASS(progress, shader, nir_opt_constant_folding);
-                NIR_PASS(progress, shader, nir_opt_algebraic);
+                NIR_LOOP_PASS_NOT_IDEMPOTENT(progress, skip, shader, nir_opt_if, true);
+                NIR_LOOP_PASS(progress, skip, shader, nir_opt_dead_cf);
+                NIR_LOOP_PASS(progress, skip, shader, nir_opt_cse);
+                NIR_LOOP_PASS(progress, skip, shader, nir_opt_peephole_select, 8, true, true);
+                NIR_LOOP_PASS(progress, skip, shader, nir_opt_constant_folding);
+                NIR_LOOP_PASS_NOT_IDEMPOTENT(progress, skip, shader, nir_opt_algebraic);
 
                 if (lower_flrp != 0) {
                         bool lower_flrp_progress = false;
@@ -185,8 +222,9 @@ radv_optimize_nir(const struct radv_device *device, struct nir_shader *shader,
                                  lower_flrp,
                                  false /* always_precise */);
                         if (lower_flrp_progress) {
-                                NIR_PASS(progress, shader,
-                                         nir_opt_constant_folding);
+                                _mesa_set_clear(skip, NULL);
+                                NIR_LOOP_PASS(progress, skip, shader,
+                                              nir_opt_constant_folding);
                                 progress = true;
                         }
 
@@ -196,14 +234,16 @@ radv_optimize_nir(const struct radv_device *device, struct nir_shader *shader,
                         lower_flrp = 0;
                 }
 
-                NIR_PASS(progress, shader, nir_opt_undef);
-                NIR_PASS(progress, shader, nir_opt_shrink_vectors,
+                NIR_LOOP_PASS(progress, skip, shader, nir_opt_undef);
+                NIR_LOOP_PASS(progress, skip, shader, nir_opt_shrink_vectors,
                          !device->instance->disable_shrink_image_store);
                 if (shader->options->max_unroll_iterations) {
-                        NIR_PASS(progress, shader, nir_opt_loop_unroll, 0);
+                        NIR_LOOP_PASS_NOT_IDEMPOTENT(progress, skip, shader, nir_opt_loop_unroll, 0);
                 }
         } while (progress && !optimize_conservatively);
 
+        _mesa_set_destroy(skip, NULL);
+
 	NIR_PASS(progress, shader, nir_opt_conditional_discard);
         NIR_PASS(progress, shader, nir_opt_move, nir_move_load_ubo);
 }
@@ -327,15 +367,15 @@ lower_intrinsics(nir_shader *nir)
 	return progress;
 }
 
-nir_shader *
-radv_shader_compile_to_nir(struct radv_device *device,
-			   struct vk_shader_module *module,
-			   const char *entrypoint_name,
-			   gl_shader_stage stage,
-			   const VkSpecializationInfo *spec_info,
-			   const VkPipelineCreateFlags flags,
-			   const struct radv_pipeline_layout *layout,
-			   unsigned subgroup_size, unsigned ballot_bit_size)
+static nir_shader *
+compile_to_nir_uncached(struct radv_device *device,
+			struct vk_shader_module *module,
+			const char *entrypoint_name,
+			gl_shader_stage stage,
+			const VkSpecializationInfo *spec_info,
+			const VkPipelineCreateFlags flags,
+			const struct radv_pipeline_layout *layout,
+			unsigned subgroup_size, unsigned ballot_bit_size)
 {
 	nir_shader *nir;
 
@@ -677,6 +717,162 @@ radv_shader_compile_to_nir(struct radv_device *device,
 	return nir;
 }
 
+/* The NIR cache keeps the output of compile_to_nir_uncached(), so that
+ * pipelines sharing a stage with a previously created pipeline don't
+ * translate and optimize the SPIR-V again. Only linking and the backend
+ * compilation are done per pipeline for those stages.
+ */
+#define RADV_NIR_CACHE_MAX_SIZE (64 * 1024 * 1024)
+
+struct radv_nir_cache_entry {
+	unsigned char sha1[20];
+	size_t size;
+	char data[];
+};
+
+static uint32_t
+radv_nir_cache_hash(const void *key)
+{
+	return *(const uint32_t *)key;
+}
+
+static bool
+radv_nir_cache_equals(const void *a, const void *b)
+{
+	return memcmp(a, b, 20) == 0;
+}
+
+void
+radv_nir_cache_init(struct radv_device *device)
+{
+	mtx_init(&device->nir_cache_mutex, mtx_plain);
+	device->nir_cache_size = 0;
+	device->nir_cache = _mesa_hash_table_create(NULL, radv_nir_cache_hash,
+						    radv_nir_cache_equals);
+}
+
+static void
+radv_nir_cache_delete_entry(struct hash_entry *entry)
+{
+	free(entry->data);
+}
+
+void
+radv_nir_cache_finish(struct radv_device *device)
+{
+	if (!device->nir_cache)
+		return;
+
+	_mesa_hash_table_destroy(device->nir_cache, radv_nir_cache_delete_entry);
+	device->nir_cache = NULL;
+	mtx_destroy(&device->nir_cache_mutex);
+}
+
+static void
+radv_hash_nir_stage(unsigned char *hash,
+		    struct vk_shader_module *module,
+		    const char *entrypoint_name,
+		    gl_shader_stage stage,
+		    const VkSpecializationInfo *spec_info,
+		    const VkPipelineCreateFlags flags,
+		    const struct radv_pipeline_layout *layout,
+		    unsigned subgroup_size, unsigned ballot_bit_size)
+{
+	struct mesa_sha1 ctx;
+	const uint32_t state[] = {
+		stage, flags & VK_PIPELINE_CREATE_DISABLE_OPTIMIZATION_BIT,
+		subgroup_size, ballot_bit_size,
+	};
+
+	_mesa_sha1_init(&ctx);
+	_mesa_sha1_update(&ctx, module->sha1, sizeof(module->sha1));
+	_mesa_sha1_update(&ctx, entrypoint_name, strlen(entrypoint_name));
+	if (spec_info && spec_info->mapEntryCount) {
+		_mesa_sha1_update(&ctx, spec_info->pMapEntries,
+				  spec_info->mapEntryCount * sizeof spec_info->pMapEntries[0]);
+		_mesa_sha1_update(&ctx, spec_info->pData, spec_info->dataSize);
+	}
+	/* YCbCr lowering depends on the immutable samplers of the layout. */
+	if (layout)
+		_mesa_sha1_update(&ctx, layout->sha1, sizeof(layout->sha1));
+	_mesa_sha1_update(&ctx, state, sizeof(state));
+	_mesa_sha1_final(&ctx, hash);
+}
+
+nir_shader *
+radv_shader_compile_to_nir(struct radv_device *device,
+			   struct vk_shader_module *module,
+			   const char *entrypoint_name,
+			   gl_shader_stage stage,
+			   const VkSpecializationInfo *spec_info,
+			   const VkPipelineCreateFlags flags,
+			   const struct radv_pipeline_layout *layout,
+			   unsigned subgroup_size, unsigned ballot_bit_size)
+{
+	unsigned char hash[20];
+	nir_shader *nir;
+
+	/* Internal shaders are NIR already, and the SPIR-V dumps are
+	 * only printed when the SPIR-V is translated.
+	 */
+	if (module->nir || !device->nir_cache ||
+	    (device->instance->debug_flags & (RADV_DEBUG_NO_CACHE |
+					      RADV_DEBUG_DUMP_SPIRV))) {
+		return compile_to_nir_uncached(device, module, entrypoint_name,
+					       stage, spec_info, flags, layout,
+					       subgroup_size, ballot_bit_size);
+	}
+
+	radv_hash_nir_stage(hash, module, entrypoint_name, stage, spec_info,
+			    flags, layout, subgroup_size, ballot_bit_size);
+
+	mtx_lock(&device->nir_cache_mutex);
+	struct hash_entry *he = _mesa_hash_table_search(device->nir_cache, hash);
+	mtx_unlock(&device->nir_cache_mutex);
+
+	/* Entries are never removed before the device is destroyed, so the
+	 * data can be read without holding the lock.
+	 */
+	if (he) {
+		const struct radv_nir_cache_entry *entry = he->data;
+		struct blob_reader reader;
+
+		blob_reader_init(&reader, entry->data, entry->size);
+		nir = nir_deserialize(NULL, &nir_options, &reader);
+		if (nir)
+			return nir;
+	}
+
+	nir = compile_to_nir_uncached(device, module, entrypoint_name,
+				      stage, spec_info, flags, layout,
+				      subgroup_size, ballot_bit_size);
+
+	struct blob blob;
+	blob_init(&blob);
+	nir_serialize(&blob, nir, false);
+
+	if (!blob.out_of_memory) {
+		struct radv_nir_cache_entry *entry = NULL;
+
+		mtx_lock(&device->nir_cache_mutex);
+		if (!_mesa_hash_table_search(device->nir_cache, hash) &&
+		    device->nir_cache_size + blob.size <= RADV_NIR_CACHE_MAX_SIZE)
+			entry = malloc(sizeof(*entry) + blob.size);
+
+		if (entry) {
+			memcpy(entry->sha1, hash, sizeof(hash));
+			entry->size = blob.size;
+			memcpy(entry->data, blob.data, blob.size);
+			_mesa_hash_table_insert(device->nir_cache, entry->sha1, entry);
+			device->nir_cache_size += blob.size;
+		}
+		mtx_unlock(&device->nir_cache_mutex);
+	}
+
+	blob_finish(&blob);
+	return nir;
+}
+
 static int
 type_size_vec4(const struct glsl_type *type, bool bindless)
 {
@@ -1395,6 +1591,7 @@ shader_variant_compile(struct radv_device *device,
 				 device->instance->debug_flags & RADV_DEBUG_PREOPTIR;
 	options->record_ir = keep_shader_info;
 	options->record_stats = keep_statistic_info;
+	options->dump_compile_time = device->instance->debug_flags & RADV_DEBUG_COMPILE_TIME;
 	options->check_ir = device->instance->debug_flags & RADV_DEBUG_CHECKIR;
 	options->tess_offchip_block_dw_size = device->tess_offchip_block_dw_size;
 	options->address32_hi = device->physical_device->rad_info.address32_hi;
@@ -131,6 +131,7 @@ struct radv_nir_compiler_options {
 	bool dump_preoptir;
 	bool record_ir;
 	bool record_stats;
+	bool dump_compile_time; /* only used by ACO */
 	bool check_ir;
 	bool has_ls_vgpr_init_bug;
 	bool use_ngg_streamout;
@@ -434,6 +435,12 @@ radv_shader_compile_to_nir(struct radv_device *device,
 			   const struct radv_pipeline_layout *layout,
 			   unsigned subgroup_size, unsigned ballot_bit_size);
 
+void
+radv_nir_cache_init(struct radv_device *device);
+
+void
+radv_nir_cache_finish(struct radv_device *device);
+
 void
 radv_destroy_shader_slabs(struct radv_device *device);
 
@@ -458,6 +458,9 @@ radv_thread_trace_init(struct radv_device *device)
 	if (trigger_file)
 		device->thread_trace.trigger_file = strdup(trigger_file);
 
+	device->thread_trace.hitch_threshold_ms =
+		radv_get_int_debug_option("RADV_THREAD_TRACE_HITCH", 0);
+
 	if (!radv_thread_trace_init_bo(device))
 		return false;
 
@@ -517,6 +517,58 @@ tmu_spilling_allowed(struct v3d_compile *c, int thread_index)
         return thread_index == 0 && c->disable_tmu_pipelining;
 }
 
+/**
+ * Returns whether the register pressure of the shader is known to exceed
+ * what register allocation can satisfy at this thread count.
+ *
+ * Temps overlapping at a given IP all interfere with each other, so if more
+ * of them than there are physical registers and accumulators are live at any
+ * point, allocation will fail. Uniforms can still be rematerialized by
+ * spilling, so they are not counted, and we can't tell anything if we may
+ * spill to the TMU. This lets us drop to a lower thread count without
+ * building the interference graph first.
+ */
+static bool
+v3d_pressure_exceeds_regs(struct v3d_compile *c, int thread_index)
+{
+        if (tmu_spilling_allowed(c, thread_index))
+                return false;
+
+        int max_regs = (PHYS_COUNT >> thread_index) + ACC_COUNT;
+
+        int ip_count = 0;
+        for (uint32_t i = 0; i < c->num_temps; i++)
+                ip_count = MAX2(ip_count, c->temp_end[i]);
+
+        if (ip_count == 0)
+                return false;
+
+        int *live_delta = calloc(ip_count + 1, sizeof(int));
+        for (uint32_t i = 0; i < c->num_temps; i++) {
+                if (c->temp_start[i] >= c->temp_end[i] ||
+                    vir_is_mov_uniform(c, i)) {
+                        continue;
+                }
+
+                live_delta[c->temp_start[i]]++;
+                live_delta[c->temp_end[i]]--;
+        }
+
+        bool exceeds = false;
+        int live = 0;
+        for (int ip = 0; ip < ip_count; ip++) {
+                live += live_delta[ip];
+                if (live > max_regs) {
+                        exceeds = true;
+                        break;
+                }
+        }
+
+        free(live_delta);
+
+        return exceeds;
+}
+
 #define CLASS_BIT_PHYS			(1 << 0)
 #define CLASS_BIT_ACC			(1 << 1)
 #define CLASS_BIT_R5			(1 << 4)
@@ -559,6 +611,9 @@ v3d_register_allocate(struct v3d_compile *c, bool *spilled)
                         thread_index--;
         }
 
+        if (v3d_pressure_exceeds_regs(c, thread_index))
+                return NULL;
+
         struct ra_graph *g = ra_alloc_interference_graph(c->compiler->regs,
                                                          c->num_temps +
                                                          ARRAY_SIZE(acc_nodes));
@@ -75,6 +75,7 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "main/mtypes.h"
 #include "main/shaderobj.h"
 #include "ir_builder.h"
@@ -7737,6 +7738,14 @@ static builtin_builder builtins;
 static mtx_t builtins_lock = _MTX_INITIALIZER_NP;
 static uint32_t builtin_users = 0;
 
+static void
+release_builtins_at_exit(void)
+{
+   mtx_lock(&builtins_lock);
+   builtins.release();
+   mtx_unlock(&builtins_lock);
+}
+
 /**
  * External API (exposing the built-in module to the rest of the compiler):
  *  @{
@@ -7744,9 +7753,21 @@ static uint32_t builtin_users = 0;
 extern "C" void
 _mesa_glsl_builtin_functions_init_or_ref()
 {
+   static bool release_registered = false;
+
    mtx_lock(&builtins_lock);
-   if (builtin_users++ == 0)
+   if (builtin_users++ == 0) {
+      /* The module isn't released when the last user goes away, so that
+       * applications creating and destroying contexts (or calling
+       * glReleaseShaderCompiler) don't rebuild thousands of signatures every
+       * time.  initialize() is a no-op if it's still around.
+       */
       builtins.initialize();
+      if (!release_registered) {
+         atexit(release_builtins_at_exit);
+         release_registered = true;
+      }
+   }
    mtx_unlock(&builtins_lock);
 }
 
@@ -7755,8 +7776,7 @@ _mesa_glsl_builtin_functions_decref()
 {
    mtx_lock(&builtins_lock);
    assert(builtin_users != 0);
-   if (--builtin_users == 0)
-      builtins.release();
+   builtin_users--;
    mtx_unlock(&builtins_lock);
 }
 
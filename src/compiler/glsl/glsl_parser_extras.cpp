@@ -2070,9 +2070,16 @@ opt_shader_and_create_symbol_table(struct gl_context *ctx,
       &ctx->Const.ShaderCompilerOptions[shader->Stage];
 
    /* Do some optimization at compile time to reduce shader IR size
-    * and reduce later work if the same shader is linked multiple times
+    * and reduce later work if the same shader is linked multiple times.
+    *
+    * Drivers that translate the linked IR to NIR skip this: the linker runs
+    * the same passes again on the linked IR, which is where they matter for
+    * inlining, dead code and loop unrolling, and NIR optimizes the result
+    * better than GLSL IR does.
     */
-   if (ctx->Const.GLSLOptimizeConservatively) {
+   if (options->NirOptions) {
+      /* Nothing to do. */
+   } else if (ctx->Const.GLSLOptimizeConservatively) {
       /* Run it just once. */
       do_common_optimization(shader->ir, false, false, options,
                              ctx->Const.NativeIntegers);
@@ -1277,6 +1277,53 @@ variable_is_referenced(ir_array_refcount_visitor &v, ir_variable *var)
 
 }
 
+struct block_member_ref {
+   unsigned block;
+   unsigned index;
+};
+
+/**
+ * Index the members of a list of uniform or shader storage blocks by the
+ * part of their name in front of \c sentinel (or by their whole name if
+ * \c sentinel is '\0'), so that the variables of blocks without an instance
+ * name can be matched without comparing them to every member of every
+ * block.  Like the linear search, the first match in block order wins.
+ */
+static struct hash_table *
+index_block_members(void *mem_ctx, struct gl_uniform_block **blks,
+                    unsigned num_blocks, char sentinel)
+{
+   struct hash_table *ht =
+      _mesa_hash_table_create(mem_ctx, _mesa_hash_string,
+                              _mesa_key_string_equal);
+
+   for (unsigned i = 0; i < num_blocks; i++) {
+      for (unsigned j = 0; j < blks[i]->NumUniforms; j++) {
+         const char *key = blks[i]->Uniforms[j].Name;
+
+         if (sentinel) {
+            const char *end = strchr(key, sentinel);
+
+            if (end == NULL)
+               continue;
+
+            key = ralloc_strndup(mem_ctx, key, end - key);
+         }
+
+         if (_mesa_hash_table_search(ht, key))
+            continue;
+
+         struct block_member_ref *ref =
+            ralloc(mem_ctx, struct block_member_ref);
+         ref->block = i;
+         ref->index = j;
+         _mesa_hash_table_insert(ht, key, ref);
+      }
+   }
+
+   return ht;
+}
+
 /**
  * Walks the IR and update the references to uniform blocks in the
  * ir_variables to point at linked shader's list (previously, they
@@ -1291,6 +1338,12 @@ link_update_uniform_buffer_variables(struct gl_linked_shader *shader,
 
    v.run(shader->ir);
 
+   /* Member indices of the UBOs and SSBOs, for each sentinel, built on
+    * first use.
+    */
+   void *mem_ctx = ralloc_context(NULL);
+   struct hash_table *member_index[2][3] = {};
+
    foreach_in_list(ir_instruction, node, shader->ir) {
       ir_variable *const var = node->as_variable();
 
@@ -1347,49 +1400,38 @@ link_update_uniform_buffer_variables(struct gl_linked_shader *shader,
          continue;
       }
 
-      bool found = false;
       char sentinel = '\0';
+      unsigned sentinel_idx = 0;
 
       if (var->type->is_struct()) {
          sentinel = '.';
+         sentinel_idx = 1;
       } else if (var->type->is_array() && (var->type->fields.array->is_array()
                  || var->type->without_array()->is_struct())) {
          sentinel = '[';
+         sentinel_idx = 2;
       }
 
-      const unsigned l = strlen(var->name);
-      for (unsigned i = 0; i < num_blocks; i++) {
-         for (unsigned j = 0; j < blks[i]->NumUniforms; j++) {
-            if (sentinel) {
-               const char *begin = blks[i]->Uniforms[j].Name;
-               const char *end = strchr(begin, sentinel);
-
-               if (end == NULL)
-                  continue;
-
-               if ((ptrdiff_t) l != (end - begin))
-                  continue;
-
-               found = strncmp(var->name, begin, l) == 0;
-            } else {
-               found = strcmp(var->name, blks[i]->Uniforms[j].Name) == 0;
-            }
+      struct hash_table **ht =
+         &member_index[var->data.mode == ir_var_shader_storage][sentinel_idx];
+      if (*ht == NULL)
+         *ht = index_block_members(mem_ctx, blks, num_blocks, sentinel);
 
-            if (found) {
-               var->data.location = j;
+      struct hash_entry *entry = _mesa_hash_table_search(*ht, var->name);
+      assert(entry);
+      if (entry == NULL)
+         continue;
 
-               if (variable_is_referenced(v, var))
-                  blks[i]->stageref |= 1U << stage;
+      const struct block_member_ref *ref =
+         (const struct block_member_ref *) entry->data;
 
-               break;
-            }
-         }
+      var->data.location = ref->index;
 
-         if (found)
-            break;
-      }
-      assert(found);
+      if (variable_is_referenced(v, var))
+         blks[ref->block]->stageref |= 1U << stage;
    }
+
+   ralloc_free(mem_ctx);
 }
 
 /**
@@ -1439,6 +1481,27 @@ link_setup_uniform_remap_tables(struct gl_context *ctx,
       }
    }
 
+   /* Grow the remap table once, to fit the worst case of none of the
+    * remaining uniforms fitting into empty blocks, rather than reallocating
+    * it for every uniform.
+    */
+   unsigned max_new_entries = 0;
+   for (unsigned i = 0; i < prog->data->NumUniformStorage; i++) {
+      if (prog->data->UniformStorage[i].type->is_subroutine() ||
+          prog->data->UniformStorage[i].is_shader_storage ||
+          prog->data->UniformStorage[i].builtin ||
+          prog->data->UniformStorage[i].remap_location != UNMAPPED_UNIFORM_LOC)
+         continue;
+
+      max_new_entries += MAX2(1, prog->data->UniformStorage[i].array_elements);
+   }
+
+   if (max_new_entries) {
+      prog->UniformRemapTable =
+         reralloc(prog, prog->UniformRemapTable, gl_uniform_storage *,
+                  prog->NumUniformRemapTable + max_new_entries);
+   }
+
    /* Reserve locations for rest of the uniforms. */
    for (unsigned i = 0; i < prog->data->NumUniformStorage; i++) {
 
@@ -1475,13 +1538,6 @@ link_setup_uniform_remap_tables(struct gl_context *ctx,
          empty_locs -= entries;
       } else {
          chosen_location = prog->NumUniformRemapTable;
-
-         /* resize remap table to fit new entries */
-         prog->UniformRemapTable =
-            reralloc(prog,
-                     prog->UniformRemapTable,
-                     gl_uniform_storage *,
-                     prog->NumUniformRemapTable + entries);
          prog->NumUniformRemapTable += entries;
       }
 
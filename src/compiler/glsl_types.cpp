@@ -26,6 +26,7 @@
 #include "compiler/glsl/glsl_parser_extras.h"
 #include "glsl_types.h"
 #include "util/hash_table.h"
+#include "util/u_atomic.h"
 #include "util/u_cpu_detect.h"
 #include "util/u_string.h"
 
@@ -44,6 +45,29 @@ hash_table *glsl_type::subroutine_types = NULL;
  */
 static uint32_t glsl_type_users = 0;
 
+/* Bumped whenever the type tables are released, which invalidates the
+ * per-thread array type caches below.  Starts at 1 so that zero-initialized
+ * cache slots never match.
+ */
+static uint32_t glsl_type_generation = 1;
+
+/* Small direct-mapped per-thread cache in front of array_types, so that
+ * compiler threads looking up the same array types over and over don't
+ * serialize on hash_mutex.
+ */
+#define ARRAY_TYPE_CACHE_SIZE 64
+
+struct array_type_cache_entry {
+   const glsl_type *base;
+   unsigned array_size;
+   unsigned explicit_stride;
+   uint32_t generation;
+   const glsl_type *type;
+};
+
+static thread_local array_type_cache_entry
+   array_type_cache[ARRAY_TYPE_CACHE_SIZE];
+
 glsl_type::glsl_type(GLenum gl_type,
                      glsl_base_type base_type, unsigned vector_elements,
                      unsigned matrix_columns, const char *name,
@@ -572,6 +596,8 @@ glsl_type_singleton_decref()
       glsl_type::subroutine_types = NULL;
    }
 
+   p_atomic_inc(&glsl_type_generation);
+
    mtx_unlock(&glsl_type::hash_mutex);
 }
 
@@ -1121,6 +1147,18 @@ glsl_type::get_array_instance(const glsl_type *base,
                               unsigned array_size,
                               unsigned explicit_stride)
 {
+   const uint32_t generation = p_atomic_read(&glsl_type_generation);
+   const unsigned slot =
+      ((uintptr_t) base / sizeof(void *) ^ array_size * 31 ^ explicit_stride) %
+      ARRAY_TYPE_CACHE_SIZE;
+   array_type_cache_entry *cached = &array_type_cache[slot];
+
+   if (cached->generation == generation &&
+       cached->base == base &&
+       cached->array_size == array_size &&
+       cached->explicit_stride == explicit_stride)
+      return cached->type;
+
    /* Generate a name using the base type pointer in the key.  This is
     * done because the name of the base type may not be unique across
     * shaders.  For example, two shaders may have different record types
@@ -1155,6 +1193,12 @@ glsl_type::get_array_instance(const glsl_type *base,
 
    mtx_unlock(&glsl_type::hash_mutex);
 
+   cached->base = base;
+   cached->array_size = array_size;
+   cached->explicit_stride = explicit_stride;
+   cached->generation = generation;
+   cached->type = t;
+
    return t;
 }
 
@@ -33,6 +33,7 @@
 #include <assert.h>
 #include <math.h>
 #include "util/u_math.h"
+#include "util/simple_mtx.h"
 
 #include "main/menums.h" /* BITFIELD64_MASK */
 
@@ -1005,6 +1006,29 @@ void nir_instr_remove_v(nir_instr *instr)
    }
 }
 
+/**
+ * Free an instruction which was removed from the shader.
+ *
+ * Nothing may reference the instruction or its SSA def anymore.  Without
+ * this, removed instructions stay allocated until the shader is swept.
+ */
+void
+nir_instr_free(nir_instr *instr)
+{
+   ralloc_free(instr);
+}
+
+/** Free a list of removed instructions, linked through their nodes. */
+void
+nir_instr_free_list(struct exec_list *list)
+{
+   struct exec_node *node;
+   while ((node = exec_list_pop_head(list))) {
+      nir_instr *removed_instr = exec_node_data(nir_instr, node, node);
+      nir_instr_free(removed_instr);
+   }
+}
+
 /*@}*/
 
 void
@@ -2399,3 +2423,76 @@ nir_variable *nir_get_binding_variable(nir_shader *shader, nir_binding binding)
 
    return NULL;
 }
+
+#ifndef NDEBUG
+#define NIR_MAX_TIMED_PASSES 256
+
+struct nir_pass_time {
+   const char *name;
+   uint64_t ns;
+   unsigned count;
+};
+
+static struct nir_pass_time nir_pass_times[NIR_MAX_TIMED_PASSES];
+static unsigned nir_num_timed_passes;
+static simple_mtx_t nir_pass_times_mutex = _SIMPLE_MTX_INITIALIZER_NP;
+
+static int
+compare_pass_times(const void *a, const void *b)
+{
+   const uint64_t ta = ((const struct nir_pass_time *)a)->ns;
+   const uint64_t tb = ((const struct nir_pass_time *)b)->ns;
+   return ta < tb ? 1 : ta > tb ? -1 : 0;
+}
+
+static void
+print_pass_times(void)
+{
+   simple_mtx_lock(&nir_pass_times_mutex);
+
+   qsort(nir_pass_times, nir_num_timed_passes, sizeof(nir_pass_times[0]),
+         compare_pass_times);
+
+   fprintf(stderr, "%-40s %8s %12s %10s\n", "NIR pass", "calls", "total ms",
+           "avg us");
+   for (unsigned i = 0; i < nir_num_timed_passes; i++) {
+      fprintf(stderr, "%-40s %8u %12.3f %10.3f\n", nir_pass_times[i].name,
+              nir_pass_times[i].count, nir_pass_times[i].ns / 1000000.0,
+              nir_pass_times[i].ns / 1000.0 / nir_pass_times[i].count);
+   }
+
+   simple_mtx_unlock(&nir_pass_times_mutex);
+}
+
+/**
+ * Accumulate the time spent in a pass run with NIR_PASS, for
+ * NIR_TIME_PASSES.  The totals are printed to stderr at exit.  Passes which
+ * run other passes with NIR_PASS include the time of those.
+ */
+void
+nir_record_pass_time(const char *pass_name, int64_t ns)
+{
+   simple_mtx_lock(&nir_pass_times_mutex);
+
+   unsigned i;
+   for (i = 0; i < nir_num_timed_passes; i++) {
+      if (!strcmp(nir_pass_times[i].name, pass_name))
+         break;
+   }
+
+   if (i == nir_num_timed_passes && i < NIR_MAX_TIMED_PASSES) {
+      if (!nir_num_timed_passes)
+         atexit(print_pass_times);
+
+      nir_pass_times[i].name = pass_name;
+      nir_num_timed_passes++;
+   }
+
+   if (i < nir_num_timed_passes) {
+      nir_pass_times[i].ns += ns;
+      nir_pass_times[i].count++;
+   }
+
+   simple_mtx_unlock(&nir_pass_times_mutex);
+}
+#endif
@@ -40,6 +40,7 @@
 #include "util/enum_operators.h"
 #include "util/macros.h"
 #include "util/format/u_format.h"
+#include "util/os_time.h"
 #include "compiler/nir_types.h"
 #include "compiler/shader_enums.h"
 #include "compiler/shader_info.h"
@@ -2888,6 +2889,14 @@ typedef enum {
     */
    nir_metadata_instr_index = 0x20,
 
+   /** Indicates that the impl was validated and hasn't changed since.
+    *
+    * This is only set and used by nir_validate_shader() when incremental
+    * validation is enabled with NIR_VALIDATE_INCREMENTAL.  Any pass which
+    * changes the impl drops it by not preserving all metadata.
+    */
+   nir_metadata_validated = 0x40,
+
    /** All metadata
     *
     * This includes all nir_metadata flags except not_properly_reset.  Passes
@@ -3429,6 +3438,15 @@ typedef struct nir_shader_compiler_options {
    unsigned max_unroll_iterations;
    unsigned max_unroll_iterations_aggressive;
 
+   /**
+    * Optional backend estimate of the cost of an instruction, in number of
+    * simple instructions.  It is given the generic estimate, which accounts
+    * for int64 and fp64 lowering, and returns the cost the backend expects.
+    * Loop unrolling uses it to bound the size of unrolled loops.
+    */
+   unsigned (*instr_cost_cb)(const struct nir_instr *instr,
+                             unsigned default_cost);
+
    /* For the non-zero value of the enum corresponds multiplier when
     * calling lower_uniforms_to_ubo */
    bool lower_uniforms_to_ubo;
@@ -3529,6 +3547,9 @@ typedef struct nir_instr_liveness {
 nir_instr_liveness *
 nir_live_ssa_defs_per_instr(nir_function_impl *impl);
 
+unsigned nir_compute_register_pressure(nir_function_impl *impl, void *mem_ctx,
+                                       unsigned **instr_pressure);
+
 nir_shader *nir_shader_create(void *mem_ctx,
                               gl_shader_stage stage,
                               const nir_shader_compiler_options *options,
@@ -3861,6 +3882,8 @@ nir_instr_insert_after_cf_list(struct exec_list *list, nir_instr *after)
 }
 
 void nir_instr_remove_v(nir_instr *instr);
+void nir_instr_free(nir_instr *instr);
+void nir_instr_free_list(struct exec_list *list);
 
 static inline nir_cursor
 nir_instr_remove(nir_instr *instr)
@@ -4116,6 +4139,18 @@ should_serialize_deserialize_nir(void)
    return test_serialize;
 }
 
+static inline bool
+should_time_nir(void)
+{
+   static int should_time = -1;
+   if (should_time < 0)
+      should_time = env_var_as_boolean("NIR_TIME_PASSES", false);
+
+   return should_time;
+}
+
+void nir_record_pass_time(const char *pass_name, int64_t ns);
+
 static inline bool
 should_print_nir(nir_shader *shader)
 {
@@ -4136,6 +4171,8 @@ static inline void nir_metadata_check_validation_flag(nir_shader *shader) { (voi
 static inline bool should_skip_nir(UNUSED const char *pass_name) { return false; }
 static inline bool should_clone_nir(void) { return false; }
 static inline bool should_serialize_deserialize_nir(void) { return false; }
+static inline bool should_time_nir(void) { return false; }
+static inline void nir_record_pass_time(UNUSED const char *pass_name, UNUSED int64_t ns) { }
 static inline bool should_print_nir(nir_shader *shader) { return false; }
 #endif /* NDEBUG */
 
@@ -4144,7 +4181,10 @@ static inline bool should_print_nir(nir_shader *shader) { return false; }
       printf("skipping %s\n", #pass);                                \
       break;                                                         \
    }                                                                 \
+   int64_t nir_pass_start = should_time_nir() ? os_time_get_nano() : 0; \
    do_pass                                                           \
+   if (nir_pass_start)                                               \
+      nir_record_pass_time(#pass, os_time_get_nano() - nir_pass_start); \
    if (should_clone_nir()) {                                         \
       nir_shader *clone = nir_shader_clone(ralloc_parent(nir), nir); \
       nir_shader_replace(nir, clone);                                \
@@ -4176,6 +4216,40 @@ static inline bool should_print_nir(nir_shader *shader) { return false; }
       nir_print_shader(nir, stdout);                                 \
 )
 
+/** Run a pass inside an optimization loop, skipping it when it can't make
+ * progress.
+ *
+ * \p idempotent_set holds the passes which made no progress since the last
+ * time any pass of the loop made progress.  Running them again would just
+ * rescan the shader for nothing, so they are skipped until some other pass
+ * changes the shader.  This assumes that the pass is idempotent and that it
+ * is always called with the same arguments in the loop.
+ */
+#define NIR_LOOP_PASS(progress, idempotent_set, nir, pass, ...)      \
+do {                                                                 \
+   bool nir_loop_pass_progress = false;                              \
+   if (!_mesa_set_search(idempotent_set, (void *)(uintptr_t)pass))   \
+      NIR_PASS(nir_loop_pass_progress, nir, pass, ##__VA_ARGS__);    \
+   if (nir_loop_pass_progress)                                       \
+      _mesa_set_clear(idempotent_set, NULL);                         \
+   else                                                              \
+      _mesa_set_add(idempotent_set, (void *)(uintptr_t)pass);        \
+   progress |= nir_loop_pass_progress;                               \
+} while (0)
+
+/** Like NIR_LOOP_PASS, for passes which may make progress again when run
+ * twice in a row.  They are never skipped.
+ */
+#define NIR_LOOP_PASS_NOT_IDEMPOTENT(progress, idempotent_set, nir,  \
+                                     pass, ...)                      \
+do {                                                                 \
+   bool nir_loop_pass_progress = false;                              \
+   NIR_PASS(nir_loop_pass_progress, nir, pass, ##__VA_ARGS__);       \
+   if (nir_loop_pass_progress)                                       \
+      _mesa_set_clear(idempotent_set, NULL);                         \
+   progress |= nir_loop_pass_progress;                               \
+} while (0)
+
 #define NIR_SKIP(name) should_skip_nir(#name)
 
 /** An instruction filtering callback
@@ -45,6 +45,12 @@ typedef struct {
    /* maps orig ptr -> cloned ptr: */
    struct hash_table *remap_table;
 
+   /* When cloning a whole function_impl, maps the index of an orig SSA def
+    * to the cloned def, which is a lot cheaper than the remap table.
+    */
+   nir_ssa_def **ssa_defs;
+   unsigned num_ssa_defs;
+
    /* List of phi sources. */
    struct list_head phi_srcs;
 
@@ -65,6 +71,9 @@ init_clone_state(clone_state *state, struct hash_table *remap_table,
       state->remap_table = _mesa_pointer_hash_table_create(NULL);
    }
 
+   state->ssa_defs = NULL;
+   state->num_ssa_defs = 0;
+
    list_inithead(&state->phi_srcs);
 }
 
@@ -117,6 +126,26 @@ remap_global(clone_state *state, const void *ptr)
    return _lookup_ptr(state, ptr, true);
 }
 
+static void
+add_ssa_remap(clone_state *state, nir_ssa_def *ndef, const nir_ssa_def *def)
+{
+   if (def->index < state->num_ssa_defs)
+      state->ssa_defs[def->index] = ndef;
+   else if (likely(state->remap_table))
+      add_remap(state, ndef, def);
+}
+
+static nir_ssa_def *
+remap_ssa(clone_state *state, const nir_ssa_def *def)
+{
+   if (def->index < state->num_ssa_defs) {
+      assert(state->ssa_defs[def->index]);
+      return state->ssa_defs[def->index];
+   }
+
+   return remap_local(state, def);
+}
+
 static nir_register *
 remap_reg(clone_state *state, const nir_register *reg)
 {
@@ -240,7 +269,7 @@ __clone_src(clone_state *state, void *ninstr_or_if,
 {
    nsrc->is_ssa = src->is_ssa;
    if (src->is_ssa) {
-      nsrc->ssa = remap_local(state, src->ssa);
+      nsrc->ssa = remap_ssa(state, src->ssa);
    } else {
       nsrc->reg.reg = remap_reg(state, src->reg.reg);
       if (src->reg.indirect) {
@@ -259,8 +288,7 @@ __clone_dst(clone_state *state, nir_instr *ninstr,
    if (dst->is_ssa) {
       nir_ssa_dest_init(ninstr, ndst, dst->ssa.num_components,
                         dst->ssa.bit_size, dst->ssa.name);
-      if (likely(state->remap_table))
-         add_remap(state, &ndst->ssa, &dst->ssa);
+      add_ssa_remap(state, &ndst->ssa, &dst->ssa);
    } else {
       ndst->reg.reg = remap_reg(state, dst->reg.reg);
       if (dst->reg.indirect) {
@@ -379,7 +407,7 @@ clone_load_const(clone_state *state, const nir_load_const_instr *lc)
 
    memcpy(&nlc->value, &lc->value, sizeof(*nlc->value) * lc->def.num_components);
 
-   add_remap(state, &nlc->def, &lc->def);
+   add_ssa_remap(state, &nlc->def, &lc->def);
 
    return nlc;
 }
@@ -391,7 +419,7 @@ clone_ssa_undef(clone_state *state, const nir_ssa_undef_instr *sa)
       nir_ssa_undef_instr_create(state->ns, sa->def.num_components,
                                  sa->def.bit_size);
 
-   add_remap(state, &nsa->def, &sa->def);
+   add_ssa_remap(state, &nsa->def, &sa->def);
 
    return nsa;
 }
@@ -637,7 +665,7 @@ fixup_phi_srcs(clone_state *state)
       list_del(&src->src.use_link);
 
       if (src->src.is_ssa) {
-         src->src.ssa = remap_local(state, src->src.ssa);
+         src->src.ssa = remap_ssa(state, src->src.ssa);
          list_addtail(&src->src.use_link, &src->src.ssa->uses);
       } else {
          src->src.reg.reg = remap_reg(state, src->src.reg.reg);
@@ -689,10 +717,22 @@ clone_function_impl(clone_state *state, const nir_function_impl *fi)
 
    assert(list_is_empty(&state->phi_srcs));
 
+   /* SSA def indices are unique within the impl, so every def of the impl
+    * gets a slot in the array.
+    */
+   state->num_ssa_defs = fi->ssa_alloc;
+   state->ssa_defs = calloc(fi->ssa_alloc, sizeof(*state->ssa_defs));
+   if (!state->ssa_defs)
+      state->num_ssa_defs = 0;
+
    clone_cf_list(state, &nfi->body, &fi->body);
 
    fixup_phi_srcs(state);
 
+   free(state->ssa_defs);
+   state->ssa_defs = NULL;
+   state->num_ssa_defs = 0;
+
    /* All metadata is invalidated in the cloning process */
    nfi->valid_metadata = 0;
 
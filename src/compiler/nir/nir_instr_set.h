@@ -50,8 +50,14 @@ void nir_instr_set_destroy(struct set *instr_set);
  * does already exist, rewrites all uses of it to point to the other
  * already-inserted instruction. Returns 'true' if the uses of the instruction
  * were rewritten.
+ *
+ * If cond_function is not NULL, the uses are only rewritten if it returns
+ * true for the already-inserted instruction and the new one.  Otherwise the
+ * new instruction replaces the other one in the set.
  */
-bool nir_instr_set_add_or_rewrite(struct set *instr_set, nir_instr *instr);
+bool nir_instr_set_add_or_rewrite(struct set *instr_set, nir_instr *instr,
+                                  bool (*cond_function)(const nir_instr *a,
+                                                        const nir_instr *b));
 
 /**
  * Removes an instruction from an instruction set, so that other instructions
@@ -380,7 +380,7 @@ nir_live_ssa_defs_per_instr(nir_function_impl *impl)
 
    /* Set our starts so we can use MIN2() as we accumulate bounds. */
    for (int i = 0; i < impl->ssa_alloc; i++)
-      liveness->defs->start = ~0;
+      liveness->defs[i].start = ~0;
 
    nir_foreach_block(block, impl) {
       unsigned index;
@@ -413,3 +413,151 @@ nir_live_ssa_defs_per_instr(nir_function_impl *impl)
 
    return liveness;
 }
+
+struct pressure_state {
+   BITSET_WORD *live;
+   uint8_t *def_slots;
+   unsigned pressure;
+};
+
+static unsigned
+ssa_def_slots(const nir_ssa_def *def)
+{
+   return def->num_components * DIV_ROUND_UP(def->bit_size, 32);
+}
+
+static bool
+init_def_slots_cb(nir_ssa_def *def, void *void_state)
+{
+   struct pressure_state *state = void_state;
+
+   /* Undefs never take a register, see set_src_live(). */
+   if (def->parent_instr->type != nir_instr_type_ssa_undef)
+      state->def_slots[def->index] = ssa_def_slots(def);
+   return true;
+}
+
+static bool
+pressure_def_cb(nir_ssa_def *def, void *void_state)
+{
+   struct pressure_state *state = void_state;
+
+   /* Dead defs still need a register while the instruction executes. */
+   if (!BITSET_TEST(state->live, def->index))
+      state->pressure += state->def_slots[def->index];
+
+   return true;
+}
+
+static bool
+pressure_kill_def_cb(nir_ssa_def *def, void *void_state)
+{
+   struct pressure_state *state = void_state;
+
+   if (BITSET_TEST(state->live, def->index)) {
+      BITSET_CLEAR(state->live, def->index);
+      state->pressure -= state->def_slots[def->index];
+   }
+
+   return true;
+}
+
+static void
+pressure_use_def(struct pressure_state *state, const nir_src *src)
+{
+   if (!src->is_ssa || nir_src_is_undef(*src))
+      return;
+
+   if (!BITSET_TEST(state->live, src->ssa->index)) {
+      BITSET_SET(state->live, src->ssa->index);
+      state->pressure += state->def_slots[src->ssa->index];
+   }
+}
+
+static bool
+pressure_use_cb(nir_src *src, void *void_state)
+{
+   pressure_use_def(void_state, src);
+   return true;
+}
+
+/** Compute the register pressure of an impl
+ *
+ * The pressure at an instruction is the number of 32-bit slots needed by
+ * the SSA values live across it, including its sources and destinations.
+ * Phis are considered to be between blocks like in the liveness analysis,
+ * so the pressure of the phi sources and destinations is accounted for at
+ * the end of the predecessors and at the beginning of the block.
+ *
+ * If instr_pressure is not NULL, it is set to an array allocated from
+ * mem_ctx which contains the per-instruction pressure, indexed by
+ * nir_instr::index.  The maximum pressure of the impl is returned.
+ */
+unsigned
+nir_compute_register_pressure(nir_function_impl *impl, void *mem_ctx,
+                              unsigned **instr_pressure)
+{
+   nir_metadata_require(impl, nir_metadata_live_ssa_defs |
+                              nir_metadata_instr_index);
+
+   const unsigned bitset_words = BITSET_WORDS(impl->ssa_alloc);
+   struct pressure_state state;
+   state.live = ralloc_array(NULL, BITSET_WORD, bitset_words);
+   state.def_slots = rzalloc_array(state.live, uint8_t, impl->ssa_alloc);
+
+   unsigned num_instrs = 0;
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr(instr, block) {
+         nir_foreach_ssa_def(instr, init_def_slots_cb, &state);
+         num_instrs = MAX2(num_instrs, instr->index + 1);
+      }
+   }
+
+   unsigned *pressure = NULL;
+   if (instr_pressure) {
+      pressure = rzalloc_array(mem_ctx, unsigned, num_instrs);
+      *instr_pressure = pressure;
+   }
+
+   unsigned max_pressure = 0;
+   nir_foreach_block(block, impl) {
+      memcpy(state.live, block->live_out, bitset_words * sizeof(BITSET_WORD));
+
+      state.pressure = 0;
+      unsigned i;
+      BITSET_FOREACH_SET(i, state.live, impl->ssa_alloc)
+         state.pressure += state.def_slots[i];
+
+      nir_if *following_if = nir_block_get_following_if(block);
+      if (following_if)
+         pressure_use_def(&state, &following_if->condition);
+
+      max_pressure = MAX2(max_pressure, state.pressure);
+
+      nir_foreach_instr_reverse(instr, block) {
+         if (instr->type == nir_instr_type_phi)
+            break;
+
+         /* Sources which die here are live across the instruction too. */
+         nir_foreach_src(instr, pressure_use_cb, &state);
+
+         unsigned instr_max = state.pressure;
+         nir_foreach_ssa_def(instr, pressure_def_cb, &state);
+         max_pressure = MAX2(max_pressure, state.pressure);
+         if (pressure)
+            pressure[instr->index] = state.pressure;
+
+         /* Remove the dead defs which were added above, then the defs
+          * which are live, which leaves the values live before instr.
+          */
+         state.pressure = instr_max;
+         nir_foreach_ssa_def(instr, pressure_kill_def_cb, &state);
+      }
+
+      max_pressure = MAX2(max_pressure, state.pressure);
+   }
+
+   ralloc_free(state.live);
+
+   return max_pressure;
+}
@@ -203,7 +203,10 @@ init_loop_block(nir_block *block, loop_info_state *state,
                                  .state = state };
 
    nir_foreach_instr(instr, block) {
-      state->loop->info->instr_cost += instr_cost(instr, options);
+      unsigned cost = instr_cost(instr, options);
+      if (options->instr_cost_cb)
+         cost = options->instr_cost_cb(instr, cost);
+      state->loop->info->instr_cost += cost;
       nir_foreach_ssa_def(instr, init_loop_def, &init_state);
    }
 
@@ -44,6 +44,7 @@ static bool
 try_fold_alu(nir_builder *b, nir_alu_instr *alu)
 {
    nir_const_value src[NIR_MAX_VEC_COMPONENTS][NIR_MAX_VEC_COMPONENTS];
+   nir_const_value *srcs[NIR_MAX_VEC_COMPONENTS];
 
    if (!alu->dest.dest.is_ssa)
       return false;
@@ -75,9 +76,17 @@ try_fold_alu(nir_builder *b, nir_alu_instr *alu)
          return false;
       nir_load_const_instr* load_const = nir_instr_as_load_const(src_instr);
 
-      for (unsigned j = 0; j < nir_ssa_alu_instr_src_components(alu, i);
-           j++) {
-         src[i][j] = load_const->value[alu->src[i].swizzle[j]];
+      /* The constant evaluation only reads the sources, so unswizzled
+       * sources can be used in place.
+       */
+      const unsigned num_src_components =
+         nir_ssa_alu_instr_src_components(alu, i);
+      if (nir_alu_src_is_trivial_ssa(alu, i)) {
+         srcs[i] = load_const->value;
+      } else {
+         for (unsigned j = 0; j < num_src_components; j++)
+            src[i][j] = load_const->value[alu->src[i].swizzle[j]];
+         srcs[i] = src[i];
       }
 
       /* We shouldn't have any source modifiers in the optimization loop. */
@@ -90,11 +99,11 @@ try_fold_alu(nir_builder *b, nir_alu_instr *alu)
    /* We shouldn't have any saturate modifiers in the optimization loop. */
    assert(!alu->dest.saturate);
 
+   /* Only the components that get written need to be cleared, so that the
+    * unused high bits of the values are zero.
+    */
    nir_const_value dest[NIR_MAX_VEC_COMPONENTS];
-   nir_const_value *srcs[NIR_MAX_VEC_COMPONENTS];
-   memset(dest, 0, sizeof(dest));
-   for (unsigned i = 0; i < nir_op_infos[alu->op].num_inputs; ++i)
-      srcs[i] = src[i];
+   memset(dest, 0, alu->dest.dest.ssa.num_components * sizeof(dest[0]));
    nir_eval_const_opcode(alu->op, dest, alu->dest.dest.ssa.num_components,
                          bit_size, srcs,
                          b->shader->info.float_controls_execution_mode);
@@ -32,43 +32,37 @@
  * Implements common subexpression elimination
  */
 
-/*
- * Visits and CSEs the given block and all its descendants in the dominance
- * tree recursively. Note that the instr_set is guaranteed to only ever
- * contain instructions that dominate the current block.
- */
-
 static bool
-cse_block(nir_block *block, struct set *dominance_set)
+dominates(const nir_instr *old_instr, const nir_instr *new_instr)
 {
-   bool progress = false;
-   struct set *instr_set = _mesa_set_clone(dominance_set, NULL);
-
-   nir_foreach_instr_safe(instr, block) {
-      if (nir_instr_set_add_or_rewrite(instr_set, instr)) {
-         progress = true;
-         nir_instr_remove(instr);
-      }
-   }
-
-   for (unsigned i = 0; i < block->num_dom_children; i++) {
-      nir_block *child = block->dom_children[i];
-      progress |= cse_block(child, instr_set);
-   }
-
-   _mesa_set_destroy(instr_set, NULL);
-
-   return progress;
+   return nir_block_dominates(old_instr->block, new_instr->block);
 }
 
+/*
+ * Visits the blocks in order, which visits every block after the blocks
+ * which dominate it, and uses a single instruction set.  When a duplicate is
+ * found in a block which isn't dominated by the one of the instruction in
+ * the set, the set keeps the newer instruction instead, since later blocks
+ * are more likely to be dominated by it.
+ */
 static bool
 nir_opt_cse_impl(nir_function_impl *impl)
 {
    struct set *instr_set = nir_instr_set_create(NULL);
 
+   _mesa_set_resize(instr_set, impl->ssa_alloc);
+
    nir_metadata_require(impl, nir_metadata_dominance);
 
-   bool progress = cse_block(nir_start_block(impl), instr_set);
+   bool progress = false;
+   nir_foreach_block(block, impl) {
+      nir_foreach_instr_safe(instr, block) {
+         if (nir_instr_set_add_or_rewrite(instr_set, instr, dominates)) {
+            progress = true;
+            nir_instr_remove(instr);
+         }
+      }
+   }
 
    if (progress) {
       nir_metadata_preserve(impl, nir_metadata_block_index |
@@ -30,6 +30,7 @@
 #include "nir_builder.h"
 #include "nir_worklist.h"
 #include "util/half_float.h"
+#include "util/u_math.h"
 
 /* This should be the same as nir_search_max_comm_ops in nir_algebraic.py. */
 #define NIR_SEARCH_MAX_COMM_OPS 8
@@ -38,6 +39,10 @@ struct match_state {
    bool inexact_match;
    bool has_exact_alu;
    uint8_t comm_op_direction;
+   /* Highest commutative expression index whose direction was looked at by
+    * the current match attempt, or -1 if none.
+    */
+   int8_t comm_op_max_used;
    unsigned variables_seen;
 
    /* Used for running the automaton on newly-constructed instructions. */
@@ -430,10 +435,13 @@ match_expression(const nir_search_expression *expr, nir_alu_instr *instr,
     * up its direction for the current search operation.  We'll use that value
     * to possibly flip the sources for the match.
     */
-   unsigned comm_op_flip =
-      (expr->comm_expr_idx >= 0 &&
-       expr->comm_expr_idx < NIR_SEARCH_MAX_COMM_OPS) ?
-      ((state->comm_op_direction >> expr->comm_expr_idx) & 1) : 0;
+   unsigned comm_op_flip = 0;
+   if (expr->comm_expr_idx >= 0 &&
+       expr->comm_expr_idx < NIR_SEARCH_MAX_COMM_OPS) {
+      comm_op_flip = (state->comm_op_direction >> expr->comm_expr_idx) & 1;
+      state->comm_op_max_used = MAX2(state->comm_op_max_used,
+                                     expr->comm_expr_idx);
+   }
 
    bool matched = true;
    for (unsigned i = 0; i < nir_op_infos[instr->op].num_inputs; i++) {
@@ -701,23 +709,27 @@ nir_replace_instr(nir_builder *build, nir_alu_instr *instr,
    assert(instr->dest.dest.is_ssa);
 
    struct match_state state;
-   state.inexact_match = false;
-   state.has_exact_alu = false;
    state.range_ht = range_ht;
    state.pass_op_table = pass_op_table;
 
    STATIC_ASSERT(sizeof(state.comm_op_direction) * 8 >= NIR_SEARCH_MAX_COMM_OPS);
 
-   unsigned comm_expr_combinations =
-      1 << MIN2(search->comm_exprs, NIR_SEARCH_MAX_COMM_OPS);
+   const unsigned num_comm_ops = MIN2(search->comm_exprs,
+                                      NIR_SEARCH_MAX_COMM_OPS);
+   const unsigned comm_expr_combinations = 1 << num_comm_ops;
 
    bool found = false;
-   for (unsigned comb = 0; comb < comm_expr_combinations; comb++) {
-      /* The bitfield of directions is just the current iteration.  Hooray for
-       * binary.
+   for (unsigned comb = 0; comb < comm_expr_combinations;) {
+      /* The bitfield of directions is the current iteration with its bits
+       * reversed, so that all the combinations which agree on the directions
+       * of the first few commutative expressions are contiguous.
        */
-      state.comm_op_direction = comb;
+      state.comm_op_direction =
+         util_bitreverse(comb) >> (32 - MAX2(num_comm_ops, 1));
+      state.comm_op_max_used = -1;
       state.variables_seen = 0;
+      state.inexact_match = false;
+      state.has_exact_alu = false;
 
       if (match_expression(search, instr,
                            instr->dest.dest.ssa.num_components,
@@ -725,6 +737,13 @@ nir_replace_instr(nir_builder *build, nir_alu_instr *instr,
          found = true;
          break;
       }
+
+      /* A failed match only depends on the directions it looked at, so every
+       * combination that only differs in the directions of later commutative
+       * expressions is going to fail in the same way.  Skip them.
+       */
+      const unsigned unused = num_comm_ops - (state.comm_op_max_used + 1);
+      comb = (comb | ((1u << unused) - 1)) + 1;
    }
    if (!found)
       return NULL;
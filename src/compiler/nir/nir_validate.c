@@ -27,6 +27,7 @@
 
 #include "nir.h"
 #include "c11/threads.h"
+#include "util/u_atomic.h"
 #include <assert.h>
 
 /*
@@ -1564,18 +1565,35 @@ validate_function_impl(nir_function_impl *impl, validate_state *state)
 }
 
 static void
-validate_function(nir_function *func, validate_state *state)
+validate_function(nir_function *func, validate_state *state, bool full)
 {
    if (func->impl != NULL) {
       validate_assert(state, func->impl->function == func);
-      validate_function_impl(func->impl, state);
+
+      if (full || !(func->impl->valid_metadata & nir_metadata_validated))
+         validate_function_impl(func->impl, state);
    }
 }
 
+/* With NIR_VALIDATE_INCREMENTAL=N, only the impls changed by a pass are
+ * validated, and only every Nth validation is a full one, to still catch
+ * passes which forget to invalidate metadata.
+ */
+static unsigned
+validate_full_interval(void)
+{
+   static int full_interval = -1;
+   if (full_interval < 0)
+      full_interval = env_var_as_unsigned("NIR_VALIDATE_INCREMENTAL", 0);
+
+   return full_interval;
+}
+
 static void
 init_validate_state(validate_state *state)
 {
-   state->mem_ctx = ralloc_context(NULL);
+   /* Everything allocated during validation is freed at once at the end. */
+   state->mem_ctx = ralloc_bump_context(NULL);
    state->regs = _mesa_pointer_hash_table_create(state->mem_ctx);
    state->ssa_srcs = _mesa_pointer_set_create(state->mem_ctx);
    state->ssa_defs_found = NULL;
@@ -1668,15 +1686,27 @@ nir_validate_shader(nir_shader *shader, const char *when)
    nir_foreach_variable_in_shader(var, shader)
      validate_var_decl(var, valid_modes, &state);
 
+   static unsigned validate_count;
+   const unsigned full_interval = validate_full_interval();
+   const bool full = full_interval <= 1 ||
+                     p_atomic_inc_return(&validate_count) % full_interval == 0;
+
    exec_list_validate(&shader->functions);
    foreach_list_typed(nir_function, func, node, &shader->functions) {
-      validate_function(func, &state);
+      validate_function(func, &state, full);
    }
 
    if (_mesa_hash_table_num_entries(state.errors) > 0)
       dump_errors(&state, when);
 
    destroy_validate_state(&state);
+
+   if (full_interval > 1) {
+      nir_foreach_function(func, shader) {
+         if (func->impl)
+            func->impl->valid_metadata |= nir_metadata_validated;
+      }
+   }
 }
 
 void
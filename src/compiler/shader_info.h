@@ -116,6 +116,13 @@ typedef struct shader_info {
    /* Descriptive name provided by the client; may be NULL */
    const char *label;
 
+   /**
+    * SHA1 identifying the source this exact shader was built from, set by
+    * the frontend when it can guarantee that (all zeros otherwise).
+    * Drivers can use it to key their shader cache instead of hashing the IR.
+    */
+   uint8_t source_sha1[20];
+
    /* Shader is internal, and should be ignored by things like NIR_PRINT */
    bool internal;
 
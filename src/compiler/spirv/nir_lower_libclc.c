@@ -33,20 +33,21 @@
 
 static bool
 lower_clc_call_instr(nir_instr *instr, nir_builder *b,
-                     const nir_shader *clc_shader,
+                     struct hash_table *clc_funcs,
                      struct hash_table *copy_vars)
 {
    nir_call_instr *call = nir_instr_as_call(instr);
-   nir_function *func = NULL;
-   nir_foreach_function(function, clc_shader) {
-      if (strcmp(function->name, call->callee->name) == 0) {
-         func = function;
-         break;
-      }
-   }
-   if (!func || !func->impl) {
+   if (!call->callee->name)
+      return false;
+
+   struct hash_entry *entry =
+      _mesa_hash_table_search(clc_funcs, call->callee->name);
+   if (!entry)
+      return false;
+
+   nir_function *func = entry->data;
+   if (!func->impl)
       return false;
-   }
 
    nir_ssa_def **params = rzalloc_array(b->shader, nir_ssa_def*, call->num_params);
 
@@ -65,7 +66,7 @@ lower_clc_call_instr(nir_instr *instr, nir_builder *b,
 
 static bool
 nir_lower_libclc_impl(nir_function_impl *impl,
-                      const nir_shader *clc_shader,
+                      struct hash_table *clc_funcs,
                       struct hash_table *copy_vars)
 {
    nir_builder b;
@@ -75,7 +76,7 @@ nir_lower_libclc_impl(nir_function_impl *impl,
    nir_foreach_block_safe(block, impl) {
       nir_foreach_instr_safe(instr, block) {
          if (instr->type == nir_instr_type_call)
-            progress |= lower_clc_call_instr(instr, &b, clc_shader, copy_vars);
+            progress |= lower_clc_call_instr(instr, &b, clc_funcs, copy_vars);
       }
    }
 
@@ -98,12 +99,25 @@ nir_lower_libclc(nir_shader *shader,
    struct hash_table *copy_vars = _mesa_pointer_hash_table_create(ra_ctx);
    bool progress = false, overall_progress = false;
 
+   /* libclc has thousands of functions and every call gets looked up by
+    * name, possibly several times as inlined bodies bring in more calls.
+    * Index them by name once.  The first function with a given name wins,
+    * as with the linear search this replaces.
+    */
+   struct hash_table *clc_funcs = _mesa_string_hash_table_create(ra_ctx);
+   nir_foreach_function(function, clc_shader) {
+      if (!function->name ||
+          _mesa_hash_table_search(clc_funcs, function->name))
+         continue;
+      _mesa_hash_table_insert(clc_funcs, function->name, function);
+   }
+
    /* do progress passes inside the pass */
    do {
       progress = false;
       nir_foreach_function(function, shader) {
          if (function->impl)
-            progress |= nir_lower_libclc_impl(function->impl, clc_shader, copy_vars);
+            progress |= nir_lower_libclc_impl(function->impl, clc_funcs, copy_vars);
       }
       overall_progress |= progress;
    } while (progress);
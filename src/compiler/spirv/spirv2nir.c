@@ -32,12 +32,15 @@
  */
 
 #include "spirv/nir_spirv.h"
+#include "util/os_time.h"
 
 #include <sys/mman.h>
+#include <sys/resource.h>
 #include <sys/types.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <errno.h>
 #include <string.h>
 #include <getopt.h>
@@ -78,15 +81,36 @@ print_usage(char *exec_name, FILE *f)
 "  -e, --entry <name>      Specify the entry-point name.\n"
 "  -g, --opengl            Use OpenGL environment instead of Vulkan for\n"
 "                          graphics stages.\n"
+"  -b, --bench <count>     Translate the shader <count> times and print the\n"
+"                          compile time, peak memory and instruction count\n"
+"                          as JSON instead of the NIR.\n"
    , exec_name);
 }
 
+static unsigned
+count_instrs(nir_shader *nir)
+{
+   unsigned count = 0;
+
+   nir_foreach_function(func, nir) {
+      if (!func->impl)
+         continue;
+      nir_foreach_block(block, func->impl) {
+         nir_foreach_instr(instr, block)
+            count++;
+      }
+   }
+
+   return count;
+}
+
 int main(int argc, char **argv)
 {
    gl_shader_stage shader_stage = MESA_SHADER_FRAGMENT;
    char *entry_point = "main";
    int ch;
    enum nir_spirv_execution_environment env = NIR_SPIRV_VULKAN;
+   unsigned bench_count = 0;
 
    static struct option long_options[] =
      {
@@ -94,10 +118,11 @@ int main(int argc, char **argv)
        {"stage",  required_argument, 0, 's'},
        {"entry",  required_argument, 0, 'e'},
        {"opengl",       no_argument, 0, 'g'},
+       {"bench",  required_argument, 0, 'b'},
        {0, 0, 0, 0}
      };
 
-   while ((ch = getopt_long(argc, argv, "hs:e:g", long_options, NULL)) != -1)
+   while ((ch = getopt_long(argc, argv, "hs:e:gb:", long_options, NULL)) != -1)
    {
       switch (ch)
       {
@@ -119,6 +144,15 @@ int main(int argc, char **argv)
       case 'g':
          env = NIR_SPIRV_OPENGL;
          break;
+      case 'b':
+         bench_count = strtoul(optarg, NULL, 0);
+         if (bench_count == 0)
+         {
+            fprintf(stderr, "Invalid benchmark count \"%s\"\n", optarg);
+            print_usage(argv[0], stderr);
+            return 1;
+         }
+         break;
       default:
          fprintf(stderr, "Unrecognized option \"%s\".\n", optarg);
          print_usage(argv[0], stderr);
@@ -171,14 +205,49 @@ int main(int argc, char **argv)
       spirv_opts.caps.kernel = true;
    }
 
-   nir_shader *nir = spirv_to_nir(map, word_count, NULL, 0,
-                                  shader_stage, entry_point,
-                                  &spirv_opts, NULL);
+   if (bench_count) {
+      int64_t min_ns = INT64_MAX, max_ns = 0, total_ns = 0;
+      unsigned instr_count = 0;
 
-   if (nir)
-      nir_print_shader(nir, stderr);
-   else
-      fprintf(stderr, "SPIRV to NIR compilation failed\n");
+      for (unsigned i = 0; i < bench_count; i++) {
+         int64_t start = os_time_get_nano();
+         nir_shader *nir = spirv_to_nir(map, word_count, NULL, 0,
+                                        shader_stage, entry_point,
+                                        &spirv_opts, NULL);
+         int64_t elapsed = os_time_get_nano() - start;
+
+         if (!nir) {
+            fprintf(stderr, "SPIRV to NIR compilation failed\n");
+            glsl_type_singleton_decref();
+            return 1;
+         }
+
+         min_ns = MIN2(min_ns, elapsed);
+         max_ns = MAX2(max_ns, elapsed);
+         total_ns += elapsed;
+         instr_count = count_instrs(nir);
+         ralloc_free(nir);
+      }
+
+      struct rusage usage;
+      getrusage(RUSAGE_SELF, &usage);
+
+      printf("{\"file\": \"%s\", \"runs\": %u, "
+             "\"min_ms\": %.3f, \"mean_ms\": %.3f, \"max_ms\": %.3f, "
+             "\"peak_rss_kb\": %ld, \"instructions\": %u}\n",
+             filename, bench_count,
+             min_ns / 1e6, total_ns / 1e6 / bench_count, max_ns / 1e6,
+             usage.ru_maxrss, instr_count);
+   } else {
+      nir_shader *nir = spirv_to_nir(map, word_count, NULL, 0,
+                                     shader_stage, entry_point,
+                                     &spirv_opts, NULL);
+
+      if (nir)
+         nir_print_shader(nir, stderr);
+      else
+         fprintf(stderr, "SPIRV to NIR compilation failed\n");
+   }
 
    glsl_type_singleton_decref();
 
@@ -573,7 +573,7 @@ vtn_process_block(struct vtn_builder *b,
    if (!list_is_empty(cf_list)) {
       /* vtn_process_block() acts like an iterator: it processes the given
        * block and then returns the next block to process.  For a given
-       * control-flow construct, vtn_build_cfg() calls vtn_process_block()
+       * control-flow construct, vtn_build_structured_cfg() calls vtn_process_block()
        * repeatedly until it finally returns NULL.  Therefore, we know that
        * the only blocks on which vtn_process_block() can be called are either
        * the first block in a construct or a block that vtn_process_block()
@@ -846,33 +846,34 @@ vtn_build_cfg(struct vtn_builder *b, const uint32_t *words, const uint32_t *end)
 {
    vtn_foreach_instruction(b, words, end,
                            vtn_cfg_handle_prepass_instruction);
+}
 
-   if (b->shader->info.stage == MESA_SHADER_KERNEL)
-      return;
+/* The structured CFG of a function is only built once it's known to be
+ * emitted, so modules with many entry points or large libraries don't pay
+ * for walking the blocks of functions that are never called.
+ */
+static void
+vtn_build_structured_cfg(struct vtn_builder *b, struct vtn_function *func)
+{
+   /* We build the CFG for each function by doing a breadth-first search on
+    * the control-flow graph.  We keep track of our state using a worklist.
+    * Doing a BFS ensures that we visit each structured control-flow
+    * construct and its merge node before we visit the stuff inside the
+    * construct.
+    */
+   struct list_head work_list;
+   list_inithead(&work_list);
+   vtn_add_cfg_work_item(b, &work_list, &func->node, &func->body,
+                         func->start_block);
 
-   vtn_foreach_cf_node(func_node, &b->functions) {
-      struct vtn_function *func = vtn_cf_node_as_function(func_node);
+   while (!list_is_empty(&work_list)) {
+      struct vtn_cfg_work_item *work =
+         list_first_entry(&work_list, struct vtn_cfg_work_item, link);
+      list_del(&work->link);
 
-      /* We build the CFG for each function by doing a breadth-first search on
-       * the control-flow graph.  We keep track of our state using a worklist.
-       * Doing a BFS ensures that we visit each structured control-flow
-       * construct and its merge node before we visit the stuff inside the
-       * construct.
-       */
-      struct list_head work_list;
-      list_inithead(&work_list);
-      vtn_add_cfg_work_item(b, &work_list, &func->node, &func->body,
-                            func->start_block);
-
-      while (!list_is_empty(&work_list)) {
-         struct vtn_cfg_work_item *work =
-            list_first_entry(&work_list, struct vtn_cfg_work_item, link);
-         list_del(&work->link);
-
-         for (struct vtn_block *block = work->start_block; block; ) {
-            block = vtn_process_block(b, &work_list, work->cf_parent,
-                                      work->cf_list, block);
-         }
+      for (struct vtn_block *block = work->start_block; block; ) {
+         block = vtn_process_block(b, &work_list, work->cf_parent,
+                                   work->cf_list, block);
       }
    }
 }
@@ -1384,6 +1385,7 @@ vtn_function_emit(struct vtn_builder *b, struct vtn_function *func,
       impl->structured = false;
       vtn_emit_cf_func_unstructured(b, func, instruction_handler);
    } else {
+      vtn_build_structured_cfg(b, func);
       vtn_emit_cf_list_structured(b, &func->body, NULL, NULL,
                                   instruction_handler);
    }
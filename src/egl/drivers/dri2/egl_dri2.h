@@ -53,6 +53,7 @@ struct wl_registry;
 struct wl_shm;
 struct wl_surface;
 struct zwp_linux_dmabuf_v1;
+struct zwp_linux_dmabuf_feedback_v1;
 #endif
 
 #include <GL/gl.h>
@@ -87,6 +88,22 @@ struct zwp_linux_dmabuf_v1;
 
 struct wl_buffer;
 
+#ifdef HAVE_WAYLAND_PLATFORM
+/* State of a zwp_linux_dmabuf_feedback_v1 object while its events arrive */
+struct dri2_wl_dmabuf_feedback {
+   struct zwp_linux_dmabuf_feedback_v1 *feedback;
+   /* format table shared by the compositor, mapped read-only */
+   const void *format_table;
+   uint32_t format_table_size;
+   /* flags of the tranche being received */
+   bool tranche_scanout;
+   /* modifiers of the preferred tranche, collected until 'done' */
+   struct u_vector pending_modifiers;
+   bool pending_scanout;
+   bool pending_set;
+};
+#endif
+
 struct dri2_egl_display_vtbl {
    /* mandatory on Wayland, unused otherwise */
    int (*authenticate)(_EGLDisplay *disp, uint32_t id);
@@ -238,6 +255,7 @@ struct dri2_egl_display
    struct wl_shm            *wl_shm;
    struct wl_event_queue    *wl_queue;
    struct zwp_linux_dmabuf_v1 *wl_dmabuf;
+   struct dri2_wl_dmabuf_feedback wl_default_feedback;
    struct u_vector          *wl_modifiers;
    bool                      authenticated;
    BITSET_DECLARE(formats, EGL_DRI2_MAX_FORMATS);
@@ -294,6 +312,11 @@ struct dri2_egl_surface
    struct wl_drm         *wl_drm_wrapper;
    struct wl_callback    *throttle_callback;
    int                    format;
+   /* dma-buf feedback; dmabuf_feedback.feedback is NULL if unsupported */
+   struct dri2_wl_dmabuf_feedback dmabuf_feedback;
+   struct u_vector        wl_modifiers;
+   bool                   wl_scanout;
+   bool                   received_dmabuf_feedback;
 #endif
 
 #ifdef HAVE_DRM_PLATFORM
@@ -50,6 +50,11 @@
 #include "wayland-drm-client-protocol.h"
 #include "linux-dmabuf-unstable-v1-client-protocol.h"
 
+/* dma-buf feedback is part of linux-dmabuf v4, from wayland-protocols 1.24 */
+#ifdef ZWP_LINUX_DMABUF_V1_GET_SURFACE_FEEDBACK_SINCE_VERSION
+#define HAVE_WL_DMABUF_FEEDBACK 1
+#endif
+
 /*
  * The index of entries in this table is used as a bitmask in
  * dri2_dpy->formats, which tracks the formats supported by our server.
@@ -296,6 +301,323 @@ get_wl_surface_proxy(struct wl_egl_window *window)
    return wl_proxy_create_wrapper(window->surface);
 }
 
+#ifdef HAVE_WL_DMABUF_FEEDBACK
+struct dri2_wl_format_table_entry {
+   uint32_t format;
+   uint32_t padding;
+   uint64_t modifier;
+};
+
+static bool
+dmabuf_feedback_init(struct dri2_wl_dmabuf_feedback *fb)
+{
+   memset(fb, 0, sizeof(*fb));
+   return u_vector_init(&fb->pending_modifiers, sizeof(uint64_t), 32);
+}
+
+static void
+dmabuf_feedback_fini(struct dri2_wl_dmabuf_feedback *fb)
+{
+   if (fb->feedback)
+      zwp_linux_dmabuf_feedback_v1_destroy(fb->feedback);
+   if (fb->format_table)
+      munmap((void *)fb->format_table, fb->format_table_size);
+   u_vector_finish(&fb->pending_modifiers);
+   memset(fb, 0, sizeof(*fb));
+}
+
+static void
+dmabuf_feedback_set_format_table(struct dri2_wl_dmabuf_feedback *fb,
+                                 int32_t fd, uint32_t size)
+{
+   if (fb->format_table)
+      munmap((void *)fb->format_table, fb->format_table_size);
+
+   fb->format_table = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+   fb->format_table_size = size;
+   if (fb->format_table == MAP_FAILED) {
+      fb->format_table = NULL;
+      fb->format_table_size = 0;
+   }
+
+   close(fd);
+}
+
+static const struct dri2_wl_format_table_entry *
+dmabuf_feedback_get_entry(const struct dri2_wl_dmabuf_feedback *fb,
+                          uint16_t index)
+{
+   const struct dri2_wl_format_table_entry *table = fb->format_table;
+
+   if (!table || (index + 1) * sizeof(*table) > fb->format_table_size)
+      return NULL;
+
+   return &table[index];
+}
+
+static bool
+modifiers_contain(struct u_vector *modifiers, uint64_t modifier)
+{
+   uint64_t *mod;
+
+   u_vector_foreach(mod, modifiers) {
+      if (*mod == modifier)
+         return true;
+   }
+
+   return false;
+}
+
+static bool
+modifiers_equal(struct u_vector *a, struct u_vector *b)
+{
+   uint64_t *mod;
+
+   if (u_vector_length(a) != u_vector_length(b))
+      return false;
+
+   u_vector_foreach(mod, a) {
+      if (!modifiers_contain(b, *mod))
+         return false;
+   }
+
+   return true;
+}
+
+static void
+dmabuf_feedback_ignore_event(void *data,
+                             struct zwp_linux_dmabuf_feedback_v1 *feedback)
+{
+}
+
+static void
+dmabuf_feedback_ignore_device(void *data,
+                              struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                              struct wl_array *device)
+{
+   /* the device was already picked through wl_drm */
+}
+
+static void
+dmabuf_feedback_ignore_flags(void *data,
+                             struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                             uint32_t flags)
+{
+}
+
+static void
+default_dmabuf_feedback_format_table(void *data,
+                                     struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                                     int32_t fd, uint32_t size)
+{
+   struct dri2_egl_display *dri2_dpy = data;
+
+   dmabuf_feedback_set_format_table(&dri2_dpy->wl_default_feedback, fd, size);
+}
+
+static void
+default_dmabuf_feedback_tranche_formats(void *data,
+                                        struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                                        struct wl_array *indices)
+{
+   struct dri2_egl_display *dri2_dpy = data;
+   uint16_t *index;
+
+   /* With linux-dmabuf v4 the default feedback replaces the 'modifier'
+    * events, so every tranche feeds the display-wide modifier lists.
+    */
+   wl_array_for_each(index, indices) {
+      const struct dri2_wl_format_table_entry *entry =
+         dmabuf_feedback_get_entry(&dri2_dpy->wl_default_feedback, *index);
+      int visual_idx;
+      uint64_t *mod;
+
+      if (!entry)
+         continue;
+
+      visual_idx = dri2_wl_visual_idx_from_fourcc(entry->format);
+      if (visual_idx == -1)
+         continue;
+
+      BITSET_SET(dri2_dpy->formats, visual_idx);
+
+      if (modifiers_contain(&dri2_dpy->wl_modifiers[visual_idx],
+                            entry->modifier))
+         continue;
+
+      mod = u_vector_add(&dri2_dpy->wl_modifiers[visual_idx]);
+      if (mod)
+         *mod = entry->modifier;
+   }
+}
+
+static const struct zwp_linux_dmabuf_feedback_v1_listener
+default_dmabuf_feedback_listener = {
+   .done = dmabuf_feedback_ignore_event,
+   .format_table = default_dmabuf_feedback_format_table,
+   .main_device = dmabuf_feedback_ignore_device,
+   .tranche_done = dmabuf_feedback_ignore_event,
+   .tranche_target_device = dmabuf_feedback_ignore_device,
+   .tranche_formats = default_dmabuf_feedback_tranche_formats,
+   .tranche_flags = dmabuf_feedback_ignore_flags,
+};
+
+static void
+surface_dmabuf_feedback_format_table(void *data,
+                                     struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                                     int32_t fd, uint32_t size)
+{
+   struct dri2_egl_surface *dri2_surf = data;
+
+   dmabuf_feedback_set_format_table(&dri2_surf->dmabuf_feedback, fd, size);
+}
+
+static void
+surface_dmabuf_feedback_tranche_flags(void *data,
+                                      struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                                      uint32_t flags)
+{
+   struct dri2_egl_surface *dri2_surf = data;
+
+   dri2_surf->dmabuf_feedback.tranche_scanout =
+      flags & ZWP_LINUX_DMABUF_FEEDBACK_V1_TRANCHE_FLAGS_SCANOUT;
+}
+
+static void
+surface_dmabuf_feedback_tranche_formats(void *data,
+                                        struct zwp_linux_dmabuf_feedback_v1 *feedback,
+                                        struct wl_array *indices)
+{
+   struct dri2_egl_surface *dri2_surf = data;
+   struct dri2_wl_dmabuf_feedback *fb = &dri2_surf->dmabuf_feedback;
+   uint16_t *index;
+
+   /* Tranches are sent in order of preference, so only the first one that
+    * has the surface format matters.
+    */
+   if (fb->pending_set)
+      return;
+
+   wl_array_for_each(index, indices) {
+      const struct dri2_wl_format_table_entry *entry =
+         dmabuf_feedback_get_entry(fb, *index);
+      uint64_t *mod;
+
+      if (!entry || entry->format != dri2_surf->format)
+         continue;
+
+      mod = u_vector_add(&fb->pending_modifiers);
+      if (mod)
+         *mod = entry->modifier;
+   }
+}
+
+static void
+surface_dmabuf_feedback_tranche_done(void *data,
+                                     struct zwp_linux_dmabuf_feedback_v1 *feedback)
+{
+   struct dri2_egl_surface *dri2_surf = data;
+   struct dri2_wl_dmabuf_feedback *fb = &dri2_surf->dmabuf_feedback;
+
+   if (!fb->pending_set && u_vector_length(&fb->pending_modifiers) > 0) {
+      fb->pending_set = true;
+      fb->pending_scanout = fb->tranche_scanout;
+   }
+
+   fb->tranche_scanout = false;
+}
+
+static void
+surface_dmabuf_feedback_done(void *data,
+                             struct zwp_linux_dmabuf_feedback_v1 *feedback)
+{
+   struct dri2_egl_surface *dri2_surf = data;
+   struct dri2_wl_dmabuf_feedback *fb = &dri2_surf->dmabuf_feedback;
+
+   /* Reallocate the buffers with the new modifiers once the preferred
+    * tranche changed, e.g. when the compositor can scan the surface out.
+    */
+   if (fb->pending_set &&
+       (fb->pending_scanout != dri2_surf->wl_scanout ||
+        !modifiers_equal(&fb->pending_modifiers, &dri2_surf->wl_modifiers))) {
+      struct u_vector tmp = dri2_surf->wl_modifiers;
+
+      dri2_surf->wl_modifiers = fb->pending_modifiers;
+      fb->pending_modifiers = tmp;
+      dri2_surf->wl_scanout = fb->pending_scanout;
+      dri2_surf->received_dmabuf_feedback = true;
+   }
+
+   /* get_back_bo() reads the modifiers as a plain array starting at the
+    * tail, so empty the vector by rewinding it rather than removing entries.
+    */
+   fb->pending_modifiers.head = 0;
+   fb->pending_modifiers.tail = 0;
+   fb->pending_set = false;
+}
+
+static const struct zwp_linux_dmabuf_feedback_v1_listener
+surface_dmabuf_feedback_listener = {
+   .done = surface_dmabuf_feedback_done,
+   .format_table = surface_dmabuf_feedback_format_table,
+   .main_device = dmabuf_feedback_ignore_device,
+   .tranche_done = surface_dmabuf_feedback_tranche_done,
+   .tranche_target_device = dmabuf_feedback_ignore_device,
+   .tranche_formats = surface_dmabuf_feedback_tranche_formats,
+   .tranche_flags = surface_dmabuf_feedback_tranche_flags,
+};
+
+static void
+dri2_wl_surface_init_dmabuf_feedback(struct dri2_egl_surface *dri2_surf)
+{
+   struct dri2_egl_display *dri2_dpy =
+      dri2_egl_display(dri2_surf->base.Resource.Display);
+   struct zwp_linux_dmabuf_v1 *dmabuf_wrapper;
+   struct zwp_linux_dmabuf_feedback_v1 *feedback;
+
+   if (!dmabuf_feedback_init(&dri2_surf->dmabuf_feedback))
+      return;
+
+   if (!u_vector_init(&dri2_surf->wl_modifiers, sizeof(uint64_t), 32))
+      goto fail;
+
+   dmabuf_wrapper = wl_proxy_create_wrapper(dri2_dpy->wl_dmabuf);
+   if (!dmabuf_wrapper)
+      goto fail_modifiers;
+   wl_proxy_set_queue((struct wl_proxy *)dmabuf_wrapper, dri2_surf->wl_queue);
+
+   feedback = zwp_linux_dmabuf_v1_get_surface_feedback(dmabuf_wrapper,
+                                                       dri2_surf->wl_surface_wrapper);
+   wl_proxy_wrapper_destroy(dmabuf_wrapper);
+   if (!feedback)
+      goto fail_modifiers;
+
+   zwp_linux_dmabuf_feedback_v1_add_listener(feedback,
+                                             &surface_dmabuf_feedback_listener,
+                                             dri2_surf);
+   dri2_surf->dmabuf_feedback.feedback = feedback;
+
+   /* Get the initial feedback so the first buffers already use it */
+   wl_display_roundtrip_queue(dri2_dpy->wl_dpy, dri2_surf->wl_queue);
+   return;
+
+ fail_modifiers:
+   u_vector_finish(&dri2_surf->wl_modifiers);
+ fail:
+   dmabuf_feedback_fini(&dri2_surf->dmabuf_feedback);
+}
+
+static void
+dri2_wl_surface_fini_dmabuf_feedback(struct dri2_egl_surface *dri2_surf)
+{
+   if (!dri2_surf->dmabuf_feedback.feedback)
+      return;
+
+   dmabuf_feedback_fini(&dri2_surf->dmabuf_feedback);
+   u_vector_finish(&dri2_surf->wl_modifiers);
+}
+#endif
+
 /**
  * Called via eglCreateWindowSurface(), drv->CreateWindowSurface().
  */
@@ -373,6 +695,16 @@ dri2_wl_create_window_surface(_EGLDisplay *disp, _EGLConfig *conf,
    wl_proxy_set_queue((struct wl_proxy *)dri2_surf->wl_surface_wrapper,
                       dri2_surf->wl_queue);
 
+#ifdef HAVE_WL_DMABUF_FEEDBACK
+   /* With PRIME the buffers the compositor sees are linear copies, so the
+    * feedback would not apply to what we render into.
+    */
+   if (dri2_dpy->wl_dmabuf && !dri2_dpy->is_different_gpu &&
+       wl_proxy_get_version((struct wl_proxy *)dri2_dpy->wl_dmabuf) >=
+       ZWP_LINUX_DMABUF_V1_GET_SURFACE_FEEDBACK_SINCE_VERSION)
+      dri2_wl_surface_init_dmabuf_feedback(dri2_surf);
+#endif
+
    dri2_surf->wl_win = window;
    dri2_surf->wl_win->driver_private = dri2_surf;
    dri2_surf->wl_win->destroy_window_callback = destroy_window_callback;
@@ -387,6 +719,9 @@ dri2_wl_create_window_surface(_EGLDisplay *disp, _EGLConfig *conf,
    return &dri2_surf->base;
 
  cleanup_surf_wrapper:
+#ifdef HAVE_WL_DMABUF_FEEDBACK
+   dri2_wl_surface_fini_dmabuf_feedback(dri2_surf);
+#endif
    wl_proxy_wrapper_destroy(dri2_surf->wl_surface_wrapper);
  cleanup_dpy_wrapper:
    wl_proxy_wrapper_destroy(dri2_surf->wl_dpy_wrapper);
@@ -451,6 +786,9 @@ dri2_wl_destroy_surface(_EGLDisplay *disp, _EGLSurface *surf)
       dri2_surf->wl_win->destroy_window_callback = NULL;
    }
 
+#ifdef HAVE_WL_DMABUF_FEEDBACK
+   dri2_wl_surface_fini_dmabuf_feedback(dri2_surf);
+#endif
    wl_proxy_wrapper_destroy(dri2_surf->wl_surface_wrapper);
    wl_proxy_wrapper_destroy(dri2_surf->wl_dpy_wrapper);
    if (dri2_surf->wl_drm_wrapper)
@@ -511,8 +849,16 @@ get_back_bo(struct dri2_egl_surface *dri2_surf)
    assert(visual_idx != -1);
    dri_image_format = dri2_wl_visuals[visual_idx].dri_image_format;
    linear_dri_image_format = dri_image_format;
-   modifiers = u_vector_tail(&dri2_dpy->wl_modifiers[visual_idx]);
-   num_modifiers = u_vector_length(&dri2_dpy->wl_modifiers[visual_idx]);
+
+   /* Prefer the modifiers the compositor asked for on this surface */
+   if (dri2_surf->dmabuf_feedback.feedback &&
+       u_vector_length(&dri2_surf->wl_modifiers) > 0) {
+      modifiers = u_vector_tail(&dri2_surf->wl_modifiers);
+      num_modifiers = u_vector_length(&dri2_surf->wl_modifiers);
+   } else {
+      modifiers = u_vector_tail(&dri2_dpy->wl_modifiers[visual_idx]);
+      num_modifiers = u_vector_length(&dri2_dpy->wl_modifiers[visual_idx]);
+   }
 
    if (num_modifiers == 1 && modifiers[0] == DRM_FORMAT_MOD_INVALID) {
       /* For the purposes of this function, an INVALID modifier on its own
@@ -567,6 +913,10 @@ get_back_bo(struct dri2_egl_surface *dri2_surf)
 
    use_flags = __DRI_IMAGE_USE_SHARE | __DRI_IMAGE_USE_BACKBUFFER;
 
+   /* Only used when allocating without modifiers */
+   if (dri2_surf->wl_scanout)
+      use_flags |= __DRI_IMAGE_USE_SCANOUT;
+
    if (dri2_surf->base.ProtectedContent) {
       /* Protected buffers can't be read from another GPU */
       if (dri2_dpy->is_different_gpu)
@@ -677,8 +1027,10 @@ update_buffers(struct dri2_egl_surface *dri2_surf)
    }
 
    if (dri2_surf->base.Width != dri2_surf->wl_win->attached_width ||
-       dri2_surf->base.Height != dri2_surf->wl_win->attached_height) {
+       dri2_surf->base.Height != dri2_surf->wl_win->attached_height ||
+       dri2_surf->received_dmabuf_feedback) {
       dri2_wl_release_buffers(dri2_surf);
+      dri2_surf->received_dmabuf_feedback = false;
    }
 
    if (get_back_bo(dri2_surf) < 0) {
@@ -1340,6 +1692,20 @@ registry_handle_global_drm(void *data, struct wl_registry *registry,
          wl_registry_bind(registry, name, &wl_drm_interface, MIN2(version, 2));
       wl_drm_add_listener(dri2_dpy->wl_drm, &drm_listener, dri2_dpy);
    } else if (strcmp(interface, "zwp_linux_dmabuf_v1") == 0 && version >= 3) {
+#ifdef HAVE_WL_DMABUF_FEEDBACK
+      if (version >= ZWP_LINUX_DMABUF_V1_GET_DEFAULT_FEEDBACK_SINCE_VERSION &&
+          dmabuf_feedback_init(&dri2_dpy->wl_default_feedback)) {
+         dri2_dpy->wl_dmabuf =
+            wl_registry_bind(registry, name, &zwp_linux_dmabuf_v1_interface,
+                             ZWP_LINUX_DMABUF_V1_GET_DEFAULT_FEEDBACK_SINCE_VERSION);
+         dri2_dpy->wl_default_feedback.feedback =
+            zwp_linux_dmabuf_v1_get_default_feedback(dri2_dpy->wl_dmabuf);
+         zwp_linux_dmabuf_feedback_v1_add_listener(dri2_dpy->wl_default_feedback.feedback,
+                                                   &default_dmabuf_feedback_listener,
+                                                   dri2_dpy);
+         return;
+      }
+#endif
       dri2_dpy->wl_dmabuf =
          wl_registry_bind(registry, name, &zwp_linux_dmabuf_v1_interface,
                           MIN2(version, 3));
@@ -2110,6 +2476,10 @@ dri2_teardown_wayland(struct dri2_egl_display *dri2_dpy)
 {
    if (dri2_dpy->wl_drm)
       wl_drm_destroy(dri2_dpy->wl_drm);
+#ifdef HAVE_WL_DMABUF_FEEDBACK
+   if (dri2_dpy->wl_default_feedback.feedback)
+      dmabuf_feedback_fini(&dri2_dpy->wl_default_feedback);
+#endif
    if (dri2_dpy->wl_dmabuf)
       zwp_linux_dmabuf_v1_destroy(dri2_dpy->wl_dmabuf);
    if (dri2_dpy->wl_shm)
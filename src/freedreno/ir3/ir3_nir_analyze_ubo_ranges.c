@@ -354,6 +354,17 @@ instr_is_load_ubo(nir_instr *instr)
 	return op == nir_intrinsic_load_ubo;
 }
 
+static bool
+block_in_loop(nir_block *block)
+{
+	for (nir_cf_node *node = block->cf_node.parent; node; node = node->parent) {
+		if (node->type == nir_cf_node_loop)
+			return true;
+	}
+
+	return false;
+}
+
 void
 ir3_nir_analyze_ubo_ranges(nir_shader *nir, struct ir3_shader_variant *v)
 {
@@ -374,15 +385,24 @@ ir3_nir_analyze_ubo_ranges(nir_shader *nir, struct ir3_shader_variant *v)
 
 	memset(state, 0, sizeof(*state));
 
+	/* Loads inside loops are executed far more often than the rest, so let
+	 * them claim const space first; when the space runs out, it's the
+	 * straight-line loads that are left as ldc.
+	 */
 	uint32_t upload_remaining = max_upload;
-	nir_foreach_function (function, nir) {
-		if (function->impl) {
-			nir_foreach_block (block, function->impl) {
-				nir_foreach_instr (instr, block) {
-					if (instr_is_load_ubo(instr))
-						gather_ubo_ranges(nir, nir_instr_as_intrinsic(instr),
-								state, compiler->const_upload_unit,
-								&upload_remaining);
+	for (int in_loop = 1; in_loop >= 0; in_loop--) {
+		nir_foreach_function (function, nir) {
+			if (function->impl) {
+				nir_foreach_block (block, function->impl) {
+					if (block_in_loop(block) != in_loop)
+						continue;
+
+					nir_foreach_instr (instr, block) {
+						if (instr_is_load_ubo(instr))
+							gather_ubo_ranges(nir, nir_instr_as_intrinsic(instr),
+									state, compiler->const_upload_unit,
+									&upload_remaining);
+					}
 				}
 			}
 		}
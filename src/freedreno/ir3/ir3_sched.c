@@ -30,6 +30,7 @@
 
 #include "ir3.h"
 #include "ir3_compiler.h"
+#include "ir3_ra.h"
 
 #ifdef DEBUG
 #define SCHED_DEBUG (ir3_shader_debug & IR3_DBG_SCHEDMSGS)
@@ -69,6 +70,16 @@
  * and we encounter a conflicting write to a special register, we try
  * to schedule any remaining instructions that use that value first.
  *
+ * To avoid leaving RA with more than it can allocate (and to keep the
+ * footprint low enough to not cost us waves), a running estimate of the
+ * number of live values in the block is kept, using the same split as
+ * RA's register classes: half and full regs share the merged register
+ * file (a half reg being half the size of a full reg), while shared regs
+ * come from a separate file and don't count.  Once the estimate passes
+ * SCHED_PRESSURE_LIMIT, we stop trading register pressure for avoiding
+ * (ss)/(sy) syncs, and when something must increase pressure we pick
+ * whatever increases it the least.
+ *
  * TODO we can detect too-large live_values here.. would be a good place
  * to "spill" cheap things, like move from uniform/immed.  (Constructing
  * list of ssa def consumers before sched pass would make this easier.
@@ -99,8 +110,18 @@ struct ir3_sched_ctx {
 
 	int sfu_delay;
 	int tex_delay;
+
+	/* estimated live values in the current block, in half-reg units: */
+	int live;
 };
 
+/* Pressure (in half-reg units) above which we start to prioritize
+ * keeping register usage down over avoiding nops/syncs.  Half of the
+ * full register file, so that shaders which can fit in it are not pushed
+ * over by the scheduler and keep their occupancy.
+ */
+#define SCHED_PRESSURE_LIMIT  NUM_REGS
+
 struct ir3_sched_node {
 	struct dag_node dag;     /* must be first for util_dynarray_foreach */
 	struct ir3_instruction *instr;
@@ -153,6 +174,70 @@ static bool is_scheduled(struct ir3_instruction *instr)
 	return !!(instr->flags & IR3_INSTR_MARK);
 }
 
+static int use_count(struct ir3_instruction *instr);
+
+/* size of an instruction's dst in the merged register file, in half-regs: */
+static unsigned
+dest_size(struct ir3_instruction *instr)
+{
+	unsigned regs = dest_regs(instr);
+
+	if (!regs || !writes_gpr(instr) || is_shared(instr))
+		return 0;
+
+	return is_half(instr) ? regs : 2 * regs;
+}
+
+static bool
+over_pressure(struct ir3_sched_ctx *ctx)
+{
+	return ctx->live > SCHED_PRESSURE_LIMIT;
+}
+
+/* Update the live value estimate after an instruction is scheduled: its
+ * dst becomes live, and any src in this block which has no remaining
+ * unscheduled users dies.
+ */
+static void
+update_live(struct ir3_sched_ctx *ctx, struct ir3_instruction *instr)
+{
+	struct ir3_sched_node *n = instr->data;
+
+	/* for collect srcs, the whole vecN became live with the first src: */
+	if (n->collect) {
+		if (!n->partially_live)
+			ctx->live += dest_size(instr) * (n->collect->regs_count - 1);
+	} else {
+		ctx->live += dest_size(instr);
+	}
+
+	foreach_ssa_src_n (src, i, instr) {
+		if (__is_false_dep(instr, i))
+			continue;
+
+		if (src->block != instr->block)
+			continue;
+
+		if (use_count(src) != 0)
+			continue;
+
+		/* don't count the same src twice: */
+		bool dup = false;
+		foreach_ssa_src_n (other, j, instr) {
+			if (j >= i)
+				break;
+			if (other == src)
+				dup = true;
+		}
+		if (dup)
+			continue;
+
+		ctx->live -= dest_size(src);
+	}
+
+	ctx->live = MAX2(ctx->live, 0);
+}
+
 static void
 schedule(struct ir3_sched_ctx *ctx, struct ir3_instruction *instr)
 {
@@ -191,6 +276,8 @@ schedule(struct ir3_sched_ctx *ctx, struct ir3_instruction *instr)
 
 	struct ir3_sched_node *n = instr->data;
 
+	update_live(ctx, instr);
+
 	/* If this instruction is a meta:collect src, mark the remaining
 	 * collect srcs as partially live.
 	 */
@@ -575,9 +662,35 @@ choose_instr_dec(struct ir3_sched_ctx *ctx, struct ir3_sched_notes *notes,
 		return chosen;
 	}
 
+	/* When we are already short on registers, a sync is cheaper than
+	 * making more values live, so let the caller retry without avoiding
+	 * syncs before resorting to increasing pressure:
+	 */
+	if (avoid_sync && over_pressure(ctx))
+		return NULL;
+
 	return choose_instr_inc(ctx, notes, avoid_sync, true);
 }
 
+/* Is a better choice than b, when both increase register pressure?  Normally
+ * this is whichever has the nearest use, but once we are over the pressure
+ * limit we first pick whichever makes the fewest new values live.
+ */
+static bool
+better_inc(struct ir3_sched_ctx *ctx, struct ir3_sched_node *a,
+		unsigned a_distance, struct ir3_sched_node *b, unsigned b_distance)
+{
+	if (over_pressure(ctx)) {
+		int a_effect = live_effect(a->instr);
+		int b_effect = live_effect(b->instr);
+
+		if (a_effect != b_effect)
+			return a_effect < b_effect;
+	}
+
+	return a_distance < b_distance;
+}
+
 /**
  * When we can't choose an instruction that reduces register pressure or
  * is neutral, we end up here to try and pick the least bad option.
@@ -614,7 +727,7 @@ choose_instr_inc(struct ir3_sched_ctx *ctx, struct ir3_sched_notes *notes,
 
 		unsigned distance = nearest_use(n->instr);
 
-		if (!chosen || distance < chosen_distance) {
+		if (!chosen || better_inc(ctx, n, distance, chosen, chosen_distance)) {
 			chosen = n;
 			chosen_distance = distance;
 		}
@@ -638,7 +751,7 @@ choose_instr_inc(struct ir3_sched_ctx *ctx, struct ir3_sched_notes *notes,
 
 		unsigned distance = nearest_use(n->instr);
 
-		if (!chosen || distance < chosen_distance) {
+		if (!chosen || better_inc(ctx, n, distance, chosen, chosen_distance)) {
 			chosen = n;
 			chosen_distance = distance;
 		}
@@ -682,6 +795,8 @@ dump_state(struct ir3_sched_ctx *ctx)
 	if (!SCHED_DEBUG)
 		return;
 
+	d("live=%d", ctx->live);
+
 	foreach_sched_node (n, &ctx->dag->heads) {
 		di(n->instr, "maxdel=%3d le=%d del=%u ",
 				n->max_delay, live_effect(n->instr),
@@ -986,6 +1101,7 @@ sched_block(struct ir3_sched_ctx *ctx, struct ir3_block *block)
 	ctx->pred = NULL;
 	ctx->tex_delay = 0;
 	ctx->sfu_delay = 0;
+	ctx->live = 0;
 
 	/* move all instructions to the unscheduled list, and
 	 * empty the block's instruction list (to which we will
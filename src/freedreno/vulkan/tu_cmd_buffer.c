@@ -3406,7 +3406,7 @@ tu6_draw_common(struct tu_cmd_buffer *cmd,
          ((cmd->state.dirty & TU_CMD_DIRTY_DESC_SETS_LOAD) ? 1 : 0) +
          ((cmd->state.dirty & TU_CMD_DIRTY_VERTEX_BUFFERS) ? 1 : 0) +
          ((cmd->state.dirty & TU_CMD_DIRTY_LRZ) ? 1 : 0) +
-         1; /* vs_params */
+         ((cmd->state.dirty & TU_CMD_DIRTY_VS_PARAMS) ? 1 : 0);
 
       if ((cmd->state.dirty & TU_CMD_DIRTY_VB_STRIDE) &&
           !(pipeline->dynamic_state_mask & BIT(TU_DYNAMIC_STATE_VB_STRIDE))) {
@@ -3435,7 +3435,8 @@ tu6_draw_common(struct tu_cmd_buffer *cmd,
          tu_cs_emit_draw_state(cs, TU_DRAW_STATE_DYNAMIC + TU_DYNAMIC_STATE_VB_STRIDE,
                                cmd->state.dynamic_state[TU_DYNAMIC_STATE_VB_STRIDE]);
       }
-      tu_cs_emit_draw_state(cs, TU_DRAW_STATE_VS_PARAMS, cmd->state.vs_params);
+      if (cmd->state.dirty & TU_CMD_DIRTY_VS_PARAMS)
+         tu_cs_emit_draw_state(cs, TU_DRAW_STATE_VS_PARAMS, cmd->state.vs_params);
 
       if (cmd->state.dirty & TU_CMD_DIRTY_LRZ)
          tu_cs_emit_draw_state(cs, TU_DRAW_STATE_LRZ, cmd->state.lrz.state);
@@ -3511,22 +3512,32 @@ vs_params_offset(struct tu_cmd_buffer *cmd)
    return const_state->offsets.driver_param;
 }
 
-static struct tu_draw_state
+static void
 tu6_emit_vs_params(struct tu_cmd_buffer *cmd,
                    uint32_t vertex_offset,
                    uint32_t first_instance)
 {
    uint32_t offset = vs_params_offset(cmd);
 
+   /* Most draws don't change these, in which case the draw state from the
+    * previous draw is still bound and can be reused as is.
+    */
+   if (cmd->state.vs_params.size &&
+       cmd->state.vs_params_offset == offset &&
+       cmd->state.vs_params_vertex_offset == vertex_offset &&
+       cmd->state.vs_params_first_instance == first_instance)
+      return;
+
+   cmd->state.dirty |= TU_CMD_DIRTY_VS_PARAMS;
+
    struct tu_cs cs;
    VkResult result = tu_cs_begin_sub_stream(&cmd->sub_cs, 3 + (offset ? 8 : 0), &cs);
    if (result != VK_SUCCESS) {
       cmd->record_result = result;
-      return (struct tu_draw_state) {};
+      cmd->state.vs_params = (struct tu_draw_state) {};
+      return;
    }
 
-   /* TODO: don't make a new draw state when it doesn't change */
-
    tu_cs_emit_regs(&cs,
                    A6XX_VFD_INDEX_OFFSET(vertex_offset),
                    A6XX_VFD_INSTANCE_START_OFFSET(first_instance));
@@ -3548,7 +3559,19 @@ tu6_emit_vs_params(struct tu_cmd_buffer *cmd,
    }
 
    struct tu_cs_entry entry = tu_cs_end_sub_stream(&cmd->sub_cs, &cs);
-   return (struct tu_draw_state) {entry.bo->iova + entry.offset, entry.size / 4};
+   cmd->state.vs_params = (struct tu_draw_state) {entry.bo->iova + entry.offset, entry.size / 4};
+   cmd->state.vs_params_offset = offset;
+   cmd->state.vs_params_vertex_offset = vertex_offset;
+   cmd->state.vs_params_first_instance = first_instance;
+}
+
+static void
+tu6_clear_vs_params(struct tu_cmd_buffer *cmd)
+{
+   /* indirect draws load the vs params themselves: */
+   if (cmd->state.vs_params.size)
+      cmd->state.dirty |= TU_CMD_DIRTY_VS_PARAMS;
+   cmd->state.vs_params = (struct tu_draw_state) {};
 }
 
 void
@@ -3561,7 +3584,7 @@ tu_CmdDraw(VkCommandBuffer commandBuffer,
    TU_FROM_HANDLE(tu_cmd_buffer, cmd, commandBuffer);
    struct tu_cs *cs = &cmd->draw_cs;
 
-   cmd->state.vs_params = tu6_emit_vs_params(cmd, firstVertex, firstInstance);
+   tu6_emit_vs_params(cmd, firstVertex, firstInstance);
 
    tu6_draw_common(cmd, cs, false, vertexCount);
 
@@ -3582,7 +3605,7 @@ tu_CmdDrawIndexed(VkCommandBuffer commandBuffer,
    TU_FROM_HANDLE(tu_cmd_buffer, cmd, commandBuffer);
    struct tu_cs *cs = &cmd->draw_cs;
 
-   cmd->state.vs_params = tu6_emit_vs_params(cmd, vertexOffset, firstInstance);
+   tu6_emit_vs_params(cmd, vertexOffset, firstInstance);
 
    tu6_draw_common(cmd, cs, true, indexCount);
 
@@ -3620,7 +3643,7 @@ tu_CmdDrawIndirect(VkCommandBuffer commandBuffer,
    TU_FROM_HANDLE(tu_buffer, buf, _buffer);
    struct tu_cs *cs = &cmd->draw_cs;
 
-   cmd->state.vs_params = (struct tu_draw_state) {};
+   tu6_clear_vs_params(cmd);
 
    /* The latest known a630_sqe.fw fails to wait for WFI before reading the
     * indirect buffer when using CP_DRAW_INDIRECT_MULTI, so we have to fall
@@ -3654,7 +3677,7 @@ tu_CmdDrawIndexedIndirect(VkCommandBuffer commandBuffer,
    TU_FROM_HANDLE(tu_buffer, buf, _buffer);
    struct tu_cs *cs = &cmd->draw_cs;
 
-   cmd->state.vs_params = (struct tu_draw_state) {};
+   tu6_clear_vs_params(cmd);
 
    if (cmd->device->physical_device->gpu_id != 650)
       draw_wfm(cmd);
@@ -3686,7 +3709,7 @@ tu_CmdDrawIndirectCount(VkCommandBuffer commandBuffer,
    TU_FROM_HANDLE(tu_buffer, count_buf, countBuffer);
    struct tu_cs *cs = &cmd->draw_cs;
 
-   cmd->state.vs_params = (struct tu_draw_state) {};
+   tu6_clear_vs_params(cmd);
 
    /* It turns out that the firmware we have for a650 only partially fixed the
     * problem with CP_DRAW_INDIRECT_MULTI not waiting for WFI's to complete
@@ -3721,7 +3744,7 @@ tu_CmdDrawIndexedIndirectCount(VkCommandBuffer commandBuffer,
    TU_FROM_HANDLE(tu_buffer, count_buf, countBuffer);
    struct tu_cs *cs = &cmd->draw_cs;
 
-   cmd->state.vs_params = (struct tu_draw_state) {};
+   tu6_clear_vs_params(cmd);
 
    draw_wfm(cmd);
 
@@ -3758,7 +3781,7 @@ void tu_CmdDrawIndirectByteCountEXT(VkCommandBuffer commandBuffer,
     */
    draw_wfm(cmd);
 
-   cmd->state.vs_params = tu6_emit_vs_params(cmd, 0, firstInstance);
+   tu6_emit_vs_params(cmd, 0, firstInstance);
 
    tu6_draw_common(cmd, cs, false, 0);
 
@@ -683,8 +683,9 @@ enum tu_cmd_dirty_bits
    TU_CMD_DIRTY_COMPUTE_DESC_SETS_LOAD = BIT(6),
    TU_CMD_DIRTY_SHADER_CONSTS = BIT(7),
    TU_CMD_DIRTY_LRZ = BIT(8),
+   TU_CMD_DIRTY_VS_PARAMS = BIT(9),
    /* all draw states were disabled and need to be re-enabled: */
-   TU_CMD_DIRTY_DRAW_STATE = BIT(9)
+   TU_CMD_DIRTY_DRAW_STATE = BIT(10)
 };
 
 /* There are only three cache domains we have to care about: the CCU, or
@@ -890,6 +891,8 @@ struct tu_cmd_state
    struct tu_draw_state desc_sets;
 
    struct tu_draw_state vs_params;
+   /* values vs_params was built from, to reuse it for following draws: */
+   uint32_t vs_params_offset, vs_params_vertex_offset, vs_params_first_instance;
 
    /* Index buffer */
    uint64_t index_va;
@@ -42,6 +42,7 @@
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/u_vbuf.h"
+#include "util/simple_mtx.h"
 #include "tgsi/tgsi_parse.h"
 
 #include "cso_cache/cso_context.h"
@@ -60,9 +61,32 @@ struct sampler_info
 };
 
 
+/**
+ * CSOs shared by all the CSO contexts of a screen, for drivers which
+ * advertise PIPE_CAP_SHAREABLE_CSOS.
+ *
+ * The per-context cache stays in front of it and is still looked up
+ * without any locking.  Only its misses come here, so the shared cache
+ * is simply protected by a mutex.  Entries of the per-context caches then
+ * merely point at the driver objects, which are owned by the shared cache
+ * and only deleted when the last context of the screen goes away.
+ */
+struct cso_shared_cache
+{
+   struct pipe_screen *screen;
+   unsigned refcount;
+   simple_mtx_t lock;
+   struct cso_cache cache;
+   struct cso_shared_cache *next;
+};
+
+static simple_mtx_t shared_caches_lock = _SIMPLE_MTX_INITIALIZER_NP;
+static struct cso_shared_cache *shared_caches;
+
 
 struct cso_context {
    struct pipe_context *pipe;
+   struct cso_shared_cache *shared;
 
    struct u_vbuf *vbuf;
    struct u_vbuf *vbuf_current;
@@ -148,7 +172,10 @@ static inline boolean delete_cso(struct cso_context *ctx,
       assert(0);
    }
 
-   cso_delete_state(ctx->pipe, state, type);
+   if (ctx->shared)
+      FREE(state);
+   else
+      cso_delete_state(ctx->pipe, state, type);
    return true;
 }
 
@@ -219,6 +246,172 @@ sanitize_hash(struct cso_hash *hash, enum cso_cache_type type,
    }
 }
 
+/**
+ * Delete callback of the per-context cache when the driver objects are
+ * owned by the shared cache.
+ */
+static void
+free_shared_cso(void *ctx, void *state, enum cso_cache_type type)
+{
+   FREE(state);
+}
+
+static struct cso_shared_cache *
+cso_shared_cache_get(struct pipe_screen *screen)
+{
+   struct cso_shared_cache *shared;
+
+   simple_mtx_lock(&shared_caches_lock);
+
+   for (shared = shared_caches; shared; shared = shared->next) {
+      if (shared->screen == screen)
+         break;
+   }
+
+   if (!shared) {
+      shared = CALLOC_STRUCT(cso_shared_cache);
+      if (shared) {
+         shared->screen = screen;
+         simple_mtx_init(&shared->lock, mtx_plain);
+         cso_cache_init(&shared->cache, NULL);
+         /* Bound objects of other contexts can't be tracked here, so the
+          * shared cache never evicts anything.
+          */
+         cso_cache_set_sanitize_callback(&shared->cache, NULL, NULL);
+         shared->next = shared_caches;
+         shared_caches = shared;
+      }
+   }
+
+   if (shared)
+      shared->refcount++;
+
+   simple_mtx_unlock(&shared_caches_lock);
+   return shared;
+}
+
+/**
+ * Drop a reference to the shared cache.  The last context of the screen
+ * deletes all the driver objects.
+ */
+static void
+cso_shared_cache_release(struct cso_shared_cache *shared,
+                         struct pipe_context *pipe)
+{
+   struct cso_shared_cache **link;
+
+   simple_mtx_lock(&shared_caches_lock);
+
+   if (--shared->refcount) {
+      simple_mtx_unlock(&shared_caches_lock);
+      return;
+   }
+
+   for (link = &shared_caches; *link != shared; link = &(*link)->next)
+      ;
+   *link = shared->next;
+
+   simple_mtx_unlock(&shared_caches_lock);
+
+   cso_cache_set_delete_cso_callback(&shared->cache,
+                                     (cso_delete_cso_callback)cso_delete_state,
+                                     pipe);
+   cso_cache_delete(&shared->cache);
+   simple_mtx_destroy(&shared->lock);
+   FREE(shared);
+}
+
+static void **
+cso_data_ptr(void *cso, enum cso_cache_type type)
+{
+   switch (type) {
+   case CSO_BLEND:
+      return &((struct cso_blend *)cso)->data;
+   case CSO_DEPTH_STENCIL_ALPHA:
+      return &((struct cso_depth_stencil_alpha *)cso)->data;
+   case CSO_RASTERIZER:
+      return &((struct cso_rasterizer *)cso)->data;
+   case CSO_SAMPLER:
+      return &((struct cso_sampler *)cso)->data;
+   case CSO_VELEMENTS:
+      return &((struct cso_velements *)cso)->data;
+   default:
+      unreachable("bad cso_cache_type");
+   }
+}
+
+static void *
+cso_create_driver_state(struct pipe_context *pipe, void *cso,
+                        enum cso_cache_type type)
+{
+   switch (type) {
+   case CSO_BLEND:
+      return pipe->create_blend_state(pipe,
+                                      &((struct cso_blend *)cso)->state);
+   case CSO_DEPTH_STENCIL_ALPHA:
+      return pipe->create_depth_stencil_alpha_state(pipe,
+                        &((struct cso_depth_stencil_alpha *)cso)->state);
+   case CSO_RASTERIZER:
+      return pipe->create_rasterizer_state(pipe,
+                                    &((struct cso_rasterizer *)cso)->state);
+   case CSO_SAMPLER:
+      return pipe->create_sampler_state(pipe,
+                                        &((struct cso_sampler *)cso)->state);
+   case CSO_VELEMENTS: {
+      struct cso_velems_state *velems = &((struct cso_velements *)cso)->state;
+      return pipe->create_vertex_elements_state(pipe, velems->count,
+                                                &velems->velems[0]);
+   }
+   default:
+      unreachable("bad cso_cache_type");
+   }
+}
+
+/**
+ * Return the driver object for a CSO missing from the per-context cache.
+ *
+ * The state of \p cso must be filled in already, \p key_size and
+ * \p hash_key are those used for the per-context lookup.  Without a
+ * shared cache this just creates a new driver object.
+ */
+static void *
+cso_create_state_data(struct cso_context *ctx, enum cso_cache_type type,
+                      unsigned hash_key, void *cso, unsigned key_size,
+                      unsigned cso_size)
+{
+   struct cso_shared_cache *shared = ctx->shared;
+   struct cso_hash_iter iter;
+   void *data = NULL;
+
+   if (!shared)
+      return cso_create_driver_state(ctx->pipe, cso, type);
+
+   simple_mtx_lock(&shared->lock);
+
+   iter = cso_find_state_template(&shared->cache, hash_key, type,
+                                  cso, key_size);
+   if (!cso_hash_iter_is_null(iter)) {
+      data = *cso_data_ptr(cso_hash_iter_data(iter), type);
+   }
+   else {
+      void *shared_cso = mem_dup(cso, cso_size);
+
+      if (shared_cso) {
+         data = cso_create_driver_state(ctx->pipe, shared_cso, type);
+         *cso_data_ptr(shared_cso, type) = data;
+
+         iter = cso_insert_state(&shared->cache, hash_key, type, shared_cso);
+         if (cso_hash_iter_is_null(iter)) {
+            cso_delete_state(ctx->pipe, shared_cso, type);
+            data = NULL;
+         }
+      }
+   }
+
+   simple_mtx_unlock(&shared->lock);
+   return data;
+}
+
 static void cso_init_vbuf(struct cso_context *cso, unsigned flags)
 {
    struct u_vbuf_caps caps;
@@ -250,6 +443,12 @@ cso_create_context(struct pipe_context *pipe, unsigned flags)
    ctx->pipe = pipe;
    ctx->sample_mask = ~0;
 
+   if (pipe->screen->get_param(pipe->screen, PIPE_CAP_SHAREABLE_CSOS)) {
+      ctx->shared = cso_shared_cache_get(pipe->screen);
+      if (ctx->shared)
+         cso_cache_set_delete_cso_callback(&ctx->cache, free_shared_cso, NULL);
+   }
+
    cso_init_vbuf(ctx, flags);
 
    /* Enable for testing: */
@@ -382,6 +581,9 @@ void cso_destroy_context( struct cso_context *ctx )
 
    cso_cache_delete(&ctx->cache);
 
+   if (ctx->shared)
+      cso_shared_cache_release(ctx->shared, ctx->pipe);
+
    if (ctx->vbuf)
       u_vbuf_destroy(ctx->vbuf);
    FREE( ctx );
@@ -419,7 +621,8 @@ enum pipe_error cso_set_blend(struct cso_context *ctx,
 
       memset(&cso->state, 0, sizeof cso->state);
       memcpy(&cso->state, templ, key_size);
-      cso->data = ctx->pipe->create_blend_state(ctx->pipe, &cso->state);
+      cso->data = cso_create_state_data(ctx, CSO_BLEND, hash_key, cso,
+                                        key_size, sizeof(*cso));
 
       iter = cso_insert_state(&ctx->cache, hash_key, CSO_BLEND, cso);
       if (cso_hash_iter_is_null(iter)) {
@@ -478,8 +681,9 @@ cso_set_depth_stencil_alpha(struct cso_context *ctx,
          return PIPE_ERROR_OUT_OF_MEMORY;
 
       memcpy(&cso->state, templ, sizeof(*templ));
-      cso->data = ctx->pipe->create_depth_stencil_alpha_state(ctx->pipe,
-                                                              &cso->state);
+      cso->data = cso_create_state_data(ctx, CSO_DEPTH_STENCIL_ALPHA,
+                                        hash_key, cso, key_size,
+                                        sizeof(*cso));
 
       iter = cso_insert_state(&ctx->cache, hash_key,
                               CSO_DEPTH_STENCIL_ALPHA, cso);
@@ -544,7 +748,8 @@ enum pipe_error cso_set_rasterizer(struct cso_context *ctx,
          return PIPE_ERROR_OUT_OF_MEMORY;
 
       memcpy(&cso->state, templ, sizeof(*templ));
-      cso->data = ctx->pipe->create_rasterizer_state(ctx->pipe, &cso->state);
+      cso->data = cso_create_state_data(ctx, CSO_RASTERIZER, hash_key, cso,
+                                        key_size, sizeof(*cso));
 
       iter = cso_insert_state(&ctx->cache, hash_key, CSO_RASTERIZER, cso);
       if (cso_hash_iter_is_null(iter)) {
@@ -947,9 +1152,8 @@ cso_set_vertex_elements_direct(struct cso_context *ctx,
          return;
 
       memcpy(&cso->state, velems, key_size);
-      cso->data = ctx->pipe->create_vertex_elements_state(ctx->pipe,
-                                                          velems->count,
-                                                      &cso->state.velems[0]);
+      cso->data = cso_create_state_data(ctx, CSO_VELEMENTS, hash_key, cso,
+                                        key_size, sizeof(*cso));
 
       iter = cso_insert_state(&ctx->cache, hash_key, CSO_VELEMENTS, cso);
       if (cso_hash_iter_is_null(iter)) {
@@ -1119,8 +1323,9 @@ cso_single_sampler(struct cso_context *ctx, enum pipe_shader_type shader_stage,
             return;
 
          memcpy(&cso->state, templ, sizeof(*templ));
-         cso->data = ctx->pipe->create_sampler_state(ctx->pipe, &cso->state);
          cso->hash_key = hash_key;
+         cso->data = cso_create_state_data(ctx, CSO_SAMPLER, hash_key, cso,
+                                           key_size, sizeof(*cso));
 
          iter = cso_insert_state(&ctx->cache, hash_key, CSO_SAMPLER, cso);
          if (cso_hash_iter_is_null(iter)) {
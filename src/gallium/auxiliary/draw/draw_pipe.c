@@ -149,6 +149,53 @@ static void do_line( struct draw_context *draw,
 }
 
 
+/**
+ * Return TRUE if the clip or cull stage would drop the triangle.
+ *
+ * The clip masks are computed for whole vectors of vertices by the vertex
+ * shader, so this is just a few bit ops for most triangles, and saves
+ * running them through the stage chain.  The face test must match the one
+ * of draw_pipe_cull.c exactly.
+ */
+static inline boolean
+tri_trivial_reject(const struct draw_context *draw,
+                   const struct vertex_header *v0,
+                   const struct vertex_header *v1,
+                   const struct vertex_header *v2)
+{
+   if (draw->pipeline.early_clip_reject) {
+      if (v0->clipmask & v1->clipmask & v2->clipmask)
+         return TRUE;
+      /* clipped triangles are culled with the clipped vertices */
+      if (v0->clipmask | v1->clipmask | v2->clipmask)
+         return FALSE;
+   }
+
+   if (draw->pipeline.early_cull_face != PIPE_FACE_NONE) {
+      const unsigned pos = draw->pipeline.early_pos;
+      const float *p0 = v0->data[pos];
+      const float *p1 = v1->data[pos];
+      const float *p2 = v2->data[pos];
+      const float ex = p0[0] - p2[0];
+      const float ey = p0[1] - p2[1];
+      const float fx = p1[0] - p2[0];
+      const float fy = p1[1] - p2[1];
+      const float det = ex * fy - ey * fx;
+      unsigned face = PIPE_FACE_BACK;
+
+      if (det != 0) {
+         const unsigned ccw = (det < 0);
+         face = (ccw == draw->pipeline.early_front_ccw) ?
+                PIPE_FACE_FRONT : PIPE_FACE_BACK;
+      }
+
+      return (face & draw->pipeline.early_cull_face) != 0;
+   }
+
+   return FALSE;
+}
+
+
 /**
  * Build primitive to render a triangle with vertices at v0, v1, v2.
  * \param flags  bitmask of DRAW_PIPE_EDGE_x, DRAW_PIPE_RESET_STIPPLE
@@ -160,7 +207,12 @@ static void do_triangle( struct draw_context *draw,
 			 char *v2 )
 {
    struct prim_header prim;
-   
+
+   if (tri_trivial_reject(draw, (const struct vertex_header *)v0,
+                          (const struct vertex_header *)v1,
+                          (const struct vertex_header *)v2))
+      return;
+
    prim.v[0] = (struct vertex_header *)v0;
    prim.v[1] = (struct vertex_header *)v1;
    prim.v[2] = (struct vertex_header *)v2;
@@ -351,6 +403,9 @@ void draw_pipeline_flush( struct draw_context *draw,
                           unsigned flags )
 {
    draw->pipeline.first->flush( draw->pipeline.first, flags );
-   if (flags & DRAW_FLUSH_STATE_CHANGE)
+   if (flags & DRAW_FLUSH_STATE_CHANGE) {
       draw->pipeline.first = draw->pipeline.validate;
+      draw->pipeline.early_clip_reject = FALSE;
+      draw->pipeline.early_cull_face = PIPE_FACE_NONE;
+   }
 }
@@ -275,6 +275,16 @@ static struct draw_stage *validate_pipeline( struct draw_stage *stage )
 
    draw->pipeline.first = next;
 
+   /* The clip and cull stages come first, so their trivial rejects can
+    * be done before running the pipeline.
+    */
+   draw->pipeline.early_clip_reject = next == draw->pipeline.clip ||
+      (next == draw->pipeline.user_cull &&
+       next->next == draw->pipeline.clip);
+   draw->pipeline.early_cull_face = rast->cull_face;
+   draw->pipeline.early_front_ccw = rast->front_ccw;
+   draw->pipeline.early_pos = draw_current_shader_position_output(draw);
+
    if (0) {
       debug_printf("draw pipeline:\n");
       for (next = draw->pipeline.first; next ; next = next->next ) 
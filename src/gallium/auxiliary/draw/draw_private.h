@@ -140,6 +140,14 @@ struct draw_context
       boolean line_stipple;       /**< do line stipple? */
       boolean point_sprite;       /**< convert points to quads for sprites? */
 
+      /* Triangles the clip and cull stages would drop are rejected before
+       * entering the pipeline.  Set up when the pipeline gets validated.
+       */
+      boolean early_clip_reject;  /**< clip stage is in the pipeline */
+      unsigned early_cull_face;   /**< PIPE_FACE_x the cull stage drops */
+      boolean early_front_ccw;
+      unsigned early_pos;         /**< position output slot */
+
       /* Temporary storage while the pipeline is being run:
        */
       char *verts;
@@ -28,6 +28,7 @@
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/u_prim.h"
+#include "util/u_queue.h"
 #include "draw/draw_context.h"
 #include "draw/draw_gs.h"
 #include "draw/draw_tess.h"
@@ -41,6 +42,31 @@
 #include "gallivm/lp_bld_debug.h"
 
 
+/*
+ * Large segments get their fetch + vertex shader work split into chunks
+ * which run in parallel on a small thread pool.  Everything after the
+ * shader (tess/gs, clipping, the pipeline and emit) still runs on the
+ * calling thread, in primitive order.
+ */
+#define LLVM_VS_MAX_JOBS 8
+#define LLVM_VS_MIN_JOB_VERTICES 256
+
+DEBUG_GET_ONCE_NUM_OPTION(draw_vs_threads, "DRAW_VS_THREADS", 0)
+
+struct llvm_middle_end;
+
+struct llvm_vs_job {
+   struct llvm_middle_end *fpme;
+   struct vertex_header *verts;
+   unsigned count;
+   unsigned start_or_maxelt;
+   unsigned vid_base;
+   const unsigned *elts;
+   boolean clipped;
+   struct util_queue_fence fence;
+};
+
+
 struct llvm_middle_end {
    struct draw_pt_middle_end base;
    struct draw_context *draw;
@@ -58,6 +84,11 @@ struct llvm_middle_end {
 
    struct draw_llvm *llvm;
    struct draw_llvm_variant *current_variant;
+
+   /* threads helping with the vertex shader, 0 if none */
+   unsigned num_vs_threads;
+   struct util_queue vs_queue;
+   struct llvm_vs_job vs_jobs[LLVM_VS_MAX_JOBS];
 };
 
 
@@ -560,6 +591,104 @@ emit(struct pt_emit *emit,
 }
 
 
+static void
+llvm_vs_job_execute(void *data, int thread_index)
+{
+   struct llvm_vs_job *job = (struct llvm_vs_job *)data;
+   struct llvm_middle_end *fpme = job->fpme;
+   struct draw_context *draw = fpme->draw;
+
+   job->clipped = fpme->current_variant->jit_func(&fpme->llvm->jit_context,
+                                                  job->verts,
+                                                  draw->pt.user.vbuffer,
+                                                  job->count,
+                                                  job->start_or_maxelt,
+                                                  fpme->vertex_size,
+                                                  draw->pt.vertex_buffer,
+                                                  draw->instance_id,
+                                                  job->vid_base,
+                                                  draw->start_instance,
+                                                  job->elts,
+                                                  draw->pt.user.drawid,
+                                                  draw->pt.user.viewid);
+}
+
+
+/**
+ * Fetch and shade count vertices into verts, splitting the work across the
+ * vertex shader threads if there are enough of them.
+ * Returns whether any vertex needs clipping.
+ */
+static boolean
+llvm_pipeline_run_vs(struct llvm_middle_end *fpme,
+                     struct vertex_header *verts,
+                     unsigned count,
+                     unsigned start_or_maxelt,
+                     unsigned vid_base,
+                     const unsigned *elts)
+{
+   unsigned num_jobs = 1, chunk, i;
+   boolean clipped = FALSE;
+
+   if (fpme->num_vs_threads)
+      num_jobs = MIN2(fpme->num_vs_threads + 1,
+                      count / LLVM_VS_MIN_JOB_VERTICES);
+
+   if (num_jobs <= 1) {
+      struct llvm_vs_job *job = &fpme->vs_jobs[0];
+
+      job->verts = verts;
+      job->count = count;
+      job->start_or_maxelt = start_or_maxelt;
+      job->vid_base = vid_base;
+      job->elts = elts;
+      llvm_vs_job_execute(job, 0);
+      return job->clipped;
+   }
+
+   /*
+    * The shader writes whole vectors of vertices, so all chunks but the
+    * last must be a multiple of the vector length to not overwrite the
+    * start of the next one.
+    */
+   chunk = align(DIV_ROUND_UP(count, num_jobs), lp_native_vector_width / 32);
+   num_jobs = DIV_ROUND_UP(count, chunk);
+
+   for (i = 0; i < num_jobs; i++) {
+      struct llvm_vs_job *job = &fpme->vs_jobs[i];
+      const unsigned first = i * chunk;
+
+      job->verts = (struct vertex_header *)
+         ((char *)verts + first * fpme->vertex_size);
+      job->count = MIN2(chunk, count - first);
+      job->vid_base = vid_base;
+      if (elts) {
+         job->start_or_maxelt = start_or_maxelt;
+         job->elts = elts + first;
+      }
+      else {
+         job->start_or_maxelt = start_or_maxelt + first;
+         job->elts = NULL;
+      }
+
+      if (i > 0)
+         util_queue_add_job(&fpme->vs_queue, job, &job->fence,
+                            llvm_vs_job_execute, NULL, 0);
+   }
+
+   /* do the first chunk ourselves */
+   llvm_vs_job_execute(&fpme->vs_jobs[0], 0);
+   clipped = fpme->vs_jobs[0].clipped;
+
+   for (i = 1; i < num_jobs; i++) {
+      util_queue_fence_wait(&fpme->vs_jobs[i].fence);
+      clipped |= fpme->vs_jobs[i].clipped;
+   }
+
+   return clipped;
+}
+
+
 static void
 llvm_pipeline_generic(struct draw_pt_middle_end *middle,
                       const struct draw_fetch_info *fetch_info,
@@ -621,18 +750,9 @@ llvm_pipeline_generic(struct draw_pt_middle_end *middle,
       vid_base = draw->pt.user.eltBias;
       elts = fetch_info->elts;
    }
-   clipped = fpme->current_variant->jit_func(&fpme->llvm->jit_context,
-                                             llvm_vert_info.verts,
-                                             draw->pt.user.vbuffer,
-                                             fetch_info->count,
-                                             start_or_maxelt,
-                                             fpme->vertex_size,
-                                             draw->pt.vertex_buffer,
-                                             draw->instance_id,
-                                             vid_base,
-                                             draw->start_instance,
-                                             elts, draw->pt.user.drawid,
-                                             draw->pt.user.viewid);
+   clipped = llvm_pipeline_run_vs(fpme, llvm_vert_info.verts,
+                                  fetch_info->count, start_or_maxelt,
+                                  vid_base, elts);
 
    /* Finished with fetch and vs:
     */
@@ -901,6 +1021,14 @@ llvm_middle_end_destroy(struct draw_pt_middle_end *middle)
    if (fpme->post_vs)
       draw_pt_post_vs_destroy( fpme->post_vs );
 
+   if (fpme->num_vs_threads) {
+      unsigned i;
+
+      util_queue_destroy(&fpme->vs_queue);
+      for (i = 0; i < LLVM_VS_MAX_JOBS; i++)
+         util_queue_fence_destroy(&fpme->vs_jobs[i].fence);
+   }
+
    FREE(middle);
 }
 
@@ -909,6 +1037,7 @@ struct draw_pt_middle_end *
 draw_pt_fetch_pipeline_or_emit_llvm(struct draw_context *draw)
 {
    struct llvm_middle_end *fpme = 0;
+   unsigned num_vs_threads, i;
 
    if (!draw->llvm)
       return NULL;
@@ -949,6 +1078,19 @@ draw_pt_fetch_pipeline_or_emit_llvm(struct draw_context *draw)
 
    fpme->current_variant = NULL;
 
+   for (i = 0; i < LLVM_VS_MAX_JOBS; i++)
+      fpme->vs_jobs[i].fpme = fpme;
+
+   num_vs_threads = MIN2(debug_get_option_draw_vs_threads(),
+                         LLVM_VS_MAX_JOBS - 1);
+   if (num_vs_threads &&
+       util_queue_init(&fpme->vs_queue, "draw_vs", LLVM_VS_MAX_JOBS,
+                       num_vs_threads, 0)) {
+      for (i = 0; i < LLVM_VS_MAX_JOBS; i++)
+         util_queue_fence_init(&fpme->vs_jobs[i].fence);
+      fpme->num_vs_threads = num_vs_threads;
+   }
+
    return &fpme->base;
 
  fail:
@@ -23,6 +23,9 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <inttypes.h>
+
+#include "util/u_debug.h"
 #include "util/u_math.h"
 #include "util/u_memory.h"
 
@@ -31,7 +34,14 @@
 #include "draw/draw_pt.h"
 
 #define SEGMENT_SIZE 1024
-#define MAP_SIZE     256
+
+/*
+ * The vertex cache is set associative with FIFO replacement within a set.
+ * It has room for twice the vertices of a segment so that meshes with poor
+ * index locality still get most of their reuse.
+ */
+#define CACHE_SETS   512
+#define CACHE_WAYS   4
 
 /* The largest possible index within an index buffer */
 #define MAX_ELT_IDX 0xffffffff
@@ -54,21 +64,36 @@ struct vsplit_frontend {
 
    struct {
       /* map a fetch element to a draw element */
-      unsigned fetches[MAP_SIZE];
-      ushort draws[MAP_SIZE];
-      boolean has_max_fetch;
+      unsigned fetches[CACHE_SETS][CACHE_WAYS];
+      ushort draws[CACHE_SETS][CACHE_WAYS];
+      /* an entry is only valid if its tag is the one of the segment */
+      unsigned tags[CACHE_SETS][CACHE_WAYS];
+      ubyte next[CACHE_SETS];
+      unsigned tag;
 
       ushort num_fetch_elts;
       ushort num_draw_elts;
    } cache;
+
+   /* indices seen and vertices fetched for indexed draws */
+   struct {
+      uint64_t indices;
+      uint64_t fetches;
+   } stats;
 };
 
 
+DEBUG_GET_ONCE_BOOL_OPTION(draw_vcache_stats, "DRAW_VCACHE_STATS", FALSE)
+
+
 static void
 vsplit_clear_cache(struct vsplit_frontend *vsplit)
 {
-   memset(vsplit->cache.fetches, 0xff, sizeof(vsplit->cache.fetches));
-   vsplit->cache.has_max_fetch = FALSE;
+   /* invalidate all entries by moving to the next tag */
+   if (++vsplit->cache.tag == 0) {
+      memset(vsplit->cache.tags, 0, sizeof(vsplit->cache.tags));
+      vsplit->cache.tag = 1;
+   }
    vsplit->cache.num_fetch_elts = 0;
    vsplit->cache.num_draw_elts = 0;
 }
@@ -76,6 +101,9 @@ vsplit_clear_cache(struct vsplit_frontend *vsplit)
 static void
 vsplit_flush_cache(struct vsplit_frontend *vsplit, unsigned flags)
 {
+   vsplit->stats.indices += vsplit->cache.num_draw_elts;
+   vsplit->stats.fetches += vsplit->cache.num_fetch_elts;
+
    vsplit->middle->run(vsplit->middle,
          vsplit->fetch_elts, vsplit->cache.num_fetch_elts,
          vsplit->draw_elts, vsplit->cache.num_draw_elts, flags);
@@ -87,23 +115,32 @@ vsplit_flush_cache(struct vsplit_frontend *vsplit, unsigned flags)
 static inline void
 vsplit_add_cache(struct vsplit_frontend *vsplit, unsigned fetch)
 {
-   unsigned hash;
+   const unsigned set = fetch % CACHE_SETS;
+   const unsigned tag = vsplit->cache.tag;
+   unsigned way;
+
+   for (way = 0; way < CACHE_WAYS; way++) {
+      if (vsplit->cache.tags[set][way] == tag &&
+          vsplit->cache.fetches[set][way] == fetch)
+         break;
+   }
 
-   hash = fetch % MAP_SIZE;
+   if (way == CACHE_WAYS) {
+      /* replace the oldest entry of the set */
+      way = vsplit->cache.next[set];
+      vsplit->cache.next[set] = (way + 1) % CACHE_WAYS;
 
-   /* If the value isn't in the cache or it's an overflow due to the
-    * element bias */
-   if (vsplit->cache.fetches[hash] != fetch) {
-      /* update cache */
-      vsplit->cache.fetches[hash] = fetch;
-      vsplit->cache.draws[hash] = vsplit->cache.num_fetch_elts;
+      vsplit->cache.fetches[set][way] = fetch;
+      vsplit->cache.draws[set][way] = vsplit->cache.num_fetch_elts;
+      vsplit->cache.tags[set][way] = tag;
 
       /* add fetch */
       assert(vsplit->cache.num_fetch_elts < vsplit->segment_size);
       vsplit->fetch_elts[vsplit->cache.num_fetch_elts++] = fetch;
    }
 
-   vsplit->draw_elts[vsplit->cache.num_draw_elts++] = vsplit->cache.draws[hash];
+   vsplit->draw_elts[vsplit->cache.num_draw_elts++] =
+      vsplit->cache.draws[set][way];
 }
 
 /**
@@ -125,12 +162,6 @@ vsplit_add_cache_ubyte(struct vsplit_frontend *vsplit, const ubyte *elts,
    unsigned elt_idx;
    elt_idx = vsplit_get_base_idx(start, fetch);
    elt_idx = (unsigned)((int)(DRAW_GET_IDX(elts, elt_idx)) + elt_bias);
-   /* unlike the uint case this can only happen with elt_bias */
-   if (elt_bias && elt_idx == DRAW_MAX_FETCH_IDX && !vsplit->cache.has_max_fetch) {
-      unsigned hash = elt_idx % MAP_SIZE;
-      vsplit->cache.fetches[hash] = 0;
-      vsplit->cache.has_max_fetch = TRUE;
-   }
    vsplit_add_cache(vsplit, elt_idx);
 }
 
@@ -142,12 +173,6 @@ vsplit_add_cache_ushort(struct vsplit_frontend *vsplit, const ushort *elts,
    unsigned elt_idx;
    elt_idx = vsplit_get_base_idx(start, fetch);
    elt_idx = (unsigned)((int)(DRAW_GET_IDX(elts, elt_idx)) + elt_bias);
-   /* unlike the uint case this can only happen with elt_bias */
-   if (elt_bias && elt_idx == DRAW_MAX_FETCH_IDX && !vsplit->cache.has_max_fetch) {
-      unsigned hash = elt_idx % MAP_SIZE;
-      vsplit->cache.fetches[hash] = 0;
-      vsplit->cache.has_max_fetch = TRUE;
-   }
    vsplit_add_cache(vsplit, elt_idx);
 }
 
@@ -167,13 +192,6 @@ vsplit_add_cache_uint(struct vsplit_frontend *vsplit, const uint *elts,
     */
    elt_idx = vsplit_get_base_idx(start, fetch);
    elt_idx = (unsigned)((int)(DRAW_GET_IDX(elts, elt_idx)) + elt_bias);
-   /* Take care for DRAW_MAX_FETCH_IDX (since cache is initialized to -1). */
-   if (elt_idx == DRAW_MAX_FETCH_IDX && !vsplit->cache.has_max_fetch) {
-      unsigned hash = elt_idx % MAP_SIZE;
-      /* force update - any value will do except DRAW_MAX_FETCH_IDX */
-      vsplit->cache.fetches[hash] = 0;
-      vsplit->cache.has_max_fetch = TRUE;
-   }
    vsplit_add_cache(vsplit, elt_idx);
 }
 
@@ -245,6 +263,16 @@ static void vsplit_flush(struct draw_pt_front_end *frontend, unsigned flags)
 
 static void vsplit_destroy(struct draw_pt_front_end *frontend)
 {
+   struct vsplit_frontend *vsplit = (struct vsplit_frontend *) frontend;
+
+   if (debug_get_option_draw_vcache_stats() && vsplit->stats.indices) {
+      debug_printf("draw: %" PRIu64 " indices, %" PRIu64 " vertices shaded, "
+                   "%.2f indices per vertex\n",
+                   vsplit->stats.indices, vsplit->stats.fetches,
+                   (double)vsplit->stats.indices /
+                   MAX2(vsplit->stats.fetches, 1));
+   }
+
    FREE(frontend);
 }
 
@@ -35,40 +35,129 @@
  * is abstracted out of this file, so that we can switch to a binary
  * representation if/when it becomes justified.
  *
+ * Output is accumulated in blocks.  By default every call is written out
+ * and flushed as soon as it completes, so that the trace survives crashes.
+ * With GALLIUM_TRACE_COMPACT the blocks are instead written by a separate
+ * thread once full, and blobs dumped before are only referenced by their
+ * hash, which makes long captures practical.
+ *
  * @author Jose Fonseca <jfonseca@vmware.com>
  */
 
 #include "pipe/p_config.h"
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "pipe/p_compiler.h"
 #include "os/os_thread.h"
 #include "util/os_time.h"
+#include "util/hash_table.h"
 #include "util/u_debug.h"
 #include "util/u_memory.h"
+#include "util/u_queue.h"
 #include "util/u_string.h"
 #include "util/u_math.h"
 #include "util/format/u_format.h"
+#define XXH_INLINE_ALL
+#include "util/xxhash.h"
 
 #include "tr_dump.h"
 #include "tr_screen.h"
 #include "tr_texture.h"
 
 
+#define TRACE_DUMP_BLOCK_SIZE (1 << 20)
+
+/* Blobs smaller than this are always dumped in full. */
+#define TRACE_DUMP_MIN_HASHED_BLOB 256
+
+struct trace_dump_block {
+   struct util_queue_fence fence;
+   size_t size;
+   char data[TRACE_DUMP_BLOCK_SIZE];
+};
+
 static bool close_stream = false;
 static FILE *stream = NULL;
 static mtx_t call_mutex = _MTX_INITIALIZER_NP;
 static long unsigned call_no = 0;
 static bool dumping = false;
 
+static bool compact = false;
+static struct trace_dump_block *block = NULL;
+static struct util_queue write_queue;
+static struct hash_table_u64 *dumped_blobs = NULL;
+
+
+static void
+trace_dump_block_execute(void *job, int thread_index)
+{
+   struct trace_dump_block *blk = job;
+
+   fwrite(blk->data, blk->size, 1, stream);
+}
+
+
+static void
+trace_dump_block_cleanup(void *job, int thread_index)
+{
+   FREE(job);
+}
+
+
+/**
+ * Hand the pending output over to the stream, either directly or through
+ * the writer thread.
+ */
+static void
+trace_dump_block_flush(void)
+{
+   if (!block || !block->size)
+      return;
+
+   if (compact) {
+      util_queue_fence_init(&block->fence);
+      util_queue_add_job(&write_queue, block, &block->fence,
+                         trace_dump_block_execute, trace_dump_block_cleanup,
+                         block->size);
+      block = MALLOC_STRUCT(trace_dump_block);
+      if (block)
+         block->size = 0;
+   } else {
+      fwrite(block->data, block->size, 1, stream);
+      block->size = 0;
+   }
+}
+
 
 static inline void
 trace_dump_write(const char *buf, size_t size)
 {
-   if (stream) {
+   if (!stream)
+      return;
+
+   if (unlikely(!block)) {
       fwrite(buf, size, 1, stream);
+      return;
+   }
+
+   while (size) {
+      size_t n = MIN2(size, TRACE_DUMP_BLOCK_SIZE - block->size);
+
+      memcpy(block->data + block->size, buf, n);
+      block->size += n;
+      buf += n;
+      size -= n;
+
+      if (block->size == TRACE_DUMP_BLOCK_SIZE) {
+         trace_dump_block_flush();
+         if (unlikely(!block)) {
+            fwrite(buf, size, 1, stream);
+            return;
+         }
+      }
    }
 }
 
@@ -166,7 +255,8 @@ trace_dump_tag_end(const char *name)
 void
 trace_dump_trace_flush(void)
 {
-   if (stream) {
+   if (stream && !compact) {
+      trace_dump_block_flush();
       fflush(stream);
    }
 }
@@ -176,6 +266,17 @@ trace_dump_trace_close(void)
 {
    if (stream) {
       trace_dump_writes("</trace>\n");
+      trace_dump_block_flush();
+      if (compact) {
+         util_queue_finish(&write_queue);
+         util_queue_destroy(&write_queue);
+         _mesa_hash_table_u64_destroy(dumped_blobs, NULL);
+         dumped_blobs = NULL;
+         compact = false;
+      }
+      FREE(block);
+      block = NULL;
+      fflush(stream);
       if (close_stream) {
          fclose(stream);
          close_stream = false;
@@ -225,6 +326,21 @@ trace_dump_trace_begin(void)
             return false;
       }
 
+      block = MALLOC_STRUCT(trace_dump_block);
+      if (block)
+         block->size = 0;
+
+      if (block && debug_get_bool_option("GALLIUM_TRACE_COMPACT", false)) {
+         dumped_blobs = _mesa_hash_table_u64_create(NULL);
+         compact = dumped_blobs &&
+                   util_queue_init(&write_queue, "tr_dump", 16, 1,
+                                   UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY);
+         if (!compact) {
+            _mesa_hash_table_u64_destroy(dumped_blobs, NULL);
+            dumped_blobs = NULL;
+         }
+      }
+
       trace_dump_writes("<?xml version='1.0' encoding='UTF-8'?>\n");
       trace_dump_writes("<?xml-stylesheet type='text/xsl' href='trace.xsl'?>\n");
       trace_dump_writes("<trace version='0.1'>\n");
@@ -338,7 +454,7 @@ void trace_dump_call_end_locked(void)
    trace_dump_indent(1);
    trace_dump_tag_end("call");
    trace_dump_newline();
-   fflush(stream);
+   trace_dump_trace_flush();
 }
 
 void trace_dump_call_begin(const char *klass, const char *method)
@@ -431,7 +547,20 @@ void trace_dump_bytes(const void *data,
    if (!dumping)
       return;
 
-   trace_dump_writes("<bytes>");
+   if (compact && size >= TRACE_DUMP_MIN_HASHED_BLOB) {
+      uint64_t hash = XXH64(data, size, size);
+
+      if (_mesa_hash_table_u64_search(dumped_blobs, hash)) {
+         trace_dump_writef("<bytes hash='%016" PRIx64 "'/>", hash);
+         return;
+      }
+
+      _mesa_hash_table_u64_insert(dumped_blobs, hash, (void *)(uintptr_t)1);
+      trace_dump_writef("<bytes hash='%016" PRIx64 "'>", hash);
+   } else {
+      trace_dump_writes("<bytes>");
+   }
+
    for(i = 0; i < size; ++i) {
       uint8_t byte = *p++;
       char hex[2];
@@ -82,6 +82,37 @@
 #define LOG_POLY_DEGREE 4
 
 
+#if defined(PIPE_ARCH_AARCH64)
+/**
+ * Float min/max on AArch64.
+ * fminnm/fmaxnm return the other operand if one of them is NaN, fmin/fmax
+ * return NaN, so every NaN behavior is a single instruction.  LLVM selects
+ * those for minnum/maxnum and minimum/maximum.
+ */
+static LLVMValueRef
+lp_build_minmax_neon(struct lp_build_context *bld,
+                     LLVMValueRef a,
+                     LLVMValueRef b,
+                     enum gallivm_nan_behavior nan_behavior,
+                     boolean max)
+{
+   const boolean return_nan = nan_behavior == GALLIVM_NAN_RETURN_NAN ||
+                              nan_behavior == GALLIVM_NAN_RETURN_NAN_FIRST_NONNAN;
+   char intrinsic[32];
+
+   if (return_nan)
+      lp_format_intrinsic(intrinsic, sizeof intrinsic,
+                          max ? "llvm.maximum" : "llvm.minimum", bld->vec_type);
+   else
+      lp_format_intrinsic(intrinsic, sizeof intrinsic,
+                          max ? "llvm.maxnum" : "llvm.minnum", bld->vec_type);
+
+   return lp_build_intrinsic_binary(bld->gallivm->builder, intrinsic,
+                                    bld->vec_type, a, b);
+}
+#endif
+
+
 /**
  * Generate min(a, b)
  * No checks for special case values of a or b = 1 or 0 are done.
@@ -104,6 +135,12 @@ lp_build_min_simple(struct lp_build_context *bld,
 
    /* TODO: optimize the constant case */
 
+#if defined(PIPE_ARCH_AARCH64)
+   if (type.floating && util_get_cpu_caps()->has_neon &&
+       LLVM_VERSION_MAJOR >= 8)
+      return lp_build_minmax_neon(bld, a, b, nan_behavior, FALSE);
+#endif
+
    if (type.floating && util_get_cpu_caps()->has_sse) {
       if (type.width == 32) {
          if (type.length == 1) {
@@ -274,6 +311,12 @@ lp_build_max_simple(struct lp_build_context *bld,
 
    /* TODO: optimize the constant case */
 
+#if defined(PIPE_ARCH_AARCH64)
+   if (type.floating && util_get_cpu_caps()->has_neon &&
+       LLVM_VERSION_MAJOR >= 8)
+      return lp_build_minmax_neon(bld, a, b, nan_behavior, TRUE);
+#endif
+
    if (type.floating && util_get_cpu_caps()->has_sse) {
       if (type.width == 32) {
          if (type.length == 1) {
@@ -1954,6 +1997,20 @@ lp_build_iround_nearest_sse2(struct lp_build_context *bld,
       res = lp_build_intrinsic_unary(builder, intrinsic,
                                      ret_type, arg);
    }
+   else if (type.width * type.length == 512) {
+      LLVMValueRef args[4];
+
+      assert(util_get_cpu_caps()->has_avx512f);
+
+      /* unmasked, with the current (MXCSR) rounding mode */
+      args[0] = a;
+      args[1] = LLVMGetUndef(ret_type);
+      args[2] = LLVMConstInt(LLVMInt16TypeInContext(bld->gallivm->context),
+                             0xffff, 0);
+      args[3] = LLVMConstInt(i32t, 4, 0);
+      res = lp_build_intrinsic(builder, "llvm.x86.avx512.mask.cvtps2dq.512",
+                               ret_type, args, 4, 0);
+   }
    else {
       if (type.width* type.length == 128) {
          intrinsic = "llvm.x86.sse2.cvtps2dq";
@@ -1972,6 +2029,59 @@ lp_build_iround_nearest_sse2(struct lp_build_context *bld,
 }
 
 
+#if defined(PIPE_ARCH_AARCH64)
+/**
+ * Convert float to int with the rounding mode of the AArch64 fcvt*s
+ * instructions, instead of rounding with frint* and converting separately.
+ */
+static LLVMValueRef
+lp_build_iround_neon(struct lp_build_context *bld,
+                     LLVMValueRef a,
+                     enum lp_build_round_mode mode)
+{
+   const struct lp_type type = bld->type;
+   const char *op = NULL;
+   char intrinsic[64];
+
+   assert(type.floating && type.width == 32);
+   assert(util_get_cpu_caps()->has_neon);
+
+   switch (mode) {
+   case LP_BUILD_ROUND_NEAREST:
+      op = "fcvtns";
+      break;
+   case LP_BUILD_ROUND_FLOOR:
+      op = "fcvtms";
+      break;
+   case LP_BUILD_ROUND_CEIL:
+      op = "fcvtps";
+      break;
+   case LP_BUILD_ROUND_TRUNCATE:
+      op = "fcvtzs";
+      break;
+   }
+
+   if (type.length == 1)
+      snprintf(intrinsic, sizeof intrinsic,
+               "llvm.aarch64.neon.%s.i32.f32", op);
+   else
+      snprintf(intrinsic, sizeof intrinsic,
+               "llvm.aarch64.neon.%s.v%ui32.v%uf32", op,
+               type.length, type.length);
+
+   return lp_build_intrinsic_unary(bld->gallivm->builder, intrinsic,
+                                   bld->int_vec_type, a);
+}
+
+static inline boolean
+iround_neon_available(const struct lp_type type)
+{
+   return util_get_cpu_caps()->has_neon && type.width == 32 &&
+          (type.length == 1 || type.length == 2 || type.length == 4);
+}
+#endif
+
+
 /*
  */
 static inline LLVMValueRef
@@ -2380,9 +2490,14 @@ lp_build_iround(struct lp_build_context *bld,
 
    if ((util_get_cpu_caps()->has_sse2 &&
        ((type.width == 32) && (type.length == 1 || type.length == 4))) ||
-       (util_get_cpu_caps()->has_avx && type.width == 32 && type.length == 8)) {
+       (util_get_cpu_caps()->has_avx && type.width == 32 && type.length == 8) ||
+       (util_get_cpu_caps()->has_avx512f && type.width == 32 && type.length == 16)) {
       return lp_build_iround_nearest_sse2(bld, a);
    }
+#if defined(PIPE_ARCH_AARCH64)
+   if (iround_neon_available(type))
+      return lp_build_iround_neon(bld, a, LP_BUILD_ROUND_NEAREST);
+#endif
    if (arch_rounding_available(type)) {
       res = lp_build_round_arch(bld, a, LP_BUILD_ROUND_NEAREST);
    }
@@ -2435,6 +2550,10 @@ lp_build_ifloor(struct lp_build_context *bld,
 
    res = a;
    if (type.sign) {
+#if defined(PIPE_ARCH_AARCH64)
+      if (iround_neon_available(type))
+         return lp_build_iround_neon(bld, a, LP_BUILD_ROUND_FLOOR);
+#endif
       if (arch_rounding_available(type)) {
          res = lp_build_round_arch(bld, a, LP_BUILD_ROUND_FLOOR);
       }
@@ -2490,6 +2609,10 @@ lp_build_iceil(struct lp_build_context *bld,
    assert(type.floating);
    assert(lp_check_value(type, a));
 
+#if defined(PIPE_ARCH_AARCH64)
+   if (iround_neon_available(type))
+      return lp_build_iround_neon(bld, a, LP_BUILD_ROUND_CEIL);
+#endif
    if (arch_rounding_available(type)) {
       res = lp_build_round_arch(bld, a, LP_BUILD_ROUND_CEIL);
    }
@@ -2786,9 +2909,15 @@ lp_build_fast_rsqrt_available(struct lp_type type)
    assert(type.floating);
 
    if ((util_get_cpu_caps()->has_sse && type.width == 32 && type.length == 4) ||
-       (util_get_cpu_caps()->has_avx && type.width == 32 && type.length == 8)) {
+       (util_get_cpu_caps()->has_avx && type.width == 32 && type.length == 8) ||
+       (util_get_cpu_caps()->has_avx512f && type.width == 32 && type.length == 16)) {
+      return true;
+   }
+#if defined(PIPE_ARCH_AARCH64) || defined(PIPE_ARCH_ARM)
+   if (util_get_cpu_caps()->has_neon && type.width == 32 && type.length == 4) {
       return true;
    }
+#endif
    return false;
 }
 
@@ -2811,7 +2940,42 @@ lp_build_fast_rsqrt(struct lp_build_context *bld,
    if (lp_build_fast_rsqrt_available(type)) {
       const char *intrinsic = NULL;
 
-      if (type.length == 4) {
+#if defined(PIPE_ARCH_AARCH64) || defined(PIPE_ARCH_ARM)
+      if (util_get_cpu_caps()->has_neon) {
+         /*
+          * The estimate only has 8 bits, so do one Newton-Raphson step with
+          * frsqrts, computing (3 - a * x * x) / 2.  Written as
+          * frsqrts(a, x * x) the step keeps rsqrt(0) = inf and
+          * rsqrt(inf) = 0.
+          */
+#if defined(PIPE_ARCH_AARCH64)
+         const char *estimate = "llvm.aarch64.neon.frsqrte.v4f32";
+         const char *step = "llvm.aarch64.neon.frsqrts.v4f32";
+#else
+         const char *estimate = "llvm.arm.neon.vrsqrte.v4f32";
+         const char *step = "llvm.arm.neon.vrsqrts.v4f32";
+#endif
+         LLVMValueRef res, tmp;
+
+         res = lp_build_intrinsic_unary(builder, estimate, bld->vec_type, a);
+         tmp = LLVMBuildFMul(builder, res, res, "");
+         tmp = lp_build_intrinsic_binary(builder, step, bld->vec_type, a, tmp);
+         return LLVMBuildFMul(builder, res, tmp, "");
+      }
+#endif
+
+      if (type.length == 16) {
+         /* rsqrt14 is even more precise than the sse/avx versions */
+         LLVMValueRef args[3];
+
+         args[0] = a;
+         args[1] = bld->undef;
+         args[2] = LLVMConstInt(LLVMInt16TypeInContext(bld->gallivm->context),
+                                0xffff, 0);
+         return lp_build_intrinsic(builder, "llvm.x86.avx512.rsqrt14.ps.512",
+                                   bld->vec_type, args, 3, 0);
+      }
+      else if (type.length == 4) {
          intrinsic = "llvm.x86.sse.rsqrt.ps";
       }
       else {
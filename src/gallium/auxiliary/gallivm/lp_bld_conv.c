@@ -110,6 +110,16 @@ lp_build_half_to_float(struct gallivm_state *gallivm,
    LLVMTypeRef int_vec_type = lp_build_vec_type(gallivm, i32_type);
    LLVMValueRef h;
 
+#if defined(PIPE_ARCH_AARCH64)
+   /* fcvtl converts 4 halfs at a time */
+   if (LLVM_VERSION_MAJOR >= 11 && util_get_cpu_caps()->has_neon &&
+       src_length % 4 == 0) {
+      src = LLVMBuildBitCast(builder, src,
+                             LLVMVectorType(LLVMHalfTypeInContext(gallivm->context), src_length), "");
+      return LLVMBuildFPExt(builder, src, lp_build_vec_type(gallivm, f32_type), "");
+   }
+#endif
+
    if (util_get_cpu_caps()->has_f16c &&
        (src_length == 4 || src_length == 8)) {
       if (LLVM_VERSION_MAJOR < 11) {
@@ -498,7 +508,8 @@ int lp_build_conv_auto(struct gallivm_state *gallivm,
 
       /* Special case 4x4x32 --> 1x16x8 */
       if (src_type.length == 4 &&
-            (util_get_cpu_caps()->has_sse2 || util_get_cpu_caps()->has_altivec))
+            (util_get_cpu_caps()->has_sse2 || util_get_cpu_caps()->has_altivec ||
+             util_get_cpu_caps()->has_neon))
       {
          num_dsts = (num_srcs + 3) / 4;
          dst_type->length = num_srcs * 4 >= 16 ? 16 : num_srcs * 4;
@@ -606,7 +617,8 @@ lp_build_conv(struct gallivm_state *gallivm,
        ((dst_type.length == 16 && 4 * num_dsts == num_srcs) ||
         (num_dsts == 1 && dst_type.length * num_srcs == 16 && num_srcs != 3)) &&
 
-       (util_get_cpu_caps()->has_sse2 || util_get_cpu_caps()->has_altivec))
+       (util_get_cpu_caps()->has_sse2 || util_get_cpu_caps()->has_altivec ||
+        util_get_cpu_caps()->has_neon))
    {
       struct lp_build_context bld;
       struct lp_type int16_type, int32_type;
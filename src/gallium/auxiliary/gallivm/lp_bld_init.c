@@ -59,9 +59,11 @@ static const struct debug_named_value lp_bld_perf_flags[] = {
    { "no_rho_approx", GALLIVM_PERF_NO_RHO_APPROX, "disable rho_approx optimization" },
    { "no_quad_lod", GALLIVM_PERF_NO_QUAD_LOD, "disable quad_lod optimization" },
    { "no_aos_sampling", GALLIVM_PERF_NO_AOS_SAMPLING, "disable aos sampling optimization" },
+   { "no_fast_bilerp", GALLIVM_PERF_NO_FAST_BILERP, "disable ssse3 bilinear filtering of 8-bit textures" },
    { "nopt",   GALLIVM_PERF_NO_OPT, "disable optimization passes to speed up shader compilation" },
    { "no_filter_hacks", GALLIVM_PERF_NO_BRILINEAR | GALLIVM_PERF_NO_RHO_APPROX |
-     GALLIVM_PERF_NO_QUAD_LOD, "disable filter optimization hacks" },
+     GALLIVM_PERF_NO_QUAD_LOD | GALLIVM_PERF_NO_FAST_BILERP,
+     "disable filter optimization hacks" },
    DEBUG_NAMED_VALUE_END
 };
 
@@ -146,7 +148,7 @@ create_pass_manager(struct gallivm_state *gallivm)
    LLVMAddCoroElidePass(gallivm->cgpassmgr);
 #endif
 
-   if ((gallivm_perf & GALLIVM_PERF_NO_OPT) == 0) {
+   if ((gallivm_perf & GALLIVM_PERF_NO_OPT) == 0 && !gallivm->no_opt) {
       /*
        * TODO: Evaluate passes some more - keeping in mind
        * both quality of generated code and compile times.
@@ -208,12 +210,19 @@ gallivm_free_ir(struct gallivm_state *gallivm)
    }
 #endif
 
+#if GALLIVM_USE_ORCJIT
+   /* The ORC session only holds the object code, not the module */
+   if (gallivm->module) {
+      LLVMDisposeModule(gallivm->module);
+   }
+#else
    if (gallivm->engine) {
       /* This will already destroy any associated module */
       LLVMDisposeExecutionEngine(gallivm->engine);
    } else if (gallivm->module) {
       LLVMDisposeModule(gallivm->module);
    }
+#endif
 
    if (gallivm->cache) {
       lp_free_objcache(gallivm->cache->jit_obj_cache);
@@ -230,7 +239,9 @@ gallivm_free_ir(struct gallivm_state *gallivm)
 
    /* The LLVMContext should be owned by the parent of gallivm. */
 
+#if !GALLIVM_USE_ORCJIT
    gallivm->engine = NULL;
+#endif
    gallivm->target = NULL;
    gallivm->module = NULL;
    gallivm->module_name = NULL;
@@ -249,11 +260,16 @@ static void
 gallivm_free_code(struct gallivm_state *gallivm)
 {
    assert(!gallivm->module);
+#if GALLIVM_USE_ORCJIT
+   lp_free_jit_library(gallivm->jit_lib);
+   gallivm->jit_lib = NULL;
+#else
    assert(!gallivm->engine);
    lp_free_generated_code(gallivm->code);
    gallivm->code = NULL;
    lp_free_memory_manager(gallivm->memorymgr);
    gallivm->memorymgr = NULL;
+#endif
 }
 
 
@@ -265,13 +281,20 @@ init_gallivm_engine(struct gallivm_state *gallivm)
       char *error = NULL;
       int ret;
 
-      if (gallivm_perf & GALLIVM_PERF_NO_OPT) {
+      if ((gallivm_perf & GALLIVM_PERF_NO_OPT) || gallivm->no_opt) {
          optlevel = None;
       }
       else {
          optlevel = Default;
       }
 
+#if GALLIVM_USE_ORCJIT
+      ret = lp_build_jit_add_module(&gallivm->jit_lib,
+                                    gallivm->cache,
+                                    gallivm->module,
+                                    (unsigned) optlevel,
+                                    &error);
+#else
       ret = lp_build_create_jit_compiler_for_module(&gallivm->engine,
                                                     &gallivm->code,
                                                     gallivm->cache,
@@ -279,6 +302,7 @@ init_gallivm_engine(struct gallivm_state *gallivm)
                                                     gallivm->memorymgr,
                                                     (unsigned) optlevel,
                                                     &error);
+#endif
       if (ret) {
          _debug_printf("%s\n", error);
          LLVMDisposeMessage(error);
@@ -286,6 +310,7 @@ init_gallivm_engine(struct gallivm_state *gallivm)
       }
    }
 
+#if !GALLIVM_USE_ORCJIT
    if (0) {
        /*
         * Dump the data layout strings.
@@ -306,6 +331,7 @@ init_gallivm_engine(struct gallivm_state *gallivm)
        free(data_layout);
        free(engine_data_layout);
    }
+#endif
 
    return TRUE;
 
@@ -320,7 +346,8 @@ fail:
  */
 static boolean
 init_gallivm_state(struct gallivm_state *gallivm, const char *name,
-                   LLVMContextRef context, struct lp_cached_code *cache)
+                   LLVMContextRef context, struct lp_cached_code *cache,
+                   boolean no_opt)
 {
    assert(!gallivm->context);
    assert(!gallivm->module);
@@ -330,6 +357,7 @@ init_gallivm_state(struct gallivm_state *gallivm, const char *name,
 
    gallivm->context = context;
    gallivm->cache = cache;
+   gallivm->no_opt = no_opt;
    if (!gallivm->context)
       goto fail;
 
@@ -351,9 +379,11 @@ init_gallivm_state(struct gallivm_state *gallivm, const char *name,
    if (!gallivm->builder)
       goto fail;
 
+#if !GALLIVM_USE_ORCJIT
    gallivm->memorymgr = lp_get_default_memory_manager();
    if (!gallivm->memorymgr)
       goto fail;
+#endif
 
    /* FIXME: MC-JIT only allows compiling one module at a time, and it must be
     * complete when MC-JIT is created. So defer the MC-JIT engine creation for
@@ -446,6 +476,17 @@ lp_build_init(void)
    }
 #endif
 
+#if LLVM_VERSION_MAJOR >= 4
+   if (util_get_cpu_caps()->has_avx512f &&
+       util_get_cpu_caps()->has_avx512bw &&
+       util_get_cpu_caps()->has_avx512dq &&
+       util_get_cpu_caps()->has_avx512vl) {
+      /* A whole 4x4 block of fragments per vector.  Code generation for
+       * avx512 is only enabled with the host cpu features of llvm 4+.
+       */
+      lp_native_vector_width = 512;
+   } else
+#endif
    if (util_get_cpu_caps()->has_avx2 || util_get_cpu_caps()->has_avx) {
       lp_native_vector_width = 256;
    } else {
@@ -514,7 +555,31 @@ gallivm_create(const char *name, LLVMContextRef context,
 
    gallivm = CALLOC_STRUCT(gallivm_state);
    if (gallivm) {
-      if (!init_gallivm_state(gallivm, name, context, cache)) {
+      if (!init_gallivm_state(gallivm, name, context, cache, FALSE)) {
+         FREE(gallivm);
+         gallivm = NULL;
+      }
+   }
+
+   assert(gallivm != NULL);
+   return gallivm;
+}
+
+
+/**
+ * Create a new gallivm_state object whose module gets compiled as quickly
+ * as possible, at the expense of the quality of the generated code.
+ * Meant for stand-in code which gets replaced by an optimized build later,
+ * hence the code never goes into the shader cache.
+ */
+struct gallivm_state *
+gallivm_create_unoptimized(const char *name, LLVMContextRef context)
+{
+   struct gallivm_state *gallivm;
+
+   gallivm = CALLOC_STRUCT(gallivm_state);
+   if (gallivm) {
+      if (!init_gallivm_state(gallivm, name, context, NULL, TRUE)) {
          FREE(gallivm);
          gallivm = NULL;
       }
@@ -562,6 +627,38 @@ gallivm_verify_function(struct gallivm_state *gallivm,
 }
 
 
+static void *
+get_function_code(struct gallivm_state *gallivm, LLVMValueRef func)
+{
+#if GALLIVM_USE_ORCJIT
+   assert(gallivm->jit_lib);
+   return lp_jit_library_lookup(gallivm->jit_lib, LLVMGetValueName(func));
+#else
+   assert(gallivm->engine);
+   return LLVMGetPointerToGlobal(gallivm->engine, func);
+#endif
+}
+
+
+/**
+ * Make calls to the function declared as func resolve to addr.
+ * Must be done after gallivm_compile_module() and before any function is
+ * jitted.
+ */
+void
+gallivm_add_global_mapping(struct gallivm_state *gallivm,
+                           LLVMValueRef func, void *addr)
+{
+#if GALLIVM_USE_ORCJIT
+   assert(gallivm->jit_lib);
+   lp_jit_library_add_symbol(gallivm->jit_lib, LLVMGetValueName(func), addr);
+#else
+   assert(gallivm->engine);
+   LLVMAddGlobalMapping(gallivm->engine, func, addr);
+#endif
+}
+
+
 /**
  * Compile a module.
  * This does IR optimization on all functions in the module.
@@ -652,16 +749,25 @@ gallivm_compile_module(struct gallivm_state *gallivm)
     */
  skip_cached:
    LLVMSetDataLayout(gallivm->module, "");
+#if GALLIVM_USE_ORCJIT
+   assert(!gallivm->jit_lib);
+   if (!init_gallivm_engine(gallivm)) {
+      assert(0);
+   }
+   assert(gallivm->jit_lib);
+#else
    assert(!gallivm->engine);
    if (!init_gallivm_engine(gallivm)) {
       assert(0);
    }
    assert(gallivm->engine);
+#endif
 
    ++gallivm->compiled;
 
    if (gallivm->debug_printf_hook)
-      LLVMAddGlobalMapping(gallivm->engine, gallivm->debug_printf_hook, debug_printf);
+      gallivm_add_global_mapping(gallivm, gallivm->debug_printf_hook,
+                                 debug_printf);
 
    if (gallivm_debug & GALLIVM_DEBUG_ASM) {
       LLVMValueRef llvm_func = LLVMGetFirstFunction(gallivm->module);
@@ -673,7 +779,7 @@ gallivm_compile_module(struct gallivm_state *gallivm)
           * LLVMGetPointerToGlobal() will abort otherwise.
           */
          if (!LLVMIsDeclaration(llvm_func)) {
-            void *func_code = LLVMGetPointerToGlobal(gallivm->engine, llvm_func);
+            void *func_code = get_function_code(gallivm, llvm_func);
             lp_disassemble(llvm_func, func_code);
          }
          llvm_func = LLVMGetNextFunction(llvm_func);
@@ -686,7 +792,7 @@ gallivm_compile_module(struct gallivm_state *gallivm)
 
       while (llvm_func) {
          if (!LLVMIsDeclaration(llvm_func)) {
-            void *func_code = LLVMGetPointerToGlobal(gallivm->engine, llvm_func);
+            void *func_code = get_function_code(gallivm, llvm_func);
             lp_profile(llvm_func, func_code);
          }
          llvm_func = LLVMGetNextFunction(llvm_func);
@@ -706,12 +812,11 @@ gallivm_jit_function(struct gallivm_state *gallivm,
    int64_t time_begin = 0;
 
    assert(gallivm->compiled);
-   assert(gallivm->engine);
 
    if (gallivm_debug & GALLIVM_DEBUG_PERF)
       time_begin = os_time_get();
 
-   code = LLVMGetPointerToGlobal(gallivm->engine, func);
+   code = get_function_code(gallivm, func);
    assert(code);
    jit_func = pointer_to_func(code);
 
@@ -40,20 +40,28 @@ extern "C" {
 #endif
 
 struct lp_cached_code;
+struct lp_jit_library;
 struct gallivm_state
 {
    char *module_name;
    LLVMModuleRef module;
+#if GALLIVM_USE_ORCJIT
+   struct lp_jit_library *jit_lib;  /**< this module's code in the ORC session */
+#else
    LLVMExecutionEngineRef engine;
+#endif
    LLVMTargetDataRef target;
    LLVMPassManagerRef passmgr;
    LLVMPassManagerRef cgpassmgr;
    LLVMContextRef context;
    LLVMBuilderRef builder;
+#if !GALLIVM_USE_ORCJIT
    LLVMMCJITMemoryManagerRef memorymgr;
    struct lp_generated_code *code;
+#endif
    struct lp_cached_code *cache;
    unsigned compiled;
+   boolean no_opt;      /**< skip IR optimizations, fast instruction selection */
    LLVMValueRef coro_malloc_hook;
    LLVMValueRef coro_free_hook;
    LLVMValueRef debug_printf_hook;
@@ -68,6 +76,9 @@ struct gallivm_state *
 gallivm_create(const char *name, LLVMContextRef context,
                struct lp_cached_code *cache);
 
+struct gallivm_state *
+gallivm_create_unoptimized(const char *name, LLVMContextRef context);
+
 void
 gallivm_destroy(struct gallivm_state *gallivm);
 
@@ -85,6 +96,10 @@ func_pointer
 gallivm_jit_function(struct gallivm_state *gallivm,
                      LLVMValueRef func);
 
+void
+gallivm_add_global_mapping(struct gallivm_state *gallivm,
+                           LLVMValueRef func, void *addr);
+
 unsigned gallivm_get_perf_flags(void);
 
 #ifdef __cplusplus
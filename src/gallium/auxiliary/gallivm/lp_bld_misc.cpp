@@ -77,6 +77,15 @@
 #include <llvm/ExecutionEngine/JITEventListener.h>
 #endif
 
+#if GALLIVM_USE_ORCJIT
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <vector>
+#endif
+
 #if LLVM_VERSION_MAJOR < 7
 // Workaround http://llvm.org/PR23628
 #pragma pop_macro("DEBUG")
@@ -85,6 +94,7 @@
 #include "c11/threads.h"
 #include "os/os_thread.h"
 #include "pipe/p_config.h"
+#include "util/u_atomic.h"
 #include "util/u_debug.h"
 #include "util/u_cpu_detect.h"
 
@@ -321,61 +331,14 @@ public:
 };
 
 /**
- * Same as LLVMCreateJITCompilerForModule, but:
- * - allows using MCJIT and enabling AVX feature where available.
- * - set target options
- *
- * See also:
- * - llvm/lib/ExecutionEngine/ExecutionEngineBindings.cpp
- * - llvm/tools/lli/lli.cpp
- * - http://markmail.org/message/ttkuhvgj4cxxy2on#query:+page:1+mid:aju2dggerju3ivd3+state:results
+ * Host cpu name and features to generate code for.
  */
-extern "C"
-LLVMBool
-lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
-                                        lp_generated_code **OutCode,
-                                        struct lp_cached_code *cache_out,
-                                        LLVMModuleRef M,
-                                        LLVMMCJITMemoryManagerRef CMM,
-                                        unsigned OptLevel,
-                                        char **OutError)
+static void
+lp_get_host_target(llvm::SmallVector<std::string, 16> &MAttrs,
+                   std::string &MCPU)
 {
    using namespace llvm;
 
-   std::string Error;
-   EngineBuilder builder(std::unique_ptr<Module>(unwrap(M)));
-
-   /**
-    * LLVM 3.1+ haven't more "extern unsigned llvm::StackAlignmentOverride" and
-    * friends for configuring code generation options, like stack alignment.
-    */
-   TargetOptions options;
-#if defined(PIPE_ARCH_X86)
-   options.StackAlignmentOverride = 4;
-#endif
-
-   builder.setEngineKind(EngineKind::JIT)
-          .setErrorStr(&Error)
-          .setTargetOptions(options)
-          .setOptLevel((CodeGenOpt::Level)OptLevel);
-
-#ifdef _WIN32
-    /*
-     * MCJIT works on Windows, but currently only through ELF object format.
-     *
-     * XXX: We could use `LLVM_HOST_TRIPLE "-elf"` but LLVM_HOST_TRIPLE has
-     * different strings for MinGW/MSVC, so better play it safe and be
-     * explicit.
-     */
-#  ifdef _WIN64
-    LLVMSetTarget(M, "x86_64-pc-win32-elf");
-#  else
-    LLVMSetTarget(M, "i686-pc-win32-elf");
-#  endif
-#endif
-
-   llvm::SmallVector<std::string, 16> MAttrs;
-
 #if LLVM_VERSION_MAJOR >= 4 && (defined(PIPE_ARCH_X86) || defined(PIPE_ARCH_X86_64) || defined(PIPE_ARCH_ARM))
    /* llvm-3.3+ implements sys::getHostCPUFeatures for Arm
     * and llvm-3.7+ for x86, which allows us to enable/disable
@@ -464,8 +427,6 @@ lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
 #endif
 #endif
 
-   builder.setMAttrs(MAttrs);
-
    if (gallivm_debug & (GALLIVM_DEBUG_IR | GALLIVM_DEBUG_ASM | GALLIVM_DEBUG_DUMP_BC)) {
       int n = MAttrs.size();
       if (n > 0) {
@@ -476,7 +437,7 @@ lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
       }
    }
 
-   StringRef MCPU = llvm::sys::getHostCPUName();
+   MCPU = llvm::sys::getHostCPUName().str();
    /*
     * The cpu bits are no longer set automatically, so need to set mcpu manually.
     * Note that the MAttrs set above will be sort of ignored (since we should
@@ -490,19 +451,7 @@ lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
     * can't handle. Not entirely sure if we really need to do anything yet.
     */
 
-#ifdef PIPE_ARCH_PPC_64
-   /*
-    * Large programs, e.g. gnome-shell and firefox, may tax the addressability
-    * of the Medium code model once dynamically generated JIT-compiled shader
-    * programs are linked in and relocated.  Yet the default code model as of
-    * LLVM 8 is Medium or even Small.
-    * The cost of changing from Medium to Large is negligible:
-    * - an additional 8-byte pointer stored immediately before the shader entrypoint;
-    * - change an add-immediate (addis) instruction to a load (ld).
-    */
-   builder.setCodeModel(CodeModel::Large);
-
-#if UTIL_ARCH_LITTLE_ENDIAN
+#if defined(PIPE_ARCH_PPC_64) && UTIL_ARCH_LITTLE_ENDIAN
    /*
     * Versions of LLVM prior to 4.0 lacked a table entry for "POWER8NVL",
     * resulting in (big-endian) "generic" being returned on
@@ -515,11 +464,85 @@ lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
    if (MCPU == "generic")
       MCPU = "pwr8";
 #endif
-#endif
-   builder.setMCPU(MCPU);
+
    if (gallivm_debug & (GALLIVM_DEBUG_IR | GALLIVM_DEBUG_ASM | GALLIVM_DEBUG_DUMP_BC)) {
-      debug_printf("llc -mcpu option: %s\n", MCPU.str().c_str());
+      debug_printf("llc -mcpu option: %s\n", MCPU.c_str());
    }
+}
+
+/**
+ * Same as LLVMCreateJITCompilerForModule, but:
+ * - allows using MCJIT and enabling AVX feature where available.
+ * - set target options
+ *
+ * See also:
+ * - llvm/lib/ExecutionEngine/ExecutionEngineBindings.cpp
+ * - llvm/tools/lli/lli.cpp
+ * - http://markmail.org/message/ttkuhvgj4cxxy2on#query:+page:1+mid:aju2dggerju3ivd3+state:results
+ */
+extern "C"
+LLVMBool
+lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
+                                        lp_generated_code **OutCode,
+                                        struct lp_cached_code *cache_out,
+                                        LLVMModuleRef M,
+                                        LLVMMCJITMemoryManagerRef CMM,
+                                        unsigned OptLevel,
+                                        char **OutError)
+{
+   using namespace llvm;
+
+   std::string Error;
+   EngineBuilder builder(std::unique_ptr<Module>(unwrap(M)));
+
+   /**
+    * LLVM 3.1+ haven't more "extern unsigned llvm::StackAlignmentOverride" and
+    * friends for configuring code generation options, like stack alignment.
+    */
+   TargetOptions options;
+#if defined(PIPE_ARCH_X86)
+   options.StackAlignmentOverride = 4;
+#endif
+
+   builder.setEngineKind(EngineKind::JIT)
+          .setErrorStr(&Error)
+          .setTargetOptions(options)
+          .setOptLevel((CodeGenOpt::Level)OptLevel);
+
+#ifdef _WIN32
+    /*
+     * MCJIT works on Windows, but currently only through ELF object format.
+     *
+     * XXX: We could use `LLVM_HOST_TRIPLE "-elf"` but LLVM_HOST_TRIPLE has
+     * different strings for MinGW/MSVC, so better play it safe and be
+     * explicit.
+     */
+#  ifdef _WIN64
+    LLVMSetTarget(M, "x86_64-pc-win32-elf");
+#  else
+    LLVMSetTarget(M, "i686-pc-win32-elf");
+#  endif
+#endif
+
+   llvm::SmallVector<std::string, 16> MAttrs;
+   std::string MCPU;
+
+   lp_get_host_target(MAttrs, MCPU);
+   builder.setMAttrs(MAttrs);
+   builder.setMCPU(MCPU);
+
+#ifdef PIPE_ARCH_PPC_64
+   /*
+    * Large programs, e.g. gnome-shell and firefox, may tax the addressability
+    * of the Medium code model once dynamically generated JIT-compiled shader
+    * programs are linked in and relocated.  Yet the default code model as of
+    * LLVM 8 is Medium or even Small.
+    * The cost of changing from Medium to Large is negligible:
+    * - an additional 8-byte pointer stored immediately before the shader entrypoint;
+    * - change an add-immediate (addis) instruction to a load (ld).
+    */
+   builder.setCodeModel(CodeModel::Large);
+#endif
 
    ShaderMemoryManager *MM = NULL;
    BaseMemoryManager* JMM = reinterpret_cast<BaseMemoryManager*>(CMM);
@@ -585,6 +608,277 @@ lp_free_objcache(void *objcache_ptr)
    delete objcache;
 }
 
+#if GALLIVM_USE_ORCJIT
+
+/*
+ * One ORC session shared by all gallivm modules, instead of an MCJIT engine
+ * with its own target machine and memory manager per module.
+ *
+ * Every module gets its own JITDylib, so its code memory can be released on
+ * its own once the variant goes away.  Modules are compiled to object code
+ * on the calling thread, as the IR is freed right after jitting; the object
+ * is only linked when its first symbol is looked up.  Target machines can't
+ * be used by several threads at once, so they are recycled through a pool
+ * rather than shared.
+ */
+struct lp_jit_library {
+   llvm::orc::JITDylib *JD;
+};
+
+namespace {
+
+class LPJit {
+public:
+   static LPJit *get()
+   {
+      call_once(&once_flag, create);
+      return instance;
+   }
+
+   llvm::orc::LLJIT &jit() { return *JIT; }
+
+   llvm::TargetMachine *take_target_machine(unsigned OptLevel)
+   {
+      llvm::TargetMachine *TM = NULL;
+      unsigned Idx = OptLevel ? 1 : 0;
+
+      mtx_lock(&mutex);
+      if (!tm_pool[Idx].empty()) {
+         TM = tm_pool[Idx].back();
+         tm_pool[Idx].pop_back();
+      }
+      mtx_unlock(&mutex);
+
+      if (!TM) {
+         llvm::orc::JITTargetMachineBuilder Builder(JTMB);
+         Builder.setCodeGenOptLevel((llvm::CodeGenOpt::Level)OptLevel);
+         auto NewTM = Builder.createTargetMachine();
+         if (!NewTM) {
+            llvm::consumeError(NewTM.takeError());
+            return NULL;
+         }
+         TM = NewTM->release();
+      }
+      return TM;
+   }
+
+   void return_target_machine(llvm::TargetMachine *TM, unsigned OptLevel)
+   {
+      mtx_lock(&mutex);
+      tm_pool[OptLevel ? 1 : 0].push_back(TM);
+      mtx_unlock(&mutex);
+   }
+
+   std::string new_library_name()
+   {
+      return "gallivm" + std::to_string(p_atomic_inc_return(&library_count));
+   }
+
+private:
+   LPJit(std::unique_ptr<llvm::orc::LLJIT> JIT,
+         llvm::orc::JITTargetMachineBuilder JTMB) :
+      JIT(std::move(JIT)), JTMB(std::move(JTMB)), library_count(0)
+   {
+      mtx_init(&mutex, mtx_plain);
+   }
+
+   static void create();
+
+   static ::once_flag once_flag;
+   static LPJit *instance;
+
+   std::unique_ptr<llvm::orc::LLJIT> JIT;
+   llvm::orc::JITTargetMachineBuilder JTMB;
+   mtx_t mutex;
+   std::vector<llvm::TargetMachine *> tm_pool[2];
+   unsigned library_count;
+};
+
+::once_flag LPJit::once_flag = ONCE_FLAG_INIT;
+LPJit *LPJit::instance = NULL;
+
+void
+LPJit::create()
+{
+   using namespace llvm;
+   using namespace llvm::orc;
+
+#ifdef _WIN32
+   /* same as MCJIT, see lp_build_create_jit_compiler_for_module() */
+#  ifdef _WIN64
+   JITTargetMachineBuilder JTMB((Triple("x86_64-pc-win32-elf")));
+#  else
+   JITTargetMachineBuilder JTMB((Triple("i686-pc-win32-elf")));
+#  endif
+#else
+   JITTargetMachineBuilder JTMB((Triple(sys::getProcessTriple())));
+#endif
+
+   TargetOptions options;
+#if defined(PIPE_ARCH_X86)
+   options.StackAlignmentOverride = 4;
+#endif
+   JTMB.setOptions(options);
+
+   llvm::SmallVector<std::string, 16> MAttrs;
+   std::string MCPU;
+
+   lp_get_host_target(MAttrs, MCPU);
+   JTMB.setCPU(MCPU);
+   JTMB.addFeatures(std::vector<std::string>(MAttrs.begin(), MAttrs.end()));
+#ifdef PIPE_ARCH_PPC_64
+   /* see lp_build_create_jit_compiler_for_module() */
+   JTMB.setCodeModel(CodeModel::Large);
+#endif
+
+   auto JIT = LLJITBuilder()
+      .setJITTargetMachineBuilder(JTMB)
+      .setObjectLinkingLayerCreator(
+         [](ExecutionSession &ES, const Triple &TT) {
+            auto Layer = std::make_unique<RTDyldObjectLinkingLayer>(
+               ES, []() { return std::make_unique<SectionMemoryManager>(); });
+#if LLVM_USE_INTEL_JITEVENTS
+            Layer->registerJITEventListener(
+               *JITEventListener::createIntelJITEventListener());
+#endif
+            return Expected<std::unique_ptr<ObjectLayer>>(std::move(Layer));
+         })
+      .create();
+   if (!JIT) {
+      _debug_printf("%s\n", toString(JIT.takeError()).c_str());
+      return;
+   }
+
+   /* resolve calls to libm and friends from the process */
+   auto ProcessSymbols = DynamicLibrarySearchGenerator::GetForCurrentProcess(
+      (*JIT)->getDataLayout().getGlobalPrefix());
+   if (!ProcessSymbols) {
+      _debug_printf("%s\n", toString(ProcessSymbols.takeError()).c_str());
+      return;
+   }
+   (*JIT)->getMainJITDylib().addGenerator(std::move(*ProcessSymbols));
+
+   instance = new LPJit(std::move(*JIT), std::move(JTMB));
+}
+
+}
+
+extern "C"
+LLVMBool
+lp_build_jit_add_module(struct lp_jit_library **OutLib,
+                        struct lp_cached_code *cache_out,
+                        LLVMModuleRef M,
+                        unsigned OptLevel,
+                        char **OutError)
+{
+   using namespace llvm;
+   using namespace llvm::orc;
+
+   LPJit *lpjit = LPJit::get();
+   Module *Mod = unwrap(M);
+   TargetMachine *TM;
+   LPObjectCache *objcache = NULL;
+   std::unique_ptr<MemoryBuffer> Obj;
+
+   *OutLib = NULL;
+   if (!lpjit || !(TM = lpjit->take_target_machine(OptLevel))) {
+      *OutError = strdup("failed to create the ORC JIT");
+      return 1;
+   }
+
+   Mod->setDataLayout(TM->createDataLayout());
+   Mod->setTargetTriple(TM->getTargetTriple().str());
+
+   if (cache_out) {
+      objcache = new LPObjectCache(cache_out);
+      cache_out->jit_obj_cache = (void *)objcache;
+   }
+
+   {
+      SimpleCompiler Compile(*TM, objcache);
+      auto Compiled = Compile(*Mod);
+      lpjit->return_target_machine(TM, OptLevel);
+      if (!Compiled) {
+         *OutError = strdup(toString(Compiled.takeError()).c_str());
+         return 1;
+      }
+      Obj = std::move(*Compiled);
+   }
+
+   /* A cached object only points at the cache data, which is freed along
+    * with the IR, before the object gets linked.
+    */
+   if (cache_out && Obj->getBufferStart() == cache_out->data)
+      Obj = MemoryBuffer::getMemBufferCopy(Obj->getBuffer(),
+                                           Obj->getBufferIdentifier());
+
+   ExecutionSession &ES = lpjit->jit().getExecutionSession();
+   auto JD = ES.createJITDylib(lpjit->new_library_name());
+   if (!JD) {
+      *OutError = strdup(toString(JD.takeError()).c_str());
+      return 1;
+   }
+   JD->addToLinkOrder(lpjit->jit().getMainJITDylib());
+
+   if (Error Err = lpjit->jit().addObjectFile(*JD, std::move(Obj))) {
+      *OutError = strdup(toString(std::move(Err)).c_str());
+      cantFail(ES.removeJITDylib(*JD));
+      return 1;
+   }
+
+   *OutLib = new lp_jit_library;
+   (*OutLib)->JD = &*JD;
+   return 0;
+}
+
+extern "C"
+void
+lp_jit_library_add_symbol(struct lp_jit_library *lib,
+                          const char *name, void *addr)
+{
+   using namespace llvm;
+   using namespace llvm::orc;
+
+   LPJit *lpjit = LPJit::get();
+   SymbolMap Symbols;
+
+   Symbols[lpjit->jit().mangleAndIntern(name)] =
+      JITEvaluatedSymbol(pointerToJITTargetAddress(addr),
+                         JITSymbolFlags::Exported);
+   if (Error Err = lib->JD->define(absoluteSymbols(std::move(Symbols))))
+      _debug_printf("%s\n", toString(std::move(Err)).c_str());
+}
+
+extern "C"
+void *
+lp_jit_library_lookup(struct lp_jit_library *lib, const char *name)
+{
+   using namespace llvm;
+
+   auto Sym = LPJit::get()->jit().lookup(*lib->JD, name);
+   if (!Sym) {
+      _debug_printf("%s\n", toString(Sym.takeError()).c_str());
+      return NULL;
+   }
+   return jitTargetAddressToPointer<void *>(Sym->getAddress());
+}
+
+extern "C"
+void
+lp_free_jit_library(struct lp_jit_library *lib)
+{
+   using namespace llvm;
+
+   if (!lib)
+      return;
+
+   if (Error Err = LPJit::get()->jit().getExecutionSession().removeJITDylib(*lib->JD))
+      _debug_printf("%s\n", toString(std::move(Err)).c_str());
+   delete lib;
+}
+
+#endif /* GALLIVM_USE_ORCJIT */
+
 extern "C" LLVMValueRef
 lp_get_called_value(LLVMValueRef call)
 {
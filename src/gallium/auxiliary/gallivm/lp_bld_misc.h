@@ -77,6 +77,27 @@ lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
 extern void
 lp_free_generated_code(struct lp_generated_code *code);
 
+#if GALLIVM_USE_ORCJIT
+struct lp_jit_library;
+
+extern int
+lp_build_jit_add_module(struct lp_jit_library **OutLib,
+                        struct lp_cached_code *cache_out,
+                        LLVMModuleRef M,
+                        unsigned OptLevel,
+                        char **OutError);
+
+extern void
+lp_jit_library_add_symbol(struct lp_jit_library *lib,
+                          const char *name, void *addr);
+
+extern void *
+lp_jit_library_lookup(struct lp_jit_library *lib, const char *name);
+
+extern void
+lp_free_jit_library(struct lp_jit_library *lib);
+#endif
+
 extern LLVMMCJITMemoryManagerRef
 lp_get_default_memory_manager();
 
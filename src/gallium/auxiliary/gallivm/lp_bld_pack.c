@@ -691,6 +691,48 @@ lp_build_pack2(struct gallivm_state *gallivm,
       }
    }
 
+#if defined(PIPE_ARCH_AARCH64) || defined(PIPE_ARCH_ARM)
+   /*
+    * NEON narrows one register at a time. Like the SSE2 packs, the inputs
+    * are treated as signed, and saturated to the signed or unsigned
+    * destination range.
+    */
+   if (util_get_cpu_caps()->has_neon &&
+       (src_type.width == 32 || src_type.width == 16) &&
+       src_type.width * src_type.length % 128 == 0) {
+      const unsigned nlen = 128 / src_type.width;
+      const unsigned num_split = src_type.width * src_type.length / 128;
+      struct lp_type half_type = lp_type_int_vec(dst_type.width, 64);
+      LLVMTypeRef half_vec_type = lp_build_vec_type(gallivm, half_type);
+      LLVMValueRef tmpres[2 * LP_MAX_VECTOR_WIDTH / 128];
+      const char *op;
+      char intrinsic[48];
+      unsigned i;
+
+#if defined(PIPE_ARCH_AARCH64)
+      op = dst_type.sign ? "llvm.aarch64.neon.sqxtn" :
+                           "llvm.aarch64.neon.sqxtun";
+#else
+      op = dst_type.sign ? "llvm.arm.neon.vqmovns" :
+                           "llvm.arm.neon.vqmovnsu";
+#endif
+      snprintf(intrinsic, sizeof intrinsic, "%s.v%ui%u",
+               op, half_type.length, half_type.width);
+
+      for (i = 0; i < 2 * num_split; i++) {
+         LLVMValueRef src = i < num_split ? lo : hi;
+
+         if (num_split > 1)
+            src = lp_build_extract_range(gallivm, src,
+                                         (i % num_split) * nlen, nlen);
+         tmpres[i] = lp_build_intrinsic_unary(builder, intrinsic,
+                                              half_vec_type, src);
+      }
+      res = lp_build_concat(gallivm, tmpres, half_type, 2 * num_split);
+      return LLVMBuildBitCast(builder, res, dst_vec_type, "");
+   }
+#endif
+
    /* generic shuffle */
    lo = LLVMBuildBitCast(builder, lo, dst_vec_type, "");
    hi = LLVMBuildBitCast(builder, hi, dst_vec_type, "");
@@ -792,8 +834,9 @@ lp_build_packs2(struct gallivm_state *gallivm,
    clamp = TRUE;
 
    /* All X86 SSE non-interleaved pack instructions take signed inputs and
-    * saturate them, so no need to clamp for those cases. */
-   if(util_get_cpu_caps()->has_sse2 &&
+    * saturate them, so no need to clamp for those cases. Same for the
+    * NEON saturating narrows used by lp_build_pack2. */
+   if((util_get_cpu_caps()->has_sse2 || util_get_cpu_caps()->has_neon) &&
       src_type.width * src_type.length >= 128 &&
       src_type.sign &&
       (src_type.width == 32 || src_type.width == 16))
@@ -52,6 +52,7 @@
 #include "lp_bld_pack.h"
 #include "lp_bld_flow.h"
 #include "lp_bld_gather.h"
+#include "lp_bld_intr.h"
 #include "lp_bld_format.h"
 #include "lp_bld_init.h"
 #include "lp_bld_sample.h"
@@ -551,6 +552,112 @@ lp_build_sample_image_nearest(struct lp_build_sample_context *bld,
 }
 
 
+/**
+ * Bilinear interpolation of 8-bit unorm texels with SSSE3, for the common
+ * 2D weighted average case.
+ *
+ * The horizontal lerp of 8 channels is a single pmaddubsw: the weights
+ * (128 - s/2, s/2) are the unsigned operand, and the texels, biased by -128 so
+ * they fit a signed byte, the signed one.  This has 7 bits of horizontal
+ * sub-texel precision instead of 8.  The vertical lerp is done with pmulhrsw
+ * on the 16-bit results, at the full 8 bits.
+ *
+ * The weights are 8-bit fixed point, replicated for the 4 channels of each
+ * texel, as in lp_build_sample_fetch_image_linear.
+ */
+static LLVMValueRef
+lp_build_bilerp_rgba8_ssse3(struct gallivm_state *gallivm,
+                            struct lp_type u8n_type,
+                            LLVMValueRef s_fpart,
+                            LLVMValueRef t_fpart,
+                            LLVMValueRef n00, LLVMValueRef n01,
+                            LLVMValueRef n10, LLVMValueRef n11)
+{
+   LLVMBuilderRef builder = gallivm->builder;
+   struct lp_type i8_type = lp_type_int_vec(8, 128);
+   struct lp_type u8_type = lp_type_uint_vec(8, 128);
+   struct lp_type i16_type = lp_type_int_vec(16, 128);
+   LLVMTypeRef i16_vec_type = lp_build_vec_type(gallivm, i16_type);
+   const unsigned num_chunks = u8n_type.length / 16;
+   LLVMValueRef bias = lp_build_const_int_vec(gallivm, i8_type, -128);
+   LLVMValueRef one = lp_build_const_int_vec(gallivm, i8_type, 1);
+   LLVMValueRef c128 = lp_build_const_int_vec(gallivm, i8_type, -128);
+   LLVMValueRef zero = LLVMConstNull(lp_build_vec_type(gallivm, i8_type));
+   /* undo the bias and round, (x + 128 * 128 + 64) >> 7 */
+   LLVMValueRef unbias = lp_build_const_int_vec(gallivm, i16_type, 16448);
+   LLVMValueRef shift7 = lp_build_const_int_vec(gallivm, i16_type, 7);
+   LLVMValueRef res[LP_MAX_VECTOR_LENGTH / 16];
+   unsigned chunk;
+
+   assert(u8n_type.width == 8 && u8n_type.length % 16 == 0);
+
+   for (chunk = 0; chunk < num_chunks; chunk++) {
+      LLVMValueRef s = s_fpart, t = t_fpart;
+      LLVMValueRef texels[2][2] = { { n00, n01 }, { n10, n11 } };
+      LLVMValueRef w0, w1, filtered[2];
+      unsigned half, x, y;
+
+      if (num_chunks > 1) {
+         s = lp_build_extract_range(gallivm, s, chunk * 16, 16);
+         t = lp_build_extract_range(gallivm, t, chunk * 16, 16);
+         for (y = 0; y < 2; y++)
+            for (x = 0; x < 2; x++)
+               texels[y][x] = lp_build_extract_range(gallivm, texels[y][x],
+                                                     chunk * 16, 16);
+      }
+
+      /* w1 = (s + 1) >> 1 in [0, 128], w0 = 128 - w1 */
+      w1 = LLVMBuildAdd(builder,
+                        LLVMBuildLShr(builder, s, one, ""),
+                        LLVMBuildAnd(builder, s, one, ""), "");
+      w0 = LLVMBuildSub(builder, c128, w1, "");
+
+      for (y = 0; y < 2; y++)
+         for (x = 0; x < 2; x++)
+            texels[y][x] = LLVMBuildXor(builder, texels[y][x], bias, "");
+
+      for (half = 0; half < 2; half++) {
+         LLVMValueRef weights, rows[2], tw, delta;
+
+         weights = lp_build_interleave2(gallivm, i8_type, w0, w1, half);
+
+         for (y = 0; y < 2; y++) {
+            LLVMValueRef pairs = lp_build_interleave2(gallivm, i8_type,
+                                                      texels[y][0],
+                                                      texels[y][1], half);
+            /* 128 * (lerp - 128), in [-16384, 16256] */
+            rows[y] = lp_build_intrinsic_binary(builder,
+                                                "llvm.x86.ssse3.pmadd.ub.sw.128",
+                                                i16_vec_type, weights, pairs);
+         }
+
+         /* t zero extended to 16 bits and scaled by 2^7 */
+         tw = lp_build_interleave2(gallivm, i8_type, t, zero, half);
+         tw = LLVMBuildBitCast(builder, tw, i16_vec_type, "");
+         tw = LLVMBuildShl(builder, tw, shift7, "");
+
+         /* (delta * t * 2^7 + 2^14) >> 15, the difference can't overflow */
+         delta = LLVMBuildSub(builder, rows[1], rows[0], "");
+         delta = lp_build_intrinsic_binary(builder,
+                                           "llvm.x86.ssse3.pmul.hr.sw.128",
+                                           i16_vec_type, delta, tw);
+
+         filtered[half] = LLVMBuildAdd(builder, rows[0], delta, "");
+         filtered[half] = LLVMBuildAdd(builder, filtered[half], unbias, "");
+         filtered[half] = LLVMBuildLShr(builder, filtered[half], shift7, "");
+      }
+
+      res[chunk] = lp_build_pack2(gallivm, i16_type, u8_type,
+                                  filtered[0], filtered[1]);
+   }
+
+   if (num_chunks == 1)
+      return res[0];
+
+   return lp_build_concat(gallivm, res, u8_type, num_chunks);
+}
+
+
 /**
  * Fetch texels for image with linear sampling.
  * Return filtered color as two vectors of 16-bit fixed point values.
@@ -713,6 +820,18 @@ lp_build_sample_fetch_image_linear(struct lp_build_sample_context *bld,
                                 &neighbors[0][0][0],
                                 &neighbors[0][0][1],
                                 &packed);
+      } else if (dims == 2 &&
+                 bld->static_sampler_state->reduction_mode ==
+                    PIPE_TEX_REDUCTION_WEIGHTED_AVERAGE &&
+                 util_get_cpu_caps()->has_ssse3 &&
+                 u8n.type.length % 16 == 0 &&
+                 !(gallivm_perf & GALLIVM_PERF_NO_FAST_BILERP)) {
+         packed = lp_build_bilerp_rgba8_ssse3(bld->gallivm, u8n.type,
+                                              s_fpart, t_fpart,
+                                              neighbors[0][0][0],
+                                              neighbors[0][0][1],
+                                              neighbors[0][1][0],
+                                              neighbors[0][1][1]);
       } else if (dims == 2) {
          /* 2-D lerp */
          lp_build_reduce_filter_2d(&u8n,
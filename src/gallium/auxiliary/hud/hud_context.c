@@ -1163,6 +1163,12 @@ has_occlusion_query(struct pipe_screen *screen)
    return screen->get_param(screen, PIPE_CAP_OCCLUSION_QUERY) != 0;
 }
 
+static boolean
+has_time_elapsed_query(struct pipe_screen *screen)
+{
+   return screen->get_param(screen, PIPE_CAP_QUERY_TIME_ELAPSED) != 0;
+}
+
 static boolean
 has_streamout(struct pipe_screen *screen)
 {
@@ -1250,6 +1256,15 @@ hud_parse_env_var(struct hud_context *hud, struct pipe_screen *screen,
       else if (strcmp(name, "frametime") == 0) {
          hud_frametime_graph_install(pane);
       }
+      else if (strcmp(name, "frametime-p50") == 0) {
+         hud_frametime_percentile_graph_install(pane, 50);
+      }
+      else if (strcmp(name, "frametime-p99") == 0) {
+         hud_frametime_percentile_graph_install(pane, 99);
+      }
+      else if (strcmp(name, "frametime-max") == 0) {
+         hud_frametime_percentile_graph_install(pane, 100);
+      }
       else if (strcmp(name, "cpu") == 0) {
          hud_cpu_graph_install(pane, ALL_CPUS);
       }
@@ -1339,6 +1354,15 @@ hud_parse_env_var(struct hud_context *hud, struct pipe_screen *screen,
                                 PIPE_DRIVER_QUERY_RESULT_TYPE_AVERAGE,
                                 0);
       }
+      else if (strcmp(name, "GPU-frametime") == 0 &&
+               has_time_elapsed_query(screen)) {
+         hud_pipe_query_install(&hud->batch_query, pane,
+                                "GPU-frametime",
+                                PIPE_QUERY_TIME_ELAPSED, 0, 0,
+                                PIPE_DRIVER_QUERY_TYPE_MICROSECONDS,
+                                PIPE_DRIVER_QUERY_RESULT_TYPE_AVERAGE,
+                                0);
+      }
       else if (strcmp(name, "primitives-generated") == 0 &&
                has_streamout(screen)) {
          hud_pipe_query_install(&hud->batch_query, pane,
@@ -1562,6 +1586,9 @@ print_help(struct pipe_screen *screen)
    puts("  Available names:");
    puts("    fps");
    puts("    frametime");
+   puts("    frametime-p50");
+   puts("    frametime-p99");
+   puts("    frametime-max");
    puts("    cpu");
 
    for (i = 0; i < num_cpus; i++)
@@ -1569,6 +1596,8 @@ print_help(struct pipe_screen *screen)
 
    if (has_occlusion_query(screen))
       puts("    samples-passed");
+   if (has_time_elapsed_query(screen))
+      puts("    GPU-frametime");
    if (has_streamout(screen))
       puts("    primitives-generated");
 
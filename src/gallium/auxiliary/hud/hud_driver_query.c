@@ -334,6 +334,11 @@ query_new_value(struct hud_graph *gr, struct pipe_context *pipe)
          value /= 1000.0;
       }
 
+      /* time queries return nanoseconds */
+      if (!info->batch && info->query_type == PIPE_QUERY_TIME_ELAPSED) {
+         value /= 1000.0;
+      }
+
       hud_graph_add_value(gr, value);
 
       info->last_time = now;
@@ -28,8 +28,12 @@
 /* This file contains code for calculating framerate for displaying on the HUD.
  */
 
+#include <stdlib.h>
+
 #include "hud/hud_private.h"
 #include "util/os_time.h"
+#include "util/u_dynarray.h"
+#include "util/u_math.h"
 #include "util/u_memory.h"
 
 struct fps_info {
@@ -122,3 +126,93 @@ hud_frametime_graph_install(struct hud_pane *pane)
 
    hud_pane_add_graph(pane, gr);
 }
+
+struct frametime_percentile_info {
+   unsigned percentile;
+   uint64_t last_time;
+   uint64_t period_start;
+   struct util_dynarray frametimes; /* double, in ms */
+};
+
+static int
+compare_frametimes(const void *a, const void *b)
+{
+   double x = *(const double *)a, y = *(const double *)b;
+
+   return x < y ? -1 : x > y;
+}
+
+static void
+query_frametime_percentile(struct hud_graph *gr, struct pipe_context *pipe)
+{
+   struct frametime_percentile_info *info = gr->query_data;
+   uint64_t now = os_time_get();
+
+   if (!info->last_time) {
+      info->last_time = now;
+      info->period_start = now;
+      return;
+   }
+
+   double frametime = ((double)now - (double)info->last_time) / 1000.0;
+   util_dynarray_append(&info->frametimes, double, frametime);
+   info->last_time = now;
+
+   if (info->period_start + gr->pane->period <= now) {
+      double *frametimes = util_dynarray_begin(&info->frametimes);
+      unsigned num = util_dynarray_num_elements(&info->frametimes, double);
+
+      /* nearest-rank percentile of the frames of this period */
+      qsort(frametimes, num, sizeof(double), compare_frametimes);
+      hud_graph_add_value(gr, frametimes[DIV_ROUND_UP(num * info->percentile,
+                                                      100) - 1]);
+
+      util_dynarray_clear(&info->frametimes);
+      info->period_start = now;
+   }
+}
+
+static void
+free_frametime_percentile_info(void *p, struct pipe_context *pipe)
+{
+   struct frametime_percentile_info *info = p;
+
+   util_dynarray_fini(&info->frametimes);
+   FREE(info);
+}
+
+/**
+ * Install a graph of the given percentile (1..100) of the frame times
+ * within each period, 100 being the longest frame.
+ */
+void
+hud_frametime_percentile_graph_install(struct hud_pane *pane,
+                                       unsigned percentile)
+{
+   struct hud_graph *gr = CALLOC_STRUCT(hud_graph);
+
+   assert(percentile >= 1 && percentile <= 100);
+
+   if (!gr)
+      return;
+
+   if (percentile == 100)
+      strcpy(gr->name, "frametime max (ms)");
+   else
+      snprintf(gr->name, sizeof(gr->name), "frametime p%u (ms)", percentile);
+
+   gr->query_data = CALLOC_STRUCT(frametime_percentile_info);
+   if (!gr->query_data) {
+      FREE(gr);
+      return;
+   }
+   struct frametime_percentile_info *info = gr->query_data;
+   info->percentile = percentile;
+   util_dynarray_init(&info->frametimes, NULL);
+
+   gr->query_new_value = query_frametime_percentile;
+
+   gr->free_query_data = free_frametime_percentile_info;
+
+   hud_pane_add_graph(pane, gr);
+}
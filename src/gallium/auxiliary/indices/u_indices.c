@@ -45,18 +45,20 @@ static void translate_memcpy_uint( const void *in,
    memcpy(out, &((int *)in)[start], out_nr*sizeof(int));
 }
 
-static void translate_byte_to_ushort( const void *in,
+static void translate_byte_to_ushort( const void * restrict in,
                                       unsigned start,
                                       UNUSED unsigned in_nr,
                                       unsigned out_nr,
                                       UNUSED unsigned restart_index,
-                                      void *out )
+                                      void * restrict out )
 {
-   uint8_t *src = (uint8_t *)in + start;
-   uint16_t *dst = out;
-   while (out_nr--) {
-      *dst++ = *src++;
-   }
+   /* Plain indexed loop over restrict pointers so the compiler can widen
+    * it with SIMD unpack instructions.
+    */
+   const uint8_t * restrict src = (const uint8_t *)in + start;
+   uint16_t * restrict dst = out;
+   for (unsigned i = 0; i < out_nr; i++)
+      dst[i] = src[i];
 }
 
 /**
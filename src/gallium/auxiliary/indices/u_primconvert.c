@@ -50,13 +50,95 @@
 #include "indices/u_indices.h"
 #include "indices/u_primconvert.h"
 
+#define PRIMCONVERT_CACHE_SIZE 16
+
+/* A translated index buffer, keyed by everything that feeds the
+ * translation.  The source resource is referenced so that its address
+ * can't be recycled while the entry lives.
+ */
+struct primconvert_cache_entry
+{
+   struct pipe_resource *src;
+   unsigned start;
+   unsigned count;
+   unsigned restart_index;
+   uint8_t mode;
+   uint8_t index_size;
+   uint8_t api_pv;
+   bool primitive_restart;
+
+   struct pipe_resource *dst;
+   unsigned dst_start;
+   unsigned dst_count;
+   uint8_t dst_mode;
+   uint8_t dst_index_size;
+   unsigned dst_restart_index;
+
+   unsigned last_use;
+};
+
 struct primconvert_context
 {
    struct pipe_context *pipe;
    struct primconvert_config cfg;
    unsigned api_pv;
+
+   struct primconvert_cache_entry cache[PRIMCONVERT_CACHE_SIZE];
+   unsigned cache_clock;
 };
 
+static void
+cache_entry_release(struct primconvert_cache_entry *entry)
+{
+   pipe_resource_reference(&entry->src, NULL);
+   pipe_resource_reference(&entry->dst, NULL);
+}
+
+static struct primconvert_cache_entry *
+cache_lookup(struct primconvert_context *pc,
+             const struct pipe_draw_info *info,
+             const struct pipe_draw_start_count *draw)
+{
+   for (unsigned i = 0; i < PRIMCONVERT_CACHE_SIZE; i++) {
+      struct primconvert_cache_entry *entry = &pc->cache[i];
+
+      if (entry->src == info->index.resource &&
+          entry->start == draw->start &&
+          entry->count == draw->count &&
+          entry->mode == info->mode &&
+          entry->index_size == info->index_size &&
+          entry->api_pv == pc->api_pv &&
+          entry->primitive_restart == info->primitive_restart &&
+          (!info->primitive_restart ||
+           entry->restart_index == info->restart_index)) {
+         entry->last_use = ++pc->cache_clock;
+         return entry;
+      }
+   }
+
+   return NULL;
+}
+
+static struct primconvert_cache_entry *
+cache_evict(struct primconvert_context *pc)
+{
+   struct primconvert_cache_entry *victim = &pc->cache[0];
+
+   for (unsigned i = 0; i < PRIMCONVERT_CACHE_SIZE; i++) {
+      struct primconvert_cache_entry *entry = &pc->cache[i];
+
+      if (!entry->src) {
+         victim = entry;
+         break;
+      }
+      if (entry->last_use < victim->last_use)
+         victim = entry;
+   }
+
+   cache_entry_release(victim);
+   return victim;
+}
+
 
 struct primconvert_context *
 util_primconvert_create_config(struct pipe_context *pipe,
@@ -80,9 +162,24 @@ util_primconvert_create(struct pipe_context *pipe, uint32_t primtypes_mask)
 void
 util_primconvert_destroy(struct primconvert_context *pc)
 {
+   for (unsigned i = 0; i < PRIMCONVERT_CACHE_SIZE; i++)
+      cache_entry_release(&pc->cache[i]);
    FREE(pc);
 }
 
+void
+util_primconvert_invalidate_resource(struct primconvert_context *pc,
+                                     struct pipe_resource *res)
+{
+   if (!pc->cfg.cache_translations)
+      return;
+
+   for (unsigned i = 0; i < PRIMCONVERT_CACHE_SIZE; i++) {
+      if (pc->cache[i].src == res)
+         cache_entry_release(&pc->cache[i]);
+   }
+}
+
 void
 util_primconvert_save_rasterizer_state(struct primconvert_context *pc,
                                        const struct pipe_rasterizer_state
@@ -103,11 +200,14 @@ util_primconvert_draw_vbo(struct primconvert_context *pc,
    struct pipe_draw_info new_info;
    struct pipe_draw_start_count new_draw;
    struct pipe_transfer *src_transfer = NULL;
+   struct primconvert_cache_entry *entry = NULL;
    u_translate_func trans_func;
    u_generate_func gen_func;
    const void *src = NULL;
    void *dst;
    unsigned ib_offset;
+   bool cacheable = pc->cfg.cache_translations &&
+                    info->index_size && !info->has_user_indices;
 
    util_draw_init_info(&new_info);
    new_info.index_bounds_valid = info->index_bounds_valid;
@@ -118,6 +218,21 @@ util_primconvert_draw_vbo(struct primconvert_context *pc,
    new_info.instance_count = info->instance_count;
    new_info.primitive_restart = info->primitive_restart;
    new_info.restart_index = info->restart_index;
+
+   if (cacheable) {
+      entry = cache_lookup(pc, info, draw);
+      if (entry) {
+         new_info.mode = entry->dst_mode;
+         new_info.index_size = entry->dst_index_size;
+         new_info.restart_index = entry->dst_restart_index;
+         new_info.index.resource = entry->dst;
+         new_draw.start = entry->dst_start;
+         new_draw.count = entry->dst_count;
+         pc->pipe->draw_vbo(pc->pipe, &new_info, NULL, &new_draw, 1);
+         return;
+      }
+   }
+
    if (info->index_size) {
       enum pipe_prim_type mode = 0;
       unsigned index_size;
@@ -174,6 +289,25 @@ util_primconvert_draw_vbo(struct primconvert_context *pc,
 
    u_upload_unmap(pc->pipe->stream_uploader);
 
+   if (cacheable) {
+      entry = cache_evict(pc);
+      pipe_resource_reference(&entry->src, info->index.resource);
+      entry->start = draw->start;
+      entry->count = draw->count;
+      entry->mode = info->mode;
+      entry->index_size = info->index_size;
+      entry->api_pv = pc->api_pv;
+      entry->primitive_restart = info->primitive_restart;
+      entry->restart_index = info->restart_index;
+      pipe_resource_reference(&entry->dst, new_info.index.resource);
+      entry->dst_start = new_draw.start;
+      entry->dst_count = new_draw.count;
+      entry->dst_mode = new_info.mode;
+      entry->dst_index_size = new_info.index_size;
+      entry->dst_restart_index = new_info.restart_index;
+      entry->last_use = ++pc->cache_clock;
+   }
+
    /* to the translated draw: */
    pc->pipe->draw_vbo(pc->pipe, &new_info, NULL, &new_draw, 1);
 
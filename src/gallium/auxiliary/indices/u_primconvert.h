@@ -34,6 +34,12 @@ struct primconvert_context;
 struct primconvert_config {
    uint32_t primtypes_mask;
    bool fixed_prim_restart;
+   /* Keep the translated index buffers of recent draws from non-user index
+    * buffers and reuse them for identical draws.  Drivers enabling this must
+    * call util_primconvert_invalidate_resource() whenever an index buffer
+    * may have been written.
+    */
+   bool cache_translations;
 };
 
 struct primconvert_context *util_primconvert_create(struct pipe_context *pipe,
@@ -42,6 +48,8 @@ struct primconvert_context *util_primconvert_create_config(struct pipe_context *
                                                            struct primconvert_config *cfg);
 
 void util_primconvert_destroy(struct primconvert_context *pc);
+void util_primconvert_invalidate_resource(struct primconvert_context *pc,
+                                          struct pipe_resource *res);
 void util_primconvert_save_rasterizer_state(struct primconvert_context *pc,
                                             const struct pipe_rasterizer_state
                                             *rast);
@@ -45,8 +45,24 @@ struct pb_slab_group
     *
     * Due to a race in new slab allocation, additional slabs in this list
     * can be fully allocated as well.
+    *
+    * Slabs whose entries are all free are only in this list if they are
+    * kept for re-use, see pb_slabs_set_max_empty_slabs.
     */
    struct list_head slabs;
+
+   /* The number of slabs in the list whose entries are all free. */
+   unsigned num_empty_slabs;
+
+   /* List of entries of this group waiting to be reclaimed, i.e. they have
+    * been passed to pb_slab_free, but may not be safe for re-use yet. The
+    * tail points at the most-recently freed entry.
+    *
+    * Keeping these per group means that an allocation only needs to check
+    * the entries it can actually use, and that busy entries of one group
+    * don't hold back the reclaim of idle entries of another.
+    */
+   struct list_head reclaim;
 };
 
 
@@ -66,17 +82,29 @@ pb_slab_reclaim(struct pb_slabs *slabs, struct pb_slab_entry *entry)
    }
 
    if (slab->num_free >= slab->num_entries) {
-      list_del(&slab->head);
-      slabs->slab_free(slabs->priv, slab);
+      struct pb_slab_group *group = &slabs->groups[entry->group_index];
+      unsigned heap = entry->group_index /
+                      (slabs->num_orders * (1 + slabs->allow_three_fourths_allocations));
+
+      /* Keep some empty slabs to avoid re-creating them when buffers of
+       * the same size are freed and allocated repeatedly.
+       */
+      if (group->num_empty_slabs < slabs->max_empty_slabs[heap]) {
+         group->num_empty_slabs++;
+      } else {
+         list_del(&slab->head);
+         slabs->slab_free(slabs->priv, slab);
+      }
    }
 }
 
 static void
-pb_slabs_reclaim_locked(struct pb_slabs *slabs)
+pb_slab_group_reclaim_locked(struct pb_slabs *slabs,
+                             struct pb_slab_group *group)
 {
-   while (!list_is_empty(&slabs->reclaim)) {
+   while (!list_is_empty(&group->reclaim)) {
       struct pb_slab_entry *entry =
-         LIST_ENTRY(struct pb_slab_entry, slabs->reclaim.next, head);
+         LIST_ENTRY(struct pb_slab_entry, group->reclaim.next, head);
 
       if (!slabs->can_reclaim(slabs->priv, entry))
          break;
@@ -85,6 +113,22 @@ pb_slabs_reclaim_locked(struct pb_slabs *slabs)
    }
 }
 
+static unsigned
+pb_slabs_num_groups(struct pb_slabs *slabs)
+{
+   return slabs->num_orders * slabs->num_heaps *
+          (1 + slabs->allow_three_fourths_allocations);
+}
+
+static void
+pb_slabs_reclaim_locked(struct pb_slabs *slabs)
+{
+   unsigned num_groups = pb_slabs_num_groups(slabs);
+
+   for (unsigned i = 0; i < num_groups; ++i)
+      pb_slab_group_reclaim_locked(slabs, &slabs->groups[i]);
+}
+
 /* Allocate a slab entry of the given size from the given heap.
  *
  * This will try to re-use entries that have previously been freed. However,
@@ -123,11 +167,11 @@ pb_slab_alloc(struct pb_slabs *slabs, unsigned size, unsigned heap)
    mtx_lock(&slabs->mutex);
 
    /* If there is no candidate slab at all, or the first slab has no free
-    * entries, try reclaiming entries.
+    * entries, try reclaiming entries of this group.
     */
    if (list_is_empty(&group->slabs) ||
        list_is_empty(&LIST_ENTRY(struct pb_slab, group->slabs.next, head)->free))
-      pb_slabs_reclaim_locked(slabs);
+      pb_slab_group_reclaim_locked(slabs, group);
 
    /* Remove slabs without free entries. */
    while (!list_is_empty(&group->slabs)) {
@@ -139,6 +183,12 @@ pb_slab_alloc(struct pb_slabs *slabs, unsigned size, unsigned heap)
    }
 
    if (list_is_empty(&group->slabs)) {
+      /* A new slab is needed, which is comparatively rare. Reclaim the other
+       * groups as well, so that their slabs are released once all their
+       * entries are idle, even if no more allocations of their size happen.
+       */
+      pb_slabs_reclaim_locked(slabs);
+
       /* Drop the mutex temporarily to prevent a deadlock where the allocation
        * calls back into slab functions (most likely to happen for
        * pb_slab_reclaim if memory is low).
@@ -153,6 +203,10 @@ pb_slab_alloc(struct pb_slabs *slabs, unsigned size, unsigned heap)
       mtx_lock(&slabs->mutex);
 
       list_add(&slab->head, &group->slabs);
+   } else if (slab->num_free == slab->num_entries) {
+      /* Re-use a kept empty slab. */
+      assert(group->num_empty_slabs);
+      group->num_empty_slabs--;
    }
 
    entry = LIST_ENTRY(struct pb_slab_entry, slab->free.next, head);
@@ -174,7 +228,35 @@ void
 pb_slab_free(struct pb_slabs* slabs, struct pb_slab_entry *entry)
 {
    mtx_lock(&slabs->mutex);
-   list_addtail(&entry->head, &slabs->reclaim);
+   list_addtail(&entry->head, &slabs->groups[entry->group_index].reclaim);
+   mtx_unlock(&slabs->mutex);
+}
+
+/* Free the empty slabs that were kept for re-use. */
+static void
+pb_slabs_free_empty_locked(struct pb_slabs *slabs)
+{
+   unsigned num_groups = pb_slabs_num_groups(slabs);
+
+   for (unsigned i = 0; i < num_groups; ++i) {
+      struct pb_slab_group *group = &slabs->groups[i];
+
+      list_for_each_entry_safe(struct pb_slab, slab, &group->slabs, head) {
+         if (slab->num_free >= slab->num_entries) {
+            list_del(&slab->head);
+            slabs->slab_free(slabs->priv, slab);
+         }
+      }
+      group->num_empty_slabs = 0;
+   }
+}
+
+void
+pb_slabs_free_empty(struct pb_slabs *slabs)
+{
+   mtx_lock(&slabs->mutex);
+   pb_slabs_reclaim_locked(slabs);
+   pb_slabs_free_empty_locked(slabs);
    mtx_unlock(&slabs->mutex);
 }
 
@@ -224,17 +306,21 @@ pb_slabs_init(struct pb_slabs *slabs,
    slabs->slab_alloc = slab_alloc;
    slabs->slab_free = slab_free;
 
-   list_inithead(&slabs->reclaim);
+   slabs->max_empty_slabs = CALLOC(num_heaps, sizeof(*slabs->max_empty_slabs));
+   if (!slabs->max_empty_slabs)
+      return false;
 
-   num_groups = slabs->num_orders * slabs->num_heaps *
-                (1 + allow_three_fourth_allocations);
+   num_groups = pb_slabs_num_groups(slabs);
    slabs->groups = CALLOC(num_groups, sizeof(*slabs->groups));
-   if (!slabs->groups)
+   if (!slabs->groups) {
+      FREE(slabs->max_empty_slabs);
       return false;
+   }
 
    for (i = 0; i < num_groups; ++i) {
       struct pb_slab_group *group = &slabs->groups[i];
       list_inithead(&group->slabs);
+      list_inithead(&group->reclaim);
    }
 
    (void) mtx_init(&slabs->mutex, mtx_plain);
@@ -254,12 +340,36 @@ pb_slabs_deinit(struct pb_slabs *slabs)
    /* Reclaim all slab entries (even those that are still in flight). This
     * implicitly calls slab_free for everything.
     */
-   while (!list_is_empty(&slabs->reclaim)) {
-      struct pb_slab_entry *entry =
-         LIST_ENTRY(struct pb_slab_entry, slabs->reclaim.next, head);
-      pb_slab_reclaim(slabs, entry);
+   unsigned num_groups = pb_slabs_num_groups(slabs);
+
+   for (unsigned i = 0; i < num_groups; ++i) {
+      struct pb_slab_group *group = &slabs->groups[i];
+
+      while (!list_is_empty(&group->reclaim)) {
+         struct pb_slab_entry *entry =
+            LIST_ENTRY(struct pb_slab_entry, group->reclaim.next, head);
+         pb_slab_reclaim(slabs, entry);
+      }
    }
 
+   pb_slabs_free_empty_locked(slabs);
+
+   FREE(slabs->max_empty_slabs);
    FREE(slabs->groups);
    mtx_destroy(&slabs->mutex);
 }
+
+/* Set how many slabs with only free entries are kept for re-use in each
+ * group of the given heap, instead of being passed to slab_free. The default
+ * is 0.
+ */
+void
+pb_slabs_set_max_empty_slabs(struct pb_slabs *slabs, unsigned heap,
+                             unsigned max_empty_slabs)
+{
+   assert(heap < slabs->num_heaps);
+
+   mtx_lock(&slabs->mutex);
+   slabs->max_empty_slabs[heap] = max_empty_slabs;
+   mtx_unlock(&slabs->mutex);
+}
@@ -121,11 +121,8 @@ struct pb_slabs
    /* One group per (heap, order, three_fourth_allocations). */
    struct pb_slab_group *groups;
 
-   /* List of entries waiting to be reclaimed, i.e. they have been passed to
-    * pb_slab_free, but may not be safe for re-use yet. The tail points at
-    * the most-recently freed entry.
-    */
-   struct list_head reclaim;
+   /* The number of empty slabs kept in each group of a heap. */
+   unsigned *max_empty_slabs;
 
    void *priv;
    slab_can_reclaim_fn *can_reclaim;
@@ -142,6 +139,9 @@ pb_slab_free(struct pb_slabs* slabs, struct pb_slab_entry *entry);
 void
 pb_slabs_reclaim(struct pb_slabs *slabs);
 
+void
+pb_slabs_free_empty(struct pb_slabs *slabs);
+
 bool
 pb_slabs_init(struct pb_slabs *slabs,
               unsigned min_order, unsigned max_order,
@@ -154,4 +154,8 @@ pb_slabs_init(struct pb_slabs *slabs,
 void
 pb_slabs_deinit(struct pb_slabs *slabs);
 
+void
+pb_slabs_set_max_empty_slabs(struct pb_slabs *slabs, unsigned heap,
+                             unsigned max_empty_slabs);
+
 #endif
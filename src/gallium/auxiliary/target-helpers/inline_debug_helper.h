@@ -34,6 +34,8 @@ debug_screen_wrap(struct pipe_screen *screen)
 
    if (debug_get_bool_option("GALLIUM_TESTS", FALSE))
       util_run_tests(screen);
+   if (debug_get_bool_option("GALLIUM_BENCHMARKS", FALSE))
+      util_run_benchmarks(screen);
 
    return screen;
 }
@@ -30,6 +30,7 @@
 #include "tessellator.hpp"
 
 #include <new>
+#include <string.h>
 
 namespace pipe_tessellator_wrap
 {
@@ -44,6 +45,14 @@ namespace pipe_tessellator_wrap
       PIPE_ALIGN_VAR(32) float     domain_points_v[MAX_POINT_COUNT];
       uint32_t               num_domain_points;
 
+      /* Factors of the last tessellated patch.  The reference tessellator
+       * is a pure function of the factors, so neighbouring patches sharing
+       * them (the common case for uniformly tessellated meshes) can reuse
+       * the previous points and indices as they are.
+       */
+      struct pipe_tessellation_factors last_factors;
+      bool                   last_valid;
+
    public:
       void Init(enum pipe_prim_type tes_prim_mode,
                 enum pipe_tess_spacing ts_spacing,
@@ -70,11 +79,21 @@ namespace pipe_tessellator_wrap
 
          prim_mode          = tes_prim_mode;
          num_domain_points = 0;
+         last_valid = false;
       }
 
       void Tessellate(const struct pipe_tessellation_factors *tess_factors,
                       struct pipe_tessellator_data *tess_data)
       {
+         if (last_valid &&
+             memcmp(last_factors.outer_tf, tess_factors->outer_tf,
+                    sizeof(last_factors.outer_tf)) == 0 &&
+             memcmp(last_factors.inner_tf, tess_factors->inner_tf,
+                    sizeof(last_factors.inner_tf)) == 0) {
+            FillData(tess_data);
+            return;
+         }
+
          switch (prim_mode)
             {
             case PIPE_PRIM_QUADS:
@@ -113,6 +132,19 @@ namespace pipe_tessellator_wrap
             domain_points_u[i] = points[i].u;
             domain_points_v[i] = points[i].v;
          }
+
+         memcpy(last_factors.outer_tf, tess_factors->outer_tf,
+                sizeof(last_factors.outer_tf));
+         memcpy(last_factors.inner_tf, tess_factors->inner_tf,
+                sizeof(last_factors.inner_tf));
+         last_valid = true;
+
+         FillData(tess_data);
+      }
+
+   private:
+      void FillData(struct pipe_tessellator_data *tess_data)
+      {
          tess_data->num_domain_points = num_domain_points;
          tess_data->domain_points_u = &domain_points_u[0];
          tess_data->domain_points_v = &domain_points_v[0];
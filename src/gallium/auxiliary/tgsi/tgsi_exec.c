@@ -1051,6 +1051,9 @@ tgsi_exec_set_constant_buffers(struct tgsi_exec_machine *mach,
    }
 }
 
+static void
+decode_instructions(struct tgsi_exec_machine *mach);
+
 /**
  * Initialize machine state by expanding tokens to full instructions,
  * allocating temporary storage, setting up constants, etc.
@@ -1093,6 +1096,9 @@ tgsi_exec_machine_bind_shader(
       mach->Instructions = NULL;
       mach->NumInstructions = 0;
 
+      FREE(mach->DecodedInstructions);
+      mach->DecodedInstructions = NULL;
+
       return;
    }
 
@@ -1243,6 +1249,8 @@ tgsi_exec_machine_bind_shader(
    FREE(mach->Instructions);
    mach->Instructions = instructions;
    mach->NumInstructions = numInstructions;
+
+   decode_instructions(mach);
 }
 
 
@@ -1296,6 +1304,7 @@ tgsi_exec_machine_destroy(struct tgsi_exec_machine *mach)
 {
    if (mach) {
       FREE(mach->Instructions);
+      FREE(mach->DecodedInstructions);
       FREE(mach->Declarations);
       FREE(mach->Imms);
 
@@ -5122,6 +5131,531 @@ exec_interp_at_centroid(struct tgsi_exec_machine *mach,
 }
 
 
+/*
+ * Pre-decoded instructions.
+ *
+ * Most of the time of exec_instruction() goes into decoding the operands
+ * of simple ALU instructions: switching on the opcode, the register files
+ * and the swizzles, again for every channel of every execution.  When a
+ * shader is bound, the ALU instructions that only access directly
+ * addressed registers are translated to a handler function plus pointers
+ * to the registers they read and write, so running them involves no
+ * decoding at all.  Everything else still goes through exec_instruction().
+ */
+
+struct tgsi_exec_decoded_instruction;
+
+typedef void (*exec_decoded_func)(struct tgsi_exec_machine *mach,
+                                  const struct tgsi_exec_decoded_instruction *dinst);
+
+struct exec_decoded_src
+{
+   /** Channel read for each channel, NULL when reading a constant */
+   const union tgsi_exec_channel *chan[TGSI_NUM_CHANNELS];
+
+   /** Constant buffer and dword read for each channel */
+   unsigned const_buf;
+   int const_pos[TGSI_NUM_CHANNELS];
+
+   boolean absolute;
+   boolean negate;
+
+   /** Immediates, replicated to all the lanes */
+   union tgsi_exec_channel imm[TGSI_NUM_CHANNELS];
+};
+
+struct tgsi_exec_decoded_instruction
+{
+   /** NULL for instructions which need exec_instruction() */
+   exec_decoded_func func;
+
+   union {
+      micro_unary_op unary;
+      micro_binary_op binary;
+      micro_trinary_op trinary;
+   } op;
+   enum tgsi_exec_datatype src_datatype;
+
+   unsigned num_chans;   /**< dot products */
+   unsigned write_mask;
+   boolean saturate;
+   union tgsi_exec_channel *dst[TGSI_NUM_CHANNELS];
+
+   struct exec_decoded_src src[3];
+};
+
+
+struct exec_alu_info
+{
+   unsigned num_src;
+   enum tgsi_exec_datatype dst_datatype;
+   enum tgsi_exec_datatype src_datatype;
+   union {
+      micro_unary_op unary;
+      micro_binary_op binary;
+      micro_trinary_op trinary;
+   } op;
+};
+
+#define ALU1(OP, DST, SRC) \
+   { 1, TGSI_EXEC_DATA_##DST, TGSI_EXEC_DATA_##SRC, { .unary = OP } }
+#define ALU2(OP, DST, SRC) \
+   { 2, TGSI_EXEC_DATA_##DST, TGSI_EXEC_DATA_##SRC, { .binary = OP } }
+#define ALU3(OP, DST, SRC) \
+   { 3, TGSI_EXEC_DATA_##DST, TGSI_EXEC_DATA_##SRC, { .trinary = OP } }
+
+/**
+ * The instructions exec_instruction() runs with exec_vector_unary(),
+ * exec_vector_binary() or exec_vector_trinary(), which must match.
+ */
+static const struct exec_alu_info exec_alu_ops[TGSI_OPCODE_LAST] = {
+   [TGSI_OPCODE_ARL] = ALU1(micro_arl, INT, FLOAT),
+   [TGSI_OPCODE_MOV] = ALU1(micro_mov, UINT, FLOAT),
+   [TGSI_OPCODE_MUL] = ALU2(micro_mul, FLOAT, FLOAT),
+   [TGSI_OPCODE_ADD] = ALU2(micro_add, FLOAT, FLOAT),
+   [TGSI_OPCODE_MIN] = ALU2(micro_min, FLOAT, FLOAT),
+   [TGSI_OPCODE_MAX] = ALU2(micro_max, FLOAT, FLOAT),
+   [TGSI_OPCODE_SLT] = ALU2(micro_slt, FLOAT, FLOAT),
+   [TGSI_OPCODE_SGE] = ALU2(micro_sge, FLOAT, FLOAT),
+   [TGSI_OPCODE_MAD] = ALU3(micro_mad, FLOAT, FLOAT),
+   [TGSI_OPCODE_LRP] = ALU3(micro_lrp, FLOAT, FLOAT),
+   [TGSI_OPCODE_FRC] = ALU1(micro_frc, FLOAT, FLOAT),
+   [TGSI_OPCODE_FLR] = ALU1(micro_flr, FLOAT, FLOAT),
+   [TGSI_OPCODE_ROUND] = ALU1(micro_rnd, FLOAT, FLOAT),
+   [TGSI_OPCODE_SEQ] = ALU2(micro_seq, FLOAT, FLOAT),
+   [TGSI_OPCODE_SGT] = ALU2(micro_sgt, FLOAT, FLOAT),
+   [TGSI_OPCODE_SLE] = ALU2(micro_sle, FLOAT, FLOAT),
+   [TGSI_OPCODE_SNE] = ALU2(micro_sne, FLOAT, FLOAT),
+   [TGSI_OPCODE_SSG] = ALU1(micro_sgn, FLOAT, FLOAT),
+   [TGSI_OPCODE_CMP] = ALU3(micro_cmp, FLOAT, FLOAT),
+   [TGSI_OPCODE_DIV] = ALU2(micro_div, FLOAT, FLOAT),
+   [TGSI_OPCODE_CEIL] = ALU1(micro_ceil, FLOAT, FLOAT),
+   [TGSI_OPCODE_I2F] = ALU1(micro_i2f, FLOAT, INT),
+   [TGSI_OPCODE_NOT] = ALU1(micro_not, UINT, UINT),
+   [TGSI_OPCODE_TRUNC] = ALU1(micro_trunc, FLOAT, FLOAT),
+   [TGSI_OPCODE_SHL] = ALU2(micro_shl, UINT, UINT),
+   [TGSI_OPCODE_AND] = ALU2(micro_and, UINT, UINT),
+   [TGSI_OPCODE_OR] = ALU2(micro_or, UINT, UINT),
+   [TGSI_OPCODE_XOR] = ALU2(micro_xor, UINT, UINT),
+   [TGSI_OPCODE_F2I] = ALU1(micro_f2i, INT, FLOAT),
+   [TGSI_OPCODE_FSEQ] = ALU2(micro_fseq, UINT, FLOAT),
+   [TGSI_OPCODE_FSGE] = ALU2(micro_fsge, UINT, FLOAT),
+   [TGSI_OPCODE_FSLT] = ALU2(micro_fslt, UINT, FLOAT),
+   [TGSI_OPCODE_FSNE] = ALU2(micro_fsne, UINT, FLOAT),
+   [TGSI_OPCODE_IMAX] = ALU2(micro_imax, INT, INT),
+   [TGSI_OPCODE_IMIN] = ALU2(micro_imin, INT, INT),
+   [TGSI_OPCODE_INEG] = ALU1(micro_ineg, INT, INT),
+   [TGSI_OPCODE_ISGE] = ALU2(micro_isge, INT, INT),
+   [TGSI_OPCODE_ISHR] = ALU2(micro_ishr, INT, INT),
+   [TGSI_OPCODE_ISLT] = ALU2(micro_islt, INT, INT),
+   [TGSI_OPCODE_F2U] = ALU1(micro_f2u, UINT, FLOAT),
+   [TGSI_OPCODE_U2F] = ALU1(micro_u2f, FLOAT, UINT),
+   [TGSI_OPCODE_UADD] = ALU2(micro_uadd, INT, INT),
+   [TGSI_OPCODE_UMAD] = ALU3(micro_umad, UINT, UINT),
+   [TGSI_OPCODE_UMAX] = ALU2(micro_umax, UINT, UINT),
+   [TGSI_OPCODE_UMIN] = ALU2(micro_umin, UINT, UINT),
+   [TGSI_OPCODE_UMUL] = ALU2(micro_umul, UINT, UINT),
+   [TGSI_OPCODE_USEQ] = ALU2(micro_useq, UINT, UINT),
+   [TGSI_OPCODE_USGE] = ALU2(micro_usge, UINT, UINT),
+   [TGSI_OPCODE_USHR] = ALU2(micro_ushr, UINT, UINT),
+   [TGSI_OPCODE_USLT] = ALU2(micro_uslt, UINT, UINT),
+   [TGSI_OPCODE_USNE] = ALU2(micro_usne, UINT, UINT),
+   [TGSI_OPCODE_UARL] = ALU1(micro_uarl, INT, UINT),
+   [TGSI_OPCODE_IABS] = ALU1(micro_iabs, INT, INT),
+   [TGSI_OPCODE_ISSG] = ALU1(micro_isgn, INT, INT),
+   [TGSI_OPCODE_LDEXP] = ALU2(micro_ldexp, FLOAT, FLOAT),
+   [TGSI_OPCODE_DDX_FINE] = ALU1(micro_ddx_fine, FLOAT, FLOAT),
+   [TGSI_OPCODE_DDX] = ALU1(micro_ddx, FLOAT, FLOAT),
+   [TGSI_OPCODE_DDY_FINE] = ALU1(micro_ddy_fine, FLOAT, FLOAT),
+   [TGSI_OPCODE_DDY] = ALU1(micro_ddy, FLOAT, FLOAT),
+   [TGSI_OPCODE_ARR] = ALU1(micro_arr, INT, FLOAT),
+   [TGSI_OPCODE_MOD] = ALU2(micro_mod, INT, INT),
+   [TGSI_OPCODE_IDIV] = ALU2(micro_idiv, INT, INT),
+   [TGSI_OPCODE_UDIV] = ALU2(micro_udiv, UINT, UINT),
+   [TGSI_OPCODE_UMOD] = ALU2(micro_umod, UINT, UINT),
+   [TGSI_OPCODE_IMUL_HI] = ALU2(micro_imul_hi, INT, INT),
+   [TGSI_OPCODE_UMUL_HI] = ALU2(micro_umul_hi, UINT, UINT),
+   [TGSI_OPCODE_IBFE] = ALU3(micro_ibfe, INT, INT),
+   [TGSI_OPCODE_UBFE] = ALU3(micro_ubfe, UINT, UINT),
+   [TGSI_OPCODE_BREV] = ALU1(micro_brev, UINT, UINT),
+   [TGSI_OPCODE_POPC] = ALU1(micro_popc, UINT, UINT),
+   [TGSI_OPCODE_LSB] = ALU1(micro_lsb, INT, UINT),
+   [TGSI_OPCODE_IMSB] = ALU1(micro_imsb, INT, INT),
+   [TGSI_OPCODE_UMSB] = ALU1(micro_umsb, INT, UINT),
+};
+
+#undef ALU1
+#undef ALU2
+#undef ALU3
+
+
+/**
+ * Return the channel to read from a decoded source register, applying the
+ * modifiers into tmp if needed.
+ */
+static inline const union tgsi_exec_channel *
+fetch_decoded(const struct tgsi_exec_machine *mach,
+              const struct exec_decoded_src *src,
+              enum tgsi_exec_datatype src_datatype,
+              unsigned chan,
+              union tgsi_exec_channel *tmp)
+{
+   const union tgsi_exec_channel *val = src->chan[chan];
+
+   if (!val) {
+      const int pos = src->const_pos[chan];
+      const uint *buf = (const uint *)mach->Consts[src->const_buf];
+      const uint v =
+         pos < (int) mach->ConstsSize[src->const_buf] / 4 ? buf[pos] : 0;
+
+      tmp->u[0] = tmp->u[1] = tmp->u[2] = tmp->u[3] = v;
+      val = tmp;
+   }
+
+   if (src->absolute) {
+      micro_abs(tmp, val);
+      val = tmp;
+   }
+
+   if (src->negate) {
+      if (src_datatype == TGSI_EXEC_DATA_FLOAT)
+         micro_neg(tmp, val);
+      else
+         micro_ineg(tmp, val);
+      val = tmp;
+   }
+
+   return val;
+}
+
+
+static inline void
+store_decoded(const struct tgsi_exec_machine *mach,
+              const struct tgsi_exec_decoded_instruction *dinst,
+              const struct tgsi_exec_vector *result)
+{
+   const uint execmask = mach->ExecMask;
+   unsigned chan, i;
+
+   for (chan = 0; chan < TGSI_NUM_CHANNELS; chan++) {
+      const union tgsi_exec_channel *val = &result->xyzw[chan];
+      union tgsi_exec_channel *dst = dinst->dst[chan];
+
+      if (!(dinst->write_mask & (1 << chan)))
+         continue;
+
+      if (!dinst->saturate) {
+         for (i = 0; i < TGSI_QUAD_SIZE; i++)
+            if (execmask & (1 << i))
+               dst->i[i] = val->i[i];
+      }
+      else {
+         for (i = 0; i < TGSI_QUAD_SIZE; i++)
+            if (execmask & (1 << i)) {
+               if (val->f[i] < 0.0f)
+                  dst->f[i] = 0.0f;
+               else if (val->f[i] > 1.0f)
+                  dst->f[i] = 1.0f;
+               else
+                  dst->i[i] = val->i[i];
+            }
+      }
+   }
+}
+
+
+static void
+exec_decoded_unary(struct tgsi_exec_machine *mach,
+                   const struct tgsi_exec_decoded_instruction *dinst)
+{
+   struct tgsi_exec_vector dst;
+   unsigned chan;
+
+   for (chan = 0; chan < TGSI_NUM_CHANNELS; chan++) {
+      if (dinst->write_mask & (1 << chan)) {
+         union tgsi_exec_channel tmp;
+
+         dinst->op.unary(&dst.xyzw[chan],
+                         fetch_decoded(mach, &dinst->src[0],
+                                       dinst->src_datatype, chan, &tmp));
+      }
+   }
+   store_decoded(mach, dinst, &dst);
+}
+
+
+static void
+exec_decoded_binary(struct tgsi_exec_machine *mach,
+                    const struct tgsi_exec_decoded_instruction *dinst)
+{
+   struct tgsi_exec_vector dst;
+   unsigned chan;
+
+   for (chan = 0; chan < TGSI_NUM_CHANNELS; chan++) {
+      if (dinst->write_mask & (1 << chan)) {
+         union tgsi_exec_channel tmp[2];
+
+         dinst->op.binary(&dst.xyzw[chan],
+                          fetch_decoded(mach, &dinst->src[0],
+                                        dinst->src_datatype, chan, &tmp[0]),
+                          fetch_decoded(mach, &dinst->src[1],
+                                        dinst->src_datatype, chan, &tmp[1]));
+      }
+   }
+   store_decoded(mach, dinst, &dst);
+}
+
+
+static void
+exec_decoded_trinary(struct tgsi_exec_machine *mach,
+                     const struct tgsi_exec_decoded_instruction *dinst)
+{
+   struct tgsi_exec_vector dst;
+   unsigned chan;
+
+   for (chan = 0; chan < TGSI_NUM_CHANNELS; chan++) {
+      if (dinst->write_mask & (1 << chan)) {
+         union tgsi_exec_channel tmp[3];
+
+         dinst->op.trinary(&dst.xyzw[chan],
+                           fetch_decoded(mach, &dinst->src[0],
+                                         dinst->src_datatype, chan, &tmp[0]),
+                           fetch_decoded(mach, &dinst->src[1],
+                                         dinst->src_datatype, chan, &tmp[1]),
+                           fetch_decoded(mach, &dinst->src[2],
+                                         dinst->src_datatype, chan, &tmp[2]));
+      }
+   }
+   store_decoded(mach, dinst, &dst);
+}
+
+
+/** DP2, DP3 and DP4, same as exec_dp4() and friends */
+static void
+exec_decoded_dp(struct tgsi_exec_machine *mach,
+                const struct tgsi_exec_decoded_instruction *dinst)
+{
+   struct tgsi_exec_vector dst;
+   union tgsi_exec_channel tmp[2];
+   unsigned chan;
+
+   micro_mul(&dst.xyzw[0],
+             fetch_decoded(mach, &dinst->src[0], TGSI_EXEC_DATA_FLOAT,
+                           TGSI_CHAN_X, &tmp[0]),
+             fetch_decoded(mach, &dinst->src[1], TGSI_EXEC_DATA_FLOAT,
+                           TGSI_CHAN_X, &tmp[1]));
+
+   for (chan = TGSI_CHAN_Y; chan < dinst->num_chans; chan++) {
+      micro_mad(&dst.xyzw[0],
+                fetch_decoded(mach, &dinst->src[0], TGSI_EXEC_DATA_FLOAT,
+                              chan, &tmp[0]),
+                fetch_decoded(mach, &dinst->src[1], TGSI_EXEC_DATA_FLOAT,
+                              chan, &tmp[1]),
+                &dst.xyzw[0]);
+   }
+
+   dst.xyzw[1] = dst.xyzw[2] = dst.xyzw[3] = dst.xyzw[0];
+   store_decoded(mach, dinst, &dst);
+}
+
+
+/**
+ * Resolve a source register, return FALSE if it needs the generic path.
+ */
+static boolean
+decode_src(const struct tgsi_exec_machine *mach,
+           const struct tgsi_full_src_register *reg,
+           struct exec_decoded_src *src)
+{
+   const int index = reg->Register.Index;
+   unsigned chan;
+
+   if (reg->Register.Indirect ||
+       (reg->Register.Dimension &&
+        (reg->Register.File != TGSI_FILE_CONSTANT ||
+         reg->Dimension.Indirect)))
+      return FALSE;
+
+   src->absolute = reg->Register.Absolute;
+   src->negate = reg->Register.Negate;
+
+   for (chan = 0; chan < TGSI_NUM_CHANNELS; chan++) {
+      const uint swizzle = tgsi_util_get_full_src_register_swizzle(reg, chan);
+
+      switch (reg->Register.File) {
+      case TGSI_FILE_CONSTANT:
+         src->const_buf = reg->Register.Dimension ? reg->Dimension.Index : 0;
+         if (src->const_buf >= PIPE_MAX_CONSTANT_BUFFERS)
+            return FALSE;
+         src->const_pos[chan] = index * 4 + swizzle;
+         src->chan[chan] = NULL;
+         break;
+      case TGSI_FILE_INPUT:
+         if (!mach->Inputs || index >= PIPE_MAX_SHADER_INPUTS)
+            return FALSE;
+         src->chan[chan] = &mach->Inputs[index].xyzw[swizzle];
+         break;
+      case TGSI_FILE_SYSTEM_VALUE:
+         if (index >= TGSI_MAX_MISC_INPUTS)
+            return FALSE;
+         src->chan[chan] = &mach->SystemValue[index].xyzw[swizzle];
+         break;
+      case TGSI_FILE_TEMPORARY:
+         if (index >= TGSI_EXEC_NUM_TEMPS)
+            return FALSE;
+         src->chan[chan] = &mach->Temps[index].xyzw[swizzle];
+         break;
+      case TGSI_FILE_IMMEDIATE:
+         if (index >= (int) mach->ImmLimit)
+            return FALSE;
+         src->imm[chan].f[0] =
+         src->imm[chan].f[1] =
+         src->imm[chan].f[2] =
+         src->imm[chan].f[3] = mach->Imms[index][swizzle];
+         src->chan[chan] = &src->imm[chan];
+         break;
+      case TGSI_FILE_ADDRESS:
+         if (index >= ARRAY_SIZE(mach->Addrs))
+            return FALSE;
+         src->chan[chan] = &mach->Addrs[index].xyzw[swizzle];
+         break;
+      case TGSI_FILE_OUTPUT:
+         if (!mach->Outputs || index >= PIPE_MAX_SHADER_OUTPUTS)
+            return FALSE;
+         src->chan[chan] = &mach->Outputs[index].xyzw[swizzle];
+         break;
+      default:
+         return FALSE;
+      }
+   }
+
+   return TRUE;
+}
+
+
+/**
+ * Resolve the destination register, return FALSE if it needs the generic
+ * path.
+ */
+static boolean
+decode_dst(struct tgsi_exec_machine *mach,
+           const struct tgsi_full_dst_register *reg,
+           struct tgsi_exec_decoded_instruction *dinst)
+{
+   const int index = reg->Register.Index;
+   struct tgsi_exec_vector *vec;
+   unsigned chan;
+
+   if (reg->Register.Indirect || reg->Register.Dimension)
+      return FALSE;
+
+   switch (reg->Register.File) {
+   case TGSI_FILE_TEMPORARY:
+      if (index >= TGSI_EXEC_NUM_TEMPS)
+         return FALSE;
+      vec = &mach->Temps[index];
+      break;
+   case TGSI_FILE_ADDRESS:
+      if (index >= ARRAY_SIZE(mach->Addrs))
+         return FALSE;
+      vec = &mach->Addrs[index];
+      break;
+   case TGSI_FILE_OUTPUT:
+      /* geometry shaders emit vertices at a varying offset */
+      if (!mach->Outputs || index >= PIPE_MAX_SHADER_OUTPUTS ||
+          mach->ShaderType == PIPE_SHADER_GEOMETRY)
+         return FALSE;
+      vec = &mach->Outputs[index];
+      break;
+   default:
+      return FALSE;
+   }
+
+   for (chan = 0; chan < TGSI_NUM_CHANNELS; chan++)
+      dinst->dst[chan] = &vec->xyzw[chan];
+
+   return TRUE;
+}
+
+
+static void
+decode_instruction(struct tgsi_exec_machine *mach,
+                   const struct tgsi_full_instruction *inst,
+                   struct tgsi_exec_decoded_instruction *dinst)
+{
+   const unsigned opcode = inst->Instruction.Opcode;
+   exec_decoded_func func = NULL;
+   unsigned num_src = 0, i;
+
+   memset(dinst, 0, sizeof(*dinst));
+
+   if (inst->Instruction.NumDstRegs != 1 ||
+       !decode_dst(mach, &inst->Dst[0], dinst))
+      return;
+
+   switch (opcode) {
+   case TGSI_OPCODE_DP2:
+   case TGSI_OPCODE_DP3:
+   case TGSI_OPCODE_DP4:
+      func = exec_decoded_dp;
+      num_src = 2;
+      dinst->num_chans = opcode == TGSI_OPCODE_DP2 ? 2 :
+                         opcode == TGSI_OPCODE_DP3 ? 3 : 4;
+      dinst->src_datatype = TGSI_EXEC_DATA_FLOAT;
+      break;
+   default:
+      if (opcode >= TGSI_OPCODE_LAST || !exec_alu_ops[opcode].num_src)
+         return;
+      num_src = exec_alu_ops[opcode].num_src;
+      func = num_src == 1 ? exec_decoded_unary :
+             num_src == 2 ? exec_decoded_binary : exec_decoded_trinary;
+      dinst->op.binary = exec_alu_ops[opcode].op.binary;
+      dinst->src_datatype = exec_alu_ops[opcode].src_datatype;
+      break;
+   }
+
+   if (inst->Instruction.NumSrcRegs != num_src)
+      return;
+
+   for (i = 0; i < num_src; i++) {
+      if (!decode_src(mach, &inst->Src[i], &dinst->src[i]))
+         return;
+   }
+
+   dinst->write_mask = inst->Dst[0].Register.WriteMask;
+   dinst->saturate = inst->Instruction.Saturate;
+   dinst->func = func;
+}
+
+
+/**
+ * Decode the instructions of the bound shader, see
+ * tgsi_exec_decoded_instruction.  If this fails every instruction is run
+ * through exec_instruction().
+ */
+static void
+decode_instructions(struct tgsi_exec_machine *mach)
+{
+   uint i;
+
+   FREE(mach->DecodedInstructions);
+   mach->DecodedInstructions = NULL;
+
+   if (!mach->NumInstructions)
+      return;
+
+   mach->DecodedInstructions =
+      MALLOC(mach->NumInstructions *
+             sizeof(struct tgsi_exec_decoded_instruction));
+   if (!mach->DecodedInstructions)
+      return;
+
+   for (i = 0; i < mach->NumInstructions; i++)
+      decode_instruction(mach, &mach->Instructions[i],
+                         &mach->DecodedInstructions[i]);
+}
+
+
 /**
  * Execute a TGSI instruction.
  * Returns TRUE if a barrier instruction is hit,
@@ -6262,7 +6796,17 @@ tgsi_exec_machine_run( struct tgsi_exec_machine *mach, int start_pc )
 #endif
 
          assert(mach->pc < (int) mach->NumInstructions);
-         barrier_hit = exec_instruction(mach, mach->Instructions + mach->pc, &mach->pc);
+         if (mach->DecodedInstructions &&
+             mach->DecodedInstructions[mach->pc].func) {
+            const struct tgsi_exec_decoded_instruction *dinst =
+               &mach->DecodedInstructions[mach->pc++];
+
+            dinst->func(mach, dinst);
+            barrier_hit = FALSE;
+         }
+         else {
+            barrier_hit = exec_instruction(mach, mach->Instructions + mach->pc, &mach->pc);
+         }
 
          /* for compute shaders if we hit a barrier return now for later rescheduling */
          if (barrier_hit && mach->ShaderType == PIPE_SHADER_COMPUTE)
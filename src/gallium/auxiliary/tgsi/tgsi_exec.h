@@ -274,6 +274,7 @@ enum tgsi_break_type {
 typedef float float4[4];
 
 struct tgsi_exec_machine;
+struct tgsi_exec_decoded_instruction;
 
 typedef void (* apply_sample_offset_func)(
    const struct tgsi_exec_machine *mach,
@@ -389,6 +390,9 @@ struct tgsi_exec_machine
    struct tgsi_full_instruction *Instructions;
    uint NumInstructions;
 
+   /** Instructions resolved to a handler and register pointers, see tgsi_exec.c */
+   struct tgsi_exec_decoded_instruction *DecodedInstructions;
+
    struct tgsi_full_declaration *Declarations;
    uint NumDeclarations;
 
@@ -74,9 +74,19 @@ struct translate_generic {
        */
       int copy_size;
 
+      /* set if output_format is 4x32 bits, which is what fetch produces:
+       * in this case, fetch writes to the output vertex directly
+       */
+      boolean fetch_to_output;
+
    } attrib[TRANSLATE_MAX_ATTRIBS];
 
    unsigned nr_attrib;
+
+   /* per-vertex attributes with fetch_to_output set, converted for all
+    * the vertices of a linear run with a single fetch call
+    */
+   uint64_t linear_fetch_mask;
 };
 
 
@@ -590,7 +600,8 @@ generic_run_one(struct translate_generic *tg,
                 unsigned elt,
                 unsigned start_instance,
                 unsigned instance_id,
-                void *vert)
+                void *vert,
+                uint64_t skip_mask)
 {
    unsigned nr_attrs = tg->nr_attrib;
    unsigned attr;
@@ -599,6 +610,9 @@ generic_run_one(struct translate_generic *tg,
       float data[4];
       uint8_t *dst = (uint8_t *)vert + tg->attrib[attr].output_offset;
 
+      if (skip_mask & BITFIELD64_BIT(attr))
+         continue;
+
       if (tg->attrib[attr].type == TRANSLATE_ELEMENT_NORMAL) {
          const uint8_t *src;
          unsigned index;
@@ -624,6 +638,8 @@ generic_run_one(struct translate_generic *tg,
          copy_size = tg->attrib[attr].copy_size;
          if (likely(copy_size >= 0)) {
             memcpy(dst, src, copy_size);
+         } else if (tg->attrib[attr].fetch_to_output) {
+            tg->attrib[attr].fetch(dst, 0, src, 0, 1, 1);
          } else {
             tg->attrib[attr].fetch(data, 0, src, 0, 1, 1);
 
@@ -665,7 +681,7 @@ generic_run_elts(struct translate *translate,
    unsigned i;
 
    for (i = 0; i < count; i++) {
-      generic_run_one(tg, *elts++, start_instance, instance_id, vert);
+      generic_run_one(tg, *elts++, start_instance, instance_id, vert, 0);
       vert += tg->translate.key.output_stride;
    }
 }
@@ -683,7 +699,7 @@ generic_run_elts16(struct translate *translate,
    unsigned i;
 
    for (i = 0; i < count; i++) {
-      generic_run_one(tg, *elts++, start_instance, instance_id, vert);
+      generic_run_one(tg, *elts++, start_instance, instance_id, vert, 0);
       vert += tg->translate.key.output_stride;
    }
 }
@@ -701,11 +717,51 @@ generic_run_elts8(struct translate *translate,
    unsigned i;
 
    for (i = 0; i < count; i++) {
-      generic_run_one(tg, *elts++, start_instance, instance_id, vert);
+      generic_run_one(tg, *elts++, start_instance, instance_id, vert, 0);
       vert += tg->translate.key.output_stride;
    }
 }
 
+/**
+ * Convert an attribute of 'count' consecutive vertices with one fetch call,
+ * which writes straight to the output vertices.
+ */
+static void
+generic_fetch_linear(struct translate_generic *tg,
+                     unsigned attr,
+                     unsigned start,
+                     unsigned count,
+                     void *output_buffer)
+{
+   const unsigned output_stride = tg->translate.key.output_stride;
+   const unsigned input_stride = tg->attrib[attr].input_stride;
+   const unsigned max_index = tg->attrib[attr].max_index;
+   uint8_t *dst = (uint8_t *)output_buffer + tg->attrib[attr].output_offset;
+   unsigned n, i;
+
+   /* the vertices past max_index are clamped to it */
+   if (start > max_index)
+      n = 0;
+   else if (max_index - start >= count)
+      n = count;
+   else
+      n = max_index - start + 1;
+
+   if (n) {
+      tg->attrib[attr].fetch(dst, output_stride,
+                             tg->attrib[attr].input_ptr +
+                             (ptrdiff_t)input_stride * start,
+                             input_stride, 1, n);
+   }
+
+   for (i = n; i < count; i++) {
+      tg->attrib[attr].fetch(dst + (ptrdiff_t)output_stride * i, 0,
+                             tg->attrib[attr].input_ptr +
+                             (ptrdiff_t)input_stride * max_index,
+                             0, 1, 1);
+   }
+}
+
 static void PIPE_CDECL
 generic_run(struct translate *translate,
             unsigned start,
@@ -716,10 +772,21 @@ generic_run(struct translate *translate,
 {
    struct translate_generic *tg = translate_generic(translate);
    char *vert = output_buffer;
+
+   uint64_t mask = tg->linear_fetch_mask;
    unsigned i;
 
+   while (mask) {
+      const unsigned attr = u_bit_scan64(&mask);
+      generic_fetch_linear(tg, attr, start, count, output_buffer);
+   }
+
+   if (tg->linear_fetch_mask == BITFIELD64_MASK(tg->nr_attrib))
+      return;
+
    for (i = 0; i < count; i++) {
-      generic_run_one(tg, start + i, start_instance, instance_id, vert);
+      generic_run_one(tg, start + i, start_instance, instance_id, vert,
+                      tg->linear_fetch_mask);
       vert += tg->translate.key.output_stride;
    }
 }
@@ -839,6 +906,19 @@ translate_generic_create(const struct translate_key *key)
          tg->attrib[i].emit = get_emit_func(key->element[i].output_format);
       else
          tg->attrib[i].emit  = NULL;
+
+      /* The emit functions of these formats are plain copies of what
+       * fetch produced, skip them.
+       */
+      if (tg->attrib[i].type == TRANSLATE_ELEMENT_NORMAL &&
+          tg->attrib[i].copy_size < 0 &&
+          (key->element[i].output_format == PIPE_FORMAT_R32G32B32A32_FLOAT ||
+           key->element[i].output_format == PIPE_FORMAT_R32G32B32A32_UINT ||
+           key->element[i].output_format == PIPE_FORMAT_R32G32B32A32_SINT)) {
+         tg->attrib[i].fetch_to_output = TRUE;
+         if (!tg->attrib[i].instance_divisor)
+            tg->linear_fetch_mask |= BITFIELD64_BIT(i);
+      }
    }
 
    tg->nr_attrib = key->nr_elements;
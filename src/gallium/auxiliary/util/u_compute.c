@@ -27,6 +27,7 @@
  **************************************************************************/
 
 #include "pipe/p_context.h"
+#include "pipe/p_screen.h"
 #include "pipe/p_state.h"
 
 #include "u_bitcast.h"
@@ -75,85 +76,146 @@ static void *blit_compute_shader(struct pipe_context *ctx)
    return ctx->create_compute_state(ctx, &state);
 }
 
-void util_compute_blit(struct pipe_context *ctx, struct pipe_blit_info *blit_info,
-                       void **compute_state)
+static void *create_blit_sampler(struct pipe_context *ctx, unsigned filter)
 {
-   if (blit_info->src.box.width == 0 || blit_info->src.box.height == 0 ||
-       blit_info->dst.box.width == 0 || blit_info->dst.box.height == 0)
-     return;
-
-   struct pipe_resource *src = blit_info->src.resource;
-   struct pipe_resource *dst = blit_info->dst.resource;
-   struct pipe_sampler_view src_templ = {0}, *src_view;
-   void *sampler_state_p;
-   unsigned width = blit_info->dst.box.width;
-   unsigned height = blit_info->dst.box.height;
-   float x_scale = blit_info->src.box.width / (float)blit_info->dst.box.width;
-   float y_scale = blit_info->src.box.height / (float)blit_info->dst.box.height;
-   float z_scale = blit_info->src.box.depth / (float)blit_info->dst.box.depth;
-
-   unsigned data[] = {u_bitcast_f2u(blit_info->src.box.x / (float)src->width0),
-                      u_bitcast_f2u(blit_info->src.box.y / (float)src->height0),
-                      u_bitcast_f2u(blit_info->src.box.z),
-                      u_bitcast_f2u(0),
-                      u_bitcast_f2u(x_scale / src->width0),
-                      u_bitcast_f2u(y_scale / src->height0),
-                      u_bitcast_f2u(z_scale),
-                      u_bitcast_f2u(0),
-                      blit_info->dst.box.x,
-                      blit_info->dst.box.y,
-                      blit_info->dst.box.z,
-                      0};
-
-   struct pipe_constant_buffer cb = {0};
-   cb.buffer_size = sizeof(data);
-   cb.user_buffer = data;
-   ctx->set_constant_buffer(ctx, PIPE_SHADER_COMPUTE, 0, false, &cb);
-
-   struct pipe_image_view image = {0};
-   image.resource = dst;
-   image.shader_access = image.access = PIPE_IMAGE_ACCESS_WRITE;
-   image.format = util_format_linear(blit_info->dst.format);
-   image.u.tex.level = blit_info->dst.level;
-   image.u.tex.first_layer = 0;
-   image.u.tex.last_layer = (unsigned)(dst->array_size - 1);
-
-   ctx->set_shader_images(ctx, PIPE_SHADER_COMPUTE, 0, 1, 0, &image);
-
    struct pipe_sampler_state sampler_state={0};
    sampler_state.wrap_s = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
    sampler_state.wrap_t = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
    sampler_state.wrap_r = PIPE_TEX_WRAP_CLAMP_TO_EDGE;
    sampler_state.normalized_coords = 1;
 
-   if (blit_info->filter == PIPE_TEX_FILTER_LINEAR) {
+   if (filter == PIPE_TEX_FILTER_LINEAR) {
       sampler_state.min_img_filter = PIPE_TEX_FILTER_LINEAR;
       sampler_state.mag_img_filter = PIPE_TEX_FILTER_LINEAR;
    }
 
-   sampler_state_p = ctx->create_sampler_state(ctx, &sampler_state);
-   ctx->bind_sampler_states(ctx, PIPE_SHADER_COMPUTE, 0, 1, &sampler_state_p);
+   return ctx->create_sampler_state(ctx, &sampler_state);
+}
+
+static bool blit_reads_earlier_dst(const struct pipe_blit_info *blits,
+                                   unsigned index)
+{
+   for (unsigned i = 0; i < index; i++) {
+      if (blits[i].dst.resource == blits[index].src.resource)
+         return true;
+   }
+   return false;
+}
 
-   /* Initialize the sampler view. */
-   u_sampler_view_default_template(&src_templ, src, src->format);
-   src_templ.format = util_format_linear(blit_info->src.format);
-   src_view = ctx->create_sampler_view(ctx, src, &src_templ);
-   ctx->set_sampler_views(ctx, PIPE_SHADER_COMPUTE, 0, 1, 0, &src_view);
+/**
+ * Run several blits with the compute blit shader.  The shader, samplers and
+ * bindings are only set up once for the whole batch, and sampler views and
+ * images are only rebound when the source or destination level changes.
+ * A barrier is only inserted before a blit that reads a resource written by
+ * an earlier blit of the batch, so independent regions are dispatched back
+ * to back.
+ */
+void util_compute_blit_batch(struct pipe_context *ctx,
+                             const struct pipe_blit_info *blits,
+                             unsigned num_blits, void **compute_state)
+{
+   struct pipe_sampler_view *src_view = NULL;
+   struct pipe_image_view image = {0};
+   void *samplers[2] = {NULL, NULL};
+   int bound_filter = -1;
+   bool image_bound = false;
 
    if (!*compute_state)
      *compute_state = blit_compute_shader(ctx);
    ctx->bind_compute_state(ctx, *compute_state);
 
-   struct pipe_grid_info grid_info = {0};
-   grid_info.block[0] = 64;
-   grid_info.last_block[0] = width % 64;
-   grid_info.block[1] = 1;
-   grid_info.block[2] = 1;
-   grid_info.grid[0] = DIV_ROUND_UP(width, 64);
-   grid_info.grid[1] = height;
-   grid_info.grid[2] = 1;
+   for (unsigned i = 0; i < num_blits; i++) {
+      const struct pipe_blit_info *blit_info = &blits[i];
+
+      if (blit_info->src.box.width == 0 || blit_info->src.box.height == 0 ||
+          blit_info->dst.box.width == 0 || blit_info->dst.box.height == 0)
+        continue;
+
+      if (i && blit_reads_earlier_dst(blits, i))
+         ctx->memory_barrier(ctx, PIPE_BARRIER_ALL);
+
+      struct pipe_resource *src = blit_info->src.resource;
+      struct pipe_resource *dst = blit_info->dst.resource;
+      unsigned src_width = u_minify(src->width0, blit_info->src.level);
+      unsigned src_height = u_minify(src->height0, blit_info->src.level);
+      unsigned width = blit_info->dst.box.width;
+      unsigned height = blit_info->dst.box.height;
+      float x_scale = blit_info->src.box.width / (float)blit_info->dst.box.width;
+      float y_scale = blit_info->src.box.height / (float)blit_info->dst.box.height;
+      float z_scale = blit_info->src.box.depth / (float)blit_info->dst.box.depth;
+
+      unsigned data[] = {u_bitcast_f2u(blit_info->src.box.x / (float)src_width),
+                         u_bitcast_f2u(blit_info->src.box.y / (float)src_height),
+                         u_bitcast_f2u(blit_info->src.box.z),
+                         u_bitcast_f2u(0),
+                         u_bitcast_f2u(x_scale / src_width),
+                         u_bitcast_f2u(y_scale / src_height),
+                         u_bitcast_f2u(z_scale),
+                         u_bitcast_f2u(0),
+                         blit_info->dst.box.x,
+                         blit_info->dst.box.y,
+                         blit_info->dst.box.z,
+                         0};
+
+      struct pipe_constant_buffer cb = {0};
+      cb.buffer_size = sizeof(data);
+      cb.user_buffer = data;
+      ctx->set_constant_buffer(ctx, PIPE_SHADER_COMPUTE, 0, false, &cb);
+
+      enum pipe_format dst_format = util_format_linear(blit_info->dst.format);
+      if (!image_bound || image.resource != dst ||
+          image.format != dst_format ||
+          image.u.tex.level != blit_info->dst.level) {
+         image.resource = dst;
+         image.shader_access = image.access = PIPE_IMAGE_ACCESS_WRITE;
+         image.format = dst_format;
+         image.u.tex.level = blit_info->dst.level;
+         image.u.tex.first_layer = 0;
+         image.u.tex.last_layer = (unsigned)(dst->array_size - 1);
+
+         ctx->set_shader_images(ctx, PIPE_SHADER_COMPUTE, 0, 1, 0, &image);
+         image_bound = true;
+      }
+
+      unsigned filter = blit_info->filter == PIPE_TEX_FILTER_LINEAR;
+      if (bound_filter != (int)filter) {
+         if (!samplers[filter])
+            samplers[filter] = create_blit_sampler(ctx, blit_info->filter);
+         ctx->bind_sampler_states(ctx, PIPE_SHADER_COMPUTE, 0, 1,
+                                  &samplers[filter]);
+         bound_filter = filter;
+      }
+
+      /* The shader samples with TEX_LZ, so the view must start at the
+       * source level.
+       */
+      enum pipe_format src_format = util_format_linear(blit_info->src.format);
+      if (!src_view || src_view->texture != src ||
+          src_view->format != src_format ||
+          src_view->u.tex.first_level != blit_info->src.level) {
+         struct pipe_sampler_view src_templ = {0};
 
-   ctx->launch_grid(ctx, &grid_info);
+         u_sampler_view_default_template(&src_templ, src, src->format);
+         src_templ.format = src_format;
+         src_templ.u.tex.first_level = blit_info->src.level;
+         src_templ.u.tex.last_level = blit_info->src.level;
+
+         pipe_sampler_view_reference(&src_view, NULL);
+         src_view = ctx->create_sampler_view(ctx, src, &src_templ);
+         ctx->set_sampler_views(ctx, PIPE_SHADER_COMPUTE, 0, 1, 0, &src_view);
+      }
+
+      struct pipe_grid_info grid_info = {0};
+      grid_info.block[0] = 64;
+      grid_info.last_block[0] = width % 64;
+      grid_info.block[1] = 1;
+      grid_info.block[2] = 1;
+      grid_info.grid[0] = DIV_ROUND_UP(width, 64);
+      grid_info.grid[1] = height;
+      grid_info.grid[2] = blit_info->dst.box.depth;
+
+      ctx->launch_grid(ctx, &grid_info);
+   }
 
    ctx->memory_barrier(ctx, PIPE_BARRIER_ALL);
 
@@ -161,6 +223,77 @@ void util_compute_blit(struct pipe_context *ctx, struct pipe_blit_info *blit_inf
    ctx->set_constant_buffer(ctx, PIPE_SHADER_COMPUTE, 0, false, NULL);
    ctx->set_sampler_views(ctx, PIPE_SHADER_COMPUTE, 0, 0, 1, NULL);
    pipe_sampler_view_reference(&src_view, NULL);
-   ctx->delete_sampler_state(ctx, sampler_state_p);
+   for (unsigned i = 0; i < ARRAY_SIZE(samplers); i++) {
+      if (samplers[i])
+         ctx->delete_sampler_state(ctx, samplers[i]);
+   }
    ctx->bind_compute_state(ctx, NULL);
 }
+
+void util_compute_blit(struct pipe_context *ctx, struct pipe_blit_info *blit_info,
+                       void **compute_state)
+{
+   util_compute_blit_batch(ctx, blit_info, 1, compute_state);
+}
+
+/**
+ * Generate mipmap levels with a single batch of compute blits, avoiding the
+ * per-level graphics state save/restore of u_blitter.  Only 2D and 2D array
+ * non-sRGB color textures whose format can be written as a shader image are
+ * handled;
+ * returns false otherwise so the caller can fall back to util_gen_mipmap().
+ */
+bool util_compute_gen_mipmap(struct pipe_context *ctx, struct pipe_resource *pt,
+                             enum pipe_format format, unsigned base_level,
+                             unsigned last_level, unsigned first_layer,
+                             unsigned last_layer, unsigned filter,
+                             void **compute_state)
+{
+   struct pipe_screen *screen = ctx->screen;
+   struct pipe_blit_info blits[PIPE_MAX_TEXTURE_LEVELS];
+   unsigned num_blits = 0;
+
+   if (pt->target != PIPE_TEXTURE_2D && pt->target != PIPE_TEXTURE_2D_ARRAY)
+      return false;
+
+   /* The shader stores through linear views, so sRGB levels would be
+    * filtered in the encoded space.
+    */
+   if (util_format_is_depth_or_stencil(format) ||
+       util_format_is_pure_integer(format) ||
+       util_format_is_srgb(format))
+      return false;
+
+   if (!screen->is_format_supported(screen, util_format_linear(format),
+                                    pt->target, pt->nr_samples,
+                                    pt->nr_storage_samples,
+                                    PIPE_BIND_SAMPLER_VIEW |
+                                    PIPE_BIND_SHADER_IMAGE))
+      return false;
+
+   assert(last_level <= pt->last_level);
+   assert(last_level > base_level);
+
+   for (unsigned level = base_level + 1; level <= last_level; level++) {
+      struct pipe_blit_info *blit = &blits[num_blits++];
+
+      memset(blit, 0, sizeof(*blit));
+      blit->src.resource = blit->dst.resource = pt;
+      blit->src.format = blit->dst.format = format;
+      blit->mask = PIPE_MASK_RGBA;
+      blit->filter = filter;
+
+      blit->src.level = level - 1;
+      blit->dst.level = level;
+      blit->src.box.width = u_minify(pt->width0, blit->src.level);
+      blit->src.box.height = u_minify(pt->height0, blit->src.level);
+      blit->dst.box.width = u_minify(pt->width0, blit->dst.level);
+      blit->dst.box.height = u_minify(pt->height0, blit->dst.level);
+      blit->src.box.z = blit->dst.box.z = first_layer;
+      blit->src.box.depth = blit->dst.box.depth =
+         last_layer + 1 - first_layer;
+   }
+
+   util_compute_blit_batch(ctx, blits, num_blits, compute_state);
+   return true;
+}
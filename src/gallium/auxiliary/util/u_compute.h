@@ -38,6 +38,16 @@ extern "C" {
 void util_compute_blit(struct pipe_context *ctx, struct pipe_blit_info *blit_info,
                        void **compute_state);
 
+void util_compute_blit_batch(struct pipe_context *ctx,
+                             const struct pipe_blit_info *blits,
+                             unsigned num_blits, void **compute_state);
+
+bool util_compute_gen_mipmap(struct pipe_context *ctx, struct pipe_resource *pt,
+                             enum pipe_format format, unsigned base_level,
+                             unsigned last_level, unsigned first_layer,
+                             unsigned last_layer, unsigned filter,
+                             void **compute_state);
+
 #ifdef __cplusplus
 }
 #endif
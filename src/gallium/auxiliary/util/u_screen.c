@@ -462,6 +462,9 @@ u_pipe_screen_get_param_defaults(struct pipe_screen *pscreen,
    case PIPE_CAP_SAMPLER_REDUCTION_MINMAX:
       return 0;
 
+   case PIPE_CAP_SHAREABLE_CSOS:
+      return 0;
+
    default:
       unreachable("bad PIPE_CAP_*");
    }
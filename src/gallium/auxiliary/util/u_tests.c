@@ -35,6 +35,7 @@
 #include "util/u_surface.h"
 #include "util/u_string.h"
 #include "util/u_tile.h"
+#include "util/os_time.h"
 #include "tgsi/tgsi_strings.h"
 #include "tgsi/tgsi_text.h"
 #include "cso_cache/cso_context.h"
@@ -1050,3 +1051,268 @@ util_run_tests(struct pipe_screen *screen)
    puts("Done. Exiting..");
    exit(0);
 }
+
+
+/**
+ * Benchmarks. Each one prints a JSON object on its own line, so the output
+ * can be collected and compared across drivers and releases.
+ */
+
+#define BENCH_SIZE 1024
+
+static void
+util_report_benchmark(struct pipe_screen *screen, const char *name,
+                      unsigned iterations, int64_t elapsed_ns,
+                      uint64_t bytes)
+{
+   double seconds = elapsed_ns / 1e9;
+
+   printf("{\"driver\": \"%s\", \"benchmark\": \"%s\", "
+          "\"iterations\": %u, \"total_ms\": %.3f, \"us_per_iter\": %.3f",
+          screen->get_name(screen), name, iterations, elapsed_ns / 1e6,
+          elapsed_ns / 1e3 / iterations);
+   if (bytes && seconds > 0)
+      printf(", \"mb_per_s\": %.1f", bytes / seconds / (1024 * 1024));
+   printf("}\n");
+   fflush(stdout);
+}
+
+static void
+util_finish(struct pipe_context *ctx)
+{
+   struct pipe_fence_handle *fence = NULL;
+
+   ctx->flush(ctx, &fence, 0);
+   if (fence) {
+      ctx->screen->fence_finish(ctx->screen, NULL, fence, PIPE_TIMEOUT_INFINITE);
+      ctx->screen->fence_reference(ctx->screen, &fence, NULL);
+   }
+}
+
+/* CPU cost of draw calls, including GPU completion of the last one. */
+static void
+bench_draw_overhead(struct pipe_context *ctx, unsigned iterations)
+{
+   struct cso_context *cso = cso_create_context(ctx, 0);
+   struct pipe_resource *cb =
+      util_create_texture2d(ctx->screen, 64, 64, PIPE_FORMAT_R8G8B8A8_UNORM, 0);
+   util_set_common_states_and_clear(cso, ctx, cb);
+
+   void *vs = util_set_passthrough_vertex_shader(cso, ctx, false);
+   void *fs = util_make_fragment_passthrough_shader(ctx, TGSI_SEMANTIC_GENERIC,
+                                                    TGSI_INTERPOLATE_LINEAR,
+                                                    TRUE);
+   cso_set_fragment_shader_handle(cso, fs);
+   util_finish(ctx);
+
+   int64_t start = os_time_get_nano();
+   for (unsigned i = 0; i < iterations; i++)
+      util_draw_fullscreen_quad(cso);
+   util_finish(ctx);
+   util_report_benchmark(ctx->screen, "draw_overhead", iterations,
+                         os_time_get_nano() - start, 0);
+
+   cso_destroy_context(cso);
+   ctx->delete_vs_state(ctx, vs);
+   ctx->delete_fs_state(ctx, fs);
+   pipe_resource_reference(&cb, NULL);
+}
+
+/* Cost of changing blend state between draws. */
+static void
+bench_state_change(struct pipe_context *ctx, unsigned iterations)
+{
+   struct cso_context *cso = cso_create_context(ctx, 0);
+   struct pipe_resource *cb =
+      util_create_texture2d(ctx->screen, 64, 64, PIPE_FORMAT_R8G8B8A8_UNORM, 0);
+   util_set_common_states_and_clear(cso, ctx, cb);
+
+   void *vs = util_set_passthrough_vertex_shader(cso, ctx, false);
+   void *fs = util_make_fragment_passthrough_shader(ctx, TGSI_SEMANTIC_GENERIC,
+                                                    TGSI_INTERPOLATE_LINEAR,
+                                                    TRUE);
+   cso_set_fragment_shader_handle(cso, fs);
+
+   struct pipe_blend_state blend[2] = {0};
+   blend[0].rt[0].colormask = PIPE_MASK_RGBA;
+   blend[1].rt[0].colormask = PIPE_MASK_RGBA;
+   blend[1].rt[0].blend_enable = 1;
+   blend[1].rt[0].rgb_func = PIPE_BLEND_ADD;
+   blend[1].rt[0].rgb_src_factor = PIPE_BLENDFACTOR_SRC_ALPHA;
+   blend[1].rt[0].rgb_dst_factor = PIPE_BLENDFACTOR_INV_SRC_ALPHA;
+   blend[1].rt[0].alpha_func = PIPE_BLEND_ADD;
+   blend[1].rt[0].alpha_src_factor = PIPE_BLENDFACTOR_ONE;
+   blend[1].rt[0].alpha_dst_factor = PIPE_BLENDFACTOR_ZERO;
+   util_finish(ctx);
+
+   int64_t start = os_time_get_nano();
+   for (unsigned i = 0; i < iterations; i++) {
+      cso_set_blend(cso, &blend[i & 1]);
+      util_draw_fullscreen_quad(cso);
+   }
+   util_finish(ctx);
+   util_report_benchmark(ctx->screen, "blend_state_change", iterations,
+                         os_time_get_nano() - start, 0);
+
+   cso_destroy_context(cso);
+   ctx->delete_vs_state(ctx, vs);
+   ctx->delete_fs_state(ctx, fs);
+   pipe_resource_reference(&cb, NULL);
+}
+
+static void
+bench_clear(struct pipe_context *ctx, unsigned iterations)
+{
+   static const union pipe_color_union color = {{0.5, 0.5, 0.5, 0.5}};
+   struct pipe_resource *tex =
+      util_create_texture2d(ctx->screen, BENCH_SIZE, BENCH_SIZE,
+                            PIPE_FORMAT_R8G8B8A8_UNORM, 0);
+   struct pipe_surface templ, *surf;
+
+   u_surface_default_template(&templ, tex);
+   surf = ctx->create_surface(ctx, tex, &templ);
+   util_finish(ctx);
+
+   int64_t start = os_time_get_nano();
+   for (unsigned i = 0; i < iterations; i++)
+      ctx->clear_render_target(ctx, surf, &color, 0, 0,
+                               BENCH_SIZE, BENCH_SIZE, false);
+   util_finish(ctx);
+   util_report_benchmark(ctx->screen, "clear_render_target", iterations,
+                         os_time_get_nano() - start,
+                         (uint64_t)iterations * BENCH_SIZE * BENCH_SIZE * 4);
+
+   pipe_surface_reference(&surf, NULL);
+   pipe_resource_reference(&tex, NULL);
+}
+
+static void
+bench_blit(struct pipe_context *ctx, unsigned iterations)
+{
+   struct pipe_resource *src =
+      util_create_texture2d(ctx->screen, BENCH_SIZE, BENCH_SIZE,
+                            PIPE_FORMAT_R8G8B8A8_UNORM, 0);
+   struct pipe_resource *dst =
+      util_create_texture2d(ctx->screen, BENCH_SIZE, BENCH_SIZE,
+                            PIPE_FORMAT_R8G8B8A8_UNORM, 0);
+   struct pipe_blit_info info;
+
+   memset(&info, 0, sizeof(info));
+   info.src.resource = src;
+   info.src.format = src->format;
+   u_box_2d(0, 0, BENCH_SIZE, BENCH_SIZE, &info.src.box);
+   info.dst.resource = dst;
+   info.dst.format = dst->format;
+   info.dst.box = info.src.box;
+   info.mask = PIPE_MASK_RGBA;
+   info.filter = PIPE_TEX_FILTER_NEAREST;
+   util_finish(ctx);
+
+   int64_t start = os_time_get_nano();
+   for (unsigned i = 0; i < iterations; i++)
+      ctx->blit(ctx, &info);
+   util_finish(ctx);
+   util_report_benchmark(ctx->screen, "blit", iterations,
+                         os_time_get_nano() - start,
+                         (uint64_t)iterations * BENCH_SIZE * BENCH_SIZE * 4);
+
+   pipe_resource_reference(&src, NULL);
+   pipe_resource_reference(&dst, NULL);
+}
+
+static void
+bench_texture_transfer(struct pipe_context *ctx, unsigned iterations)
+{
+   unsigned stride = BENCH_SIZE * 4;
+   struct pipe_resource *tex =
+      util_create_texture2d(ctx->screen, BENCH_SIZE, BENCH_SIZE,
+                            PIPE_FORMAT_R8G8B8A8_UNORM, 0);
+   uint8_t *data = calloc(BENCH_SIZE, stride);
+   struct pipe_box box;
+
+   u_box_2d(0, 0, BENCH_SIZE, BENCH_SIZE, &box);
+
+   int64_t start = os_time_get_nano();
+   for (unsigned i = 0; i < iterations; i++)
+      ctx->texture_subdata(ctx, tex, 0, PIPE_MAP_WRITE, &box, data, stride, 0);
+   util_finish(ctx);
+   util_report_benchmark(ctx->screen, "texture_upload", iterations,
+                         os_time_get_nano() - start,
+                         (uint64_t)iterations * BENCH_SIZE * stride);
+
+   start = os_time_get_nano();
+   for (unsigned i = 0; i < iterations; i++) {
+      struct pipe_transfer *transfer;
+      uint8_t *map = pipe_transfer_map(ctx, tex, 0, 0, PIPE_MAP_READ,
+                                       0, 0, BENCH_SIZE, BENCH_SIZE, &transfer);
+      for (unsigned y = 0; y < BENCH_SIZE; y++)
+         memcpy(data + y * stride, map + y * transfer->stride, stride);
+      pipe_transfer_unmap(ctx, transfer);
+   }
+   util_report_benchmark(ctx->screen, "texture_readback", iterations,
+                         os_time_get_nano() - start,
+                         (uint64_t)iterations * BENCH_SIZE * stride);
+
+   free(data);
+   pipe_resource_reference(&tex, NULL);
+}
+
+/* Latency of a single small dispatch, waited for one at a time. */
+static void
+bench_compute_dispatch(struct pipe_context *ctx, unsigned iterations)
+{
+   if (!ctx->screen->get_param(ctx->screen, PIPE_CAP_COMPUTE))
+      return;
+
+   static const char *text = "COMP\n"
+                             "PROPERTY CS_FIXED_BLOCK_WIDTH 1\n"
+                             "PROPERTY CS_FIXED_BLOCK_HEIGHT 1\n"
+                             "PROPERTY CS_FIXED_BLOCK_DEPTH 1\n"
+                             "END\n";
+   struct tgsi_token tokens[1000];
+   struct pipe_compute_state state = {0};
+
+   if (!tgsi_text_translate(text, tokens, ARRAY_SIZE(tokens)))
+      return;
+
+   state.ir_type = PIPE_SHADER_IR_TGSI;
+   state.prog = tokens;
+
+   void *cs = ctx->create_compute_state(ctx, &state);
+   if (!cs)
+      return;
+   ctx->bind_compute_state(ctx, cs);
+
+   struct pipe_grid_info info = {0};
+   info.block[0] = info.block[1] = info.block[2] = 1;
+   info.grid[0] = info.grid[1] = info.grid[2] = 1;
+
+   int64_t start = os_time_get_nano();
+   for (unsigned i = 0; i < iterations; i++) {
+      ctx->launch_grid(ctx, &info);
+      util_finish(ctx);
+   }
+   util_report_benchmark(ctx->screen, "compute_dispatch_latency", iterations,
+                         os_time_get_nano() - start, 0);
+
+   ctx->delete_compute_state(ctx, cs);
+}
+
+/**
+ * Run all benchmarks. Like util_run_tests(), this exits the process.
+ */
+void
+util_run_benchmarks(struct pipe_screen *screen)
+{
+   struct pipe_context *ctx = screen->context_create(screen, NULL, 0);
+
+   bench_draw_overhead(ctx, 10000);
+   bench_state_change(ctx, 10000);
+   bench_clear(ctx, 100);
+   bench_blit(ctx, 100);
+   bench_texture_transfer(ctx, 20);
+   bench_compute_dispatch(ctx, 100);
+   ctx->destroy(ctx);
+
+   exit(0);
+}
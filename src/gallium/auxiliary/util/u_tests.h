@@ -41,6 +41,7 @@ struct pipe_resource;
 void util_test_constant_buffer(struct pipe_context *ctx,
                                struct pipe_resource *constbuf);
 void util_run_tests(struct pipe_screen *screen);
+void util_run_benchmarks(struct pipe_screen *screen);
 
 #ifdef __cplusplus
 }
@@ -237,12 +237,33 @@ static void
 tc_batch_flush(struct threaded_context *tc)
 {
    struct tc_batch *next = &tc->batch_slots[tc->next];
+   struct tc_batch *oldest = &tc->batch_slots[(tc->next + 1) % TC_MAX_BATCHES];
 
    tc_assert(next->num_total_call_slots != 0);
    tc_batch_check(next);
    tc_debug_check(tc);
    tc->bytes_mapped_estimate = 0;
    p_atomic_add(&tc->num_offloaded_slots, next->num_total_call_slots);
+   p_atomic_inc(&tc->num_batches);
+
+   /* Adapt the batch size to the driver thread. Batches are executed in
+    * order, so if the oldest one is still busy, all slots are in use and
+    * adding the job below will wait. Queuing overhead doesn't matter then,
+    * so record as many calls as possible per batch. If the driver thread
+    * has already executed everything, it is waiting for us, so give it
+    * smaller batches to reduce the latency. Otherwise, grow slowly.
+    */
+   if (!util_queue_fence_is_signalled(&oldest->fence)) {
+      p_atomic_inc(&tc->num_stalls);
+      tc->batch_call_limit = TC_CALLS_PER_BATCH;
+   } else if (util_queue_fence_is_signalled(&tc->batch_slots[tc->last].fence)) {
+      tc->batch_call_limit = MAX2(tc->batch_call_limit / 2,
+                                  TC_MIN_CALLS_PER_BATCH);
+   } else {
+      tc->batch_call_limit = MIN2(tc->batch_call_limit +
+                                  tc->batch_call_limit / 4,
+                                  TC_CALLS_PER_BATCH);
+   }
 
    if (next->token) {
       next->token->tc = NULL;
@@ -267,7 +288,9 @@ tc_add_sized_call(struct threaded_context *tc, enum tc_call_id id,
 
    tc_debug_check(tc);
 
-   if (unlikely(next->num_total_call_slots + num_call_slots > TC_CALLS_PER_BATCH)) {
+   /* A call bigger than the current limit still fits in an empty batch. */
+   if (unlikely(next->num_total_call_slots + num_call_slots > tc->batch_call_limit &&
+                next->num_total_call_slots)) {
       tc_batch_flush(tc);
       next = &tc->batch_slots[tc->next];
       tc_assert(next->num_total_call_slots == 0);
@@ -1985,6 +2008,26 @@ tc_call_texture_subdata(struct pipe_context *pipe, union tc_payload *payload)
    pipe_resource_reference(&p->resource, NULL);
 }
 
+struct tc_texture_subdata_copy {
+   struct pipe_resource *resource;
+   struct threaded_context *tc;
+   unsigned level, usage, stride, layer_stride, size;
+   struct pipe_box box;
+   void *data; /* malloc'd by tc_texture_subdata */
+};
+
+static void
+tc_call_texture_subdata_copy(struct pipe_context *pipe, union tc_payload *payload)
+{
+   struct tc_texture_subdata_copy *p = (struct tc_texture_subdata_copy *)payload;
+
+   pipe->texture_subdata(pipe, p->resource, p->level, p->usage, &p->box,
+                         p->data, p->stride, p->layer_stride);
+   pipe_resource_reference(&p->resource, NULL);
+   free(p->data);
+   p_atomic_add(&p->tc->queued_subdata_bytes, -(int)p->size);
+}
+
 static void
 tc_texture_subdata(struct pipe_context *_pipe,
                    struct pipe_resource *resource,
@@ -2005,7 +2048,7 @@ tc_texture_subdata(struct pipe_context *_pipe,
    if (!size)
       return;
 
-   /* Small uploads can be enqueued, big uploads must sync. */
+   /* Small uploads can be enqueued. */
    if (size <= TC_MAX_SUBDATA_BYTES) {
       struct tc_texture_subdata *p =
          tc_add_slot_based_call(tc, TC_CALL_texture_subdata, tc_texture_subdata, size);
@@ -2017,15 +2060,45 @@ tc_texture_subdata(struct pipe_context *_pipe,
       p->stride = stride;
       p->layer_stride = layer_stride;
       memcpy(p->slot, data, size);
-   } else {
-      struct pipe_context *pipe = tc->pipe;
+      return;
+   }
 
-      tc_sync(tc);
-      tc_set_driver_thread(tc);
-      pipe->texture_subdata(pipe, resource, level, usage, box, data,
-                            stride, layer_stride);
-      tc_clear_driver_thread(tc);
+   /* Big uploads are copied to the heap and enqueued too, so that streaming
+    * texture uploads don't have to wait for the driver thread, unless too
+    * much data is already waiting.
+    */
+   if (p_atomic_read(&tc->queued_subdata_bytes) + size <= TC_MAX_QUEUED_SUBDATA_BYTES) {
+      void *copy = malloc(size);
+
+      if (copy) {
+         struct tc_texture_subdata_copy *p =
+            tc_add_struct_typed_call(tc, TC_CALL_texture_subdata_copy,
+                                     tc_texture_subdata_copy);
+
+         memcpy(copy, data, size);
+         p_atomic_add(&tc->queued_subdata_bytes, size);
+
+         tc_set_resource_reference(&p->resource, resource);
+         p->tc = tc;
+         p->level = level;
+         p->usage = usage;
+         p->box = *box;
+         p->stride = stride;
+         p->layer_stride = layer_stride;
+         p->size = size;
+         p->data = copy;
+         return;
+      }
    }
+
+   /* Otherwise sync. */
+   struct pipe_context *pipe = tc->pipe;
+
+   tc_sync(tc);
+   tc_set_driver_thread(tc);
+   pipe->texture_subdata(pipe, resource, level, usage, box, data,
+                         stride, layer_stride);
+   tc_clear_driver_thread(tc);
 }
 
 
@@ -3071,6 +3144,7 @@ threaded_context_create(struct pipe_context *pipe,
       tc->batch_slots[i].tc = tc;
       util_queue_fence_init(&tc->batch_slots[i].fence);
    }
+   tc->batch_call_limit = TC_CALLS_PER_BATCH;
 
    list_inithead(&tc->unflushed_queries);
 
@@ -222,16 +222,28 @@ struct tc_unflushed_batch_token;
  */
 #define TC_CALLS_PER_BATCH    768
 
+/* The threaded context flushes batches earlier, down to this many call
+ * slots, while the driver thread is idle, so that it can start executing
+ * calls sooner. See tc_batch_flush.
+ */
+#define TC_MIN_CALLS_PER_BATCH 96
+
 /* Threshold for when to use the queue or sync. */
 #define TC_MAX_STRING_MARKER_BYTES  512
 
 /* Threshold for when to enqueue buffer/texture_subdata as-is.
  * If the upload size is greater than this, it will do instead:
  * - for buffers: DISCARD_RANGE is done by the threaded context
- * - for textures: sync and call the driver directly
+ * - for textures: copy the data to the heap and enqueue the call, see below
  */
 #define TC_MAX_SUBDATA_BYTES        320
 
+/* How many bytes of texture_subdata data copied to the heap can wait for
+ * the driver thread. If there is more, texture_subdata syncs and calls
+ * the driver directly.
+ */
+#define TC_MAX_QUEUED_SUBDATA_BYTES (64 * 1024 * 1024)
+
 typedef void (*tc_replace_buffer_storage_func)(struct pipe_context *ctx,
                                                struct pipe_resource *dst,
                                                struct pipe_resource *src);
@@ -364,6 +376,13 @@ struct threaded_context {
    unsigned num_offloaded_slots;
    unsigned num_direct_slots;
    unsigned num_syncs;
+   unsigned num_batches;
+   unsigned num_stalls;    /**< flushes that waited for a free batch slot */
+
+   /* Number of call slots after which the current batch is flushed,
+    * between TC_MIN_CALLS_PER_BATCH and TC_CALLS_PER_BATCH.
+    */
+   unsigned batch_call_limit;
 
    bool use_forced_staging_uploads;
 
@@ -373,6 +392,9 @@ struct threaded_context {
    uint64_t bytes_mapped_estimate;
    uint64_t bytes_mapped_limit;
 
+   /* Texture upload bytes queued by tc_texture_subdata. */
+   unsigned queued_subdata_bytes;
+
    struct util_queue queue;
    struct util_queue_fence *fence;
 
@@ -25,6 +25,7 @@ CALL(transfer_flush_region)
 CALL(transfer_unmap)
 CALL(buffer_subdata)
 CALL(texture_subdata)
+CALL(texture_subdata_copy)
 CALL(emit_string_marker)
 CALL(draw_single)
 CALL(draw_multi)
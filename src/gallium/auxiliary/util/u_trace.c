@@ -22,12 +22,14 @@
  */
 
 #include <inttypes.h>
+#include <string.h>
 
 #include "pipe/p_context.h"
 #include "pipe/p_state.h"
 
 #include "util/list.h"
 #include "util/ralloc.h"
+#include "util/u_atomic.h"
 #include "util/u_debug.h"
 #include "util/u_inlines.h"
 
@@ -143,6 +145,23 @@ get_chunk(struct u_trace *ut)
    return chunk;
 }
 
+#ifdef HAVE_PERFETTO
+int ut_perfetto_enabled;
+
+void
+u_trace_perfetto_start(void)
+{
+   p_atomic_inc(&ut_perfetto_enabled);
+}
+
+void
+u_trace_perfetto_stop(void)
+{
+   assert(ut_perfetto_enabled > 0);
+   p_atomic_dec(&ut_perfetto_enabled);
+}
+#endif
+
 DEBUG_GET_ONCE_BOOL_OPTION(trace, "GALLIUM_GPU_TRACE", false)
 DEBUG_GET_ONCE_FILE_OPTION(trace_file, "GALLIUM_GPU_TRACEFILE", NULL, "w")
 
@@ -182,8 +201,15 @@ u_trace_context_init(struct u_trace_context *utctx,
 
    utctx->out = get_tracefile();
 
+   memset(&utctx->queue, 0, sizeof(utctx->queue));
+
+   /* A perfetto session may start at any time, so the queue is needed
+    * even when not printing traces:
+    */
+#ifndef HAVE_PERFETTO
    if (!utctx->out)
       return;
+#endif
 
    bool ret = util_queue_init(&utctx->queue, "traceq", 256, 1,
          UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY |
@@ -197,11 +223,12 @@ u_trace_context_init(struct u_trace_context *utctx,
 void
 u_trace_context_fini(struct u_trace_context *utctx)
 {
-   if (!utctx->out)
+   if (!util_queue_is_initialized(&utctx->queue))
       return;
    util_queue_finish(&utctx->queue);
    util_queue_destroy(&utctx->queue);
-   fflush(utctx->out);
+   if (utctx->out)
+      fflush(utctx->out);
    free_chunks(&utctx->flushed_trace_chunks);
 }
 
@@ -212,7 +239,7 @@ process_chunk(void *job, int thread_index)
    struct u_trace_context *utctx = chunk->utctx;
 
    /* For first chunk of batch, accumulated times will be zerod: */
-   if (!utctx->last_time_ns) {
+   if (utctx->out && !utctx->last_time_ns) {
       fprintf(utctx->out, "+----- NS -----+ +-- Δ --+  +----- MSG -----\n");
    }
 
@@ -236,6 +263,14 @@ process_chunk(void *job, int thread_index)
          delta = 0;
       }
 
+#ifdef HAVE_PERFETTO
+      if (evt->tp->perfetto && ut_perfetto_enabled > 0)
+         evt->tp->perfetto(utctx->pctx, ns, evt->payload);
+#endif
+
+      if (!utctx->out)
+         continue;
+
       if (evt->tp->print) {
          fprintf(utctx->out, "%016"PRIu64" %+9d: %s: ", ns, delta, evt->tp->name);
          evt->tp->print(utctx->out, evt->payload);
@@ -246,14 +281,17 @@ process_chunk(void *job, int thread_index)
 
    if (chunk->last) {
       uint64_t elapsed = utctx->last_time_ns - utctx->first_time_ns;
-      fprintf(utctx->out, "ELAPSED: %"PRIu64" ns\n", elapsed);
+      if (utctx->out)
+         fprintf(utctx->out, "ELAPSED: %"PRIu64" ns\n", elapsed);
 
       utctx->last_time_ns = 0;
       utctx->first_time_ns = 0;
    }
 
    if (chunk->eof) {
-      fprintf(utctx->out, "END OF FRAME %u\n", utctx->frame_nr++);
+      if (utctx->out)
+         fprintf(utctx->out, "END OF FRAME %u\n", utctx->frame_nr);
+      utctx->frame_nr++;
    }
 }
 
@@ -296,7 +334,7 @@ u_trace_init(struct u_trace *ut, struct u_trace_context *utctx)
 {
    ut->utctx = utctx;
    list_inithead(&ut->trace_chunks);
-   ut->enabled = !!utctx->out;
+   ut->enabled = u_trace_context_tracing(utctx);
 }
 
 void
@@ -35,9 +35,11 @@
  * tracepoints, which generate 'trace_$name()' functions that can be
  * called at various points in commandstream emit.
  *
- * Currently a printf backend is implemented, but the expectation is to
- * also implement a perfetto backend for shipping out traces to a tool like
- * AGI.
+ * Traces are printed to the file given by GALLIUM_GPU_TRACEFILE (or stdout
+ * with GALLIUM_GPU_TRACE).  In HAVE_PERFETTO builds, tracepoints declaring a
+ * tp_perfetto callback are additionally forwarded to the driver's perfetto
+ * data source while a tracing session is active, for shipping out traces
+ * to a tool like AGI.
  *
  * Notable differences:
  *
@@ -66,6 +68,7 @@ struct u_trace_context;
 struct u_trace;
 struct u_trace_chunk;
 
+struct pipe_context;
 struct pipe_resource;
 
 /**
@@ -152,12 +155,38 @@ struct u_trace {
    bool enabled;
 };
 
+#ifdef HAVE_PERFETTO
+/**
+ * Number of active perfetto tracing sessions.  Drivers' perfetto data
+ * sources call u_trace_perfetto_start()/u_trace_perfetto_stop() when a
+ * session starts or stops.  Tracing is enabled for u_trace instances
+ * initialized while a session is active.
+ */
+extern int ut_perfetto_enabled;
+
+void u_trace_perfetto_start(void);
+void u_trace_perfetto_stop(void);
+#else
+#  define ut_perfetto_enabled 0
+#endif
+
 void u_trace_context_init(struct u_trace_context *utctx,
       struct pipe_context *pctx,
       u_trace_record_ts record_timestamp,
       u_trace_read_ts   read_timestamp);
 void u_trace_context_fini(struct u_trace_context *utctx);
 
+/**
+ * Whether tracepoints emitted to the trace context are consumed, either by
+ * the printf backend or by an active perfetto session.
+ */
+static inline bool
+u_trace_context_tracing(struct u_trace_context *utctx)
+{
+   return util_queue_is_initialized(&utctx->queue) &&
+          (utctx->out || ut_perfetto_enabled > 0);
+}
+
 /**
  * Flush (trigger processing) of traces previously flushed to the trace-context
  * by u_trace_flush().
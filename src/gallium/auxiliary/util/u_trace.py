@@ -29,7 +29,8 @@ TRACEPOINTS = {}
 class Tracepoint(object):
     """Class that represents all the information about a tracepoint
     """
-    def __init__(self, name, args=[], tp_struct=None, tp_print=None):
+    def __init__(self, name, args=[], tp_struct=None, tp_print=None,
+                 tp_perfetto=None):
         """Parameters:
 
         - name: the tracepoint name, a tracepoint function with the given
@@ -41,6 +42,10 @@ class Tracepoint(object):
           convert from tracepoint args to trace payload.  If not specified
           it will be generated from `args` (ie, [type, name, name])
         - tp_print: (optional) array of format string followed by expressions
+        - tp_perfetto: (optional) name of a driver provided function, taking
+          the pipe_context, the timestamp in ns and a pointer to the
+          'struct trace_<name>' payload, which forwards the event to a
+          perfetto data source.  Only used in HAVE_PERFETTO builds.
         """
         assert isinstance(name, str)
         assert isinstance(args, list)
@@ -54,6 +59,7 @@ class Tracepoint(object):
                 tp_struct.append([arg[0], arg[1], arg[1]])
         self.tp_struct = tp_struct
         self.tp_print = tp_print
+        self.tp_perfetto = tp_perfetto
 
         TRACEPOINTS[name] = self
 
@@ -106,6 +112,17 @@ hdr_template = """\
 #include "util/u_trace.h"
 
 % for trace_name, trace in TRACEPOINTS.items():
+struct trace_${trace_name} {
+%    for member in trace.tp_struct:
+         ${member[0]} ${member[1]};
+%    endfor
+};
+%    if trace.tp_perfetto is not None:
+#ifdef HAVE_PERFETTO
+void ${trace.tp_perfetto}(struct pipe_context *pctx, uint64_t ts_ns,
+                          const struct trace_${trace_name} *payload);
+#endif
+%    endif
 void __trace_${trace_name}(struct u_trace *ut
 %    for arg in trace.args:
      , ${arg[0]} ${arg[1]}
@@ -165,15 +182,10 @@ src_template = """\
 /*
  * ${trace_name}
  */
-struct __payload_${trace_name} {
-%    for member in trace.tp_struct:
-         ${member[0]} ${member[1]};
-%    endfor
-};
 %    if trace.tp_print is not None:
 static void __print_${trace_name}(FILE *out, const void *arg) {
-   const struct __payload_${trace_name} *__entry =
-      (const struct __payload_${trace_name} *)arg;
+   const struct trace_${trace_name} *__entry =
+      (const struct trace_${trace_name} *)arg;
    fprintf(out, "${trace.tp_print[0]}\\n"
 %       for arg in trace.tp_print[1:]:
            , ${arg}
@@ -183,18 +195,30 @@ static void __print_${trace_name}(FILE *out, const void *arg) {
 %    else:
 #define __print_${trace_name} NULL
 %    endif
+#ifdef HAVE_PERFETTO
+%    if trace.tp_perfetto is not None:
+static void __emit_${trace_name}(struct pipe_context *pctx, uint64_t ts_ns, const void *arg) {
+   ${trace.tp_perfetto}(pctx, ts_ns, (const struct trace_${trace_name} *)arg);
+}
+%    else:
+#define __emit_${trace_name} NULL
+%    endif
+#endif
 static const struct u_tracepoint __tp_${trace_name} = {
-    ALIGN_POT(sizeof(struct __payload_${trace_name}), 8),   /* keep size 64b aligned */
+    ALIGN_POT(sizeof(struct trace_${trace_name}), 8),   /* keep size 64b aligned */
     "${trace_name}",
     __print_${trace_name},
+#ifdef HAVE_PERFETTO
+    __emit_${trace_name},
+#endif
 };
 void __trace_${trace_name}(struct u_trace *ut
 %    for arg in trace.args:
      , ${arg[0]} ${arg[1]}
 %    endfor
 ) {
-   struct __payload_${trace_name} *__entry =
-      (struct __payload_${trace_name} *)u_trace_append(ut, &__tp_${trace_name});
+   struct trace_${trace_name} *__entry =
+      (struct trace_${trace_name} *)u_trace_append(ut, &__tp_${trace_name});
    (void)__entry;
 %    for member in trace.tp_struct:
         __entry->${member[1]} = ${member[2]};
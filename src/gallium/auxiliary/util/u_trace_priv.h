@@ -43,6 +43,9 @@ struct u_tracepoint {
    unsigned payload_sz;
    const char *name;
    void (*print)(FILE *out, const void *payload);
+#ifdef HAVE_PERFETTO
+   void (*perfetto)(struct pipe_context *pctx, uint64_t ts_ns, const void *payload);
+#endif
 };
 
 /**
@@ -89,4 +89,20 @@ Tracepoint('grid_info',
         '__entry->grid_x', '__entry->grid_y', '__entry->grid_z'],
 )
 
+Tracepoint('blit',
+    args=[['const struct pipe_blit_info *', 'pblit']],
+    tp_struct=[['int16_t',      'src_width',  'pblit->src.box.width'],
+               ['int16_t',      'src_height', 'pblit->src.box.height'],
+               ['int16_t',      'dst_width',  'pblit->dst.box.width'],
+               ['int16_t',      'dst_height', 'pblit->dst.box.height'],
+               ['uint8_t',      'mask',       'pblit->mask'],
+               ['uint8_t',      'filter',     'pblit->filter'],
+               ['const char *', 'src_format', 'util_format_short_name(pblit->src.format)'],
+               ['const char *', 'dst_format', 'util_format_short_name(pblit->dst.format)']],
+    tp_print=['%dx%d (%s) -> %dx%d (%s), mask=0x%x, filter=%u',
+        '__entry->src_width', '__entry->src_height', '__entry->src_format',
+        '__entry->dst_width', '__entry->dst_height', '__entry->dst_format',
+        '__entry->mask', '__entry->filter'],
+)
+
 utrace_generate(cpath=args.src, hpath=args.hdr)
@@ -55,6 +55,15 @@ struct u_upload_mgr {
    unsigned offset; /* Aligned offset to the upload buffer, pointing
                      * at the first unused byte. */
    int buffer_private_refcount;
+
+   /* Filled upload buffers kept for re-use once the GPU is done with them,
+    * oldest first.
+    */
+   struct pipe_resource *ring[U_UPLOAD_MAX_RING_SIZE];
+   unsigned ring_size;      /* Maximum number of kept buffers, 0 if disabled. */
+   unsigned num_ring_buffers;
+
+   struct u_upload_stats stats;
 };
 
 
@@ -147,6 +156,32 @@ u_upload_unmap(struct u_upload_mgr *upload)
 }
 
 
+static void
+u_upload_drop_ring_buffer(struct u_upload_mgr *upload, unsigned i)
+{
+   assert(i < upload->num_ring_buffers);
+
+   pipe_resource_reference(&upload->ring[i], NULL);
+   memmove(&upload->ring[i], &upload->ring[i + 1],
+           (upload->num_ring_buffers - i - 1) * sizeof(upload->ring[0]));
+   upload->num_ring_buffers--;
+}
+
+void
+u_upload_enable_ring(struct u_upload_mgr *upload, unsigned ring_size)
+{
+   upload->ring_size = MIN2(ring_size, U_UPLOAD_MAX_RING_SIZE);
+
+   while (upload->num_ring_buffers > upload->ring_size)
+      u_upload_drop_ring_buffer(upload, 0);
+}
+
+void
+u_upload_get_stats(struct u_upload_mgr *upload, struct u_upload_stats *stats)
+{
+   *stats = upload->stats;
+}
+
 static void
 u_upload_release_buffer(struct u_upload_mgr *upload)
 {
@@ -165,11 +200,71 @@ u_upload_release_buffer(struct u_upload_mgr *upload)
    upload->buffer_size = 0;
 }
 
+/* Like u_upload_release_buffer, but keep the buffer in the ring if enabled. */
+static void
+u_upload_retire_buffer(struct u_upload_mgr *upload)
+{
+   if (upload->ring_size && upload->buffer) {
+      struct pipe_resource *buffer = NULL;
+
+      if (upload->num_ring_buffers == upload->ring_size)
+         u_upload_drop_ring_buffer(upload, 0);
+
+      pipe_resource_reference(&buffer, upload->buffer);
+      upload->ring[upload->num_ring_buffers++] = buffer;
+   }
+
+   u_upload_release_buffer(upload);
+}
+
+/* Take the oldest kept buffer of at least min_size bytes that is neither
+ * referenced elsewhere (e.g. still bound) nor busy on the GPU, and map it.
+ */
+static bool
+u_upload_reuse_ring_buffer(struct u_upload_mgr *upload, unsigned min_size)
+{
+   for (unsigned i = 0; i < upload->num_ring_buffers; i++) {
+      struct pipe_resource *buffer = upload->ring[i];
+
+      if (buffer->width0 < min_size ||
+          p_atomic_read(&buffer->reference.count) != 1)
+         continue;
+
+      /* Without UNSYNCHRONIZED, DONTBLOCK makes the map fail instead of
+       * waiting while the GPU may still read the previous contents.
+       */
+      upload->map = pipe_buffer_map_range(upload->pipe, buffer,
+                                          0, buffer->width0,
+                                          (upload->map_flags &
+                                           ~PIPE_MAP_UNSYNCHRONIZED) |
+                                          PIPE_MAP_DONTBLOCK,
+                                          &upload->transfer);
+      if (!upload->map) {
+         upload->transfer = NULL;
+         upload->stats.buffers_busy++;
+         continue;
+      }
+
+      /* Move the ring's reference to the upload buffer. */
+      upload->buffer = buffer;
+      memmove(&upload->ring[i], &upload->ring[i + 1],
+              (upload->num_ring_buffers - i - 1) * sizeof(upload->ring[0]));
+      upload->num_ring_buffers--;
+
+      upload->stats.buffers_reused++;
+      return true;
+   }
+
+   return false;
+}
+
 
 void
 u_upload_destroy(struct u_upload_mgr *upload)
 {
    u_upload_release_buffer(upload);
+   while (upload->num_ring_buffers)
+      u_upload_drop_ring_buffer(upload, 0);
    FREE(upload);
 }
 
@@ -183,31 +278,37 @@ u_upload_alloc_buffer(struct u_upload_mgr *upload, unsigned min_size)
 
    /* Release the old buffer, if present:
     */
-   u_upload_release_buffer(upload);
+   u_upload_retire_buffer(upload);
 
-   /* Allocate a new one:
-    */
-   size = align(MAX2(upload->default_size, min_size), 4096);
-
-   memset(&buffer, 0, sizeof buffer);
-   buffer.target = PIPE_BUFFER;
-   buffer.format = PIPE_FORMAT_R8_UNORM; /* want TYPELESS or similar */
-   buffer.bind = upload->bind;
-   buffer.usage = upload->usage;
-   buffer.flags = upload->flags | PIPE_RESOURCE_FLAG_SINGLE_THREAD_USE;
-   buffer.width0 = size;
-   buffer.height0 = 1;
-   buffer.depth0 = 1;
-   buffer.array_size = 1;
+   if (u_upload_reuse_ring_buffer(upload, min_size)) {
+      size = upload->buffer->width0;
+   } else {
+      /* Allocate a new one:
+       */
+      size = align(MAX2(upload->default_size, min_size), 4096);
+
+      memset(&buffer, 0, sizeof buffer);
+      buffer.target = PIPE_BUFFER;
+      buffer.format = PIPE_FORMAT_R8_UNORM; /* want TYPELESS or similar */
+      buffer.bind = upload->bind;
+      buffer.usage = upload->usage;
+      buffer.flags = upload->flags | PIPE_RESOURCE_FLAG_SINGLE_THREAD_USE;
+      buffer.width0 = size;
+      buffer.height0 = 1;
+      buffer.depth0 = 1;
+      buffer.array_size = 1;
+
+      if (upload->map_persistent) {
+         buffer.flags |= PIPE_RESOURCE_FLAG_MAP_PERSISTENT |
+                         PIPE_RESOURCE_FLAG_MAP_COHERENT;
+      }
 
-   if (upload->map_persistent) {
-      buffer.flags |= PIPE_RESOURCE_FLAG_MAP_PERSISTENT |
-                      PIPE_RESOURCE_FLAG_MAP_COHERENT;
-   }
+      upload->buffer = screen->resource_create(screen, &buffer);
+      if (upload->buffer == NULL)
+         return 0;
 
-   upload->buffer = screen->resource_create(screen, &buffer);
-   if (upload->buffer == NULL)
-      return 0;
+      upload->stats.buffers_allocated++;
+   }
 
    /* Since atomic operations are very very slow when 2 threads are not
     * sharing the same L3 cache (which happens on AMD Zen), eliminate all
@@ -236,13 +337,15 @@ u_upload_alloc_buffer(struct u_upload_mgr *upload, unsigned min_size)
    assert(upload->buffer_private_refcount < INT32_MAX / 2);
    p_atomic_add(&upload->buffer->reference.count, upload->buffer_private_refcount);
 
-   /* Map the new buffer. */
-   upload->map = pipe_buffer_map_range(upload->pipe, upload->buffer,
-                                       0, size, upload->map_flags,
-                                       &upload->transfer);
-   if (upload->map == NULL) {
-      u_upload_release_buffer(upload);
-      return 0;
+   /* Map the new buffer. Re-used buffers are already mapped. */
+   if (!upload->map) {
+      upload->map = pipe_buffer_map_range(upload->pipe, upload->buffer,
+                                          0, size, upload->map_flags,
+                                          &upload->transfer);
+      if (upload->map == NULL) {
+         u_upload_release_buffer(upload);
+         return 0;
+      }
    }
 
    upload->buffer_size = size;
@@ -42,6 +42,14 @@ struct pipe_resource;
 extern "C" {
 #endif
 
+#define U_UPLOAD_MAX_RING_SIZE 8
+
+struct u_upload_stats {
+   unsigned buffers_allocated; /* upload buffers created */
+   unsigned buffers_reused;    /* kept buffers re-used instead */
+   unsigned buffers_busy;      /* kept buffers skipped as still in use */
+};
+
 /**
  * Create the upload manager.
  *
@@ -73,6 +81,20 @@ u_upload_clone(struct pipe_context *pipe, struct u_upload_mgr *upload);
 void
 u_upload_disable_persistent(struct u_upload_mgr *upload);
 
+/**
+ * Keep up to ring_size filled upload buffers and re-use them once they are
+ * idle, instead of allocating a new buffer every time the current one is
+ * full. A buffer is only re-used when the uploader holds the last
+ * reference to it and mapping it with PIPE_MAP_DONTBLOCK succeeds.
+ * 0 disables the ring, which is the default.
+ */
+void
+u_upload_enable_ring(struct u_upload_mgr *upload, unsigned ring_size);
+
+/** Return the buffer allocation counters of the upload manager. */
+void
+u_upload_get_stats(struct u_upload_mgr *upload, struct u_upload_stats *stats);
+
 /**
  * Destroy the upload manager.
  */
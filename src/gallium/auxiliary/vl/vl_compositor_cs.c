@@ -644,53 +644,44 @@ calc_drawn_area(struct vl_compositor_state *s,
    return result;
 }
 
-static bool
+static void
 set_viewport(struct vl_compositor_state *s,
              struct cs_viewport         *drawn,
              struct pipe_sampler_view **samplers)
 {
-   struct pipe_transfer *buf_transfer;
+   union { float f; int i; } params[12];
+   unsigned n = 0;
 
    assert(s && drawn);
 
-   void *ptr = pipe_buffer_map(s->pipe, s->shader_params,
-                               PIPE_MAP_READ | PIPE_MAP_WRITE,
-                               &buf_transfer);
-
-   if (!ptr)
-     return false;
-
-   float *ptr_float = (float *)ptr;
-   ptr_float += sizeof(vl_csc_matrix)/sizeof(float) + 2;
-   *ptr_float++ = drawn->scale_x;
-   *ptr_float++ = drawn->scale_y;
-
-   int *ptr_int = (int *)ptr_float;
-   *ptr_int++ = drawn->area.x0;
-   *ptr_int++ = drawn->area.y0;
-   *ptr_int++ = drawn->area.x1;
-   *ptr_int++ = drawn->area.y1;
-   *ptr_int++ = drawn->translate_x;
-   *ptr_int++ = drawn->translate_y;
-
-   ptr_float = (float *)ptr_int;
-   *ptr_float++ = drawn->sampler0_w;
-   *ptr_float++ = drawn->sampler0_h;
+   params[n++].f = drawn->scale_x;
+   params[n++].f = drawn->scale_y;
+   params[n++].i = drawn->area.x0;
+   params[n++].i = drawn->area.y0;
+   params[n++].i = drawn->area.x1;
+   params[n++].i = drawn->area.y1;
+   params[n++].i = drawn->translate_x;
+   params[n++].i = drawn->translate_y;
+   params[n++].f = drawn->sampler0_w;
+   params[n++].f = drawn->sampler0_h;
 
    /* compute_shader_video_buffer uses pixel coordinates based on the
     * Y sampler dimensions. If U/V are using separate planes and are
     * subsampled, we need to scale the coordinates */
    if (samplers[1]) {
-      float h_ratio = samplers[1]->texture->width0 /
-                     (float) samplers[0]->texture->width0;
-      *ptr_float++ = h_ratio;
-      float v_ratio = samplers[1]->texture->height0 /
-                     (float) samplers[0]->texture->height0;
-      *ptr_float++ = v_ratio;
+      params[n++].f = samplers[1]->texture->width0 /
+                      (float) samplers[0]->texture->width0;
+      params[n++].f = samplers[1]->texture->height0 /
+                      (float) samplers[0]->texture->height0;
    }
-   pipe_buffer_unmap(s->pipe, buf_transfer);
 
-   return true;
+   /* Only the viewport part after the CSC matrix and luma range changes
+    * between layers and planes. Write it as a subrange instead of mapping
+    * the buffer for reading, which waits for the previous dispatch.
+    */
+   pipe_buffer_write(s->pipe, s->shader_params,
+                     sizeof(vl_csc_matrix) + 2 * sizeof(float),
+                     n * sizeof(params[0]), params);
 }
 
 static void
@@ -731,15 +722,6 @@ draw_layers(struct vl_compositor       *c,
 
          cs_launch(c, layer->cs, &(drawn.area));
 
-         /* Unbind. */
-         c->pipe->set_shader_images(c->pipe, PIPE_SHADER_COMPUTE, 0, 0, 1, NULL);
-         c->pipe->set_constant_buffer(c->pipe, PIPE_SHADER_COMPUTE, 0, false, NULL);
-         c->pipe->set_sampler_views(c->pipe, PIPE_SHADER_FRAGMENT, 0, 0,
-                        num_sampler_views, NULL);
-         c->pipe->bind_compute_state(c->pipe, NULL);
-         c->pipe->bind_sampler_states(c->pipe, PIPE_SHADER_COMPUTE, 0,
-                        num_sampler_views, NULL);
-
          if (dirty) {
             struct u_rect drawn = calc_drawn_area(s, layer);
             dirty->x0 = MIN2(drawn.x0, dirty->x0);
@@ -749,6 +731,15 @@ draw_layers(struct vl_compositor       *c,
          }
       }
    }
+
+   /* Unbind once all layers are drawn, so later layers keep the constant
+    * buffer bound by vl_compositor_cs_render().
+    */
+   c->pipe->set_shader_images(c->pipe, PIPE_SHADER_COMPUTE, 0, 0, 1, NULL);
+   c->pipe->set_constant_buffer(c->pipe, PIPE_SHADER_COMPUTE, 0, false, NULL);
+   c->pipe->set_sampler_views(c->pipe, PIPE_SHADER_COMPUTE, 0, 0, 3, NULL);
+   c->pipe->bind_compute_state(c->pipe, NULL);
+   c->pipe->bind_sampler_states(c->pipe, PIPE_SHADER_COMPUTE, 0, 3, NULL);
 }
 
 void *
@@ -25,6 +25,7 @@
 #define D3D12_CONTEXT_H
 
 #include "d3d12_batch.h"
+#include "d3d12_compiler.h"
 #include "d3d12_descriptor_pool.h"
 #include "d3d12_pipeline_state.h"
 #include "d3d12_nir_lower_texcmp.h"
@@ -204,6 +205,8 @@ struct d3d12_context {
    unsigned shader_dirty[D3D12_GFX_SHADER_STAGES];
    unsigned state_dirty;
    unsigned cmdlist_dirty;
+   uint32_t state_vars[D3D12_GFX_SHADER_STAGES][D3D12_MAX_STATE_VARS * 4];
+   unsigned state_vars_size[D3D12_GFX_SHADER_STAGES];
    ID3D12PipelineState *current_pso;
    bool reverse_depth_range;
 
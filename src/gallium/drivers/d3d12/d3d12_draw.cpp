@@ -211,14 +211,19 @@ check_descriptors_left(struct d3d12_context *ctx)
    struct d3d12_batch *batch = d3d12_current_batch(ctx);
    unsigned needed_descs = 0;
 
+   /* Only tables that set_graphics_root_parameters() is going to rewrite
+    * consume heap space, so don't flush for stages whose bindings are clean.
+    */
    for (unsigned i = 0; i < D3D12_GFX_SHADER_STAGES; ++i) {
       struct d3d12_shader_selector *shader = ctx->gfx_stages[i];
 
       if (!shader)
          continue;
 
-      needed_descs += shader->current->num_cb_bindings;
-      needed_descs += shader->current->num_srv_bindings;
+      if (ctx->shader_dirty[i] & D3D12_SHADER_DIRTY_CONSTBUF)
+         needed_descs += shader->current->num_cb_bindings;
+      if (ctx->shader_dirty[i] & D3D12_SHADER_DIRTY_SAMPLER_VIEWS)
+         needed_descs += shader->current->num_srv_bindings;
    }
 
    if (d3d12_descriptor_heap_get_remaining_handles(batch->view_heap) < needed_descs)
@@ -231,7 +236,8 @@ check_descriptors_left(struct d3d12_context *ctx)
       if (!shader)
          continue;
 
-      needed_descs += shader->current->num_srv_bindings;
+      if (ctx->shader_dirty[i] & D3D12_SHADER_DIRTY_SAMPLERS)
+         needed_descs += shader->current->num_srv_bindings;
    }
 
    if (d3d12_descriptor_heap_get_remaining_handles(batch->sampler_heap) < needed_descs)
@@ -269,11 +275,19 @@ set_graphics_root_parameters(struct d3d12_context *ctx,
             ctx->cmdlist->SetGraphicsRootDescriptorTable(num_params, fill_sampler_descriptors(ctx, shader_sel, i));
          num_params++;
       }
-      /* TODO Don't always update state vars */
+      /* Root constants survive until the root signature is rebound, so only
+       * upload state vars when they changed since the last draw.
+       */
       if (shader->num_state_vars > 0) {
          uint32_t constants[D3D12_MAX_STATE_VARS * 4];
          unsigned size = fill_state_vars(ctx, dinfo, draw, shader, constants);
-         ctx->cmdlist->SetGraphicsRoot32BitConstants(num_params, size, constants, 0);
+         if (ctx->cmdlist_dirty & D3D12_DIRTY_ROOT_SIGNATURE ||
+             ctx->state_vars_size[i] != size ||
+             memcmp(ctx->state_vars[i], constants, size * sizeof(uint32_t))) {
+            ctx->cmdlist->SetGraphicsRoot32BitConstants(num_params, size, constants, 0);
+            memcpy(ctx->state_vars[i], constants, size * sizeof(uint32_t));
+            ctx->state_vars_size[i] = size;
+         }
          num_params++;
       }
    }
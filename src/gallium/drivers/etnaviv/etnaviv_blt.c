@@ -247,6 +247,7 @@ etna_blit_clear_color_blt(struct pipe_context *pctx, struct pipe_surface *dst,
    clr.rect_h = surf->surf.height;
 
    emit_blt_clearimage(ctx->stream, &clr);
+   ctx->stats.blt_operations++;
 
    /* This made the TS valid */
    if (surf->surf.ts_size) {
@@ -326,6 +327,7 @@ etna_blit_clear_zs_blt(struct pipe_context *pctx, struct pipe_surface *dst,
    clr.rect_h = surf->surf.height;
 
    emit_blt_clearimage(ctx->stream, &clr);
+   ctx->stats.blt_operations++;
 
    /* This made the TS valid */
    if (surf->surf.ts_size) {
@@ -436,6 +438,8 @@ etna_try_blt_blit(struct pipe_context *pctx,
    }
 
    mtx_lock(&ctx->lock);
+   ctx->stats.blt_operations++;
+
    /* Kick off BLT here */
    if (src == dst && src_lev->ts_compress_fmt < 0) {
       /* Resolve-in-place */
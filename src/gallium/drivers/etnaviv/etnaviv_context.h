@@ -187,6 +187,7 @@ struct etna_context {
       uint64_t prims_generated;
       uint64_t draw_calls;
       uint64_t rs_operations;
+      uint64_t blt_operations;
    } stats;
 
    struct pipe_debug_callback debug;
@@ -446,6 +446,29 @@ flush_write_batch(struct fd_resource *rsc)
 	fd_batch_reference_locked(&b, NULL);
 }
 
+/* Can the reader depend on the pending writer, rather than flushing it? */
+static bool
+can_defer_write_batch(struct fd_batch *batch, struct fd_batch *write_batch)
+	assert_dt
+{
+	struct fd_context *ctx = batch->ctx;
+
+	if (!ctx->screen->reorder)
+		return false;
+
+	/* Flushing another context's batch from here is only safe as an
+	 * immediate flush, and the context's current batch would keep
+	 * receiving draws that the reader must not see.
+	 */
+	if (write_batch->ctx != ctx || write_batch == ctx->batch)
+		return false;
+
+	if (batch->dependents_mask & (1 << write_batch->idx))
+		return true;
+
+	return !((1 << batch->idx) & recursive_dependents_mask(write_batch));
+}
+
 static void
 fd_batch_add_resource(struct fd_batch *batch, struct fd_resource *rsc)
 {
@@ -521,12 +544,28 @@ fd_batch_resource_read_slowpath(struct fd_batch *batch, struct fd_resource *rsc)
 
 	DBG("%p: read %p", batch, rsc);
 
-	/* If reading a resource pending a write, go ahead and flush the
-	 * writer.  This avoids situations where we end up having to
-	 * flush the current batch in _resource_used()
+	/* If reading a resource pending a write, the writer has to run first.
+	 * When reordering, that is just a dependency, so apps ping-ponging
+	 * between render targets don't force a flush (and with it a resolve
+	 * and a later restore) every time they switch.  Otherwise, or if the
+	 * dependency would create a loop, go ahead and flush the writer.
 	 */
-	if (unlikely(rsc->track->write_batch && rsc->track->write_batch != batch))
-		flush_write_batch(rsc);
+	struct fd_batch *write_batch = rsc->track->write_batch;
+	if (unlikely(write_batch && write_batch != batch)) {
+		if (can_defer_write_batch(batch, write_batch)) {
+			struct fd_batch *b = NULL;
+			fd_batch_reference_locked(&b, write_batch);
+			fd_batch_add_dep(batch, b);
+			/* Later draws to the writer's framebuffer must go to a new
+			 * batch, which the reader won't be ordered after:
+			 */
+			fd_bc_invalidate_batch(b, false);
+			fd_batch_reference_locked(&b, NULL);
+			batch->ctx->stats.deferred_flushes++;
+		} else {
+			flush_write_batch(rsc);
+		}
+	}
 
 	fd_batch_add_resource(batch, rsc);
 }
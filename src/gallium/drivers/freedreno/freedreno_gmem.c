@@ -666,6 +666,71 @@ flush_ring(struct fd_batch *batch)
 	fd_fence_populate(batch->fence, timestamp, out_fence_fd);
 }
 
+/* Estimate of the average fraction of the render target covered by a draw,
+ * in 1/16ths.
+ */
+#define DRAW_COVERAGE 4
+
+/* Bytes of vertex data re-read by the binning pass per vertex. */
+#define BINNING_BYTES_PER_VERTEX 16
+
+static void
+estimate_buffer_cost(struct fd_batch *batch, struct pipe_surface *psurf,
+		uint32_t mask, bool reads, uint64_t *gmem, uint64_t *sysmem)
+{
+	struct pipe_framebuffer_state *pfb = &batch->framebuffer;
+
+	if (!psurf || !(batch->resolve & mask))
+		return;
+
+	uint64_t size = (uint64_t)pfb->width * pfb->height *
+			util_format_get_blocksize(psurf->format);
+
+	/* With GMEM, the buffer is loaded into each tile unless it was cleared
+	 * or invalidated, and stored back at the end.
+	 */
+	if (batch->restore & mask)
+		*gmem += size;
+	*gmem += size;
+
+	/* Rendering directly to memory pays for the clear, and for every
+	 * draw touching the buffer, twice if the draw also reads it back
+	 * (blending, depth/stencil test).
+	 */
+	if (batch->cleared & mask)
+		*sysmem += size;
+	*sysmem += size * batch->num_draws * DRAW_COVERAGE * (reads ? 2 : 1) / 16;
+}
+
+/* Compare the estimated memory traffic of rendering the batch through GMEM
+ * (tile loads and stores, plus the binning pass) with rendering it straight
+ * to system memory.  Only meaningful on a6xx, where sysmem rendering has the
+ * same capabilities as GMEM rendering.
+ */
+static bool
+sysmem_is_cheaper(struct fd_batch *batch)
+{
+	struct pipe_framebuffer_state *pfb = &batch->framebuffer;
+	uint64_t gmem = (uint64_t)batch->num_vertices * BINNING_BYTES_PER_VERTEX;
+	uint64_t sysmem = 0;
+
+	bool color_reads = batch->gmem_reason &
+			(FD_GMEM_BLEND_ENABLED | FD_GMEM_LOGICOP_ENABLED);
+	for (unsigned i = 0; i < pfb->nr_cbufs; i++) {
+		estimate_buffer_cost(batch, pfb->cbufs[i], PIPE_CLEAR_COLOR0 << i,
+				color_reads, &gmem, &sysmem);
+	}
+
+	bool zs_reads = batch->gmem_reason &
+			(FD_GMEM_DEPTH_ENABLED | FD_GMEM_STENCIL_ENABLED);
+	estimate_buffer_cost(batch, pfb->zsbuf, FD_BUFFER_DEPTH | FD_BUFFER_STENCIL,
+			zs_reads, &gmem, &sysmem);
+
+	trace_render_cost(&batch->trace, gmem / 1024, sysmem / 1024);
+
+	return sysmem < gmem;
+}
+
 void
 fd_gmem_render_tiles(struct fd_batch *batch)
 {
@@ -680,9 +745,12 @@ fd_gmem_render_tiles(struct fd_batch *batch)
 	}
 
 	if (ctx->emit_sysmem_prep && !batch->nondraw) {
-		if (batch->cleared || batch->gmem_reason ||
-				((batch->num_draws > 5) && !batch->blit) ||
-				(pfb->samples > 1)) {
+		if ((batch->gmem_reason & FD_GMEM_FB_READ) || (pfb->samples > 1)) {
+		} else if (is_a6xx(ctx->screen)) {
+			if (sysmem_is_cheaper(batch) && !FD_DBG(NOBYPASS))
+				sysmem = true;
+		} else if (batch->cleared || batch->gmem_reason ||
+				((batch->num_draws > 5) && !batch->blit)) {
 		} else if (!FD_DBG(NOBYPASS)) {
 			sysmem = true;
 		}
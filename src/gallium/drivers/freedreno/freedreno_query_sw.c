@@ -68,6 +68,8 @@ read_counter(struct fd_context *ctx, int type)
 		return ctx->stats.batch_nondraw;
 	case FD_QUERY_BATCH_RESTORE:
 		return ctx->stats.batch_restore;
+	case FD_QUERY_DEFERRED_FLUSHES:
+		return ctx->stats.deferred_flushes;
 	case FD_QUERY_STAGING_UPLOADS:
 		return ctx->stats.staging_uploads;
 	case FD_QUERY_SHADOW_UPLOADS:
@@ -89,6 +91,7 @@ is_time_rate_query(struct fd_query *q)
 	case FD_QUERY_BATCH_GMEM:
 	case FD_QUERY_BATCH_NONDRAW:
 	case FD_QUERY_BATCH_RESTORE:
+	case FD_QUERY_DEFERRED_FLUSHES:
 	case FD_QUERY_STAGING_UPLOADS:
 	case FD_QUERY_SHADOW_UPLOADS:
 		return true;
@@ -185,6 +188,7 @@ fd_sw_create_query(struct fd_context *ctx, unsigned query_type, unsigned index)
 	case FD_QUERY_BATCH_GMEM:
 	case FD_QUERY_BATCH_NONDRAW:
 	case FD_QUERY_BATCH_RESTORE:
+	case FD_QUERY_DEFERRED_FLUSHES:
 	case FD_QUERY_STAGING_UPLOADS:
 	case FD_QUERY_SHADOW_UPLOADS:
 	case FD_QUERY_VS_REGS:
@@ -94,6 +94,7 @@ static const struct debug_named_value fd_debug_options[] = {
 		{"layout",    FD_DBG_LAYOUT, "Dump resource layouts"},
 		{"nofp16",    FD_DBG_NOFP16, "Disable mediump precision lowering"},
 		{"nohw",      FD_DBG_NOHW,   "Disable submitting commands to the HW"},
+		{"noprewarm", FD_DBG_NOPREWARM, "Disable pre-compiling likely draw-time shader variants"},
 		DEBUG_NAMED_VALUE_END
 };
 
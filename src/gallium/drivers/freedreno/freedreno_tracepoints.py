@@ -69,6 +69,12 @@ Tracepoint('render_gmem',
 
 Tracepoint('render_sysmem')
 
+Tracepoint('render_cost',
+    args=[['uint32_t', 'gmem_kb'],
+          ['uint32_t', 'sysmem_kb']],
+    tp_print=['gmem=%ukb, sysmem=%ukb', '__entry->gmem_kb', '__entry->sysmem_kb'],
+)
+
 Tracepoint('start_binning_ib')
 Tracepoint('end_binning_ib')
 
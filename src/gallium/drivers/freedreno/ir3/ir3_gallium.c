@@ -249,6 +249,27 @@ create_initial_variants(struct ir3_shader_state *hwcso,
 		}
 	}
 
+	/* Pre-warm the fragment shader permutations which are commonly hit at
+	 * draw time (single-sampled rendering and flat-shaded colors).  Key
+	 * bits the shader doesn't depend on are cleared in ir3_shader_variant(),
+	 * so for most shaders these just find the variant compiled above.  The
+	 * compiled variants also land in the disk cache, so the next run gets
+	 * them for free.  Skipped for shader-db, which only wants the standard
+	 * variants.
+	 */
+	if ((nir->info.stage == MESA_SHADER_FRAGMENT) &&
+			!FD_DBG(NOPREWARM) && !FD_DBG(SHADERDB)) {
+		struct ir3_shader_key prewarm_key = key;
+
+		prewarm_key.safe_constlen = false;
+		prewarm_key.msaa = false;
+		ir3_shader_variant(shader, prewarm_key, false, debug);
+
+		prewarm_key.msaa = true;
+		prewarm_key.rasterflat = true;
+		ir3_shader_variant(shader, prewarm_key, false, debug);
+	}
+
 	shader->initial_variants_done = true;
 }
 
@@ -533,7 +554,8 @@ ir3_screen_init(struct pipe_screen *pscreen)
 
 	util_queue_init(&screen->compile_queue, "ir3q", 64, num_threads,
 			UTIL_QUEUE_INIT_RESIZE_IF_FULL |
-			UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY);
+			UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY |
+			UTIL_QUEUE_INIT_SHARED_THREADS);
 
 	pscreen->finalize_nir = ir3_screen_finalize_nir;
 	pscreen->set_max_shader_compiler_threads =
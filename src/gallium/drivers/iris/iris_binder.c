@@ -48,6 +48,7 @@
  */
 
 #include <stdlib.h>
+#include "util/hash_table.h"
 #include "util/u_math.h"
 #include "iris_binder.h"
 #include "iris_bufmgr.h"
@@ -91,6 +92,9 @@ binder_realloc(struct iris_context *ice)
    binder->map = iris_bo_map(NULL, binder->bo, MAP_WRITE);
    binder->insert_point = INIT_INSERT_POINT;
 
+   /* Tables written to the old binder can't be referenced from the new one. */
+   _mesa_hash_table_u64_clear(binder->bt_cache, NULL);
+
    /* Allocating a new binder requires changing Surface State Base Address,
     * which also invalidates all our previous binding tables - each entry
     * in those tables is an offset from the old base.
@@ -210,15 +214,54 @@ iris_binder_reserve_compute(struct iris_context *ice)
    binder->bt_offset[MESA_SHADER_COMPUTE] = iris_binder_reserve(ice, size);
 }
 
+/**
+ * Point a freshly populated binding table at an identical earlier copy.
+ *
+ * Most draws rebind the same surfaces, so the table just written for
+ * \p stage (\p size bytes at bt_offset[stage]) often matches one already
+ * in this binder.  If so, use the existing table instead, and give the
+ * space back when the new one was the most recent allocation.  This keeps
+ * the binder from filling up, so we reallocate it (and re-emit
+ * STATE_BASE_ADDRESS, with its stalls) far less often.
+ */
+void
+iris_binder_reuse_table(struct iris_binder *binder,
+                        gl_shader_stage stage, unsigned size)
+{
+   uint32_t offset = binder->bt_offset[stage];
+
+   if (offset == 0 || size == 0)
+      return;
+
+   const void *table = binder->map + offset;
+   uint64_t key = (uint64_t) size << 32 | _mesa_hash_data(table, size);
+   uint32_t prev = (uintptr_t) _mesa_hash_table_u64_search(binder->bt_cache,
+                                                           key);
+
+   if (prev != 0 && prev != offset &&
+       memcmp(binder->map + prev, table, size) == 0) {
+      if (align(offset + size, BTP_ALIGNMENT) == binder->insert_point)
+         binder->insert_point = offset;
+
+      binder->bt_offset[stage] = prev;
+      return;
+   }
+
+   _mesa_hash_table_u64_insert(binder->bt_cache, key,
+                               (void *) (uintptr_t) offset);
+}
+
 void
 iris_init_binder(struct iris_context *ice)
 {
    memset(&ice->state.binder, 0, sizeof(struct iris_binder));
+   ice->state.binder.bt_cache = _mesa_hash_table_u64_create(NULL);
    binder_realloc(ice);
 }
 
 void
 iris_destroy_binder(struct iris_binder *binder)
 {
+   _mesa_hash_table_u64_destroy(binder->bt_cache, NULL);
    iris_bo_unreference(binder->bo);
 }
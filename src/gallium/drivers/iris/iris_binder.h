@@ -33,6 +33,7 @@ struct iris_batch;
 struct iris_bufmgr;
 struct iris_compiled_shader;
 struct iris_context;
+struct hash_table_u64;
 
 struct iris_binder
 {
@@ -47,6 +48,12 @@ struct iris_binder
     * Zero is considered invalid and means there's no binding table.
     */
    uint32_t bt_offset[MESA_SHADER_STAGES];
+
+   /**
+    * Binding tables already written to this binder, keyed on a hash of
+    * their contents, so identical tables can be shared between draws.
+    */
+   struct hash_table_u64 *bt_cache;
 };
 
 void iris_init_binder(struct iris_context *ice);
@@ -54,5 +61,7 @@ void iris_destroy_binder(struct iris_binder *binder);
 uint32_t iris_binder_reserve(struct iris_context *ice, unsigned size);
 void iris_binder_reserve_3d(struct iris_context *ice);
 void iris_binder_reserve_compute(struct iris_context *ice);
+void iris_binder_reuse_table(struct iris_binder *binder,
+                             gl_shader_stage stage, unsigned size);
 
 #endif
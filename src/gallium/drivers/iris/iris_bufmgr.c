@@ -161,6 +161,13 @@ struct iris_bufmgr {
    int num_buckets;
    time_t time;
 
+   /** BO cache statistics, reported at exit with INTEL_DEBUG=bufmgr */
+   struct {
+      uint64_t hits;
+      uint64_t misses;
+      uint64_t purged;
+   } cache_stats;
+
    struct hash_table *name_table;
    struct hash_table *handle_table;
 
@@ -385,7 +392,6 @@ alloc_bo_from_cache(struct iris_bufmgr *bufmgr,
                     struct bo_cache_bucket *bucket,
                     uint32_t alignment,
                     enum iris_memory_zone memzone,
-                    unsigned flags,
                     bool match_zone)
 {
    if (!bucket)
@@ -414,6 +420,7 @@ alloc_bo_from_cache(struct iris_bufmgr *bufmgr,
       }
 
       /* This BO was purged, throw it out and keep looking. */
+      bufmgr->cache_stats.purged++;
       bo_free(cur);
    }
 
@@ -443,19 +450,6 @@ alloc_bo_from_cache(struct iris_bufmgr *bufmgr,
       bo->gtt_offset = 0ull;
    }
 
-   /* Zero the contents if necessary.  If this fails, fall back to
-    * allocating a fresh BO, which will always be zeroed by the kernel.
-    */
-   if (flags & BO_ALLOC_ZEROED) {
-      void *map = iris_bo_map(NULL, bo, MAP_WRITE | MAP_RAW);
-      if (map) {
-         memset(map, 0, bo->size);
-      } else {
-         bo_free(bo);
-         return NULL;
-      }
-   }
-
    return bo;
 }
 
@@ -526,16 +520,37 @@ bo_alloc_internal(struct iris_bufmgr *bufmgr,
    /* Get a buffer out of the cache if available.  First, we try to find
     * one with a matching memory zone so we can avoid reallocating VMA.
     */
-   bo = alloc_bo_from_cache(bufmgr, bucket, alignment, memzone, flags, true);
+   bo = alloc_bo_from_cache(bufmgr, bucket, alignment, memzone, true);
 
    /* If that fails, we try for any cached BO, without matching memzone. */
-   if (!bo) {
-      bo = alloc_bo_from_cache(bufmgr, bucket, alignment, memzone, flags,
-                               false);
-   }
+   if (!bo)
+      bo = alloc_bo_from_cache(bufmgr, bucket, alignment, memzone, false);
+
+   if (bo)
+      bufmgr->cache_stats.hits++;
+   else if (bucket)
+      bufmgr->cache_stats.misses++;
 
    mtx_unlock(&bufmgr->lock);
 
+   /* Zero the contents if necessary.  This is done outside the lock, as
+    * clearing a large buffer can take a while and would otherwise stall
+    * every other thread allocating or freeing BOs.  If mapping fails,
+    * fall back to allocating a fresh BO, which will always be zeroed by
+    * the kernel.
+    */
+   if (bo && (flags & BO_ALLOC_ZEROED)) {
+      void *map = iris_bo_map(NULL, bo, MAP_WRITE | MAP_RAW);
+      if (map) {
+         memset(map, 0, bo->size);
+      } else {
+         mtx_lock(&bufmgr->lock);
+         bo_free(bo);
+         mtx_unlock(&bufmgr->lock);
+         bo = NULL;
+      }
+   }
+
    if (!bo) {
       bo = alloc_fresh_bo(bufmgr, bo_size);
       if (!bo)
@@ -1306,6 +1321,11 @@ iris_bufmgr_destroy(struct iris_bufmgr *bufmgr)
    /* bufmgr will no longer try to free VMA entries in the aux-map */
    bufmgr->aux_map_ctx = NULL;
 
+   DBG("BO cache: %llu hits, %llu misses, %llu purged\n",
+       (unsigned long long) bufmgr->cache_stats.hits,
+       (unsigned long long) bufmgr->cache_stats.misses,
+       (unsigned long long) bufmgr->cache_stats.purged);
+
    mtx_destroy(&bufmgr->lock);
 
    /* Free any cached buffer objects we were going to reuse */
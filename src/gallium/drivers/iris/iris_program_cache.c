@@ -90,11 +90,29 @@ iris_find_cached_shader(struct iris_context *ice,
                         uint32_t key_size,
                         const void *key)
 {
-   struct keybox *keybox = make_keybox(NULL, cache_id, key, key_size);
+   /* BLORP looks up its shader on every blit and clear, so build the
+    * lookup keybox on the stack rather than allocating one each time.
+    */
+   union {
+      struct keybox keybox;
+      uint8_t data[sizeof(struct keybox) + 256];
+   } stack_keybox;
+   struct keybox *keybox;
+
+   if (key_size <= sizeof(stack_keybox.data) - sizeof(struct keybox)) {
+      keybox = &stack_keybox.keybox;
+      keybox->cache_id = cache_id;
+      keybox->size = key_size;
+      memcpy(keybox->data, key, key_size);
+   } else {
+      keybox = make_keybox(NULL, cache_id, key, key_size);
+   }
+
    struct hash_entry *entry =
       _mesa_hash_table_search(ice->shaders.cache, keybox);
 
-   ralloc_free(keybox);
+   if (keybox != &stack_keybox.keybox)
+      ralloc_free(keybox);
 
    return entry ? entry->data : NULL;
 }
@@ -1750,7 +1750,8 @@ iris_unmap_tiled_memcpy(struct iris_transfer *map)
 
          isl_memcpy_linear_to_tiled(x1, x2, y1, y2, dst, ptr,
                                     surf->row_pitch_B, xfer->stride,
-                                    has_swizzling, surf->tiling, ISL_MEMCPY);
+                                    has_swizzling, surf->tiling,
+                                    ISL_MEMCPY_STREAMING_STORE);
       }
    }
    os_free_aligned(map->buffer);
@@ -2135,7 +2136,8 @@ iris_texture_subdata(struct pipe_context *ctx,
          isl_memcpy_linear_to_tiled(x1, x2, y1, y2,
                                     (void *)dst, (void *)src,
                                     surf->row_pitch_B, stride,
-                                    false, surf->tiling, ISL_MEMCPY);
+                                    false, surf->tiling,
+                                    ISL_MEMCPY_STREAMING_STORE);
       }
    }
 }
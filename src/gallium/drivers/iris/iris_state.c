@@ -5040,6 +5040,9 @@ iris_populate_binding_table(struct iris_context *ice,
       bt_assert(plane_start[1], ...);
       bt_assert(plane_start[2], ...);
 #endif
+
+   if (!pin_only)
+      iris_binder_reuse_table(&ice->state.binder, stage, s * sizeof(uint32_t));
 }
 
 static void
@@ -5805,6 +5808,15 @@ iris_upload_dirty_render_state(struct iris_context *ice,
       emit_push_constant_packet_all(ice, batch, nobuffer_stages, NULL);
 #endif
 
+   /* Populate the tables before pointing at them, as a table identical to
+    * one already in the binder is replaced by that earlier copy.
+    */
+   for (int stage = 0; stage <= MESA_SHADER_FRAGMENT; stage++) {
+      if (stage_dirty & (IRIS_STAGE_DIRTY_BINDINGS_VS << stage)) {
+         iris_populate_binding_table(ice, batch, stage, false);
+      }
+   }
+
    for (int stage = 0; stage <= MESA_SHADER_FRAGMENT; stage++) {
       /* Gen9 requires 3DSTATE_BINDING_TABLE_POINTERS_XS to be re-emitted
        * in order to commit constants.  TODO: Investigate "Disable Gather
@@ -5838,12 +5850,6 @@ iris_upload_dirty_render_state(struct iris_context *ice,
                                    PIPE_CONTROL_STALL_AT_SCOREBOARD);
    }
 
-   for (int stage = 0; stage <= MESA_SHADER_FRAGMENT; stage++) {
-      if (stage_dirty & (IRIS_STAGE_DIRTY_BINDINGS_VS << stage)) {
-         iris_populate_binding_table(ice, batch, stage, false);
-      }
-   }
-
    for (int stage = 0; stage <= MESA_SHADER_FRAGMENT; stage++) {
       if (!(stage_dirty & (IRIS_STAGE_DIRTY_SAMPLER_STATES_VS << stage)) ||
           !ice->shaders.prog[stage])
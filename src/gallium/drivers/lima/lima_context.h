@@ -271,6 +271,12 @@ struct lima_context {
 
    unsigned index_offset;
    struct lima_resource *index_res;
+
+   /* stats/counters for driver queries */
+   struct {
+      uint64_t jobs;
+      uint64_t job_submit_ns;
+   } stats;
 };
 
 static inline struct lima_context *
@@ -311,6 +317,11 @@ void lima_draw_init(struct lima_context *ctx);
 void lima_program_init(struct lima_context *ctx);
 void lima_program_fini(struct lima_context *ctx);
 void lima_query_init(struct lima_context *ctx);
+int lima_get_driver_query_info(struct pipe_screen *pscreen, unsigned index,
+                               struct pipe_driver_query_info *info);
+
+#define LIMA_QUERY_JOBS            (PIPE_QUERY_DRIVER_SPECIFIC + 0)
+#define LIMA_QUERY_JOB_SUBMIT_TIME (PIPE_QUERY_DRIVER_SPECIFIC + 1)
 
 struct pipe_context *
 lima_context_create(struct pipe_screen *pscreen, void *priv, unsigned flags);
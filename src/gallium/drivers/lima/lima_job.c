@@ -884,6 +884,7 @@ lima_do_job(struct lima_job *job)
    #define pp_stack_pp_size 0x400
 
    struct lima_context *ctx = job->ctx;
+   int64_t start = os_time_get_nano();
 
    lima_pack_head_plbu_cmd(job);
    lima_finish_plbu_cmd(&job->plbu_cmd_array);
@@ -1024,6 +1025,9 @@ lima_do_job(struct lima_job *job)
 
    ctx->plb_index = (ctx->plb_index + 1) % lima_ctx_num_plb;
 
+   ctx->stats.jobs++;
+   ctx->stats.job_submit_ns += os_time_get_nano() - start;
+
    /* Set reload flags for next draw. It'll be unset if buffer is cleared */
    if (job->key.cbuf && (job->resolve & PIPE_CLEAR_COLOR0)) {
       struct lima_surface *surf = lima_surface(job->key.cbuf);
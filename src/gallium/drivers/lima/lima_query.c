@@ -23,27 +23,49 @@
  */
 
 /**
- * Stub support for occlusion queries.
+ * Stub support for occlusion queries, plus a few software counters.
  *
  * Since we expose support for GL 2.0, we have to expose occlusion queries,
  * but the spec allows you to expose 0 query counter bits, so we just return 0
  * as the result of all our queries.
+ *
+ * The driver-specific queries report job statistics collected in
+ * lima_do_job(), so flush-heavy workloads can be spotted with e.g.
+ * GALLIUM_HUD.
  */
 
 #include "util/u_debug.h"
+#include "util/u_memory.h"
 
 #include "lima_context.h"
 
 struct lima_query
 {
-   uint8_t pad;
+   unsigned type;
+   uint64_t begin_value, end_value;
 };
 
+static uint64_t
+lima_read_counter(struct lima_context *ctx, unsigned type)
+{
+   switch (type) {
+   case LIMA_QUERY_JOBS:
+      return ctx->stats.jobs;
+   case LIMA_QUERY_JOB_SUBMIT_TIME:
+      return ctx->stats.job_submit_ns / 1000;
+   }
+
+   return 0;
+}
+
 static struct pipe_query *
 lima_create_query(struct pipe_context *ctx, unsigned query_type, unsigned index)
 {
    struct lima_query *query = calloc(1, sizeof(*query));
 
+   if (query)
+      query->type = query_type;
+
    /* Note that struct pipe_query isn't actually defined anywhere. */
    return (struct pipe_query *)query;
 }
@@ -55,24 +77,31 @@ lima_destroy_query(struct pipe_context *ctx, struct pipe_query *query)
 }
 
 static bool
-lima_begin_query(struct pipe_context *ctx, struct pipe_query *query)
+lima_begin_query(struct pipe_context *pctx, struct pipe_query *pquery)
 {
+   struct lima_query *query = (struct lima_query *)pquery;
+
+   query->begin_value = lima_read_counter(lima_context(pctx), query->type);
    return true;
 }
 
 static bool
-lima_end_query(struct pipe_context *ctx, struct pipe_query *query)
+lima_end_query(struct pipe_context *pctx, struct pipe_query *pquery)
 {
+   struct lima_query *query = (struct lima_query *)pquery;
+
+   query->end_value = lima_read_counter(lima_context(pctx), query->type);
    return true;
 }
 
 static bool
-lima_get_query_result(struct pipe_context *ctx, struct pipe_query *query,
+lima_get_query_result(struct pipe_context *ctx, struct pipe_query *pquery,
                      bool wait, union pipe_query_result *vresult)
 {
+   struct lima_query *query = (struct lima_query *)pquery;
    uint64_t *result = &vresult->u64;
 
-   *result = 0;
+   *result = query->end_value - query->begin_value;
 
    return true;
 }
@@ -94,3 +123,24 @@ lima_query_init(struct lima_context *pctx)
    pctx->base.set_active_query_state = lima_set_active_query_state;
 }
 
+
+static const struct pipe_driver_query_info lima_driver_queries[] = {
+   {"jobs", LIMA_QUERY_JOBS, { 0 }},
+   {"job-submit-time", LIMA_QUERY_JOB_SUBMIT_TIME, { 0 },
+    PIPE_DRIVER_QUERY_TYPE_MICROSECONDS},
+};
+
+int
+lima_get_driver_query_info(struct pipe_screen *pscreen, unsigned index,
+                           struct pipe_driver_query_info *info)
+{
+   if (!info)
+      return ARRAY_SIZE(lima_driver_queries);
+
+   if (index >= ARRAY_SIZE(lima_driver_queries))
+      return 0;
+
+   *info = lima_driver_queries[index];
+
+   return 1;
+}
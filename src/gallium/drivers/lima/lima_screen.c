@@ -707,6 +707,7 @@ lima_screen_create(int fd, struct renderonly *ro)
    screen->base.get_compiler_options = lima_screen_get_compiler_options;
    screen->base.query_dmabuf_modifiers = lima_screen_query_dmabuf_modifiers;
    screen->base.is_dmabuf_modifier_supported = lima_screen_is_dmabuf_modifier_supported;
+   screen->base.get_driver_query_info = lima_get_driver_query_info;
 
    lima_resource_screen_init(screen);
    lima_fence_screen_init(screen);
@@ -570,11 +570,10 @@ lp_build_depth_stencil_load_swizzled(struct gallivm_state *gallivm,
          shuffles[i] = lp_build_const_int32(gallivm, i);
       }
    }
-   else {
+   else if (z_src_type.length == 8) {
       unsigned i;
       LLVMValueRef loopx2 = LLVMBuildShl(builder, loop_counter,
                                          lp_build_const_int32(gallivm, 1), "");
-      assert(z_src_type.length == 8);
       depth_offset1 = LLVMBuildMul(builder, loopx2, depth_stride, "");
       /*
        * We load 2x4 values, and need to swizzle them (order
@@ -584,20 +583,55 @@ lp_build_depth_stencil_load_swizzled(struct gallivm_state *gallivm,
          shuffles[i] = lp_build_const_int32(gallivm, (i&1) + (i&2) * 2 + (i&4) / 2);
       }
    }
+   else {
+      struct lp_type row_type = zs_type;
+      LLVMValueRef rows[4];
+      unsigned i;
 
-   depth_offset2 = LLVMBuildAdd(builder, depth_offset1, depth_stride, "");
+      /*
+       * The whole 4x4 block at once. Load the four rows and pair them up,
+       * then swizzle the 4x4 values into 2x2 quad order.
+       */
+      assert(z_src_type.length == 16);
+      row_type.length = 4;
+      load_ptr_type = LLVMPointerType(lp_build_vec_type(gallivm, row_type), 0);
 
-   /* Load current z/stencil values from z/stencil buffer */
-   zs_dst_ptr = LLVMBuildGEP(builder, depth_ptr, &depth_offset1, 1, "");
-   zs_dst_ptr = LLVMBuildBitCast(builder, zs_dst_ptr, load_ptr_type, "");
-   zs_dst1 = LLVMBuildLoad(builder, zs_dst_ptr, "");
-   if (is_1d) {
-      zs_dst2 = lp_build_undef(gallivm, zs_load_type);
+      for (i = 0; i < 4; i++) {
+         if (is_1d && i > 0) {
+            rows[i] = lp_build_undef(gallivm, row_type);
+            continue;
+         }
+         depth_offset1 = LLVMBuildMul(builder, depth_stride,
+                                      lp_build_const_int32(gallivm, i), "");
+         zs_dst_ptr = LLVMBuildGEP(builder, depth_ptr, &depth_offset1, 1, "");
+         zs_dst_ptr = LLVMBuildBitCast(builder, zs_dst_ptr, load_ptr_type, "");
+         rows[i] = LLVMBuildLoad(builder, zs_dst_ptr, "");
+      }
+      zs_dst1 = lp_build_concat(gallivm, &rows[0], row_type, 2);
+      zs_dst2 = lp_build_concat(gallivm, &rows[2], row_type, 2);
+
+      for (i = 0; i < 16; i++) {
+         unsigned x = (i & 1) + ((i & 4) >> 1);
+         unsigned y = ((i & 2) >> 1) + ((i & 8) >>2);
+         shuffles[i] = lp_build_const_int32(gallivm, y * 4 + x);
+      }
    }
-   else {
-      zs_dst_ptr = LLVMBuildGEP(builder, depth_ptr, &depth_offset2, 1, "");
+
+   if (z_src_type.length <= 8) {
+      depth_offset2 = LLVMBuildAdd(builder, depth_offset1, depth_stride, "");
+
+      /* Load current z/stencil values from z/stencil buffer */
+      zs_dst_ptr = LLVMBuildGEP(builder, depth_ptr, &depth_offset1, 1, "");
       zs_dst_ptr = LLVMBuildBitCast(builder, zs_dst_ptr, load_ptr_type, "");
-      zs_dst2 = LLVMBuildLoad(builder, zs_dst_ptr, "");
+      zs_dst1 = LLVMBuildLoad(builder, zs_dst_ptr, "");
+      if (is_1d) {
+         zs_dst2 = lp_build_undef(gallivm, zs_load_type);
+      }
+      else {
+         zs_dst_ptr = LLVMBuildGEP(builder, depth_ptr, &depth_offset2, 1, "");
+         zs_dst_ptr = LLVMBuildBitCast(builder, zs_dst_ptr, load_ptr_type, "");
+         zs_dst2 = LLVMBuildLoad(builder, zs_dst_ptr, "");
+      }
    }
 
    *z_fb = LLVMBuildShuffleVector(builder, zs_dst1, zs_dst2,
@@ -716,11 +750,10 @@ lp_build_depth_stencil_write_swizzled(struct gallivm_state *gallivm,
                                    lp_build_const_int32(gallivm, depth_bytes * 2), "");
       depth_offset1 = LLVMBuildAdd(builder, depth_offset1, offset2, "");
    }
-   else {
+   else if (z_src_type.length == 8) {
       unsigned i;
       LLVMValueRef loopx2 = LLVMBuildShl(builder, loop_counter,
                                          lp_build_const_int32(gallivm, 1), "");
-      assert(z_src_type.length == 8);
       depth_offset1 = LLVMBuildMul(builder, loopx2, depth_stride, "");
       /*
        * We load 2x4 values, and need to swizzle them (order
@@ -730,6 +763,11 @@ lp_build_depth_stencil_write_swizzled(struct gallivm_state *gallivm,
          shuffles[i] = lp_build_const_int32(gallivm, (i&1) + (i&2) * 2 + (i&4) / 2);
       }
    }
+   else {
+      /* the whole 4x4 block, stored row by row below */
+      assert(z_src_type.length == 16);
+      depth_offset1 = lp_build_const_int32(gallivm, 0);
+   }
 
    depth_offset2 = LLVMBuildAdd(builder, depth_offset1, depth_stride, "");
 
@@ -756,6 +794,51 @@ lp_build_depth_stencil_write_swizzled(struct gallivm_state *gallivm,
                                lp_build_int_vec_type(gallivm, zs_type), "");
    }
 
+   if (z_src_type.length == 16) {
+      struct lp_type row_type = zs_type;
+      LLVMTypeRef row_ptr_type;
+      unsigned x, y;
+
+      /* Unswizzle the 2x2 quads and store the 4x4 block row by row */
+      row_type.length = 4;
+      row_ptr_type = LLVMPointerType(lp_build_vec_type(gallivm, row_type), 0);
+
+      for (y = 0; y < (is_1d ? 1 : 4); y++) {
+         LLVMValueRef row_shuffles[8];
+         LLVMValueRef row, row_ptr, row_offset;
+
+         for (x = 0; x < 4; x++) {
+            unsigned lane = (x & 1) | ((y & 1) << 1) | ((x & 2) << 1) | ((y & 2) << 2);
+            if (format_desc->block.bits <= 32) {
+               row_shuffles[x] = lp_build_const_int32(gallivm, lane);
+            }
+            else {
+               /* interleave depth and stencil */
+               row_shuffles[x*2] = lp_build_const_int32(gallivm, lane);
+               row_shuffles[x*2+1] = lp_build_const_int32(gallivm, lane + 16);
+            }
+         }
+
+         if (format_desc->block.bits <= 32) {
+            row = LLVMBuildShuffleVector(builder, z_value, z_value,
+                                         LLVMConstVector(row_shuffles, 4), "");
+         }
+         else {
+            row = LLVMBuildShuffleVector(builder, z_value, s_value,
+                                         LLVMConstVector(row_shuffles, 8), "");
+            row = LLVMBuildBitCast(builder, row,
+                                   lp_build_vec_type(gallivm, row_type), "");
+         }
+
+         row_offset = LLVMBuildMul(builder, depth_stride,
+                                   lp_build_const_int32(gallivm, y), "");
+         row_ptr = LLVMBuildGEP(builder, depth_ptr, &row_offset, 1, "");
+         row_ptr = LLVMBuildBitCast(builder, row_ptr, row_ptr_type, "");
+         LLVMBuildStore(builder, row, row_ptr);
+      }
+      return;
+   }
+
    if (format_desc->block.bits <= 32) {
       if (z_src_type.length == 4) {
          zs_dst1 = lp_build_extract_range(gallivm, z_value, 0, 2);
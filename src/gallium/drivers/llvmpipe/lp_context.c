@@ -33,6 +33,7 @@
 #include "draw/draw_context.h"
 #include "draw/draw_vbuf.h"
 #include "pipe/p_defines.h"
+#include "util/u_debug.h"
 #include "util/u_inlines.h"
 #include "util/u_math.h"
 #include "util/u_memory.h"
@@ -60,6 +61,13 @@ static void llvmpipe_destroy( struct pipe_context *pipe )
 
    lp_print_counters();
 
+   if (llvmpipe->async_fs_compile) {
+      util_queue_finish(&llvmpipe->fs_compile_queue);
+      util_queue_destroy(&llvmpipe->fs_compile_queue);
+   }
+
+   llvmpipe_finish_compute(llvmpipe);
+
    if (llvmpipe->csctx) {
       lp_csctx_destroy(llvmpipe->csctx);
    }
@@ -232,6 +240,19 @@ llvmpipe_create_context(struct pipe_screen *screen, void *priv,
    if (!llvmpipe->context)
       goto fail;
 
+   /* Compile optimized fragment shaders in the background, drawing with
+    * quickly compiled ones meanwhile.
+    */
+   if (debug_get_bool_option("LP_ASYNC_COMPILE", FALSE)) {
+      llvmpipe->async_fs_compile =
+         util_queue_init(&llvmpipe->fs_compile_queue, "lpfs", 64, 1,
+                         UTIL_QUEUE_INIT_RESIZE_IF_FULL);
+      llvmpipe->fs_optimize_threshold =
+         debug_get_num_option("LP_ASYNC_COMPILE_DRAWS", 16);
+   }
+
+   llvmpipe->cs_defer_wait = debug_get_bool_option("LP_CS_DEFER_WAIT", FALSE);
+
    /*
     * Create drawing context and plug our rendering stage into it.
     */
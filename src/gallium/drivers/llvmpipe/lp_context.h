@@ -50,6 +50,8 @@ struct draw_stage;
 struct draw_vertex_shader;
 struct lp_fragment_shader;
 struct lp_compute_shader;
+struct lp_cs_job_info;
+struct lp_cs_tpool_task;
 struct lp_blend_state;
 struct lp_setup_context;
 struct lp_setup_variant;
@@ -156,6 +158,20 @@ struct llvmpipe_context {
    unsigned nr_fs_variants;
    unsigned nr_fs_instrs;
 
+   /** Background compilation of optimized fragment shader variants */
+   boolean async_fs_compile;
+   struct util_queue fs_compile_queue;
+   /** Draws with an unoptimized variant before its optimized build starts */
+   unsigned fs_optimize_threshold;
+   /** The bound variant, if it's waiting to be replaced by optimized code */
+   struct lp_fragment_shader_variant *unoptimized_fs_variant;
+
+   /** Don't wait for compute dispatches until something depends on them */
+   boolean cs_defer_wait;
+   /** The last dispatch, if it's still running */
+   struct lp_cs_tpool_task *cs_pending_task;
+   struct lp_cs_job_info *cs_pending_job;
+
    struct lp_setup_variant_list_item setup_variants_list;
    unsigned nr_setup_variants;
 
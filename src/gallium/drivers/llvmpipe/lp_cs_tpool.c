@@ -30,8 +30,17 @@
 
 #include "util/u_thread.h"
 #include "util/u_memory.h"
+#include "util/u_math.h"
 #include "lp_cs_tpool.h"
 
+/*
+ * How many chunks of iterations each thread should get from a task on
+ * average, so threads finishing early can balance the load, and the
+ * upper limit on a chunk.
+ */
+#define LP_CS_CHUNKS_PER_THREAD 8
+#define LP_CS_MAX_CHUNK 64
+
 static int
 lp_cs_tpool_worker(void *data)
 {
@@ -52,15 +61,19 @@ lp_cs_tpool_worker(void *data)
 
       task = list_first_entry(&pool->workqueue, struct lp_cs_tpool_task,
                               list);
-      unsigned this_iter = task->iter_start++;
+      unsigned this_iter = task->iter_start;
+      unsigned num_iters = MIN2(task->iter_chunk,
+                                task->iter_total - this_iter);
 
+      task->iter_start += num_iters;
       if (task->iter_start == task->iter_total)
          list_del(&task->list);
 
       mtx_unlock(&pool->m);
-      task->work(task->data, this_iter, &lmem);
+      for (unsigned i = 0; i < num_iters; i++)
+         task->work(task->data, this_iter + i, &lmem);
       mtx_lock(&pool->m);
-      task->iter_finished++;
+      task->iter_finished += num_iters;
       if (task->iter_finished == task->iter_total)
          cnd_broadcast(&task->finish);
    }
@@ -131,6 +144,8 @@ lp_cs_tpool_queue_task(struct lp_cs_tpool *pool,
    task->work = work;
    task->data = data;
    task->iter_total = num_iters;
+   task->iter_chunk = CLAMP(num_iters / (pool->num_threads * LP_CS_CHUNKS_PER_THREAD),
+                            1, LP_CS_MAX_CHUNK);
    cnd_init(&task->finish);
 
    mtx_lock(&pool->m);
@@ -30,6 +30,9 @@
  * structs with just unique indexes in them.
  * It also supports a local memory support struct to be passed from
  * outside the thread exec function.
+ * Threads take the iterations in chunks, so large numbers of small
+ * work-groups don't all go through the pool mutex, and move on to the
+ * next queued task as soon as a task has no iterations left to hand out.
  */
 #ifndef LP_CS_QUEUE
 #define LP_CS_QUEUE
@@ -66,6 +69,7 @@ struct lp_cs_tpool_task {
    unsigned iter_total;
    unsigned iter_start;
    unsigned iter_finished;
+   unsigned iter_chunk;
 };
 
 struct lp_cs_tpool *lp_cs_tpool_create(unsigned num_threads);
@@ -35,10 +35,12 @@
 #include "pipe/p_context.h"
 #include "util/u_draw.h"
 #include "util/u_prim.h"
+#include "util/os_time.h"
 
 #include "lp_context.h"
 #include "lp_state.h"
 #include "lp_query.h"
+#include "lp_perf.h"
 
 #include "draw/draw_context.h"
 
@@ -75,6 +77,8 @@ llvmpipe_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info,
    const void *mapped_indices = NULL;
    unsigned i;
 
+   llvmpipe_finish_compute(lp);
+
    if (!llvmpipe_check_render_cond(lp))
       return;
 
@@ -83,6 +87,14 @@ llvmpipe_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info,
       return;
    }
 
+   const int64_t start_time = lp_stats_enabled() ? os_time_get_nano() : 0;
+
+   /* optimize a hot fragment shader, and switch to the optimized code once
+    * it has been compiled
+    */
+   if (lp->unoptimized_fs_variant)
+      llvmpipe_poll_unoptimized_fs(lp);
+
    if (lp->dirty)
       llvmpipe_update_derived( lp );
 
@@ -182,6 +194,11 @@ llvmpipe_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info,
     * internally when this condition is seen?)
     */
    draw_flush(draw);
+
+   if (start_time) {
+      lp_stats_add(LP_STAT_DRAWS, 1);
+      lp_stats_add(LP_STAT_DRAW_TIME, os_time_get_nano() - start_time);
+   }
 }
 
 
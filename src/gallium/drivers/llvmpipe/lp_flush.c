@@ -38,6 +38,7 @@
 #include "lp_flush.h"
 #include "lp_context.h"
 #include "lp_setup.h"
+#include "lp_state.h"
 
 
 /**
@@ -50,6 +51,7 @@ llvmpipe_flush( struct pipe_context *pipe,
 {
    struct llvmpipe_context *llvmpipe = llvmpipe_context(pipe);
 
+   llvmpipe_finish_compute(llvmpipe);
    draw_flush(llvmpipe->draw);
 
    /* ask the setup module to flush */
@@ -107,6 +109,13 @@ llvmpipe_flush_resource(struct pipe_context *pipe,
 {
    unsigned referenced;
 
+   /* Compute dispatches still running can access anything */
+   if (llvmpipe_context(pipe)->cs_pending_job) {
+      if (do_not_block)
+         return FALSE;
+      llvmpipe_finish_compute(llvmpipe_context(pipe));
+   }
+
    referenced = llvmpipe_is_resource_referenced(pipe, resource, level);
 
    if ((referenced & LP_REFERENCED_FOR_WRITE) ||
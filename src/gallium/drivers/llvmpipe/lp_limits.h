@@ -66,7 +66,12 @@
 
 #define LP_MAX_SAMPLES 4
 
-#define LP_MAX_THREADS 16
+/**
+ * Max number of rasterizer / compute threads.  Per-thread state is kept in
+ * fixed size arrays (see lp_rasterizer, lp_cs_tpool and llvmpipe_query), so
+ * this only costs a few KB even on machines with fewer cores.
+ */
+#define LP_MAX_THREADS 128
 
 
 /**
@@ -74,6 +79,13 @@
  */
 #define LP_MAX_SCENE_SIZE (512 * 1024 * 1024)
 
+/**
+ * Max bytes of binned data per context in scenes that were queued for
+ * rasterization but haven't finished yet.  Setup waits for the oldest
+ * scenes to be rasterized before exceeding this.
+ */
+#define LP_MAX_SCENES_IN_FLIGHT_SIZE (128 * 1024 * 1024)
+
 /**
  * Max number of shader variants (for all shaders combined,
  * per context) that will be kept around.
@@ -33,6 +33,22 @@
 
 struct lp_counters lp_count;
 
+struct lp_stats lp_stats[LP_MAX_THREADS + 1];
+int lp_stats_active;
+
+
+int64_t
+lp_stats_total(enum lp_stat stat)
+{
+   int64_t total = 0;
+   unsigned i;
+
+   for (i = 0; i < ARRAY_SIZE(lp_stats); i++)
+      total += p_atomic_read(&lp_stats[i].value[stat]);
+
+   return total;
+}
+
 
 void
 lp_reset_counters(void)
@@ -98,10 +114,27 @@ lp_print_counters(void)
       debug_printf("llvmpipe:   nr_empty_4x4:               %9u (%3.0f%% of %u)\n", lp_count.nr_empty_4, p1, total_4);
       debug_printf("llvmpipe:   nr_non_empty_4x4:           %9u (%3.0f%% of %u)\n", lp_count.nr_non_empty_4, p4, total_4);
 
+      debug_printf("llvmpipe: nr_hiz_rejected_16x16:        %9u\n", lp_count.nr_hiz_rejected_16);
+
       debug_printf("llvmpipe: nr_color_tile_clear:          %9u\n", lp_count.nr_color_tile_clear);
       debug_printf("llvmpipe: nr_color_tile_load:           %9u\n", lp_count.nr_color_tile_load);
       debug_printf("llvmpipe: nr_color_tile_store:          %9u\n", lp_count.nr_color_tile_store);
 
+      for (unsigned i = 0; i < LP_MAX_THREADS; i++) {
+         int64_t busy = lp_count.thread[i].busy_time;
+         int64_t idle = lp_count.thread[i].idle_time;
+
+         if (!busy && !lp_count.thread[i].nr_bins)
+            continue;
+
+         debug_printf("llvmpipe: thread %3u: bins %9u (%u stolen), "
+                      "busy %.3f sec, idle %.3f sec (%3.0f%%)\n",
+                      i, lp_count.thread[i].nr_bins,
+                      lp_count.thread[i].nr_bins_stolen,
+                      busy / 1e9, idle / 1e9,
+                      busy + idle ? 100.0 * idle / (busy + idle) : 0.0);
+      }
+
       debug_printf("llvmpipe: nr_llvm_compiles:             %u\n", lp_count.nr_llvm_compiles);
       debug_printf("llvmpipe: total LLVM compile time:      %.2f sec\n", lp_count.llvm_compile_time / 1000000.0);
       debug_printf("llvmpipe: average LLVM compile time:    %.2f sec\n", lp_count.llvm_compile_time / 1000000.0 / lp_count.nr_llvm_compiles);
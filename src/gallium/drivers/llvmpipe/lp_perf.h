@@ -34,6 +34,8 @@
 #define LP_PERF_H
 
 #include "pipe/p_compiler.h"
+#include "util/u_atomic.h"
+#include "lp_limits.h"
 
 /**
  * Various counters
@@ -56,12 +58,21 @@ struct lp_counters
    unsigned nr_fully_covered_4;
    unsigned nr_partially_covered_4;
    unsigned nr_non_empty_4;
+   unsigned nr_hiz_rejected_16;
    unsigned nr_llvm_compiles;
    int64_t llvm_compile_time;  /**< total, in microseconds */
 
    unsigned nr_color_tile_clear;
    unsigned nr_color_tile_load;
    unsigned nr_color_tile_store;
+
+   /** Per rasterizer thread counters, only written by the owning thread */
+   struct {
+      unsigned nr_bins;         /**< non-empty bins rasterized */
+      unsigned nr_bins_stolen;  /**< ... of which taken from another thread */
+      int64_t busy_time;        /**< rasterizing, in nanoseconds */
+      int64_t idle_time;        /**< waiting for other threads, in ns */
+   } thread[LP_MAX_THREADS];
 };
 
 
@@ -73,13 +84,64 @@ extern struct lp_counters lp_count;
 #define LP_COUNT(counter) lp_count.counter++
 #define LP_COUNT_ADD(counter, incr)  lp_count.counter += (incr)
 #define LP_COUNT_GET(counter) (lp_count.counter)
+#define LP_COUNT_THREAD(counter, idx) lp_count.thread[idx].counter++
 #else
 #define LP_COUNT(counter) do {} while (0)
 #define LP_COUNT_ADD(counter, incr) (void)(incr)
 #define LP_COUNT_GET(counter) 0
+#define LP_COUNT_THREAD(counter, idx) (void)(idx)
 #endif
 
 
+/**
+ * Timing statistics.  Unlike the counters above these are available in
+ * all builds, exposed as driver queries (and so in the HUD), but only
+ * gathered while at least one of these queries is active.
+ */
+enum lp_stat
+{
+   LP_STAT_DRAWS,            /**< draw calls */
+   LP_STAT_DRAW_TIME,        /**< draw calls, including state validation */
+   LP_STAT_SETUP_TIME,       /**< triangle setup and binning */
+   LP_STAT_TILES,            /**< tiles rasterized */
+   LP_STAT_RAST_TIME,        /**< rasterizing tiles, all threads */
+   LP_STAT_RAST_TRI_TIME,    /**< ... of which partially covered triangles */
+   LP_STAT_RAST_SHADE_TIME,  /**< ... of which fully covered tiles */
+   LP_STAT_RAST_CLEAR_TIME,  /**< ... of which clears */
+   LP_STAT_COUNT
+};
+
+/**
+ * One slot per rasterizer thread, only written by the owning thread, and
+ * a last one for the application threads (updated atomically).
+ * Times are in nanoseconds.
+ */
+struct lp_stats
+{
+   PIPE_ALIGN_VAR(64) int64_t value[LP_STAT_COUNT];
+};
+
+extern struct lp_stats lp_stats[LP_MAX_THREADS + 1];
+extern int lp_stats_active;
+
+#define LP_STATS_APP_SLOT LP_MAX_THREADS
+
+static inline boolean
+lp_stats_enabled(void)
+{
+   return p_atomic_read(&lp_stats_active) > 0;
+}
+
+static inline void
+lp_stats_add(enum lp_stat stat, int64_t value)
+{
+   p_atomic_add(&lp_stats[LP_STATS_APP_SLOT].value[stat], value);
+}
+
+extern int64_t
+lp_stats_total(enum lp_stat stat);
+
+
 extern void
 lp_reset_counters(void);
 
@@ -37,6 +37,7 @@
 #include "lp_context.h"
 #include "lp_flush.h"
 #include "lp_fence.h"
+#include "lp_perf.h"
 #include "lp_query.h"
 #include "lp_screen.h"
 #include "lp_state.h"
@@ -48,6 +49,30 @@ static struct llvmpipe_query *llvmpipe_query( struct pipe_query *p )
    return (struct llvmpipe_query *)p;
 }
 
+static inline boolean
+is_driver_query(const struct llvmpipe_query *pq)
+{
+   return pq->type >= PIPE_QUERY_DRIVER_SPECIFIC;
+}
+
+static inline enum lp_stat
+driver_query_stat(const struct llvmpipe_query *pq)
+{
+   return (enum lp_stat)(pq->type - PIPE_QUERY_DRIVER_SPECIFIC);
+}
+
+/**
+ * Stop gathering the lp_stats on behalf of a driver query.
+ */
+static void
+driver_query_release(struct llvmpipe_query *pq)
+{
+   if (pq->stat_active) {
+      p_atomic_dec(&lp_stats_active);
+      pq->stat_active = FALSE;
+   }
+}
+
 static struct pipe_query *
 llvmpipe_create_query(struct pipe_context *pipe, 
                       unsigned type,
@@ -55,7 +80,9 @@ llvmpipe_create_query(struct pipe_context *pipe,
 {
    struct llvmpipe_query *pq;
 
-   assert(type < PIPE_QUERY_TYPES);
+   assert(type < PIPE_QUERY_TYPES ||
+          (type >= PIPE_QUERY_DRIVER_SPECIFIC &&
+           type < PIPE_QUERY_DRIVER_SPECIFIC + LP_STAT_COUNT));
 
    pq = CALLOC_STRUCT( llvmpipe_query );
 
@@ -86,6 +113,8 @@ llvmpipe_destroy_query(struct pipe_context *pipe, struct pipe_query *q)
       lp_fence_reference(&pq->fence, NULL);
    }
 
+   driver_query_release(pq);
+
    FREE(pq);
 }
 
@@ -115,6 +144,20 @@ llvmpipe_get_query_result(struct pipe_context *pipe,
       }
    }
 
+   if (is_driver_query(pq)) {
+      const enum lp_stat stat = driver_query_stat(pq);
+
+      /* The scenes the query spans are done, take the final value */
+      if (pq->stat_active) {
+         pq->end[0] = lp_stats_total(stat);
+         driver_query_release(pq);
+      }
+      *result = pq->end[0] - pq->start[0];
+      if (stat != LP_STAT_DRAWS && stat != LP_STAT_TILES)
+         *result /= 1000; /* microseconds */
+      return true;
+   }
+
    /* Sum the results from each of the threads:
     */
    *result = 0;
@@ -379,6 +422,14 @@ llvmpipe_begin_query(struct pipe_context *pipe, struct pipe_query *q)
    memset(pq->end, 0, sizeof(pq->end));
    lp_setup_begin_query(llvmpipe->setup, pq);
 
+   if (is_driver_query(pq)) {
+      if (!pq->stat_active) {
+         p_atomic_inc(&lp_stats_active);
+         pq->stat_active = TRUE;
+      }
+      pq->start[0] = lp_stats_total(driver_query_stat(pq));
+   }
+
    switch (pq->type) {
    case PIPE_QUERY_PRIMITIVES_EMITTED:
       pq->num_primitives_written[0] = llvmpipe->so_stats[pq->index].num_primitives_written;
@@ -51,6 +51,8 @@ struct llvmpipe_query {
    unsigned num_primitives_written[PIPE_MAX_VERTEX_STREAMS];
 
    struct pipe_query_data_pipeline_statistics stats;
+
+   boolean stat_active;             /* driver query holding lp_stats_active */
 };
 
 
@@ -33,6 +33,7 @@
 #include "util/u_pack_color.h"
 #include "util/u_string.h"
 #include "util/u_thread.h"
+#include "util/u_cpu_detect.h"
 #include "util/u_memset.h"
 #include "util/os_time.h"
 
@@ -74,16 +75,28 @@ lp_rast_begin( struct lp_rasterizer *rast,
    LP_DBG(DEBUG_RAST, "%s\n", __FUNCTION__);
 
    lp_scene_begin_rasterization( scene );
-   lp_scene_bin_iter_begin( scene );
+   lp_scene_bin_iter_begin( scene, rast->num_threads );
 }
 
 
+/**
+ * End rasterizing a scene.
+ * Called once per scene by one thread, after all threads are done with it.
+ * The scene's fence is only signalled here so that setup can't reuse the
+ * scene while it is still in use by the rasterizer.
+ */
 static void
 lp_rast_end( struct lp_rasterizer *rast )
 {
-   lp_scene_end_rasterization( rast->curr_scene );
+   struct lp_scene *scene = rast->curr_scene;
+
+   lp_scene_end_rasterization( scene );
 
    rast->curr_scene = NULL;
+
+   if (scene->fence) {
+      lp_fence_signal(scene->fence);
+   }
 }
 
 
@@ -125,6 +138,8 @@ lp_rast_tile_begin(struct lp_rasterizer_task *task,
                          scene->zsbuf.stride * task->y +
                          scene->zsbuf.format_bytes * task->x;
    }
+
+   lp_rast_hiz_tile_begin(task);
 }
 
 
@@ -200,6 +215,10 @@ lp_rast_clear_zstencil(struct lp_rasterizer_task *task,
    LP_DBG(DEBUG_RAST, "%s: value=0x%08x, mask=0x%08x\n",
            __FUNCTION__, clear_value, clear_mask);
 
+   /* the depth bounds get recomputed when needed */
+   task->hiz_known = 0;
+   task->hiz_exact = 0;
+
    /*
     * Clear the area of the depth/depth buffer matching this tile.
     */
@@ -309,6 +328,7 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
    const struct lp_rast_state *state;
    struct lp_fragment_shader_variant *variant;
    const unsigned tile_x = task->x, tile_y = task->y;
+   unsigned hiz_reject = 0;
    unsigned x, y;
 
    if (inputs->disable) {
@@ -325,6 +345,15 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
    }
    variant = state->variant;
 
+   /* find the 16x16 blocks which would fail the depth test entirely */
+   if (task->hiz_enabled) {
+      for (y = 0; y < task->height; y += 16)
+         for (x = 0; x < task->width; x += 16)
+            if (lp_rast_hiz_reject_16(task, inputs, tile_x + x, tile_y + y,
+                                      TRUE))
+               hiz_reject |= 1 << ((y / 16) * 4 + x / 16);
+   }
+
    /* render the whole 64x64 tile in 4x4 chunks */
    for (y = 0; y < task->height; y += 4){
       for (x = 0; x < task->width; x += 4) {
@@ -336,6 +365,9 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
          unsigned depth_sample_stride = 0;
          unsigned i;
 
+         if (hiz_reject & (1 << ((y / 16) * 4 + x / 16)))
+            continue;
+
          /* color buffer */
          for (i = 0; i < scene->fb.nr_cbufs; i++){
             if (scene->fb.cbufs[i]) {
@@ -367,6 +399,8 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
          task->thread_data.raster_state.viewport_index = inputs->viewport_index;
          task->thread_data.raster_state.view_index = inputs->view_index;
 
+         lp_rast_hiz_update(task, inputs, tile_x + x, tile_y + y, 4, 4);
+
          /* run shader on 4x4 block */
          BEGIN_JIT_CALL(state, task);
          variant->jit_function[RAST_WHOLE]( &state->jit_context,
@@ -476,6 +510,8 @@ lp_rast_shade_quads_mask_sample(struct lp_rasterizer_task *task,
       task->thread_data.raster_state.viewport_index = inputs->viewport_index;
       task->thread_data.raster_state.view_index = inputs->view_index;
 
+      lp_rast_hiz_update(task, inputs, x, y, 4, 4);
+
       /* run shader on 4x4 block */
       BEGIN_JIT_CALL(state, task);
       variant->jit_function[RAST_EDGE_TEST](&state->jit_context,
@@ -662,6 +698,57 @@ do_rasterize_bin(struct lp_rasterizer_task *task,
 
 
 
+/**
+ * The statistic the time spent in a command counts towards, or
+ * LP_STAT_COUNT if it is only accounted for in the total.
+ */
+static inline enum lp_stat
+cmd_stat(unsigned cmd)
+{
+   switch (cmd) {
+   case LP_RAST_OP_CLEAR_COLOR:
+   case LP_RAST_OP_CLEAR_ZSTENCIL:
+      return LP_STAT_RAST_CLEAR_TIME;
+   case LP_RAST_OP_SHADE_TILE:
+   case LP_RAST_OP_SHADE_TILE_OPAQUE:
+      return LP_STAT_RAST_SHADE_TIME;
+   case LP_RAST_OP_BEGIN_QUERY:
+   case LP_RAST_OP_END_QUERY:
+   case LP_RAST_OP_SET_STATE:
+      return LP_STAT_COUNT;
+   default:
+      return LP_STAT_RAST_TRI_TIME;
+   }
+}
+
+
+/**
+ * do_rasterize_bin() which also times the commands, for the lp_stats.
+ */
+static void
+do_rasterize_bin_timed(struct lp_rasterizer_task *task,
+                       const struct cmd_bin *bin)
+{
+   int64_t *stats = lp_stats[task->thread_index].value;
+   const struct cmd_block *block;
+   int64_t t0 = os_time_get_nano(), t1;
+   unsigned k;
+
+   for (block = bin->head; block; block = block->next) {
+      for (k = 0; k < block->count; k++) {
+         const enum lp_stat stat = cmd_stat(block->cmd[k]);
+
+         dispatch[block->cmd[k]]( task, block->arg[k] );
+
+         t1 = os_time_get_nano();
+         if (stat != LP_STAT_COUNT)
+            stats[stat] += t1 - t0;
+         t0 = t1;
+      }
+   }
+}
+
+
 /**
  * Rasterize commands for a single bin.
  * \param x, y  position of the bin's tile in the framebuffer
@@ -672,11 +759,22 @@ static void
 rasterize_bin(struct lp_rasterizer_task *task,
               const struct cmd_bin *bin, int x, int y )
 {
-   lp_rast_tile_begin( task, bin, x, y );
+   if (lp_stats_enabled()) {
+      int64_t *stats = lp_stats[task->thread_index].value;
+      int64_t start = os_time_get_nano();
 
-   do_rasterize_bin(task, bin, x, y);
+      lp_rast_tile_begin( task, bin, x, y );
+      do_rasterize_bin_timed(task, bin);
+      lp_rast_tile_end(task);
 
-   lp_rast_tile_end(task);
+      stats[LP_STAT_TILES]++;
+      stats[LP_STAT_RAST_TIME] += os_time_get_nano() - start;
+   }
+   else {
+      lp_rast_tile_begin( task, bin, x, y );
+      do_rasterize_bin(task, bin, x, y);
+      lp_rast_tile_end(task);
+   }
 
 #ifdef DEBUG
    /* Debug/Perf flags:
@@ -731,11 +829,17 @@ rasterize_scene(struct lp_rasterizer_task *task,
       {
          struct cmd_bin *bin;
          int i, j;
+         boolean stolen;
 
          assert(scene);
-         while ((bin = lp_scene_bin_iter_next(scene, &i, &j))) {
-            if (!is_empty_bin( bin ))
+         while ((bin = lp_scene_bin_iter_next(scene, task->thread_index,
+                                              &i, &j, &stolen))) {
+            if (!is_empty_bin( bin )) {
                rasterize_bin(task, bin, i, j);
+               LP_COUNT_THREAD(nr_bins, task->thread_index);
+               if (stolen)
+                  LP_COUNT_THREAD(nr_bins_stolen, task->thread_index);
+            }
          }
       }
    }
@@ -755,10 +859,6 @@ rasterize_scene(struct lp_rasterizer_task *task,
    }
 #endif
 
-   if (scene->fence) {
-      lp_fence_signal(scene->fence);
-   }
-
    task->scene = NULL;
 }
 
@@ -807,19 +907,37 @@ lp_rast_queue_scene( struct lp_rasterizer *rast,
 }
 
 
-void
-lp_rast_finish( struct lp_rasterizer *rast )
+/**
+ * Pin a rasterizer thread to the set of cores sharing one L3 cache and
+ * re-allocate its scratch memory from that thread.
+ *
+ * Threads are spread round-robin across the L3 caches.  On multi-socket and
+ * chiplet systems each L3 group lives on a single NUMA node, so with the
+ * kernel's first-touch policy the per-thread data allocated here ends up in
+ * node-local memory.
+ */
+static void
+pin_rast_thread(struct lp_rasterizer_task *task)
 {
-   if (rast->num_threads == 0) {
-      /* nothing to do */
-   }
-   else {
-      int i;
+   const struct util_cpu_caps_t *caps = util_get_cpu_caps();
+   struct lp_build_format_cache *cache;
 
-      /* wait for work to complete */
-      for (i = 0; i < rast->num_threads; i++) {
-         pipe_semaphore_wait(&rast->tasks[i].work_done);
-      }
+   if (caps->num_L3_caches <= 1 || !caps->L3_affinity_mask)
+      return;
+
+   if (!util_set_current_thread_affinity(
+          caps->L3_affinity_mask[task->thread_index % caps->num_L3_caches],
+          NULL, UTIL_MAX_CPUS))
+      return;
+
+   /* Touch the new allocation from this thread so its pages are placed
+    * locally.  The original allocation is kept if this one fails.
+    */
+   cache = align_malloc(sizeof(struct lp_build_format_cache), 16);
+   if (cache) {
+      memset(cache, 0, sizeof *cache);
+      align_free(task->thread_data.cache);
+      task->thread_data.cache = cache;
    }
 }
 
@@ -829,7 +947,7 @@ lp_rast_finish( struct lp_rasterizer *rast )
  * It's a simple loop:
  *   1. wait for work
  *   2. do work
- *   3. signal that we're done
+ * Completion of each scene is signalled through the scene's fence.
  */
 static int
 thread_function(void *init_data)
@@ -843,6 +961,9 @@ thread_function(void *init_data)
    snprintf(thread_name, sizeof thread_name, "llvmpipe-%u", task->thread_index);
    u_thread_setname(thread_name);
 
+   if (rast->pin_threads)
+      pin_rast_thread(task);
+
    /* Make sure that denorms are treated like zeros. This is 
     * the behavior required by D3D10. OpenGL doesn't care.
     */
@@ -876,11 +997,26 @@ thread_function(void *init_data)
       if (debug)
          debug_printf("thread %d doing work\n", task->thread_index);
 
-      rasterize_scene(task,
-                      rast->curr_scene);
-      
-      /* wait for all threads to finish with this scene */
-      util_barrier_wait( &rast->barrier );
+      if (LP_DEBUG & DEBUG_COUNTERS) {
+         int64_t start = os_time_get_nano(), end;
+
+         rasterize_scene(task,
+                         rast->curr_scene);
+         end = os_time_get_nano();
+         lp_count.thread[task->thread_index].busy_time += end - start;
+
+         /* wait for all threads to finish with this scene */
+         util_barrier_wait( &rast->barrier );
+         lp_count.thread[task->thread_index].idle_time +=
+            os_time_get_nano() - end;
+      }
+      else {
+         rasterize_scene(task,
+                         rast->curr_scene);
+
+         /* wait for all threads to finish with this scene */
+         util_barrier_wait( &rast->barrier );
+      }
 
       /* XXX: shouldn't be necessary:
        */
@@ -888,11 +1024,8 @@ thread_function(void *init_data)
          lp_rast_end( rast );
       }
 
-      /* signal done with work */
       if (debug)
          debug_printf("thread %d done working\n", task->thread_index);
-
-      pipe_semaphore_signal(&task->work_done);
    }
 
 #ifdef _WIN32
@@ -961,6 +1094,7 @@ lp_rast_create( unsigned num_threads )
    rast->num_threads = num_threads;
 
    rast->no_rast = debug_get_bool_option("LP_NO_RAST", FALSE);
+   rast->pin_threads = debug_get_bool_option("LP_PIN_THREADS", FALSE);
 
    create_rast_threads(rast);
 
@@ -0,0 +1,313 @@
+/**************************************************************************
+ *
+ * Copyright 2021 VMware, Inc.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/*
+ * Hierarchical Z for the rasterizer.
+ *
+ * Each task keeps conservative bounds of the depth values stored in every
+ * 16x16 block of the tile it is rasterizing.  Before a covered block of a
+ * triangle is shaded, the depth range of the triangle's plane over that
+ * block is compared against the bounds, and the block is skipped if the
+ * depth test would fail for all of its pixels.
+ *
+ * The bounds are computed from the depth buffer the first time a fully
+ * covered block needs them, and are then widened by every depth write the
+ * rasterizer issues to the block.  Widening is cheap but loses precision,
+ * so the bounds are recomputed from memory whenever a fully covered block
+ * comes along and they aren't exact anymore.
+ */
+
+#include <float.h>
+#include "util/u_math.h"
+#include "lp_debug.h"
+#include "lp_perf.h"
+#include "lp_rast_priv.h"
+#include "lp_state_fs.h"
+
+
+/**
+ * Depth formats the bounds can be computed for.
+ * Return the largest representable value for unorm formats, 0 for float.
+ */
+static boolean
+hiz_format_supported(enum pipe_format format, double *unorm_max)
+{
+   switch (format) {
+   case PIPE_FORMAT_Z16_UNORM:
+      *unorm_max = 65535.0;
+      return TRUE;
+   case PIPE_FORMAT_Z24_UNORM_S8_UINT:
+   case PIPE_FORMAT_Z24X8_UNORM:
+   case PIPE_FORMAT_S8_UINT_Z24_UNORM:
+   case PIPE_FORMAT_X8Z24_UNORM:
+      *unorm_max = 16777215.0;
+      return TRUE;
+   case PIPE_FORMAT_Z32_UNORM:
+      *unorm_max = 4294967295.0;
+      return TRUE;
+   case PIPE_FORMAT_Z32_FLOAT:
+   case PIPE_FORMAT_Z32_FLOAT_S8X24_UINT:
+      *unorm_max = 0.0;
+      return TRUE;
+   default:
+      return FALSE;
+   }
+}
+
+
+void
+lp_rast_hiz_tile_begin(struct lp_rasterizer_task *task)
+{
+   const struct lp_scene *scene = task->scene;
+   double unorm_max;
+
+   task->hiz_known = 0;
+   task->hiz_exact = 0;
+
+   task->hiz_enabled = scene->zsbuf.map &&
+                       scene->zsbuf.nr_samples == 1 &&
+                       scene->fb_max_layer == 0 &&
+                       !(LP_PERF & PERF_NO_HIZ) &&
+                       hiz_format_supported(scene->fb.zsbuf->format,
+                                            &unorm_max);
+   if (task->hiz_enabled) {
+      /* Fragment depth gets truncated when converted to unorm, so allow for
+       * one step of slack plus one for the different rounding.
+       */
+      task->hiz_slack = unorm_max ? 2.0 / unorm_max : 0.0;
+   }
+}
+
+
+/**
+ * Compute the exact depth bounds of a 16x16 block from the depth buffer.
+ */
+static void
+hiz_compute_block(struct lp_rasterizer_task *task, unsigned block)
+{
+   const struct lp_scene *scene = task->scene;
+   const enum pipe_format format = scene->fb.zsbuf->format;
+   const unsigned stride = scene->zsbuf.stride;
+   const unsigned bytes = scene->zsbuf.format_bytes;
+   const unsigned bx = (block & 3) * 16, by = (block >> 2) * 16;
+   const unsigned w = bx < task->width ? MIN2(16, task->width - bx) : 0;
+   const unsigned h = by < task->height ? MIN2(16, task->height - by) : 0;
+   const uint8_t *row = task->depth_tile + by * stride + bx * bytes;
+   double zmin = 1.0, zmax = 0.0;
+   unsigned i, j;
+
+   if (format == PIPE_FORMAT_Z32_FLOAT ||
+       format == PIPE_FORMAT_Z32_FLOAT_S8X24_UINT) {
+      /* depth is the first dword of each pixel */
+      float vmin = 1.0f, vmax = 0.0f;
+
+      for (i = 0; i < h; i++, row += stride) {
+         for (j = 0; j < w; j++) {
+            const float v = *(const float *)(row + j * bytes);
+            vmin = MIN2(vmin, v);
+            vmax = MAX2(vmax, v);
+         }
+      }
+      zmin = vmin;
+      zmax = vmax;
+   }
+   else {
+      const unsigned shift = (format == PIPE_FORMAT_S8_UINT_Z24_UNORM ||
+                              format == PIPE_FORMAT_X8Z24_UNORM) ? 8 : 0;
+      const uint32_t mask = format == PIPE_FORMAT_Z16_UNORM ? 0xffff :
+                            format == PIPE_FORMAT_Z32_UNORM ? 0xffffffff :
+                            0xffffff;
+      uint32_t vmin = mask, vmax = 0;
+
+      for (i = 0; i < h; i++, row += stride) {
+         for (j = 0; j < w; j++) {
+            const uint32_t v = bytes == 2 ?
+               *(const uint16_t *)(row + j * 2) :
+               (*(const uint32_t *)(row + j * 4) >> shift) & mask;
+            vmin = MIN2(vmin, v);
+            vmax = MAX2(vmax, v);
+         }
+      }
+      zmin = vmin / (double)mask;
+      zmax = vmax / (double)mask;
+   }
+
+   if (!w || !h) {
+      /* nothing of the block is inside the framebuffer */
+      zmin = 1.0;
+      zmax = 0.0;
+   }
+
+   task->hiz_min[block] = zmin;
+   task->hiz_max[block] = zmax;
+   task->hiz_known |= 1 << block;
+   task->hiz_exact |= 1 << block;
+}
+
+
+/**
+ * Conservative range of the depth values the fragment shader may produce
+ * for the triangle over the w x h pixels at x, y (window coords).
+ *
+ * Depth gets interpolated as a0 + x * dzdx + y * dzdy and clamped to [0, 1].
+ * It is linear, so the extremes are at the corners of the block.  The range
+ * is widened to cover the rounding errors of the float math done by the
+ * shader (and by us), which are relative to the magnitude of the terms.
+ */
+static void
+hiz_plane_range(const struct lp_rasterizer_task *task,
+                const struct lp_rast_shader_inputs *inputs,
+                unsigned x, unsigned y, unsigned w, unsigned h,
+                double *zmin, double *zmax)
+{
+   const double z0 = GET_A0(inputs)[0][2];
+   const double dzdx = GET_DADX(inputs)[0][2];
+   const double dzdy = GET_DADY(inputs)[0][2];
+   const double x0 = dzdx * x, x1 = dzdx * (x + w - 1);
+   const double y0 = dzdy * y, y1 = dzdy * (y + h - 1);
+   const double err = (fabs(z0) + MAX2(fabs(x0), fabs(x1)) +
+                       MAX2(fabs(y0), fabs(y1))) * 8 * FLT_EPSILON +
+                      task->hiz_slack;
+
+   *zmin = CLAMP(z0 + MIN2(x0, x1) + MIN2(y0, y1) - err, 0.0, 1.0);
+   *zmax = CLAMP(z0 + MAX2(x0, x1) + MAX2(y0, y1) + err, 0.0, 1.0);
+}
+
+
+/**
+ * Return TRUE if the depth test is known to fail for every pixel of the
+ * triangle in the 16x16 block at x, y (window coords).
+ * \param full  whether the triangle covers the whole block, in which case
+ *              it's worth recomputing inexact bounds from the depth buffer
+ */
+boolean
+lp_rast_hiz_reject_16(struct lp_rasterizer_task *task,
+                      const struct lp_rast_shader_inputs *inputs,
+                      unsigned x, unsigned y, boolean full)
+{
+   const struct lp_fragment_shader_variant *variant = task->state->variant;
+   const unsigned block = ((y % TILE_SIZE) / 16) * 4 + (x % TILE_SIZE) / 16;
+   double zmin, zmax;
+   boolean reject;
+
+   assert(x % 16 == 0);
+   assert(y % 16 == 0);
+
+   if (!variant->hiz_cull || inputs->layer || inputs->view_index)
+      return FALSE;
+
+   if (full && !(task->hiz_exact & (1 << block)))
+      hiz_compute_block(task, block);
+   else if (!(task->hiz_known & (1 << block)))
+      return FALSE;
+
+   hiz_plane_range(task, inputs, x, y, 16, 16, &zmin, &zmax);
+
+   switch (variant->key.depth.func) {
+   case PIPE_FUNC_LESS:
+      reject = zmin >= task->hiz_max[block];
+      break;
+   case PIPE_FUNC_LEQUAL:
+      reject = zmin > task->hiz_max[block];
+      break;
+   case PIPE_FUNC_GREATER:
+      reject = zmax <= task->hiz_min[block];
+      break;
+   case PIPE_FUNC_GEQUAL:
+      reject = zmax < task->hiz_min[block];
+      break;
+   default:
+      reject = FALSE;
+      break;
+   }
+
+   if (reject)
+      LP_COUNT(nr_hiz_rejected_16);
+
+   return reject;
+}
+
+
+/**
+ * Account for a depth write to the w x h pixels at x, y (window coords).
+ */
+void
+lp_rast_hiz_write(struct lp_rasterizer_task *task,
+                  const struct lp_rast_shader_inputs *inputs,
+                  unsigned x, unsigned y, unsigned w, unsigned h)
+{
+   const struct lp_fragment_shader_variant *variant = task->state->variant;
+   const unsigned bx0 = (x % TILE_SIZE) / 16;
+   const unsigned by0 = (y % TILE_SIZE) / 16;
+   const unsigned bx1 = ((x % TILE_SIZE) + w - 1) / 16;
+   const unsigned by1 = ((y % TILE_SIZE) + h - 1) / 16;
+   unsigned bx, by;
+   double zmin, zmax;
+
+   if (!variant->hiz_plane_z || inputs->layer || inputs->view_index) {
+      /* The values written don't come from the plane, forget the bounds */
+      for (by = by0; by <= by1; by++)
+         for (bx = bx0; bx <= bx1; bx++)
+            task->hiz_known &= ~(1 << (by * 4 + bx));
+      task->hiz_exact &= task->hiz_known;
+      return;
+   }
+
+   hiz_plane_range(task, inputs, x, y, w, h, &zmin, &zmax);
+
+   for (by = by0; by <= by1; by++) {
+      for (bx = bx0; bx <= bx1; bx++) {
+         const unsigned block = by * 4 + bx;
+
+         if (!(task->hiz_known & (1 << block)))
+            continue;
+
+         task->hiz_exact &= ~(1 << block);
+
+         /* A passing depth test can only move the stored values towards
+          * the camera, so one of the bounds stays valid.
+          */
+         switch (variant->key.depth.func) {
+         case PIPE_FUNC_LESS:
+         case PIPE_FUNC_LEQUAL:
+            task->hiz_min[block] = MIN2(task->hiz_min[block], zmin);
+            break;
+         case PIPE_FUNC_GREATER:
+         case PIPE_FUNC_GEQUAL:
+            task->hiz_max[block] = MAX2(task->hiz_max[block], zmax);
+            break;
+         case PIPE_FUNC_EQUAL:
+         case PIPE_FUNC_NEVER:
+            break;
+         default:
+            task->hiz_min[block] = MIN2(task->hiz_min[block], zmin);
+            task->hiz_max[block] = MAX2(task->hiz_max[block], zmax);
+            break;
+         }
+      }
+   }
+}
@@ -102,6 +102,14 @@ struct lp_rasterizer_task
 
    pipe_semaphore work_ready;
    pipe_semaphore work_done;
+
+   /** Depth bounds of each 16x16 block of the tile, see lp_rast_hiz.c */
+   boolean hiz_enabled;
+   uint16_t hiz_known;  /**< blocks with valid bounds */
+   uint16_t hiz_exact;  /**< ... which match the depth buffer exactly */
+   double hiz_slack;
+   double hiz_min[16];
+   double hiz_max[16];
 };
 
 
@@ -114,6 +122,7 @@ struct lp_rasterizer
 {
    boolean exit_flag;
    boolean no_rast;  /**< For debugging/profiling */
+   boolean pin_threads;  /**< Pin threads to L3 cache / NUMA node groups */
 
    /** The incoming queue of scenes ready to rasterize */
    struct lp_scene_queue *full_scenes;
@@ -131,6 +140,28 @@ struct lp_rasterizer
    util_barrier barrier;
 };
 
+void
+lp_rast_hiz_tile_begin(struct lp_rasterizer_task *task);
+
+boolean
+lp_rast_hiz_reject_16(struct lp_rasterizer_task *task,
+                      const struct lp_rast_shader_inputs *inputs,
+                      unsigned x, unsigned y, boolean full);
+
+void
+lp_rast_hiz_write(struct lp_rasterizer_task *task,
+                  const struct lp_rast_shader_inputs *inputs,
+                  unsigned x, unsigned y, unsigned w, unsigned h);
+
+static inline void
+lp_rast_hiz_update(struct lp_rasterizer_task *task,
+                   const struct lp_rast_shader_inputs *inputs,
+                   unsigned x, unsigned y, unsigned w, unsigned h)
+{
+   if (task->hiz_enabled && task->state->variant->hiz_write)
+      lp_rast_hiz_write(task, inputs, x, y, w, h);
+}
+
 void
 lp_rast_shade_quads_mask_sample(struct lp_rasterizer_task *task,
                                 const struct lp_rast_shader_inputs *inputs,
@@ -274,6 +305,8 @@ lp_rast_shade_quads_all( struct lp_rasterizer_task *task,
       task->thread_data.raster_state.viewport_index = inputs->viewport_index;
       task->thread_data.raster_state.view_index = inputs->view_index;
 
+      lp_rast_hiz_update(task, inputs, x, y, 4, 4);
+
       /* run shader on 4x4 block */
       BEGIN_JIT_CALL(state, task);
       variant->jit_function[RAST_WHOLE]( &state->jit_context,
@@ -28,6 +28,7 @@
 #include "util/u_framebuffer.h"
 #include "util/u_math.h"
 #include "util/u_memory.h"
+#include "util/os_misc.h"
 #include "util/u_inlines.h"
 #include "util/simple_list.h"
 #include "util/format/u_format.h"
@@ -63,7 +64,10 @@ struct shader_ref {
 struct lp_scene *
 lp_scene_create( struct pipe_context *pipe )
 {
-   struct lp_scene *scene = CALLOC_STRUCT(lp_scene);
+   /* The bins are indexed all over the place while binning, so put the
+    * scene on huge pages when they're enabled.
+    */
+   struct lp_scene *scene = os_malloc_huge(sizeof(struct lp_scene));
    if (!scene)
       return NULL;
 
@@ -72,8 +76,6 @@ lp_scene_create( struct pipe_context *pipe )
    scene->data.head =
       CALLOC_STRUCT(data_block);
 
-   (void) mtx_init(&scene->mutex, mtx_plain);
-
 #ifdef DEBUG
    /* Do some scene limit sanity checks here */
    {
@@ -100,10 +102,9 @@ void
 lp_scene_destroy(struct lp_scene *scene)
 {
    lp_fence_reference(&scene->fence, NULL);
-   mtx_destroy(&scene->mutex);
    assert(scene->data.head->next == NULL);
    FREE(scene->data.head);
-   FREE(scene);
+   os_free_huge(scene, sizeof(struct lp_scene));
 }
 
 
@@ -221,12 +222,14 @@ lp_scene_begin_rasterization(struct lp_scene *scene)
 
 
 /**
- * Free all the temporary data in a scene.
+ * Unmap the framebuffer surfaces once all threads are done rasterizing.
+ * Called by the rasterizer; the rest of the scene stays intact until
+ * setup reclaims it with lp_scene_reset().
  */
 void
 lp_scene_end_rasterization(struct lp_scene *scene )
 {
-   int i, j;
+   int i;
 
    /* Unmap color buffers */
    for (i = 0; i < scene->fb.nr_cbufs; i++) {
@@ -249,6 +252,19 @@ lp_scene_end_rasterization(struct lp_scene *scene )
                               zsbuf->u.tex.first_layer);
       scene->zsbuf.map = NULL;
    }
+}
+
+
+/**
+ * Free all the temporary data in a scene.
+ * Must only be called by the setup thread, once the scene's fence has
+ * been signalled, since it drops the references which
+ * lp_scene_is_resource_referenced() walks.
+ */
+void
+lp_scene_reset(struct lp_scene *scene)
+{
+   int i, j;
 
    /* Reset all command lists:
     */
@@ -530,61 +546,77 @@ lp_scene_is_resource_referenced(const struct lp_scene *scene,
 
 
 
-/** advance curr_x,y to the next bin */
-static boolean
-next_bin(struct lp_scene *scene)
+/**
+ * Split the bins of the scene into one contiguous range per rasterizer
+ * thread.  Must be called by a single thread before any thread calls
+ * lp_scene_bin_iter_next().
+ */
+void
+lp_scene_bin_iter_begin( struct lp_scene *scene, unsigned num_threads )
 {
-   scene->curr_x++;
-   if (scene->curr_x >= scene->tiles_x) {
-      scene->curr_x = 0;
-      scene->curr_y++;
-   }
-   if (scene->curr_y >= scene->tiles_y) {
-      /* no more bins */
-      return FALSE;
+   const int num_bins = scene->tiles_x * scene->tiles_y;
+   unsigned i;
+
+   scene->num_bin_queues = MAX2(1, num_threads);
+   assert(scene->num_bin_queues <= LP_MAX_THREADS);
+
+   for (i = 0; i < scene->num_bin_queues; i++) {
+      scene->bin_queue[i].next = num_bins * i / scene->num_bin_queues;
+      scene->bin_queue[i].end = num_bins * (i + 1) / scene->num_bin_queues;
    }
-   return TRUE;
 }
 
 
-void
-lp_scene_bin_iter_begin( struct lp_scene *scene )
+/** claim the next bin index of the given queue, or return -1 */
+static inline int
+bin_queue_pop(struct lp_scene *scene, unsigned queue)
 {
-   scene->curr_x = scene->curr_y = -1;
+   int index;
+
+   /* Cheap check so that drained queues aren't hammered by atomics. */
+   if (p_atomic_read(&scene->bin_queue[queue].next) >=
+       scene->bin_queue[queue].end)
+      return -1;
+
+   index = p_atomic_inc_return(&scene->bin_queue[queue].next) - 1;
+   return index < scene->bin_queue[queue].end ? index : -1;
 }
 
 
 /**
- * Return pointer to next bin to be rendered.
- * The lp_scene::curr_x and ::curr_y fields will be advanced.
+ * Return pointer to next bin to be rendered by the given thread.
  * Multiple rendering threads will call this function to get a chunk
- * of work (a bin) to work on.
+ * of work (a bin) to work on.  Each thread first takes bins from its own
+ * range, and once that is empty steals from the other threads' ranges,
+ * so unevenly loaded scenes still keep all threads busy.  No locking is
+ * needed since every bin index is claimed by exactly one atomic increment.
  */
 struct cmd_bin *
-lp_scene_bin_iter_next( struct lp_scene *scene , int *x, int *y)
+lp_scene_bin_iter_next( struct lp_scene *scene, unsigned thread_index,
+                        int *x, int *y, boolean *stolen )
 {
-   struct cmd_bin *bin = NULL;
+   unsigned i;
+   int index;
 
-   mtx_lock(&scene->mutex);
+   assert(thread_index < scene->num_bin_queues);
 
-   if (scene->curr_x < 0) {
-      /* first bin */
-      scene->curr_x = 0;
-      scene->curr_y = 0;
-   }
-   else if (!next_bin(scene)) {
-      /* no more bins left */
-      goto end;
+   *stolen = FALSE;
+   index = bin_queue_pop(scene, thread_index);
+
+   for (i = 1; index < 0 && i < scene->num_bin_queues; i++) {
+      index = bin_queue_pop(scene,
+                            (thread_index + i) % scene->num_bin_queues);
+      *stolen = TRUE;
    }
 
-   bin = lp_scene_get_bin(scene, scene->curr_x, scene->curr_y);
-   *x = scene->curr_x;
-   *y = scene->curr_y;
+   if (index < 0)
+      return NULL;
+
+   *x = index % scene->tiles_x;
+   *y = index / scene->tiles_x;
 
-end:
-   /*printf("return bin %p at %d, %d\n", (void *) bin, *bin_x, *bin_y);*/
-   mtx_unlock(&scene->mutex);
-   return bin;
+   /*printf("return bin at %d, %d\n", *x, *y);*/
+   return lp_scene_get_bin(scene, *x, *y);
 }
 
 
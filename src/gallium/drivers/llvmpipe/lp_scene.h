@@ -185,8 +185,18 @@ struct lp_scene {
     */
    unsigned tiles_x, tiles_y;
 
-   int curr_x, curr_y;  /**< for iterating over bins */
-   mtx_t mutex;
+   /**
+    * Per-thread ranges of bin indices (y * tiles_x + x) for iterating over
+    * bins.  Each rasterizer thread consumes its own range first and then
+    * steals from the ranges of the other threads.  The padding keeps each
+    * counter in its own cache line.
+    */
+   struct {
+      int next;
+      int end;
+      char pad[64 - 2 * sizeof(int)];
+   } bin_queue[LP_MAX_THREADS];
+   unsigned num_bin_queues;
 
    struct cmd_bin tile[TILES_X][TILES_Y];
    struct data_block_list data;
@@ -395,10 +405,11 @@ lp_scene_get_num_bins( const struct lp_scene *scene )
 
 
 void
-lp_scene_bin_iter_begin( struct lp_scene *scene );
+lp_scene_bin_iter_begin( struct lp_scene *scene, unsigned num_threads );
 
 struct cmd_bin *
-lp_scene_bin_iter_next( struct lp_scene *scene, int *x, int *y );
+lp_scene_bin_iter_next( struct lp_scene *scene, unsigned thread_index,
+                        int *x, int *y, boolean *stolen );
 
 
 
@@ -420,6 +431,9 @@ lp_scene_begin_rasterization(struct lp_scene *scene);
 void
 lp_scene_end_rasterization(struct lp_scene *scene);
 
+void
+lp_scene_reset(struct lp_scene *scene);
+
 
 
 
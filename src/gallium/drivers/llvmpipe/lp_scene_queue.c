@@ -39,7 +39,7 @@
 
 
 
-#define SCENE_QUEUE_SIZE 4
+#define SCENE_QUEUE_SIZE 64
 
 
 
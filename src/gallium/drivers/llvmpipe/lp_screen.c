@@ -43,10 +43,12 @@
 #include "util/os_time.h"
 #include "lp_texture.h"
 #include "lp_fence.h"
+#include "lp_flush.h"
 #include "lp_jit.h"
 #include "lp_screen.h"
 #include "lp_context.h"
 #include "lp_debug.h"
+#include "lp_perf.h"
 #include "lp_public.h"
 #include "lp_limits.h"
 #include "lp_rast.h"
@@ -89,6 +91,7 @@ static const struct debug_named_value lp_perf_flags[] = {
    { "no_blend",       PERF_NO_BLEND, NULL },
    { "no_depth",       PERF_NO_DEPTH, NULL },
    { "no_alphatest",   PERF_NO_ALPHATEST, NULL },
+   { "no_hiz",         PERF_NO_HIZ, NULL },
    DEBUG_NAMED_VALUE_END
 };
 
@@ -339,6 +342,7 @@ llvmpipe_get_param(struct pipe_screen *screen, enum pipe_cap param)
    case PIPE_CAP_FRAMEBUFFER_NO_ATTACHMENT:
    case PIPE_CAP_TGSI_TG4_COMPONENT_IN_SWIZZLE:
    case PIPE_CAP_TGSI_FS_FACE_IS_INTEGER_SYSVAL:
+   case PIPE_CAP_SHAREABLE_CSOS:
       return 1;
    case PIPE_CAP_SAMPLER_REDUCTION_MINMAX:
    case PIPE_CAP_TGSI_TXQS:
@@ -738,8 +742,19 @@ llvmpipe_flush_frontbuffer(struct pipe_screen *_screen,
    struct llvmpipe_resource *texture = llvmpipe_resource(resource);
 
    assert(texture->dt);
-   if (texture->dt)
-      winsys->displaytarget_display(winsys, texture->dt, context_private, sub_box);
+   if (!texture->dt)
+      return;
+
+   /* Scenes are rasterized asynchronously, wait for the ones drawing to
+    * the display target (but not the rest of the context) before the
+    * winsys presents straight from its memory.
+    */
+   if (_pipe)
+      llvmpipe_flush(_pipe, NULL, __FUNCTION__);
+   if (texture->dt_fence && lp_fence_issued(texture->dt_fence))
+      lp_fence_wait(texture->dt_fence);
+
+   winsys->displaytarget_display(winsys, texture->dt, context_private, sub_box);
 }
 
 static void
@@ -817,6 +832,75 @@ llvmpipe_get_timestamp(struct pipe_screen *_screen)
    return os_time_get_nano();
 }
 
+
+static int
+llvmpipe_get_driver_query_info(struct pipe_screen *screen,
+                               unsigned index,
+                               struct pipe_driver_query_info *info)
+{
+#define QUERY(NAME, STAT, UNITS) \
+   {NAME, PIPE_QUERY_DRIVER_SPECIFIC + STAT, {0}, UNITS, \
+    PIPE_DRIVER_QUERY_RESULT_TYPE_AVERAGE, 0, 0x0}
+
+   static const struct pipe_driver_query_info queries[] = {
+      QUERY("lp-draw-calls", LP_STAT_DRAWS,
+            PIPE_DRIVER_QUERY_TYPE_UINT64),
+      QUERY("lp-draw-time", LP_STAT_DRAW_TIME,
+            PIPE_DRIVER_QUERY_TYPE_MICROSECONDS),
+      QUERY("lp-setup-time", LP_STAT_SETUP_TIME,
+            PIPE_DRIVER_QUERY_TYPE_MICROSECONDS),
+      QUERY("lp-tiles", LP_STAT_TILES,
+            PIPE_DRIVER_QUERY_TYPE_UINT64),
+      QUERY("lp-rast-time", LP_STAT_RAST_TIME,
+            PIPE_DRIVER_QUERY_TYPE_MICROSECONDS),
+      QUERY("lp-rast-triangle-time", LP_STAT_RAST_TRI_TIME,
+            PIPE_DRIVER_QUERY_TYPE_MICROSECONDS),
+      QUERY("lp-rast-shade-time", LP_STAT_RAST_SHADE_TIME,
+            PIPE_DRIVER_QUERY_TYPE_MICROSECONDS),
+      QUERY("lp-rast-clear-time", LP_STAT_RAST_CLEAR_TIME,
+            PIPE_DRIVER_QUERY_TYPE_MICROSECONDS),
+   };
+#undef QUERY
+
+   STATIC_ASSERT(ARRAY_SIZE(queries) == LP_STAT_COUNT);
+
+   if (!info)
+      return ARRAY_SIZE(queries);
+
+   if (index >= ARRAY_SIZE(queries))
+      return 0;
+
+   *info = queries[index];
+   return 1;
+}
+
+/**
+ * Hash everything about the host CPU the generated code depends on, so
+ * that a cache directory shared between machines (or containers running on
+ * different hosts) never hands out code using instructions we don't have.
+ */
+static void
+update_cache_sha1_cpu(struct mesa_sha1 *ctx)
+{
+   const struct util_cpu_caps_t *cpu_caps = util_get_cpu_caps();
+   const uint32_t cpu_flags[] = {
+      cpu_caps->family,
+      cpu_caps->x86_cpu_type,
+      cpu_caps->has_sse, cpu_caps->has_sse2, cpu_caps->has_sse3,
+      cpu_caps->has_ssse3, cpu_caps->has_sse4_1, cpu_caps->has_sse4_2,
+      cpu_caps->has_popcnt, cpu_caps->has_avx, cpu_caps->has_avx2,
+      cpu_caps->has_f16c, cpu_caps->has_fma, cpu_caps->has_xop,
+      cpu_caps->has_altivec, cpu_caps->has_vsx, cpu_caps->has_neon,
+      cpu_caps->has_avx512f, cpu_caps->has_avx512dq, cpu_caps->has_avx512ifma,
+      cpu_caps->has_avx512pf, cpu_caps->has_avx512er, cpu_caps->has_avx512cd,
+      cpu_caps->has_avx512bw, cpu_caps->has_avx512vl, cpu_caps->has_avx512vbmi,
+      /* vector width the variants get built for (LP_NATIVE_VECTOR_WIDTH) */
+      lp_native_vector_width,
+   };
+
+   _mesa_sha1_update(ctx, cpu_flags, sizeof(cpu_flags));
+}
+
 static void lp_disk_cache_create(struct llvmpipe_screen *screen)
 {
    struct mesa_sha1 ctx;
@@ -830,6 +914,9 @@ static void lp_disk_cache_create(struct llvmpipe_screen *screen)
       return;
 
    _mesa_sha1_update(&ctx, &gallivm_perf, sizeof(gallivm_perf));
+   /* various LP_PERF flags change the generated shaders too */
+   _mesa_sha1_update(&ctx, &LP_PERF, sizeof(LP_PERF));
+   update_cache_sha1_cpu(&ctx);
    _mesa_sha1_final(&ctx, sha1);
    disk_cache_format_hex_id(cache_id, sha1, 20 * 2);
 
@@ -924,6 +1011,7 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
    screen->base.fence_finish = llvmpipe_fence_finish;
 
    screen->base.get_timestamp = llvmpipe_get_timestamp;
+   screen->base.get_driver_query_info = llvmpipe_get_driver_query_info;
 
    screen->base.finalize_nir = llvmpipe_finalize_nir;
 
@@ -64,24 +64,77 @@ static boolean set_scene_state( struct lp_setup_context *, enum setup_state,
 static boolean try_update_scene_state( struct lp_setup_context *setup );
 
 
+/**
+ * Free the data of a scene which was queued for rasterization, waiting
+ * for the rasterizer to finish with it first.
+ */
+static void
+lp_setup_reclaim_scene(struct lp_scene *scene)
+{
+   if (!scene->fence)
+      return;
+
+   if ((LP_DEBUG & DEBUG_SETUP) && !lp_fence_signalled(scene->fence))
+      debug_printf("%s: wait for scene %d\n",
+                   __FUNCTION__, scene->fence->id);
+
+   /* Even when already signalled, this orders our accesses to the scene
+    * after the rasterizer's.
+    */
+   lp_fence_wait(scene->fence);
+
+   lp_scene_reset(scene);
+}
+
+
+/**
+ * Pick the next scene of the ring for binning.
+ *
+ * Up to num_scenes scenes may be queued for rasterization, so that binning
+ * overlaps with rasterization of the previous scenes.  Besides the ring
+ * depth, the amount of binned data in flight is bounded by
+ * LP_MAX_SCENES_IN_FLIGHT_SIZE: if it is exceeded we wait for the oldest
+ * scenes to finish first.
+ */
 static void
 lp_setup_get_empty_scene(struct lp_setup_context *setup)
 {
+   unsigned in_flight_size = 0;
+   unsigned i;
+
    assert(setup->scene == NULL);
 
    setup->scene_idx++;
-   setup->scene_idx %= ARRAY_SIZE(setup->scenes);
+   setup->scene_idx %= setup->num_scenes;
 
-   setup->scene = setup->scenes[setup->scene_idx];
+   /* Free the scenes which are done and account for the others.  We go
+    * from the oldest to the newest scene, so the oldest ones are waited
+    * on first if we are over budget.
+    */
+   for (i = 1; i < setup->num_scenes; i++) {
+      unsigned idx = (setup->scene_idx + i) % setup->num_scenes;
+      struct lp_scene *scene = setup->scenes[idx];
+
+      if (scene->fence && lp_fence_signalled(scene->fence))
+         lp_setup_reclaim_scene(scene);
+      else if (scene->fence)
+         in_flight_size += scene->scene_size;
+   }
 
-   if (setup->scene->fence) {
-      if (LP_DEBUG & DEBUG_SETUP)
-         debug_printf("%s: wait for scene %d\n",
-                      __FUNCTION__, setup->scene->fence->id);
+   for (i = 1; i < setup->num_scenes &&
+               in_flight_size > LP_MAX_SCENES_IN_FLIGHT_SIZE; i++) {
+      unsigned idx = (setup->scene_idx + i) % setup->num_scenes;
+      struct lp_scene *scene = setup->scenes[idx];
 
-      lp_fence_wait(setup->scene->fence);
+      if (scene->fence) {
+         in_flight_size -= scene->scene_size;
+         lp_setup_reclaim_scene(scene);
+      }
    }
 
+   setup->scene = setup->scenes[setup->scene_idx];
+   lp_setup_reclaim_scene(setup->scene);
+
    lp_scene_begin_binning(setup->scene, &setup->fb);
 
 }
@@ -163,26 +216,27 @@ lp_setup_rasterize_scene( struct lp_setup_context *setup )
 
    lp_fence_reference(&setup->last_fence, scene->fence);
 
-   if (setup->last_fence)
+   if (setup->last_fence) {
+      unsigned i;
+
       setup->last_fence->issued = TRUE;
 
-   mtx_lock(&screen->rast_mutex);
+      for (i = 0; i < scene->fb.nr_cbufs; i++) {
+         struct pipe_surface *cbuf = scene->fb.cbufs[i];
+         if (cbuf && llvmpipe_resource(cbuf->texture)->dt)
+            lp_fence_reference(&llvmpipe_resource(cbuf->texture)->dt_fence,
+                               scene->fence);
+      }
+   }
 
-   /* FIXME: We enqueue the scene then wait on the rasterizer to finish.
-    * This means we never actually run any vertex stuff in parallel to
-    * rasterization (not in the same context at least) which is what the
-    * multiple scenes per setup is about - when we get a new empty scene
-    * any old one is already empty again because we waited here for
-    * raster tasks to be finished. Ideally, we shouldn't need to wait here
-    * and rely on fences elsewhere when waiting is necessary.
-    * Certainly, lp_scene_end_rasterization() would need to be deferred too
-    * and there's probably other bits why this doesn't actually work.
+   /* We don't wait for the rasterizer here.  The scene is freed when it
+    * gets reused (see lp_setup_get_empty_scene()), and anything which needs
+    * the results waits on the scene's fence.
     */
+   mtx_lock(&screen->rast_mutex);
    lp_rast_queue_scene(screen->rast, scene);
-   lp_rast_finish(screen->rast);
    mtx_unlock(&screen->rast_mutex);
 
-   lp_scene_end_rasterization(setup->scene);
    lp_setup_reset( setup );
 
    LP_DBG(DEBUG_SETUP, "%s done \n", __FUNCTION__);
@@ -200,9 +254,10 @@ begin_binning( struct lp_setup_context *setup )
    assert(scene);
    assert(scene->fence == NULL);
 
-   /* Always create a fence:
+   /* Always create a fence.  It is signalled once by the rasterizer, after
+    * all threads are done with the scene:
     */
-   scene->fence = lp_fence_create(MAX2(1, setup->num_threads));
+   scene->fence = lp_fence_create(1);
    if (!scene->fence)
       return FALSE;
 
@@ -344,6 +399,7 @@ set_scene_state( struct lp_setup_context *setup,
 fail:
    if (setup->scene) {
       lp_scene_end_rasterization(setup->scene);
+      lp_scene_reset(setup->scene);
       setup->scene = NULL;
    }
 
@@ -1081,9 +1137,26 @@ lp_setup_is_resource_referenced( const struct lp_setup_context *setup,
       return LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
    }
 
-   /* check textures referenced by the scene */
-   for (i = 0; i < ARRAY_SIZE(setup->scenes); i++) {
-      if (lp_scene_is_resource_referenced(setup->scenes[i], texture)) {
+   /* check the scenes which haven't been rasterized yet */
+   for (i = 0; i < setup->num_scenes; i++) {
+      const struct lp_scene *scene = setup->scenes[i];
+      unsigned j;
+
+      if (scene != setup->scene &&
+          (!scene->fence || lp_fence_signalled(scene->fence)))
+         continue;
+
+      /* queued scenes may render to a previously bound framebuffer */
+      if (scene != setup->scene) {
+         for (j = 0; j < scene->fb.nr_cbufs; j++) {
+            if (scene->fb.cbufs[j] && scene->fb.cbufs[j]->texture == texture)
+               return LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
+         }
+         if (scene->fb.zsbuf && scene->fb.zsbuf->texture == texture)
+            return LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
+      }
+
+      if (lp_scene_is_resource_referenced(scene, texture)) {
          return LP_REFERENCED_FOR_READ;
       }
    }
@@ -1428,13 +1501,11 @@ lp_setup_destroy( struct lp_setup_context *setup )
       pipe_resource_reference(&setup->ssbos[i].current.buffer, NULL);
    }
 
-   /* free the scenes in the 'empty' queue */
-   for (i = 0; i < ARRAY_SIZE(setup->scenes); i++) {
+   /* wait for the queued scenes and free them all */
+   for (i = 0; i < setup->num_scenes; i++) {
       struct lp_scene *scene = setup->scenes[i];
 
-      if (scene->fence)
-         lp_fence_wait(scene->fence);
-
+      lp_setup_reclaim_scene(scene);
       lp_scene_destroy(scene);
    }
 
@@ -1470,6 +1541,9 @@ lp_setup_create( struct pipe_context *pipe,
 
 
    setup->num_threads = screen->num_threads;
+   setup->num_scenes = debug_get_num_option("LP_NUM_SCENES",
+                                            DEFAULT_NUM_SCENES);
+   setup->num_scenes = CLAMP(setup->num_scenes, 1, MAX_SCENES);
    setup->vbuf = draw_vbuf_stage(draw, &setup->base);
    if (!setup->vbuf) {
       goto no_vbuf;
@@ -1479,7 +1553,7 @@ lp_setup_create( struct pipe_context *pipe,
    draw_set_render(draw, &setup->base);
 
    /* create some empty scenes */
-   for (i = 0; i < MAX_SCENES; i++) {
+   for (i = 0; i < setup->num_scenes; i++) {
       setup->scenes[i] = lp_scene_create( pipe );
       if (!setup->scenes[i]) {
          goto no_scenes;
@@ -1499,7 +1573,7 @@ lp_setup_create( struct pipe_context *pipe,
    return setup;
 
 no_scenes:
-   for (i = 0; i < MAX_SCENES; i++) {
+   for (i = 0; i < setup->num_scenes; i++) {
       if (setup->scenes[i]) {
          lp_scene_destroy(setup->scenes[i]);
       }
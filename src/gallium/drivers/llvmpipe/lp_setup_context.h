@@ -54,9 +54,11 @@
 struct lp_setup_variant;
 
 
-/** Max number of scenes */
-/* XXX: make multiple scenes per context work, see lp_setup_rasterize_scene */
-#define MAX_SCENES 1
+/** Max number of scenes per context, see LP_NUM_SCENES */
+#define MAX_SCENES 64
+
+/** Default number of scenes per context */
+#define DEFAULT_NUM_SCENES 4
 
 
 
@@ -89,6 +91,7 @@ struct lp_setup_context
    struct draw_stage *vbuf;
    unsigned num_threads;
    unsigned scene_idx;
+   unsigned num_scenes;
    struct lp_scene *scenes[MAX_SCENES];  /**< all the scenes */
    struct lp_scene *scene;               /**< current scene being built */
 
@@ -38,9 +38,11 @@
 
 #include "lp_setup_context.h"
 #include "lp_context.h"
+#include "lp_perf.h"
 #include "draw/draw_vbuf.h"
 #include "draw/draw_vertex.h"
 #include "util/u_memory.h"
+#include "util/os_time.h"
 
 
 #define LP_MAX_VBUF_INDEXES 1024
@@ -146,6 +148,7 @@ lp_setup_draw_elements(struct vbuf_render *vbr, const ushort *indices, uint nr)
    const void *vertex_buffer = setup->vertex_buffer;
    const boolean flatshade_first = setup->flatshade_first;
    unsigned i;
+   const int64_t start_time = lp_stats_enabled() ? os_time_get_nano() : 0;
 
    assert(setup->setup.variant);
 
@@ -330,6 +333,9 @@ lp_setup_draw_elements(struct vbuf_render *vbr, const ushort *indices, uint nr)
    default:
       assert(0);
    }
+
+   if (start_time)
+      lp_stats_add(LP_STAT_SETUP_TIME, os_time_get_nano() - start_time);
 }
 
 
@@ -346,6 +352,7 @@ lp_setup_draw_arrays(struct vbuf_render *vbr, uint start, uint nr)
       (void *) get_vert(setup->vertex_buffer, start, stride);
    const boolean flatshade_first = setup->flatshade_first;
    unsigned i;
+   const int64_t start_time = lp_stats_enabled() ? os_time_get_nano() : 0;
 
    if (!lp_setup_update_state(setup, TRUE))
       return;
@@ -525,6 +532,9 @@ lp_setup_draw_arrays(struct vbuf_render *vbr, uint start, uint nr)
    default:
       assert(0);
    }
+
+   if (start_time)
+      lp_stats_add(LP_STAT_SETUP_TIME, os_time_get_nano() - start_time);
 }
 
 
@@ -113,6 +113,9 @@ llvmpipe_set_framebuffer_state(struct pipe_context *,
 void
 llvmpipe_update_fs(struct llvmpipe_context *lp);
 
+void
+llvmpipe_poll_unoptimized_fs(struct llvmpipe_context *lp);
+
 void 
 llvmpipe_update_setup(struct llvmpipe_context *lp);
 
@@ -134,6 +137,9 @@ llvmpipe_init_draw_funcs(struct llvmpipe_context *llvmpipe);
 void
 llvmpipe_init_compute_funcs(struct llvmpipe_context *llvmpipe);
 
+void
+llvmpipe_finish_compute(struct llvmpipe_context *llvmpipe);
+
 void
 llvmpipe_init_clip_funcs(struct llvmpipe_context *llvmpipe);
 
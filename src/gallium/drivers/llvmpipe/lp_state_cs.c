@@ -482,6 +482,8 @@ llvmpipe_bind_compute_state(struct pipe_context *pipe,
    if (llvmpipe->cs == cs)
       return;
 
+   llvmpipe_finish_compute(llvmpipe);
+
    llvmpipe->cs = (struct lp_compute_shader *)cs;
    llvmpipe->cs_dirty |= LP_CSNEW_CS;
 }
@@ -525,6 +527,8 @@ llvmpipe_delete_compute_state(struct pipe_context *pipe,
    struct lp_compute_shader *shader = cs;
    struct lp_cs_variant_list_item *li;
 
+   llvmpipe_finish_compute(llvmpipe);
+
    if (llvmpipe->cs == cs)
       llvmpipe->cs = NULL;
    for (unsigned i = 0; i < shader->max_global_buffers; i++)
@@ -1318,6 +1322,22 @@ fill_grid_size(struct pipe_context *pipe,
    pipe_buffer_unmap(pipe, transfer);
 }
 
+/**
+ * Wait for the dispatch llvmpipe_launch_grid left running, if any.
+ */
+void
+llvmpipe_finish_compute(struct llvmpipe_context *llvmpipe)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(llvmpipe->pipe.screen);
+
+   if (!llvmpipe->cs_pending_job)
+      return;
+
+   lp_cs_tpool_wait_for_task(screen->cs_tpool, &llvmpipe->cs_pending_task);
+   FREE(llvmpipe->cs_pending_job);
+   llvmpipe->cs_pending_job = NULL;
+}
+
 static void llvmpipe_launch_grid(struct pipe_context *pipe,
                                  const struct pipe_grid_info *info)
 {
@@ -1330,6 +1350,10 @@ static void llvmpipe_launch_grid(struct pipe_context *pipe,
 
    memset(&job_info, 0, sizeof(job_info));
 
+   /* The running dispatch uses the current jit context */
+   if (llvmpipe->cs_dirty || info->input)
+      llvmpipe_finish_compute(llvmpipe);
+
    llvmpipe_cs_update_derived(llvmpipe, info->input);
 
    fill_grid_size(pipe, info, job_info.grid_size);
@@ -1345,7 +1369,31 @@ static void llvmpipe_launch_grid(struct pipe_context *pipe,
    job_info.current = &llvmpipe->csctx->cs.current;
 
    int num_tasks = job_info.grid_size[2] * job_info.grid_size[1] * job_info.grid_size[0];
-   if (num_tasks) {
+   if (num_tasks && llvmpipe->cs_defer_wait) {
+      struct lp_cs_job_info *job = mem_dup(&job_info, sizeof(job_info));
+      struct lp_cs_tpool_task *task;
+
+      if (!job)
+         return;
+
+      mtx_lock(&screen->cs_mutex);
+      task = lp_cs_tpool_queue_task(screen->cs_tpool, cs_exec_fn, job, num_tasks);
+      mtx_unlock(&screen->cs_mutex);
+
+      /* The threads move on to this dispatch while the previous one is
+       * finishing, rather than the pool draining in between.
+       */
+      llvmpipe_finish_compute(llvmpipe);
+
+      if (task) {
+         llvmpipe->cs_pending_task = task;
+         llvmpipe->cs_pending_job = job;
+      }
+      else {
+         FREE(job);
+      }
+   }
+   else if (num_tasks) {
       struct lp_cs_tpool_task *task;
       mtx_lock(&screen->cs_mutex);
       task = lp_cs_tpool_queue_task(screen->cs_tpool, cs_exec_fn, &job_info, num_tasks);
@@ -1375,6 +1423,8 @@ llvmpipe_set_global_binding(struct pipe_context *pipe,
    struct lp_compute_shader *cs = llvmpipe->cs;
    unsigned i;
 
+   llvmpipe_finish_compute(llvmpipe);
+
    if (first + count > cs->max_global_buffers) {
       unsigned old_max = cs->max_global_buffers;
       cs->max_global_buffers = first + count;
@@ -555,6 +555,7 @@ static void fs_fb_fetch(const struct lp_build_fs_iface *iface,
 static void
 generate_fs_loop(struct gallivm_state *gallivm,
                  struct lp_fragment_shader *shader,
+                 struct nir_shader *nir,
                  const struct lp_fragment_shader_variant_key *key,
                  LLVMBuilderRef builder,
                  struct lp_type type,
@@ -965,7 +966,7 @@ generate_fs_loop(struct gallivm_state *gallivm,
       lp_build_tgsi_soa(gallivm, tokens, &params,
                         outputs);
    else
-      lp_build_nir_soa(gallivm, shader->base.ir.nir, &params,
+      lp_build_nir_soa(gallivm, nir, &params,
                        outputs);
 
    /* Alpha test */
@@ -2339,7 +2340,8 @@ generate_unswizzled_blend(struct gallivm_state *gallivm,
    undef_src_val = lp_build_undef(gallivm, fs_type);
 
    row_type.length = fs_type.length;
-   vector_width    = dst_type.floating ? lp_native_vector_width : lp_integer_vector_width;
+   /* the blend code doesn't handle more than 8 floats at a time */
+   vector_width    = dst_type.floating ? MIN2(lp_native_vector_width, 256) : lp_integer_vector_width;
 
    /* Compute correct swizzle and count channels */
    memset(swizzle, LP_BLD_SWIZZLE_DONTCARE, TGSI_NUM_CHANNELS);
@@ -2919,6 +2921,7 @@ generate_unswizzled_blend(struct gallivm_state *gallivm,
 static void
 generate_fragment(struct llvmpipe_context *lp,
                   struct lp_fragment_shader *shader,
+                  struct nir_shader *nir,
                   struct lp_fragment_shader_variant *variant,
                   unsigned partial_mask)
 {
@@ -2992,6 +2995,8 @@ generate_fragment(struct llvmpipe_context *lp,
    fs_type.norm = FALSE;         /* values are not limited to [0,1] or [-1,1] */
    fs_type.width = 32;           /* 32-bit float */
    fs_type.length = MIN2(lp_native_vector_width / 32, 16); /* n*4 elements per vector */
+   if (key->resource_1d)
+      fs_type.length = MIN2(fs_type.length, 8); /* 1d only uses the upper 4x2 */
 
    memset(&blend_type, 0, sizeof blend_type);
    blend_type.floating = FALSE; /* values are integers */
@@ -3204,7 +3209,7 @@ generate_fragment(struct llvmpipe_context *lp,
       }
 
       generate_fs_loop(gallivm,
-                       shader, key,
+                       shader, nir, key,
                        builder,
                        fs_type,
                        context_ptr,
@@ -3293,6 +3298,42 @@ generate_fragment(struct llvmpipe_context *lp,
             unsigned mask_idx = num_fs * (key->multisample ? s : 0);
             unsigned out_idx = key->min_samples == 1 ? 0 : s;
             LLVMValueRef out_ptr = color_ptr;;
+            LLVMValueRef (*out_color)[TGSI_NUM_CHANNELS][16 / 4] = fs_out_color[out_idx];
+            LLVMValueRef *out_mask = &fs_mask[mask_idx];
+            LLVMValueRef half_color[PIPE_MAX_COLOR_BUFS][TGSI_NUM_CHANNELS][16 / 4];
+            LLVMValueRef half_mask[2];
+            struct lp_type out_type = fs_type;
+            unsigned out_num_fs = num_fs;
+
+            if (fs_type.length == 16) {
+               /*
+                * Blend the 4x4 stamp as two 4x2 halves, which is what the
+                * blend code handles, the lanes are already in that order.
+                */
+               LLVMTypeRef half_ptr_type =
+                  LLVMPointerType(LLVMVectorType(LLVMFloatTypeInContext(gallivm->context), 8), 0);
+               LLVMValueRef one = lp_build_const_int32(gallivm, 1);
+               unsigned rt;
+
+               for (rt = 0; rt < PIPE_MAX_COLOR_BUFS; rt++) {
+                  /* only the target blended here and the dual source one */
+                  if (rt != cbuf && !(rt == 1 && dual_source_blend))
+                     continue;
+                  for (chan = 0; chan < TGSI_NUM_CHANNELS; ++chan) {
+                     LLVMValueRef ptr = LLVMBuildBitCast(builder, out_color[rt][chan][0],
+                                                         half_ptr_type, "");
+                     half_color[rt][chan][0] = ptr;
+                     half_color[rt][chan][1] = LLVMBuildGEP(builder, ptr, &one, 1, "");
+                  }
+               }
+               half_mask[0] = lp_build_extract_range(gallivm, out_mask[0], 0, 8);
+               half_mask[1] = lp_build_extract_range(gallivm, out_mask[0], 8, 8);
+
+               out_color = half_color;
+               out_mask = half_mask;
+               out_type.length = 8;
+               out_num_fs = 2;
+            }
 
             if (key->multisample) {
                LLVMValueRef sample_offset = LLVMBuildMul(builder, sample_stride, lp_build_const_int32(gallivm, s), "");
@@ -3304,7 +3345,7 @@ generate_fragment(struct llvmpipe_context *lp,
 
             generate_unswizzled_blend(gallivm, cbuf, variant,
                                       key->cbuf_format[cbuf],
-                                      num_fs, fs_type, &fs_mask[mask_idx], fs_out_color[out_idx],
+                                      out_num_fs, out_type, out_mask, out_color,
                                       context_ptr, out_ptr, stride,
                                       partial_mask, do_branch);
          }
@@ -3449,6 +3490,7 @@ lp_debug_fs_variant(struct lp_fragment_shader_variant *variant)
 
 static void
 lp_fs_get_ir_cache_key(struct lp_fragment_shader_variant *variant,
+                            struct nir_shader *nir,
                             unsigned char ir_sha1_cache_key[20])
 {
    struct blob blob = { 0 };
@@ -3456,7 +3498,7 @@ lp_fs_get_ir_cache_key(struct lp_fragment_shader_variant *variant,
    void *ir_binary;
 
    blob_init(&blob);
-   nir_serialize(&blob, variant->shader->base.ir.nir, true);
+   nir_serialize(&blob, nir, true);
    ir_binary = blob.data;
    ir_size = blob.size;
 
@@ -3472,11 +3514,20 @@ lp_fs_get_ir_cache_key(struct lp_fragment_shader_variant *variant,
 /**
  * Generate a new fragment shader variant from the shader code and
  * other state indicated by the key.
+ *
+ * \param nir  the shader's NIR, or a private copy of it when compiling off
+ *             the context's thread, as it gets lowered in place
+ * \param context  the LLVM context to build the code in
+ * \param unoptimized  build quickly compiled stand-in code, unless the
+ *                     optimized code is in the shader cache already
  */
 static struct lp_fragment_shader_variant *
 generate_variant(struct llvmpipe_context *lp,
                  struct lp_fragment_shader *shader,
-                 const struct lp_fragment_shader_variant_key *key)
+                 const struct lp_fragment_shader_variant_key *key,
+                 struct nir_shader *nir,
+                 LLVMContextRef context,
+                 boolean unoptimized)
 {
    struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
    struct lp_fragment_shader_variant *variant;
@@ -3491,30 +3542,39 @@ generate_variant(struct llvmpipe_context *lp,
       return NULL;
 
    memset(variant, 0, sizeof(*variant));
+   variant->no = p_atomic_inc_return(&shader->variants_created) - 1;
    snprintf(module_name, sizeof(module_name), "fs%u_variant%u",
-            shader->no, shader->variants_created);
+            shader->no, variant->no);
 
    pipe_reference_init(&variant->reference, 1);
    lp_fs_reference(lp, &variant->shader, shader);
 
    memcpy(&variant->key, key, shader->variant_key_size);
 
-   if (shader->base.ir.nir) {
-      lp_fs_get_ir_cache_key(variant, ir_sha1_cache_key);
+   if (nir) {
+      lp_fs_get_ir_cache_key(variant, nir, ir_sha1_cache_key);
 
       lp_disk_cache_find_shader(screen, &cached, ir_sha1_cache_key);
       if (!cached.data_size)
          needs_caching = true;
    }
-   variant->gallivm = gallivm_create(module_name, lp->context, &cached);
+
+   if (unoptimized && !cached.data_size) {
+      variant->gallivm = gallivm_create_unoptimized(module_name, context);
+      variant->unoptimized = TRUE;
+      needs_caching = false;
+   } else {
+      variant->gallivm = gallivm_create(module_name, context, &cached);
+   }
    if (!variant->gallivm) {
+      lp_fs_reference(lp, &variant->shader, NULL);
       FREE(variant);
       return NULL;
    }
 
    variant->list_item_global.base = variant;
    variant->list_item_local.base = variant;
-   variant->no = shader->variants_created++;
+   util_queue_fence_init(&variant->optimized_ready);
 
 
 
@@ -3540,6 +3600,24 @@ generate_variant(struct llvmpipe_context *lp,
          !shader->info.base.writes_samplemask
       ? TRUE : FALSE;
 
+   /*
+    * Whether the rasterizer can track and test the depth of whole blocks,
+    * see lp_rast_hiz.c.  Rejecting blocks is only invisible if nothing but
+    * the depth test against the interpolated depth decides their fate.
+    */
+   variant->hiz_write = key->depth.enabled && key->depth.writemask;
+   variant->hiz_plane_z = !key->depth_clamp && !shader->info.base.writes_z;
+   variant->hiz_cull =
+         key->depth.enabled &&
+         (key->depth.func == PIPE_FUNC_LESS ||
+          key->depth.func == PIPE_FUNC_LEQUAL ||
+          key->depth.func == PIPE_FUNC_GREATER ||
+          key->depth.func == PIPE_FUNC_GEQUAL) &&
+         variant->hiz_plane_z &&
+         !key->stencil[0].enabled &&
+         !key->multisample &&
+         !shader->info.base.writes_memory;
+
    if ((LP_DEBUG & DEBUG_FS) || (gallivm_debug & GALLIVM_DEBUG_IR)) {
       lp_debug_fs_variant(variant);
    }
@@ -3547,12 +3625,12 @@ generate_variant(struct llvmpipe_context *lp,
    lp_jit_init_types(variant);
    
    if (variant->jit_function[RAST_EDGE_TEST] == NULL)
-      generate_fragment(lp, shader, variant, RAST_EDGE_TEST);
+      generate_fragment(lp, shader, nir, variant, RAST_EDGE_TEST);
 
    if (variant->jit_function[RAST_WHOLE] == NULL) {
       if (variant->opaque) {
          /* Specialized shader, which doesn't need to read the color buffer. */
-         generate_fragment(lp, shader, variant, RAST_WHOLE);
+         generate_fragment(lp, shader, nir, variant, RAST_WHOLE);
       }
    }
 
@@ -3707,6 +3785,7 @@ llvmpipe_bind_fs_state(struct pipe_context *pipe, void *fs)
 
    /* invalidate the setup link, NEW_FS will make it update */
    lp_setup_set_fs_variant(llvmpipe->setup, NULL);
+   llvmpipe->unoptimized_fs_variant = NULL;
    llvmpipe->dirty |= LP_NEW_FS;
 }
 
@@ -3737,12 +3816,21 @@ void llvmpipe_remove_shader_variant(struct llvmpipe_context *lp,
    remove_from_list(&variant->list_item_global);
    lp->nr_fs_variants--;
    lp->nr_fs_instrs -= variant->nr_instrs;
+
+   if (lp->unoptimized_fs_variant == variant)
+      lp->unoptimized_fs_variant = NULL;
 }
 
 void
 llvmpipe_destroy_shader_variant(struct llvmpipe_context *lp,
                                struct lp_fragment_shader_variant *variant)
 {
+   /* The optimized replacement may still be compiling */
+   util_queue_fence_wait(&variant->optimized_ready);
+   if (variant->optimized)
+      llvmpipe_destroy_shader_variant(lp, variant->optimized);
+   util_queue_fence_destroy(&variant->optimized_ready);
+
    gallivm_destroy(variant->gallivm);
 
    lp_fs_reference(lp, &variant->shader, NULL);
@@ -3797,6 +3885,9 @@ llvmpipe_set_constant_buffer(struct pipe_context *pipe,
    assert(shader < PIPE_SHADER_TYPES);
    assert(index < ARRAY_SIZE(llvmpipe->constants[shader]));
 
+   if (shader == PIPE_SHADER_COMPUTE)
+      llvmpipe_finish_compute(llvmpipe);
+
    /* note: reference counting */
    util_copy_constant_buffer(&llvmpipe->constants[shader][index], cb,
                              take_ownership);
@@ -3850,6 +3941,10 @@ llvmpipe_set_shader_buffers(struct pipe_context *pipe,
 {
    struct llvmpipe_context *llvmpipe = llvmpipe_context(pipe);
    unsigned i, idx;
+
+   if (shader == PIPE_SHADER_COMPUTE)
+      llvmpipe_finish_compute(llvmpipe);
+
    for (i = start_slot, idx = 0; i < start_slot + count; i++, idx++) {
       const struct pipe_shader_buffer *buffer = buffers ? &buffers[idx] : NULL;
 
@@ -3885,6 +3980,9 @@ llvmpipe_set_shader_images(struct pipe_context *pipe,
    unsigned i, idx;
 
    draw_flush(llvmpipe->draw);
+   if (shader == PIPE_SHADER_COMPUTE)
+      llvmpipe_finish_compute(llvmpipe);
+
    for (i = start_slot, idx = 0; i < start_slot + count; i++, idx++) {
       const struct pipe_image_view *image = images ? &images[idx] : NULL;
 
@@ -4163,6 +4261,121 @@ make_variant_key(struct llvmpipe_context *lp,
 
 
 
+/**
+ * Insert a new variant into the shader's and the context's variant lists.
+ */
+static void
+llvmpipe_add_shader_variant(struct llvmpipe_context *lp,
+                            struct lp_fragment_shader_variant *variant)
+{
+   insert_at_head(&variant->shader->variants, &variant->list_item_local);
+   insert_at_head(&lp->fs_variants_list, &variant->list_item_global);
+   lp->nr_fs_variants++;
+   lp->nr_fs_instrs += variant->nr_instrs;
+   variant->shader->variants_cached++;
+}
+
+
+struct lp_fs_compile_job {
+   struct llvmpipe_context *lp;
+   struct lp_fragment_shader_variant *variant;
+   struct nir_shader *nir;
+};
+
+
+/**
+ * Compile the optimized counterpart of an unoptimized variant.
+ * Runs on the context's compile queue.
+ */
+static void
+lp_fs_compile_job_execute(void *data, int thread_index)
+{
+   struct lp_fs_compile_job *job = data;
+   struct lp_fragment_shader_variant *variant = job->variant;
+   LLVMContextRef context;
+
+   /* LLVM contexts can't be shared between threads */
+   context = LLVMContextCreate();
+   if (context) {
+      variant->optimized = generate_variant(job->lp, variant->shader,
+                                            &variant->key, job->nir,
+                                            context, FALSE);
+      LLVMContextDispose(context);
+   }
+
+   ralloc_free(job->nir);
+   FREE(job);
+}
+
+
+static void
+lp_fs_compile_optimized_variant(struct llvmpipe_context *lp,
+                                struct lp_fragment_shader_variant *variant)
+{
+   struct lp_fragment_shader *shader = variant->shader;
+   struct lp_fs_compile_job *job;
+
+   job = CALLOC_STRUCT(lp_fs_compile_job);
+   if (!job)
+      return;
+
+   job->lp = lp;
+   job->variant = variant;
+   /* The compile lowers the NIR it is given, so hand out a copy */
+   if (shader->base.ir.nir)
+      job->nir = nir_shader_clone(NULL, shader->base.ir.nir);
+
+   variant->optimize_queued = TRUE;
+   util_queue_add_job(&lp->fs_compile_queue, job, &variant->optimized_ready,
+                      lp_fs_compile_job_execute, NULL, 0);
+}
+
+
+/**
+ * Called for every draw while the bound fragment shader variant is an
+ * unoptimized stand-in: count the draw, start the optimized build once the
+ * variant turns out to be hot, and have the state update pick up the
+ * optimized code once it's ready.
+ */
+void
+llvmpipe_poll_unoptimized_fs(struct llvmpipe_context *lp)
+{
+   struct lp_fragment_shader_variant *variant = lp->unoptimized_fs_variant;
+
+   if (!variant->optimize_queued) {
+      if (++variant->draws >= lp->fs_optimize_threshold)
+         lp_fs_compile_optimized_variant(lp, variant);
+   }
+   else if (util_queue_fence_is_signalled(&variant->optimized_ready)) {
+      lp->dirty |= LP_NEW_FS;
+   }
+}
+
+
+/**
+ * Put the optimized variant in place of an unoptimized one whose
+ * compilation has finished.
+ */
+static struct lp_fragment_shader_variant *
+llvmpipe_replace_unoptimized_variant(struct llvmpipe_context *lp,
+                                     struct lp_fragment_shader_variant *variant)
+{
+   struct lp_fragment_shader_variant *optimized = variant->optimized;
+
+   if (!optimized)
+      return variant;
+
+   variant->optimized = NULL;
+   llvmpipe_add_shader_variant(lp, optimized);
+
+   /* scenes still in flight keep their reference to the old code */
+   llvmpipe_remove_shader_variant(lp, variant);
+   lp_fs_variant_reference(lp, &variant, NULL);
+
+   return optimized;
+}
+
+
 /**
  * Update fragment shader state.  This is called just prior to drawing
  * something when some fragment-related state has changed.
@@ -4189,6 +4402,10 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
    }
 
    if (variant) {
+      if (variant->unoptimized && variant->optimize_queued &&
+          util_queue_fence_is_signalled(&variant->optimized_ready))
+         variant = llvmpipe_replace_unoptimized_variant(lp, variant);
+
       /* Move this variant to the head of the list to implement LRU
        * deletion of shader's when we have too many.
        */
@@ -4246,7 +4463,8 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
        * Generate the new variant.
        */
       t0 = os_time_get();
-      variant = generate_variant(lp, shader, key);
+      variant = generate_variant(lp, shader, key, shader->base.ir.nir,
+                                 lp->context, lp->async_fs_compile);
       t1 = os_time_get();
       dt = t1 - t0;
       LP_COUNT_ADD(llvm_compile_time, dt);
@@ -4254,16 +4472,24 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
 
       /* Put the new variant into the list */
       if (variant) {
-         insert_at_head(&shader->variants, &variant->list_item_local);
-         insert_at_head(&lp->fs_variants_list, &variant->list_item_global);
-         lp->nr_fs_variants++;
-         lp->nr_fs_instrs += variant->nr_instrs;
-         shader->variants_cached++;
+         llvmpipe_add_shader_variant(lp, variant);
+
+         if (variant->unoptimized && !lp->fs_optimize_threshold)
+            lp_fs_compile_optimized_variant(lp, variant);
       }
    }
 
    /* Bind this variant */
    lp_setup_set_fs_variant(lp->setup, variant);
+
+   /* Have the draws count towards optimizing the variant, and pick up the
+    * optimized code once it's ready
+    */
+   lp->unoptimized_fs_variant =
+      variant && variant->unoptimized &&
+      !(variant->optimize_queued &&
+        util_queue_fence_is_signalled(&variant->optimized_ready)) ?
+      variant : NULL;
 }
 
 
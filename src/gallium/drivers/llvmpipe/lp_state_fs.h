@@ -37,6 +37,7 @@
 #include "gallivm/lp_bld_tgsi.h" /* for lp_tgsi_info */
 #include "lp_bld_interp.h" /* for struct lp_shader_input */
 #include "util/u_inlines.h"
+#include "util/u_queue.h"
 #include "lp_jit.h"
 
 struct tgsi_token;
@@ -140,6 +141,11 @@ struct lp_fragment_shader_variant
    struct pipe_reference reference;
    boolean opaque;
 
+   /* Hierarchical depth, see lp_rast_hiz.c */
+   unsigned hiz_cull:1;     /**< blocks may be rejected by their depth */
+   unsigned hiz_write:1;    /**< writes depth */
+   unsigned hiz_plane_z:1;  /**< depth is the interpolated fragment z */
+
    struct gallivm_state *gallivm;
 
    LLVMTypeRef jit_context_ptr_type;
@@ -153,6 +159,20 @@ struct lp_fragment_shader_variant
    /* Total number of LLVM instructions generated */
    unsigned nr_instrs;
 
+   /*
+    * Asynchronous compilation (LP_ASYNC_COMPILE): unoptimized variants are
+    * used until the optimized variant for the same key, compiled on the
+    * context's compile queue, is ready to take their place.  The optimized
+    * build is only queued once the variant has been drawn with
+    * fs_optimize_threshold times, so code that is barely used never pays
+    * for it.
+    */
+   boolean unoptimized;
+   boolean optimize_queued;
+   unsigned draws;
+   struct util_queue_fence optimized_ready;
+   struct lp_fragment_shader_variant *optimized;
+
    struct lp_fs_variant_list_item list_item_global, list_item_local;
    struct lp_fragment_shader *shader;
 
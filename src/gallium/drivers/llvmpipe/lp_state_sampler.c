@@ -79,6 +79,8 @@ llvmpipe_bind_sampler_states(struct pipe_context *pipe,
    assert(start + num <= ARRAY_SIZE(llvmpipe->samplers[shader]));
 
    draw_flush(llvmpipe->draw);
+   if (shader == PIPE_SHADER_COMPUTE)
+      llvmpipe_finish_compute(llvmpipe);
 
    /* set the new samplers */
    for (i = 0; i < num; i++) {
@@ -131,6 +133,8 @@ llvmpipe_set_sampler_views(struct pipe_context *pipe,
    assert(start + num <= ARRAY_SIZE(llvmpipe->sampler_views[shader]));
 
    draw_flush(llvmpipe->draw);
+   if (shader == PIPE_SHADER_COMPUTE)
+      llvmpipe_finish_compute(llvmpipe);
 
    /* set the new sampler views */
    for (i = 0; i < num; i++) {
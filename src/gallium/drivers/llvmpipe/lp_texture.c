@@ -44,6 +44,7 @@
 #include "util/u_transfer.h"
 
 #include "lp_context.h"
+#include "lp_fence.h"
 #include "lp_flush.h"
 #include "lp_screen.h"
 #include "lp_texture.h"
@@ -362,6 +363,7 @@ llvmpipe_resource_destroy(struct pipe_screen *pscreen,
       if (lpr->dt) {
          /* display target */
          struct sw_winsys *winsys = screen->winsys;
+         lp_fence_reference(&lpr->dt_fence, NULL);
          winsys->displaytarget_destroy(winsys, lpr->dt);
       }
       else if (llvmpipe_resource_is_texture(pt)) {
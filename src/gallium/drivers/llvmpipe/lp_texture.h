@@ -47,6 +47,7 @@ struct pipe_screen;
 struct llvmpipe_context;
 
 struct sw_displaytarget;
+struct lp_fence;
 
 
 /**
@@ -75,6 +76,12 @@ struct llvmpipe_resource
     */
    struct sw_displaytarget *dt;
 
+   /**
+    * Fence of the last scene rendering to the display target, so it can be
+    * presented as soon as that is done.
+    */
+   struct lp_fence *dt_fence;
+
    /**
     * Malloc'ed data for regular textures, or a mapping to dt above.
     */
@@ -89,10 +89,16 @@ nouveau_screen_fence_finish(struct pipe_screen *screen,
                             struct pipe_fence_handle *pfence,
                             uint64_t timeout)
 {
-   if (!timeout)
-      return nouveau_fence_signalled(nouveau_fence(pfence));
+   struct nouveau_fence *fence = nouveau_fence(pfence);
 
-   return nouveau_fence_wait(nouveau_fence(pfence), NULL);
+   if (!timeout) {
+      /* A deferred flush may not have submitted the fence yet. */
+      if (ctx && fence->state < NOUVEAU_FENCE_STATE_FLUSHED)
+         ctx->flush(ctx, NULL, 0);
+      return nouveau_fence_signalled(fence);
+   }
+
+   return nouveau_fence_wait(fence, NULL);
 }
 
 
@@ -86,7 +86,11 @@ nvc0_flush(struct pipe_context *pipe,
    if (fence)
       nouveau_fence_ref(screen->fence.current, (struct nouveau_fence **)fence);
 
-   PUSH_KICK(nvc0->base.pushbuf); /* fencing handled in kick_notify */
+   /* The fence is emitted with whatever kick comes next, or by fence_finish
+    * if somebody waits on it first, so deferred flushes don't need to submit.
+    */
+   if (!(flags & PIPE_FLUSH_DEFERRED))
+      PUSH_KICK(nvc0->base.pushbuf); /* fencing handled in kick_notify */
 
    nouveau_context_update_frame_stats(&nvc0->base);
 }
@@ -1395,6 +1395,10 @@ emit_image_attribs(struct panfrost_batch *batch, enum pipe_shader_type shader,
                         flags |= PAN_BO_ACCESS_WRITE;
                         unsigned level = is_buffer ? 0 : image->u.tex.level;
                         rsrc->layout.slices[level].initialized = true;
+
+                        /* Image stores bypass the tile writeback, so the
+                         * CRCs no longer match the contents */
+                        rsrc->layout.slices[level].checksum_valid = false;
                 }
                 panfrost_batch_add_bo(batch, rsrc->bo, flags);
 
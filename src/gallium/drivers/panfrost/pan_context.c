@@ -1449,6 +1449,7 @@ panfrost_destroy(struct pipe_context *pipe)
         util_unreference_framebuffer_state(&panfrost->pipe_framebuffer);
         u_upload_destroy(pipe->stream_uploader);
         u_upload_destroy(panfrost->state_uploader);
+        pan_slab_ring_cleanup(&panfrost->transient_ring);
 
         ralloc_free(pipe);
 }
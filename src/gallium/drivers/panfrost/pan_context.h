@@ -119,6 +119,9 @@ struct panfrost_context {
         /* panfrost_bo -> panfrost_bo_access */
         struct hash_table *accessed_bos;
 
+        /* Transient slabs recycled between the batch pools */
+        struct pan_slab_ring transient_ring;
+
         /* Within a launch_grid call.. */
         const struct pipe_grid_info *compute_grid;
 
@@ -1121,11 +1121,16 @@ pan_resource_modifier_convert(struct panfrost_context *ctx,
         panfrost_bo_unreference(rsrc->bo);
         if (rsrc->checksum_bo)
                 panfrost_bo_unreference(rsrc->checksum_bo);
+        rsrc->checksum_bo = NULL;
 
         rsrc->bo = tmp_rsrc->bo;
         panfrost_bo_reference(rsrc->bo);
 
         panfrost_resource_setup(pan_device(ctx->base.screen), rsrc, NULL, modifier);
+
+        /* The CRCs tracked so far describe the old BO */
+        for (unsigned i = 0; i <= rsrc->base.last_level; ++i)
+                rsrc->layout.slices[i].checksum_valid = false;
         pipe_resource_reference(&tmp_prsrc, NULL);
 }
 
@@ -89,6 +89,12 @@ The compiler must issue the source argument to slots z, y, and x
       face_gpr.w = SampleID
 */
 #define R600_SHADER_BUFFER_INFO_SEL (512 + R600_BUFFER_INFO_OFFSET / 16)
+
+/* Shaders below this size (blits, clears, pass-through stages) gain next to
+ * nothing from the sb optimizer, so they skip it to save compile time.
+ */
+#define R600_SB_MIN_SHADER_DWORDS 64
+
 static int r600_shader_from_tgsi(struct r600_context *rctx,
 				 struct r600_pipe_shader *pipeshader,
 				 union r600_shader_key key);
@@ -267,6 +273,9 @@ int r600_pipe_shader_create(struct pipe_context *ctx,
 		}
 	}
 
+	if (shader->shader.bc.ndw < R600_SB_MIN_SHADER_DWORDS)
+		use_sb = 0;
+
 	sb_disasm = use_sb || (rctx->screen->b.debug_flags & DBG_SB_DISASM);
 	if (dump && !sb_disasm) {
 		fprintf(stderr, "--------------------------------------------------------------\n");
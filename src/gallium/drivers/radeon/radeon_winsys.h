@@ -126,6 +126,8 @@ enum radeon_value_id
    RADEON_MAPPED_GTT,
    RADEON_SLAB_WASTED_VRAM,
    RADEON_SLAB_WASTED_GTT,
+   RADEON_NUM_SLAB_ALLOCS,
+   RADEON_NUM_SLABS_CREATED,
    RADEON_BUFFER_WAIT_TIME_NS,
    RADEON_NUM_MAPPED_BUFFERS,
    RADEON_TIMESTAMP,
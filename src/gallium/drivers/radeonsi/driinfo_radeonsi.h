@@ -4,6 +4,10 @@ DRI_CONF_ADAPTIVE_SYNC(true)
 DRI_CONF_RADEONSI_ASSUME_NO_Z_FIGHTS(false)
 DRI_CONF_RADEONSI_COMMUTATIVE_BLEND_ADD(false)
 DRI_CONF_RADEONSI_ZERO_ALL_VRAM_ALLOCS(false)
+DRI_CONF_RADEONSI_PRIM_DISCARD_CS(false)
+DRI_CONF_RADEONSI_PRIM_DISCARD_CS_MIN_TRIANGLES(0)
+DRI_CONF_RADEONSI_NGG_CULL_VERT_THRESHOLD(-1)
+DRI_CONF_RADEONSI_NGG_CULL_TESS(false)
 DRI_CONF_SECTION_END
 
 DRI_CONF_SECTION_DEBUG
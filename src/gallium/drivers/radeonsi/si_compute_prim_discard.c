@@ -102,7 +102,6 @@
  * - Instancing is only supported with 16-bit indices and instance count <= 2^16.
  * - The instance divisor buffer is unavailable, so all divisors must be
  *   either 0 or 1.
- * - Multidraws where the vertex shader reads gl_DrawID are unsupported.
  * - No support for tessellation and geometry shaders.
  *   (patch elimination where tess factors are 0 would be possible to implement)
  * - The vertex shader must not contain memory stores.
@@ -137,6 +136,7 @@
  *     - Bits [5:31]: The number of primitives per instance for computing the remainder.
  *   PRIMITIVE_RESTART_INDEX
  *   SMALL_PRIM_CULLING_PRECISION: Scale the primitive bounding box by this number.
+ *   DRAW_ID: gl_DrawID of the current draw of a multi draw
  *
  *
  * The code contains 3 codepaths:
@@ -199,12 +199,22 @@ void si_initialize_prim_discard_tunables(struct si_screen *sscreen, bool is_aux_
    bool enable_on_pro_graphics_by_default = false;
 
    if (sscreen->debug_flags & DBG(ALWAYS_PD) || sscreen->debug_flags & DBG(PD) ||
+       sscreen->prim_discard_cs ||
        (enable_on_pro_graphics_by_default && sscreen->info.is_pro_graphics &&
         (sscreen->info.family == CHIP_BONAIRE || sscreen->info.family == CHIP_HAWAII ||
          sscreen->info.family == CHIP_TONGA || sscreen->info.family == CHIP_FIJI ||
          sscreen->info.family == CHIP_POLARIS10 || sscreen->info.family == CHIP_POLARIS11 ||
          sscreen->info.family == CHIP_VEGA10 || sscreen->info.family == CHIP_VEGA20))) {
-      *prim_discard_vertex_count_threshold = 6000 * 3; /* 6K triangles */
+      unsigned min_triangles = sscreen->prim_discard_cs_min_triangles;
+
+      /* Smaller draws can't occupy all CUs with culling waves, so the cost of
+       * signaling the gfx IB isn't worth it. 1 threadgroup per CU, but at least
+       * 6K triangles.
+       */
+      if (!min_triangles)
+         min_triangles = MAX2(6000, sscreen->info.num_good_compute_units * THREADGROUP_SIZE);
+
+      *prim_discard_vertex_count_threshold = min_triangles * 3;
 
       if (sscreen->debug_flags & DBG(ALWAYS_PD))
          *prim_discard_vertex_count_threshold = 0; /* always enable */
@@ -323,6 +333,7 @@ void si_build_prim_discard_compute_shader(struct si_shader_context *ctx)
    struct ac_arg param_restart_index, param_smallprim_precision;
    struct ac_arg param_num_prims_udiv_multiplier, param_num_prims_udiv_terms;
    struct ac_arg param_sampler_desc, param_last_wave_prim_id, param_vertex_count_addr;
+   struct ac_arg param_draw_id;
 
    ac_add_arg(&ctx->args, AC_ARG_SGPR, 1, AC_ARG_CONST_DESC_PTR,
               &param_index_buffers_and_constants);
@@ -338,6 +349,7 @@ void si_build_prim_discard_compute_shader(struct si_shader_context *ctx)
    ac_add_arg(&ctx->args, AC_ARG_SGPR, 1, AC_ARG_INT, &param_num_prims_udiv_terms);
    ac_add_arg(&ctx->args, AC_ARG_SGPR, 1, AC_ARG_INT, &param_restart_index);
    ac_add_arg(&ctx->args, AC_ARG_SGPR, 1, AC_ARG_FLOAT, &param_smallprim_precision);
+   ac_add_arg(&ctx->args, AC_ARG_SGPR, 1, AC_ARG_INT, &param_draw_id);
 
    /* Block ID and thread ID inputs. */
    ac_add_arg(&ctx->args, AC_ARG_SGPR, 1, AC_ARG_INT, &param_block_id);
@@ -370,7 +382,7 @@ void si_build_prim_discard_compute_shader(struct si_shader_context *ctx)
       LLVMConstInt(ctx->ac.i32, S_VS_STATE_INDEXED(key->opt.cs_indexed), 0);
    vs_params[num_vs_params++] = ac_get_arg(&ctx->ac, param_base_vertex);
    vs_params[num_vs_params++] = ac_get_arg(&ctx->ac, param_start_instance);
-   vs_params[num_vs_params++] = ctx->ac.i32_0; /* DrawID */
+   vs_params[num_vs_params++] = ac_get_arg(&ctx->ac, param_draw_id);
    vs_params[num_vs_params++] = ac_get_arg(&ctx->ac, param_vb_desc);
 
    vs_params[(param_vertex_id = num_vs_params++)] = NULL;   /* VertexID */
@@ -992,6 +1004,7 @@ si_prepare_prim_discard_or_split_draw(struct si_context *sctx, const struct pipe
 
       /* Split multi draws first. */
       if (num_draws > 1) {
+         struct pipe_draw_info split_info = *info;
          unsigned count = 0;
          unsigned first_draw = 0;
          unsigned num_draws_split = 0;
@@ -999,7 +1012,8 @@ si_prepare_prim_discard_or_split_draw(struct si_context *sctx, const struct pipe
          for (unsigned i = 0; i < num_draws; i++) {
             if (count && count + draws[i].count > vert_count_per_subdraw) {
                /* Submit previous draws.  */
-               sctx->b.draw_vbo(&sctx->b, info, NULL, draws + first_draw, num_draws_split);
+               split_info.drawid = info->drawid + (info->increment_draw_id ? first_draw : 0);
+               sctx->b.draw_vbo(&sctx->b, &split_info, NULL, draws + first_draw, num_draws_split);
                count = 0;
                first_draw = i;
                num_draws_split = 0;
@@ -1007,7 +1021,8 @@ si_prepare_prim_discard_or_split_draw(struct si_context *sctx, const struct pipe
 
             if (draws[i].count > vert_count_per_subdraw) {
                /* Submit just 1 draw. It will be split. */
-               sctx->b.draw_vbo(&sctx->b, info, NULL, draws + i, 1);
+               split_info.drawid = info->drawid + (info->increment_draw_id ? i : 0);
+               sctx->b.draw_vbo(&sctx->b, &split_info, NULL, draws + i, 1);
                assert(count == 0);
                assert(first_draw == i);
                assert(num_draws_split == 0);
@@ -1018,6 +1033,12 @@ si_prepare_prim_discard_or_split_draw(struct si_context *sctx, const struct pipe
             count += draws[i].count;
             num_draws_split++;
          }
+
+         /* Submit the remaining draws. */
+         if (num_draws_split) {
+            split_info.drawid = info->drawid + (info->increment_draw_id ? first_draw : 0);
+            sctx->b.draw_vbo(&sctx->b, &split_info, NULL, draws + first_draw, num_draws_split);
+         }
          return SI_PRIM_DISCARD_MULTI_DRAW_SPLIT;
       }
 
@@ -1066,8 +1087,8 @@ si_prepare_prim_discard_or_split_draw(struct si_context *sctx, const struct pipe
    }
 
    unsigned num_subdraws = DIV_ROUND_UP(num_prims, SPLIT_PRIMS_PACKET_LEVEL) * num_draws;
-   unsigned need_compute_dw = 11 /* shader */ + 34 /* first draw */ +
-                              24 * (num_subdraws - 1) + /* subdraws */
+   unsigned need_compute_dw = 11 /* shader */ + 35 /* first draw */ +
+                              25 * (num_subdraws - 1) + /* subdraws */
                               30;                       /* leave some space at the end */
    unsigned need_gfx_dw = si_get_minimum_num_gfx_cs_dwords(sctx, 0);
 
@@ -1076,6 +1097,9 @@ si_prepare_prim_discard_or_split_draw(struct si_context *sctx, const struct pipe
    else
       need_gfx_dw += num_subdraws * 8; /* use REWIND(2) + DRAW(6) */
 
+   /* BASE_VERTEX and DRAWID are updated between the draws of a multi draw. */
+   need_gfx_dw += (num_draws - 1) * 4;
+
    if (ring_full ||
        (VERTEX_COUNTER_GDS_MODE == 1 && sctx->compute_gds_offset + 8 > GDS_SIZE_UNORDERED) ||
        !sctx->ws->cs_check_space(gfx_cs, need_gfx_dw, false)) {
@@ -1140,7 +1164,7 @@ void si_dispatch_prim_discard_cs_and_draw(struct si_context *sctx,
                                           const struct pipe_draw_info *info,
                                           unsigned count, unsigned index_size,
                                           unsigned base_vertex, uint64_t input_indexbuf_va,
-                                          unsigned input_indexbuf_num_elements)
+                                          unsigned input_indexbuf_num_elements, unsigned draw_id)
 {
    struct radeon_cmdbuf *gfx_cs = &sctx->gfx_cs;
    struct radeon_cmdbuf *cs = &sctx->prim_discard_compute_cs;
@@ -1321,7 +1345,7 @@ void si_dispatch_prim_discard_cs_and_draw(struct si_context *sctx,
 
    /* Set user data SGPRs. */
    /* This can't be greater than 14 if we want the fastest launch rate. */
-   unsigned user_sgprs = 13;
+   unsigned user_sgprs = 14;
 
    uint64_t index_buffers_va = indexbuf_desc->gpu_address + indexbuf_desc_offset;
    unsigned vs_const_desc = si_const_and_shader_buffer_descriptors_idx(PIPE_SHADER_VERTEX);
@@ -1495,6 +1519,7 @@ void si_dispatch_prim_discard_cs_and_draw(struct si_context *sctx,
          radeon_emit(cs, info->restart_index);
          /* small-prim culling precision (same as rasterizer precision = QUANT_MODE) */
          radeon_emit(cs, fui(cull_info.small_prim_precision));
+         radeon_emit(cs, draw_id);
       } else {
          assert(VERTEX_COUNTER_GDS_MODE == 2);
          /* Only update the SGPRs that changed. */
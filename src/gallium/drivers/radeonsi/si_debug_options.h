@@ -1,6 +1,9 @@
 OPT_BOOL(inline_uniforms, false, "Optimize shaders by replacing uniforms with literals")
 OPT_BOOL(aux_debug, false, "Generate ddebug_dumps for the auxiliary context")
 OPT_BOOL(sync_compile, false, "Always compile synchronously (will cause stalls)")
+OPT_BOOL(async_mono_variants, false,
+         "Compile optimized variants of monolithic-only shaders asynchronously, "
+         "using the variant without optimizations until they are ready")
 OPT_BOOL(dump_shader_binary, false, "Dump shader binary as part of ddebug_dumps")
 OPT_BOOL(debug_disassembly, false,
          "Report shader disassembly as part of driver debug messages (for shader db)")
@@ -126,6 +126,7 @@ static const struct debug_named_value test_options[] = {
    {"testvmfaultcp", DBG(TEST_VMFAULT_CP), "Invoke a CP VM fault test and exit."},
    {"testvmfaultshader", DBG(TEST_VMFAULT_SHADER), "Invoke a shader VM fault test and exit."},
    {"testdmaperf", DBG(TEST_DMA_PERF), "Test DMA performance"},
+   {"testimageperf", DBG(TEST_IMAGE_PERF), "Test image clear, copy, blit and decompression performance"},
    {"testgds", DBG(TEST_GDS), "Test GDS."},
    {"testgdsmm", DBG(TEST_GDS_MM), "Test GDS memory management."},
    {"testgdsoamm", DBG(TEST_GDS_OA_MM), "Test GDS OA memory management."},
@@ -523,6 +524,11 @@ static struct pipe_context *si_create_context(struct pipe_screen *screen, unsign
    if (!sctx->b.stream_uploader)
       goto fail;
 
+   /* Cycle through a few upload buffers instead of allocating a new one
+    * whenever the current one is full.
+    */
+   u_upload_enable_ring(sctx->b.stream_uploader, 4);
+
    if (smart_access_memory || is_apu) {
       sctx->b.const_uploader = sctx->b.stream_uploader;
    } else {
@@ -986,6 +992,13 @@ static struct pipe_screen *radeonsi_screen_create_impl(struct radeon_winsys *ws,
 #include "si_debug_options.h"
    }
 
+   sscreen->prim_discard_cs = driQueryOptionb(config->options, "radeonsi_prim_discard_cs");
+   sscreen->prim_discard_cs_min_triangles =
+      driQueryOptioni(config->options, "radeonsi_prim_discard_cs_min_triangles");
+   sscreen->ngg_cull_vert_threshold =
+      driQueryOptioni(config->options, "radeonsi_ngg_cull_vert_threshold");
+   sscreen->ngg_cull_tess = driQueryOptionb(config->options, "radeonsi_ngg_cull_tess");
+
    sscreen->ws = ws;
    ws->query_info(ws, &sscreen->info,
                   sscreen->options.enable_sam,
@@ -1344,6 +1357,9 @@ static struct pipe_screen *radeonsi_screen_create_impl(struct radeon_winsys *ws,
       si_test_dma_perf(sscreen);
    }
 
+   if (test_flags & DBG(TEST_IMAGE_PERF))
+      si_test_image_perf(sscreen);
+
    if (test_flags & (DBG(TEST_VMFAULT_CP) | DBG(TEST_VMFAULT_SHADER)))
       si_test_vmfault(sscreen, test_flags);
 
@@ -250,6 +250,7 @@ enum
    DBG_TEST_VMFAULT_CP,
    DBG_TEST_VMFAULT_SHADER,
    DBG_TEST_DMA_PERF,
+   DBG_TEST_IMAGE_PERF,
    DBG_TEST_GDS,
    DBG_TEST_GDS_MM,
    DBG_TEST_GDS_OA_MM,
@@ -549,6 +550,10 @@ struct si_screen {
    bool has_out_of_order_rast;
    bool assume_no_z_fights;
    bool commutative_blend_add;
+   bool prim_discard_cs;
+   unsigned prim_discard_cs_min_triangles;
+   int ngg_cull_vert_threshold; /* -1 = chip default */
+   bool ngg_cull_tess;
    bool dpbb_allowed;
    bool dfsm_allowed;
    bool llvm_has_working_vgpr_indexing;
@@ -1238,6 +1243,8 @@ struct si_context {
    unsigned num_draw_calls;
    unsigned num_decompress_calls;
    unsigned num_prim_restart_calls;
+   unsigned num_ngg_culling_draw_calls;
+   uint64_t num_ngg_culling_vertices; /* of direct draws */
    unsigned num_compute_calls;
    unsigned num_cp_dma_calls;
    unsigned num_vs_flushes;
@@ -1495,7 +1502,7 @@ void si_dispatch_prim_discard_cs_and_draw(struct si_context *sctx,
                                           const struct pipe_draw_info *info,
                                           unsigned count, unsigned index_size,
                                           unsigned base_vertex, uint64_t input_indexbuf_va,
-                                          unsigned input_indexbuf_max_elements);
+                                          unsigned input_indexbuf_max_elements, unsigned draw_id);
 void si_initialize_prim_discard_tunables(struct si_screen *sscreen, bool is_aux_context,
                                          unsigned *prim_discard_vertex_count_threshold,
                                          unsigned *index_ring_size_per_ib);
@@ -1541,6 +1548,9 @@ void si_test_blit(struct si_screen *sscreen);
 /* si_test_clearbuffer.c */
 void si_test_dma_perf(struct si_screen *sscreen);
 
+/* si_test_image_perf.c */
+void si_test_image_perf(struct si_screen *sscreen);
+
 /* si_uvd.c */
 struct pipe_video_codec *si_uvd_create_decoder(struct pipe_context *context,
                                                const struct pipe_video_codec *templ);
@@ -133,15 +133,16 @@ void si_pm4_emit(struct si_context *sctx, struct si_pm4_state *state)
 void si_pm4_reset_emitted(struct si_context *sctx, bool first_cs)
 {
    if (!first_cs && sctx->shadowed_regs) {
-      /* Only dirty states that contain buffers, so that they are
-       * added to the buffer list on the next draw call.
+      /* The registers of emitted states are restored by the CP, so only add
+       * the shader binaries to the buffer list instead of emitting the states
+       * again. States that are queued but not emitted are still dirty.
        */
       for (unsigned i = 0; i < SI_NUM_STATES; i++) {
          struct si_pm4_state *state = sctx->emitted.array[i];
 
          if (state && state->shader) {
-            sctx->emitted.array[i] = NULL;
-            sctx->dirty_states |= 1 << i;
+            radeon_add_to_buffer_list(sctx, &sctx->gfx_cs, state->shader->bo,
+                                      RADEON_USAGE_READ, RADEON_PRIO_SHADER_BINARY);
          }
       }
       return;
@@ -81,6 +81,10 @@ static enum radeon_value_id winsys_id_from_type(unsigned type)
       return RADEON_SLAB_WASTED_VRAM;
    case SI_QUERY_SLAB_WASTED_GTT:
       return RADEON_SLAB_WASTED_GTT;
+   case SI_QUERY_NUM_SLAB_ALLOCS:
+      return RADEON_NUM_SLAB_ALLOCS;
+   case SI_QUERY_NUM_SLABS_CREATED:
+      return RADEON_NUM_SLABS_CREATED;
    case SI_QUERY_BUFFER_WAIT_TIME:
       return RADEON_BUFFER_WAIT_TIME_NS;
    case SI_QUERY_NUM_MAPPED_BUFFERS:
@@ -134,6 +138,12 @@ static bool si_query_sw_begin(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_PRIM_RESTART_CALLS:
       query->begin_result = sctx->num_prim_restart_calls;
       break;
+   case SI_QUERY_NGG_CULLING_DRAW_CALLS:
+      query->begin_result = sctx->num_ngg_culling_draw_calls;
+      break;
+   case SI_QUERY_NGG_CULLING_VERTICES:
+      query->begin_result = sctx->num_ngg_culling_vertices;
+      break;
    case SI_QUERY_COMPUTE_CALLS:
       query->begin_result = sctx->num_compute_calls;
       break;
@@ -173,6 +183,9 @@ static bool si_query_sw_begin(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_TC_NUM_SYNCS:
       query->begin_result = sctx->tc ? sctx->tc->num_syncs : 0;
       break;
+   case SI_QUERY_TC_NUM_STALLS:
+      query->begin_result = sctx->tc ? sctx->tc->num_stalls : 0;
+      break;
    case SI_QUERY_REQUESTED_VRAM:
    case SI_QUERY_REQUESTED_GTT:
    case SI_QUERY_MAPPED_VRAM:
@@ -192,6 +205,8 @@ static bool si_query_sw_begin(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_BUFFER_WAIT_TIME:
    case SI_QUERY_GFX_IB_SIZE:
    case SI_QUERY_NUM_GFX_IBS:
+   case SI_QUERY_NUM_SLAB_ALLOCS:
+   case SI_QUERY_NUM_SLABS_CREATED:
    case SI_QUERY_NUM_BYTES_MOVED:
    case SI_QUERY_NUM_EVICTIONS:
    case SI_QUERY_NUM_VRAM_CPU_PAGE_FAULTS: {
@@ -302,6 +317,12 @@ static bool si_query_sw_end(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_PRIM_RESTART_CALLS:
       query->end_result = sctx->num_prim_restart_calls;
       break;
+   case SI_QUERY_NGG_CULLING_DRAW_CALLS:
+      query->end_result = sctx->num_ngg_culling_draw_calls;
+      break;
+   case SI_QUERY_NGG_CULLING_VERTICES:
+      query->end_result = sctx->num_ngg_culling_vertices;
+      break;
    case SI_QUERY_COMPUTE_CALLS:
       query->end_result = sctx->num_compute_calls;
       break;
@@ -341,6 +362,9 @@ static bool si_query_sw_end(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_TC_NUM_SYNCS:
       query->end_result = sctx->tc ? sctx->tc->num_syncs : 0;
       break;
+   case SI_QUERY_TC_NUM_STALLS:
+      query->end_result = sctx->tc ? sctx->tc->num_stalls : 0;
+      break;
    case SI_QUERY_REQUESTED_VRAM:
    case SI_QUERY_REQUESTED_GTT:
    case SI_QUERY_MAPPED_VRAM:
@@ -357,6 +381,8 @@ static bool si_query_sw_end(struct si_context *sctx, struct si_query *squery)
    case SI_QUERY_GFX_IB_SIZE:
    case SI_QUERY_NUM_MAPPED_BUFFERS:
    case SI_QUERY_NUM_GFX_IBS:
+   case SI_QUERY_NUM_SLAB_ALLOCS:
+   case SI_QUERY_NUM_SLABS_CREATED:
    case SI_QUERY_NUM_BYTES_MOVED:
    case SI_QUERY_NUM_EVICTIONS:
    case SI_QUERY_NUM_VRAM_CPU_PAGE_FAULTS: {
@@ -1680,6 +1706,8 @@ static struct pipe_driver_query_info si_driver_query_list[] = {
    X("draw-calls", DRAW_CALLS, UINT64, AVERAGE),
    X("decompress-calls", DECOMPRESS_CALLS, UINT64, AVERAGE),
    X("prim-restart-calls", PRIM_RESTART_CALLS, UINT64, AVERAGE),
+   X("ngg-culling-draw-calls", NGG_CULLING_DRAW_CALLS, UINT64, AVERAGE),
+   X("ngg-culling-vertices", NGG_CULLING_VERTICES, UINT64, AVERAGE),
    X("compute-calls", COMPUTE_CALLS, UINT64, AVERAGE),
    X("cp-dma-calls", CP_DMA_CALLS, UINT64, AVERAGE),
    X("num-vs-flushes", NUM_VS_FLUSHES, UINT64, AVERAGE),
@@ -1693,6 +1721,7 @@ static struct pipe_driver_query_info si_driver_query_list[] = {
    X("tc-offloaded-slots", TC_OFFLOADED_SLOTS, UINT64, AVERAGE),
    X("tc-direct-slots", TC_DIRECT_SLOTS, UINT64, AVERAGE),
    X("tc-num-syncs", TC_NUM_SYNCS, UINT64, AVERAGE),
+   X("tc-num-stalls", TC_NUM_STALLS, UINT64, AVERAGE),
    X("CS-thread-busy", CS_THREAD_BUSY, UINT64, AVERAGE),
    X("gallium-thread-busy", GALLIUM_THREAD_BUSY, UINT64, AVERAGE),
    X("requested-VRAM", REQUESTED_VRAM, BYTES, AVERAGE),
@@ -1701,6 +1730,8 @@ static struct pipe_driver_query_info si_driver_query_list[] = {
    X("mapped-GTT", MAPPED_GTT, BYTES, AVERAGE),
    X("slab-wasted-VRAM", SLAB_WASTED_VRAM, BYTES, AVERAGE),
    X("slab-wasted-GTT", SLAB_WASTED_GTT, BYTES, AVERAGE),
+   X("num-slab-allocs", NUM_SLAB_ALLOCS, UINT64, AVERAGE),
+   X("num-slabs-created", NUM_SLABS_CREATED, UINT64, AVERAGE),
    X("buffer-wait-time", BUFFER_WAIT_TIME, MICROSECONDS, CUMULATIVE),
    X("num-mapped-buffers", NUM_MAPPED_BUFFERS, UINT64, AVERAGE),
    X("num-GFX-IBs", NUM_GFX_IBS, UINT64, AVERAGE),
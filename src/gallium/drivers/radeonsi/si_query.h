@@ -45,6 +45,8 @@ enum
    SI_QUERY_DRAW_CALLS = PIPE_QUERY_DRIVER_SPECIFIC,
    SI_QUERY_DECOMPRESS_CALLS,
    SI_QUERY_PRIM_RESTART_CALLS,
+   SI_QUERY_NGG_CULLING_DRAW_CALLS,
+   SI_QUERY_NGG_CULLING_VERTICES,
    SI_QUERY_COMPUTE_CALLS,
    SI_QUERY_CP_DMA_CALLS,
    SI_QUERY_NUM_VS_FLUSHES,
@@ -58,6 +60,7 @@ enum
    SI_QUERY_TC_OFFLOADED_SLOTS,
    SI_QUERY_TC_DIRECT_SLOTS,
    SI_QUERY_TC_NUM_SYNCS,
+   SI_QUERY_TC_NUM_STALLS,
    SI_QUERY_CS_THREAD_BUSY,
    SI_QUERY_GALLIUM_THREAD_BUSY,
    SI_QUERY_REQUESTED_VRAM,
@@ -66,6 +69,8 @@ enum
    SI_QUERY_MAPPED_GTT,
    SI_QUERY_SLAB_WASTED_VRAM,
    SI_QUERY_SLAB_WASTED_GTT,
+   SI_QUERY_NUM_SLAB_ALLOCS,
+   SI_QUERY_NUM_SLABS_CREATED,
    SI_QUERY_BUFFER_WAIT_TIME,
    SI_QUERY_NUM_MAPPED_BUFFERS,
    SI_QUERY_NUM_GFX_IBS,
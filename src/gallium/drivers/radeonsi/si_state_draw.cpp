@@ -35,6 +35,11 @@
 /* special primitive types */
 #define SI_PRIM_RECTANGLE_LIST PIPE_PRIM_MAX
 
+/* Minimum number of draws of a multi draw using DrawID to execute it as
+ * a single indirect multi draw.
+ */
+#define SI_MULTI_DRAW_INDIRECT_THRESHOLD 16
+
 ALWAYS_INLINE
 static unsigned si_conv_pipe_prim(unsigned mode)
 {
@@ -1182,11 +1187,32 @@ static void si_emit_draw_packets(struct si_context *sctx, const struct pipe_draw
             radeon_end();
 
             for (unsigned i = 0; i < num_draws; i++) {
-               uint64_t va = index_va + draws[0].start * original_index_size;
+               uint64_t va = index_va + draws[i].start * original_index_size;
+               int draw_base_vertex = original_index_size ? base_vertex : draws[i].start;
+               unsigned draw_id = info->drawid + (info->increment_draw_id ? i : 0);
+
+               /* The culled draw is executed by the gfx IB with the same VS user SGPRs. */
+               if (i > 0 && (!original_index_size || set_draw_id)) {
+                  radeon_begin_again(cs);
+                  if (set_draw_id) {
+                     radeon_set_sh_reg_seq(cs, sh_base_reg + SI_SGPR_BASE_VERTEX * 4, 2);
+                     radeon_emit(cs, draw_base_vertex);
+                     radeon_emit(cs, draw_id);
+
+                     sctx->last_drawid = draw_id;
+                  } else {
+                     radeon_set_sh_reg(cs, sh_base_reg + SI_SGPR_BASE_VERTEX * 4,
+                                       draw_base_vertex);
+                  }
+                  radeon_end();
+
+                  sctx->last_base_vertex = draw_base_vertex;
+               }
 
                si_dispatch_prim_discard_cs_and_draw(sctx, info, draws[i].count,
-                                                    original_index_size, base_vertex,
-                                                    va, MIN2(index_max_size, draws[i].count));
+                                                    original_index_size, draw_base_vertex,
+                                                    va, MIN2(index_max_size, draws[i].count),
+                                                    draw_id);
             }
             EMIT_SQTT_END_DRAW;
             return;
@@ -1679,6 +1705,41 @@ static void si_draw_vbo(struct pipe_context *ctx,
     */
    struct si_context *sctx = (struct si_context *)ctx;
 
+   /* Direct multi draws that use DrawID need a user SGPR write before
+    * every draw. For large ones, write the draw parameters to memory
+    * instead and let the CP execute the whole batch with one
+    * DRAW_(INDEX_)INDIRECT_MULTI packet, which also sets DrawID.
+    */
+   if (GFX_VERSION >= GFX9 && !indirect && num_draws >= SI_MULTI_DRAW_INDIRECT_THRESHOLD &&
+       info->increment_draw_id && info->drawid == 0 && !info->has_user_indices &&
+       !sctx->num_vs_blit_sgprs && sctx->screen->has_draw_indirect_multi &&
+       sctx->shader.vs.cso && sctx->shader.vs.cso->info.uses_drawid) {
+      struct pipe_draw_indirect_info multi = {};
+      struct pipe_draw_start_count draw = {};
+      unsigned stride = info->index_size ? 20 : 16;
+      uint32_t *params;
+
+      u_upload_alloc(ctx->stream_uploader, 0, num_draws * stride, 16, &multi.offset,
+                     &multi.buffer, (void **)&params);
+      if (likely(multi.buffer)) {
+         for (unsigned i = 0; i < num_draws; i++) {
+            *params++ = draws[i].count;
+            *params++ = info->instance_count;
+            *params++ = draws[i].start;
+            if (info->index_size)
+               *params++ = info->index_bias;
+            *params++ = info->start_instance;
+         }
+
+         multi.draw_count = num_draws;
+         multi.stride = stride;
+         si_draw_vbo<GFX_VERSION, HAS_TESS, HAS_GS, NGG, ALLOW_PRIM_DISCARD_CS>
+               (ctx, info, &multi, &draw, 1);
+         pipe_resource_reference(&multi.buffer, NULL);
+         return;
+      }
+   }
+
    /* Recompute and re-emit the texture resource states if needed. */
    unsigned dirty_tex_counter = p_atomic_read(&sctx->screen->dirty_tex_counter);
    if (unlikely(dirty_tex_counter != sctx->last_dirty_tex_counter)) {
@@ -1884,8 +1945,6 @@ static void si_draw_vbo(struct pipe_context *ctx,
               (instance_count == 1 ||
                (instance_count <= USHRT_MAX && index_size && index_size <= 2) ||
                pd_msg("instance_count too large or index_size == 4 or DrawArraysInstanced"))) &&
-       ((info->drawid == 0 && (num_draws == 1 || !info->increment_draw_id)) ||
-        !sctx->shader.vs.cso->info.uses_drawid || pd_msg("draw_id > 0")) &&
        (!sctx->render_cond || pd_msg("render condition")) &&
        /* Forced enablement ignores pipeline statistics queries. */
        (sctx->screen->debug_flags & (DBG(PD) | DBG(ALWAYS_PD)) ||
@@ -2197,6 +2256,10 @@ static void si_draw_vbo(struct pipe_context *ctx,
       sctx->num_draw_calls++;
       if (primitive_restart)
          sctx->num_prim_restart_calls++;
+      if (NGG && sctx->ngg_culling) {
+         sctx->num_ngg_culling_draw_calls++;
+         sctx->num_ngg_culling_vertices += (uint64_t)total_direct_count * instance_count;
+      }
    }
 
    DRAW_CLEANUP;
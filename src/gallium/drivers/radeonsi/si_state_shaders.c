@@ -41,15 +41,23 @@
 
 /**
  * Return the IR key for the shader cache.
+ *
+ * If the frontend identified the shader by its source, that is used instead
+ * of the IR, which saves hashing the whole IR on every shader creation.
  */
 void si_get_ir_cache_key(struct si_shader_selector *sel, bool ngg, bool es,
                          unsigned char ir_sha1_cache_key[20])
 {
+   static const uint8_t zero_sha1[20];
+   bool use_source_sha1 = memcmp(sel->info.base.source_sha1, zero_sha1, 20) != 0;
    struct blob blob = {};
    unsigned ir_size;
    void *ir_binary;
 
-   if (sel->nir_binary) {
+   if (use_source_sha1) {
+      ir_binary = sel->info.base.source_sha1;
+      ir_size = 20;
+   } else if (sel->nir_binary) {
       ir_binary = sel->nir_binary;
       ir_size = sel->nir_size;
    } else {
@@ -97,6 +105,8 @@ void si_get_ir_cache_key(struct si_shader_selector *sel, bool ngg, bool es,
       shader_variant_flags |= 1 << 10;
    if (sel->screen->options.inline_uniforms)
       shader_variant_flags |= 1 << 11;
+   if (use_source_sha1)
+      shader_variant_flags |= 1 << 12;
 
    struct mesa_sha1 ctx;
    _mesa_sha1_init(&ctx);
@@ -2351,8 +2361,17 @@ current_not_ready:
    shader->is_monolithic =
       is_pure_monolithic || memcmp(&key->opt, &zeroed.opt, sizeof(key->opt)) != 0;
 
-   /* The prim discard CS is always optimized. */
-   shader->is_optimized = (!is_pure_monolithic || key->opt.vs_as_prim_discard_cs) &&
+   /* The prim discard CS is always optimized.
+    *
+    * Shaders that can only be monolithic have no separate parts to fall
+    * back to, so their optimized variants are normally compiled right away.
+    * With async_mono_variants, they are compiled asynchronously too, and
+    * the monolithic variant without the "opt" flags is used meanwhile.
+    * That one only depends on the "mono" flags, so it's compiled once and
+    * shared by all "opt" combinations, e.g. all inlined uniform values.
+    */
+   shader->is_optimized = (!is_pure_monolithic || key->opt.vs_as_prim_discard_cs ||
+                           sscreen->options.async_mono_variants) &&
                           memcmp(&key->opt, &zeroed.opt, sizeof(key->opt)) != 0;
 
    /* If it's an optimized shader, compile it asynchronously. */
@@ -2845,6 +2864,8 @@ static void *si_create_shader_selector(struct pipe_context *ctx,
       if (sel->info.stage == MESA_SHADER_VERTEX) {
          if (sscreen->debug_flags & DBG(ALWAYS_NGG_CULLING_ALL))
             sel->ngg_cull_vert_threshold = 0; /* always enabled */
+         else if (sscreen->ngg_cull_vert_threshold >= 0)
+            sel->ngg_cull_vert_threshold = sscreen->ngg_cull_vert_threshold;
          else if (sscreen->options.shader_culling ||
                   sscreen->info.chip_class == GFX10_3 ||
                   (sscreen->info.chip_class == GFX10 &&
@@ -2870,6 +2891,7 @@ static void *si_create_shader_selector(struct pipe_context *ctx,
          if (sel->rast_prim == PIPE_PRIM_TRIANGLES &&
              (sscreen->debug_flags & DBG(ALWAYS_NGG_CULLING_ALL) ||
               sscreen->debug_flags & DBG(ALWAYS_NGG_CULLING_TESS) ||
+              sscreen->ngg_cull_tess ||
               sscreen->info.chip_class == GFX10_3))
             sel->ngg_cull_vert_threshold = 0; /* always enabled */
       }
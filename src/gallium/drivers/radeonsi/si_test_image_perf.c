@@ -0,0 +1,260 @@
+/*
+ * Copyright 2021 Advanced Micro Devices, Inc.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+/* This file implements performance tests of image clears, copies, blits,
+ * resolves and decompression passes. The output is CSV.
+ */
+
+#include "si_pipe.h"
+#include "si_query.h"
+#include "util/format/u_format.h"
+
+#define MIN_SIZE 256
+#define MAX_SIZE 4096
+#define NUM_RUNS 32
+
+enum
+{
+   TEST_FAST_CLEAR,
+   TEST_CLEAR,
+   TEST_COMPUTE_CLEAR,
+   TEST_COPY,
+   TEST_COMPUTE_COPY,
+   TEST_SCALED_BLIT,
+   TEST_RESOLVE,
+   TEST_DCC_DECOMPRESS,
+   TEST_FMASK_EXPAND,
+   NUM_TESTS,
+};
+
+static const struct {
+   const char *name;
+   unsigned sample_mask; /* bit i = 2^i samples */
+   bool gfx;             /* requires the graphics queue */
+   bool no_dcc;          /* the destination must not have DCC */
+   bool has_src;
+} tests[NUM_TESTS] = {
+   [TEST_FAST_CLEAR] = {"fast_clear", 0xf, true, false, false},
+   [TEST_CLEAR] = {"clear_render_target", 0xf, true, false, false},
+   [TEST_COMPUTE_CLEAR] = {"compute_clear", 0x1, false, true, false},
+   [TEST_COPY] = {"resource_copy_region", 0x1, true, false, true},
+   [TEST_COMPUTE_COPY] = {"compute_copy", 0x1, false, true, true},
+   [TEST_SCALED_BLIT] = {"scaled_blit", 0x1, true, false, true},
+   [TEST_RESOLVE] = {"resolve", 0xe, true, false, true},
+   [TEST_DCC_DECOMPRESS] = {"dcc_decompress", 0x1, true, false, false},
+   [TEST_FMASK_EXPAND] = {"fmask_expand", 0xe, false, false, false},
+};
+
+static const enum pipe_format formats[] = {
+   PIPE_FORMAT_R8G8B8A8_UNORM,
+   PIPE_FORMAT_R10G10B10A2_UNORM,
+   PIPE_FORMAT_R16G16B16A16_FLOAT,
+   PIPE_FORMAT_R32G32B32A32_FLOAT,
+};
+
+static struct pipe_resource *create_texture(struct pipe_screen *screen, enum pipe_format format,
+                                            unsigned size, unsigned samples, bool no_dcc)
+{
+   struct pipe_resource templ = {};
+
+   templ.target = PIPE_TEXTURE_2D;
+   templ.format = format;
+   templ.width0 = size;
+   templ.height0 = size;
+   templ.depth0 = 1;
+   templ.array_size = 1;
+   templ.nr_samples = samples;
+   templ.nr_storage_samples = samples;
+   templ.usage = PIPE_USAGE_DEFAULT;
+   templ.bind = PIPE_BIND_RENDER_TARGET | PIPE_BIND_SAMPLER_VIEW;
+   templ.flags = no_dcc ? SI_RESOURCE_FLAG_DISABLE_DCC : 0;
+
+   return screen->resource_create(screen, &templ);
+}
+
+static void run_test(struct si_context *sctx, unsigned test, struct pipe_resource *dst,
+                     struct pipe_surface *surf, struct pipe_resource *src)
+{
+   struct pipe_context *ctx = &sctx->b;
+   union pipe_color_union color = {.f = {0.25, 0.5, 0.75, 1}};
+   struct pipe_box box;
+   struct pipe_blit_info blit = {};
+
+   u_box_origin_2d(dst->width0, dst->height0, &box);
+
+   switch (test) {
+   case TEST_FAST_CLEAR:
+      ctx->clear(ctx, PIPE_CLEAR_COLOR0, NULL, &color, 0, 0);
+      break;
+   case TEST_CLEAR:
+      ctx->clear_render_target(ctx, surf, &color, 0, 0, dst->width0, dst->height0, false);
+      break;
+   case TEST_COMPUTE_CLEAR:
+      si_compute_clear_render_target(ctx, surf, &color, 0, 0, dst->width0, dst->height0, false);
+      break;
+   case TEST_COPY:
+      ctx->resource_copy_region(ctx, dst, 0, 0, 0, 0, src, 0, &box);
+      break;
+   case TEST_COMPUTE_COPY:
+      si_compute_copy_image(sctx, dst, 0, src, 0, 0, 0, 0, &box, false);
+      break;
+   case TEST_SCALED_BLIT:
+   case TEST_RESOLVE:
+      blit.src.resource = src;
+      blit.src.format = src->format;
+      u_box_origin_2d(src->width0, src->height0, &blit.src.box);
+      blit.dst.resource = dst;
+      blit.dst.format = dst->format;
+      /* Minify 2x, which can't be turned into a copy. */
+      if (test == TEST_SCALED_BLIT)
+         u_box_origin_2d(dst->width0 / 2, dst->height0 / 2, &blit.dst.box);
+      else
+         blit.dst.box = box;
+      blit.mask = PIPE_MASK_RGBA;
+      blit.filter = test == TEST_SCALED_BLIT ? PIPE_TEX_FILTER_LINEAR : PIPE_TEX_FILTER_NEAREST;
+      ctx->blit(ctx, &blit);
+      break;
+   case TEST_DCC_DECOMPRESS:
+      si_decompress_dcc(sctx, (struct si_texture *)dst);
+      break;
+   case TEST_FMASK_EXPAND:
+      si_compute_expand_fmask(ctx, dst);
+      break;
+   }
+}
+
+void si_test_image_perf(struct si_screen *sscreen)
+{
+   struct pipe_screen *screen = &sscreen->b;
+   struct pipe_context *ctx = screen->context_create(screen, NULL, 0);
+   struct si_context *sctx = (struct si_context *)ctx;
+
+   printf("Rates are in Mpix/s of the destination. Unsupported cases are skipped.\n");
+   printf("test,format,samples,width,height,us,Mpix/s,GB/s\n");
+
+   for (unsigned test = 0; test < NUM_TESTS; test++) {
+      if (tests[test].gfx && !sctx->has_graphics)
+         continue;
+
+      for (unsigned f = 0; f < ARRAY_SIZE(formats); f++) {
+         enum pipe_format format = formats[f];
+
+         u_foreach_bit(log_samples, tests[test].sample_mask) {
+            unsigned samples = 1 << log_samples;
+
+            if (!screen->is_format_supported(screen, format, PIPE_TEXTURE_2D, samples, samples,
+                                             PIPE_BIND_RENDER_TARGET))
+               continue;
+
+            for (unsigned size = MIN_SIZE; size <= MAX_SIZE; size *= 2) {
+               /* The source is the MSAA image when resolving. */
+               unsigned dst_samples = test == TEST_RESOLVE ? 1 : samples;
+               struct pipe_resource *dst =
+                  create_texture(screen, format, size, dst_samples, tests[test].no_dcc);
+               struct pipe_resource *src =
+                  tests[test].has_src ? create_texture(screen, format, size, samples,
+                                                       tests[test].no_dcc) : NULL;
+               struct si_texture *tex = (struct si_texture *)dst;
+
+               if (!dst || (tests[test].has_src && !src) ||
+                   (test == TEST_DCC_DECOMPRESS && !tex->surface.dcc_offset) ||
+                   (test == TEST_FMASK_EXPAND && !tex->surface.fmask_offset)) {
+                  pipe_resource_reference(&dst, NULL);
+                  pipe_resource_reference(&src, NULL);
+                  continue;
+               }
+
+               struct pipe_surface surf_templ = {}, *surf;
+               surf_templ.format = format;
+               surf = ctx->create_surface(ctx, dst, &surf_templ);
+
+               struct pipe_framebuffer_state fb = {};
+               if (test == TEST_FAST_CLEAR) {
+                  fb.width = size;
+                  fb.height = size;
+                  fb.samples = samples;
+                  fb.layers = 1;
+                  fb.nr_cbufs = 1;
+                  fb.cbufs[0] = surf;
+                  ctx->set_framebuffer_state(ctx, &fb);
+               }
+
+               /* Compile the shaders and initialize metadata before measuring. */
+               run_test(sctx, test, dst, surf, src);
+
+               /* Wait for idle before testing, so that other processes don't mess up the
+                * results.
+                */
+               sctx->flags |= SI_CONTEXT_CS_PARTIAL_FLUSH | SI_CONTEXT_PS_PARTIAL_FLUSH |
+                              SI_CONTEXT_FLUSH_AND_INV_CB | SI_CONTEXT_FLUSH_AND_INV_DB;
+               sctx->emit_cache_flush(sctx, &sctx->gfx_cs);
+
+               struct pipe_query *q = ctx->create_query(ctx, PIPE_QUERY_TIME_ELAPSED, 0);
+               ctx->begin_query(ctx, q);
+
+               for (unsigned iter = 0; iter < NUM_RUNS; iter++) {
+                  run_test(sctx, test, dst, surf, src);
+
+                  /* Flush CB and L2, so that we don't just test cache performance. */
+                  sctx->flags |= SI_CONTEXT_FLUSH_AND_INV_CB | SI_CONTEXT_INV_VCACHE |
+                                 SI_CONTEXT_INV_L2 | SI_CONTEXT_CS_PARTIAL_FLUSH |
+                                 SI_CONTEXT_PS_PARTIAL_FLUSH;
+                  sctx->emit_cache_flush(sctx, &sctx->gfx_cs);
+               }
+
+               ctx->end_query(ctx, q);
+               ctx->flush(ctx, NULL, PIPE_FLUSH_ASYNC);
+
+               if (test == TEST_FAST_CLEAR) {
+                  memset(&fb, 0, sizeof(fb));
+                  ctx->set_framebuffer_state(ctx, &fb);
+               }
+               pipe_surface_reference(&surf, NULL);
+               pipe_resource_reference(&dst, NULL);
+               pipe_resource_reference(&src, NULL);
+
+               /* Get results. */
+               union pipe_query_result result;
+
+               ctx->get_query_result(ctx, q, true, &result);
+               ctx->destroy_query(ctx, q);
+
+               double ns = result.u64 / (double)NUM_RUNS;
+               double num_pixels = test == TEST_SCALED_BLIT ? (size / 2) * (size / 2) :
+                                                              size * size;
+               double num_bytes = num_pixels * dst_samples * util_format_get_blocksize(format);
+
+               printf("%s,%s,%u,%u,%u,%.1f,%.1f,%.2f\n", tests[test].name,
+                      util_format_short_name(format), samples, size, size, ns / 1000.0,
+                      num_pixels / (ns / 1000.0), num_bytes / ns);
+               fflush(stdout);
+            }
+         }
+      }
+   }
+
+   ctx->destroy(ctx);
+   exit(0);
+}
@@ -89,5 +89,7 @@ softpipe_clear(struct pipe_context *pipe, unsigned buffers,
       sp_tile_cache_clear(softpipe->zsbuf_cache, &zero, cv);
    }
 
+   /* the pending clears cover the tiles of all rasterizer threads */
+   softpipe->rast_shared_tiles = TRUE;
    softpipe->dirty_render_cache = TRUE;
 }
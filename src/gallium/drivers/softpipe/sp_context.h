@@ -36,6 +36,7 @@
 
 #include "draw/draw_vertex.h"
 
+#include "sp_limits.h"
 #include "sp_quad_pipe.h"
 #include "sp_setup.h"
 
@@ -51,6 +52,7 @@ struct softpipe_vbuf_render;
 struct draw_context;
 struct draw_stage;
 struct softpipe_tile_cache;
+struct sp_rast_thread;
 struct softpipe_tex_tile_cache;
 struct sp_fragment_shader;
 struct sp_vertex_shader;
@@ -161,13 +163,7 @@ struct softpipe_context {
    } pstipple;
 
    /** Software quad rendering pipeline */
-   struct {
-      struct quad_stage *shade;
-      struct quad_stage *depth_test;
-      struct quad_stage *blend;
-      struct quad_stage *pstipple;
-      struct quad_stage *first; /**< points to one of the above stages */
-   } quad;
+   struct sp_quad_pipeline quad;
 
    /** TGSI exec things */
    struct {
@@ -194,6 +190,15 @@ struct softpipe_context {
    struct softpipe_tile_cache *cbuf_cache[PIPE_MAX_COLOR_BUFS];
    struct softpipe_tile_cache *zsbuf_cache;
 
+   /**
+    * Rasterizer threads.  rast[0] is the application thread, which uses the
+    * caches and pipeline of the context, see sp_rast_thread.c.
+    */
+   struct sp_rast_thread *rast[SP_MAX_THREADS];
+   unsigned num_rast_threads;
+   /** may the caches of rast[0] hold tiles owned by the other threads? */
+   boolean rast_shared_tiles;
+
    unsigned tex_timestamp;
 
    /*
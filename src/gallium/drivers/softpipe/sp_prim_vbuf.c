@@ -40,6 +40,7 @@
 #include "sp_setup.h"
 #include "sp_state.h"
 #include "sp_prim_vbuf.h"
+#include "sp_rast_thread.h"
 #include "draw/draw_context.h"
 #include "draw/draw_vbuf.h"
 #include "util/u_memory.h"
@@ -153,17 +154,31 @@ static inline cptrf4 get_vert( const void *vertex_buffer,
 }
 
 
+/**
+ * The primitives of a draw_elements/draw_arrays call, which every
+ * rasterizer thread runs through its own setup context.
+ */
+struct sp_vbuf_job {
+   struct softpipe_vbuf_render *cvbr;
+   const ushort *indices;
+   uint start;
+   uint nr;
+};
+
+
 /**
  * draw elements / indexed primitives
  */
 static void
-sp_vbuf_draw_elements(struct vbuf_render *vbr, const ushort *indices, uint nr)
+sp_vbuf_setup_elements(struct setup_context *setup, const void *data)
 {
-   struct softpipe_vbuf_render *cvbr = softpipe_vbuf_render(vbr);
+   const struct sp_vbuf_job *job = (const struct sp_vbuf_job *) data;
+   struct softpipe_vbuf_render *cvbr = job->cvbr;
    struct softpipe_context *softpipe = cvbr->softpipe;
    const unsigned stride = softpipe->vertex_info.size * sizeof(float);
    const void *vertex_buffer = cvbr->vertex_buffer;
-   struct setup_context *setup = cvbr->setup;
+   const ushort *indices = job->indices;
+   const uint nr = job->nr;
    const boolean flatshade_first = softpipe->rasterizer->flatshade_first;
    unsigned i;
 
@@ -353,14 +368,15 @@ sp_vbuf_draw_elements(struct vbuf_render *vbr, const ushort *indices, uint nr)
  * It's up to us to convert the vertex array into point/line/tri prims.
  */
 static void
-sp_vbuf_draw_arrays(struct vbuf_render *vbr, uint start, uint nr)
+sp_vbuf_setup_arrays(struct setup_context *setup, const void *data)
 {
-   struct softpipe_vbuf_render *cvbr = softpipe_vbuf_render(vbr);
+   const struct sp_vbuf_job *job = (const struct sp_vbuf_job *) data;
+   struct softpipe_vbuf_render *cvbr = job->cvbr;
    struct softpipe_context *softpipe = cvbr->softpipe;
-   struct setup_context *setup = cvbr->setup;
    const unsigned stride = softpipe->vertex_info.size * sizeof(float);
    const void *vertex_buffer =
-      (void *) get_vert(cvbr->vertex_buffer, start, stride);
+      (void *) get_vert(cvbr->vertex_buffer, job->start, stride);
+   const uint nr = job->nr;
    const boolean flatshade_first = softpipe->rasterizer->flatshade_first;
    unsigned i;
 
@@ -587,6 +603,38 @@ sp_vbuf_draw_arrays(struct vbuf_render *vbr, uint start, uint nr)
    }
 }
 
+static void
+sp_vbuf_draw_elements(struct vbuf_render *vbr, const ushort *indices, uint nr)
+{
+   struct softpipe_vbuf_render *cvbr = softpipe_vbuf_render(vbr);
+   struct sp_vbuf_job job;
+
+   job.cvbr = cvbr;
+   job.indices = indices;
+   job.start = 0;
+   job.nr = nr;
+
+   sp_rast_threads_run(cvbr->softpipe, cvbr->setup,
+                       sp_vbuf_setup_elements, &job);
+}
+
+
+static void
+sp_vbuf_draw_arrays(struct vbuf_render *vbr, uint start, uint nr)
+{
+   struct softpipe_vbuf_render *cvbr = softpipe_vbuf_render(vbr);
+   struct sp_vbuf_job job;
+
+   job.cvbr = cvbr;
+   job.indices = NULL;
+   job.start = start;
+   job.nr = nr;
+
+   sp_rast_threads_run(cvbr->softpipe, cvbr->setup,
+                       sp_vbuf_setup_arrays, &job);
+}
+
+
 /*
  * FIXME: it is unclear if primitives_storage_needed (which is generally
  * the same as pipe query num_primitives_generated) should increase
@@ -667,7 +715,7 @@ sp_create_vbuf_backend(struct softpipe_context *sp)
 
    cvbr->softpipe = sp;
 
-   cvbr->setup = sp_setup_create_context(cvbr->softpipe);
+   cvbr->setup = sp_setup_create_context(cvbr->softpipe, &sp->quad);
 
    return &cvbr->base;
 }
@@ -28,14 +28,36 @@
 
 #include "sp_context.h"
 #include "sp_state.h"
+#include "sp_rast_thread.h"
 #include "pipe/p_shader_tokens.h"
 
 
 static void
-insert_stage_at_head(struct softpipe_context *sp, struct quad_stage *quad)
+insert_stage_at_head(struct sp_quad_pipeline *quad, struct quad_stage *stage)
 {
-   quad->next = sp->quad.first;
-   sp->quad.first = quad;
+   stage->next = quad->first;
+   quad->first = stage;
+}
+
+
+static void
+build_quad_pipeline(struct softpipe_context *sp, struct sp_quad_pipeline *quad)
+{
+   quad->first = quad->blend;
+
+   if (sp->early_depth) {
+      insert_stage_at_head( quad, quad->shade );
+      insert_stage_at_head( quad, quad->depth_test );
+   }
+   else {
+      insert_stage_at_head( quad, quad->depth_test );
+      insert_stage_at_head( quad, quad->shade );
+   }
+
+#if !DO_PSTIPPLE_IN_DRAW_MODULE && !DO_PSTIPPLE_IN_HELPER_MODULE
+   if (sp->rasterizer->poly_stipple_enable)
+      insert_stage_at_head( quad, quad->pstipple );
+#endif
 }
 
 
@@ -50,22 +72,13 @@ sp_build_quad_pipeline(struct softpipe_context *sp)
       !sp->fs_variant->info.writes_z &&
        !sp->fs_variant->info.writes_stencil) ||
       sp->fs_variant->info.properties[TGSI_PROPERTY_FS_EARLY_DEPTH_STENCIL];
-
-   sp->quad.first = sp->quad.blend;
+   unsigned i;
 
    sp->early_depth = early_depth_test;
-   if (early_depth_test) {
-      insert_stage_at_head( sp, sp->quad.shade );
-      insert_stage_at_head( sp, sp->quad.depth_test );
-   }
-   else {
-      insert_stage_at_head( sp, sp->quad.depth_test );
-      insert_stage_at_head( sp, sp->quad.shade );
-   }
 
-#if !DO_PSTIPPLE_IN_DRAW_MODULE && !DO_PSTIPPLE_IN_HELPER_MODULE
-   if (sp->rasterizer->poly_stipple_enable)
-      insert_stage_at_head( sp, sp->quad.pstipple );
-#endif
-}
+   build_quad_pipeline(sp, &sp->quad);
 
+   /* the other rasterizer threads have their own stages */
+   for (i = 1; i < sp->num_rast_threads; i++)
+      build_quad_pipeline(sp, &sp->rast[i]->quad);
+}
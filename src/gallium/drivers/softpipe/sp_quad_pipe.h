@@ -33,6 +33,7 @@
 
 
 struct softpipe_context;
+struct sp_rast_thread;
 struct quad_header;
 
 
@@ -44,6 +45,9 @@ struct quad_header;
 struct quad_stage {
    struct softpipe_context *softpipe;
 
+   /** The thread running the stage, owns the caches and shader machine */
+   struct sp_rast_thread *thread;
+
    struct quad_stage *next;
 
    void (*begin)(struct quad_stage *qs);
@@ -55,6 +59,18 @@ struct quad_stage {
 };
 
 
+/**
+ * The stages, and the order they currently run in.
+ */
+struct sp_quad_pipeline {
+   struct quad_stage *shade;
+   struct quad_stage *depth_test;
+   struct quad_stage *blend;
+   struct quad_stage *pstipple;
+   struct quad_stage *first; /**< points to one of the above stages */
+};
+
+
 struct quad_stage *sp_quad_polygon_stipple_stage( struct softpipe_context *softpipe );
 struct quad_stage *sp_quad_earlyz_stage( struct softpipe_context *softpipe );
 struct quad_stage *sp_quad_shade_stage( struct softpipe_context *softpipe );
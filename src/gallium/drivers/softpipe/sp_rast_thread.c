@@ -0,0 +1,432 @@
+/**************************************************************************
+ *
+ * Copyright 2021 VMware, Inc.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+
+/*
+ * Rasterizer worker threads.
+ *
+ * With SOFTPIPE_NUM_THREADS=n the screen space is split into the 64x64
+ * blocks of the tile caches, and block (x, y) belongs to thread
+ * (x + y) % n.  Every thread runs the setup of all the primitives of a
+ * draw, but only emits the quads falling into its own blocks, which it
+ * shades, depth tests and blends with its own shader machine and tile
+ * caches.  The application thread acts as thread 0 and uses the caches
+ * of the context; the workers flush their caches at the end of each
+ * draw, so the context caches never hold stale copies of their tiles.
+ */
+
+#include "util/u_debug.h"
+#include "util/u_memory.h"
+#include "tgsi/tgsi_exec.h"
+#include "sp_context.h"
+#include "sp_quad.h"
+#include "sp_rast_thread.h"
+#include "sp_setup.h"
+#include "sp_state.h"
+#include "sp_tex_sample.h"
+#include "sp_tex_tile_cache.h"
+#include "sp_tile_cache.h"
+
+
+DEBUG_GET_ONCE_NUM_OPTION(sp_num_threads, "SOFTPIPE_NUM_THREADS", 0)
+
+
+static void
+set_pipeline_thread(struct sp_quad_pipeline *quad,
+                    struct sp_rast_thread *thread)
+{
+   quad->shade->thread = thread;
+   quad->depth_test->thread = thread;
+   quad->blend->thread = thread;
+   quad->pstipple->thread = thread;
+}
+
+
+static int
+thread_function(void *init_data)
+{
+   struct sp_rast_thread *t = (struct sp_rast_thread *) init_data;
+   char thread_name[16];
+   unsigned i;
+
+   snprintf(thread_name, sizeof thread_name, "softpipe-%u", t->index);
+   u_thread_setname(thread_name);
+
+   while (1) {
+      pipe_semaphore_wait(&t->work_ready);
+
+      if (t->exit_flag)
+         break;
+
+      t->func(t->setup, t->data);
+
+      for (i = 0; i < PIPE_MAX_COLOR_BUFS; i++)
+         sp_flush_tile_cache(t->cbuf_cache[i]);
+      sp_flush_tile_cache(t->zsbuf_cache);
+
+      pipe_semaphore_signal(&t->work_done);
+   }
+
+#ifdef _WIN32
+   pipe_semaphore_signal(&t->work_done);
+#endif
+
+   return 0;
+}
+
+
+static void
+destroy_worker(struct sp_rast_thread *t)
+{
+   unsigned i;
+
+   if (t->setup)
+      sp_setup_destroy_context(t->setup);
+
+   if (t->quad.shade)
+      t->quad.shade->destroy(t->quad.shade);
+   if (t->quad.depth_test)
+      t->quad.depth_test->destroy(t->quad.depth_test);
+   if (t->quad.blend)
+      t->quad.blend->destroy(t->quad.blend);
+   if (t->quad.pstipple)
+      t->quad.pstipple->destroy(t->quad.pstipple);
+
+   for (i = 0; i < ARRAY_SIZE(t->tex_cache); i++) {
+      if (t->tex_cache[i]) {
+         sp_tex_tile_cache_set_sampler_view(t->tex_cache[i], NULL);
+         sp_destroy_tex_tile_cache(t->tex_cache[i]);
+      }
+   }
+
+   for (i = 0; i < PIPE_MAX_COLOR_BUFS; i++)
+      sp_destroy_tile_cache(t->cbuf_cache[i]);
+   sp_destroy_tile_cache(t->zsbuf_cache);
+
+   if (t->fs_machine)
+      tgsi_exec_machine_destroy(t->fs_machine);
+
+   FREE(t->sampler);
+   FREE(t);
+}
+
+
+static struct sp_rast_thread *
+create_worker(struct softpipe_context *softpipe, unsigned index)
+{
+   struct sp_rast_thread *t = CALLOC_STRUCT(sp_rast_thread);
+   unsigned i;
+
+   if (!t)
+      return NULL;
+
+   t->softpipe = softpipe;
+   t->index = index;
+
+   for (i = 0; i < PIPE_MAX_COLOR_BUFS; i++) {
+      t->cbuf_cache[i] = sp_create_tile_cache(&softpipe->pipe);
+      if (!t->cbuf_cache[i])
+         goto fail;
+   }
+   t->zsbuf_cache = sp_create_tile_cache(&softpipe->pipe);
+   t->fs_machine = tgsi_exec_machine_create(PIPE_SHADER_FRAGMENT);
+   t->sampler = sp_create_tgsi_sampler();
+   if (!t->zsbuf_cache || !t->fs_machine || !t->sampler)
+      goto fail;
+
+   t->quad.shade = sp_quad_shade_stage(softpipe);
+   t->quad.depth_test = sp_quad_depth_test_stage(softpipe);
+   t->quad.blend = sp_quad_blend_stage(softpipe);
+   t->quad.pstipple = sp_quad_polygon_stipple_stage(softpipe);
+   if (!t->quad.shade || !t->quad.depth_test ||
+       !t->quad.blend || !t->quad.pstipple)
+      goto fail;
+   set_pipeline_thread(&t->quad, t);
+
+   t->setup = sp_setup_create_context(softpipe, &t->quad);
+   if (!t->setup)
+      goto fail;
+
+   pipe_semaphore_init(&t->work_ready, 0);
+   pipe_semaphore_init(&t->work_done, 0);
+
+   t->thread = u_thread_create(thread_function, t);
+   if (!t->thread) {
+      pipe_semaphore_destroy(&t->work_ready);
+      pipe_semaphore_destroy(&t->work_done);
+      goto fail;
+   }
+
+   return t;
+
+fail:
+   destroy_worker(t);
+   return NULL;
+}
+
+
+/**
+ * Create the per-thread state of the application thread, and as many
+ * workers as SOFTPIPE_NUM_THREADS asks for.  Must be called after the
+ * context's tile caches, shader machine and quad stages were created.
+ * Running with fewer workers than requested isn't an error.
+ */
+boolean
+sp_rast_threads_create(struct softpipe_context *softpipe)
+{
+   const unsigned num_threads = MIN2(debug_get_option_sp_num_threads(),
+                                     SP_MAX_THREADS);
+   struct sp_rast_thread *t = CALLOC_STRUCT(sp_rast_thread);
+   unsigned i;
+
+   if (!t)
+      return FALSE;
+
+   t->softpipe = softpipe;
+   t->index = 0;
+   t->fs_machine = softpipe->fs_machine;
+   for (i = 0; i < PIPE_MAX_COLOR_BUFS; i++)
+      t->cbuf_cache[i] = softpipe->cbuf_cache[i];
+   t->zsbuf_cache = softpipe->zsbuf_cache;
+   set_pipeline_thread(&softpipe->quad, t);
+
+   softpipe->rast[0] = t;
+   softpipe->num_rast_threads = 1;
+   softpipe->rast_shared_tiles = TRUE;
+
+   for (i = 1; i < num_threads; i++) {
+      t = create_worker(softpipe, i);
+      if (!t) {
+         debug_printf("softpipe: only %u of %u rasterizer threads created\n",
+                      i, num_threads);
+         break;
+      }
+      softpipe->rast[i] = t;
+      softpipe->num_rast_threads = i + 1;
+   }
+
+   return TRUE;
+}
+
+
+void
+sp_rast_threads_destroy(struct softpipe_context *softpipe)
+{
+   unsigned i;
+
+   for (i = 1; i < softpipe->num_rast_threads; i++) {
+      struct sp_rast_thread *t = softpipe->rast[i];
+
+      t->exit_flag = TRUE;
+      pipe_semaphore_signal(&t->work_ready);
+#ifdef _WIN32
+      pipe_semaphore_wait(&t->work_done);
+#else
+      thrd_join(t->thread, NULL);
+#endif
+      pipe_semaphore_destroy(&t->work_ready);
+      pipe_semaphore_destroy(&t->work_done);
+
+      destroy_worker(t);
+      softpipe->rast[i] = NULL;
+   }
+
+   FREE(softpipe->rast[0]);
+   softpipe->rast[0] = NULL;
+   softpipe->num_rast_threads = 0;
+}
+
+
+/**
+ * Make sure no worker machine still refers to the tokens of a variant
+ * which is about to be deleted.
+ */
+void
+sp_rast_threads_unbind_fs_variant(struct softpipe_context *softpipe,
+                                  const struct sp_fragment_shader_variant *var)
+{
+   unsigned i;
+
+   for (i = 1; i < softpipe->num_rast_threads; i++) {
+      struct tgsi_exec_machine *machine = softpipe->rast[i]->fs_machine;
+
+      if (machine->Tokens == var->tokens)
+         tgsi_exec_machine_bind_shader(machine, NULL, NULL, NULL, NULL);
+   }
+}
+
+
+/**
+ * Return TRUE if the current draw can be split among the threads.
+ * Also allocates the texture caches the workers will need.
+ */
+static boolean
+threads_can_run(struct softpipe_context *softpipe)
+{
+   const struct sp_fragment_shader_variant *var = softpipe->fs_variant;
+   unsigned i, j;
+
+   if (softpipe->num_rast_threads < 2 || !var)
+      return FALSE;
+
+   /* Stores to images and buffers, and atomics on them, would happen in
+    * an order depending on the thread timings.
+    */
+   if (var->info.file_count[TGSI_FILE_IMAGE] ||
+       var->info.file_count[TGSI_FILE_BUFFER] ||
+       var->info.file_count[TGSI_FILE_MEMORY])
+      return FALSE;
+
+   for (i = 1; i < softpipe->num_rast_threads; i++) {
+      struct sp_rast_thread *t = softpipe->rast[i];
+
+      for (j = 0; j < softpipe->num_sampler_views[PIPE_SHADER_FRAGMENT]; j++) {
+         if (!softpipe->sampler_views[PIPE_SHADER_FRAGMENT][j] ||
+             t->tex_cache[j])
+            continue;
+
+         t->tex_cache[j] = sp_create_tex_tile_cache(&softpipe->pipe);
+         if (!t->tex_cache[j])
+            return FALSE;
+      }
+   }
+
+   return TRUE;
+}
+
+
+/**
+ * Point a worker at the current framebuffer, textures and fragment shader.
+ */
+static void
+begin_job(struct sp_rast_thread *t, unsigned num_threads,
+          sp_rast_func func, const void *data)
+{
+   struct softpipe_context *softpipe = t->softpipe;
+   const struct sp_fragment_shader_variant *var = softpipe->fs_variant;
+   unsigned i;
+
+   for (i = 0; i < softpipe->framebuffer.nr_cbufs; i++)
+      sp_tile_cache_set_surface(t->cbuf_cache[i],
+                                softpipe->framebuffer.cbufs[i]);
+   sp_tile_cache_set_surface(t->zsbuf_cache, softpipe->framebuffer.zsbuf);
+
+   memcpy(t->sampler, softpipe->tgsi.sampler[PIPE_SHADER_FRAGMENT],
+          sizeof(*t->sampler));
+   for (i = 0; i < softpipe->num_sampler_views[PIPE_SHADER_FRAGMENT]; i++) {
+      struct pipe_sampler_view *view =
+         softpipe->sampler_views[PIPE_SHADER_FRAGMENT][i];
+
+      if (!view)
+         continue;
+
+      /* The texture may have changed since the last draw */
+      sp_tex_tile_cache_set_sampler_view(t->tex_cache[i], view);
+      sp_flush_tex_tile_cache(t->tex_cache[i]);
+      t->sampler->sp_sview[i].cache = t->tex_cache[i];
+   }
+
+   if (t->fs_machine->Tokens != var->tokens) {
+      var->prepare(var, t->fs_machine,
+                   (struct tgsi_sampler *) t->sampler,
+                   (struct tgsi_image *)
+                      softpipe->tgsi.image[PIPE_SHADER_FRAGMENT],
+                   (struct tgsi_buffer *)
+                      softpipe->tgsi.buffer[PIPE_SHADER_FRAGMENT]);
+   }
+
+   sp_setup_prepare(t->setup);
+   sp_setup_set_thread(t->setup, t->index, num_threads);
+
+   t->func = func;
+   t->data = data;
+}
+
+
+static void
+end_job(struct sp_rast_thread *t)
+{
+   struct softpipe_context *softpipe = t->softpipe;
+   unsigned i;
+
+   for (i = 0; i < softpipe->framebuffer.nr_cbufs; i++)
+      sp_tile_cache_set_surface(t->cbuf_cache[i], NULL);
+   sp_tile_cache_set_surface(t->zsbuf_cache, NULL);
+}
+
+
+/**
+ * Run func on the setup context of every thread, and wait for all of
+ * them to finish.  setup is the context's setup, used by thread 0.
+ */
+void
+sp_rast_threads_run(struct softpipe_context *softpipe,
+                    struct setup_context *setup,
+                    sp_rast_func func, const void *data)
+{
+   unsigned num_threads = 1;
+   unsigned i;
+
+   if (threads_can_run(softpipe)) {
+      num_threads = softpipe->num_rast_threads;
+
+      /* Clears and earlier single-threaded draws may have left tiles of
+       * other threads in the context caches.
+       */
+      if (softpipe->rast_shared_tiles) {
+         for (i = 0; i < softpipe->framebuffer.nr_cbufs; i++)
+            sp_flush_tile_cache(softpipe->cbuf_cache[i]);
+         sp_flush_tile_cache(softpipe->zsbuf_cache);
+         softpipe->rast_shared_tiles = FALSE;
+      }
+
+      for (i = 1; i < num_threads; i++) {
+         begin_job(softpipe->rast[i], num_threads, func, data);
+         pipe_semaphore_signal(&softpipe->rast[i]->work_ready);
+      }
+   }
+   else {
+      softpipe->rast_shared_tiles = TRUE;
+   }
+
+   sp_setup_set_thread(setup, 0, num_threads);
+   func(setup, data);
+
+   for (i = 1; i < num_threads; i++) {
+      pipe_semaphore_wait(&softpipe->rast[i]->work_done);
+      end_job(softpipe->rast[i]);
+   }
+
+   for (i = 0; i < num_threads; i++) {
+      struct sp_rast_thread *t = softpipe->rast[i];
+
+      softpipe->occlusion_count += t->occlusion_count;
+      softpipe->pipeline_statistics.ps_invocations += t->ps_invocations;
+      t->occlusion_count = 0;
+      t->ps_invocations = 0;
+   }
+}
@@ -0,0 +1,105 @@
+/**************************************************************************
+ *
+ * Copyright 2021 VMware, Inc.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+#ifndef SP_RAST_THREAD_H
+#define SP_RAST_THREAD_H
+
+#include "os/os_thread.h"
+#include "pipe/p_state.h"
+#include "sp_quad_pipe.h"
+
+
+struct softpipe_context;
+struct setup_context;
+struct sp_tgsi_sampler;
+struct softpipe_tile_cache;
+struct softpipe_tex_tile_cache;
+struct tgsi_exec_machine;
+struct sp_fragment_shader_variant;
+
+
+/**
+ * Feeds the primitives of a draw to the setup context of a thread.
+ */
+typedef void (*sp_rast_func)(struct setup_context *setup, const void *data);
+
+
+/**
+ * Per-thread rasterization state.  Everything the quad stages write while
+ * processing quads lives here, so the threads can run them concurrently.
+ */
+struct sp_rast_thread
+{
+   struct softpipe_context *softpipe;
+   unsigned index;
+
+   struct tgsi_exec_machine *fs_machine;
+   struct softpipe_tile_cache *cbuf_cache[PIPE_MAX_COLOR_BUFS];
+   struct softpipe_tile_cache *zsbuf_cache;
+
+   /** Counters, added to the context's after each draw */
+   uint64_t occlusion_count;
+   uint64_t ps_invocations;
+
+   /*
+    * The rest is only used by the worker threads, rast[0] uses the setup
+    * context, pipeline and samplers of the context.
+    */
+   struct setup_context *setup;
+   struct sp_quad_pipeline quad;
+
+   /** copy of the context's fragment sampler using our own texture caches */
+   struct sp_tgsi_sampler *sampler;
+   struct softpipe_tex_tile_cache *tex_cache[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+
+   sp_rast_func func;
+   const void *data;
+   boolean exit_flag;
+
+   thrd_t thread;
+   pipe_semaphore work_ready;
+   pipe_semaphore work_done;
+};
+
+
+boolean
+sp_rast_threads_create(struct softpipe_context *softpipe);
+
+void
+sp_rast_threads_destroy(struct softpipe_context *softpipe);
+
+void
+sp_rast_threads_run(struct softpipe_context *softpipe,
+                    struct setup_context *setup,
+                    sp_rast_func func, const void *data);
+
+void
+sp_rast_threads_unbind_fs_variant(struct softpipe_context *softpipe,
+                                  const struct sp_fragment_shader_variant *var);
+
+
+#endif /* SP_RAST_THREAD_H */
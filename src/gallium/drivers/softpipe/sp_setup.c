@@ -38,6 +38,7 @@
 #include "sp_quad_pipe.h"
 #include "sp_setup.h"
 #include "sp_state.h"
+#include "sp_tile_cache.h"
 #include "draw/draw_context.h"
 #include "pipe/p_shader_tokens.h"
 #include "util/u_math.h"
@@ -75,6 +76,13 @@ struct edge {
 struct setup_context {
    struct softpipe_context *softpipe;
 
+   /** The quad pipeline quads get emitted to */
+   struct sp_quad_pipeline *pipeline;
+
+   /** Only the tiles with (x + y) % num_threads == thread_index are drawn */
+   unsigned thread_index;
+   unsigned num_threads;
+
    /* Vertices are just an array of floats making up each attribute in
     * turn.  Currently fixed at 4 floats, but should change in time.
     * Codegen will help cope with this.
@@ -122,6 +130,18 @@ struct setup_context {
 
 
 
+/**
+ * Is the tile containing (x, y) rasterized by this setup context?
+ */
+static inline boolean
+owns_tile(const struct setup_context *setup, int x, int y)
+{
+   return setup->num_threads == 1 ||
+          ((x >> TILE_SIZE_LOG2) + (y >> TILE_SIZE_LOG2)) %
+          setup->num_threads == setup->thread_index;
+}
+
+
 /**
  * Clip setup->quad against the scissor/surface bounds.
  */
@@ -162,14 +182,15 @@ clip_emit_quad(struct setup_context *setup, struct quad_header *quad)
 {
    quad_clip(setup, quad);
 
-   if (quad->inout.mask) {
-      struct softpipe_context *sp = setup->softpipe;
+   if (quad->inout.mask &&
+       owns_tile(setup, quad->input.x0, quad->input.y0)) {
+      struct quad_stage *pipe = setup->pipeline->first;
 
 #if DEBUG_FRAGS
       setup->numFragsEmitted += util_bitcount(quad->inout.mask);
 #endif
 
-      sp->quad.first->run( sp->quad.first, &quad, 1 );
+      pipe->run( pipe, &quad, 1 );
    }
 }
 
@@ -204,7 +225,7 @@ flush_spans(struct setup_context *setup)
    const int xleft1 = setup->span.left[1];
    const int xright0 = setup->span.right[0];
    const int xright1 = setup->span.right[1];
-   struct quad_stage *pipe = setup->softpipe->quad.first;
+   struct quad_stage *pipe = setup->pipeline->first;
 
    const int minleft = block_x(MIN2(xleft0, xleft1));
    const int maxright = MAX2(xright0, xright1);
@@ -233,7 +254,7 @@ flush_spans(struct setup_context *setup)
       if (mask0 | mask1) {
          do {
             unsigned quadmask = (mask0 & 3) | ((mask1 & 3) << 2);
-            if (quadmask) {
+            if (quadmask && owns_tile(setup, lx, setup->span.y)) {
                setup->quad[q].input.x0 = lx;
                setup->quad[q].input.y0 = setup->span.y;
                setup->quad[q].input.facing = setup->facing;
@@ -249,7 +270,9 @@ flush_spans(struct setup_context *setup)
             lx += 2;
          } while (mask0 | mask1);
 
-         pipe->run( pipe, setup->quad_ptrs, q );
+         /* chunks aren't tile aligned, other threads may own all of it */
+         if (q)
+            pipe->run( pipe, setup->quad_ptrs, q );
       }
    }
 
@@ -864,7 +887,8 @@ sp_setup_tri(struct setup_context *setup,
 
    flush_spans( setup );
 
-   if (setup->softpipe->active_statistics_queries) {
+   if (setup->softpipe->active_statistics_queries &&
+       setup->thread_index == 0) {
       setup->softpipe->pipeline_statistics.c_primitives++;
    }
 
@@ -1481,7 +1505,7 @@ sp_setup_prepare(struct setup_context *setup)
 
    setup->max_layer = max_layer;
 
-   sp->quad.first->begin( sp->quad.first );
+   setup->pipeline->first->begin( setup->pipeline->first );
 
    if (sp->reduced_api_prim == PIPE_PRIM_TRIANGLES &&
        sp->rasterizer->fill_front == PIPE_POLYGON_MODE_FILL &&
@@ -1496,6 +1520,19 @@ sp_setup_prepare(struct setup_context *setup)
 }
 
 
+/**
+ * Restrict rasterization to the tiles of a rasterizer thread.
+ */
+void
+sp_setup_set_thread(struct setup_context *setup,
+                    unsigned thread_index, unsigned num_threads)
+{
+   assert(thread_index < num_threads);
+   setup->thread_index = thread_index;
+   setup->num_threads = num_threads;
+}
+
+
 void
 sp_setup_destroy_context(struct setup_context *setup)
 {
@@ -1507,12 +1544,18 @@ sp_setup_destroy_context(struct setup_context *setup)
  * Create a new primitive setup/render stage.
  */
 struct setup_context *
-sp_setup_create_context(struct softpipe_context *softpipe)
+sp_setup_create_context(struct softpipe_context *softpipe,
+                        struct sp_quad_pipeline *pipeline)
 {
    struct setup_context *setup = CALLOC_STRUCT(setup_context);
    unsigned i;
 
+   if (!setup)
+      return NULL;
+
    setup->softpipe = softpipe;
+   setup->pipeline = pipeline;
+   setup->num_threads = 1;
 
    for (i = 0; i < MAX_QUADS; i++) {
       setup->quad[i].coef = setup->coef;
@@ -29,6 +29,7 @@
 
 struct setup_context;
 struct softpipe_context;
+struct sp_quad_pipeline;
 
 /**
  * Attribute interpolation mode
@@ -70,8 +71,11 @@ sp_clamp_viewport_idx(int idx)
    return (PIPE_MAX_VIEWPORTS > idx && idx >= 0) ? idx : 0;
 }
 
-struct setup_context *sp_setup_create_context( struct softpipe_context *softpipe );
+struct setup_context *sp_setup_create_context( struct softpipe_context *softpipe,
+                                               struct sp_quad_pipeline *pipeline );
 void sp_setup_prepare( struct setup_context *setup );
+void sp_setup_set_thread( struct setup_context *setup,
+                          unsigned thread_index, unsigned num_threads );
 void sp_setup_destroy_context( struct setup_context *setup );
 
 #endif
@@ -29,6 +29,7 @@
 #include "sp_screen.h"
 #include "sp_state.h"
 #include "sp_fs.h"
+#include "sp_rast_thread.h"
 #include "sp_texture.h"
 
 #include "nir.h"
@@ -234,6 +235,7 @@ softpipe_delete_fs_state(struct pipe_context *pipe, void *fs)
       draw_delete_fragment_shader(softpipe->draw, var->draw_shader);
 #endif
 
+      sp_rast_threads_unbind_fs_variant(softpipe, var);
       var->delete(var, softpipe->fs_machine);
    }
 
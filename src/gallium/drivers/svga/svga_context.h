@@ -350,6 +350,7 @@ struct svga_hw_clear_state
    /* VGPU9 only */
    SVGA3dRect viewport;
    struct svga_depthrange depthrange;
+   float clip_planes[SVGA3D_MAX_CLIP_PLANES][4];
 
    /* VGPU10 state */
    SVGA3dViewport viewports[SVGA3D_DX_MAX_VIEWPORTS];
@@ -874,10 +874,13 @@ emit_clip_planes( struct svga_context *svga,
          //debug_printf("XXX emit DX10 clip plane\n");
          ret = PIPE_OK;
       }
-      else {
+      else if (memcmp(plane, svga->state.hw_clear.clip_planes[i],
+                      sizeof(plane)) != 0) {
          ret = SVGA3D_SetClipPlane(svga->swc, i, plane);
          if (ret != PIPE_OK)
             return ret;
+
+         memcpy(svga->state.hw_clear.clip_planes[i], plane, sizeof(plane));
       }
    }
 
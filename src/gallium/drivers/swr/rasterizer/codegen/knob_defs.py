@@ -124,6 +124,25 @@ KNOBS = [
         'category'  : 'perf',
     }],
 
+    ['HOT_TILE_MEMORY_BUDGET_MB', {
+        'type'      : 'uint32_t',
+        'default'   : '0',
+        'desc'      : ['Maximum memory in MB used by hot tiles.',
+                       '  0 == No limit, hot tiles stay allocated until the context is destroyed',
+                       '  N == Least recently used macro tiles are stored to their surfaces',
+                       '       and freed once the hot tiles take more than N MB'],
+        'category'  : 'perf',
+    }],
+
+    ['HOT_TILE_SPILL_DIRTY', {
+        'type'      : 'bool',
+        'default'   : 'true',
+        'desc'      : ['Allow hot tiles which have been rendered to be stored to their',
+                       'surface early to stay within HOT_TILE_MEMORY_BUDGET_MB.',
+                       'If disabled, only hot tiles consistent with memory are freed.'],
+        'category'  : 'perf_adv',
+    }],
+
     ['BUCKETS_START_FRAME', {
         'type'      : 'uint32_t',
         'default'   : '1200',
@@ -144,6 +163,19 @@ KNOBS = [
         'category'  : 'perf_adv',
     }],
 
+    ['BUCKETS_ENABLE_THREADVIZ', {
+        'type'      : 'bool',
+        'default'   : 'false',
+        'desc'      : ['Stream the start and end of the threadviz buckets of every',
+                       'thread to threadviz_thread.<id>.bin while buckets are captured,',
+                       'and convert them to a chrome trace in rdtsc_trace.json at',
+                       'BUCKETS_END_FRAME.',
+                       '',
+                       'NOTE: KNOB_ENABLE_RDTSC must be enabled in core/knobs.h',
+                       'for this to have an effect.'],
+        'category'  : 'perf_adv',
+    }],
+
     ['WORKER_SPIN_LOOP_COUNT', {
         'type'      : 'uint32_t',
         'default'   : '5000',
@@ -173,11 +173,131 @@ void BucketManager::PrintReport(const std::string& filename)
 }
 
 
-void BucketManager::StartCapture()
+std::string BucketManager::ThreadVizFilename(const BUCKET_THREAD& thread) const
+{
+    std::stringstream ss;
+    ss << mThreadVizDir << PATH_SEPARATOR << "threadviz_thread." << thread.id << ".bin";
+    return ss.str();
+}
+
+void BucketManager::FlushThreadViz(BUCKET_THREAD& bt)
+{
+    if (bt.vizTrace.size())
+    {
+        fwrite(bt.vizTrace.data(), sizeof(VIZ_TRACE_DATA), bt.vizTrace.size(), bt.vizFile);
+        bt.vizTrace.clear();
+    }
+}
+
+void BucketManager::StopThreadViz()
+{
+    mThreadMutex.lock();
+    for (BUCKET_THREAD& thread : mThreads)
+    {
+        if (thread.vizFile)
+        {
+            FlushThreadViz(thread);
+            fclose(thread.vizFile);
+            thread.vizFile = nullptr;
+        }
+    }
+    mThreadMutex.unlock();
+}
+
+void BucketManager::PrintTrace(const std::string& filename)
+{
+    // rdtsc ticks per microsecond, measured over the capture
+    double elapsedUs = std::chrono::duration<double, std::micro>(mStopTime - mStartTime).count();
+    double ticksPerUs =
+        elapsedUs > 0.0 ? (double)(mStopTsc - mStartTsc) / elapsedUs : 1.0;
+
+    FILE* f = fopen(filename.c_str(), "w");
+    if (!f)
+    {
+        return;
+    }
+
+    fprintf(f, "{\"traceEvents\":[\n");
+    const char* sep = "";
+
+    mThreadMutex.lock();
+    for (const BUCKET_THREAD& thread : mThreads)
+    {
+        fprintf(f,
+                "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,"
+                "\"args\":{\"name\":\"%s\"}}",
+                sep,
+                thread.id,
+                thread.name.c_str());
+        sep = ",\n";
+
+        FILE* vizFile = fopen(ThreadVizFilename(thread).c_str(), "rb");
+        if (!vizFile)
+        {
+            continue;
+        }
+
+        VIZ_TRACE_DATA data;
+        while (fread(&data, sizeof(data), 1, vizFile) == 1)
+        {
+            double ts = (double)(data.timestamp - mStartTsc) / ticksPerUs;
+            const BUCKET_DESC& desc = mBuckets[data.bucketId];
+
+            if (data.type == VIZ_START)
+            {
+                fprintf(f,
+                        "%s{\"name\":\"%s\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":0,\"tid\":%u,"
+                        "\"args\":{\"drawId\":%u}}",
+                        sep,
+                        desc.name.c_str(),
+                        ts,
+                        thread.id,
+                        data.drawId);
+            }
+            else
+            {
+                fprintf(f,
+                        "%s{\"name\":\"%s\",\"ph\":\"E\",\"ts\":%.3f,\"pid\":0,\"tid\":%u}",
+                        sep,
+                        desc.name.c_str(),
+                        ts,
+                        thread.id);
+            }
+        }
+
+        fclose(vizFile);
+    }
+    mThreadMutex.unlock();
+
+    fprintf(f, "\n]}\n");
+    fclose(f);
+}
+
+void BucketManager::StartCapture(bool enableThreadViz)
 {
 
     printf("Capture Starting\n");
 
+    if (enableThreadViz)
+    {
+        if (mThreadVizDir.empty())
+        {
+            mThreadVizDir = ".";
+        }
+
+        // open the per-thread files before any thread can see mCapturing
+        mThreadMutex.lock();
+        for (BUCKET_THREAD& thread : mThreads)
+        {
+            thread.vizTrace.clear();
+            thread.vizTrace.reserve(VIZ_BUFFER_RECORDS);
+            thread.vizFile = fopen(ThreadVizFilename(thread).c_str(), "wb");
+        }
+        mThreadMutex.unlock();
+    }
+
+    mStartTsc  = __rdtsc();
+    mStartTime = std::chrono::steady_clock::now();
     mCapturing = true;
 }
 
@@ -33,6 +33,7 @@
 #include <vector>
 #include <mutex>
 #include <sstream>
+#include <chrono>
 
 #include "rdtsc_buckets_shared.h"
 
@@ -91,8 +92,12 @@ public:
     void PrintReport(const std::string& filename);
 
 
+    // write the threadviz records of the last capture as a chrome trace
+    void PrintTrace(const std::string& filename);
+
     // start capturing
-    void StartCapture();
+    // @param enableThreadViz - also stream the threadviz buckets to disk
+    void StartCapture(bool enableThreadViz = false);
 
     // stop capturing
     INLINE void StopCapture()
@@ -115,12 +120,16 @@ public:
         }
 
         mDoneCapturing = true;
+        mStopTsc       = __rdtsc();
+        mStopTime      = std::chrono::steady_clock::now();
+        StopThreadViz();
         printf("Capture Stopped\n");
     }
 
     // start a bucket
     // @param id generated by RegisterBucket
-    INLINE void StartBucket(UINT id)
+    // @param drawId draw the work belongs to, recorded for threadviz
+    INLINE void StartBucket(UINT id, uint32_t drawId = 0)
     {
         if (!mCapturing)
             return;
@@ -143,6 +152,11 @@ public:
 
             // update thread's currently executing bucket
             bt.pCurrent = &child;
+
+            if (bt.vizFile && mBuckets[id].enableThreadViz)
+            {
+                RecordThreadViz(bt, VIZ_START, id, drawId, tsc);
+            }
         }
 
 
@@ -170,6 +184,11 @@ public:
             bt.pCurrent->elapsed += (tsc - bt.pCurrent->start);
             bt.pCurrent->count++;
 
+            if (bt.vizFile && mBuckets[id].enableThreadViz)
+            {
+                RecordThreadViz(bt, VIZ_STOP, id, 0, tsc);
+            }
+
             // pop to parent
             bt.pCurrent = bt.pCurrent->pParent;
         }
@@ -200,6 +219,30 @@ public:
     }
 
 private:
+    // number of threadviz records buffered per thread before writing them out
+    static const size_t VIZ_BUFFER_RECORDS = 4096;
+
+    INLINE void RecordThreadViz(
+        BUCKET_THREAD& bt, uint8_t type, UINT id, uint32_t drawId, uint64_t tsc)
+    {
+        VIZ_TRACE_DATA data;
+        data.timestamp = tsc;
+        data.drawId    = drawId;
+        data.bucketId  = (uint16_t)id;
+        data.type      = type;
+        data.pad       = 0;
+        bt.vizTrace.push_back(data);
+
+        if (bt.vizTrace.size() == VIZ_BUFFER_RECORDS)
+        {
+            FlushThreadViz(bt);
+        }
+    }
+
+    void FlushThreadViz(BUCKET_THREAD& bt);
+    void StopThreadViz();
+    std::string ThreadVizFilename(const BUCKET_THREAD& thread) const;
+
     void PrintBucket(
         FILE* f, UINT level, uint64_t threadCycles, uint64_t parentCycles, const BUCKET& bucket);
     void PrintThread(FILE* f, const BUCKET_THREAD& thread);
@@ -220,6 +263,12 @@ private:
 
     std::string mThreadVizDir;
 
+    // timestamps used to convert rdtsc ticks to time for threadviz
+    uint64_t                              mStartTsc{0};
+    uint64_t                              mStopTsc{0};
+    std::chrono::steady_clock::time_point mStartTime;
+    std::chrono::steady_clock::time_point mStopTime;
+
 };
 
 // C helpers for jitter
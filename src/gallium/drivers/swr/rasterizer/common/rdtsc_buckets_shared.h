@@ -59,6 +59,16 @@ struct BUCKET_DESC
 };
 
 
+// fixed size record streamed to the per-thread threadviz files
+struct VIZ_TRACE_DATA
+{
+    uint64_t timestamp;
+    uint32_t drawId;
+    uint16_t bucketId;
+    uint8_t  type;
+    uint8_t  pad;
+};
+
 struct BUCKET_THREAD
 {
     // name of thread, used in reports
@@ -79,6 +89,8 @@ struct BUCKET_THREAD
     // threadviz file object
     FILE* vizFile{nullptr};
 
+    // threadviz records not yet written to vizFile
+    std::vector<VIZ_TRACE_DATA> vizTrace;
 
     BUCKET_THREAD() {}
     BUCKET_THREAD(const BUCKET_THREAD& that)
@@ -88,6 +100,7 @@ struct BUCKET_THREAD
         root     = that.root;
         pCurrent = &root;
         vizFile  = that.vizFile;
+        vizTrace = that.vizTrace;
     }
 };
 
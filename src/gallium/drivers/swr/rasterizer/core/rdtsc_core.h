@@ -102,7 +102,7 @@ enum CORE_BUCKETS
 
 void rdtscReset(BucketManager* pBucketMgr);
 void rdtscInit(BucketManager* pBucketMgr, int threadId);
-void rdtscStart(BucketManager* pBucketMgr, uint32_t bucketId);
+void rdtscStart(BucketManager* pBucketMgr, uint32_t bucketId, uint32_t drawId);
 void rdtscStop(BucketManager* pBucketMgr, uint32_t bucketId, uint32_t count, uint64_t drawId);
 void rdtscEvent(BucketManager* pBucketMgr, uint32_t bucketId, uint32_t count1, uint32_t count2);
 void rdtscEndFrame(BucketManager* pBucketMgr);
@@ -110,14 +110,14 @@ void rdtscEndFrame(BucketManager* pBucketMgr);
 #ifdef KNOB_ENABLE_RDTSC
 #define RDTSC_RESET(pBucketMgr) rdtscReset(pBucketMgr)
 #define RDTSC_INIT(pBucketMgr, threadId) rdtscInit(pBucketMgr,threadId)
-#define RDTSC_START(pBucketMgr, bucket) rdtscStart(pBucketMgr, bucket)
+#define RDTSC_START(pBucketMgr, bucket, draw) rdtscStart(pBucketMgr, bucket, draw)
 #define RDTSC_STOP(pBucketMgr, bucket, count, draw) rdtscStop(pBucketMgr, bucket, count, draw)
 #define RDTSC_EVENT(pBucketMgr, bucket, count1, count2) rdtscEvent(pBucketMgr, bucket, count1, count2)
 #define RDTSC_ENDFRAME(pBucketMgr) rdtscEndFrame(pBucketMgr)
 #else
 #define RDTSC_RESET(pBucketMgr)
 #define RDTSC_INIT(pBucketMgr, threadId)
-#define RDTSC_START(pBucketMgr, bucket)
+#define RDTSC_START(pBucketMgr, bucket, draw)
 #define RDTSC_STOP(pBucketMgr, bucket, count, draw)
 #define RDTSC_EVENT(pBucketMgr, bucket, count1, count2)
 #define RDTSC_ENDFRAME(pBucketMgr)
@@ -148,10 +148,10 @@ INLINE void rdtscInit(BucketManager* pBucketMgr, int threadId)
     pBucketMgr->RegisterThread(name);
 }
 
-INLINE void rdtscStart(BucketManager* pBucketMgr, uint32_t bucketId)
+INLINE void rdtscStart(BucketManager* pBucketMgr, uint32_t bucketId, uint32_t drawId)
 {
     uint32_t id = pBucketMgr->mBucketMap[bucketId];
-    pBucketMgr->StartBucket(id);
+    pBucketMgr->StartBucket(id, drawId);
 }
 
 INLINE void rdtscStop(BucketManager* pBucketMgr, uint32_t bucketId, uint32_t count, uint64_t drawId)
@@ -173,7 +173,7 @@ INLINE void rdtscEndFrame(BucketManager* pBucketMgr)
     if (pBucketMgr->mCurrentFrame == KNOB_BUCKETS_START_FRAME &&
         KNOB_BUCKETS_START_FRAME < KNOB_BUCKETS_END_FRAME)
     {
-        pBucketMgr->StartCapture();
+        pBucketMgr->StartCapture(KNOB_BUCKETS_ENABLE_THREADVIZ);
     }
 
     if (pBucketMgr->mCurrentFrame == KNOB_BUCKETS_END_FRAME &&
@@ -181,5 +181,9 @@ INLINE void rdtscEndFrame(BucketManager* pBucketMgr)
     {
         pBucketMgr->StopCapture();
         pBucketMgr->PrintReport("rdtsc.txt");
+        if (KNOB_BUCKETS_ENABLE_THREADVIZ)
+        {
+            pBucketMgr->PrintTrace("rdtsc_trace.json");
+        }
     }
 }
@@ -614,6 +614,8 @@ bool WorkOnFifoBE(SWR_CONTEXT* pContext,
                 uint32_t numWorkItems = tile->getNumQueued();
                 SWR_ASSERT(numWorkItems);
 
+                pContext->pHotTileMgr->BeginMacroTile(tileID);
+
                 pWork = tile->peek();
                 SWR_ASSERT(pWork);
                 if (pWork->type == DRAW)
@@ -632,6 +634,8 @@ bool WorkOnFifoBE(SWR_CONTEXT* pContext,
                 }
                 RDTSC_END(pContext->pBucketMgr, WorkerFoundWork, numWorkItems);
 
+                pContext->pHotTileMgr->EndMacroTile(pContext, pDC, workerId, tileID);
+
                 _ReadWriteBarrier();
 
                 pDC->pTileMgr->markTileComplete(tileID);
@@ -724,7 +728,10 @@ INLINE void CompleteDrawFE(SWR_CONTEXT* pContext, uint32_t workerId, DRAW_CONTEX
     InterlockedDecrement(&pContext->drawsOutstandingFE);
 }
 
-void WorkOnFifoFE(SWR_CONTEXT* pContext, uint32_t workerId, uint32_t& curDrawFE)
+//////////////////////////////////////////////////////////////////////////
+/// @brief If there is any FE work then go work on it.
+/// @param maxDraws - Return after running the FE of this many draws, 0 for no limit.
+void WorkOnFifoFE(SWR_CONTEXT* pContext, uint32_t workerId, uint32_t& curDrawFE, uint32_t maxDraws)
 {
     // Try to grab the next DC from the ring
     uint32_t drawEnqueued = GetEnqueuedDraw(pContext);
@@ -764,6 +771,11 @@ void WorkOnFifoFE(SWR_CONTEXT* pContext, uint32_t workerId, uint32_t& curDrawFE)
                 pDC->FeWork.pfnWork(pContext, pDC, workerId, &pDC->FeWork.desc);
 
                 CompleteDrawFE(pContext, workerId, pDC);
+
+                if (maxDraws && --maxDraws == 0)
+                {
+                    return;
+                }
             }
             else
             {
@@ -855,6 +867,20 @@ void BindApiThread(SWR_CONTEXT* pContext, uint32_t apiThreadId)
         pContext, threadData.threadId, threadData.procGroupId, threadData.forceBindProcGroup);
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Returns true if the oldest draw the worker hasn't retired is
+/// waiting for its FE, i.e. there is no BE work to do before more FE is done.
+INLINE bool BackendWaitingOnFE(SWR_CONTEXT* pContext, uint32_t curDrawBE)
+{
+    if (!IDComparesLess(curDrawBE, GetEnqueuedDraw(pContext)))
+    {
+        return false;
+    }
+
+    DRAW_CONTEXT* pDC = &pContext->dcRing[curDrawBE % pContext->MAX_DRAWS_IN_FLIGHT];
+    return !pDC->isCompute && !pDC->doneFE;
+}
+
 template <bool IsFEThread, bool IsBEThread>
 DWORD workerThreadMain(LPVOID pData)
 {
@@ -919,6 +945,13 @@ DWORD workerThreadMain(LPVOID pData)
 
     bool bShutdown = false;
 
+#ifdef KNOB_ENABLE_AR
+    // Cycles spent on each role since the worker last went idle
+    uint64_t feCycles = 0;
+    uint64_t beCycles = 0;
+    uint32_t feFirst  = 0;
+#endif
+
     while (true)
     {
         if (bShutdown && !threadHasWork(curDrawBE))
@@ -934,6 +967,16 @@ DWORD workerThreadMain(LPVOID pData)
 
         if (!threadHasWork(curDrawBE))
         {
+#ifdef KNOB_ENABLE_AR
+            if (feCycles || beCycles)
+            {
+                _AR_EVENT(pContext->pArContext[workerId],
+                          WorkerUtilizationEvent(curDrawBE, feCycles, beCycles, feFirst));
+                feCycles = beCycles = 0;
+                feFirst             = 0;
+            }
+#endif
+
             lock.lock();
 
             // check for thread idle condition again under lock
@@ -947,19 +990,48 @@ DWORD workerThreadMain(LPVOID pData)
             lock.unlock();
         }
 
+        // Workers doing both roles balance them: while the BE is blocked on the FE
+        // of the oldest draw they help the FE first, otherwise they drain the BE
+        // first and only take one FE draw before checking on the BE again.
+        bool feFirstPass = IsFEThread && IsBEThread && BackendWaitingOnFE(pContext, curDrawBE);
+
+        if (IsFEThread && feFirstPass)
+        {
+#ifdef KNOB_ENABLE_AR
+            uint64_t start = __rdtsc();
+            feFirst++;
+#endif
+            WorkOnFifoFE(pContext, workerId, curDrawFE);
+#ifdef KNOB_ENABLE_AR
+            feCycles += __rdtsc() - start;
+#endif
+        }
+
         if (IsBEThread)
         {
+#ifdef KNOB_ENABLE_AR
+            uint64_t start = __rdtsc();
+#endif
             RDTSC_BEGIN(pContext->pBucketMgr, WorkerWorkOnFifoBE, 0);
             bShutdown |=
                 WorkOnFifoBE(pContext, workerId, curDrawBE, lockedTiles, numaNode, numaMask);
             RDTSC_END(pContext->pBucketMgr, WorkerWorkOnFifoBE, 0);
 
             WorkOnCompute(pContext, workerId, curDrawBE);
+#ifdef KNOB_ENABLE_AR
+            beCycles += __rdtsc() - start;
+#endif
         }
 
-        if (IsFEThread)
+        if (IsFEThread && !feFirstPass)
         {
-            WorkOnFifoFE(pContext, workerId, curDrawFE);
+#ifdef KNOB_ENABLE_AR
+            uint64_t start = __rdtsc();
+#endif
+            WorkOnFifoFE(pContext, workerId, curDrawFE, IsBEThread ? 1 : 0);
+#ifdef KNOB_ENABLE_AR
+            feCycles += __rdtsc() - start;
+#endif
 
             if (!IsBEThread)
             {
@@ -69,7 +69,10 @@ void StartThreadPool(SWR_CONTEXT* pContext, THREAD_POOL* pPool);
 void DestroyThreadPool(SWR_CONTEXT* pContext, THREAD_POOL* pPool);
 
 // Expose FE and BE worker functions to the API thread if single threaded
-void    WorkOnFifoFE(SWR_CONTEXT* pContext, uint32_t workerId, uint32_t& curDrawFE);
+void    WorkOnFifoFE(SWR_CONTEXT* pContext,
+                     uint32_t     workerId,
+                     uint32_t&    curDrawFE,
+                     uint32_t     maxDraws = 0);
 bool    WorkOnFifoBE(SWR_CONTEXT* pContext,
                      uint32_t     workerId,
                      uint32_t&    curDrawBE,
@@ -88,6 +88,29 @@ void MacroTileMgr::markTileComplete(uint32_t id)
     tile.mWorkItemsBE = 0;
 }
 
+static SWR_FORMAT HotTileFormat(SWR_RENDERTARGET_ATTACHMENT attachment)
+{
+    switch (attachment)
+    {
+    case SWR_ATTACHMENT_COLOR0:
+    case SWR_ATTACHMENT_COLOR1:
+    case SWR_ATTACHMENT_COLOR2:
+    case SWR_ATTACHMENT_COLOR3:
+    case SWR_ATTACHMENT_COLOR4:
+    case SWR_ATTACHMENT_COLOR5:
+    case SWR_ATTACHMENT_COLOR6:
+    case SWR_ATTACHMENT_COLOR7:
+        return KNOB_COLOR_HOT_TILE_FORMAT;
+    case SWR_ATTACHMENT_DEPTH:
+        return KNOB_DEPTH_HOT_TILE_FORMAT;
+    case SWR_ATTACHMENT_STENCIL:
+        return KNOB_STENCIL_HOT_TILE_FORMAT;
+    default:
+        SWR_INVALID("Unknown attachment: %d", attachment);
+        return KNOB_COLOR_HOT_TILE_FORMAT;
+    }
+}
+
 HOTTILE* HotTileMgr::GetHotTile(SWR_CONTEXT*                pContext,
                                 DRAW_CONTEXT*               pDC,
                                 HANDLE                      hWorkerPrivateData,
@@ -131,7 +154,7 @@ HOTTILE* HotTileMgr::GetHotTile(SWR_CONTEXT*                pContext,
             // new sample count
             SWR_ASSERT((hotTile.state == HOTTILE_INVALID) || (hotTile.state == HOTTILE_RESOLVED) ||
                        (hotTile.state == HOTTILE_CLEAR));
-            FreeHotTileMem(hotTile.pBuffer);
+            FreeHotTileMem(hotTile.pBuffer, hotTile.numSamples * mHotTileSize[attachment]);
 
             uint32_t size     = numSamples * mHotTileSize[attachment];
             uint32_t numaNode = ((x ^ y) & pContext->threadPool.numaMask);
@@ -145,30 +168,7 @@ HOTTILE* HotTileMgr::GetHotTile(SWR_CONTEXT*                pContext,
         // current hottile and load the requested array slice
         if (renderTargetArrayIndex != hotTile.renderTargetArrayIndex)
         {
-            SWR_FORMAT format;
-            switch (attachment)
-            {
-            case SWR_ATTACHMENT_COLOR0:
-            case SWR_ATTACHMENT_COLOR1:
-            case SWR_ATTACHMENT_COLOR2:
-            case SWR_ATTACHMENT_COLOR3:
-            case SWR_ATTACHMENT_COLOR4:
-            case SWR_ATTACHMENT_COLOR5:
-            case SWR_ATTACHMENT_COLOR6:
-            case SWR_ATTACHMENT_COLOR7:
-                format = KNOB_COLOR_HOT_TILE_FORMAT;
-                break;
-            case SWR_ATTACHMENT_DEPTH:
-                format = KNOB_DEPTH_HOT_TILE_FORMAT;
-                break;
-            case SWR_ATTACHMENT_STENCIL:
-                format = KNOB_STENCIL_HOT_TILE_FORMAT;
-                break;
-            default:
-                SWR_INVALID("Unknown attachment: %d", attachment);
-                format = KNOB_COLOR_HOT_TILE_FORMAT;
-                break;
-            }
+            SWR_FORMAT format = HotTileFormat(attachment);
 
             if (hotTile.state == HOTTILE_CLEAR)
             {
@@ -230,7 +230,9 @@ HOTTILE* HotTileMgr::GetHotTileNoLoad(SWR_CONTEXT*                pContext,
         if (create)
         {
             uint32_t size                  = numSamples * mHotTileSize[attachment];
-            hotTile.pBuffer                = (uint8_t*)AlignedMalloc(size, 64);
+            uint32_t numaNode              = ((x ^ y) & pContext->threadPool.numaMask);
+            hotTile.pBuffer                = (uint8_t*)AllocHotTileMem(
+                size, 64, numaNode + pContext->threadInfo.BASE_NUMA_NODE);
             hotTile.state                  = HOTTILE_INVALID;
             hotTile.numSamples             = numSamples;
             hotTile.renderTargetArrayIndex = 0;
@@ -244,6 +246,164 @@ HOTTILE* HotTileMgr::GetHotTileNoLoad(SWR_CONTEXT*                pContext,
     return &hotTile;
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Remove a macro tile from the LRU list.  mLruLock must be held.
+void HotTileMgr::LruUnlink(uint32_t index)
+{
+    uint32_t prev = mLruPrev[index];
+    uint32_t next = mLruNext[index];
+
+    if (prev != LRU_NONE)
+        mLruNext[prev] = next;
+    else if (mLruHead == index)
+        mLruHead = next;
+    else
+        return; // not in the list
+
+    if (next != LRU_NONE)
+        mLruPrev[next] = prev;
+    else
+        mLruTail = prev;
+
+    mLruPrev[index] = LRU_NONE;
+    mLruNext[index] = LRU_NONE;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Make a macro tile the most recently used.  mLruLock must be held.
+void HotTileMgr::LruTouch(uint32_t index)
+{
+    LruUnlink(index);
+
+    mLruPrev[index] = mLruTail;
+    if (mLruTail != LRU_NONE)
+        mLruNext[mLruTail] = index;
+    else
+        mLruHead = index;
+    mLruTail = index;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Write back and free the hot tiles of a macro tile.  Tiles with a
+/// pending clear are kept, as are dirty ones if spilling is disabled.
+/// The caller must own the macro tile's busy flag.
+/// @return true if no hot tile memory is left for the macro tile.
+bool HotTileMgr::EvictMacroTile(DRAW_CONTEXT* pDC, HANDLE hWorkerPrivateData, uint32_t index)
+{
+    SWR_CONTEXT* pContext = pDC->pContext;
+    uint32_t     x        = index / KNOB_NUM_HOT_TILES_Y;
+    uint32_t     y        = index % KNOB_NUM_HOT_TILES_Y;
+    bool         empty    = true;
+
+    for (uint32_t a = 0; a < SWR_NUM_ATTACHMENTS; ++a)
+    {
+        HOTTILE& hotTile = mHotTiles[x][y].Attachment[a];
+
+        if (hotTile.pBuffer == NULL)
+            continue;
+
+        if (hotTile.state == HOTTILE_CLEAR ||
+            (hotTile.state == HOTTILE_DIRTY && !KNOB_HOT_TILE_SPILL_DIRTY))
+        {
+            empty = false;
+            continue;
+        }
+
+        if (hotTile.state == HOTTILE_DIRTY)
+        {
+            RDTSC_BEGIN(pContext->pBucketMgr, BEStoreTiles, pDC->drawId);
+            pContext->pfnStoreTile(pDC,
+                                   hWorkerPrivateData,
+                                   HotTileFormat((SWR_RENDERTARGET_ATTACHMENT)a),
+                                   (SWR_RENDERTARGET_ATTACHMENT)a,
+                                   x * KNOB_MACROTILE_X_DIM,
+                                   y * KNOB_MACROTILE_Y_DIM,
+                                   hotTile.renderTargetArrayIndex,
+                                   hotTile.pBuffer);
+            RDTSC_END(pContext->pBucketMgr, BEStoreTiles, 1);
+        }
+
+        FreeHotTileMem(hotTile.pBuffer, hotTile.numSamples * mHotTileSize[a]);
+        hotTile.pBuffer = NULL;
+        hotTile.state   = HOTTILE_INVALID;
+    }
+
+    return empty;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Called by a worker before it works on the hot tiles of a macro
+/// tile, waits for a concurrent eviction of them to finish.
+void HotTileMgr::BeginMacroTile(uint32_t macroID)
+{
+    if (!mMemoryBudget)
+        return;
+
+    uint32_t x, y;
+    MacroTileMgr::getTileIndices(macroID, x, y);
+
+    std::atomic<uint8_t>& busy = mBusy[LruIndex(x, y)];
+    uint8_t               idle = 0;
+    while (!busy.compare_exchange_weak(idle, 1, std::memory_order_acquire))
+    {
+        idle = 0;
+        _mm_pause();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Called by a worker when it is done with the hot tiles of a macro
+/// tile.  Evicts the least recently used macro tiles, other than the ones
+/// in use, while the hot tiles take more memory than the budget.
+void HotTileMgr::EndMacroTile(SWR_CONTEXT*  pContext,
+                              DRAW_CONTEXT* pDC,
+                              uint32_t      workerId,
+                              uint32_t      macroID)
+{
+    if (!mMemoryBudget)
+        return;
+
+    HANDLE hWorkerPrivateData = pContext->threadPool.pThreadData[workerId].pWorkerPrivateData;
+
+    uint32_t x, y;
+    MacroTileMgr::getTileIndices(macroID, x, y);
+    uint32_t index = LruIndex(x, y);
+
+    std::unique_lock<std::mutex> lock(mLruLock);
+    LruTouch(index);
+    mBusy[index].store(0, std::memory_order_release);
+
+    // Tiles which couldn't be evicted completely move to the end of the list.
+    // Bound the work done here, the next macro tiles will carry on.
+    uint32_t candidate = mLruHead;
+    uint32_t attempts  = 0;
+    while (mResidentBytes > mMemoryBudget && candidate != index && candidate != LRU_NONE &&
+           attempts < MAX_EVICTION_ATTEMPTS)
+    {
+        uint32_t next = mLruNext[candidate];
+        uint8_t  idle = 0;
+
+        if (mBusy[candidate].compare_exchange_strong(idle, 1, std::memory_order_acquire))
+        {
+            attempts++;
+            LruUnlink(candidate);
+            lock.unlock();
+
+            bool empty = EvictMacroTile(pDC, hWorkerPrivateData, candidate);
+
+            lock.lock();
+            if (!empty)
+                LruTouch(candidate);
+            mBusy[candidate].store(0, std::memory_order_release);
+
+            // the list may have changed while it was unlocked
+            next = mLruHead;
+        }
+
+        candidate = next;
+    }
+}
+
 void HotTileMgr::ClearColorHotTile(
     const HOTTILE* pHotTile) // clear a macro tile from float4 clear data.
 {
@@ -28,8 +28,11 @@
  ******************************************************************************/
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include <set>
 #include <unordered_map>
+#include <vector>
 #include "common/formats.h"
 #include "common/intrin.h"
 #include "fifo.hpp"
@@ -281,6 +284,15 @@ public:
                                              FormatTraits<KNOB_DEPTH_HOT_TILE_FORMAT>::bpp / 8;
         mHotTileSize[SWR_ATTACHMENT_STENCIL] = KNOB_MACROTILE_X_DIM * KNOB_MACROTILE_Y_DIM *
                                                FormatTraits<KNOB_STENCIL_HOT_TILE_FORMAT>::bpp / 8;
+
+        // the LRU list and the busy flags are only needed to enforce a budget
+        mMemoryBudget = uint64_t(KNOB_HOT_TILE_MEMORY_BUDGET_MB) << 20;
+        if (mMemoryBudget)
+        {
+            mLruPrev.assign(NUM_MACRO_TILES, LRU_NONE);
+            mLruNext.assign(NUM_MACRO_TILES, LRU_NONE);
+            mBusy = new std::atomic<uint8_t>[NUM_MACRO_TILES]();
+        }
     }
 
     ~HotTileMgr()
@@ -291,10 +303,12 @@ public:
             {
                 for (int a = 0; a < SWR_NUM_ATTACHMENTS; ++a)
                 {
-                    FreeHotTileMem(mHotTiles[x][y].Attachment[a].pBuffer);
+                    FreeHotTileMem(mHotTiles[x][y].Attachment[a].pBuffer, 0);
                 }
             }
         }
+
+        delete[] mBusy;
     }
 
     void InitializeHotTiles(SWR_CONTEXT*  pContext,
@@ -318,14 +332,42 @@ public:
                               bool                        create,
                               uint32_t                    numSamples = 1);
 
+    void BeginMacroTile(uint32_t macroID);
+    void EndMacroTile(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroID);
+
     static void ClearColorHotTile(const HOTTILE* pHotTile);
     static void ClearDepthHotTile(const HOTTILE* pHotTile);
     static void ClearStencilHotTile(const HOTTILE* pHotTile);
 
 private:
+    static const uint32_t NUM_MACRO_TILES       = KNOB_NUM_HOT_TILES_X * KNOB_NUM_HOT_TILES_Y;
+    static const uint32_t LRU_NONE              = 0xffffffff;
+    static const uint32_t MAX_EVICTION_ATTEMPTS = 16;
+
     HotTileSet mHotTiles[KNOB_NUM_HOT_TILES_X][KNOB_NUM_HOT_TILES_Y];
     uint32_t   mHotTileSize[SWR_NUM_ATTACHMENTS];
 
+    // Memory budget for the hot tiles, 0 if unlimited.  Once it is exceeded, the
+    // least recently used macro tiles are written back to their surfaces and freed.
+    uint64_t              mMemoryBudget{0};
+    std::atomic<uint64_t> mResidentBytes{0};
+
+    // LRU list of the macro tiles with hot tile memory, most recent at the tail.
+    std::mutex            mLruLock;
+    std::vector<uint32_t> mLruPrev;
+    std::vector<uint32_t> mLruNext;
+    uint32_t              mLruHead{LRU_NONE};
+    uint32_t              mLruTail{LRU_NONE};
+
+    // Set while a worker or an eviction works on the hot tiles of a macro tile.
+    std::atomic<uint8_t>* mBusy{nullptr};
+
+    static uint32_t LruIndex(uint32_t x, uint32_t y) { return x * KNOB_NUM_HOT_TILES_Y + y; }
+
+    void LruUnlink(uint32_t index);
+    void LruTouch(uint32_t index);
+    bool EvictMacroTile(DRAW_CONTEXT* pDC, HANDLE hWorkerPrivateData, uint32_t index);
+
     void* AllocHotTileMem(size_t size, uint32_t align, uint32_t numaNode)
     {
         void* p = nullptr;
@@ -337,10 +379,15 @@ private:
         p = AlignedMalloc(size, align);
 #endif
 
+        if (p)
+        {
+            mResidentBytes += size;
+        }
+
         return p;
     }
 
-    void FreeHotTileMem(void* pBuffer)
+    void FreeHotTileMem(void* pBuffer, size_t size)
     {
         if (pBuffer)
         {
@@ -349,6 +396,7 @@ private:
 #else
             AlignedFree(pBuffer);
 #endif
+            mResidentBytes -= size;
         }
     }
 };
@@ -28,6 +28,7 @@
 #include "swr_query.h"
 #include "jit_api.h"
 
+#include "util/bitscan.h"
 #include "util/u_draw.h"
 #include "util/u_prim.h"
 
@@ -158,11 +159,21 @@ swr_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info,
    if (search != velems->map.end()) {
       velems->fsFunc = search->second;
    } else {
-      HANDLE hJitMgr = swr_screen(ctx->pipe.screen)->hJitMgr;
-      velems->fsFunc = JitCompileFetch(hJitMgr, velems->fsState);
+      struct swr_screen *screen = swr_screen(ctx->pipe.screen);
 
-      debug_printf("fetch shader %p\n", velems->fsFunc);
-      assert(velems->fsFunc && "Error: FetchShader = NULL");
+      simple_mtx_lock(&screen->fetch_jit_lock);
+      auto shared = screen->fetchJIT->find(key);
+      if (shared != screen->fetchJIT->end()) {
+         velems->fsFunc = shared->second;
+      } else {
+         velems->fsFunc = JitCompileFetch(screen->hJitMgr, velems->fsState);
+
+         debug_printf("fetch shader %p\n", velems->fsFunc);
+         assert(velems->fsFunc && "Error: FetchShader = NULL");
+
+         screen->fetchJIT->insert(std::make_pair(key, velems->fsFunc));
+      }
+      simple_mtx_unlock(&screen->fetch_jit_lock);
 
       velems->map.insert(std::make_pair(key, velems->fsFunc));
    }
@@ -283,15 +294,22 @@ swr_flush(struct pipe_context *pipe,
    struct swr_context *ctx = swr_context(pipe);
    struct swr_screen *screen = swr_screen(pipe->screen);
 
+   /* Resolve all dirty attachments together, so that each worker stores
+    * every attachment of a macrotile in one pass and only one fence is
+    * needed to track completion. */
+   uint32_t attachments = 0;
    for (int i=0; i < ctx->framebuffer.nr_cbufs; i++) {
       struct pipe_surface *cb = ctx->framebuffer.cbufs[i];
-      if (cb) {
-         swr_store_dirty_resource(pipe, cb->texture, SWR_TILE_RESOLVED);
-      }
+      if (cb)
+         attachments |= swr_dirty_resource_attachments(ctx, cb->texture);
    }
    if (ctx->framebuffer.zsbuf) {
-      swr_store_dirty_resource(pipe, ctx->framebuffer.zsbuf->texture,
-                               SWR_TILE_RESOLVED);
+      attachments |=
+         swr_dirty_resource_attachments(ctx, ctx->framebuffer.zsbuf->texture);
+   }
+   if (attachments) {
+      swr_store_render_targets(pipe, attachments, SWR_TILE_RESOLVED);
+      swr_fence_submit(ctx, screen->flush_fence);
    }
 
    if (fence)
@@ -335,57 +353,103 @@ void
 swr_store_render_target(struct pipe_context *pipe,
                         uint32_t attachment,
                         enum SWR_TILE_STATE post_tile_state)
+{
+   swr_store_render_targets(pipe, 1 << attachment, post_tile_state);
+}
+
+/*
+ * Store the HotTiles of several attachments at once.  Attachments of the
+ * same size share a single SwrStoreTiles call.
+ */
+void
+swr_store_render_targets(struct pipe_context *pipe,
+                         uint32_t attachments,
+                         enum SWR_TILE_STATE post_tile_state)
 {
    struct swr_context *ctx = swr_context(pipe);
    struct swr_draw_context *pDC = &ctx->swrDC;
-   struct SWR_SURFACE_STATE *renderTarget = &pDC->renderTargets[attachment];
+   bool updated = false;
 
-   /* Only proceed if there's a valid surface to store to */
-   if (renderTarget->xpBaseAddress) {
-      swr_update_draw_context(ctx);
+   /* Only proceed for attachments with a valid surface to store to */
+   for (uint32_t i = 0; i < SWR_NUM_ATTACHMENTS; i++) {
+      if (!pDC->renderTargets[i].xpBaseAddress)
+         attachments &= ~(1u << i);
+   }
+
+   while (attachments) {
+      struct SWR_SURFACE_STATE *renderTarget =
+         &pDC->renderTargets[ffs(attachments) - 1];
       SWR_RECT full_rect =
          {0, 0,
           (int32_t)u_minify(renderTarget->width, renderTarget->lod),
           (int32_t)u_minify(renderTarget->height, renderTarget->lod)};
+
+      uint32_t mask = 0;
+      u_foreach_bit(i, attachments) {
+         struct SWR_SURFACE_STATE *rt = &pDC->renderTargets[i];
+         if ((int32_t)u_minify(rt->width, rt->lod) == full_rect.xmax &&
+             (int32_t)u_minify(rt->height, rt->lod) == full_rect.ymax)
+            mask |= 1u << i;
+      }
+      attachments &= ~mask;
+
+      if (!updated) {
+         swr_update_draw_context(ctx);
+         updated = true;
+      }
       ctx->api.pfnSwrStoreTiles(ctx->swrContext,
-                                1 << attachment,
+                                mask,
                                 post_tile_state,
                                 full_rect);
    }
 }
 
+/*
+ * Returns the mask of bound attachments a resource has to be stored from,
+ * or 0 if it has not been written to.
+ */
+uint32_t
+swr_dirty_resource_attachments(struct swr_context *ctx,
+                               struct pipe_resource *resource)
+{
+   struct swr_resource *spr = swr_resource(resource);
+
+   /* Only store resource if it has been written to */
+   if (!(spr->status & SWR_RESOURCE_WRITE))
+      return 0;
+
+   SWR_SURFACE_STATE *renderTargets = ctx->swrDC.renderTargets;
+   for (uint32_t i = 0; i < SWR_NUM_ATTACHMENTS; i++) {
+      if (renderTargets[i].xpBaseAddress == spr->swr.xpBaseAddress ||
+          (spr->secondary.xpBaseAddress &&
+           renderTargets[i].xpBaseAddress == spr->secondary.xpBaseAddress)) {
+         /* Mesa thinks depth/stencil are fused, so we'll never get an
+          * explicit resource for stencil.  So, if checking depth, then
+          * also check for stencil. */
+         if (spr->has_stencil && (i == SWR_ATTACHMENT_DEPTH))
+            return (1u << i) | (1u << SWR_ATTACHMENT_STENCIL);
+         return 1u << i;
+      }
+   }
+
+   return 0;
+}
+
 void
 swr_store_dirty_resource(struct pipe_context *pipe,
                          struct pipe_resource *resource,
                          enum SWR_TILE_STATE post_tile_state)
 {
-   /* Only store resource if it has been written to */
-   if (swr_resource(resource)->status & SWR_RESOURCE_WRITE) {
-      struct swr_context *ctx = swr_context(pipe);
+   struct swr_context *ctx = swr_context(pipe);
+   uint32_t attachments = swr_dirty_resource_attachments(ctx, resource);
+
+   if (attachments) {
       struct swr_screen *screen = swr_screen(pipe->screen);
-      struct swr_resource *spr = swr_resource(resource);
-
-      swr_draw_context *pDC = &ctx->swrDC;
-      SWR_SURFACE_STATE *renderTargets = pDC->renderTargets;
-      for (uint32_t i = 0; i < SWR_NUM_ATTACHMENTS; i++)
-         if (renderTargets[i].xpBaseAddress == spr->swr.xpBaseAddress ||
-             (spr->secondary.xpBaseAddress &&
-              renderTargets[i].xpBaseAddress == spr->secondary.xpBaseAddress)) {
-            swr_store_render_target(pipe, i, post_tile_state);
-
-            /* Mesa thinks depth/stencil are fused, so we'll never get an
-             * explicit resource for stencil.  So, if checking depth, then
-             * also check for stencil. */
-            if (spr->has_stencil && (i == SWR_ATTACHMENT_DEPTH)) {
-               swr_store_render_target(
-                  pipe, SWR_ATTACHMENT_STENCIL, post_tile_state);
-            }
 
-            /* This fence signals StoreTiles completion */
-            swr_fence_submit(ctx, screen->flush_fence);
+      swr_store_render_targets(pipe, attachments, post_tile_state);
 
-            break;
-         }
+      /* This fence signals StoreTiles completion */
+      swr_fence_submit(ctx, screen->flush_fence);
    }
 }
 
@@ -29,6 +29,7 @@
 #include "api.h"
 
 struct sw_displaytarget;
+struct swr_context;
 
 enum swr_resource_status {
    SWR_RESOURCE_UNUSED = 0x0,
@@ -108,6 +109,13 @@ void swr_store_render_target(struct pipe_context *pipe,
                              uint32_t attachment,
                              enum SWR_TILE_STATE post_tile_state);
 
+void swr_store_render_targets(struct pipe_context *pipe,
+                              uint32_t attachments,
+                              enum SWR_TILE_STATE post_tile_state);
+
+uint32_t swr_dirty_resource_attachments(struct swr_context *ctx,
+                                        struct pipe_resource *resource);
+
 void swr_store_dirty_resource(struct pipe_context *pipe,
                               struct pipe_resource *resource,
                               enum SWR_TILE_STATE post_tile_state);
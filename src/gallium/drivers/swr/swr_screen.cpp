@@ -1039,6 +1039,9 @@ swr_destroy_screen_internal(struct swr_screen **screen)
    swr_fence_finish(p_screen, NULL, (*screen)->flush_fence, 0);
    swr_fence_reference(p_screen, &(*screen)->flush_fence, NULL);
 
+   delete (*screen)->fetchJIT;
+   simple_mtx_destroy(&(*screen)->fetch_jit_lock);
+
    JitDestroyContext((*screen)->hJitMgr);
 
    if ((*screen)->pLibrary)
@@ -1138,6 +1141,10 @@ swr_create_screen_internal(struct sw_winsys *winsys)
    // Pass in "" for architecture for run-time determination
    screen->hJitMgr = JitCreateContext(KNOB_SIMD_WIDTH, "", "swr");
 
+   simple_mtx_init(&screen->fetch_jit_lock, mtx_plain);
+   screen->fetchJIT =
+      new std::unordered_map<swr_jit_fetch_key, PFN_FETCH_FUNC>;
+
    swr_fence_init(&screen->base);
 
    swr_validate_env_options(screen);
@@ -30,14 +30,17 @@
 #include "pipe/p_defines.h"
 #include "util/u_dl.h"
 #include "util/format/u_format.h"
+#include "util/simple_mtx.h"
 #include "api.h"
 
 #include "memory/TilingFunctions.h"
 #include "memory/InitMemory.h"
 #include <stdio.h>
 #include <stdarg.h>
+#include <unordered_map>
 
 struct sw_winsys;
+struct swr_jit_fetch_key;
 
 struct swr_screen {
    struct pipe_screen base;
@@ -54,6 +57,12 @@ struct swr_screen {
 
    HANDLE hJitMgr;
 
+   /* Fetch shaders only depend on their key, so they are shared by all
+    * vertex element states and contexts of the screen. They live as long
+    * as the JIT manager. */
+   simple_mtx_t fetch_jit_lock;
+   std::unordered_map<swr_jit_fetch_key, PFN_FETCH_FUNC> *fetchJIT;
+
    /* Dynamic backend implementations */
    util_dl_library *pLibrary;
    PFNSwrGetInterface pfnSwrGetInterface;
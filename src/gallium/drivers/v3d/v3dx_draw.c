@@ -224,6 +224,35 @@ v3d_predraw_check_stage_inputs(struct pipe_context *pctx,
         }
 }
 
+static bool
+v3d_resource_busy(struct pipe_resource *prsc)
+{
+        return prsc && !v3d_bo_wait(v3d_resource(prsc)->bo, 0, NULL);
+}
+
+/* Returns whether any resource read by the binner through vertex texturing
+ * or indirect drawing still has GPU work pending on it.
+ */
+static bool
+v3d_vertex_inputs_busy(struct v3d_context *v3d,
+                       const struct pipe_draw_indirect_info *indirect)
+{
+        if (indirect && v3d_resource_busy(indirect->buffer))
+                return true;
+
+        for (int i = 0; i < v3d->tex[PIPE_SHADER_VERTEX].num_textures; i++) {
+                struct pipe_sampler_view *pview =
+                        v3d->tex[PIPE_SHADER_VERTEX].textures[i];
+                if (!pview)
+                        continue;
+
+                if (v3d_resource_busy(v3d_sampler_view(pview)->texture))
+                        return true;
+        }
+
+        return false;
+}
+
 static void
 v3d_predraw_check_outputs(struct pipe_context *pctx)
 {
@@ -1176,11 +1205,13 @@ v3d_draw_vbo(struct pipe_context *pctx, const struct pipe_draw_info *info,
          * ensure that that rendering is complete before we run a coordinate
          * shader that depends on it.
          *
-         * Given that doing that is unusual, for now we just block the binner
-         * on the last submitted render, rather than tracking the last
-         * rendering to each texture's BO.
+         * We only have a single sync object for the last submitted job, so
+         * when that is needed we block the binner on it. Resources that are
+         * no longer busy on the GPU don't need it though, which lets binning
+         * overlap the previous render in the common case of static vertex
+         * textures and indirect buffers.
          */
-        if (v3d->tex[PIPE_SHADER_VERTEX].num_textures || (indirect && indirect->buffer)) {
+        if (v3d_vertex_inputs_busy(v3d, indirect)) {
                 perf_debug("Blocking binner on last render "
                            "due to vertex texturing or indirect drawing.\n");
                 job->submit.in_sync_bcl = v3d->out_sync;
@@ -184,15 +184,24 @@ static bool virgl_get_query_result(struct pipe_context *ctx,
       volatile struct virgl_host_query_state *host_state;
       struct pipe_transfer *transfer = NULL;
 
-      if (vs->vws->res_is_referenced(vs->vws, vctx->cbuf, query->buf->hw_res))
-         ctx->flush(ctx, NULL, 0);
+      host_state = vs->vws->resource_map(vs->vws, query->buf->hw_res);
 
-      if (wait)
-         vs->vws->resource_wait(vs->vws, query->buf->hw_res);
-      else if (vs->vws->resource_is_busy(vs->vws, query->buf->hw_res))
-         return false;
+      /* Newer hosts write the result back to the shared buffer as soon as the
+       * fenced VIRGL_CCMD_GET_QUERY_RESULT has run.  end_query resets the
+       * state, so seeing it done means the result is current and we can skip
+       * the flush and the busy check, each of which is a host round trip.
+       */
+      if (!host_state || host_state->query_state != VIRGL_QUERY_STATE_DONE) {
+         if (vs->vws->res_is_referenced(vs->vws, vctx->cbuf, query->buf->hw_res))
+            ctx->flush(ctx, NULL, 0);
 
-      host_state = vs->vws->resource_map(vs->vws, query->buf->hw_res);
+         if (wait)
+            vs->vws->resource_wait(vs->vws, query->buf->hw_res);
+         else if (vs->vws->resource_is_busy(vs->vws, query->buf->hw_res))
+            return false;
+
+         host_state = vs->vws->resource_map(vs->vws, query->buf->hw_res);
+      }
 
       /* The resource is idle and the result should be available at this point,
        * unless we are dealing with an older host.  In that case,
@@ -159,6 +159,44 @@ static bool transfers_intersect(struct virgl_transfer *queued,
          &current->base.box, true);
 }
 
+/* Texture transfers can only be merged when their union covers exactly the
+ * two boxes, i.e. they agree in all but one dimension and touch or overlap in
+ * that one. Anything larger would upload guest data the application never
+ * wrote, clobbering newer contents on the host side.
+ */
+static bool transfers_mergeable(struct virgl_transfer *queued,
+                                struct virgl_transfer *current)
+{
+   const struct pipe_box *a = &queued->base.box;
+   const struct pipe_box *b = &current->base.box;
+   int differing = 0;
+
+   if (queued->hw_res != current->hw_res ||
+       queued->base.level != current->base.level)
+      return false;
+
+   if (a->width <= 0 || a->height <= 0 || a->depth <= 0 ||
+       b->width <= 0 || b->height <= 0 || b->depth <= 0)
+      return false;
+
+   for (int dim = 0; dim < 3; dim++) {
+      int a_min, a_max, b_min, b_max;
+
+      box_min_max(a, dim, &a_min, &a_max);
+      box_min_max(b, dim, &b_min, &b_max);
+
+      if (a_min == b_min && a_max == b_max)
+         continue;
+
+      if (a_min > b_max || a_max < b_min)
+         return false;
+
+      differing++;
+   }
+
+   return differing <= 1;
+}
+
 static void remove_transfer(struct virgl_transfer_queue *queue,
                             struct virgl_transfer *queued)
 {
@@ -179,6 +217,26 @@ static void replace_unmapped_transfer(struct virgl_transfer_queue *queue,
    queue->num_dwords -= (VIRGL_TRANSFER3D_SIZE + 1);
 }
 
+static void merge_unmapped_texture_transfer(struct virgl_transfer_queue *queue,
+                                            struct list_action_args *args)
+{
+   struct virgl_transfer *current = args->current;
+   struct virgl_transfer *queued = args->queued;
+   const struct pipe_box *a = &queued->base.box;
+   const struct pipe_box *b = &current->base.box;
+
+   /* The boxes only differ in one dimension, so the one starting first there
+    * holds the backing offset of the merged origin.
+    */
+   if (a->x < b->x || a->y < b->y || a->z < b->z)
+      current->offset = queued->offset;
+
+   u_box_union_3d(&current->base.box, &current->base.box, &queued->base.box);
+
+   remove_transfer(queue, queued);
+   queue->num_dwords -= (VIRGL_TRANSFER3D_SIZE + 1);
+}
+
 static void transfer_put(struct virgl_transfer_queue *queue,
                          struct list_action_args *args)
 {
@@ -313,6 +371,13 @@ int virgl_transfer_queue_unmap(struct virgl_transfer_queue *queue,
       iter.compare = transfers_intersect;
       iter.action = replace_unmapped_transfer;
       compare_and_perform_action(queue, &iter);
+   } else {
+      /* Streaming uploads often write a texture in adjacent row bands. */
+      memset(&iter, 0, sizeof(iter));
+      iter.current = transfer;
+      iter.compare = transfers_mergeable;
+      iter.action = merge_unmapped_texture_transfer;
+      compare_and_perform_action(queue, &iter);
    }
 
    add_internal(queue, transfer);
@@ -22,6 +22,10 @@ batch_usage_unset(struct zink_batch_usage *u, enum zink_queue queue, uint32_t ba
    p_atomic_cmpxchg(&u->usage[queue], batch_id, 0);
 }
 
+/* The per-batch sets are emptied in one go after walking them: removing entries
+ * one at a time leaves tombstones behind, which make every later insertion into
+ * the reused set probe further and eventually force a rehash.
+ */
 void
 zink_batch_state_clear_resources(struct zink_screen *screen, struct zink_batch_state *bs)
 {
@@ -31,8 +35,8 @@ zink_batch_state_clear_resources(struct zink_screen *screen, struct zink_batch_s
       batch_usage_unset(&obj->reads, !!bs->is_compute, bs->batch_id);
       batch_usage_unset(&obj->writes, !!bs->is_compute, bs->batch_id);
       zink_resource_object_reference(screen, &obj, NULL);
-      _mesa_set_remove(bs->resources, entry);
    }
+   _mesa_set_clear(bs->resources, NULL);
 }
 
 void
@@ -45,21 +49,21 @@ zink_reset_batch_state(struct zink_context *ctx, struct zink_batch_state *bs)
    set_foreach(bs->active_queries, entry) {
       struct zink_query *query = (void*)entry->key;
       zink_prune_query(screen, query);
-      _mesa_set_remove(bs->active_queries, entry);
    }
+   _mesa_set_clear(bs->active_queries, NULL);
 
    set_foreach(bs->surfaces, entry) {
       struct zink_surface *surf = (struct zink_surface *)entry->key;
       batch_usage_unset(&surf->batch_uses, !!bs->is_compute, bs->batch_id);
       pipe_surface_reference((struct pipe_surface**)&surf, NULL);
-      _mesa_set_remove(bs->surfaces, entry);
    }
+   _mesa_set_clear(bs->surfaces, NULL);
    set_foreach(bs->bufferviews, entry) {
       struct zink_buffer_view *buffer_view = (struct zink_buffer_view *)entry->key;
       batch_usage_unset(&buffer_view->batch_uses, !!bs->is_compute, bs->batch_id);
       zink_buffer_view_reference(screen, &buffer_view, NULL);
-      _mesa_set_remove(bs->bufferviews, entry);
    }
+   _mesa_set_clear(bs->bufferviews, NULL);
 
    util_dynarray_foreach(&bs->zombie_samplers, VkSampler, samp) {
       vkDestroySampler(screen->dev, *samp, NULL);
@@ -75,8 +79,8 @@ zink_reset_batch_state(struct zink_context *ctx, struct zink_batch_state *bs)
        */
       pipe_reference(&zds->reference, NULL);
       zink_descriptor_set_recycle(zds);
-      _mesa_set_remove(bs->desc_sets, entry);
    }
+   _mesa_set_clear(bs->desc_sets, NULL);
 
    set_foreach(bs->programs, entry) {
       if (bs->is_compute) {
@@ -90,14 +94,14 @@ zink_reset_batch_state(struct zink_context *ctx, struct zink_batch_state *bs)
          if (zink_gfx_program_reference(screen, &prog, NULL) && in_use)
             ctx->curr_program = NULL;
       }
-      _mesa_set_remove(bs->programs, entry);
    }
+   _mesa_set_clear(bs->programs, NULL);
 
    set_foreach(bs->fbs, entry) {
       struct zink_framebuffer *fb = (void*)entry->key;
       zink_framebuffer_reference(screen, &fb, NULL);
-      _mesa_set_remove(bs->fbs, entry);
    }
+   _mesa_set_clear(bs->fbs, NULL);
 
    bs->flush_res = NULL;
 
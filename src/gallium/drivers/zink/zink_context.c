@@ -50,6 +50,7 @@
 
 #include "util/u_memory.h"
 #include "util/u_upload_mgr.h"
+#include "util/os_time.h"
 
 #define XXH_INLINE_ALL
 #include "util/xxhash.h"
@@ -1737,6 +1738,20 @@ zink_flush(struct pipe_context *pctx,
          ctx->dirty_so_targets = true;
    }
 
+   /* write new pipelines out periodically rather than only on screen
+    * destruction, so they survive apps which never tear the screen down;
+    * the disk write itself happens on the disk cache's own thread
+    */
+   if (flags & PIPE_FLUSH_END_OF_FRAME) {
+      struct zink_screen *screen = zink_screen(pctx->screen);
+      int64_t now = os_time_get_nano();
+      if (screen->pipeline_cache_dirty &&
+          now - screen->pipeline_cache_write_time >= ZINK_PIPELINE_CACHE_WRITE_INTERVAL) {
+         zink_screen_update_pipeline_cache(screen);
+         screen->pipeline_cache_write_time = now;
+      }
+   }
+
    if (!pfence)
       return;
    if (deferred && !batch->has_work) {
@@ -121,6 +121,31 @@ descriptor_pool_create(struct zink_screen *screen, enum zink_descriptor_type typ
       goto fail;
    }
 
+   if (screen->info.have_KHR_descriptor_update_template &&
+       (type == ZINK_DESCRIPTOR_TYPE_UBO || type == ZINK_DESCRIPTOR_TYPE_SSBO)) {
+      /* buffer descriptors are written from a packed VkDescriptorBufferInfo array
+       * in binding order, so a single template covers every set in this pool
+       */
+      VkDescriptorUpdateTemplateEntry entries[num_bindings];
+      for (unsigned i = 0; i < num_bindings; i++) {
+         entries[i].dstBinding = bindings[i].binding;
+         entries[i].dstArrayElement = 0;
+         entries[i].descriptorCount = bindings[i].descriptorCount;
+         entries[i].descriptorType = bindings[i].descriptorType;
+         entries[i].offset = i * sizeof(VkDescriptorBufferInfo);
+         entries[i].stride = sizeof(VkDescriptorBufferInfo);
+      }
+
+      VkDescriptorUpdateTemplateCreateInfo dutci = {};
+      dutci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+      dutci.descriptorUpdateEntryCount = num_bindings;
+      dutci.pDescriptorUpdateEntries = entries;
+      dutci.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+      dutci.descriptorSetLayout = pool->dsl;
+      if (screen->vk_CreateDescriptorUpdateTemplate(screen->dev, &dutci, NULL, &pool->templ) != VK_SUCCESS)
+         pool->templ = VK_NULL_HANDLE;
+   }
+
    VkDescriptorPoolCreateInfo dpci = {};
    dpci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
    dpci.pPoolSizes = sizes;
@@ -633,6 +658,8 @@ zink_descriptor_pool_free(struct zink_screen *screen, struct zink_descriptor_poo
 {
    if (!pool)
       return;
+   if (pool->templ)
+      screen->vk_DestroyDescriptorUpdateTemplate(screen->dev, pool->templ, NULL);
    if (pool->dsl)
       vkDestroyDescriptorSetLayout(screen->dev, pool->dsl, NULL);
    if (pool->descpool)
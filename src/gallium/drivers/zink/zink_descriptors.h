@@ -81,6 +81,8 @@ struct zink_descriptor_pool {
    struct util_dynarray alloc_desc_sets;
    VkDescriptorPool descpool;
    VkDescriptorSetLayout dsl;
+   /* buffer descriptor types only: writes one VkDescriptorBufferInfo per binding */
+   VkDescriptorUpdateTemplate templ;
    struct zink_descriptor_pool_key key;
    unsigned num_resources;
    unsigned num_sets_allocated;
@@ -71,6 +71,7 @@ EXTENSIONS = [
         alias="driver",
         properties=True),
     Extension("VK_KHR_draw_indirect_count"),
+    Extension("VK_KHR_descriptor_update_template"),
     Extension("VK_KHR_shader_draw_parameters"),
     Extension("VK_EXT_conditional_rendering",
         alias="cond_render", 
@@ -339,7 +339,7 @@ cmp_dynamic_offset_binding(const void *a, const void *b)
 
 static bool
 write_descriptors(struct zink_context *ctx, struct zink_descriptor_set *zds, unsigned num_wds, VkWriteDescriptorSet *wds,
-                 bool is_compute, bool cache_hit, bool need_resource_refs)
+                 const VkDescriptorBufferInfo *buffer_infos, bool is_compute, bool cache_hit, bool need_resource_refs)
 {
    bool need_flush = false;
    struct zink_batch *batch = is_compute ? zink_batch_c(ctx) : zink_batch_g(ctx);
@@ -347,8 +347,13 @@ write_descriptors(struct zink_context *ctx, struct zink_descriptor_set *zds, uns
    assert(zds->desc_set);
    enum zink_queue check_flush_id = is_compute ? ZINK_QUEUE_GFX : ZINK_QUEUE_COMPUTE;
 
-   if (!cache_hit && num_wds)
-      vkUpdateDescriptorSets(screen->dev, num_wds, wds, 0, NULL);
+   if (!cache_hit && num_wds) {
+      if (buffer_infos && zds->pool->templ) {
+         assert(num_wds == zds->pool->key.num_descriptors);
+         screen->vk_UpdateDescriptorSetWithTemplate(screen->dev, zds->desc_set, zds->pool->templ, buffer_infos);
+      } else
+         vkUpdateDescriptorSets(screen->dev, num_wds, wds, 0, NULL);
+   }
 
    for (int i = 0; zds->pool->key.num_descriptors && i < util_dynarray_num_elements(&zds->barriers, struct zink_descriptor_barrier); ++i) {
       struct zink_descriptor_barrier *barrier = util_dynarray_element(&zds->barriers, struct zink_descriptor_barrier, i);
@@ -457,7 +462,7 @@ update_ubo_descriptors(struct zink_context *ctx, struct zink_descriptor_set *zds
       dynamic_offsets[i] = dynamic_buffers[i].offset;
    *dynamic_offset_idx = dynamic_offset_count;
 
-   return write_descriptors(ctx, zds, num_wds, wds, is_compute, cache_hit, need_resource_refs);
+   return write_descriptors(ctx, zds, num_wds, wds, buffer_infos, is_compute, cache_hit, need_resource_refs);
 }
 
 static bool
@@ -523,7 +528,7 @@ update_ssbo_descriptors(struct zink_context *ctx, struct zink_descriptor_set *zd
       }
    }
    _mesa_set_destroy(ht, NULL);
-   return write_descriptors(ctx, zds, num_wds, wds, is_compute, cache_hit, need_resource_refs);
+   return write_descriptors(ctx, zds, num_wds, wds, buffer_infos, is_compute, cache_hit, need_resource_refs);
 }
 
 static void
@@ -657,7 +662,7 @@ update_sampler_descriptors(struct zink_context *ctx, struct zink_descriptor_set
       }
    }
    _mesa_set_destroy(ht, NULL);
-   return write_descriptors(ctx, zds, num_wds, wds, is_compute, cache_hit, need_resource_refs);
+   return write_descriptors(ctx, zds, num_wds, wds, NULL, is_compute, cache_hit, need_resource_refs);
 }
 
 static bool
@@ -744,7 +749,7 @@ update_image_descriptors(struct zink_context *ctx, struct zink_descriptor_set *z
       }
    }
    _mesa_set_destroy(ht, NULL);
-   return write_descriptors(ctx, zds, num_wds, wds, is_compute, cache_hit, need_resource_refs);
+   return write_descriptors(ctx, zds, num_wds, wds, NULL, is_compute, cache_hit, need_resource_refs);
 }
 
 static void
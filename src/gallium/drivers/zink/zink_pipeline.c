@@ -195,6 +195,7 @@ zink_create_gfx_pipeline(struct zink_screen *screen,
       debug_printf("vkCreateGraphicsPipelines failed\n");
       return VK_NULL_HANDLE;
    }
+   screen->pipeline_cache_dirty = true;
 
    return pipeline;
 }
@@ -237,6 +238,7 @@ zink_create_compute_pipeline(struct zink_screen *screen, struct zink_compute_pro
       debug_printf("vkCreateComputePipelines failed\n");
       return VK_NULL_HANDLE;
    }
+   screen->pipeline_cache_dirty = true;
 
    return pipeline;
 }
@@ -114,7 +114,15 @@ disk_cache_init(struct zink_screen *screen)
    static char buf[1000];
    snprintf(buf, sizeof(buf), "zink_%x04x", screen->info.props.vendorID);
 
-   screen->disk_cache = disk_cache_create(buf, screen->info.props.deviceName, 0);
+   /* The Vulkan driver rejects pipeline cache data with a different UUID,
+    * so make it part of the cache identity to avoid loading stale blobs
+    * after a driver update.
+    */
+   char uuid[VK_UUID_SIZE * 2 + 1];
+   disk_cache_format_hex_id(uuid, screen->info.props.pipelineCacheUUID,
+                            VK_UUID_SIZE * 2);
+
+   screen->disk_cache = disk_cache_create(buf, uuid, 0);
    if (screen->disk_cache)
       disk_cache_compute_key(screen->disk_cache, buf, strlen(buf), screen->disk_cache_key);
 #endif
@@ -127,6 +135,7 @@ zink_screen_update_pipeline_cache(struct zink_screen *screen)
 
    if (!screen->disk_cache)
       return;
+   screen->pipeline_cache_dirty = false;
    if (vkGetPipelineCacheData(screen->dev, screen->pipeline_cache, &size, NULL) != VK_SUCCESS)
       return;
    if (screen->pipeline_cache_size == size)
@@ -1083,6 +1092,12 @@ load_device_extensions(struct zink_screen *screen)
       GET_PROC_ADDR_KHR(CmdDrawIndirectCount);
    }
 
+   if (screen->info.have_KHR_descriptor_update_template) {
+      GET_PROC_ADDR_KHR(CreateDescriptorUpdateTemplate);
+      GET_PROC_ADDR_KHR(DestroyDescriptorUpdateTemplate);
+      GET_PROC_ADDR_KHR(UpdateDescriptorSetWithTemplate);
+   }
+
    if (screen->info.have_EXT_calibrated_timestamps) {
       GET_PROC_ADDR_INSTANCE(GetPhysicalDeviceCalibrateableTimeDomainsEXT);
       GET_PROC_ADDR(GetCalibratedTimestampsEXT);
@@ -49,6 +49,9 @@ struct hash_table;
 #define ZINK_DEBUG_TGSI 0x4
 #define ZINK_DEBUG_VALIDATION 0x8
 
+/* minimum time between periodic pipeline cache writes, in ns */
+#define ZINK_PIPELINE_CACHE_WRITE_INTERVAL (5ll * 1000 * 1000 * 1000)
+
 struct zink_screen {
    struct pipe_screen base;
 
@@ -62,6 +65,9 @@ struct zink_screen {
    struct slab_parent_pool transfer_pool;
    VkPipelineCache pipeline_cache;
    size_t pipeline_cache_size;
+   /* pipelines were created since the cache was last written to disk */
+   bool pipeline_cache_dirty;
+   int64_t pipeline_cache_write_time;
    struct disk_cache *disk_cache;
    cache_key disk_cache_key;
 
@@ -101,6 +107,10 @@ struct zink_screen {
    PFN_vkCmdDrawIndirectCount vk_CmdDrawIndirectCount;
    PFN_vkCmdDrawIndexedIndirectCount vk_CmdDrawIndexedIndirectCount;
 
+   PFN_vkCreateDescriptorUpdateTemplate vk_CreateDescriptorUpdateTemplate;
+   PFN_vkDestroyDescriptorUpdateTemplate vk_DestroyDescriptorUpdateTemplate;
+   PFN_vkUpdateDescriptorSetWithTemplate vk_UpdateDescriptorSetWithTemplate;
+
    PFN_vkGetMemoryFdKHR vk_GetMemoryFdKHR;
    PFN_vkCmdBeginConditionalRenderingEXT vk_CmdBeginConditionalRenderingEXT;
    PFN_vkCmdEndConditionalRenderingEXT vk_CmdEndConditionalRenderingEXT;
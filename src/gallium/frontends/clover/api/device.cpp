@@ -314,7 +314,8 @@ clGetDeviceInfo(cl_device_id d_dev, cl_device_info param,
       break;
 
    case CL_DEVICE_QUEUE_PROPERTIES:
-      buf.as_scalar<cl_command_queue_properties>() = CL_QUEUE_PROFILING_ENABLE;
+      buf.as_scalar<cl_command_queue_properties>() = CL_QUEUE_PROFILING_ENABLE |
+                                                     CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
       break;
 
    case CL_DEVICE_BUILT_IN_KERNELS:
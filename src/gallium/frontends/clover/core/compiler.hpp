@@ -29,8 +29,23 @@
 #include "nir/invocation.hpp"
 #include "spirv/invocation.hpp"
 
+#include <sstream>
+
 namespace clover {
    namespace compiler {
+      ///
+      /// Build the disk cache id of a compiler invocation.  The inputs
+      /// are appended separately by the caller.
+      ///
+      static inline std::string
+      cache_id(const device &dev, const std::string &stage,
+               const std::string &opts) {
+         std::ostringstream os;
+         os << stage << '\0' << dev.device_name() << '\0'
+            << dev.address_bits() << '\0' << opts << '\0';
+         return os.str();
+      }
+
       static inline module
       compile_program(const program &prog, const header_map &headers,
                       const device &dev, const std::string &opts,
@@ -39,8 +54,19 @@ namespace clover {
 #ifdef HAVE_CLOVER_SPIRV
          case PIPE_SHADER_IR_NIR_SERIALIZED:
             switch (prog.il_type()) {
-            case program::il_type::source:
-               return llvm::compile_to_spirv(prog.source(), headers, dev, opts, log);
+            case program::il_type::source: {
+               std::string id = cache_id(dev, "compile", opts) + prog.source();
+               for (auto &h : headers)
+                  id += '\0' + h.first + '\0' + h.second;
+
+               module m;
+               if (nir::get_cached_module(dev, id, m))
+                  return m;
+
+               m = llvm::compile_to_spirv(prog.source(), headers, dev, opts, log);
+               nir::put_cached_module(dev, id, m);
+               return m;
+            }
             case program::il_type::spirv:
                return spirv::compile_program(prog.source(), dev, log);
             default:
@@ -63,9 +89,22 @@ namespace clover {
       link_program(const std::vector<module> &ms, const device &dev,
                    const std::string &opts, std::string &log) {
          switch (dev.ir_format()) {
-         case PIPE_SHADER_IR_NIR_SERIALIZED:
-            return nir::spirv_to_nir(spirv::link_program(ms, dev, opts, log),
-                                     dev, log);
+         case PIPE_SHADER_IR_NIR_SERIALIZED: {
+            std::ostringstream os;
+            os << cache_id(dev, "link", opts);
+            for (auto &m : ms)
+               m.serialize(os);
+
+            const std::string id = os.str();
+            module m;
+            if (nir::get_cached_module(dev, id, m))
+               return m;
+
+            m = nir::spirv_to_nir(spirv::link_program(ms, dev, opts, log),
+                                  dev, log);
+            nir::put_cached_module(dev, id, m);
+            return m;
+         }
          case PIPE_SHADER_IR_NATIVE:
             return llvm::link_program(ms, dev, opts, log);
          default:
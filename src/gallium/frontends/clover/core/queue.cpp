@@ -103,10 +103,17 @@ command_queue::flush_unlocked() {
    if (!queued_events.empty()) {
       pipe->flush(pipe, &fence, 0);
 
-      while (!queued_events.empty() &&
-             queued_events.front()().signalled()) {
-         queued_events.front()().fence(fence);
-         queued_events.pop_front();
+      // On an out-of-order queue a blocked event doesn't hold back the
+      // ones queued after it, so look past it.
+      for (auto it = queued_events.begin(); it != queued_events.end();) {
+         if ((*it)().signalled()) {
+            (*it)().fence(fence);
+            it = queued_events.erase(it);
+         } else if (out_of_order()) {
+            ++it;
+         } else {
+            break;
+         }
       }
 
       screen->fence_reference(screen, &fence, NULL);
@@ -141,11 +148,42 @@ command_queue::profiling_enabled() const {
    return _props & CL_QUEUE_PROFILING_ENABLE;
 }
 
+bool
+command_queue::out_of_order() const {
+   return _props & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+}
+
+namespace {
+   bool
+   is_barrier(const hard_event &ev) {
+      return ev.command() == CL_COMMAND_MARKER ||
+             ev.command() == CL_COMMAND_BARRIER;
+   }
+}
+
 void
 command_queue::sequence(hard_event &ev) {
    std::lock_guard<std::mutex> lock(queued_events_mutex);
-   if (!queued_events.empty())
-      queued_events.back()().chain(ev);
+
+   if (!out_of_order()) {
+      if (!queued_events.empty())
+         queued_events.back()().chain(ev);
+
+   } else if (is_barrier(ev)) {
+      // Markers and barriers wait for everything enqueued before them.
+      for (hard_event &qev : queued_events)
+         qev.chain(ev);
+
+   } else {
+      // Other commands only have to wait for the last marker or barrier,
+      // so a command blocked on its wait list doesn't stall the rest.
+      for (auto it = queued_events.rbegin(); it != queued_events.rend(); ++it) {
+         if (is_barrier((*it)())) {
+            (*it)().chain(ev);
+            break;
+         }
+      }
+   }
 
    queued_events.push_back(ev);
 
@@ -56,6 +56,7 @@ namespace clover {
 
       std::vector<cl_queue_properties> properties() const;
       bool profiling_enabled() const;
+      bool out_of_order() const;
 
       const intrusive_ref<clover::context> context;
       const intrusive_ref<clover::device> device;
@@ -49,7 +49,7 @@ namespace {
 }
 
 resource::resource(clover::device &dev, memory_obj &obj) :
-   device(dev), obj(obj), pipe(NULL), offset() {
+   device(dev), obj(obj), pipe(NULL), offset(), user_ptr(NULL) {
 }
 
 resource::~resource() {
@@ -180,12 +180,22 @@ root_resource::root_resource(clover::device &dev, memory_obj &obj,
       // Page alignment is normally required for this, just try, hope for the
       // best and fall back if it fails.
       pipe = dev.pipe->resource_from_user_memory(dev.pipe, &info, obj.host_ptr());
-      if (pipe)
+      if (pipe) {
+         user_ptr = static_cast<char *>(obj.host_ptr());
          return;
+      }
    }
 
    if (obj.flags() & (CL_MEM_ALLOC_HOST_PTR | CL_MEM_USE_HOST_PTR)) {
       info.usage = PIPE_USAGE_STAGING;
+
+      // Allow mapping host accessible buffers persistently, so drivers
+      // hand out a pointer to the storage itself instead of staging
+      // every map through a temporary copy.
+      if (info.target == PIPE_BUFFER &&
+          dev.pipe->get_param(dev.pipe, PIPE_CAP_BUFFER_MAP_PERSISTENT_COHERENT))
+         info.flags = (PIPE_RESOURCE_FLAG_MAP_PERSISTENT |
+                       PIPE_RESOURCE_FLAG_MAP_COHERENT);
    }
 
    pipe = dev.pipe->resource_create(dev.pipe, &info);
@@ -220,6 +230,7 @@ sub_resource::sub_resource(resource &r, const vector &offset) :
    resource(r.device(), r.obj) {
    this->pipe = r.pipe;
    this->offset = r.offset + offset;
+   this->user_ptr = r.user_ptr;
 }
 
 mapping::mapping(command_queue &q, resource &r,
@@ -233,6 +244,29 @@ mapping::mapping(command_queue &q, resource &r,
                       PIPE_MAP_DISCARD_RANGE : 0) |
                      (!blocking ? PIPE_MAP_UNSYNCHRONIZED : 0));
 
+   if (r.user_ptr && r.pipe->target == PIPE_BUFFER) {
+      // The buffer lives in application memory, hand it out directly
+      // after waiting for the device to be done with it if requested.
+      if (blocking) {
+         pipe_screen *screen = r.pipe->screen;
+         pipe_fence_handle *fence = NULL;
+
+         pctx->flush(pctx, &fence, 0);
+         if (fence) {
+            screen->fence_finish(screen, NULL, fence, PIPE_TIMEOUT_INFINITE);
+            screen->fence_reference(screen, &fence, NULL);
+         }
+      }
+
+      pxfer = NULL;
+      p = r.user_ptr + (origin + r.offset)[0];
+      pipe_resource_reference(&pres, r.pipe);
+      return;
+   }
+
+   if (r.pipe->flags & PIPE_RESOURCE_FLAG_MAP_PERSISTENT)
+      usage |= PIPE_MAP_PERSISTENT | PIPE_MAP_COHERENT;
+
    p = pctx->transfer_map(pctx, r.pipe, 0, usage,
                           box(origin + r.offset, region), &pxfer);
    if (!p) {
@@ -80,6 +80,9 @@ namespace clover {
       pipe_resource *pipe;
       vector offset;
 
+      // Host memory the pipe resource is backed by directly, if any.
+      char *user_ptr;
+
    private:
       std::list<mapping> maps;
    };
@@ -22,6 +22,7 @@
 
 #include "invocation.hpp"
 
+#include <sstream>
 #include <tuple>
 
 #include "core/device.hpp"
@@ -588,10 +589,60 @@ module clover::nir::spirv_to_nir(const module &mod, const device &dev,
    }
    return m;
 }
+bool clover::nir::get_cached_module(const device &dev, const std::string &id,
+                                    module &m)
+{
+   if (!dev.clc_cache)
+      return false;
+
+   cache_key key;
+   disk_cache_compute_key(dev.clc_cache, id.data(), id.size(), key);
+
+   size_t size;
+   void *data = disk_cache_get(dev.clc_cache, key, &size);
+   if (!data)
+      return false;
+
+   std::istringstream is(std::string(static_cast<char *>(data), size));
+   free(data);
+
+   try {
+      m = module::deserialize(is);
+   } catch (...) {
+      return false;
+   }
+   return true;
+}
+
+void clover::nir::put_cached_module(const device &dev, const std::string &id,
+                                    const module &m)
+{
+   if (!dev.clc_cache)
+      return;
+
+   cache_key key;
+   disk_cache_compute_key(dev.clc_cache, id.data(), id.size(), key);
+
+   std::ostringstream os;
+   m.serialize(os);
+   const std::string data = os.str();
+   disk_cache_put(dev.clc_cache, key, data.data(), data.size(), NULL);
+}
 #else
 module clover::nir::spirv_to_nir(const module &mod, const device &dev, std::string &r_log)
 {
    r_log += "SPIR-V support in clover is not enabled.\n";
    throw error(CL_LINKER_NOT_AVAILABLE);
 }
+
+bool clover::nir::get_cached_module(const device &dev, const std::string &id,
+                                    module &m)
+{
+   return false;
+}
+
+void clover::nir::put_cached_module(const device &dev, const std::string &id,
+                                    const module &m)
+{
+}
 #endif
@@ -40,6 +40,15 @@ namespace clover {
 
       // converts a given spirv module to nir
       module spirv_to_nir(const module &mod, const device &dev, std::string &r_log);
+
+      // looks up a module previously stored under the given id in the
+      // device's disk cache, returns false on a miss
+      bool get_cached_module(const device &dev, const std::string &id,
+                             module &m);
+
+      // stores a module under the given id in the device's disk cache
+      void put_cached_module(const device &dev, const std::string &id,
+                             const module &m);
    }
 }
 
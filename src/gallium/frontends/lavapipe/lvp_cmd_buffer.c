@@ -23,6 +23,20 @@
 
 #include "lvp_private.h"
 #include "pipe/p_context.h"
+#include "util/u_math.h"
+
+/* Commands are recorded into chunks of this size, which are recycled
+ * through the command pool.  Commands that don't fit get a chunk of
+ * their own.
+ */
+#define LVP_CMD_CHUNK_SIZE (16 * 1024)
+
+struct lvp_cmd_chunk {
+   struct list_head link;
+   uint32_t size;
+   uint32_t used;
+   uint64_t data[0];
+};
 
 static VkResult lvp_create_cmd_buffer(
    struct lvp_device *                         device,
@@ -43,6 +57,7 @@ static VkResult lvp_create_cmd_buffer(
    cmd_buffer->pool = pool;
    list_inithead(&cmd_buffer->cmds);
    cmd_buffer->last_emit = &cmd_buffer->cmds;
+   list_inithead(&cmd_buffer->cmd_chunks);
    cmd_buffer->status = LVP_CMD_BUFFER_STATUS_INITIAL;
    if (pool) {
       list_addtail(&cmd_buffer->pool_link, &pool->cmd_buffers);
@@ -60,10 +75,27 @@ static VkResult lvp_create_cmd_buffer(
 static void
 lvp_cmd_buffer_free_all_cmds(struct lvp_cmd_buffer *cmd_buffer)
 {
-   struct lvp_cmd_buffer_entry *tmp, *cmd;
-   LIST_FOR_EACH_ENTRY_SAFE(cmd, tmp, &cmd_buffer->cmds, cmd_link) {
-      list_del(&cmd->cmd_link);
-      vk_free(&cmd_buffer->pool->alloc, cmd);
+   struct lvp_cmd_pool *pool = cmd_buffer->pool;
+
+   /* hand the regular sized chunks back to the pool for reuse */
+   list_for_each_entry_safe(struct lvp_cmd_chunk, chunk,
+                            &cmd_buffer->cmd_chunks, link) {
+      list_del(&chunk->link);
+      if (chunk->size == LVP_CMD_CHUNK_SIZE)
+         list_add(&chunk->link, &pool->free_cmd_chunks);
+      else
+         vk_free(&pool->alloc, chunk);
+   }
+   list_inithead(&cmd_buffer->cmds);
+}
+
+static void
+lvp_cmd_pool_free_chunks(struct lvp_cmd_pool *pool)
+{
+   list_for_each_entry_safe(struct lvp_cmd_chunk, chunk,
+                            &pool->free_cmd_chunks, link) {
+      list_del(&chunk->link);
+      vk_free(&pool->alloc, chunk);
    }
 }
 
@@ -201,6 +233,7 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_CreateCommandPool(
 
    list_inithead(&pool->cmd_buffers);
    list_inithead(&pool->free_cmd_buffers);
+   list_inithead(&pool->free_cmd_chunks);
 
    *pCmdPool = lvp_cmd_pool_to_handle(pool);
 
@@ -228,6 +261,8 @@ VKAPI_ATTR void VKAPI_CALL lvp_DestroyCommandPool(
       lvp_cmd_buffer_destroy(cmd_buffer);
    }
 
+   lvp_cmd_pool_free_chunks(pool);
+
    vk_object_base_finish(&pool->base);
    vk_free2(&device->vk.alloc, pAllocator, pool);
 }
@@ -263,6 +298,133 @@ VKAPI_ATTR void VKAPI_CALL lvp_TrimCommandPool(
                             &pool->free_cmd_buffers, pool_link) {
       lvp_cmd_buffer_destroy(cmd_buffer);
    }
+
+   lvp_cmd_pool_free_chunks(pool);
+}
+
+#define CMD_SIZE(type, member) \
+   [LVP_CMD_##type] = sizeof(((struct lvp_cmd_buffer_entry *)0)->u.member)
+#define CMD_SIZE_UPTO(type, member, field) \
+   [LVP_CMD_##type] = offsetof(struct lvp_cmd_##member, field)
+
+/* Size of the part of lvp_cmd_buffer_entry::u each command uses */
+static const uint16_t lvp_cmd_size[] = {
+   CMD_SIZE(BIND_PIPELINE, pipeline),
+   CMD_SIZE_UPTO(SET_VIEWPORT, set_viewport, viewports),
+   CMD_SIZE_UPTO(SET_SCISSOR, set_scissor, scissors),
+   CMD_SIZE(SET_LINE_WIDTH, set_line_width),
+   CMD_SIZE(SET_DEPTH_BIAS, set_depth_bias),
+   CMD_SIZE(SET_BLEND_CONSTANTS, set_blend_constants),
+   CMD_SIZE(SET_DEPTH_BOUNDS, set_depth_bounds),
+   CMD_SIZE(SET_STENCIL_COMPARE_MASK, stencil_vals),
+   CMD_SIZE(SET_STENCIL_WRITE_MASK, stencil_vals),
+   CMD_SIZE(SET_STENCIL_REFERENCE, stencil_vals),
+   CMD_SIZE(BIND_DESCRIPTOR_SETS, descriptor_sets),
+   CMD_SIZE(BIND_INDEX_BUFFER, index_buffer),
+   CMD_SIZE(BIND_VERTEX_BUFFERS, vertex_buffers),
+   CMD_SIZE(DRAW, draw),
+   CMD_SIZE(DRAW_INDEXED, draw_indexed),
+   CMD_SIZE(DRAW_INDIRECT, draw_indirect),
+   CMD_SIZE(DRAW_INDEXED_INDIRECT, draw_indirect),
+   CMD_SIZE(DISPATCH, dispatch),
+   CMD_SIZE(DISPATCH_INDIRECT, dispatch_indirect),
+   CMD_SIZE(COPY_BUFFER, copy_buffer),
+   CMD_SIZE(COPY_IMAGE, copy_image),
+   CMD_SIZE(BLIT_IMAGE, blit_image),
+   CMD_SIZE(COPY_BUFFER_TO_IMAGE, buffer_to_img),
+   CMD_SIZE(COPY_IMAGE_TO_BUFFER, img_to_buffer),
+   CMD_SIZE(UPDATE_BUFFER, update_buffer),
+   CMD_SIZE(FILL_BUFFER, fill_buffer),
+   CMD_SIZE(CLEAR_COLOR_IMAGE, clear_color_image),
+   CMD_SIZE(CLEAR_DEPTH_STENCIL_IMAGE, clear_ds_image),
+   CMD_SIZE(CLEAR_ATTACHMENTS, clear_attachments),
+   CMD_SIZE(RESOLVE_IMAGE, resolve_image),
+   CMD_SIZE(SET_EVENT, event_set),
+   CMD_SIZE(RESET_EVENT, event_set),
+   CMD_SIZE(WAIT_EVENTS, wait_events),
+   CMD_SIZE(PIPELINE_BARRIER, pipeline_barrier),
+   CMD_SIZE(BEGIN_QUERY, query),
+   CMD_SIZE(END_QUERY, query),
+   CMD_SIZE(RESET_QUERY_POOL, query),
+   CMD_SIZE(WRITE_TIMESTAMP, query),
+   CMD_SIZE(COPY_QUERY_POOL_RESULTS, copy_query_pool_results),
+   CMD_SIZE(PUSH_CONSTANTS, push_constants),
+   CMD_SIZE(BEGIN_RENDER_PASS, begin_render_pass),
+   CMD_SIZE(NEXT_SUBPASS, next_subpass),
+   [LVP_CMD_END_RENDER_PASS] = 0,
+   CMD_SIZE(EXECUTE_COMMANDS, execute_commands),
+   CMD_SIZE(DRAW_INDIRECT_COUNT, draw_indirect_count),
+   CMD_SIZE(DRAW_INDEXED_INDIRECT_COUNT, draw_indirect_count),
+   CMD_SIZE(PUSH_DESCRIPTOR_SET, push_descriptor_set),
+   CMD_SIZE(BIND_TRANSFORM_FEEDBACK_BUFFERS, bind_transform_feedback_buffers),
+   CMD_SIZE(BEGIN_TRANSFORM_FEEDBACK, begin_transform_feedback),
+   CMD_SIZE(END_TRANSFORM_FEEDBACK, begin_transform_feedback),
+   CMD_SIZE(DRAW_INDIRECT_BYTE_COUNT, draw_indirect_byte_count),
+   CMD_SIZE(BEGIN_CONDITIONAL_RENDERING, begin_conditional_rendering),
+   [LVP_CMD_END_CONDITIONAL_RENDERING] = 0,
+   CMD_SIZE(SET_CULL_MODE, set_cull_mode),
+   CMD_SIZE(SET_FRONT_FACE, set_front_face),
+   CMD_SIZE(SET_PRIMITIVE_TOPOLOGY, set_primitive_topology),
+   CMD_SIZE(SET_DEPTH_TEST_ENABLE, set_depth_test_enable),
+   CMD_SIZE(SET_DEPTH_WRITE_ENABLE, set_depth_write_enable),
+   CMD_SIZE(SET_DEPTH_COMPARE_OP, set_depth_compare_op),
+   CMD_SIZE(SET_DEPTH_BOUNDS_TEST_ENABLE, set_depth_bounds_test_enable),
+   CMD_SIZE(SET_STENCIL_TEST_ENABLE, set_stencil_test_enable),
+   CMD_SIZE(SET_STENCIL_OP, set_stencil_op),
+};
+
+#undef CMD_SIZE
+#undef CMD_SIZE_UPTO
+
+static inline uint32_t
+cmd_buf_entry_size(enum lvp_cmds type)
+{
+   assert(type < ARRAY_SIZE(lvp_cmd_size));
+   return ALIGN_POT(offsetof(struct lvp_cmd_buffer_entry, u) +
+                    lvp_cmd_size[type], 8);
+}
+
+/* The extra data allocated along with a command */
+static inline void *
+cmd_buf_entry_extra(struct lvp_cmd_buffer_entry *cmd)
+{
+   return (uint8_t *)cmd + cmd_buf_entry_size(cmd->cmd_type);
+}
+
+static void *cmd_buf_chunk_alloc(struct lvp_cmd_buffer *cmd_buffer,
+                                 uint32_t size)
+{
+   struct lvp_cmd_pool *pool = cmd_buffer->pool;
+   struct lvp_cmd_chunk *chunk;
+   void *ptr;
+
+   size = ALIGN_POT(size, 8);
+
+   if (!list_is_empty(&cmd_buffer->cmd_chunks)) {
+      chunk = list_last_entry(&cmd_buffer->cmd_chunks, struct lvp_cmd_chunk, link);
+      if (chunk->size - chunk->used >= size)
+         goto out;
+   }
+
+   if (size <= LVP_CMD_CHUNK_SIZE && !list_is_empty(&pool->free_cmd_chunks)) {
+      chunk = list_first_entry(&pool->free_cmd_chunks, struct lvp_cmd_chunk, link);
+      list_del(&chunk->link);
+   } else {
+      uint32_t chunk_size = MAX2(size, LVP_CMD_CHUNK_SIZE);
+
+      chunk = vk_alloc(&pool->alloc, sizeof(*chunk) + chunk_size,
+                       8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+      if (!chunk)
+         return NULL;
+      chunk->size = chunk_size;
+   }
+   chunk->used = 0;
+   list_addtail(&chunk->link, &cmd_buffer->cmd_chunks);
+
+out:
+   ptr = (uint8_t *)chunk->data + chunk->used;
+   chunk->used += size;
+   return ptr;
 }
 
 static struct lvp_cmd_buffer_entry *cmd_buf_entry_alloc_size(struct lvp_cmd_buffer *cmd_buffer,
@@ -270,10 +432,8 @@ static struct lvp_cmd_buffer_entry *cmd_buf_entry_alloc_size(struct lvp_cmd_buff
                                                              enum lvp_cmds type)
 {
    struct lvp_cmd_buffer_entry *cmd;
-   uint32_t cmd_size = sizeof(*cmd) + extra_size;
-   cmd = vk_alloc(&cmd_buffer->pool->alloc,
-                  cmd_size,
-                  8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+   uint32_t cmd_size = cmd_buf_entry_size(type) + extra_size;
+   cmd = cmd_buf_chunk_alloc(cmd_buffer, cmd_size);
    if (!cmd)
       return NULL;
 
@@ -363,7 +523,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdBeginRenderPass(
    cmd->u.begin_render_pass.framebuffer = framebuffer;
    cmd->u.begin_render_pass.render_area = pRenderPassBegin->renderArea;
 
-   cmd->u.begin_render_pass.attachments = (struct lvp_attachment_state *)(cmd + 1);
+   cmd->u.begin_render_pass.attachments = (struct lvp_attachment_state *)cmd_buf_entry_extra(cmd);
    state_setup_attachments(cmd->u.begin_render_pass.attachments, pass, pRenderPassBegin->pClearValues);
 
    cmd_buf_queue(cmd_buffer, cmd);
@@ -423,7 +583,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdBindVertexBuffers(
    cmd->u.vertex_buffers.first = firstBinding;
    cmd->u.vertex_buffers.binding_count = bindingCount;
 
-   buffers = (struct lvp_buffer **)(cmd + 1);
+   buffers = (struct lvp_buffer **)cmd_buf_entry_extra(cmd);
    offsets = (VkDeviceSize *)(buffers + bindingCount);
    for (i = 0; i < bindingCount; i++) {
       buffers[i] = lvp_buffer_from_handle(pBuffers[i]);
@@ -483,7 +643,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdBindDescriptorSets(
 
    for (i = 0; i < layout->num_sets; i++)
       cmd->u.descriptor_sets.set_layout[i] = layout->set[i].layout;
-   sets = (struct lvp_descriptor_set **)(cmd + 1);
+   sets = (struct lvp_descriptor_set **)cmd_buf_entry_extra(cmd);
    for (i = 0; i < descriptorSetCount; i++) {
 
       sets[i] = lvp_descriptor_set_from_handle(pDescriptorSets[i]);
@@ -551,7 +711,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdSetViewport(
    struct lvp_cmd_buffer_entry *cmd;
    int i;
 
-   cmd = cmd_buf_entry_alloc(cmd_buffer, LVP_CMD_SET_VIEWPORT);
+   cmd = cmd_buf_entry_alloc_size(cmd_buffer, viewportCount * sizeof(VkViewport), LVP_CMD_SET_VIEWPORT);
    if (!cmd)
       return;
 
@@ -573,7 +733,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdSetScissor(
    struct lvp_cmd_buffer_entry *cmd;
    int i;
 
-   cmd = cmd_buf_entry_alloc(cmd_buffer, LVP_CMD_SET_SCISSOR);
+   cmd = cmd_buf_entry_alloc_size(cmd_buffer, scissorCount * sizeof(VkRect2D), LVP_CMD_SET_SCISSOR);
    if (!cmd)
       return;
 
@@ -952,7 +1112,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdWaitEvents(VkCommandBuffer commandBuffer,
    cmd->u.wait_events.src_stage_mask = srcStageMask;
    cmd->u.wait_events.dst_stage_mask = dstStageMask;
    cmd->u.wait_events.event_count = eventCount;
-   cmd->u.wait_events.events = (struct lvp_event **)(cmd + 1);
+   cmd->u.wait_events.events = (struct lvp_event **)cmd_buf_entry_extra(cmd);
    for (unsigned i = 0; i < eventCount; i++)
       cmd->u.wait_events.events[i] = lvp_event_from_handle(pEvents[i]);
    cmd->u.wait_events.memory_barrier_count = memoryBarrierCount;
@@ -1000,7 +1160,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdCopyBufferToImage2KHR(
    {
       VkBufferImageCopy *regions;
 
-      regions = (VkBufferImageCopy *)(cmd + 1);
+      regions = (VkBufferImageCopy *)cmd_buf_entry_extra(cmd);
       COPY_STRUCT2_ARRAY(info->regionCount, regions, info->pRegions, VkBufferImageCopy);
       cmd->u.buffer_to_img.regions = regions;
    }
@@ -1030,7 +1190,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdCopyImageToBuffer2KHR(
    {
       VkBufferImageCopy *regions;
 
-      regions = (VkBufferImageCopy *)(cmd + 1);
+      regions = (VkBufferImageCopy *)cmd_buf_entry_extra(cmd);
       COPY_STRUCT2_ARRAY(info->regionCount, regions, info->pRegions, VkBufferImageCopy);
       cmd->u.img_to_buffer.regions = regions;
    }
@@ -1061,7 +1221,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdCopyImage2KHR(
    {
       VkImageCopy *regions;
 
-      regions = (VkImageCopy *)(cmd + 1);
+      regions = (VkImageCopy *)cmd_buf_entry_extra(cmd);
       COPY_STRUCT2_ARRAY(info->regionCount, regions, info->pRegions, VkImageCopy);
       cmd->u.copy_image.regions = regions;
    }
@@ -1091,7 +1251,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdCopyBuffer2KHR(
    {
       VkBufferCopy *regions;
 
-      regions = (VkBufferCopy *)(cmd + 1);
+      regions = (VkBufferCopy *)cmd_buf_entry_extra(cmd);
       COPY_STRUCT2_ARRAY(info->regionCount, regions, info->pRegions, VkBufferCopy);
       cmd->u.copy_buffer.regions = regions;
    }
@@ -1124,7 +1284,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdBlitImage2KHR(
    {
       VkImageBlit *regions;
 
-      regions = (VkImageBlit *)(cmd + 1);
+      regions = (VkImageBlit *)cmd_buf_entry_extra(cmd);
       COPY_STRUCT2_ARRAY(info->regionCount, regions, info->pRegions, VkImageBlit);
       cmd->u.blit_image.regions = regions;
    }
@@ -1148,7 +1308,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdClearAttachments(
       return;
 
    cmd->u.clear_attachments.attachment_count = attachmentCount;
-   cmd->u.clear_attachments.attachments = (VkClearAttachment *)(cmd + 1);
+   cmd->u.clear_attachments.attachments = (VkClearAttachment *)cmd_buf_entry_extra(cmd);
    for (unsigned i = 0; i < attachmentCount; i++)
       cmd->u.clear_attachments.attachments[i] = pAttachments[i];
    cmd->u.clear_attachments.rect_count = rectCount;
@@ -1226,7 +1386,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdClearColorImage(
    cmd->u.clear_color_image.layout = imageLayout;
    cmd->u.clear_color_image.clear_val = *pColor;
    cmd->u.clear_color_image.range_count = rangeCount;
-   cmd->u.clear_color_image.ranges = (VkImageSubresourceRange *)(cmd + 1);
+   cmd->u.clear_color_image.ranges = (VkImageSubresourceRange *)cmd_buf_entry_extra(cmd);
    for (unsigned i = 0; i < rangeCount; i++)
       cmd->u.clear_color_image.ranges[i] = pRanges[i];
 
@@ -1254,7 +1414,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdClearDepthStencilImage(
    cmd->u.clear_ds_image.layout = imageLayout;
    cmd->u.clear_ds_image.clear_val = *pDepthStencil;
    cmd->u.clear_ds_image.range_count = rangeCount;
-   cmd->u.clear_ds_image.ranges = (VkImageSubresourceRange *)(cmd + 1);
+   cmd->u.clear_ds_image.ranges = (VkImageSubresourceRange *)cmd_buf_entry_extra(cmd);
    for (unsigned i = 0; i < rangeCount; i++)
       cmd->u.clear_ds_image.ranges[i] = pRanges[i];
 
@@ -1281,7 +1441,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdResolveImage2KHR(
    cmd->u.resolve_image.src_layout = info->srcImageLayout;
    cmd->u.resolve_image.dst_layout = info->dstImageLayout;
    cmd->u.resolve_image.region_count = info->regionCount;
-   cmd->u.resolve_image.regions = (VkImageResolve *)(cmd + 1);
+   cmd->u.resolve_image.regions = (VkImageResolve *)cmd_buf_entry_extra(cmd);
    COPY_STRUCT2_ARRAY(info->regionCount, cmd->u.resolve_image.regions, info->pRegions, VkImageResolve);
 
    cmd_buf_queue(cmd_buffer, cmd);
@@ -1540,7 +1700,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdPushDescriptorSetKHR(
    cmd->u.push_descriptor_set.layout = layout;
    cmd->u.push_descriptor_set.set = set;
    cmd->u.push_descriptor_set.descriptor_write_count = descriptorWriteCount;
-   cmd->u.push_descriptor_set.descriptors = (struct lvp_write_descriptor *)(cmd + 1);
+   cmd->u.push_descriptor_set.descriptors = (struct lvp_write_descriptor *)cmd_buf_entry_extra(cmd);
    cmd->u.push_descriptor_set.infos = (union lvp_descriptor_info *)(cmd->u.push_descriptor_set.descriptors + descriptorWriteCount);
 
    unsigned descriptor_index = 0;
@@ -1620,7 +1780,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdPushDescriptorSetWithTemplateKHR(
    cmd->u.push_descriptor_set.layout = templ->pipeline_layout;
    cmd->u.push_descriptor_set.set = templ->set;
    cmd->u.push_descriptor_set.descriptor_write_count = templ->entry_count;
-   cmd->u.push_descriptor_set.descriptors = (struct lvp_write_descriptor *)(cmd + 1);
+   cmd->u.push_descriptor_set.descriptors = (struct lvp_write_descriptor *)cmd_buf_entry_extra(cmd);
    cmd->u.push_descriptor_set.infos = (union lvp_descriptor_info *)(cmd->u.push_descriptor_set.descriptors + templ->entry_count);
 
    unsigned descriptor_index = 0;
@@ -1700,7 +1860,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdBindTransformFeedbackBuffersEXT(
 
    cmd->u.bind_transform_feedback_buffers.first_binding = firstBinding;
    cmd->u.bind_transform_feedback_buffers.binding_count = bindingCount;
-   cmd->u.bind_transform_feedback_buffers.buffers = (struct lvp_buffer **)(cmd + 1);
+   cmd->u.bind_transform_feedback_buffers.buffers = (struct lvp_buffer **)cmd_buf_entry_extra(cmd);
    cmd->u.bind_transform_feedback_buffers.offsets = (VkDeviceSize *)(cmd->u.bind_transform_feedback_buffers.buffers + bindingCount);
    cmd->u.bind_transform_feedback_buffers.sizes = (VkDeviceSize *)(cmd->u.bind_transform_feedback_buffers.offsets + bindingCount);
 
@@ -1731,7 +1891,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdBeginTransformFeedbackEXT(
 
    cmd->u.begin_transform_feedback.first_counter_buffer = firstCounterBuffer;
    cmd->u.begin_transform_feedback.counter_buffer_count = counterBufferCount;
-   cmd->u.begin_transform_feedback.counter_buffers = (struct lvp_buffer **)(cmd + 1);
+   cmd->u.begin_transform_feedback.counter_buffers = (struct lvp_buffer **)cmd_buf_entry_extra(cmd);
    cmd->u.begin_transform_feedback.counter_buffer_offsets = (VkDeviceSize *)(cmd->u.begin_transform_feedback.counter_buffers + counterBufferCount);
 
    for (unsigned i = 0; i < counterBufferCount; i++) {
@@ -1763,7 +1923,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdEndTransformFeedbackEXT(
 
    cmd->u.begin_transform_feedback.first_counter_buffer = firstCounterBuffer;
    cmd->u.begin_transform_feedback.counter_buffer_count = counterBufferCount;
-   cmd->u.begin_transform_feedback.counter_buffers = (struct lvp_buffer **)(cmd + 1);
+   cmd->u.begin_transform_feedback.counter_buffers = (struct lvp_buffer **)cmd_buf_entry_extra(cmd);
    cmd->u.begin_transform_feedback.counter_buffer_offsets = (VkDeviceSize *)(cmd->u.begin_transform_feedback.counter_buffers + counterBufferCount);
 
    for (unsigned i = 0; i < counterBufferCount; i++) {
@@ -1915,7 +2075,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdSetViewportWithCountEXT(
    struct lvp_cmd_buffer_entry *cmd;
    int i;
 
-   cmd = cmd_buf_entry_alloc(cmd_buffer, LVP_CMD_SET_VIEWPORT);
+   cmd = cmd_buf_entry_alloc_size(cmd_buffer, viewportCount * sizeof(VkViewport), LVP_CMD_SET_VIEWPORT);
    if (!cmd)
       return;
 
@@ -1936,7 +2096,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdSetScissorWithCountEXT(
    struct lvp_cmd_buffer_entry *cmd;
    int i;
 
-   cmd = cmd_buf_entry_alloc(cmd_buffer, LVP_CMD_SET_SCISSOR);
+   cmd = cmd_buf_entry_alloc_size(cmd_buffer, scissorCount * sizeof(VkRect2D), LVP_CMD_SET_SCISSOR);
    if (!cmd)
       return;
 
@@ -1973,7 +2133,7 @@ VKAPI_ATTR void VKAPI_CALL lvp_CmdBindVertexBuffers2EXT(
    cmd->u.vertex_buffers.first = firstBinding;
    cmd->u.vertex_buffers.binding_count = bindingCount;
 
-   buffers = (struct lvp_buffer **)(cmd + 1);
+   buffers = (struct lvp_buffer **)cmd_buf_entry_extra(cmd);
    offsets = (VkDeviceSize *)(buffers + bindingCount);
    sizes = (VkDeviceSize *)(offsets + bindingCount);
    strides = (VkDeviceSize *)(sizes + bindingCount);
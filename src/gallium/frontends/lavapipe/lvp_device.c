@@ -116,6 +116,7 @@ static const struct vk_device_extension_table lvp_device_extensions_supported =
 #ifdef LVP_USE_WSI_PLATFORM
    .KHR_swapchain                         = true,
 #endif
+   .KHR_timeline_semaphore                = true,
    .KHR_uniform_buffer_standard_layout    = true,
    .KHR_variable_pointers                 = true,
    .EXT_calibrated_timestamps             = true,
@@ -498,6 +499,12 @@ VKAPI_ATTR void VKAPI_CALL lvp_GetPhysicalDeviceFeatures2(
          features->extendedDynamicState = true;
          break;
       }
+      case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES: {
+         VkPhysicalDeviceTimelineSemaphoreFeatures *features =
+            (VkPhysicalDeviceTimelineSemaphoreFeatures *)ext;
+         features->timelineSemaphore = true;
+         break;
+      }
       case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES: {
          VkPhysicalDeviceMultiviewFeatures *features =
             (VkPhysicalDeviceMultiviewFeatures*)ext;
@@ -705,6 +712,12 @@ VKAPI_ATTR void VKAPI_CALL lvp_GetPhysicalDeviceProperties2(
          properties->maxPushDescriptors = MAX_PUSH_DESCRIPTORS;
          break;
       }
+      case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_PROPERTIES: {
+         VkPhysicalDeviceTimelineSemaphoreProperties *properties =
+            (VkPhysicalDeviceTimelineSemaphoreProperties *)ext;
+         properties->maxTimelineSemaphoreValueDifference = UINT64_MAX;
+         break;
+      }
       case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_3_PROPERTIES: {
          VkPhysicalDeviceMaintenance3Properties *properties =
             (VkPhysicalDeviceMaintenance3Properties*)ext;
@@ -894,6 +907,85 @@ VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vk_icdGetPhysicalDeviceProcAddr(
    return vk_instance_get_physical_device_proc_addr(&instance->vk, pName);
 }
 
+/* Wait for lvp_device::timeline_cond with fence_lock held.  Return false
+ * once abs_timeout (as returned by os_time_get_absolute_timeout) expired.
+ */
+static bool
+timeline_wait_locked(struct lvp_device *device, int64_t abs_timeout)
+{
+   struct timespec ts;
+   int64_t rel;
+
+   if (abs_timeout == OS_TIMEOUT_INFINITE) {
+      cnd_wait(&device->timeline_cond, &device->fence_lock);
+      return true;
+   }
+
+   rel = abs_timeout - os_time_get_nano();
+   if (rel <= 0)
+      return false;
+
+   /* cnd_timedwait is relative to the TIME_UTC clock */
+   timespec_get(&ts, TIME_UTC);
+   timespec_add_nsec(&ts, &ts, rel);
+   return cnd_timedwait(&device->timeline_cond, &device->fence_lock, &ts) ==
+          thrd_success;
+}
+
+static uint64_t
+pipe_timeout(int64_t abs_timeout)
+{
+   int64_t rel;
+
+   if (abs_timeout == OS_TIMEOUT_INFINITE)
+      return PIPE_TIMEOUT_INFINITE;
+   rel = abs_timeout - os_time_get_nano();
+   return rel > 0 ? rel : 0;
+}
+
+static void
+queue_execute_task(struct lvp_queue *queue, struct lvp_queue_work *task)
+{
+   struct lvp_device *device = queue->device;
+   struct pipe_screen *pscreen = device->pscreen;
+   struct pipe_fence_handle *handle = NULL;
+
+   /* Only this submission has to wait, everything it depends on was
+    * submitted to this queue before or gets signalled from the host.
+    */
+   mtx_lock(&device->fence_lock);
+   for (uint32_t i = 0; i < task->wait_count; i++) {
+      while (task->waits[i]->value < task->wait_values[i])
+         cnd_wait(&device->timeline_cond, &device->fence_lock);
+   }
+   mtx_unlock(&device->fence_lock);
+
+   for (unsigned i = 0; i < task->cmd_buffer_count; i++) {
+      bool last = i == task->cmd_buffer_count - 1;
+      lvp_execute_cmds(device, queue, last ? &handle : NULL,
+                       task->cmd_buffers[i]);
+   }
+
+   /* Timeline semaphores are waited on without a pipe fence, so they may
+    * only move on once the rendering is done.
+    */
+   if (handle && task->signal_count)
+      pscreen->fence_finish(pscreen, NULL, handle, PIPE_TIMEOUT_INFINITE);
+
+   mtx_lock(&device->fence_lock);
+   if (task->fence)
+      pscreen->fence_reference(pscreen, &task->fence->handle, handle);
+   if (handle)
+      pscreen->fence_reference(pscreen, &queue->last_fence, handle);
+   for (uint32_t i = 0; i < task->signal_count; i++)
+      task->signals[i]->value = task->signal_values[i];
+   queue->last_finished = task->timeline;
+   cnd_broadcast(&device->timeline_cond);
+   mtx_unlock(&device->fence_lock);
+
+   pscreen->fence_reference(pscreen, &handle, NULL);
+}
+
 static int queue_thread(void *data)
 {
    struct lvp_queue *queue = data;
@@ -911,13 +1003,7 @@ static int queue_thread(void *data)
                               list);
 
       mtx_unlock(&queue->m);
-      //execute
-      for (unsigned i = 0; i < task->cmd_buffer_count; i++) {
-         lvp_execute_cmds(queue->device, queue, task->fence, task->cmd_buffers[i]);
-      }
-      if (!task->cmd_buffer_count && task->fence)
-         task->fence->signaled = true;
-      p_atomic_dec(&queue->count);
+      queue_execute_task(queue, task);
       mtx_lock(&queue->m);
       list_del(&task->list);
       free(task);
@@ -933,9 +1019,13 @@ lvp_queue_init(struct lvp_device *device, struct lvp_queue *queue)
 
    queue->flags = 0;
    queue->ctx = device->pscreen->context_create(device->pscreen, NULL, PIPE_CONTEXT_ROBUST_BUFFER_ACCESS);
+   queue->cso = cso_create_context(queue->ctx, CSO_NO_USER_VERTEX_BUFFERS);
    list_inithead(&queue->workqueue);
-   p_atomic_set(&queue->count, 0);
+   queue->timeline = 0;
+   queue->last_finished = 0;
+   queue->last_fence = NULL;
    mtx_init(&queue->m, mtx_plain);
+   cnd_init(&queue->new_work);
    queue->exec_thread = u_thread_create(queue_thread, queue);
 
    vk_object_base_init(&device->vk, &queue->base, VK_OBJECT_TYPE_QUEUE);
@@ -954,6 +1044,9 @@ lvp_queue_finish(struct lvp_queue *queue)
 
    cnd_destroy(&queue->new_work);
    mtx_destroy(&queue->m);
+   queue->device->pscreen->fence_reference(queue->device->pscreen,
+                                           &queue->last_fence, NULL);
+   cso_destroy_context(queue->cso);
    queue->ctx->destroy(queue->ctx);
 }
 
@@ -1006,6 +1099,7 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_CreateDevice(
    device->physical_device = physical_device;
 
    mtx_init(&device->fence_lock, mtx_plain);
+   cnd_init(&device->timeline_cond);
    device->pscreen = physical_device->pscreen;
 
    lvp_queue_init(device, &device->queue);
@@ -1023,6 +1117,8 @@ VKAPI_ATTR void VKAPI_CALL lvp_DestroyDevice(
    LVP_FROM_HANDLE(lvp_device, device, _device);
 
    lvp_queue_finish(&device->queue);
+   cnd_destroy(&device->timeline_cond);
+   mtx_destroy(&device->fence_lock);
    vk_device_finish(&device->vk);
    vk_free(&device->vk.alloc, device);
 }
@@ -1108,6 +1204,35 @@ VKAPI_ATTR void VKAPI_CALL lvp_GetDeviceQueue(
 }
 
 
+static void
+queue_submit_task(struct lvp_queue *queue, struct lvp_queue_work *task)
+{
+   struct lvp_device *device = queue->device;
+
+   mtx_lock(&device->fence_lock);
+   task->timeline = ++queue->timeline;
+   if (task->fence)
+      task->fence->timeline = task->timeline;
+   mtx_unlock(&device->fence_lock);
+
+   mtx_lock(&queue->m);
+   list_addtail(&task->list, &queue->workqueue);
+   cnd_signal(&queue->new_work);
+   mtx_unlock(&queue->m);
+}
+
+static uint32_t
+count_timeline_semaphores(uint32_t count, const VkSemaphore *semaphores)
+{
+   uint32_t num = 0;
+
+   for (uint32_t i = 0; i < count; i++) {
+      if (lvp_semaphore_from_handle(semaphores[i])->is_timeline)
+         num++;
+   }
+   return num;
+}
+
 VKAPI_ATTR VkResult VKAPI_CALL lvp_QueueSubmit(
    VkQueue                                     _queue,
    uint32_t                                    submitCount,
@@ -1116,45 +1241,101 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_QueueSubmit(
 {
    LVP_FROM_HANDLE(lvp_queue, queue, _queue);
    LVP_FROM_HANDLE(lvp_fence, fence, _fence);
+   struct lvp_queue_work *task;
 
-   if (submitCount == 0)
-      goto just_signal_fence;
-   for (uint32_t i = 0; i < submitCount; i++) {
-      uint32_t task_size = sizeof(struct lvp_queue_work) + pSubmits[i].commandBufferCount * sizeof(struct lvp_cmd_buffer *);
-      struct lvp_queue_work *task = malloc(task_size);
+   if (submitCount == 0) {
+      if (!fence)
+         return VK_SUCCESS;
 
-      task->cmd_buffer_count = pSubmits[i].commandBufferCount;
+      /* the fence signals once the work submitted so far is done */
+      task = calloc(1, sizeof(*task));
+      if (!task)
+         return vk_error(queue->device->instance, VK_ERROR_OUT_OF_HOST_MEMORY);
       task->fence = fence;
-      task->cmd_buffers = (struct lvp_cmd_buffer **)(task + 1);
-      for (uint32_t j = 0; j < pSubmits[i].commandBufferCount; j++) {
-         task->cmd_buffers[j] = lvp_cmd_buffer_from_handle(pSubmits[i].pCommandBuffers[j]);
+      queue_submit_task(queue, task);
+      return VK_SUCCESS;
+   }
+
+   for (uint32_t i = 0; i < submitCount; i++) {
+      const VkSubmitInfo *submit = &pSubmits[i];
+      const VkTimelineSemaphoreSubmitInfo *timeline_info =
+         vk_find_struct_const(submit->pNext, TIMELINE_SEMAPHORE_SUBMIT_INFO);
+      uint32_t wait_count =
+         count_timeline_semaphores(submit->waitSemaphoreCount,
+                                   submit->pWaitSemaphores);
+      uint32_t signal_count =
+         count_timeline_semaphores(submit->signalSemaphoreCount,
+                                   submit->pSignalSemaphores);
+      size_t task_size = sizeof(struct lvp_queue_work) +
+         (wait_count + signal_count) * sizeof(uint64_t) +
+         (wait_count + signal_count) * sizeof(struct lvp_semaphore *) +
+         submit->commandBufferCount * sizeof(struct lvp_cmd_buffer *);
+
+      task = malloc(task_size);
+      if (!task)
+         return vk_error(queue->device->instance, VK_ERROR_OUT_OF_HOST_MEMORY);
+
+      task->cmd_buffer_count = submit->commandBufferCount;
+      task->wait_count = 0;
+      task->signal_count = 0;
+      task->fence = i == submitCount - 1 ? fence : NULL;
+      task->wait_values = (uint64_t *)(task + 1);
+      task->signal_values = task->wait_values + wait_count;
+      task->waits = (struct lvp_semaphore **)(task->signal_values + signal_count);
+      task->signals = task->waits + wait_count;
+      task->cmd_buffers = (struct lvp_cmd_buffer **)(task->signals + signal_count);
+      for (uint32_t j = 0; j < submit->commandBufferCount; j++) {
+         task->cmd_buffers[j] = lvp_cmd_buffer_from_handle(submit->pCommandBuffers[j]);
       }
 
-      mtx_lock(&queue->m);
-      p_atomic_inc(&queue->count);
-      list_addtail(&task->list, &queue->workqueue);
-      cnd_signal(&queue->new_work);
-      mtx_unlock(&queue->m);
+      for (uint32_t j = 0; j < submit->waitSemaphoreCount; j++) {
+         LVP_FROM_HANDLE(lvp_semaphore, sema, submit->pWaitSemaphores[j]);
+         if (!sema->is_timeline)
+            continue;
+         assert(timeline_info && j < timeline_info->waitSemaphoreValueCount);
+         task->waits[task->wait_count] = sema;
+         task->wait_values[task->wait_count++] =
+            timeline_info->pWaitSemaphoreValues[j];
+      }
+      for (uint32_t j = 0; j < submit->signalSemaphoreCount; j++) {
+         LVP_FROM_HANDLE(lvp_semaphore, sema, submit->pSignalSemaphores[j]);
+         if (!sema->is_timeline)
+            continue;
+         assert(timeline_info && j < timeline_info->signalSemaphoreValueCount);
+         task->signals[task->signal_count] = sema;
+         task->signal_values[task->signal_count++] =
+            timeline_info->pSignalSemaphoreValues[j];
+      }
+
+      queue_submit_task(queue, task);
    }
    return VK_SUCCESS;
- just_signal_fence:
-   fence->signaled = true;
-   return VK_SUCCESS;
 }
 
 static VkResult queue_wait_idle(struct lvp_queue *queue, uint64_t timeout)
 {
-   if (timeout == 0)
-      return p_atomic_read(&queue->count) == 0 ? VK_SUCCESS : VK_TIMEOUT;
-   if (timeout == UINT64_MAX)
-      while (p_atomic_read(&queue->count))
-         os_time_sleep(100);
-   else {
-      int64_t atime = os_time_get_absolute_timeout(timeout);
-      if (!os_wait_until_zero_abs_timeout(&queue->count, atime))
+   struct lvp_device *device = queue->device;
+   struct pipe_screen *pscreen = device->pscreen;
+   struct pipe_fence_handle *handle = NULL;
+   int64_t abs_timeout = os_time_get_absolute_timeout(timeout);
+   bool idle = true;
+
+   mtx_lock(&device->fence_lock);
+   while (queue->last_finished < queue->timeline) {
+      if (!timeline_wait_locked(device, abs_timeout)) {
+         mtx_unlock(&device->fence_lock);
          return VK_TIMEOUT;
+      }
    }
-   return VK_SUCCESS;
+   pscreen->fence_reference(pscreen, &handle, queue->last_fence);
+   mtx_unlock(&device->fence_lock);
+
+   if (handle) {
+      idle = pscreen->fence_finish(pscreen, NULL, handle,
+                                   pipe_timeout(abs_timeout));
+      pscreen->fence_reference(pscreen, &handle, NULL);
+   }
+   return idle ? VK_SUCCESS : VK_TIMEOUT;
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL lvp_QueueWaitIdle(
@@ -1444,6 +1625,7 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_CreateFence(
    vk_object_base_init(&device->vk, &fence->base, VK_OBJECT_TYPE_FENCE);
    fence->signaled = pCreateInfo->flags & VK_FENCE_CREATE_SIGNALED_BIT;
 
+   fence->timeline = 0;
    fence->handle = NULL;
    *pFence = lvp_fence_to_handle(fence);
 
@@ -1479,6 +1661,7 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_ResetFences(
       fence->signaled = false;
 
       mtx_lock(&device->fence_lock);
+      fence->timeline = 0;
       if (fence->handle)
          device->pscreen->fence_reference(device->pscreen, &fence->handle, NULL);
       mtx_unlock(&device->fence_lock);
@@ -1486,32 +1669,54 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_ResetFences(
    return VK_SUCCESS;
 }
 
+/* Called with fence_lock held, which is dropped while waiting for the
+ * rendering to finish.
+ */
+static VkResult
+fence_wait_locked(struct lvp_device *device, struct lvp_fence *fence,
+                  int64_t abs_timeout)
+{
+   struct pipe_screen *pscreen = device->pscreen;
+   struct pipe_fence_handle *handle = NULL;
+   bool signalled;
+
+   /* wait for the queue thread to get the submission executed */
+   while (!fence->signaled &&
+          (!fence->timeline ||
+           device->queue.last_finished < fence->timeline)) {
+      if (!timeline_wait_locked(device, abs_timeout))
+         return VK_TIMEOUT;
+   }
+
+   if (fence->signaled || !fence->handle)
+      return VK_SUCCESS;
+
+   pscreen->fence_reference(pscreen, &handle, fence->handle);
+   mtx_unlock(&device->fence_lock);
+   signalled = pscreen->fence_finish(pscreen, NULL, handle,
+                                     pipe_timeout(abs_timeout));
+   pscreen->fence_reference(pscreen, &handle, NULL);
+   mtx_lock(&device->fence_lock);
+
+   return signalled ? VK_SUCCESS : VK_TIMEOUT;
+}
+
 VKAPI_ATTR VkResult VKAPI_CALL lvp_GetFenceStatus(
    VkDevice                                    _device,
    VkFence                                     _fence)
 {
    LVP_FROM_HANDLE(lvp_device, device, _device);
    LVP_FROM_HANDLE(lvp_fence, fence, _fence);
+   VkResult result;
 
    if (fence->signaled)
       return VK_SUCCESS;
 
    mtx_lock(&device->fence_lock);
-
-   if (!fence->handle) {
-      mtx_unlock(&device->fence_lock);
-      return VK_NOT_READY;
-   }
-
-   bool signalled = device->pscreen->fence_finish(device->pscreen,
-                                                  NULL,
-                                                  fence->handle,
-                                                  0);
+   result = fence_wait_locked(device, fence, 0);
    mtx_unlock(&device->fence_lock);
-   if (signalled)
-      return VK_SUCCESS;
-   else
-      return VK_NOT_READY;
+
+   return result == VK_SUCCESS ? VK_SUCCESS : VK_NOT_READY;
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL lvp_CreateFramebuffer(
@@ -1571,36 +1776,45 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_WaitForFences(
    uint64_t                                    timeout)
 {
    LVP_FROM_HANDLE(lvp_device, device, _device);
-
-   VkResult qret = queue_wait_idle(&device->queue, timeout);
-   bool timeout_status = false;
-   if (qret == VK_TIMEOUT)
-      return VK_TIMEOUT;
+   int64_t abs_timeout = os_time_get_absolute_timeout(timeout);
+   VkResult result = VK_SUCCESS;
 
    mtx_lock(&device->fence_lock);
-   for (unsigned i = 0; i < fenceCount; i++) {
-      struct lvp_fence *fence = lvp_fence_from_handle(pFences[i]);
-
-      if (fence->signaled)
-         continue;
-      if (!fence->handle) {
-         timeout_status |= true;
-         continue;
-      }
-      bool ret = device->pscreen->fence_finish(device->pscreen,
-                                               NULL,
-                                               fence->handle,
-                                               timeout);
-      if (ret && !waitAll) {
-         timeout_status = false;
-         break;
+   if (waitAll || fenceCount == 1) {
+      for (unsigned i = 0; i < fenceCount && result == VK_SUCCESS; i++) {
+         struct lvp_fence *fence = lvp_fence_from_handle(pFences[i]);
+         result = fence_wait_locked(device, fence, abs_timeout);
       }
+   } else {
+      for (;;) {
+         struct lvp_fence *executed = NULL;
 
-      if (!ret)
-         timeout_status |= true;
+         for (unsigned i = 0; i < fenceCount; i++) {
+            struct lvp_fence *fence = lvp_fence_from_handle(pFences[i]);
+
+            if (fence_wait_locked(device, fence, 0) == VK_SUCCESS)
+               goto out;
+            if (!executed && fence->timeline &&
+                device->queue.last_finished >= fence->timeline)
+               executed = fence;
+         }
+
+         /* The rendering of the queue is done in order, so nothing
+          * submitted later can finish before an executed fence.
+          */
+         if (executed) {
+            result = fence_wait_locked(device, executed, abs_timeout);
+            break;
+         }
+         if (!timeline_wait_locked(device, abs_timeout)) {
+            result = VK_TIMEOUT;
+            break;
+         }
+      }
    }
+out:
    mtx_unlock(&device->fence_lock);
-   return timeout_status ? VK_TIMEOUT : VK_SUCCESS;
+   return result;
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL lvp_CreateSemaphore(
@@ -1619,6 +1833,13 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_CreateSemaphore(
       return vk_error(device->instance, VK_ERROR_OUT_OF_HOST_MEMORY);
    vk_object_base_init(&device->vk, &sema->base,
                        VK_OBJECT_TYPE_SEMAPHORE);
+
+   const VkSemaphoreTypeCreateInfo *type_info =
+      vk_find_struct_const(pCreateInfo->pNext, SEMAPHORE_TYPE_CREATE_INFO);
+   sema->is_timeline = type_info &&
+                       type_info->semaphoreType == VK_SEMAPHORE_TYPE_TIMELINE;
+   sema->value = sema->is_timeline ? type_info->initialValue : 0;
+
    *pSemaphore = lvp_semaphore_to_handle(sema);
 
    return VK_SUCCESS;
@@ -1638,6 +1859,65 @@ VKAPI_ATTR void VKAPI_CALL lvp_DestroySemaphore(
    vk_free2(&device->vk.alloc, pAllocator, semaphore);
 }
 
+VKAPI_ATTR VkResult VKAPI_CALL lvp_GetSemaphoreCounterValue(
+   VkDevice                                    _device,
+   VkSemaphore                                 _semaphore,
+   uint64_t*                                   pValue)
+{
+   LVP_FROM_HANDLE(lvp_device, device, _device);
+   LVP_FROM_HANDLE(lvp_semaphore, semaphore, _semaphore);
+
+   mtx_lock(&device->fence_lock);
+   *pValue = semaphore->value;
+   mtx_unlock(&device->fence_lock);
+   return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL lvp_SignalSemaphore(
+   VkDevice                                    _device,
+   const VkSemaphoreSignalInfo*                pSignalInfo)
+{
+   LVP_FROM_HANDLE(lvp_device, device, _device);
+   LVP_FROM_HANDLE(lvp_semaphore, semaphore, pSignalInfo->semaphore);
+
+   mtx_lock(&device->fence_lock);
+   semaphore->value = pSignalInfo->value;
+   cnd_broadcast(&device->timeline_cond);
+   mtx_unlock(&device->fence_lock);
+   return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL lvp_WaitSemaphores(
+   VkDevice                                    _device,
+   const VkSemaphoreWaitInfo*                  pWaitInfo,
+   uint64_t                                    timeout)
+{
+   LVP_FROM_HANDLE(lvp_device, device, _device);
+   bool wait_any = pWaitInfo->flags & VK_SEMAPHORE_WAIT_ANY_BIT;
+   int64_t abs_timeout = os_time_get_absolute_timeout(timeout);
+   VkResult result = VK_SUCCESS;
+
+   mtx_lock(&device->fence_lock);
+   for (;;) {
+      uint32_t done = 0;
+
+      for (uint32_t i = 0; i < pWaitInfo->semaphoreCount; i++) {
+         LVP_FROM_HANDLE(lvp_semaphore, sema, pWaitInfo->pSemaphores[i]);
+         if (sema->value >= pWaitInfo->pValues[i])
+            done++;
+      }
+      if (done == pWaitInfo->semaphoreCount || (wait_any && done))
+         break;
+
+      if (!timeline_wait_locked(device, abs_timeout)) {
+         result = VK_TIMEOUT;
+         break;
+      }
+   }
+   mtx_unlock(&device->fence_lock);
+   return result;
+}
+
 VKAPI_ATTR VkResult VKAPI_CALL lvp_CreateEvent(
    VkDevice                                    _device,
    const VkEventCreateInfo*                    pCreateInfo,
@@ -45,6 +45,7 @@
 
 struct rendering_state {
    struct pipe_context *pctx;
+   struct cso_context *cso;
 
    bool blend_dirty;
    bool rs_dirty;
@@ -69,11 +70,8 @@ struct rendering_state {
    struct pipe_framebuffer_state framebuffer;
 
    struct pipe_blend_state blend_state;
-   void *blend_handle;
    struct pipe_rasterizer_state rs_state;
-   void *rast_handle;
    struct pipe_depth_stencil_alpha_state dsa_state;
-   void *dsa_handle;
 
    struct pipe_blend_color blend_color;
    struct pipe_stencil_ref stencil_ref;
@@ -94,8 +92,7 @@ struct rendering_state {
    int num_vb;
    unsigned start_vb;
    struct pipe_vertex_buffer vb[PIPE_MAX_ATTRIBS];
-   int num_ve;
-   struct pipe_vertex_element ve[PIPE_MAX_ATTRIBS];
+   struct cso_velems_state velem;
 
    struct pipe_sampler_view *sv[PIPE_SHADER_TYPES][PIPE_MAX_SAMPLERS];
    int num_sampler_views[PIPE_SHADER_TYPES];
@@ -110,11 +107,12 @@ struct rendering_state {
    int num_shader_buffers[PIPE_SHADER_TYPES];
    bool iv_dirty[PIPE_SHADER_TYPES];
    bool sb_dirty[PIPE_SHADER_TYPES];
-   void *ss_cso[PIPE_SHADER_TYPES][PIPE_MAX_SAMPLERS];
-   void *velems_cso;
 
    uint8_t push_constants[128 * 4];
 
+   /* last graphics pipeline handled, rebinding it is a no-op */
+   const struct lvp_pipeline *pipeline;
+
    const struct lvp_render_pass *pass;
    uint32_t subpass;
    const struct lvp_framebuffer *vk_framebuffer;
@@ -133,6 +131,20 @@ struct rendering_state {
    uint32_t so_offsets[PIPE_MAX_SO_BUFFERS];
 };
 
+/* The cso context hashes the sampler states, so only new states create
+ * driver objects and unchanged ones aren't even rebound.
+ */
+static void emit_samplers(struct rendering_state *state,
+                          enum pipe_shader_type sh)
+{
+   const struct pipe_sampler_state *ss[PIPE_MAX_SAMPLERS];
+
+   for (unsigned i = 0; i < state->num_sampler_states[sh]; i++)
+      ss[i] = &state->ss[sh][i];
+
+   cso_set_samplers(state->cso, sh, state->num_sampler_states[sh], ss);
+}
+
 static void emit_compute_state(struct rendering_state *state)
 {
    if (state->iv_dirty[PIPE_SHADER_COMPUTE]) {
@@ -169,12 +181,7 @@ static void emit_compute_state(struct rendering_state *state)
    }
 
    if (state->ss_dirty[PIPE_SHADER_COMPUTE]) {
-      for (unsigned i = 0; i < state->num_sampler_states[PIPE_SHADER_COMPUTE]; i++) {
-         if (state->ss_cso[PIPE_SHADER_COMPUTE][i])
-            state->pctx->delete_sampler_state(state->pctx, state->ss_cso[PIPE_SHADER_COMPUTE][i]);
-         state->ss_cso[PIPE_SHADER_COMPUTE][i] = state->pctx->create_sampler_state(state->pctx, &state->ss[PIPE_SHADER_COMPUTE][i]);
-      }
-      state->pctx->bind_sampler_states(state->pctx, PIPE_SHADER_COMPUTE, 0, state->num_sampler_states[PIPE_SHADER_COMPUTE], state->ss_cso[PIPE_SHADER_COMPUTE]);
+      emit_samplers(state, PIPE_SHADER_COMPUTE);
       state->ss_dirty[PIPE_SHADER_COMPUTE] = false;
    }
 }
@@ -182,38 +189,22 @@ static void emit_compute_state(struct rendering_state *state)
 static void emit_state(struct rendering_state *state)
 {
    int sh;
+   /* The CSOs are cached by the cso context, keyed on the state, so
+    * switching back and forth between pipelines doesn't create new
+    * driver objects, and states that didn't change aren't rebound.
+    */
    if (state->blend_dirty) {
-      if (state->blend_handle) {
-         state->pctx->bind_blend_state(state->pctx, NULL);
-         state->pctx->delete_blend_state(state->pctx, state->blend_handle);
-      }
-      state->blend_handle = state->pctx->create_blend_state(state->pctx,
-                                                            &state->blend_state);
-      state->pctx->bind_blend_state(state->pctx, state->blend_handle);
-
+      cso_set_blend(state->cso, &state->blend_state);
       state->blend_dirty = false;
    }
 
    if (state->rs_dirty) {
-      if (state->rast_handle) {
-         state->pctx->bind_rasterizer_state(state->pctx, NULL);
-         state->pctx->delete_rasterizer_state(state->pctx, state->rast_handle);
-      }
-      state->rast_handle = state->pctx->create_rasterizer_state(state->pctx,
-                                                                &state->rs_state);
-      state->pctx->bind_rasterizer_state(state->pctx, state->rast_handle);
+      cso_set_rasterizer(state->cso, &state->rs_state);
       state->rs_dirty = false;
    }
 
    if (state->dsa_dirty) {
-      if (state->dsa_handle) {
-         state->pctx->bind_depth_stencil_alpha_state(state->pctx, NULL);
-         state->pctx->delete_depth_stencil_alpha_state(state->pctx, state->dsa_handle);
-      }
-      state->dsa_handle = state->pctx->create_depth_stencil_alpha_state(state->pctx,
-                                                                        &state->dsa_state);
-      state->pctx->bind_depth_stencil_alpha_state(state->pctx, state->dsa_handle);
-
+      cso_set_depth_stencil_alpha(state->cso, &state->dsa_state);
       state->dsa_dirty = false;
    }
 
@@ -244,16 +235,8 @@ static void emit_state(struct rendering_state *state)
    }
 
    if (state->ve_dirty) {
-      void *ve = NULL;
-      if (state->velems_cso)
-         ve = state->velems_cso;
-
-      state->velems_cso = state->pctx->create_vertex_elements_state(state->pctx, state->num_ve,
-                                                                    state->ve);
-      state->pctx->bind_vertex_elements_state(state->pctx, state->velems_cso);
-
-      if (ve)
-         state->pctx->delete_vertex_elements_state(state->pctx, ve);
+      cso_set_vertex_elements(state->cso, &state->velem);
+      state->ve_dirty = false;
    }
 
    for (sh = 0; sh < PIPE_SHADER_TYPES; sh++) {
@@ -269,6 +252,7 @@ static void emit_state(struct rendering_state *state)
       if (state->pcbuf_dirty[sh]) {
          state->pctx->set_constant_buffer(state->pctx, sh,
                                           0, false, &state->pc_buffer[sh]);
+         state->pcbuf_dirty[sh] = false;
       }
    }
 
@@ -277,6 +261,7 @@ static void emit_state(struct rendering_state *state)
          state->pctx->set_shader_buffers(state->pctx, sh,
                                          0, state->num_shader_buffers[sh],
                                          state->sb[sh], 0);
+         state->sb_dirty[sh] = false;
       }
    }
 
@@ -285,6 +270,7 @@ static void emit_state(struct rendering_state *state)
          state->pctx->set_shader_images(state->pctx, sh,
                                         0, state->num_shader_images[sh], 0,
                                         state->iv[sh]);
+         state->iv_dirty[sh] = false;
       }
    }
 
@@ -299,17 +285,11 @@ static void emit_state(struct rendering_state *state)
    }
 
    for (sh = 0; sh < PIPE_SHADER_TYPES; sh++) {
-      int i;
       if (!state->ss_dirty[sh])
          continue;
 
-      for (i = 0; i < state->num_sampler_states[sh]; i++) {
-         if (state->ss_cso[sh][i])
-            state->pctx->delete_sampler_state(state->pctx, state->ss_cso[sh][i]);
-         state->ss_cso[sh][i] = state->pctx->create_sampler_state(state->pctx, &state->ss[sh][i]);
-      }
-
-      state->pctx->bind_sampler_states(state->pctx, sh, 0, state->num_sampler_states[sh], state->ss_cso[sh]);
+      emit_samplers(state, sh);
+      state->ss_dirty[sh] = false;
    }
 
    if (state->vp_dirty) {
@@ -373,6 +353,14 @@ static void handle_graphics_pipeline(struct lvp_cmd_buffer_entry *cmd,
    bool dynamic_states[VK_DYNAMIC_STATE_STENCIL_REFERENCE+13];
    unsigned fb_samples = 0;
 
+   /* Only the pipeline sets its static state, and dynamic state commands
+    * only touch the dynamic state, so there's nothing to do if the same
+    * pipeline is bound again.
+    */
+   if (pipeline == state->pipeline)
+      return;
+   state->pipeline = pipeline;
+
    memset(dynamic_states, 0, sizeof(dynamic_states));
    if (pipeline->graphics_create_info.pDynamicState)
    {
@@ -605,33 +593,36 @@ static void handle_graphics_pipeline(struct lvp_cmd_buffer_entry *cmd,
 
       if (!dynamic_states[conv_dynamic_state_idx(VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE_EXT)]) {
          for (i = 0; i < vi->vertexBindingDescriptionCount; i++) {
-            state->vb[i].stride = vi->pVertexBindingDescriptions[i].stride;
+            if (state->vb[i].stride != vi->pVertexBindingDescriptions[i].stride) {
+               state->vb[i].stride = vi->pVertexBindingDescriptions[i].stride;
+               state->vb_dirty = true;
+            }
          }
       }
 
       int max_location = -1;
       for (i = 0; i < vi->vertexAttributeDescriptionCount; i++) {
          unsigned location = vi->pVertexAttributeDescriptions[i].location;
-         state->ve[location].src_offset = vi->pVertexAttributeDescriptions[i].offset;
-         state->ve[location].vertex_buffer_index = vi->pVertexAttributeDescriptions[i].binding;
-         state->ve[location].src_format = vk_format_to_pipe(vi->pVertexAttributeDescriptions[i].format);
+         state->velem.velems[location].src_offset = vi->pVertexAttributeDescriptions[i].offset;
+         state->velem.velems[location].vertex_buffer_index = vi->pVertexAttributeDescriptions[i].binding;
+         state->velem.velems[location].src_format = vk_format_to_pipe(vi->pVertexAttributeDescriptions[i].format);
 
          switch (vi->pVertexBindingDescriptions[vi->pVertexAttributeDescriptions[i].binding].inputRate) {
          case VK_VERTEX_INPUT_RATE_VERTEX:
-            state->ve[location].instance_divisor = 0;
+            state->velem.velems[location].instance_divisor = 0;
             break;
          case VK_VERTEX_INPUT_RATE_INSTANCE:
             if (div_state) {
                for (unsigned j = 0; j < div_state->vertexBindingDivisorCount; j++) {
                   const VkVertexInputBindingDivisorDescriptionEXT *desc =
                      &div_state->pVertexBindingDivisors[j];
-                  if (desc->binding == state->ve[location].vertex_buffer_index) {
-                     state->ve[location].instance_divisor = desc->divisor;
+                  if (desc->binding == state->velem.velems[location].vertex_buffer_index) {
+                     state->velem.velems[location].instance_divisor = desc->divisor;
                      break;
                   }
                }
             } else
-               state->ve[location].instance_divisor = 1;
+               state->velem.velems[location].instance_divisor = 1;
             break;
          default:
             assert(0);
@@ -641,8 +632,7 @@ static void handle_graphics_pipeline(struct lvp_cmd_buffer_entry *cmd,
          if ((int)location > max_location)
             max_location = location;
       }
-      state->num_ve = max_location + 1;
-      state->vb_dirty = true;
+      state->velem.count = max_location + 1;
       state->ve_dirty = true;
    }
 
@@ -3068,13 +3058,13 @@ static void lvp_execute_cmd_buffer(struct lvp_cmd_buffer *cmd_buffer,
 
 VkResult lvp_execute_cmds(struct lvp_device *device,
                           struct lvp_queue *queue,
-                          struct lvp_fence *fence,
+                          struct pipe_fence_handle **fence,
                           struct lvp_cmd_buffer *cmd_buffer)
 {
    struct rendering_state state;
-   struct pipe_fence_handle *handle = NULL;
    memset(&state, 0, sizeof(state));
    state.pctx = queue->ctx;
+   state.cso = queue->cso;
    state.blend_dirty = true;
    state.dsa_dirty = true;
    state.rs_dirty = true;
@@ -3082,16 +3072,10 @@ VkResult lvp_execute_cmds(struct lvp_device *device,
    /* create a gallium context */
    lvp_execute_cmd_buffer(cmd_buffer, &state);
 
-   state.pctx->flush(state.pctx, fence ? &handle : NULL, 0);
-   if (fence) {
-      mtx_lock(&device->fence_lock);
-      fence->handle = handle;
-      mtx_unlock(&device->fence_lock);
-   }
+   state.pctx->flush(state.pctx, fence, 0);
    state.start_vb = -1;
    state.num_vb = 0;
    state.pctx->set_vertex_buffers(state.pctx, 0, 0, PIPE_MAX_ATTRIBS, false, NULL);
-   state.pctx->bind_vertex_elements_state(state.pctx, NULL);
    state.pctx->bind_vs_state(state.pctx, NULL);
    state.pctx->bind_fs_state(state.pctx, NULL);
    state.pctx->bind_gs_state(state.pctx, NULL);
@@ -3101,31 +3085,16 @@ VkResult lvp_execute_cmds(struct lvp_device *device,
       state.pctx->bind_tes_state(state.pctx, NULL);
    if (state.pctx->bind_compute_state)
       state.pctx->bind_compute_state(state.pctx, NULL);
-   if (state.velems_cso)
-      state.pctx->delete_vertex_elements_state(state.pctx, state.velems_cso);
-
-   state.pctx->bind_rasterizer_state(state.pctx, NULL);
-   state.pctx->delete_rasterizer_state(state.pctx, state.rast_handle);
-   if (state.blend_handle) {
-      state.pctx->bind_blend_state(state.pctx, NULL);
-      state.pctx->delete_blend_state(state.pctx, state.blend_handle);
-   }
-
-   if (state.dsa_handle) {
-      state.pctx->bind_depth_stencil_alpha_state(state.pctx, NULL);
-      state.pctx->delete_depth_stencil_alpha_state(state.pctx, state.dsa_handle);
-   }
 
+   /* The blend, rasterizer, dsa, vertex elements and sampler CSOs stay
+    * bound, they belong to the queue's cso context and are likely to be
+    * used again by the next command buffer.
+    */
    for (enum pipe_shader_type s = PIPE_SHADER_VERTEX; s < PIPE_SHADER_TYPES; s++) {
       for (unsigned i = 0; i < PIPE_MAX_SAMPLERS; i++) {
          if (state.sv[s][i])
             pipe_sampler_view_reference(&state.sv[s][i], NULL);
-         if (state.ss_cso[s][i]) {
-            state.pctx->delete_sampler_state(state.pctx, state.ss_cso[s][i]);
-            state.ss_cso[s][i] = NULL;
-         }
       }
-      state.pctx->bind_sampler_states(state.pctx, s, 0, PIPE_MAX_SAMPLERS, state.ss_cso[s]);
 
       state.pctx->set_shader_images(state.pctx, s, 0, 0, device->physical_device->max_images, NULL);
 
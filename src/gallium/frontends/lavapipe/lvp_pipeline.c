@@ -30,6 +30,7 @@
 #include "pipe/p_state.h"
 #include "pipe/p_context.h"
 #include "nir/nir_xfb_info.h"
+#include "util/mesa-sha1.h"
 
 #define SPIR_V_MAGIC_NUMBER 0x07230203
 
@@ -400,8 +401,51 @@ shared_var_info(const struct glsl_type *type, unsigned *size, unsigned *align)
          progress |= this_progress;                               \
       } while(0)
 
+/* Everything the NIR coming out of lvp_shader_compile_to_ir() depends on,
+ * besides the driver build which is covered by the cache uuid.
+ */
+static void
+lvp_hash_shader(unsigned char *sha1,
+                const struct lvp_pipeline_layout *layout,
+                const struct vk_shader_module *module,
+                const char *entrypoint_name,
+                gl_shader_stage stage,
+                const VkSpecializationInfo *spec_info)
+{
+   struct mesa_sha1 ctx;
+
+   _mesa_sha1_init(&ctx);
+   _mesa_sha1_update(&ctx, module->sha1, sizeof(module->sha1));
+   _mesa_sha1_update(&ctx, entrypoint_name, strlen(entrypoint_name));
+   _mesa_sha1_update(&ctx, &stage, sizeof(stage));
+   if (spec_info && spec_info->mapEntryCount > 0) {
+      _mesa_sha1_update(&ctx, spec_info->pMapEntries,
+                        spec_info->mapEntryCount * sizeof(*spec_info->pMapEntries));
+      _mesa_sha1_update(&ctx, spec_info->pData, spec_info->dataSize);
+   }
+
+   /* the descriptor indices get baked in by lvp_lower_pipeline_layout() */
+   _mesa_sha1_update(&ctx, &layout->num_sets, sizeof(layout->num_sets));
+   for (unsigned s = 0; s < layout->num_sets; s++) {
+      const struct lvp_descriptor_set_layout *set_layout = layout->set[s].layout;
+
+      _mesa_sha1_update(&ctx, &set_layout->binding_count,
+                        sizeof(set_layout->binding_count));
+      _mesa_sha1_update(&ctx, set_layout->stage, sizeof(set_layout->stage));
+      for (unsigned b = 0; b < set_layout->binding_count; b++) {
+         const struct lvp_descriptor_set_binding_layout *binding =
+            &set_layout->binding[b];
+
+         _mesa_sha1_update(&ctx, &binding->type, sizeof(binding->type));
+         _mesa_sha1_update(&ctx, binding->stage, sizeof(binding->stage));
+      }
+   }
+   _mesa_sha1_final(&ctx, sha1);
+}
+
 static void
 lvp_shader_compile_to_ir(struct lvp_pipeline *pipeline,
+                         struct lvp_pipeline_cache *cache,
                          struct vk_shader_module *module,
                          const char *entrypoint_name,
                          gl_shader_stage stage,
@@ -410,7 +454,19 @@ lvp_shader_compile_to_ir(struct lvp_pipeline *pipeline,
    nir_shader *nir;
    const nir_shader_compiler_options *drv_options = pipeline->device->pscreen->get_compiler_options(pipeline->device->pscreen, PIPE_SHADER_IR_NIR, st_shader_stage_to_ptarget(stage));
    bool progress;
+   unsigned char sha1[20];
    uint32_t *spirv = (uint32_t *) module->data;
+
+   if (cache) {
+      lvp_hash_shader(sha1, pipeline->layout, module, entrypoint_name,
+                      stage, spec_info);
+      nir = lvp_pipeline_cache_search_nir(cache, sha1, drv_options);
+      if (nir) {
+         pipeline->pipeline_nir[stage] = nir;
+         return;
+      }
+   }
+
    assert(spirv[0] == SPIR_V_MAGIC_NUMBER);
    assert(module->size % 4 == 0);
 
@@ -584,6 +640,9 @@ lvp_shader_compile_to_ir(struct lvp_pipeline *pipeline,
    nir_assign_io_var_locations(nir, nir_var_shader_out, &nir->num_outputs,
                                nir->info.stage);
    pipeline->pipeline_nir[stage] = nir;
+
+   if (cache)
+      lvp_pipeline_cache_upload_nir(cache, sha1, nir);
 }
 
 static void fill_shader_prog(struct pipe_shader_state *state, gl_shader_stage stage, struct lvp_pipeline *pipeline)
@@ -747,7 +806,7 @@ lvp_graphics_pipeline_init(struct lvp_pipeline *pipeline,
       VK_FROM_HANDLE(vk_shader_module, module,
                       pCreateInfo->pStages[i].module);
       gl_shader_stage stage = lvp_shader_stage(pCreateInfo->pStages[i].stage);
-      lvp_shader_compile_to_ir(pipeline, module,
+      lvp_shader_compile_to_ir(pipeline, cache, module,
                                pCreateInfo->pStages[i].pName,
                                stage,
                                pCreateInfo->pStages[i].pSpecializationInfo);
@@ -872,7 +931,7 @@ lvp_compute_pipeline_init(struct lvp_pipeline *pipeline,
                                  &pipeline->compute_create_info, pCreateInfo);
    pipeline->is_compute_pipeline = true;
 
-   lvp_shader_compile_to_ir(pipeline, module,
+   lvp_shader_compile_to_ir(pipeline, cache, module,
                             pCreateInfo->stage.pName,
                             MESA_SHADER_COMPUTE,
                             pCreateInfo->stage.pSpecializationInfo);
@@ -22,6 +22,135 @@
  */
 
 #include "lvp_private.h"
+#include "util/blob.h"
+#include "util/hash_table.h"
+#include "nir/nir_serialize.h"
+
+#define LVP_CACHE_HEADER_SIZE 32
+
+struct cache_entry {
+   unsigned char sha1[20];
+   uint32_t size;
+   char data[0];
+};
+
+static uint32_t
+entry_hash(const void *key)
+{
+   /* the key is a sha1 already */
+   uint32_t hash;
+   memcpy(&hash, key, sizeof(hash));
+   return hash;
+}
+
+static bool
+entry_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, 20) == 0;
+}
+
+/* Takes the cache mutex.  An entry for the same sha1 already in the cache
+ * wins, since both describe the same shader.
+ */
+static void
+cache_add_entry(struct lvp_pipeline_cache *cache,
+                const unsigned char *sha1,
+                const void *data, uint32_t size)
+{
+   struct cache_entry *entry;
+
+   mtx_lock(&cache->mutex);
+   if (_mesa_hash_table_search(cache->nir_cache, sha1)) {
+      mtx_unlock(&cache->mutex);
+      return;
+   }
+
+   entry = vk_alloc(&cache->alloc, sizeof(*entry) + size, 8,
+                    VK_SYSTEM_ALLOCATION_SCOPE_CACHE);
+   if (entry) {
+      memcpy(entry->sha1, sha1, sizeof(entry->sha1));
+      entry->size = size;
+      memcpy(entry->data, data, size);
+      _mesa_hash_table_insert(cache->nir_cache, entry->sha1, entry);
+   }
+   mtx_unlock(&cache->mutex);
+}
+
+nir_shader *
+lvp_pipeline_cache_search_nir(struct lvp_pipeline_cache *cache,
+                              const unsigned char *sha1,
+                              const nir_shader_compiler_options *options)
+{
+   struct hash_entry *he;
+   nir_shader *nir = NULL;
+
+   if (!cache)
+      return NULL;
+
+   mtx_lock(&cache->mutex);
+   he = _mesa_hash_table_search(cache->nir_cache, sha1);
+   if (he) {
+      struct cache_entry *entry = he->data;
+      struct blob_reader blob;
+
+      blob_reader_init(&blob, entry->data, entry->size);
+      nir = nir_deserialize(NULL, options, &blob);
+   }
+   mtx_unlock(&cache->mutex);
+
+   return nir;
+}
+
+void
+lvp_pipeline_cache_upload_nir(struct lvp_pipeline_cache *cache,
+                              const unsigned char *sha1,
+                              const nir_shader *nir)
+{
+   struct blob blob;
+
+   if (!cache)
+      return;
+
+   blob_init(&blob);
+   nir_serialize(&blob, nir, true);
+   if (!blob.out_of_memory)
+      cache_add_entry(cache, sha1, blob.data, blob.size);
+   blob_finish(&blob);
+}
+
+static void
+lvp_pipeline_cache_load(struct lvp_pipeline_cache *cache,
+                        const void *data, size_t size)
+{
+   struct blob_reader blob;
+   uint32_t header[LVP_CACHE_HEADER_SIZE / 4];
+   uint8_t uuid[VK_UUID_SIZE];
+
+   if (size < LVP_CACHE_HEADER_SIZE)
+      return;
+
+   /* Anything that doesn't come from this very build is ignored */
+   memcpy(header, data, sizeof(header));
+   lvp_device_get_cache_uuid(uuid);
+   if (header[0] < LVP_CACHE_HEADER_SIZE ||
+       header[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+       header[2] != VK_VENDOR_ID_MESA ||
+       header[3] != 0 ||
+       memcmp(&header[4], uuid, VK_UUID_SIZE) != 0 ||
+       header[0] > size)
+      return;
+
+   blob_reader_init(&blob, (const char *)data + header[0], size - header[0]);
+   while (blob.current < blob.end) {
+      const unsigned char *sha1 = blob_read_bytes(&blob, 20);
+      uint32_t entry_size = blob_read_uint32(&blob);
+      const void *entry_data = blob_read_bytes(&blob, entry_size);
+
+      if (blob.overrun)
+         break;
+      cache_add_entry(cache, sha1, entry_data, entry_size);
+   }
+}
 
 VKAPI_ATTR VkResult VKAPI_CALL lvp_CreatePipelineCache(
     VkDevice                                    _device,
@@ -49,6 +178,18 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_CreatePipelineCache(
      cache->alloc = device->vk.alloc;
 
    cache->device = device;
+   cache->nir_cache = _mesa_hash_table_create(NULL, entry_hash, entry_equal);
+   if (cache->nir_cache == NULL) {
+      vk_object_base_finish(&cache->base);
+      vk_free2(&device->vk.alloc, pAllocator, cache);
+      return vk_error(device->instance, VK_ERROR_OUT_OF_HOST_MEMORY);
+   }
+   mtx_init(&cache->mutex, mtx_plain);
+
+   if (pCreateInfo->initialDataSize)
+      lvp_pipeline_cache_load(cache, pCreateInfo->pInitialData,
+                              pCreateInfo->initialDataSize);
+
    *pPipelineCache = lvp_pipeline_cache_to_handle(cache);
 
    return VK_SUCCESS;
@@ -64,7 +205,12 @@ VKAPI_ATTR void VKAPI_CALL lvp_DestroyPipelineCache(
 
    if (!_cache)
       return;
-//   lvp_pipeline_cache_finish(cache);
+
+   hash_table_foreach(cache->nir_cache, he)
+      vk_free(&cache->alloc, he->data);
+   _mesa_hash_table_destroy(cache->nir_cache, NULL);
+   mtx_destroy(&cache->mutex);
+
    vk_object_base_finish(&cache->base);
    vk_free2(&device->vk.alloc, pAllocator, cache);
 }
@@ -75,21 +221,47 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_GetPipelineCacheData(
         size_t*                                     pDataSize,
         void*                                       pData)
 {
+   LVP_FROM_HANDLE(lvp_pipeline_cache, cache, _cache);
    VkResult result = VK_SUCCESS;
+   struct blob blob;
+
    if (pData) {
-      if (*pDataSize < 32) {
+      if (*pDataSize < LVP_CACHE_HEADER_SIZE) {
          *pDataSize = 0;
+         return VK_INCOMPLETE;
+      }
+      blob_init_fixed(&blob, pData, *pDataSize);
+   } else {
+      blob_init_fixed(&blob, NULL, SIZE_MAX);
+   }
+
+   uint32_t header[LVP_CACHE_HEADER_SIZE / 4];
+   header[0] = LVP_CACHE_HEADER_SIZE;
+   header[1] = VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+   header[2] = VK_VENDOR_ID_MESA;
+   header[3] = 0;
+   lvp_device_get_cache_uuid(&header[4]);
+   blob_write_bytes(&blob, header, sizeof(header));
+
+   mtx_lock(&cache->mutex);
+   hash_table_foreach(cache->nir_cache, he) {
+      const struct cache_entry *entry = he->data;
+      size_t start = blob.size;
+
+      /* Only whole entries may be returned */
+      if (!blob_write_bytes(&blob, entry->sha1, sizeof(entry->sha1)) ||
+          !blob_write_uint32(&blob, entry->size) ||
+          !blob_write_bytes(&blob, entry->data, entry->size)) {
+         blob.size = start;
          result = VK_INCOMPLETE;
-      } else {
-         uint32_t *hdr = (uint32_t *)pData;
-         hdr[0] = 32;
-         hdr[1] = 1;
-         hdr[2] = VK_VENDOR_ID_MESA;
-         hdr[3] = 0;
-         lvp_device_get_cache_uuid(&hdr[4]);
+         break;
       }
-   } else
-      *pDataSize = 32;
+   }
+   mtx_unlock(&cache->mutex);
+
+   *pDataSize = blob.size;
+   blob_finish(&blob);
+
    return result;
 }
 
@@ -99,5 +271,18 @@ VKAPI_ATTR VkResult VKAPI_CALL lvp_MergePipelineCaches(
         uint32_t                                    srcCacheCount,
         const VkPipelineCache*                      pSrcCaches)
 {
+   LVP_FROM_HANDLE(lvp_pipeline_cache, dst, destCache);
+
+   for (uint32_t i = 0; i < srcCacheCount; i++) {
+      LVP_FROM_HANDLE(lvp_pipeline_cache, src, pSrcCaches[i]);
+
+      mtx_lock(&src->mutex);
+      hash_table_foreach(src->nir_cache, he) {
+         const struct cache_entry *entry = he->data;
+         cache_add_entry(dst, entry->sha1, entry->data, entry->size);
+      }
+      mtx_unlock(&src->mutex);
+   }
+
    return VK_SUCCESS;
 }
@@ -35,6 +35,7 @@
 #include "compiler/shader_enums.h"
 #include "pipe/p_screen.h"
 #include "pipe/p_state.h"
+#include "cso_cache/cso_context.h"
 #include "nir.h"
 
 /* Pre-declarations needed for WSI entrypoints */
@@ -174,18 +175,34 @@ struct lvp_queue {
    VkDeviceQueueCreateFlags flags;
    struct lvp_device *                         device;
    struct pipe_context *ctx;
+   struct cso_context *cso;
    bool shutdown;
    thrd_t exec_thread;
    mtx_t m;
    cnd_t new_work;
    struct list_head workqueue;
-   volatile int count;
+
+   /* Serial of the last submission and of the last one the queue thread
+    * is done with, and the pipe fence of the latter.  Protected by
+    * lvp_device::fence_lock.
+    */
+   uint64_t timeline;
+   uint64_t last_finished;
+   struct pipe_fence_handle *last_fence;
 };
 
 struct lvp_queue_work {
    struct list_head list;
+   uint64_t timeline;
    uint32_t cmd_buffer_count;
+   uint32_t wait_count;
+   uint32_t signal_count;
    struct lvp_cmd_buffer **cmd_buffers;
+   /* timeline semaphores only, binary ones are ordered by the queue */
+   struct lvp_semaphore **waits;
+   uint64_t *wait_values;
+   struct lvp_semaphore **signals;
+   uint64_t *signal_values;
    struct lvp_fence *fence;
 };
 
@@ -193,8 +210,23 @@ struct lvp_pipeline_cache {
    struct vk_object_base                        base;
    struct lvp_device *                          device;
    VkAllocationCallbacks                        alloc;
+
+   /* Serialized NIR of the lowered shader stages, keyed by the sha1 of
+    * everything that went into lowering them.
+    */
+   mtx_t                                        mutex;
+   struct hash_table *                          nir_cache;
 };
 
+nir_shader *
+lvp_pipeline_cache_search_nir(struct lvp_pipeline_cache *cache,
+                              const unsigned char *sha1,
+                              const nir_shader_compiler_options *options);
+void
+lvp_pipeline_cache_upload_nir(struct lvp_pipeline_cache *cache,
+                              const unsigned char *sha1,
+                              const nir_shader *nir);
+
 struct lvp_device {
    struct vk_device vk;
 
@@ -204,6 +236,8 @@ struct lvp_device {
    struct pipe_screen *pscreen;
 
    mtx_t fence_lock;
+   /* broadcast whenever the queue timeline or a timeline semaphore moves on */
+   cnd_t timeline_cond;
 };
 
 void lvp_device_get_cache_uuid(void *uuid);
@@ -494,12 +528,16 @@ struct lvp_event {
 struct lvp_fence {
    struct vk_object_base base;
    bool signaled;
+   /* queue serial of the submission signalling the fence, 0 if none */
+   uint64_t timeline;
    struct pipe_fence_handle *handle;
 };
 
 struct lvp_semaphore {
    struct vk_object_base base;
-   bool dummy;
+   bool is_timeline;
+   /* payload of a timeline semaphore, protected by lvp_device::fence_lock */
+   uint64_t value;
 };
 
 struct lvp_buffer {
@@ -538,6 +576,7 @@ struct lvp_cmd_pool {
    VkAllocationCallbacks                        alloc;
    struct list_head                             cmd_buffers;
    struct list_head                             free_cmd_buffers;
+   struct list_head                             free_cmd_chunks;
 };
 
 
@@ -561,6 +600,7 @@ struct lvp_cmd_buffer {
 
    struct list_head                             cmds;
    struct list_head                            *last_emit;
+   struct list_head                             cmd_chunks;
 
    uint8_t push_constants[MAX_PUSH_CONSTANTS_SIZE];
 };
@@ -1050,6 +1090,9 @@ struct lvp_cmd_set_stencil_op {
    VkCompareOp compare_op;
 };
 
+/* Only the part of the union used by cmd_type (plus any extra data) is
+ * allocated, see cmd_buf_entry_alloc_size().
+ */
 struct lvp_cmd_buffer_entry {
    struct list_head cmd_link;
    uint32_t cmd_type;
@@ -1111,7 +1154,7 @@ struct lvp_cmd_buffer_entry {
 
 VkResult lvp_execute_cmds(struct lvp_device *device,
                           struct lvp_queue *queue,
-                          struct lvp_fence *fence,
+                          struct pipe_fence_handle **fence,
                           struct lvp_cmd_buffer *cmd_buffer);
 
 enum pipe_format vk_format_to_pipe(VkFormat format);
@@ -168,6 +168,7 @@ VA_DRIVER_INIT_FUNC(VADriverContextP ctx)
    if (!vl_compositor_set_csc_matrix(&drv->cstate, (const vl_csc_matrix *)&drv->csc, 1.0f, 0.0f))
       goto error_csc_matrix;
    (void) mtx_init(&drv->mutex, mtx_plain);
+   util_dynarray_init(&drv->surface_pool, NULL);
 
    ctx->pDriverData = (void *)drv;
    ctx->version_major = 0;
@@ -400,6 +401,7 @@ vlVaTerminate(VADriverContextP ctx)
       return VA_STATUS_ERROR_INVALID_CONTEXT;
 
    drv = ctx->pDriverData;
+   vlVaDestroySurfacePool(drv);
    vl_compositor_cleanup_state(&drv->cstate);
    vl_compositor_cleanup(&drv->compositor);
    drv->pipe->destroy(drv->pipe);
@@ -37,6 +37,8 @@
 
 #include "va_private.h"
 
+DEBUG_GET_ONCE_BOOL_OPTION(low_latency_encode, "VAAPI_LOW_LATENCY_ENCODE", false)
+
 VAStatus
 vlVaBeginPicture(VADriverContextP ctx, VAContextID context_id, VASurfaceID render_target)
 {
@@ -758,19 +760,28 @@ vlVaEndPicture(VADriverContextP ctx, VAContextID context_id)
       int p_remain_in_idr = idr_period - context->desc.h264enc.frame_num;
       surf->frame_num_cnt = context->desc.h264enc.frame_num_cnt;
       surf->force_flushed = false;
-      if (context->first_single_submitted) {
+      if (debug_get_option_low_latency_encode()) {
+         /* Submit every frame on its own instead of pairing two frames per
+          * submission, so the coded buffer is ready one frame earlier.
+          */
          context->decoder->flush(context->decoder);
          context->first_single_submitted = false;
          surf->force_flushed = true;
-      }
-      if (p_remain_in_idr == 1) {
-         if ((context->desc.h264enc.frame_num_cnt % 2) != 0) {
+      } else {
+         if (context->first_single_submitted) {
             context->decoder->flush(context->decoder);
-            context->first_single_submitted = true;
-         }
-         else
             context->first_single_submitted = false;
-         surf->force_flushed = true;
+            surf->force_flushed = true;
+         }
+         if (p_remain_in_idr == 1) {
+            if ((context->desc.h264enc.frame_num_cnt % 2) != 0) {
+               context->decoder->flush(context->decoder);
+               context->first_single_submitted = true;
+            }
+            else
+               context->first_single_submitted = false;
+            surf->force_flushed = true;
+         }
       }
    } else if (context->decoder->entrypoint == PIPE_VIDEO_ENTRYPOINT_ENCODE &&
               u_reduce_video_profile(context->templat.profile) == PIPE_VIDEO_FORMAT_HEVC)
@@ -52,6 +52,94 @@ static const enum pipe_format vpp_surface_formats[] = {
    PIPE_FORMAT_B8G8R8X8_UNORM, PIPE_FORMAT_R8G8B8X8_UNORM
 };
 
+/* Upper bound on the number of idle video buffers kept for reuse */
+#define VL_VA_SURFACE_POOL_SIZE 16
+
+typedef struct {
+   struct pipe_video_buffer templat;
+   struct pipe_video_buffer *buffer;
+} vlVaPooledBuffer;
+
+static bool
+vlVaPooledBufferMatches(const struct pipe_video_buffer *a,
+                        const struct pipe_video_buffer *b)
+{
+   return a->buffer_format == b->buffer_format &&
+          a->width == b->width &&
+          a->height == b->height &&
+          a->interlaced == b->interlaced &&
+          a->bind == b->bind;
+}
+
+static void
+vlVaRemovePooledBuffer(vlVaDriver *drv, vlVaPooledBuffer *entry)
+{
+   vlVaPooledBuffer *last =
+      util_dynarray_pop_ptr(&drv->surface_pool, vlVaPooledBuffer);
+
+   if (entry != last)
+      *entry = *last;
+}
+
+/* Keep the buffer of a destroyed surface around, so that applications that
+ * recreate surfaces of the same size and format (e.g. per encode segment)
+ * don't have to reallocate them. Must be called with drv->mutex held.
+ */
+static void
+vlVaReleaseSurfaceBuffer(vlVaDriver *drv, vlVaSurface *surf)
+{
+   vlVaPooledBuffer *entry;
+
+   if (!surf->buffer)
+      return;
+
+   if (surf->shared) {
+      surf->buffer->destroy(surf->buffer);
+      surf->buffer = NULL;
+      return;
+   }
+
+   /* Make room by dropping an arbitrary buffer when the pool is full */
+   if (util_dynarray_num_elements(&drv->surface_pool, vlVaPooledBuffer) >=
+       VL_VA_SURFACE_POOL_SIZE) {
+      entry = util_dynarray_begin(&drv->surface_pool);
+      entry->buffer->destroy(entry->buffer);
+      vlVaRemovePooledBuffer(drv, entry);
+   }
+
+   entry = util_dynarray_grow(&drv->surface_pool, vlVaPooledBuffer, 1);
+   if (!entry) {
+      surf->buffer->destroy(surf->buffer);
+   } else {
+      entry->templat = surf->templat;
+      entry->buffer = surf->buffer;
+   }
+   surf->buffer = NULL;
+}
+
+static struct pipe_video_buffer *
+vlVaTakePooledBuffer(vlVaDriver *drv, const struct pipe_video_buffer *templat)
+{
+   util_dynarray_foreach(&drv->surface_pool, vlVaPooledBuffer, entry) {
+      if (vlVaPooledBufferMatches(&entry->templat, templat)) {
+         struct pipe_video_buffer *buffer = entry->buffer;
+
+         vlVaRemovePooledBuffer(drv, entry);
+         return buffer;
+      }
+   }
+
+   return NULL;
+}
+
+void
+vlVaDestroySurfacePool(vlVaDriver *drv)
+{
+   util_dynarray_foreach(&drv->surface_pool, vlVaPooledBuffer, entry)
+      entry->buffer->destroy(entry->buffer);
+   util_dynarray_fini(&drv->surface_pool);
+}
+
 VAStatus
 vlVaCreateSurfaces(VADriverContextP ctx, int width, int height, int format,
                    int num_surfaces, VASurfaceID *surfaces)
@@ -77,8 +165,7 @@ vlVaDestroySurfaces(VADriverContextP ctx, VASurfaceID *surface_list, int num_sur
          mtx_unlock(&drv->mutex);
          return VA_STATUS_ERROR_INVALID_SURFACE;
       }
-      if (surf->buffer)
-         surf->buffer->destroy(surf->buffer);
+      vlVaReleaseSurfaceBuffer(drv, surf);
       util_dynarray_fini(&surf->subpics);
       FREE(surf);
       handle_table_remove(drv->htab, surface_list[i]);
@@ -646,7 +733,9 @@ vlVaHandleSurfaceAllocate(vlVaDriver *drv, vlVaSurface *surface,
    struct pipe_surface **surfaces;
    unsigned i;
 
-   surface->buffer = drv->pipe->create_video_buffer(drv->pipe, templat);
+   surface->buffer = vlVaTakePooledBuffer(drv, templat);
+   if (!surface->buffer)
+      surface->buffer = drv->pipe->create_video_buffer(drv->pipe, templat);
    if (!surface->buffer)
       return VA_STATUS_ERROR_ALLOCATION_FAILED;
 
@@ -811,8 +900,10 @@ vlVaCreateSurfaces2(VADriverContextP ctx, unsigned int format,
           * null memory_attribute means VASurfaceAttribExternalBuffers is used.
           */
          if (memory_attribute &&
-             !(memory_attribute->flags & VA_SURFACE_EXTBUF_DESC_ENABLE_TILING))
+             !(memory_attribute->flags & VA_SURFACE_EXTBUF_DESC_ENABLE_TILING)) {
             templat.bind = PIPE_BIND_LINEAR | PIPE_BIND_SHARED;
+            surf->shared = true;
+         }
 
 	 vaStatus = vlVaHandleSurfaceAllocate(drv, surf, &templat);
          if (vaStatus != VA_STATUS_SUCCESS)
@@ -823,6 +914,7 @@ vlVaCreateSurfaces2(VADriverContextP ctx, unsigned int format,
          vaStatus = surface_from_external_memory(ctx, surf, memory_attribute, i, &templat);
          if (vaStatus != VA_STATUS_SUCCESS)
             goto free_surf;
+         surf->shared = true;
          break;
 
       default:
@@ -1061,6 +1153,9 @@ vlVaExportSurfaceHandle(VADriverContextP ctx,
       interlaced->destroy(interlaced);
    }
 
+   /* The exported memory can outlive the surface */
+   surf->shared = true;
+
    surfaces = surf->buffer->get_surfaces(surf->buffer);
 
    usage = 0;
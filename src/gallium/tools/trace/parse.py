@@ -192,6 +192,7 @@ class TraceParser(XmlParser):
     def __init__(self, fp):
         XmlParser.__init__(self, fp)
         self.last_call_no = 0
+        self.blobs = {}
     
     def parse(self):
         self.element_start('trace')
@@ -303,9 +304,19 @@ class TraceParser(XmlParser):
         return Literal(value)
         
     def parse_bytes(self):
-        self.element_start('bytes')
+        attrs = self.element_start('bytes')
         value = self.character_data()
         self.element_end('bytes')
+        # Compact traces only dump the contents of a blob the first time
+        try:
+            blob_hash = attrs['hash']
+        except KeyError:
+            pass
+        else:
+            if value:
+                self.blobs[blob_hash] = value
+            else:
+                value = self.blobs[blob_hash]
         return Blob(value)
         
     def parse_array(self):
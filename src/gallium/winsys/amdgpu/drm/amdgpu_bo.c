@@ -245,10 +245,13 @@ static void amdgpu_bo_destroy_or_cache(struct pb_buffer *_buf)
 
 static void amdgpu_clean_up_buffer_managers(struct amdgpu_winsys *ws)
 {
+   /* Smaller slabs are allocated from bigger slabs, so this order frees
+    * the most.
+    */
    for (unsigned i = 0; i < NUM_SLAB_ALLOCATORS; i++) {
-      pb_slabs_reclaim(&ws->bo_slabs[i]);
+      pb_slabs_free_empty(&ws->bo_slabs[i]);
       if (ws->info.has_tmz_support)
-         pb_slabs_reclaim(&ws->bo_slabs_encrypted[i]);
+         pb_slabs_free_empty(&ws->bo_slabs_encrypted[i]);
    }
 
    pb_cache_release_all_buffers(&ws->bo_cache);
@@ -805,6 +808,8 @@ static struct pb_slab *amdgpu_bo_slab_alloc(void *priv, unsigned heap,
       list_addtail(&bo->u.slab.entry.head, &slab->base.free);
    }
 
+   ws->num_slabs_created++;
+
    /* Wasted alignment due to slabs with 3/4 allocations being aligned to a power of two. */
    assert(slab->base.num_entries * entry_size <= slab_size);
    if (domains & RADEON_DOMAIN_VRAM)
@@ -1427,6 +1432,7 @@ amdgpu_bo_create(struct amdgpu_winsys *ws,
       pipe_reference_init(&bo->base.reference, 1);
       bo->base.size = size;
       assert(alignment <= bo->base.alignment);
+      ws->num_slab_allocs++;
 
       if (domain & RADEON_DOMAIN_VRAM)
          ws->slab_wasted_vram += get_slab_wasted_size(bo);
@@ -971,6 +971,9 @@ amdgpu_cs_create(struct radeon_cmdbuf *rcs,
    cs->flush_cs = flush;
    cs->flush_data = flush_ctx;
    cs->ring_type = ring_type;
+   cs->queue = &ctx->ws->cs_queue[ring_type == RING_GFX ? AMDGPU_CS_QUEUE_GFX :
+                                  ring_type == RING_COMPUTE ? AMDGPU_CS_QUEUE_COMPUTE :
+                                                              AMDGPU_CS_QUEUE_OTHER];
    cs->stop_exec_on_failure = stop_exec_on_failure;
    cs->noop = ctx->ws->noop_cs;
 
@@ -1427,6 +1430,19 @@ static bool amdgpu_add_sparse_backing_buffers(struct amdgpu_cs_context *cs)
    return true;
 }
 
+/* Dependencies on other rings can still be queued in the submission threads
+ * of those rings. Wait until they have been submitted and have a sequence
+ * number.
+ */
+static void amdgpu_fence_list_wait_submitted(struct amdgpu_fence_list *fences)
+{
+   for (unsigned i = 0; i < fences->num; i++) {
+      struct amdgpu_fence *fence = (struct amdgpu_fence*)fences->list[i];
+
+      util_queue_fence_wait(&fence->submitted);
+   }
+}
+
 static void amdgpu_cs_submit_ib(void *job, int thread_index)
 {
    struct amdgpu_cs *acs = (struct amdgpu_cs*)job;
@@ -1440,6 +1456,11 @@ static void amdgpu_cs_submit_ib(void *job, int thread_index)
    struct drm_amdgpu_bo_list_in bo_list_in;
    unsigned initial_num_real_buffers = cs->num_real_buffers;
 
+   amdgpu_fence_list_wait_submitted(&cs->fence_dependencies);
+   amdgpu_fence_list_wait_submitted(&cs->syncobj_dependencies);
+   amdgpu_fence_list_wait_submitted(&cs->compute_fence_dependencies);
+   amdgpu_fence_list_wait_submitted(&cs->compute_start_fence_dependencies);
+
 #if DEBUG
    /* Prepare the buffer list. */
    if (ws->debug_all_bos) {
@@ -1837,7 +1858,10 @@ static int amdgpu_cs_flush(struct radeon_cmdbuf *rcs,
        *
        * This fence must be held until the submission is queued to ensure
        * that the order of fence dependency updates matches the order of
-       * submissions.
+       * submissions. Submissions to other rings are executed by other
+       * threads, but this order guarantees that a dependency has been
+       * queued before the submission that waits for it in
+       * amdgpu_cs_submit_ib, so the threads can't deadlock.
        */
       simple_mtx_lock(&ws->bo_fence_lock);
       amdgpu_add_fence_dependencies_bo_lists(cs);
@@ -1847,7 +1871,7 @@ static int amdgpu_cs_flush(struct radeon_cmdbuf *rcs,
       cs->cst = cur;
 
       /* Submit. */
-      util_queue_add_job(&ws->cs_queue, cs, &cs->flush_completed,
+      util_queue_add_job(cs->queue, cs, &cs->flush_completed,
                          amdgpu_cs_submit_ib, NULL, 0);
 
       if (flags & RADEON_FLUSH_TOGGLE_SECURE_SUBMISSION)
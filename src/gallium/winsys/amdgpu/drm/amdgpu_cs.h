@@ -133,6 +133,7 @@ struct amdgpu_cs {
    struct amdgpu_ib compute_ib;      /* optional parallel compute IB */
    struct amdgpu_ctx *ctx;
    enum ring_type ring_type;
+   struct util_queue *queue; /* the submission thread of the ring */
    struct drm_amdgpu_cs_chunk_fence fence_chunk;
 
    /* We flip between these two CS. While one is being consumed
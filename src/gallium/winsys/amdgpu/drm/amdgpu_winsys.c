@@ -132,8 +132,10 @@ static void do_winsys_deinit(struct amdgpu_winsys *ws)
    if (ws->reserve_vmid)
       amdgpu_vm_unreserve_vmid(ws->dev, 0);
 
-   if (util_queue_is_initialized(&ws->cs_queue))
-      util_queue_destroy(&ws->cs_queue);
+   for (unsigned i = 0; i < AMDGPU_NUM_CS_QUEUES; i++) {
+      if (util_queue_is_initialized(&ws->cs_queue[i]))
+         util_queue_destroy(&ws->cs_queue[i]);
+   }
 
    simple_mtx_destroy(&ws->bo_fence_lock);
    for (unsigned i = 0; i < NUM_SLAB_ALLOCATORS; i++) {
@@ -227,6 +229,10 @@ static uint64_t amdgpu_query_value(struct radeon_winsys *rws,
       return ws->slab_wasted_vram;
    case RADEON_SLAB_WASTED_GTT:
       return ws->slab_wasted_gtt;
+   case RADEON_NUM_SLAB_ALLOCS:
+      return ws->num_slab_allocs;
+   case RADEON_NUM_SLABS_CREATED:
+      return ws->num_slabs_created;
    case RADEON_BUFFER_WAIT_TIME_NS:
       return ws->buffer_wait_time;
    case RADEON_NUM_MAPPED_BUFFERS:
@@ -271,7 +277,9 @@ static uint64_t amdgpu_query_value(struct radeon_winsys *rws,
       amdgpu_query_sensor_info(ws->dev, AMDGPU_INFO_SENSOR_GFX_MCLK, 4, &retval);
       return retval;
    case RADEON_CS_THREAD_TIME:
-      return util_queue_get_thread_time_nano(&ws->cs_queue, 0);
+      for (unsigned i = 0; i < AMDGPU_NUM_CS_QUEUES; i++)
+         retval += util_queue_get_thread_time_nano(&ws->cs_queue[i], 0);
+      return retval;
    }
    return 0;
 }
@@ -330,9 +338,11 @@ static void amdgpu_pin_threads_to_L3_cache(struct radeon_winsys *rws,
 {
    struct amdgpu_winsys *ws = amdgpu_winsys(rws);
 
-   util_set_thread_affinity(ws->cs_queue.threads[0],
-                            util_get_cpu_caps()->L3_affinity_mask[cache],
-                            NULL, util_get_cpu_caps()->num_cpu_mask_bits);
+   for (unsigned i = 0; i < AMDGPU_NUM_CS_QUEUES; i++) {
+      util_set_thread_affinity(ws->cs_queue[i].threads[0],
+                               util_get_cpu_caps()->L3_affinity_mask[cache],
+                               NULL, util_get_cpu_caps()->num_cpu_mask_bits);
+   }
 }
 
 static uint32_t kms_handle_hash(const void *key)
@@ -446,7 +456,7 @@ amdgpu_winsys_create(int fd, const struct pipe_screen_config *config,
                     amdgpu_bo_destroy, amdgpu_bo_can_reclaim);
 
       unsigned min_slab_order = 8;  /* 256 bytes */
-      unsigned max_slab_order = 20; /* 1 MB (slab size = 2 MB) */
+      unsigned max_slab_order = 21; /* 2 MB (slab size = 4 MB) */
       unsigned num_slab_orders_per_allocator = (max_slab_order - min_slab_order) /
                                                NUM_SLAB_ALLOCATORS;
 
@@ -481,6 +491,20 @@ amdgpu_winsys_create(int fd, const struct pipe_screen_config *config,
             return NULL;
          }
 
+         /* Keep one empty slab per size for re-use, except for the biggest
+          * VRAM slabs, where keeping memory that nobody uses is too costly.
+          */
+         for (unsigned heap = 0; heap < RADEON_MAX_SLAB_HEAPS; heap++) {
+            unsigned max_empty_slabs =
+               i == NUM_SLAB_ALLOCATORS - 1 &&
+               radeon_domain_from_heap(heap) == RADEON_DOMAIN_VRAM ? 0 : 1;
+
+            pb_slabs_set_max_empty_slabs(&aws->bo_slabs[i], heap, max_empty_slabs);
+            if (aws->info.has_tmz_support)
+               pb_slabs_set_max_empty_slabs(&aws->bo_slabs_encrypted[i], heap,
+                                            max_empty_slabs);
+         }
+
          min_slab_order = max_order + 1;
       }
 
@@ -500,11 +524,19 @@ amdgpu_winsys_create(int fd, const struct pipe_screen_config *config,
       (void) simple_mtx_init(&aws->bo_fence_lock, mtx_plain);
       (void) simple_mtx_init(&aws->bo_export_table_lock, mtx_plain);
 
-      if (!util_queue_init(&aws->cs_queue, "cs", 8, 1,
-                           UTIL_QUEUE_INIT_RESIZE_IF_FULL)) {
-         amdgpu_winsys_destroy(&ws->base);
-         simple_mtx_unlock(&dev_tab_mutex);
-         return NULL;
+      static const char *queue_names[AMDGPU_NUM_CS_QUEUES] = {
+         [AMDGPU_CS_QUEUE_GFX] = "gfx_cs",
+         [AMDGPU_CS_QUEUE_COMPUTE] = "comp_cs",
+         [AMDGPU_CS_QUEUE_OTHER] = "other_cs",
+      };
+
+      for (unsigned i = 0; i < AMDGPU_NUM_CS_QUEUES; i++) {
+         if (!util_queue_init(&aws->cs_queue[i], queue_names[i], 8, 1,
+                              UTIL_QUEUE_INIT_RESIZE_IF_FULL)) {
+            amdgpu_winsys_destroy(&ws->base);
+            simple_mtx_unlock(&dev_tab_mutex);
+            return NULL;
+         }
       }
 
       _mesa_hash_table_insert(dev_tab, dev, aws);
@@ -37,7 +37,17 @@
 
 struct amdgpu_cs;
 
-#define NUM_SLAB_ALLOCATORS 3
+#define NUM_SLAB_ALLOCATORS 4
+
+/* IBs are submitted by a separate thread for each of these groups of rings,
+ * so that a busy ring doesn't delay submissions to the others.
+ */
+enum amdgpu_cs_queue {
+   AMDGPU_CS_QUEUE_GFX,
+   AMDGPU_CS_QUEUE_COMPUTE,
+   AMDGPU_CS_QUEUE_OTHER, /* SDMA and multimedia */
+   AMDGPU_NUM_CS_QUEUES,
+};
 
 struct amdgpu_winsys {
    struct pipe_reference reference;
@@ -68,6 +78,8 @@ struct amdgpu_winsys {
    uint64_t mapped_gtt;
    uint64_t slab_wasted_vram;
    uint64_t slab_wasted_gtt;
+   uint64_t num_slab_allocs; /* buffers suballocated from slabs */
+   uint64_t num_slabs_created; /* slab allocations that needed a new slab */
    uint64_t buffer_wait_time; /* time spent in buffer_wait in ns */
    uint64_t num_gfx_IBs;
    uint64_t num_sdma_IBs;
@@ -77,8 +89,8 @@ struct amdgpu_winsys {
 
    struct radeon_info info;
 
-   /* multithreaded IB submission */
-   struct util_queue cs_queue;
+   /* multithreaded IB submission, one thread for each group of rings */
+   struct util_queue cs_queue[AMDGPU_NUM_CS_QUEUES];
 
    struct amdgpu_gpu_info amdinfo;
    struct ac_addrlib *addrlib;
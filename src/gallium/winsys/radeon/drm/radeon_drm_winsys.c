@@ -733,6 +733,8 @@ static uint64_t radeon_query_value(struct radeon_winsys *rws,
    case RADEON_GFX_IB_SIZE_COUNTER:
    case RADEON_SLAB_WASTED_VRAM:
    case RADEON_SLAB_WASTED_GTT:
+   case RADEON_NUM_SLAB_ALLOCS:
+   case RADEON_NUM_SLABS_CREATED:
       return 0; /* unimplemented */
    case RADEON_VRAM_USAGE:
       radeon_get_drm_value(ws->fd, RADEON_INFO_VRAM_USAGE,
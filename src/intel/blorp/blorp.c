@@ -67,6 +67,7 @@ blorp_batch_init(struct blorp_context *blorp,
    batch->blorp = blorp;
    batch->driver_batch = driver_batch;
    batch->flags = flags;
+   batch->pipeline_valid = false;
 }
 
 void
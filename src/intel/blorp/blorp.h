@@ -78,12 +78,47 @@ enum blorp_batch_flags {
     * color buffer.
     */
    BLORP_BATCH_NO_UPDATE_CLEAR_COLOR = (1 << 2),
+
+   /**
+    * This flag indicates that nothing but blorp touches the 3D pipeline
+    * state between the operations recorded with this batch, so an
+    * operation that needs the same pipeline setup as the previous one only
+    * has to emit its surfaces, vertices and the draw.  Useful for copies
+    * and blits with many regions.
+    */
+   BLORP_BATCH_SHARE_PIPELINE        = (1 << 3),
+};
+
+/**
+ * The subset of an operation's parameters that the 3D pipeline setup
+ * depends on, used to detect when it can be shared with the previous
+ * operation of a batch.
+ */
+struct blorp_pipeline_key {
+   uint32_t vs_prog_kernel;
+   uint32_t sf_prog_kernel;
+   uint32_t wm_prog_kernel;
+   uint32_t depth_format;
+   uint32_t num_samples;
+   uint32_t num_draw_buffers;
+   uint32_t hiz_op;
+   uint32_t fast_clear_op;
+   uint8_t stencil_mask;
+   uint8_t stencil_ref;
+   bool color_write_disable[4];
+   bool src_enabled;
+   bool depth_enabled;
+   bool stencil_enabled;
 };
 
 struct blorp_batch {
    struct blorp_context *blorp;
    void *driver_batch;
    enum blorp_batch_flags flags;
+
+   /** Pipeline emitted by the last operation, see BLORP_BATCH_SHARE_PIPELINE */
+   struct blorp_pipeline_key pipeline;
+   bool pipeline_valid;
 };
 
 void blorp_batch_init(struct blorp_context *blorp, struct blorp_batch *batch,
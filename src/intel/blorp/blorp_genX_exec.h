@@ -1361,6 +1361,46 @@ blorp_emit_pipeline(struct blorp_batch *batch,
 #endif
 }
 
+/**
+ * Check whether the pipeline emitted for the previous operation of the
+ * batch is also right for params, recording params' pipeline otherwise.
+ */
+static bool
+blorp_pipeline_is_current(struct blorp_batch *batch,
+                          const struct blorp_params *params)
+{
+   if (!(batch->flags & BLORP_BATCH_SHARE_PIPELINE))
+      return false;
+
+   struct blorp_pipeline_key key;
+   memset(&key, 0, sizeof(key));
+
+   key.vs_prog_kernel = params->vs_prog_kernel;
+   key.sf_prog_kernel = params->sf_prog_kernel;
+   key.wm_prog_kernel = params->wm_prog_kernel;
+   key.depth_format = params->depth_format;
+   key.num_samples = params->num_samples;
+   key.num_draw_buffers = params->num_draw_buffers;
+   key.hiz_op = params->hiz_op;
+   key.fast_clear_op = params->fast_clear_op;
+   key.stencil_mask = params->stencil_mask;
+   key.stencil_ref = params->stencil_ref;
+   memcpy(key.color_write_disable, params->color_write_disable,
+          sizeof(key.color_write_disable));
+   key.src_enabled = params->src.enabled;
+   key.depth_enabled = params->depth.enabled;
+   key.stencil_enabled = params->stencil.enabled;
+
+   if (batch->pipeline_valid &&
+       memcmp(&batch->pipeline, &key, sizeof(key)) == 0)
+      return true;
+
+   batch->pipeline = key;
+   batch->pipeline_valid = true;
+
+   return false;
+}
+
 /******** This is the end of the pipeline setup code ********/
 
 #endif /* GEN_GEN >= 6 */
@@ -1966,6 +2006,8 @@ blorp_exec(struct blorp_batch *batch, const struct blorp_params *params)
 
 #if GEN_GEN >= 8
    if (params->hiz_op != ISL_AUX_OP_NONE) {
+      /* This leaves the pipeline in a different state. */
+      batch->pipeline_valid = false;
       blorp_emit_gen8_hiz_op(batch, params);
       return;
    }
@@ -1974,7 +2016,8 @@ blorp_exec(struct blorp_batch *batch, const struct blorp_params *params)
    blorp_emit_vertex_buffers(batch, params);
    blorp_emit_vertex_elements(batch, params);
 
-   blorp_emit_pipeline(batch, params);
+   if (!blorp_pipeline_is_current(batch, params))
+      blorp_emit_pipeline(batch, params);
 
    blorp_emit_surface_states(batch, params);
 
@@ -28,6 +28,8 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -53,6 +55,17 @@ static const struct debug_control debug_control[] = {
 };
 static struct intel_measure_config config;
 
+/* Set from the SIGUSR1 handler or the control fifo, and serviced by
+ * intel_measure_gather when history is enabled.
+ */
+static volatile sig_atomic_t dump_requested;
+
+static void
+intel_measure_signal_handler(int sig)
+{
+   dump_requested = 1;
+}
+
 void
 intel_measure_init(struct intel_measure_device *device)
 {
@@ -66,8 +79,6 @@ intel_measure_init(struct intel_measure_device *device)
 
       config.file = stderr;
       config.flags = parse_debug_string(env, debug_control);
-      if (!config.flags)
-         config.flags = INTEL_MEASURE_DRAW;
       config.enabled = true;
       config.event_interval = 1;
       config.control_fh = -1;
@@ -94,6 +105,8 @@ intel_measure_init(struct intel_measure_device *device)
       const char *interval_s = strstr(env, "interval=");
       const char *batch_size_s = strstr(env, "batch_size=");
       const char *buffer_size_s = strstr(env, "buffer_size=");
+      const char *history_s = strstr(env, "history=");
+      const char *trace_path = strstr(env, "trace=");
       while (true) {
          char *sep = strrchr(env, ',');
          if (sep == NULL)
@@ -203,10 +216,53 @@ intel_measure_init(struct intel_measure_device *device)
          config.buffer_size = buffer_size;
       }
 
-      fputs("draw_start,draw_end,frame,batch,"
-            "event_index,event_count,type,count,vs,tcs,tes,"
-            "gs,fs,cs,framebuffer,idle_ns,time_ns\n",
-            config.file);
+      if (history_s) {
+         history_s += 8;
+         const int history_frames = atoi(history_s);
+         if (history_frames <= 0) {
+            fprintf(stderr, "INTEL_MEASURE history must be positive: %d\n",
+                    history_frames);
+            abort();
+         }
+
+         config.history_frames = history_frames;
+         config.trace_path = "intel_measure";
+         if (trace_path && !__check_suid())
+            config.trace_path = trace_path + 6;
+
+         /* history is always collected, unless a start frame was requested.
+          * The control fifo may still pause collection.
+          */
+         if (!start_frame_s)
+            config.enabled = true;
+
+         /* only take over SIGUSR1 if the application has not claimed it */
+         struct sigaction action;
+         if (sigaction(SIGUSR1, NULL, &action) == 0 &&
+             action.sa_handler == SIG_DFL) {
+            memset(&action, 0, sizeof(action));
+            action.sa_handler = intel_measure_signal_handler;
+            action.sa_flags = SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGUSR1, &action, NULL);
+         }
+      }
+
+      /* Per-renderpass timing is cheap enough to leave running, so it is the
+       * default when keeping history.
+       */
+      if (!config.flags) {
+         config.flags = config.history_frames ?
+            INTEL_MEASURE_RENDERPASS : INTEL_MEASURE_DRAW;
+      }
+
+      /* history mode writes traces on demand instead of a csv stream */
+      if (config.history_frames == 0) {
+         fputs("draw_start,draw_end,frame,batch,"
+               "event_index,event_count,type,count,vs,tcs,tes,"
+               "gs,fs,cs,framebuffer,idle_ns,time_ns\n",
+               config.file);
+      }
    }
 
    device->config = NULL;
@@ -343,6 +399,16 @@ intel_measure_frame_transition(unsigned frame)
          buf[bytes] = '\0';
          char *nptr = buf, *endptr = buf;
          while (*nptr != '\0' && *endptr != '\0') {
+            if (strncmp(nptr, "dump", 4) == 0) {
+               /* write out the retained history at the next gather */
+               dump_requested = 1;
+               endptr = nptr + 4;
+               if (*endptr == '\0')
+                  break;
+               nptr = endptr + 1;
+               continue;
+            }
+
             long fcount = strtol(nptr, &endptr, 10);
             if (nptr == endptr) {
                config.enabled = false;
@@ -422,7 +488,11 @@ intel_measure_push_result(struct intel_measure_device *device,
       /* advance ring buffer */
       if (++rb->head == config.buffer_size)
          rb->head = 0;
-      if (rb->head == rb->tail) {
+      if (rb->head == rb->tail && config.history_frames) {
+         /* history keeps the most recent results, drop the oldest */
+         if (++rb->tail == config.buffer_size)
+            rb->tail = 0;
+      } else if (rb->head == rb->tail) {
          static bool warned = false;
          if (unlikely(!warned)) {
             fprintf(config.file,
@@ -605,6 +675,83 @@ print_combined_results(struct intel_measure_device *measure_device,
            gen_device_info_timebase_scale(info, duration_ts));
 }
 
+/**
+ * Drop results that are older than the configured number of history frames.
+ */
+static void
+intel_measure_trim_history(struct intel_measure_device *device)
+{
+   struct intel_measure_ringbuffer *rb = device->ringbuffer;
+   if (ringbuffer_size(rb) == 0)
+      return;
+
+   const unsigned latest_frame = rb->results[rb->head].frame;
+   while (ringbuffer_size(rb) > 0) {
+      /* Imperfect frame tracking requires us to allow for *older* frames
+       * following newer ones, so stop at the first result that is recent
+       * enough.
+       */
+      if (ringbuffer_peek(rb, 0)->frame + config.history_frames > latest_frame)
+         break;
+      ringbuffer_pop(rb);
+   }
+}
+
+/**
+ * Write the retained history as a trace.
+ *
+ * The output uses the Chrome trace event format, so that it can be opened
+ * directly in Perfetto or chrome://tracing.  Each buffered result becomes a
+ * complete event on a single GPU track.  The retained results are not
+ * consumed, so consecutive dumps may overlap.
+ */
+static void
+intel_measure_dump_history(struct intel_measure_device *device,
+                           struct gen_device_info *info)
+{
+   const struct intel_measure_ringbuffer *rb = device->ringbuffer;
+
+   char path[PATH_MAX];
+   snprintf(path, sizeof(path), "%s.%u.json",
+            config.trace_path, config.trace_count++);
+   FILE *trace = fopen(path, "w");
+   if (!trace) {
+      fprintf(stderr, "INTEL_MEASURE failed to open trace file %s: %s\n",
+              path, strerror(errno));
+      return;
+   }
+
+   const unsigned result_count = ringbuffer_size(rb);
+   const int pid = getpid();
+   fputs("{\"traceEvents\":[\n", trace);
+   for (unsigned i = 0; i < result_count; ++i) {
+      const struct intel_measure_buffered_result *result =
+         ringbuffer_peek(rb, i);
+      const struct intel_measure_snapshot *begin = &result->snapshot;
+      const uint64_t start_ns =
+         gen_device_info_timebase_scale(info, result->start_ts);
+      const uint64_t duration_ns =
+         gen_device_info_timebase_scale(info,
+                                        raw_timestamp_delta(result->start_ts,
+                                                            result->end_ts));
+      fprintf(trace, "%s{\"name\":\"%s\",\"cat\":\"gpu\",\"ph\":\"X\","
+              "\"pid\":%d,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,"
+              "\"args\":{\"frame\":%u,\"batch\":%u,\"event_index\":%u,"
+              "\"event_count\":%u,\"count\":%u,"
+              "\"framebuffer\":\"0x%"PRIxPTR"\",\"idle_ns\":%"PRIu64"}}",
+              i == 0 ? "" : ",\n",
+              begin->event_name, pid, start_ns / 1000.0, duration_ns / 1000.0,
+              result->frame, result->batch_count, result->event_index,
+              begin->event_count, begin->count, begin->framebuffer,
+              gen_device_info_timebase_scale(info, result->idle_duration));
+   }
+   fputs("\n]}\n", trace);
+   fclose(trace);
+
+   fprintf(config.file, "INTEL_MEASURE wrote %u events to %s\n",
+           result_count, path);
+}
+
 /**
  * Empty the ringbuffer of events that can be printed.
  */
@@ -655,7 +802,15 @@ intel_measure_gather(struct intel_measure_device *measure_device,
       batch->frame = 0;
    }
 
-   intel_measure_print(measure_device, info);
+   if (config.history_frames) {
+      intel_measure_trim_history(measure_device);
+      if (dump_requested) {
+         dump_requested = 0;
+         intel_measure_dump_history(measure_device, info);
+      }
+   } else {
+      intel_measure_print(measure_device, info);
+   }
    pthread_mutex_unlock(&measure_device->mutex);
 }
 
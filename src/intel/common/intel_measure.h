@@ -98,6 +98,24 @@ struct intel_measure_config {
     */
    int                        control_fh;
 
+   /* Number of frames of results retained in memory.  Set with
+    * INTEL_MEASURE=history={num}.  In this mode measurement runs from the
+    * first frame, nothing is streamed to the output file, and the retained
+    * frames are written out as a trace when SIGUSR1 is received or `dump` is
+    * written to the control fifo.  Retained results are also limited by
+    * buffer_size.
+    */
+   unsigned                   history_frames;
+
+   /* Path prefix for trace dumps in history mode.  Set with
+    * INTEL_MEASURE=trace={path}.  Each dump is written to {path}.{n}.json in
+    * the Chrome trace event format, which can be loaded by Perfetto.
+    */
+   const char                *trace_path;
+
+   /* Number of trace dumps written so far */
+   unsigned                   trace_count;
+
    /* true when snapshots are currently being collected */
    bool                       enabled;
 };
@@ -478,6 +478,12 @@ struct brw_wm_prog_key {
    bool coherent_fb_fetch:1;
    bool ignore_sample_mask_out:1;
 
+   /**
+    * Compile a single SIMD width picked from the shader instead of trying
+    * all of them, to keep the compile time down.
+    */
+   bool single_dispatch_width:1;
+
    uint8_t color_outputs_valid;
    uint64_t input_slots_valid;
    GLenum alpha_test_func;          /* < For Gen4/5 MRT alpha test */
@@ -8200,6 +8200,44 @@ fs_visitor::fixup_nomask_control_flow()
    return progress;
 }
 
+/**
+ * Return a lower bound of the number of GRFs needed to register allocate the
+ * shader without spilling.
+ *
+ * Unlike register_pressure, this only counts the vgrfs whose live ranges
+ * strictly overlap at each instruction.  Those all interfere with each other
+ * in the register allocator, so they must all be assigned distinct GRFs.
+ */
+static unsigned
+min_grfs_required(const fs_visitor *v)
+{
+   const fs_live_variables &live = v->live_analysis.require();
+   const unsigned num_instructions = v->cfg->num_blocks ?
+      v->cfg->blocks[v->cfg->num_blocks - 1]->end_ip + 1 : 0;
+
+   /* Number of GRFs that become live minus those that die at each ip */
+   int *delta = new int[num_instructions + 1]();
+
+   for (unsigned reg = 0; reg < v->alloc.count; reg++) {
+      if (live.vgrf_start[reg] >= live.vgrf_end[reg])
+         continue;
+
+      delta[live.vgrf_start[reg]] += v->alloc.sizes[reg];
+      delta[live.vgrf_end[reg]] -= v->alloc.sizes[reg];
+   }
+
+   int live_grfs = 0;
+   unsigned max_live_grfs = 0;
+   for (unsigned ip = 0; ip < num_instructions; ip++) {
+      live_grfs += delta[ip];
+      max_live_grfs = MAX2(max_live_grfs, (unsigned)live_grfs);
+   }
+
+   delete[] delta;
+
+   return max_live_grfs;
+}
+
 void
 fs_visitor::allocate_registers(bool allow_spilling)
 {
@@ -8256,6 +8294,16 @@ fs_visitor::allocate_registers(bool allow_spilling)
       /* We should only spill registers on the last scheduling. */
       assert(!spilled_any_registers);
 
+      /* Building the interference graph is the most expensive part of
+       * register allocation.  If this schedule has more registers live at
+       * once than there are in the register file, the attempt can only fail,
+       * so go straight to the next scheduling heuristic.
+       */
+      if (!can_spill && min_grfs_required(this) > BRW_MAX_GRF) {
+         allocated = false;
+         continue;
+      }
+
       allocated = assign_regs(can_spill, spill_all);
       if (allocated)
          break;
@@ -9054,6 +9102,35 @@ brw_register_blocks(int reg_count)
    return ALIGN(reg_count, 16) / 16 - 1;
 }
 
+/**
+ * Pick the SIMD width of a fragment shader compiled with
+ * brw_wm_prog_key::single_dispatch_width. SIMD16 runs half as many threads
+ * for the same pixels, but large shaders run out of registers and spill,
+ * so they get SIMD8. So do the shaders that SIMD16 can't handle.
+ */
+static unsigned
+brw_fs_single_dispatch_width(const struct gen_device_info *devinfo,
+                             const nir_shader *nir)
+{
+   if (devinfo->gen < 7 || (INTEL_DEBUG & DEBUG_NO16))
+      return 8;
+
+   if (nir->info.outputs_written & BITFIELD64_BIT(FRAG_RESULT_STENCIL))
+      return 8;
+
+   nir_foreach_shader_out_variable(var, nir) {
+      /* Dual source blending */
+      if (var->data.index > 0)
+         return 8;
+   }
+
+   unsigned num_instrs = 0;
+   nir_foreach_block(block, nir_shader_get_entrypoint(nir))
+      num_instrs += exec_list_length(&block->instr_list);
+
+   return num_instrs <= 512 ? 16 : 8;
+}
+
 const unsigned *
 brw_compile_fs(const struct brw_compiler *compiler, void *log_data,
                void *mem_ctx,
@@ -9100,38 +9177,73 @@ brw_compile_fs(const struct brw_compiler *compiler, void *log_data,
 
    fs_visitor *v8 = NULL, *v16 = NULL, *v32 = NULL;
    cfg_t *simd8_cfg = NULL, *simd16_cfg = NULL, *simd32_cfg = NULL;
-   float throughput = 0;
+   float throughput = 0, throughput8 = 0, throughput16 = 0;
    bool has_spilled = false;
 
-   v8 = new fs_visitor(compiler, log_data, mem_ctx, &key->base,
-                       &prog_data->base, nir, 8, shader_time_index8);
-   if (!v8->run_fs(allow_spilling, false /* do_rep_send */)) {
-      if (error_str)
-         *error_str = ralloc_strdup(mem_ctx, v8->fail_msg);
+   const bool single_width = key->single_dispatch_width && !use_rep_send;
 
-      delete v8;
-      return NULL;
-   } else if (!(INTEL_DEBUG & DEBUG_NO8)) {
-      simd8_cfg = v8->cfg;
-      prog_data->base.dispatch_grf_start_reg = v8->payload.num_regs;
-      prog_data->reg_blocks_8 = brw_register_blocks(v8->grf_used);
-      const performance &perf = v8->performance_analysis.require();
-      throughput = MAX2(throughput, perf.throughput);
-      has_spilled = v8->spilled_any_registers;
-      allow_spilling = false;
+   if (single_width && brw_fs_single_dispatch_width(devinfo, nir) == 16) {
+      /* Compiling rewrites the push constants in prog_data, keep a copy to
+       * start over in SIMD8 if SIMD16 fails.
+       */
+      const struct brw_wm_prog_data saved_prog_data = *prog_data;
+      uint32_t *saved_param = NULL;
+      if (prog_data->base.nr_params) {
+         saved_param = ralloc_array(mem_ctx, uint32_t,
+                                    prog_data->base.nr_params);
+         memcpy(saved_param, prog_data->base.param,
+                prog_data->base.nr_params * sizeof(uint32_t));
+      }
+
+      v16 = new fs_visitor(compiler, log_data, mem_ctx, &key->base,
+                           &prog_data->base, nir, 16, shader_time_index16);
+      if (!v16->run_fs(allow_spilling, false /* do_rep_send */)) {
+         compiler->shader_perf_log(log_data,
+                                   "SIMD16 shader failed to compile, "
+                                   "using SIMD8: %s", v16->fail_msg);
+         delete v16;
+         v16 = NULL;
+         *prog_data = saved_prog_data;
+         prog_data->base.param = saved_param;
+      } else {
+         simd16_cfg = v16->cfg;
+         prog_data->dispatch_grf_start_reg_16 = v16->payload.num_regs;
+         prog_data->reg_blocks_16 = brw_register_blocks(v16->grf_used);
+      }
+   }
+
+   if (!simd16_cfg) {
+      v8 = new fs_visitor(compiler, log_data, mem_ctx, &key->base,
+                          &prog_data->base, nir, 8, shader_time_index8);
+      if (!v8->run_fs(allow_spilling, false /* do_rep_send */)) {
+         if (error_str)
+            *error_str = ralloc_strdup(mem_ctx, v8->fail_msg);
+
+         delete v8;
+         return NULL;
+      } else if (!(INTEL_DEBUG & DEBUG_NO8) || single_width) {
+         simd8_cfg = v8->cfg;
+         prog_data->base.dispatch_grf_start_reg = v8->payload.num_regs;
+         prog_data->reg_blocks_8 = brw_register_blocks(v8->grf_used);
+         const performance &perf = v8->performance_analysis.require();
+         throughput8 = perf.throughput;
+         throughput = MAX2(throughput, perf.throughput);
+         has_spilled = v8->spilled_any_registers;
+         allow_spilling = false;
+      }
    }
 
    /* Limit dispatch width to simd8 with dual source blending on gen8.
     * See: https://gitlab.freedesktop.org/mesa/mesa/-/issues/1917
     */
-   if (devinfo->gen == 8 && prog_data->dual_src_blend &&
+   if (v8 && devinfo->gen == 8 && prog_data->dual_src_blend &&
        !(INTEL_DEBUG & DEBUG_NO8)) {
       assert(!use_rep_send);
       v8->limit_dispatch_width(8, "gen8 workaround: "
                                "using SIMD8 when dual src blending.\n");
    }
 
-   if (!has_spilled &&
+   if (!single_width && !has_spilled &&
        v8->max_dispatch_width >= 16 &&
        (!(INTEL_DEBUG & DEBUG_NO16) || use_rep_send)) {
       /* Try a SIMD16 compile */
@@ -9147,6 +9259,7 @@ brw_compile_fs(const struct brw_compiler *compiler, void *log_data,
          prog_data->dispatch_grf_start_reg_16 = v16->payload.num_regs;
          prog_data->reg_blocks_16 = brw_register_blocks(v16->grf_used);
          const performance &perf = v16->performance_analysis.require();
+         throughput16 = perf.throughput;
          throughput = MAX2(throughput, perf.throughput);
          has_spilled = v16->spilled_any_registers;
          allow_spilling = false;
@@ -9155,10 +9268,24 @@ brw_compile_fs(const struct brw_compiler *compiler, void *log_data,
 
    const bool simd16_failed = v16 && !simd16_cfg;
 
+   /* If the performance model doesn't expect SIMD16 to do any better than
+    * SIMD8, the shader is most likely bound by something that doesn't scale
+    * with the dispatch width, and SIMD32 is unlikely to beat either of them.
+    * Don't spend time compiling it.
+    */
+   const bool simd32_unprofitable =
+      simd8_cfg && simd16_cfg && throughput16 <= throughput8 &&
+      !(INTEL_DEBUG & DEBUG_DO32);
+   if (simd32_unprofitable) {
+      compiler->shader_perf_log(log_data,
+                                "SIMD16 shader no faster than SIMD8, "
+                                "skipping SIMD32\n");
+   }
+
    /* Currently, the compiler only supports SIMD32 on SNB+ */
-   if (!has_spilled &&
+   if (!single_width && !has_spilled &&
        v8->max_dispatch_width >= 32 && !use_rep_send &&
-       devinfo->gen >= 6 && !simd16_failed &&
+       devinfo->gen >= 6 && !simd16_failed && !simd32_unprofitable &&
        !(INTEL_DEBUG & DEBUG_NO32)) {
       /* Try a SIMD32 compile */
       v32 = new fs_visitor(compiler, log_data, mem_ctx, &key->base,
@@ -9237,7 +9364,8 @@ brw_compile_fs(const struct brw_compiler *compiler, void *log_data,
    }
 
    fs_generator g(compiler, log_data, mem_ctx, &prog_data->base,
-                  v8->runtime_check_aads_emit, MESA_SHADER_FRAGMENT);
+                  (v8 ? v8 : v16)->runtime_check_aads_emit,
+                  MESA_SHADER_FRAGMENT);
 
    if (INTEL_DEBUG & DEBUG_WM) {
       g.enable_debug(ralloc_asprintf(mem_ctx, "%s fragment shader %s",
@@ -9538,6 +9666,13 @@ brw_compile_cs(const struct brw_compiler *compiler, void *log_data,
             delete v16;
             return NULL;
          }
+      } else if (!generate_all && v8 &&
+                 v16->performance_analysis.require().throughput <
+                 v8->performance_analysis.require().throughput) {
+         /* Only one dispatch width is used, and the performance model
+          * expects SIMD8 to be faster.
+          */
+         compiler->shader_perf_log(log_data, "SIMD16 shader inefficient\n");
       } else {
          /* We should always be able to do SIMD32 for compute shaders */
          assert(v16->max_dispatch_width >= 32);
@@ -469,8 +469,10 @@ public:
    bool assign_regs(bool allow_spilling, bool spill_all);
 
 private:
+   void setup_fixed_interference(unsigned node, int node_start_ip);
    void setup_live_interference(unsigned node,
                                 int node_start_ip, int node_end_ip);
+   void setup_vgrf_live_interference();
    void setup_inst_interference(const fs_inst *inst);
 
    void build_interference_graph(bool allow_spilling);
@@ -600,9 +602,12 @@ namespace {
    }
 }
 
+/**
+ * Add the interference of a node with the payload, MRF hack and scratch
+ * header nodes, which only depends on where the node's live range starts.
+ */
 void
-fs_reg_alloc::setup_live_interference(unsigned node,
-                                      int node_start_ip, int node_end_ip)
+fs_reg_alloc::setup_fixed_interference(unsigned node, int node_start_ip)
 {
    /* Mark any virtual grf that is live between the start of the program and
     * the last use of a payload node interfering with that payload node.
@@ -630,6 +635,13 @@ fs_reg_alloc::setup_live_interference(unsigned node,
    /* Everything interferes with the scratch header */
    if (scratch_header_node >= 0)
       ra_add_node_interference(g, node, scratch_header_node);
+}
+
+void
+fs_reg_alloc::setup_live_interference(unsigned node,
+                                      int node_start_ip, int node_end_ip)
+{
+   setup_fixed_interference(node, node_start_ip);
 
    /* Add interference with every vgrf whose live range intersects this
     * node's.  We only need to look at nodes below this one as the reflexivity
@@ -644,6 +656,77 @@ fs_reg_alloc::setup_live_interference(unsigned node,
    }
 }
 
+struct live_interval {
+   int start, end;
+   unsigned vgrf;
+};
+
+static int
+compare_live_interval_start(const void *a, const void *b)
+{
+   const live_interval *ia = (const live_interval *)a;
+   const live_interval *ib = (const live_interval *)b;
+
+   if (ia->start != ib->start)
+      return ia->start < ib->start ? -1 : 1;
+   return ia->vgrf < ib->vgrf ? -1 : ia->vgrf > ib->vgrf;
+}
+
+/**
+ * Add the live range interference of every vgrf.
+ *
+ * This is equivalent to calling setup_live_interference() for each vgrf, but
+ * rather than comparing every pair of vgrfs it sweeps over the live ranges in
+ * order of their start, only comparing against the ranges that are still
+ * live.  The cost is then proportional to the register pressure rather than
+ * to the square of the number of vgrfs, which matters for large shaders.
+ */
+void
+fs_reg_alloc::setup_vgrf_live_interference()
+{
+   const unsigned count = fs->alloc.count;
+   live_interval *intervals = ralloc_array(NULL, live_interval, count);
+   unsigned *active = ralloc_array(intervals, unsigned, count);
+   unsigned active_count = 0;
+
+   for (unsigned i = 0; i < count; i++) {
+      intervals[i].start = live.vgrf_start[i];
+      intervals[i].end = live.vgrf_end[i];
+      intervals[i].vgrf = i;
+   }
+   qsort(intervals, count, sizeof(*intervals), compare_live_interval_start);
+
+   for (unsigned i = 0; i < count; i++) {
+      const live_interval *node = &intervals[i];
+      setup_fixed_interference(first_vgrf_node + node->vgrf, node->start);
+
+      /* Retire the ranges that end before this one starts.  Since ranges are
+       * visited in order of their start, they can't interfere with any of
+       * the following ones either.
+       */
+      unsigned j = 0;
+      while (j < active_count) {
+         const live_interval *other = &intervals[active[j]];
+         if (other->end <= node->start) {
+            active[j] = active[--active_count];
+            continue;
+         }
+
+         if (other->start < node->end) {
+            ra_add_node_interference(g, first_vgrf_node + node->vgrf,
+                                        first_vgrf_node + other->vgrf);
+         }
+         j++;
+      }
+
+      /* Unused vgrfs have an empty range and never interfere. */
+      if (node->start < node->end)
+         active[active_count++] = i;
+   }
+
+   ralloc_free(intervals);
+}
+
 void
 fs_reg_alloc::setup_inst_interference(const fs_inst *inst)
 {
@@ -860,11 +943,7 @@ fs_reg_alloc::build_interference_graph(bool allow_spilling)
    }
 
    /* Add interference based on the live range of the register */
-   for (unsigned i = 0; i < fs->alloc.count; i++) {
-      setup_live_interference(first_vgrf_node + i,
-                              live.vgrf_start[i],
-                              live.vgrf_end[i]);
-   }
+   setup_vgrf_live_interference();
 
    /* Add interference based on the instructions in which a register is used.
     */
@@ -1291,12 +1370,18 @@ fs_reg_alloc::spill_reg(unsigned spill_reg)
    assert(ip == live_instr_count);
 }
 
+/**
+ * Number of registers spilled for each additional register spilled per
+ * allocation attempt.
+ */
+#define SPILLS_PER_ATTEMPT_RATE 11
+
 bool
 fs_reg_alloc::assign_regs(bool allow_spilling, bool spill_all)
 {
    build_interference_graph(fs->spilled_any_registers || spill_all);
 
-   bool spilled = false;
+   unsigned spilled = 0;
    while (1) {
       /* Debug of register spilling: Go spill everything. */
       if (unlikely(spill_all)) {
@@ -1313,24 +1398,37 @@ fs_reg_alloc::assign_regs(bool allow_spilling, bool spill_all)
       if (!allow_spilling)
          return false;
 
-      /* Failed to allocate registers.  Spill a reg, and the caller will
-       * loop back into here to try again.
+      /* Failed to allocate registers.  Spill some regs, and loop back to
+       * try again.  Every allocation attempt costs as much as the first one,
+       * so shaders that need many spills would take a very long time to
+       * compile if we only spilled one register per attempt.  Once a few
+       * registers have been spilled, spill more of them at a time.
        */
-      int reg = choose_spill_reg();
-      if (reg == -1)
-         return false;
+      const unsigned nr_spills = MAX2(1, spilled / SPILLS_PER_ATTEMPT_RATE);
+      for (unsigned i = 0; i < nr_spills; i++) {
+         int reg = choose_spill_reg();
+         if (reg == -1) {
+            /* We have already spilled something, try allocating again. */
+            if (i > 0)
+               break;
+            return false;
+         }
 
-      /* If we're going to spill but we've never spilled before, we need to
-       * re-build the interference graph with MRFs enabled to allow spilling.
-       */
-      if (!fs->spilled_any_registers) {
-         discard_interference_graph();
-         build_interference_graph(true);
-      }
+         /* If we're going to spill but we've never spilled before, we need
+          * to re-build the interference graph with MRFs enabled to allow
+          * spilling.
+          */
+         if (!fs->spilled_any_registers) {
+            discard_interference_graph();
+            build_interference_graph(true);
+         }
 
-      spilled = true;
+         spill_reg(reg);
+         if (fs->failed)
+            return false;
 
-      spill_reg(reg);
+         spilled++;
+      }
    }
 
    if (spilled)
@@ -36,15 +36,40 @@
 #include "isl_gen12.h"
 #include "isl_priv.h"
 
-void
-isl_memcpy_linear_to_tiled(uint32_t xt1, uint32_t xt2,
-                           uint32_t yt1, uint32_t yt2,
-                           char *dst, const char *src,
-                           uint32_t dst_pitch, int32_t src_pitch,
-                           bool has_swizzling,
-                           enum isl_tiling tiling,
-                           isl_memcpy_type copy_type)
+#include "util/format/u_format.h"
+#include "util/u_cpu_detect.h"
+
+#ifdef HAVE_ISL_TILED_MEMCPY_AVX2
+static bool
+isl_memcpy_has_avx2(void)
 {
+   util_cpu_detect();
+   return util_get_cpu_caps()->has_avx2;
+}
+#endif
+
+static void
+linear_to_tiled(uint32_t xt1, uint32_t xt2,
+                uint32_t yt1, uint32_t yt2,
+                char *dst, const char *src,
+                uint32_t dst_pitch, int32_t src_pitch,
+                bool has_swizzling,
+                enum isl_tiling tiling,
+                isl_memcpy_type copy_type)
+{
+#ifdef HAVE_ISL_TILED_MEMCPY_AVX2
+   if (copy_type == ISL_MEMCPY_STREAMING_STORE && isl_memcpy_has_avx2()) {
+      _isl_memcpy_linear_to_tiled_avx2(
+         xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch, has_swizzling,
+         tiling, copy_type);
+      return;
+   }
+#endif
+
+   /* Streaming stores are only a hint */
+   if (copy_type == ISL_MEMCPY_STREAMING_STORE)
+      copy_type = ISL_MEMCPY;
+
 #ifdef USE_SSE41
    if (copy_type == ISL_MEMCPY_STREAMING_LOAD) {
       _isl_memcpy_linear_to_tiled_sse41(
@@ -59,15 +84,24 @@ isl_memcpy_linear_to_tiled(uint32_t xt1, uint32_t xt2,
       tiling, copy_type);
 }
 
-void
-isl_memcpy_tiled_to_linear(uint32_t xt1, uint32_t xt2,
-                           uint32_t yt1, uint32_t yt2,
-                           char *dst, const char *src,
-                           int32_t dst_pitch, uint32_t src_pitch,
-                           bool has_swizzling,
-                           enum isl_tiling tiling,
-                           isl_memcpy_type copy_type)
+static void
+tiled_to_linear(uint32_t xt1, uint32_t xt2,
+                uint32_t yt1, uint32_t yt2,
+                char *dst, const char *src,
+                int32_t dst_pitch, uint32_t src_pitch,
+                bool has_swizzling,
+                enum isl_tiling tiling,
+                isl_memcpy_type copy_type)
 {
+#ifdef HAVE_ISL_TILED_MEMCPY_AVX2
+   if (copy_type == ISL_MEMCPY_STREAMING_LOAD && isl_memcpy_has_avx2()) {
+      _isl_memcpy_tiled_to_linear_avx2(
+         xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch, has_swizzling,
+         tiling, copy_type);
+      return;
+   }
+#endif
+
 #ifdef USE_SSE41
    if (copy_type == ISL_MEMCPY_STREAMING_LOAD) {
       _isl_memcpy_tiled_to_linear_sse41(
@@ -82,6 +116,131 @@ isl_memcpy_tiled_to_linear(uint32_t xt1, uint32_t xt2,
       tiling, copy_type);
 }
 
+/* Copies of fewer bytes are done on the calling thread. */
+#define ISL_MEMCPY_PARALLEL_MIN_BYTES (1 << 20)
+
+struct isl_memcpy_rect {
+   bool linear_to_tiled;
+   uint32_t xt1, xt2, yt1;
+   char *tiled;
+   uint32_t tiled_pitch;
+   char *linear;
+   int32_t linear_pitch;
+   bool has_swizzling;
+   enum isl_tiling tiling;
+   isl_memcpy_type copy_type;
+};
+
+/* Copies a band of rows, where linear_row is the first row of the band in
+ * the linear surface.
+ */
+static void
+isl_memcpy_band(void *data,
+                uint8_t *linear_row, unsigned linear_pitch,
+                UNUSED const uint8_t *src_row, UNUSED unsigned src_stride,
+                UNUSED unsigned width, unsigned height)
+{
+   const struct isl_memcpy_rect *rect = data;
+   const uint32_t y = ((char *)linear_row - rect->linear) / linear_pitch;
+
+   if (rect->linear_to_tiled) {
+      linear_to_tiled(rect->xt1, rect->xt2,
+                      rect->yt1 + y, rect->yt1 + y + height,
+                      rect->tiled, (const char *)linear_row,
+                      rect->tiled_pitch, rect->linear_pitch,
+                      rect->has_swizzling, rect->tiling, rect->copy_type);
+   } else {
+      tiled_to_linear(rect->xt1, rect->xt2,
+                      rect->yt1 + y, rect->yt1 + y + height,
+                      (char *)linear_row, rect->tiled,
+                      rect->linear_pitch, rect->tiled_pitch,
+                      rect->has_swizzling, rect->tiling, rect->copy_type);
+   }
+}
+
+/**
+ * Split large copies into bands of rows that are copied on the shared thread
+ * pool.  Returns false if the copy should be done on the calling thread.
+ */
+static bool
+isl_memcpy_parallel(const struct isl_memcpy_rect *rect, uint32_t yt2)
+{
+   const uint32_t height = yt2 - rect->yt1;
+
+   /* Flipped copies would need a signed stride */
+   if (rect->linear_pitch <= 0)
+      return false;
+
+   if ((uint64_t)(rect->xt2 - rect->xt1) * height <
+       ISL_MEMCPY_PARALLEL_MIN_BYTES)
+      return false;
+
+   /* Keep bands tile aligned relative to the start of the copy so that most
+    * tiles are written by a single thread.
+    */
+   const unsigned tile_height = rect->tiling == ISL_TILING_X ? 8 : 32;
+
+   util_format_unpack_rect_parallel(isl_memcpy_band, (void *)rect,
+                                    tile_height,
+                                    (uint8_t *)rect->linear,
+                                    rect->linear_pitch,
+                                    (const uint8_t *)rect->linear, 0,
+                                    rect->xt2 - rect->xt1, height);
+   return true;
+}
+
+void
+isl_memcpy_linear_to_tiled(uint32_t xt1, uint32_t xt2,
+                           uint32_t yt1, uint32_t yt2,
+                           char *dst, const char *src,
+                           uint32_t dst_pitch, int32_t src_pitch,
+                           bool has_swizzling,
+                           enum isl_tiling tiling,
+                           isl_memcpy_type copy_type)
+{
+   const struct isl_memcpy_rect rect = {
+      .linear_to_tiled = true,
+      .xt1 = xt1, .xt2 = xt2, .yt1 = yt1,
+      .tiled = dst, .tiled_pitch = dst_pitch,
+      .linear = (char *)src, .linear_pitch = src_pitch,
+      .has_swizzling = has_swizzling,
+      .tiling = tiling,
+      .copy_type = copy_type,
+   };
+
+   if (isl_memcpy_parallel(&rect, yt2))
+      return;
+
+   linear_to_tiled(xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch,
+                   has_swizzling, tiling, copy_type);
+}
+
+void
+isl_memcpy_tiled_to_linear(uint32_t xt1, uint32_t xt2,
+                           uint32_t yt1, uint32_t yt2,
+                           char *dst, const char *src,
+                           int32_t dst_pitch, uint32_t src_pitch,
+                           bool has_swizzling,
+                           enum isl_tiling tiling,
+                           isl_memcpy_type copy_type)
+{
+   const struct isl_memcpy_rect rect = {
+      .linear_to_tiled = false,
+      .xt1 = xt1, .xt2 = xt2, .yt1 = yt1,
+      .tiled = (char *)src, .tiled_pitch = src_pitch,
+      .linear = dst, .linear_pitch = dst_pitch,
+      .has_swizzling = has_swizzling,
+      .tiling = tiling,
+      .copy_type = copy_type,
+   };
+
+   if (isl_memcpy_parallel(&rect, yt2))
+      return;
+
+   tiled_to_linear(xt1, xt2, yt1, yt2, dst, src, dst_pitch, src_pitch,
+                   has_swizzling, tiling, copy_type);
+}
+
 void PRINTFLIKE(3, 4) UNUSED
 __isl_finishme(const char *file, int line, const char *fmt, ...)
 {
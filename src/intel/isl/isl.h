@@ -1035,6 +1035,8 @@ typedef enum {
   ISL_MEMCPY = 0,
   ISL_MEMCPY_BGRA8,
   ISL_MEMCPY_STREAMING_LOAD,
+  /** Non-temporal stores to the tiled surface, for linear to tiled copies */
+  ISL_MEMCPY_STREAMING_STORE,
   ISL_MEMCPY_INVALID,
 } isl_memcpy_type;
 
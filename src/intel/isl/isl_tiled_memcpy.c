@@ -42,6 +42,10 @@
 #include <emmintrin.h>
 #endif
 
+#if defined(INLINE_AVX2)
+#include <immintrin.h>
+#endif
+
 #define FILE_DEBUG_FLAG DEBUG_TEXTURE
 
 #define ALIGN_DOWN(a, b) ROUND_DOWN_TO(a, b)
@@ -578,6 +582,13 @@ _memcpy_streaming_load(void *dest, const void *src, size_t count)
       _mm_storeu_si128((__m128i *)dest, val);
       return dest;
    } else if (count == 64) {
+#if defined(INLINE_AVX2)
+      __m256i val0 = _mm256_stream_load_si256(((__m256i *)src) + 0);
+      __m256i val1 = _mm256_stream_load_si256(((__m256i *)src) + 1);
+      _mm256_storeu_si256(((__m256i *)dest) + 0, val0);
+      _mm256_storeu_si256(((__m256i *)dest) + 1, val1);
+      return dest;
+#else
       __m128i val0 = _mm_stream_load_si128(((__m128i *)src) + 0);
       __m128i val1 = _mm_stream_load_si128(((__m128i *)src) + 1);
       __m128i val2 = _mm_stream_load_si128(((__m128i *)src) + 2);
@@ -587,6 +598,33 @@ _memcpy_streaming_load(void *dest, const void *src, size_t count)
       _mm_storeu_si128(((__m128i *)dest) + 2, val2);
       _mm_storeu_si128(((__m128i *)dest) + 3, val3);
       return dest;
+#endif
+   } else {
+      assert(count < 64); /* and (count < 16) for ytiled */
+      return memcpy(dest, src, count);
+   }
+}
+#endif
+
+#if defined(INLINE_AVX2)
+/**
+ * Copy to the tiled surface with non-temporal stores.
+ *
+ * Spans are written whole, so every cacheline of the surface gets fully
+ * written and the stores combine without reading the destination first.
+ */
+static ALWAYS_INLINE void *
+_memcpy_streaming_store(void *dest, const void *src, size_t count)
+{
+   if (count == 16) {
+      _mm_stream_si128((__m128i *)dest, _mm_loadu_si128((__m128i *)src));
+      return dest;
+   } else if (count == 64) {
+      __m256i val0 = _mm256_loadu_si256(((__m256i *)src) + 0);
+      __m256i val1 = _mm256_loadu_si256(((__m256i *)src) + 1);
+      _mm256_stream_si256(((__m256i *)dest) + 0, val0);
+      _mm256_stream_si256(((__m256i *)dest) + 1, val1);
+      return dest;
    } else {
       assert(count < 64); /* and (count < 16) for ytiled */
       return memcpy(dest, src, count);
@@ -607,6 +645,12 @@ choose_copy_function(isl_memcpy_type copy_type)
       return _memcpy_streaming_load;
 #else
       unreachable("ISL_MEMCOPY_STREAMING_LOAD requires sse4.1");
+#endif
+   case ISL_MEMCPY_STREAMING_STORE:
+#if defined(INLINE_AVX2)
+      return _memcpy_streaming_store;
+#else
+      unreachable("ISL_MEMCPY_STREAMING_STORE requires avx2");
 #endif
    case ISL_MEMCPY_INVALID:
       unreachable("invalid copy_type");
@@ -642,6 +686,12 @@ linear_to_xtiled_faster(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
          return linear_to_xtiled(0, 0, xtile_width, xtile_width, 0, xtile_height,
                                  dst, src, src_pitch, swizzle_bit,
                                  rgba8_copy, rgba8_copy_aligned_dst);
+#if defined(INLINE_AVX2)
+      else if (mem_copy == _memcpy_streaming_store)
+         return linear_to_xtiled(0, 0, xtile_width, xtile_width, 0, xtile_height,
+                                 dst, src, src_pitch, swizzle_bit,
+                                 memcpy, _memcpy_streaming_store);
+#endif
       else
          unreachable("not reached");
    } else {
@@ -653,6 +703,12 @@ linear_to_xtiled_faster(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
          return linear_to_xtiled(x0, x1, x2, x3, y0, y1,
                                  dst, src, src_pitch, swizzle_bit,
                                  rgba8_copy, rgba8_copy_aligned_dst);
+#if defined(INLINE_AVX2)
+      else if (mem_copy == _memcpy_streaming_store)
+         return linear_to_xtiled(x0, x1, x2, x3, y0, y1,
+                                 dst, src, src_pitch, swizzle_bit,
+                                 memcpy, _memcpy_streaming_store);
+#endif
       else
          unreachable("not reached");
    }
@@ -687,6 +743,12 @@ linear_to_ytiled_faster(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
          return linear_to_ytiled(0, 0, ytile_width, ytile_width, 0, ytile_height,
                                  dst, src, src_pitch, swizzle_bit,
                                  rgba8_copy, rgba8_copy_aligned_dst);
+#if defined(INLINE_AVX2)
+      else if (mem_copy == _memcpy_streaming_store)
+         return linear_to_ytiled(0, 0, ytile_width, ytile_width, 0, ytile_height,
+                                 dst, src, src_pitch, swizzle_bit,
+                                 memcpy, _memcpy_streaming_store);
+#endif
       else
          unreachable("not reached");
    } else {
@@ -697,6 +759,12 @@ linear_to_ytiled_faster(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
          return linear_to_ytiled(x0, x1, x2, x3, y0, y1,
                                  dst, src, src_pitch, swizzle_bit,
                                  rgba8_copy, rgba8_copy_aligned_dst);
+#if defined(INLINE_AVX2)
+      else if (mem_copy == _memcpy_streaming_store)
+         return linear_to_ytiled(x0, x1, x2, x3, y0, y1,
+                                 dst, src, src_pitch, swizzle_bit,
+                                 memcpy, _memcpy_streaming_store);
+#endif
       else
          unreachable("not reached");
    }
@@ -905,6 +973,15 @@ linear_to_tiled(uint32_t xt1, uint32_t xt2,
                    copy_type);
       }
    }
+
+#if defined(INLINE_AVX2)
+   if (copy_type == ISL_MEMCPY_STREAMING_STORE) {
+      /* Non-temporal stores are weakly ordered, make sure they are globally
+       * visible before the GPU is told to use the surface.
+       */
+      _mm_sfence();
+   }
+#endif
 }
 
 /**
@@ -168,6 +168,28 @@ struct gen_perf_query_result {
    bool query_disjoint;
 };
 
+/**
+ * One entry of a gen_perf_stream: the counter deltas between two
+ * consecutive periodic OA reports.
+ */
+struct gen_perf_stream_sample {
+   /**
+    * GPU timestamp of the later report.  OA reports only carry the low 32
+    * bits of the timestamp, this is extended to 64 bits by counting wraps
+    * since the stream was opened.
+    */
+   uint64_t timestamp;
+
+   /**
+    * Hardware context ID the later report was tagged with, only meaningful
+    * if ctx_id_valid is set.
+    */
+   uint32_t ctx_id;
+   bool ctx_id_valid;
+
+   struct gen_perf_query_result result;
+};
+
 struct gen_perf_query_counter {
    const char *name;
    const char *desc;
@@ -1602,3 +1602,264 @@ gen_perf_dump_query(struct gen_perf_context *ctx,
       break;
    }
 }
+
+/**
+ * A periodically sampled i915 perf stream.
+ *
+ * Unlike queries, which only report the counters between a begin and an
+ * end snapshot, a stream keeps the OA unit running and turns every pair
+ * of consecutive periodic reports into a gen_perf_stream_sample.  The
+ * samples are kept in a fixed size ring, the oldest ones being dropped
+ * when it's full, so a profiler can poll gen_perf_stream_read() at its
+ * own pace and look at the most recent history.
+ */
+struct gen_perf_stream {
+   const struct gen_perf_query_info *query;
+   const struct gen_device_info *devinfo;
+   int fd;
+
+   /* Previous report, the reference the next delta is computed from. */
+   uint32_t last_report[64];
+   bool has_last_report;
+   uint64_t last_timestamp;
+
+   struct gen_perf_stream_sample *samples;
+   unsigned num_samples;
+   unsigned next_sample;
+   unsigned sample_count;
+};
+
+/**
+ * Open an OA stream for the counter set of query, sampling every
+ * timestamp_period * 2^(period_exponent + 1).
+ *
+ * If single_context is set, only ctx_handle is profiled.  Otherwise the
+ * stream is system wide, which the kernel restricts to privileged users
+ * unless dev.i915.perf_stream_paranoid is 0.
+ */
+struct gen_perf_stream *
+gen_perf_stream_open(void *mem_ctx,
+                     struct gen_perf_config *perf_cfg,
+                     const struct gen_device_info *devinfo,
+                     int drm_fd,
+                     const struct gen_perf_query_info *query,
+                     bool single_context,
+                     uint32_t ctx_handle,
+                     int period_exponent,
+                     unsigned num_samples)
+{
+   assert(query->kind == GEN_PERF_QUERY_TYPE_OA ||
+          query->kind == GEN_PERF_QUERY_TYPE_RAW);
+   assert(num_samples > 0);
+
+   uint64_t metric_id = get_metric_id(perf_cfg, query);
+   if (metric_id == 0)
+      return NULL;
+
+   uint64_t properties[DRM_I915_PERF_PROP_MAX * 2];
+   uint32_t p = 0;
+
+   if (single_context) {
+      properties[p++] = DRM_I915_PERF_PROP_CTX_HANDLE;
+      properties[p++] = ctx_handle;
+   }
+
+   properties[p++] = DRM_I915_PERF_PROP_SAMPLE_OA;
+   properties[p++] = true;
+
+   properties[p++] = DRM_I915_PERF_PROP_OA_METRICS_SET;
+   properties[p++] = metric_id;
+
+   properties[p++] = DRM_I915_PERF_PROP_OA_FORMAT;
+   properties[p++] = query->oa_format;
+
+   properties[p++] = DRM_I915_PERF_PROP_OA_EXPONENT;
+   properties[p++] = period_exponent;
+
+   if (gen_perf_has_global_sseu(perf_cfg)) {
+      properties[p++] = DRM_I915_PERF_PROP_GLOBAL_SSEU;
+      properties[p++] = to_user_pointer(&perf_cfg->sseu);
+   }
+
+   assert(p <= ARRAY_SIZE(properties));
+
+   struct drm_i915_perf_open_param param = {
+      .flags = I915_PERF_FLAG_FD_CLOEXEC |
+               I915_PERF_FLAG_FD_NONBLOCK,
+      .num_properties = p / 2,
+      .properties_ptr = (uintptr_t) properties,
+   };
+   int fd = intel_ioctl(drm_fd, DRM_IOCTL_I915_PERF_OPEN, &param);
+   if (fd == -1) {
+      DBG("Error opening gen perf OA stream: %m\n");
+      return NULL;
+   }
+
+   struct gen_perf_stream *stream = rzalloc(mem_ctx, struct gen_perf_stream);
+   if (stream)
+      stream->samples = ralloc_array(stream, struct gen_perf_stream_sample,
+                                     num_samples);
+   if (!stream || !stream->samples) {
+      ralloc_free(stream);
+      close(fd);
+      return NULL;
+   }
+
+   stream->query = query;
+   stream->devinfo = devinfo;
+   stream->fd = fd;
+   stream->num_samples = num_samples;
+
+   return stream;
+}
+
+void
+gen_perf_stream_close(struct gen_perf_stream *stream)
+{
+   close(stream->fd);
+   ralloc_free(stream);
+}
+
+static void
+stream_add_report(struct gen_perf_stream *stream, const uint32_t *report)
+{
+   const struct gen_device_info *devinfo = stream->devinfo;
+
+   if (!stream->has_last_report) {
+      stream->last_timestamp = report[1];
+      memcpy(stream->last_report, report, sizeof(stream->last_report));
+      stream->has_last_report = true;
+      return;
+   }
+
+   struct gen_perf_stream_sample *sample =
+      &stream->samples[stream->next_sample];
+
+   gen_perf_query_result_clear(&sample->result);
+   gen_perf_query_result_accumulate(&sample->result, stream->query, devinfo,
+                                    stream->last_report, report);
+
+   stream->last_timestamp += (uint32_t) (report[1] - stream->last_report[1]);
+   sample->timestamp = stream->last_timestamp;
+   sample->ctx_id_valid = oa_report_ctx_id_valid(devinfo, report);
+   sample->ctx_id = report[2];
+
+   stream->next_sample = (stream->next_sample + 1) % stream->num_samples;
+   stream->sample_count = MIN2(stream->sample_count + 1, stream->num_samples);
+
+   memcpy(stream->last_report, report, sizeof(stream->last_report));
+}
+
+/**
+ * Read all the reports the kernel has for us, without blocking.
+ *
+ * Returns the number of samples added to the ring, or -1 on error.
+ */
+int
+gen_perf_stream_read(struct gen_perf_stream *stream)
+{
+   uint8_t buf[I915_PERF_OA_SAMPLE_SIZE * 10];
+   int added = 0;
+
+   while (1) {
+      int len;
+
+      while ((len = read(stream->fd, buf, sizeof(buf))) < 0 && errno == EINTR)
+         ;
+
+      if (len < 0 && errno == EAGAIN)
+         return added;
+
+      if (len <= 0) {
+         if (len == 0)
+            DBG("Spurious EOF reading i915 perf samples\n");
+         else
+            DBG("Error reading i915 perf samples: %m\n");
+         return -1;
+      }
+
+      int offset = 0;
+      while (offset < len) {
+         const struct drm_i915_perf_record_header *header =
+            (const struct drm_i915_perf_record_header *) &buf[offset];
+
+         assert(header->size != 0);
+         offset += header->size;
+
+         switch (header->type) {
+         case DRM_I915_PERF_RECORD_SAMPLE:
+            if (stream->has_last_report)
+               added++;
+            stream_add_report(stream, (const uint32_t *) (header + 1));
+            break;
+         case DRM_I915_PERF_RECORD_OA_BUFFER_LOST:
+            /* Start over from the next report, deltas across the gap
+             * would be meaningless.
+             */
+            DBG("i915 perf: OA error: all reports lost\n");
+            stream->has_last_report = false;
+            break;
+         case DRM_I915_PERF_RECORD_OA_REPORT_LOST:
+            DBG("i915 perf: OA report lost\n");
+            break;
+         }
+      }
+   }
+}
+
+unsigned
+gen_perf_stream_num_samples(const struct gen_perf_stream *stream)
+{
+   return stream->sample_count;
+}
+
+/**
+ * Return the index-th sample currently in the ring, 0 being the oldest.
+ */
+const struct gen_perf_stream_sample *
+gen_perf_stream_get_sample(const struct gen_perf_stream *stream,
+                           unsigned index)
+{
+   assert(index < stream->sample_count);
+
+   unsigned first = (stream->next_sample + stream->num_samples -
+                     stream->sample_count) % stream->num_samples;
+
+   return &stream->samples[(first + index) % stream->num_samples];
+}
+
+/**
+ * Sum the samples ending between two GPU timestamps into result.
+ *
+ * This is meant to line the stream up with timestamps captured elsewhere,
+ * like the snapshots taken by intel_measure around render passes.  Only
+ * the low 32 bits of the timestamps are compared, as that's all the OA
+ * reports give us, so the range must be shorter than the timestamp wrap
+ * period.
+ *
+ * Returns the number of samples accumulated.
+ */
+unsigned
+gen_perf_stream_accumulate_range(const struct gen_perf_stream *stream,
+                                 uint64_t begin_timestamp,
+                                 uint64_t end_timestamp,
+                                 struct gen_perf_query_result *result)
+{
+   uint32_t range = (uint32_t) (end_timestamp - begin_timestamp);
+   unsigned count = 0;
+
+   for (unsigned i = 0; i < stream->sample_count; i++) {
+      const struct gen_perf_stream_sample *sample =
+         gen_perf_stream_get_sample(stream, i);
+
+      if ((uint32_t) (sample->timestamp - begin_timestamp) > range)
+         continue;
+
+      for (unsigned c = 0; c < ARRAY_SIZE(result->accumulator); c++)
+         result->accumulator[c] += sample->result.accumulator[c];
+      result->reports_accumulated += sample->result.reports_accumulated;
+      count++;
+   }
+
+   return count;
+}
@@ -24,6 +24,7 @@
 #ifndef GEN_PERF_QUERY_H
 #define GEN_PERF_QUERY_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 struct gen_device_info;
@@ -31,6 +32,10 @@ struct gen_device_info;
 struct gen_perf_config;
 struct gen_perf_context;
 struct gen_perf_query_object;
+struct gen_perf_query_info;
+struct gen_perf_query_result;
+struct gen_perf_stream;
+struct gen_perf_stream_sample;
 
 struct gen_perf_context *gen_perf_new_context(void *parent);
 
@@ -78,4 +83,25 @@ void gen_perf_dump_query(struct gen_perf_context *perf_ctx,
                          struct gen_perf_query_object *obj,
                          void *current_batch);
 
+struct gen_perf_stream *
+gen_perf_stream_open(void *mem_ctx,
+                     struct gen_perf_config *perf_cfg,
+                     const struct gen_device_info *devinfo,
+                     int drm_fd,
+                     const struct gen_perf_query_info *query,
+                     bool single_context,
+                     uint32_t ctx_handle,
+                     int period_exponent,
+                     unsigned num_samples);
+void gen_perf_stream_close(struct gen_perf_stream *stream);
+int gen_perf_stream_read(struct gen_perf_stream *stream);
+unsigned gen_perf_stream_num_samples(const struct gen_perf_stream *stream);
+const struct gen_perf_stream_sample *
+gen_perf_stream_get_sample(const struct gen_perf_stream *stream,
+                           unsigned index);
+unsigned gen_perf_stream_accumulate_range(const struct gen_perf_stream *stream,
+                                          uint64_t begin_timestamp,
+                                          uint64_t end_timestamp,
+                                          struct gen_perf_query_result *result);
+
 #endif /* GEN_PERF_QUERY_H */
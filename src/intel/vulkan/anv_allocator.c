@@ -314,16 +314,15 @@ anv_state_table_add(struct anv_state_table *table, uint32_t *idx,
    }
 }
 
-void
-anv_free_list_push(union anv_free_list *list,
-                   struct anv_state_table *table,
-                   uint32_t first, uint32_t count)
+/* Pushes the entries linked through their next field, from first to last,
+ * with a single compare-and-swap.
+ */
+static void
+anv_free_list_push_chain(union anv_free_list *list,
+                         struct anv_state_table *table,
+                         uint32_t first, uint32_t last)
 {
    union anv_free_list current, old, new;
-   uint32_t last = first;
-
-   for (uint32_t i = 1; i < count; i++, last++)
-      table->map[last].next = last + 1;
 
    old = *list;
    do {
@@ -335,6 +334,19 @@ anv_free_list_push(union anv_free_list *list,
    } while (old.u64 != current.u64);
 }
 
+void
+anv_free_list_push(union anv_free_list *list,
+                   struct anv_state_table *table,
+                   uint32_t first, uint32_t count)
+{
+   uint32_t last = first;
+
+   for (uint32_t i = 1; i < count; i++, last++)
+      table->map[last].next = last + 1;
+
+   anv_free_list_push_chain(list, table, first, last);
+}
+
 struct anv_state *
 anv_free_list_pop(union anv_free_list *list,
                   struct anv_state_table *table)
@@ -357,6 +369,36 @@ anv_free_list_pop(union anv_free_list *list,
    return NULL;
 }
 
+/* Pops up to max_count entries with a single successful compare-and-swap.
+ * Returns the number of entries written to idx.
+ */
+static uint32_t
+anv_free_list_pop_chain(union anv_free_list *list,
+                        struct anv_state_table *table,
+                        uint32_t *idx, uint32_t max_count)
+{
+   union anv_free_list current, new, old;
+
+   current.u64 = list->u64;
+   while (current.offset != EMPTY) {
+      __sync_synchronize();
+      uint32_t count = 0;
+      uint32_t next = current.offset;
+      while (count < max_count && next != EMPTY) {
+         idx[count++] = next;
+         next = table->map[next].next;
+      }
+      new.offset = next;
+      new.count = current.count + 1;
+      old.u64 = __sync_val_compare_and_swap(&list->u64, current.u64, new.u64);
+      if (old.u64 == current.u64)
+         return count;
+      current = old;
+   }
+
+   return 0;
+}
+
 static VkResult
 anv_block_pool_expand_range(struct anv_block_pool *pool,
                             uint32_t center_bo_offset, uint32_t size);
@@ -1177,6 +1219,170 @@ anv_state_pool_free(struct anv_state_pool *pool, struct anv_state state)
    anv_state_pool_free_no_vg(pool, state);
 }
 
+/** Allocates up to count states of the same size at once.
+ *
+ * The states come off the bucket's free list with a single compare-and-swap.
+ * If the free list is empty, they are split from one larger allocation
+ * instead. Returns the number of states written to states, at least one.
+ */
+uint32_t
+anv_state_pool_alloc_batch(struct anv_state_pool *pool, uint32_t size,
+                           struct anv_state *states, uint32_t count)
+{
+   uint32_t bucket = anv_state_pool_get_bucket(size);
+   uint32_t alloc_size = anv_state_pool_get_bucket_size(bucket);
+   uint32_t idx[ANV_STATE_BATCH_MAX];
+
+   assert(count > 0 && count <= ANV_STATE_BATCH_MAX);
+
+   uint32_t n = anv_free_list_pop_chain(&pool->buckets[bucket].free_list,
+                                        &pool->table, idx, count);
+   for (uint32_t i = 0; i < n; i++)
+      states[i] = *anv_state_table_get(&pool->table, idx[i]);
+   if (n > 0)
+      return n;
+
+   /* Split a power of two number of states from a chunk that still fits in
+    * a bucket.
+    */
+   count = 1u << util_logbase2(count);
+   while (count > 1 &&
+          alloc_size * count > (1u << ANV_MAX_STATE_SIZE_LOG2))
+      count /= 2;
+
+   struct anv_state chunk =
+      anv_state_pool_alloc_no_vg(pool, alloc_size * count, alloc_size);
+   anv_state_table_get(&pool->table, chunk.idx)->alloc_size = alloc_size;
+   chunk.alloc_size = alloc_size;
+   states[0] = chunk;
+
+   if (count > 1) {
+      uint32_t first;
+      UNUSED VkResult result =
+         anv_state_table_add(&pool->table, &first, count - 1);
+      assert(result == VK_SUCCESS);
+
+      for (uint32_t i = 1; i < count; i++) {
+         struct anv_state *state =
+            anv_state_table_get(&pool->table, first + i - 1);
+         state->offset = chunk.offset + alloc_size * i;
+         state->alloc_size = alloc_size;
+         state->map = chunk.map + alloc_size * i;
+         states[i] = *state;
+      }
+   }
+
+   return count;
+}
+
+/** Frees states of the same size at once, with a single compare-and-swap. */
+void
+anv_state_pool_free_batch(struct anv_state_pool *pool,
+                          const struct anv_state *states, uint32_t count)
+{
+   assert(count > 0);
+   assert(util_is_power_of_two_nonzero(states[0].alloc_size));
+   unsigned bucket = anv_state_pool_get_bucket(states[0].alloc_size);
+
+   for (uint32_t i = 0; i + 1 < count; i++) {
+      assert(states[i].offset >= pool->start_offset);
+      assert(states[i + 1].alloc_size == states[0].alloc_size);
+      pool->table.map[states[i].idx].next = states[i + 1].idx;
+   }
+
+   anv_free_list_push_chain(&pool->buckets[bucket].free_list, &pool->table,
+                            states[0].idx, states[count - 1].idx);
+}
+
+/* The state cache keeps free states of one size for a single thread, or a
+ * set of externally synchronized users like the command buffers of a
+ * command pool. It refills from the state pool and flushes back to it in
+ * batches, so the shared free lists, and the cache lines holding them, are
+ * touched once per batch instead of once per state.
+ */
+void
+anv_state_cache_init(struct anv_state_cache *cache,
+                     struct anv_state_pool *pool, uint32_t size)
+{
+   assert(util_is_power_of_two_nonzero(size));
+
+   cache->pool = pool;
+   cache->size = size;
+   cache->count = 0;
+   cache->allocs = 0;
+   cache->refills = 0;
+   cache->flushes = 0;
+}
+
+void
+anv_state_cache_finish(struct anv_state_cache *cache)
+{
+   anv_state_cache_trim(cache);
+}
+
+/** Returns all the cached states to the pool. */
+void
+anv_state_cache_trim(struct anv_state_cache *cache)
+{
+   if (cache->count == 0)
+      return;
+
+   anv_state_pool_free_batch(cache->pool, cache->states, cache->count);
+   cache->count = 0;
+   cache->flushes++;
+}
+
+static struct anv_state
+anv_state_cache_alloc_no_vg(struct anv_state_cache *cache)
+{
+   if (cache->count == 0) {
+      cache->count = anv_state_pool_alloc_batch(cache->pool, cache->size,
+                                                cache->states,
+                                                ANV_STATE_CACHE_BATCH);
+      cache->refills++;
+   }
+
+   cache->allocs++;
+   return cache->states[--cache->count];
+}
+
+static void
+anv_state_cache_free_no_vg(struct anv_state_cache *cache,
+                           struct anv_state state)
+{
+   assert(state.alloc_size == cache->size);
+
+   if (cache->count == ARRAY_SIZE(cache->states)) {
+      /* Flush the oldest batch and keep the recently freed states, which
+       * are more likely to still be in the CPU caches.
+       */
+      anv_state_pool_free_batch(cache->pool, cache->states,
+                                ANV_STATE_CACHE_BATCH);
+      memmove(cache->states, cache->states + ANV_STATE_CACHE_BATCH,
+              (cache->count - ANV_STATE_CACHE_BATCH) *
+              sizeof(cache->states[0]));
+      cache->count -= ANV_STATE_CACHE_BATCH;
+      cache->flushes++;
+   }
+
+   cache->states[cache->count++] = state;
+}
+
+struct anv_state
+anv_state_cache_alloc(struct anv_state_cache *cache)
+{
+   struct anv_state state = anv_state_cache_alloc_no_vg(cache);
+   VG(VALGRIND_MEMPOOL_ALLOC(cache->pool, state.map, state.alloc_size));
+   return state;
+}
+
+void
+anv_state_cache_free(struct anv_state_cache *cache, struct anv_state state)
+{
+   VG(VALGRIND_MEMPOOL_FREE(cache->pool, state.map));
+   anv_state_cache_free_no_vg(cache, state);
+}
+
 struct anv_state_stream_block {
    struct anv_state block;
 
@@ -1203,6 +1409,7 @@ anv_state_stream_init(struct anv_state_stream *stream,
    stream->block_size = block_size;
 
    stream->block = ANV_STATE_NULL;
+   stream->cache = NULL;
 
    /* Ensure that next + whatever > block_size.  This way the first call to
     * state_stream_alloc fetches a new block.
@@ -1214,13 +1421,28 @@ anv_state_stream_init(struct anv_state_stream *stream,
    VG(VALGRIND_CREATE_MEMPOOL(stream, 0, false));
 }
 
+/* Like anv_state_stream_init(), but blocks of the cache's size are taken
+ * from and returned to the cache. The stream must only be used by the
+ * cache's users.
+ */
+void
+anv_state_stream_init_cached(struct anv_state_stream *stream,
+                             struct anv_state_cache *cache)
+{
+   anv_state_stream_init(stream, cache->pool, cache->size);
+   stream->cache = cache;
+}
+
 void
 anv_state_stream_finish(struct anv_state_stream *stream)
 {
    util_dynarray_foreach(&stream->all_blocks, struct anv_state, block) {
       VG(VALGRIND_MEMPOOL_FREE(stream, block->map));
       VG(VALGRIND_MAKE_MEM_NOACCESS(block->map, block->alloc_size));
-      anv_state_pool_free_no_vg(stream->state_pool, *block);
+      if (stream->cache && block->alloc_size == stream->cache->size)
+         anv_state_cache_free_no_vg(stream->cache, *block);
+      else
+         anv_state_pool_free_no_vg(stream->state_pool, *block);
    }
    util_dynarray_fini(&stream->all_blocks);
 
@@ -1242,8 +1464,12 @@ anv_state_stream_alloc(struct anv_state_stream *stream,
       if (block_size < size)
          block_size = round_to_power_of_two(size);
 
-      stream->block = anv_state_pool_alloc_no_vg(stream->state_pool,
-                                                 block_size, PAGE_SIZE);
+      if (stream->cache && block_size == stream->cache->size) {
+         stream->block = anv_state_cache_alloc_no_vg(stream->cache);
+      } else {
+         stream->block = anv_state_pool_alloc_no_vg(stream->state_pool,
+                                                    block_size, PAGE_SIZE);
+      }
       util_dynarray_append(&stream->all_blocks,
                            struct anv_state, stream->block);
       VG(VALGRIND_MAKE_MEM_NOACCESS(stream->block.map, block_size));
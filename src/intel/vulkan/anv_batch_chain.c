@@ -807,6 +807,16 @@ anv_cmd_buffer_alloc_dynamic_state(struct anv_cmd_buffer *cmd_buffer,
                                  size, alignment);
 }
 
+static void
+anv_cmd_buffer_free_binding_table_block(struct anv_cmd_buffer *cmd_buffer,
+                                        struct anv_state bt_block)
+{
+   if (cmd_buffer->device->physical->use_softpin)
+      anv_state_cache_free(&cmd_buffer->pool->binding_table_cache, bt_block);
+   else
+      anv_binding_table_pool_free(cmd_buffer->device, bt_block);
+}
+
 VkResult
 anv_cmd_buffer_new_binding_table_block(struct anv_cmd_buffer *cmd_buffer)
 {
@@ -816,7 +826,12 @@ anv_cmd_buffer_new_binding_table_block(struct anv_cmd_buffer *cmd_buffer)
       return vk_error(VK_ERROR_OUT_OF_HOST_MEMORY);
    }
 
-   *bt_block = anv_binding_table_pool_alloc(cmd_buffer->device);
+   if (cmd_buffer->device->physical->use_softpin) {
+      *bt_block =
+         anv_state_cache_alloc(&cmd_buffer->pool->binding_table_cache);
+   } else {
+      *bt_block = anv_binding_table_pool_alloc(cmd_buffer->device);
+   }
 
    /* The bt_next state is a rolling state (we update it as we suballocate
     * from it) which is relative to the start of the binding table block.
@@ -895,7 +910,7 @@ anv_cmd_buffer_fini_batch_bo_chain(struct anv_cmd_buffer *cmd_buffer)
 {
    struct anv_state *bt_block;
    u_vector_foreach(bt_block, &cmd_buffer->bt_block_states)
-      anv_binding_table_pool_free(cmd_buffer->device, *bt_block);
+      anv_cmd_buffer_free_binding_table_block(cmd_buffer, *bt_block);
    u_vector_finish(&cmd_buffer->bt_block_states);
 
    anv_reloc_list_finish(&cmd_buffer->surface_relocs, &cmd_buffer->pool->alloc);
@@ -928,7 +943,7 @@ anv_cmd_buffer_reset_batch_bo_chain(struct anv_cmd_buffer *cmd_buffer)
 
    while (u_vector_length(&cmd_buffer->bt_block_states) > 1) {
       struct anv_state *bt_block = u_vector_remove(&cmd_buffer->bt_block_states);
-      anv_binding_table_pool_free(cmd_buffer->device, *bt_block);
+      anv_cmd_buffer_free_binding_table_block(cmd_buffer, *bt_block);
    }
    assert(u_vector_length(&cmd_buffer->bt_block_states) == 1);
    cmd_buffer->bt_next = *(struct anv_state *)u_vector_head(&cmd_buffer->bt_block_states);
@@ -1862,8 +1877,14 @@ anv_queue_execbuf_locked(struct anv_queue *queue,
    struct anv_device *device = queue->device;
    struct anv_execbuf execbuf;
    anv_execbuf_init(&execbuf);
-   execbuf.alloc = submit->alloc;
-   execbuf.alloc_scope = submit->alloc_scope;
+   /* Start from the arrays left over by the previous submission on this
+    * queue. They outlive the submit, so they come from the device allocator.
+    */
+   execbuf.objects = queue->exec_objects;
+   execbuf.bos = queue->exec_bos;
+   execbuf.array_length = queue->exec_array_length;
+   execbuf.alloc = &device->vk.alloc;
+   execbuf.alloc_scope = VK_SYSTEM_ALLOCATION_SCOPE_DEVICE;
    execbuf.perf_query_pass = submit->perf_query_pass;
 
    /* Always add the workaround BO as it includes a driver identifier for the
@@ -2046,6 +2067,13 @@ anv_queue_execbuf_locked(struct anv_queue *queue,
  error:
    pthread_cond_broadcast(&device->queue_submit);
 
+   /* Hand the (possibly regrown) arrays back to the queue for next time. */
+   queue->exec_objects = execbuf.objects;
+   queue->exec_bos = execbuf.bos;
+   queue->exec_array_length = execbuf.array_length;
+   execbuf.objects = NULL;
+   execbuf.bos = NULL;
+
    anv_execbuf_finish(&execbuf);
 
    return result;
@@ -271,12 +271,12 @@ static VkResult anv_create_cmd_buffer(
    if (result != VK_SUCCESS)
       goto fail;
 
-   anv_state_stream_init(&cmd_buffer->surface_state_stream,
-                         &device->surface_state_pool, 4096);
-   anv_state_stream_init(&cmd_buffer->dynamic_state_stream,
-                         &device->dynamic_state_pool, 16384);
-   anv_state_stream_init(&cmd_buffer->general_state_stream,
-                         &device->general_state_pool, 16384);
+   anv_state_stream_init_cached(&cmd_buffer->surface_state_stream,
+                                &pool->surface_state_cache);
+   anv_state_stream_init_cached(&cmd_buffer->dynamic_state_stream,
+                                &pool->dynamic_state_cache);
+   anv_state_stream_init_cached(&cmd_buffer->general_state_stream,
+                                &pool->general_state_cache);
 
    cmd_buffer->self_mod_locations = NULL;
 
@@ -370,16 +370,16 @@ anv_cmd_buffer_reset(struct anv_cmd_buffer *cmd_buffer)
    anv_cmd_state_reset(cmd_buffer);
 
    anv_state_stream_finish(&cmd_buffer->surface_state_stream);
-   anv_state_stream_init(&cmd_buffer->surface_state_stream,
-                         &cmd_buffer->device->surface_state_pool, 4096);
+   anv_state_stream_init_cached(&cmd_buffer->surface_state_stream,
+                                &cmd_buffer->pool->surface_state_cache);
 
    anv_state_stream_finish(&cmd_buffer->dynamic_state_stream);
-   anv_state_stream_init(&cmd_buffer->dynamic_state_stream,
-                         &cmd_buffer->device->dynamic_state_pool, 16384);
+   anv_state_stream_init_cached(&cmd_buffer->dynamic_state_stream,
+                                &cmd_buffer->pool->dynamic_state_cache);
 
    anv_state_stream_finish(&cmd_buffer->general_state_stream);
-   anv_state_stream_init(&cmd_buffer->general_state_stream,
-                         &cmd_buffer->device->general_state_pool, 16384);
+   anv_state_stream_init_cached(&cmd_buffer->general_state_stream,
+                                &cmd_buffer->pool->general_state_cache);
 
    anv_measure_reset(cmd_buffer);
    return VK_SUCCESS;
@@ -1153,6 +1153,21 @@ VkResult anv_CreateCommandPool(
 
    pool->flags = pCreateInfo->flags;
 
+   anv_state_cache_init(&pool->surface_state_cache,
+                        &device->surface_state_pool, 4096);
+   anv_state_cache_init(&pool->dynamic_state_cache,
+                        &device->dynamic_state_pool, 16384);
+   anv_state_cache_init(&pool->general_state_cache,
+                        &device->general_state_pool, 16384);
+   if (device->physical->use_softpin) {
+      anv_state_cache_init(&pool->binding_table_cache,
+                           &device->binding_table_pool,
+                           device->binding_table_pool.block_size);
+   } else {
+      memset(&pool->binding_table_cache, 0,
+             sizeof(pool->binding_table_cache));
+   }
+
    *pCmdPool = anv_cmd_pool_to_handle(pool);
 
    return VK_SUCCESS;
@@ -1174,6 +1189,22 @@ void anv_DestroyCommandPool(
       anv_cmd_buffer_destroy(cmd_buffer);
    }
 
+   struct anv_state_cache *caches[] = {
+      &pool->surface_state_cache,
+      &pool->dynamic_state_cache,
+      &pool->general_state_cache,
+      &pool->binding_table_cache,
+   };
+   for (unsigned i = 0; i < ARRAY_SIZE(caches); i++) {
+      if (INTEL_DEBUG & DEBUG_PERF) {
+         mesa_logd("command pool state cache %u: %"PRIu64" allocations, "
+                   "%"PRIu64" refills, %"PRIu64" flushes",
+                   i, caches[i]->allocs, caches[i]->refills,
+                   caches[i]->flushes);
+      }
+      anv_state_cache_finish(caches[i]);
+   }
+
    vk_object_base_finish(&pool->base);
    vk_free2(&device->vk.alloc, pAllocator, pool);
 }
@@ -1198,7 +1229,12 @@ void anv_TrimCommandPool(
     VkCommandPool                               commandPool,
     VkCommandPoolTrimFlags                      flags)
 {
-   /* Nothing for us to do here.  Our pools stay pretty tidy. */
+   ANV_FROM_HANDLE(anv_cmd_pool, pool, commandPool);
+
+   anv_state_cache_trim(&pool->surface_state_cache);
+   anv_state_cache_trim(&pool->dynamic_state_cache);
+   anv_state_cache_trim(&pool->general_state_cache);
+   anv_state_cache_trim(&pool->binding_table_cache);
 }
 
 /**
@@ -40,6 +40,7 @@
 #include "util/os_file.h"
 #include "util/os_misc.h"
 #include "util/u_atomic.h"
+#include "util/u_cpu_detect.h"
 #include "util/u_string.h"
 #include "util/driconf.h"
 #include "git_sha1.h"
@@ -3243,6 +3244,24 @@ VkResult anv_CreateDevice(
    anv_pipeline_cache_init(&device->default_pipeline_cache, device,
                            true /* cache_enabled */, false /* external_sync */);
 
+   /* A pipeline has at most one backend compile per stage, and the calling
+    * thread takes one of them. Shader dumps would interleave, so they keep
+    * the serial path. Failing to create the queue isn't fatal either, the
+    * stages are then compiled serially.
+    */
+   memset(&device->compile_queue, 0, sizeof(device->compile_queue));
+   util_cpu_detect();
+   unsigned num_compile_threads = MIN2(util_get_cpu_caps()->nr_cpus - 1,
+                                       MESA_SHADER_FRAGMENT);
+   if (num_compile_threads &&
+       !(INTEL_DEBUG & (DEBUG_VS | DEBUG_TCS | DEBUG_TES | DEBUG_GS |
+                        DEBUG_WM))) {
+      util_queue_init(&device->compile_queue, "anv_sh", 32,
+                      num_compile_threads,
+                      UTIL_QUEUE_INIT_RESIZE_IF_FULL |
+                      UTIL_QUEUE_INIT_SHARED_THREADS);
+   }
+
    anv_device_init_blorp(device);
 
    anv_device_init_border_colors(device);
@@ -3319,6 +3338,9 @@ void anv_DestroyDevice(
 
    anv_device_finish_blorp(device);
 
+   if (util_queue_is_initialized(&device->compile_queue))
+      util_queue_destroy(&device->compile_queue);
+
    anv_pipeline_cache_finish(&device->default_pipeline_cache);
 
 #ifdef HAVE_VALGRIND
@@ -774,10 +774,9 @@ anv_pipeline_link_vs(const struct brw_compiler *compiler,
 }
 
 static void
-anv_pipeline_compile_vs(const struct brw_compiler *compiler,
-                        void *mem_ctx,
-                        struct anv_graphics_pipeline *pipeline,
-                        struct anv_pipeline_stage *vs_stage)
+anv_pipeline_compute_vs_vue_map(const struct brw_compiler *compiler,
+                                struct anv_graphics_pipeline *pipeline,
+                                struct anv_pipeline_stage *vs_stage)
 {
    /* When using Primitive Replication for multiview, each view gets its own
     * position slot.
@@ -790,7 +789,14 @@ anv_pipeline_compile_vs(const struct brw_compiler *compiler,
                        vs_stage->nir->info.outputs_written,
                        vs_stage->nir->info.separate_shader,
                        pos_slots);
+}
 
+static void
+anv_pipeline_compile_vs(const struct brw_compiler *compiler,
+                        void *mem_ctx,
+                        struct anv_graphics_pipeline *pipeline,
+                        struct anv_pipeline_stage *vs_stage)
+{
    vs_stage->num_stats = 1;
    vs_stage->code = brw_compile_vs(compiler, pipeline->base.device, mem_ctx,
                                    &vs_stage->key.vs,
@@ -926,17 +932,22 @@ anv_pipeline_link_gs(const struct brw_compiler *compiler,
 }
 
 static void
-anv_pipeline_compile_gs(const struct brw_compiler *compiler,
-                        void *mem_ctx,
-                        struct anv_device *device,
-                        struct anv_pipeline_stage *gs_stage,
-                        struct anv_pipeline_stage *prev_stage)
+anv_pipeline_compute_gs_vue_map(const struct brw_compiler *compiler,
+                                struct anv_pipeline_stage *gs_stage)
 {
    brw_compute_vue_map(compiler->devinfo,
                        &gs_stage->prog_data.gs.base.vue_map,
                        gs_stage->nir->info.outputs_written,
                        gs_stage->nir->info.separate_shader, 1);
+}
 
+static void
+anv_pipeline_compile_gs(const struct brw_compiler *compiler,
+                        void *mem_ctx,
+                        struct anv_device *device,
+                        struct anv_pipeline_stage *gs_stage,
+                        struct anv_pipeline_stage *prev_stage)
+{
    gs_stage->num_stats = 1;
    gs_stage->code = brw_compile_gs(compiler, device, mem_ctx,
                                    &gs_stage->key.gs,
@@ -1235,6 +1246,111 @@ anv_pipeline_init_from_cached_graphics(struct anv_graphics_pipeline *pipeline)
    pipeline->use_primitive_replication = pos_slots > 1;
 }
 
+struct anv_stage_compile_job {
+   const struct brw_compiler *compiler;
+   struct anv_graphics_pipeline *pipeline;
+   struct anv_pipeline_stage *stage;
+   struct anv_pipeline_stage *prev_stage;
+   void *mem_ctx;
+   struct util_queue_fence fence;
+};
+
+static void
+anv_stage_compile_job_execute(void *data, UNUSED int thread_index)
+{
+   struct anv_stage_compile_job *job = data;
+   struct anv_device *device = job->pipeline->base.device;
+
+   int64_t stage_start = os_time_get_nano();
+
+   switch (job->stage->stage) {
+   case MESA_SHADER_VERTEX:
+      anv_pipeline_compile_vs(job->compiler, job->mem_ctx, job->pipeline,
+                              job->stage);
+      break;
+   case MESA_SHADER_TESS_CTRL:
+      anv_pipeline_compile_tcs(job->compiler, job->mem_ctx, device,
+                               job->stage, job->prev_stage);
+      break;
+   case MESA_SHADER_TESS_EVAL:
+      anv_pipeline_compile_tes(job->compiler, job->mem_ctx, device,
+                               job->stage, job->prev_stage);
+      break;
+   case MESA_SHADER_GEOMETRY:
+      anv_pipeline_compile_gs(job->compiler, job->mem_ctx, device,
+                              job->stage, job->prev_stage);
+      break;
+   case MESA_SHADER_FRAGMENT:
+      anv_pipeline_compile_fs(job->compiler, job->mem_ctx, device,
+                              job->stage, job->prev_stage);
+      break;
+   default:
+      unreachable("Invalid graphics shader stage");
+   }
+
+   job->stage->feedback.duration += os_time_get_nano() - stage_start;
+}
+
+/* After linking, the backend compile of a stage only reads the NIR, key
+ * and prog_data of its own stage, plus the VUE map of the previous stage.
+ * The VS and GS VUE maps are computed before the compiles start, but the
+ * TCS and TES ones come out of the backend compiler, so the TES waits for
+ * the TCS and a fragment shader after a TES waits for the TES. The other
+ * stages are compiled concurrently, the calling thread compiles the vertex
+ * shader.
+ */
+static void
+anv_pipeline_compile_stages(struct anv_device *device,
+                            struct anv_stage_compile_job *jobs)
+{
+   unsigned num_jobs = 0;
+   for (unsigned s = 0; s < MESA_SHADER_STAGES; s++) {
+      if (jobs[s].stage)
+         num_jobs++;
+   }
+
+   if (num_jobs < 2 || !util_queue_is_initialized(&device->compile_queue)) {
+      for (unsigned s = 0; s < MESA_SHADER_STAGES; s++) {
+         if (jobs[s].stage)
+            anv_stage_compile_job_execute(&jobs[s], 0);
+      }
+      return;
+   }
+
+   assert(jobs[MESA_SHADER_VERTEX].stage);
+   for (unsigned s = MESA_SHADER_VERTEX + 1; s < MESA_SHADER_STAGES; s++) {
+      struct anv_stage_compile_job *job = &jobs[s];
+      if (!job->stage)
+         continue;
+
+      struct util_queue_fence *wait_fence = NULL;
+      if (s == MESA_SHADER_TESS_EVAL ||
+          (s == MESA_SHADER_FRAGMENT &&
+           job->prev_stage->stage == MESA_SHADER_TESS_EVAL))
+         wait_fence = &jobs[job->prev_stage->stage].fence;
+
+      util_queue_fence_init(&job->fence);
+      if (wait_fence) {
+         util_queue_add_job_after(&device->compile_queue, job, &job->fence,
+                                  wait_fence, anv_stage_compile_job_execute,
+                                  NULL, 0);
+      } else {
+         util_queue_add_job(&device->compile_queue, job, &job->fence,
+                            anv_stage_compile_job_execute, NULL, 0);
+      }
+   }
+
+   anv_stage_compile_job_execute(&jobs[MESA_SHADER_VERTEX], 0);
+
+   for (unsigned s = MESA_SHADER_VERTEX + 1; s < MESA_SHADER_STAGES; s++) {
+      if (!jobs[s].stage)
+         continue;
+
+      util_queue_fence_wait(&jobs[s].fence);
+      util_queue_fence_destroy(&jobs[s].fence);
+   }
+}
+
 static VkResult
 anv_pipeline_compile_graphics(struct anv_graphics_pipeline *pipeline,
                               struct anv_pipeline_cache *cache,
@@ -1292,6 +1408,11 @@ anv_pipeline_compile_graphics(struct anv_graphics_pipeline *pipeline,
                               pipeline->subpass,
                               raster_enabled ? info->pMultisampleState : NULL,
                               &stages[stage].key.wm);
+         /* Trade some shader performance for compile time when the
+          * application asks for it.
+          */
+         stages[stage].key.wm.single_dispatch_width =
+            info->flags & VK_PIPELINE_CREATE_DISABLE_OPTIMIZATION_BIT;
          break;
       }
       default:
@@ -1497,6 +1618,9 @@ anv_pipeline_compile_graphics(struct anv_graphics_pipeline *pipeline,
       prev_stage = &stages[s];
    }
 
+   struct anv_stage_compile_job jobs[MESA_SHADER_STAGES] = {};
+   nir_xfb_info *xfb_info[MESA_SHADER_STAGES] = {};
+
    prev_stage = NULL;
    for (unsigned s = 0; s < MESA_SHADER_STAGES; s++) {
       if (!stages[s].entrypoint)
@@ -1504,42 +1628,47 @@ anv_pipeline_compile_graphics(struct anv_graphics_pipeline *pipeline,
 
       int64_t stage_start = os_time_get_nano();
 
+      /* Each stage gets its own memory context, so the backend compiles
+       * never allocate from a context shared with another thread.
+       */
       void *stage_ctx = ralloc_context(NULL);
+      ralloc_steal(stage_ctx, stages[s].nir);
 
-      nir_xfb_info *xfb_info = NULL;
       if (s == MESA_SHADER_VERTEX ||
           s == MESA_SHADER_TESS_EVAL ||
           s == MESA_SHADER_GEOMETRY)
-         xfb_info = nir_gather_xfb_info(stages[s].nir, stage_ctx);
+         xfb_info[s] = nir_gather_xfb_info(stages[s].nir, stage_ctx);
+
+      if (s == MESA_SHADER_VERTEX)
+         anv_pipeline_compute_vs_vue_map(compiler, pipeline, &stages[s]);
+      else if (s == MESA_SHADER_GEOMETRY)
+         anv_pipeline_compute_gs_vue_map(compiler, &stages[s]);
+
+      jobs[s] = (struct anv_stage_compile_job) {
+         .compiler = compiler,
+         .pipeline = pipeline,
+         .stage = &stages[s],
+         .prev_stage = prev_stage,
+         .mem_ctx = stage_ctx,
+      };
+
+      stages[s].feedback.duration += os_time_get_nano() - stage_start;
+
+      prev_stage = &stages[s];
+   }
+
+   anv_pipeline_compile_stages(pipeline->base.device, jobs);
+
+   result = VK_SUCCESS;
+   for (unsigned s = 0; s < MESA_SHADER_STAGES; s++) {
+      if (!stages[s].entrypoint)
+         continue;
+
+      int64_t stage_start = os_time_get_nano();
 
-      switch (s) {
-      case MESA_SHADER_VERTEX:
-         anv_pipeline_compile_vs(compiler, stage_ctx, pipeline,
-                                 &stages[s]);
-         break;
-      case MESA_SHADER_TESS_CTRL:
-         anv_pipeline_compile_tcs(compiler, stage_ctx, pipeline->base.device,
-                                  &stages[s], prev_stage);
-         break;
-      case MESA_SHADER_TESS_EVAL:
-         anv_pipeline_compile_tes(compiler, stage_ctx, pipeline->base.device,
-                                  &stages[s], prev_stage);
-         break;
-      case MESA_SHADER_GEOMETRY:
-         anv_pipeline_compile_gs(compiler, stage_ctx, pipeline->base.device,
-                                 &stages[s], prev_stage);
-         break;
-      case MESA_SHADER_FRAGMENT:
-         anv_pipeline_compile_fs(compiler, stage_ctx, pipeline->base.device,
-                                 &stages[s], prev_stage);
-         break;
-      default:
-         unreachable("Invalid graphics shader stage");
-      }
       if (stages[s].code == NULL) {
-         ralloc_free(stage_ctx);
          result = vk_error(VK_ERROR_OUT_OF_HOST_MEMORY);
-         goto fail;
+         break;
       }
 
       anv_nir_validate_push_layout(&stages[s].prog_data.base,
@@ -1554,23 +1683,25 @@ anv_pipeline_compile_graphics(struct anv_graphics_pipeline *pipeline,
                                   &stages[s].prog_data.base,
                                   brw_prog_data_size(s),
                                   stages[s].stats, stages[s].num_stats,
-                                  xfb_info, &stages[s].bind_map);
+                                  xfb_info[s], &stages[s].bind_map);
       if (!bin) {
-         ralloc_free(stage_ctx);
          result = vk_error(VK_ERROR_OUT_OF_HOST_MEMORY);
-         goto fail;
+         break;
       }
 
       anv_pipeline_add_executables(&pipeline->base, &stages[s], bin);
 
       pipeline->shaders[s] = bin;
-      ralloc_free(stage_ctx);
 
       stages[s].feedback.duration += os_time_get_nano() - stage_start;
-
-      prev_stage = &stages[s];
    }
 
+   for (unsigned s = 0; s < MESA_SHADER_STAGES; s++)
+      ralloc_free(jobs[s].mem_ctx);
+
+   if (result != VK_SUCCESS)
+      goto fail;
+
    ralloc_free(pipeline_ctx);
 
 done:
@@ -58,6 +58,7 @@
 #include "util/list.h"
 #include "util/sparse_array.h"
 #include "util/u_atomic.h"
+#include "util/u_queue.h"
 #include "util/u_vector.h"
 #include "util/u_math.h"
 #include "util/vma.h"
@@ -721,9 +722,32 @@ struct anv_state_reserved_pool {
    uint32_t count;
 };
 
+/* The most states anv_state_pool_alloc_batch() returns at once */
+#define ANV_STATE_BATCH_MAX 64
+
+#define ANV_STATE_CACHE_BATCH 16
+
+struct anv_state_cache {
+   struct anv_state_pool *pool;
+
+   /* The alloc_size of all the states in the cache */
+   uint32_t size;
+
+   uint32_t count;
+   struct anv_state states[2 * ANV_STATE_CACHE_BATCH];
+
+   /* Statistics */
+   uint64_t allocs;
+   uint64_t refills;
+   uint64_t flushes;
+};
+
 struct anv_state_stream {
    struct anv_state_pool *state_pool;
 
+   /* Optional cache that blocks of block_size come from */
+   struct anv_state_cache *cache;
+
    /* The size of blocks to allocate from the state pool */
    uint32_t block_size;
 
@@ -764,9 +788,21 @@ struct anv_state anv_state_pool_alloc(struct anv_state_pool *pool,
                                       uint32_t state_size, uint32_t alignment);
 struct anv_state anv_state_pool_alloc_back(struct anv_state_pool *pool);
 void anv_state_pool_free(struct anv_state_pool *pool, struct anv_state state);
+uint32_t anv_state_pool_alloc_batch(struct anv_state_pool *pool, uint32_t size,
+                                    struct anv_state *states, uint32_t count);
+void anv_state_pool_free_batch(struct anv_state_pool *pool,
+                               const struct anv_state *states, uint32_t count);
+void anv_state_cache_init(struct anv_state_cache *cache,
+                          struct anv_state_pool *pool, uint32_t size);
+void anv_state_cache_finish(struct anv_state_cache *cache);
+void anv_state_cache_trim(struct anv_state_cache *cache);
+struct anv_state anv_state_cache_alloc(struct anv_state_cache *cache);
+void anv_state_cache_free(struct anv_state_cache *cache, struct anv_state state);
 void anv_state_stream_init(struct anv_state_stream *stream,
                            struct anv_state_pool *state_pool,
                            uint32_t block_size);
+void anv_state_stream_init_cached(struct anv_state_stream *stream,
+                                  struct anv_state_cache *cache);
 void anv_state_stream_finish(struct anv_state_stream *stream);
 struct anv_state anv_state_stream_alloc(struct anv_state_stream *stream,
                                         uint32_t size, uint32_t alignment);
@@ -1099,6 +1135,15 @@ struct anv_queue {
 
    /* Set to true to stop the submission thread */
    bool                                      quit;
+
+   /*
+    * Execbuf object and BO arrays kept from the previous submission so that
+    * resubmitting the same command buffers doesn't regrow them every time.
+    * Only accessed with the device mutex held.
+    */
+   struct drm_i915_gem_exec_object2 *        exec_objects;
+   struct anv_bo **                          exec_bos;
+   uint32_t                                  exec_array_length;
 };
 
 struct anv_pipeline_cache {
@@ -1229,6 +1274,9 @@ struct anv_device {
     struct anv_pipeline_cache                   default_pipeline_cache;
     struct blorp_context                        blorp;
 
+    /** Queue for compiling the stages of a pipeline concurrently */
+    struct util_queue                           compile_queue;
+
     struct anv_state                            border_colors;
 
     struct anv_state                            slice_hash;
@@ -2874,6 +2922,16 @@ struct anv_cmd_pool {
    struct list_head                             cmd_buffers;
 
    VkCommandPoolCreateFlags                     flags;
+
+   /* Recording into the command buffers of a pool is externally
+    * synchronized, so they share these caches in front of the device state
+    * pools without any locking.
+    */
+   struct anv_state_cache                       surface_state_cache;
+   struct anv_state_cache                       dynamic_state_cache;
+   struct anv_state_cache                       general_state_cache;
+   /* Only used with softpin */
+   struct anv_state_cache                       binding_table_cache;
 };
 
 #define ANV_CMD_BUFFER_BATCH_SIZE 8192
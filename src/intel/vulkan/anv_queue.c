@@ -516,6 +516,9 @@ anv_queue_init(struct anv_device *device, struct anv_queue *queue,
    queue->exec_flags = exec_flags;
    queue->lost = false;
    queue->quit = false;
+   queue->exec_objects = NULL;
+   queue->exec_bos = NULL;
+   queue->exec_array_length = 0;
 
    list_inithead(&queue->queued_submits);
 
@@ -564,6 +567,9 @@ anv_queue_finish(struct anv_queue *queue)
       pthread_mutex_destroy(&queue->mutex);
    }
 
+   vk_free(&queue->device->vk.alloc, queue->exec_objects);
+   vk_free(&queue->device->vk.alloc, queue->exec_bos);
+
    vk_object_base_finish(&queue->base);
 }
 
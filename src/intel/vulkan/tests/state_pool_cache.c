@@ -0,0 +1,134 @@
+/*
+ * Copyright © 2021 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <pthread.h>
+
+#include "anv_private.h"
+#include "test_common.h"
+
+#define NUM_THREADS 8
+#define STATES_PER_THREAD_LOG2 10
+#define STATES_PER_THREAD (1 << STATES_PER_THREAD_LOG2)
+
+struct job {
+   struct anv_state_pool *pool;
+   unsigned id;
+   pthread_t thread;
+} jobs[NUM_THREADS];
+
+pthread_barrier_t barrier;
+
+static void *alloc_states(void *void_job)
+{
+   struct job *job = void_job;
+
+   const unsigned chunk_size = 1 << (job->id % STATES_PER_THREAD_LOG2);
+   const unsigned num_chunks = STATES_PER_THREAD / chunk_size;
+
+   struct anv_state_cache cache;
+   struct anv_state states[chunk_size];
+
+   anv_state_cache_init(&cache, job->pool, 64);
+
+   pthread_barrier_wait(&barrier);
+
+   for (unsigned c = 0; c < num_chunks; c++) {
+      for (unsigned i = 0; i < chunk_size; i++) {
+         states[i] = anv_state_cache_alloc(&cache);
+         ASSERT(states[i].offset != 0);
+         ASSERT(states[i].alloc_size == 64);
+         memset(states[i].map, job->id, 64);
+      }
+
+      /* No other thread got the same states */
+      for (unsigned i = 0; i < chunk_size; i++) {
+         const uint8_t *map = states[i].map;
+         for (unsigned b = 0; b < 64; b++)
+            ASSERT(map[b] == job->id);
+      }
+
+      for (unsigned i = 0; i < chunk_size; i++)
+         anv_state_cache_free(&cache, states[i]);
+   }
+
+   ASSERT(cache.allocs == STATES_PER_THREAD);
+   anv_state_cache_finish(&cache);
+   ASSERT(cache.count == 0);
+
+   return NULL;
+}
+
+int main(void)
+{
+   struct anv_physical_device physical_device = { };
+   struct anv_device device = {
+      .physical = &physical_device,
+   };
+   struct anv_state_pool state_pool;
+
+   pthread_mutex_init(&device.mutex, NULL);
+   anv_bo_cache_init(&device.bo_cache);
+   anv_state_pool_init(&state_pool, &device, "test", 4096, 0, 4096);
+
+   /* Grab one so a zero offset is impossible */
+   anv_state_pool_alloc(&state_pool, 16, 16);
+
+   /* A batch is split from one allocation, and comes back off the free list
+    * in one piece.
+    */
+   {
+      struct anv_state states[ANV_STATE_CACHE_BATCH];
+      uint32_t count = anv_state_pool_alloc_batch(&state_pool, 64, states,
+                                                  ANV_STATE_CACHE_BATCH);
+      ASSERT(count == ANV_STATE_CACHE_BATCH);
+      for (unsigned i = 0; i < count; i++) {
+         ASSERT(states[i].alloc_size == 64);
+         ASSERT(states[i].offset % 64 == 0);
+         ASSERT(states[i].offset == states[0].offset + 64 * (int)i);
+      }
+
+      anv_state_pool_free_batch(&state_pool, states, count);
+
+      struct anv_state again[ANV_STATE_CACHE_BATCH];
+      ASSERT(anv_state_pool_alloc_batch(&state_pool, 64, again,
+                                        ANV_STATE_CACHE_BATCH) == count);
+      for (unsigned i = 0; i < count; i++)
+         ASSERT(again[i].idx == states[i].idx);
+
+      anv_state_pool_free_batch(&state_pool, again, count);
+   }
+
+   pthread_barrier_init(&barrier, NULL, NUM_THREADS);
+
+   for (unsigned i = 0; i < NUM_THREADS; i++) {
+      jobs[i].pool = &state_pool;
+      jobs[i].id = i;
+      pthread_create(&jobs[i].thread, NULL, alloc_states, &jobs[i]);
+   }
+
+   for (unsigned i = 0; i < NUM_THREADS; i++)
+      pthread_join(jobs[i].thread, NULL);
+
+   anv_state_pool_finish(&state_pool);
+   pthread_mutex_destroy(&device.mutex);
+}
@@ -58,6 +58,7 @@
 #endif
 
 #include "util/macros.h"
+#include "util/simple_mtx.h"
 
 #define __IS_LOADER
 #include "pci_id_driver_map.h"
@@ -464,10 +465,57 @@ out:
    return driver;
 }
 
+/* Resolving the driver of a device reads the drirc files and queries the
+ * kernel for its PCI ids. The answer for a given device node doesn't change
+ * within a process, so remember it for the next screen on the same device.
+ */
+#define DRIVER_CACHE_SIZE 8
+
+static simple_mtx_t driver_cache_lock = _SIMPLE_MTX_INITIALIZER_NP;
+static struct {
+   dev_t rdev;
+   char *driver;
+} driver_cache[DRIVER_CACHE_SIZE];
+static unsigned driver_cache_count;
+
+static char *
+driver_cache_lookup(dev_t rdev)
+{
+   char *driver = NULL;
+
+   simple_mtx_lock(&driver_cache_lock);
+   for (unsigned i = 0; i < driver_cache_count; i++) {
+      if (driver_cache[i].rdev == rdev) {
+         driver = strdup(driver_cache[i].driver);
+         break;
+      }
+   }
+   simple_mtx_unlock(&driver_cache_lock);
+
+   return driver;
+}
+
+static void
+driver_cache_insert(dev_t rdev, const char *driver)
+{
+   simple_mtx_lock(&driver_cache_lock);
+   if (driver_cache_count < DRIVER_CACHE_SIZE) {
+      char *copy = strdup(driver);
+      if (copy) {
+         driver_cache[driver_cache_count].rdev = rdev;
+         driver_cache[driver_cache_count].driver = copy;
+         driver_cache_count++;
+      }
+   }
+   simple_mtx_unlock(&driver_cache_lock);
+}
+
 char *
 loader_get_driver_for_fd(int fd)
 {
    char *driver;
+   struct stat sbuf;
+   bool is_chr;
 
    /* Allow an environment variable to force choosing a different driver
     * binary.  If that driver binary can't survive on this FD, that's the
@@ -480,16 +528,24 @@ loader_get_driver_for_fd(int fd)
          return strdup(driver);
    }
 
+   is_chr = fstat(fd, &sbuf) == 0 && S_ISCHR(sbuf.st_mode);
+   if (is_chr) {
+      driver = driver_cache_lookup(sbuf.st_rdev);
+      if (driver)
+         return driver;
+   }
+
 #if defined(HAVE_LIBDRM) && defined(USE_DRICONF)
    driver = loader_get_dri_config_driver(fd);
-   if (driver)
-      return driver;
+   if (!driver)
 #endif
-
-   driver = loader_get_pci_driver(fd);
+      driver = loader_get_pci_driver(fd);
    if (!driver)
       driver = loader_get_kernel_driver_name(fd);
 
+   if (driver && is_chr)
+      driver_cache_insert(sbuf.st_rdev, driver);
+
    return driver;
 }
 
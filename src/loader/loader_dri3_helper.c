@@ -65,6 +65,11 @@ dri3_flush_present_events(struct loader_dri3_drawable *draw);
 static struct loader_dri3_buffer *
 dri3_find_back_alloc(struct loader_dri3_drawable *draw);
 
+/* Number of consecutive frames with an idle back buffer to spare after which
+ * an extra back buffer allocated for flips is released again.
+ */
+#define LOADER_DRI3_SPARE_BACK_FRAMES 300
+
 static xcb_screen_t *
 get_screen_for_root(xcb_connection_t *conn, xcb_window_t root)
 {
@@ -294,6 +299,13 @@ dri3_update_max_num_back(struct loader_dri3_drawable *draw)
             draw->cur_num_back = 2;
 
          draw->max_num_back = new_max;
+      } else if (draw->cur_num_back > 2 &&
+                 draw->num_spare_back_frames >= LOADER_DRI3_SPARE_BACK_FRAMES) {
+         /* A spare buffer has been idle for a while, so the compositor keeps
+          * up with fewer buffers. Drop one; it is reallocated if needed.
+          */
+         draw->cur_num_back--;
+         draw->num_spare_back_frames = 0;
       }
 
       break;
@@ -666,6 +678,23 @@ loader_dri3_wait_for_sbc(struct loader_dri3_drawable *draw,
    return 1;
 }
 
+/* Whether a back buffer other than the chosen one is idle, i.e. one fewer
+ * buffer would have been enough for this frame.
+ */
+static bool
+dri3_has_spare_back(struct loader_dri3_drawable *draw, int chosen_id)
+{
+   for (int b = 0; b < draw->cur_num_back; b++) {
+      int id = LOADER_DRI3_BACK_ID(b);
+      struct loader_dri3_buffer *buffer = draw->buffers[id];
+
+      if (id != chosen_id && buffer && !buffer->busy)
+         return true;
+   }
+
+   return false;
+}
+
 /** loader_dri3_find_back
  *
  * Find an idle back buffer. If there isn't one, then
@@ -677,6 +706,7 @@ dri3_find_back(struct loader_dri3_drawable *draw)
    int b;
    int num_to_consider;
    int max_num;
+   bool all_busy = false;
 
    mtx_lock(&draw->mtx);
    /* Increase the likelyhood of reusing current buffer */
@@ -701,11 +731,16 @@ dri3_find_back(struct loader_dri3_drawable *draw)
 
          if (!buffer || !buffer->busy) {
             draw->cur_back = id;
+            if (!all_busy && dri3_has_spare_back(draw, id))
+               draw->num_spare_back_frames++;
+            else
+               draw->num_spare_back_frames = 0;
             mtx_unlock(&draw->mtx);
             return id;
          }
       }
 
+      all_busy = true;
       if (num_to_consider < max_num) {
          num_to_consider = ++draw->cur_num_back;
       } else if (!dri3_wait_for_event_locked(draw, NULL)) {
@@ -148,6 +148,8 @@ struct loader_dri3_drawable {
    int cur_back;
    int cur_num_back;
    int max_num_back;
+   /* Consecutive frames in which more than one back buffer was idle */
+   int num_spare_back_frames;
    int cur_blit_source;
 
    uint32_t *stamp;
@@ -384,6 +384,13 @@ struct brw_cache {
    GLuint size, n_items;
 
    uint32_t next_offset;
+
+   /**
+    * The item most recently returned for each cache_id.  State upload asks
+    * for the same key over and over while it isn't changing, so checking
+    * this first lets us skip hashing the key and walking the bucket.
+    */
+   struct brw_cache_item *last_item[BRW_MAX_CACHE];
 };
 
 #define perf_debug(...) do {                                    \
@@ -171,20 +171,26 @@ brw_search_cache(struct brw_cache *cache, enum brw_cache_id cache_id,
                  const void *key, GLuint key_size, uint32_t *inout_offset,
                  void *inout_prog_data, bool flag_state)
 {
-   struct brw_cache_item *item;
-   struct brw_cache_item lookup;
-   GLuint hash;
+   struct brw_cache_item *item = cache->last_item[cache_id];
+
+   if (item == NULL || item->key_size != key_size ||
+       memcmp(item->key, key, key_size) != 0) {
+      struct brw_cache_item lookup;
+      GLuint hash;
 
-   lookup.cache_id = cache_id;
-   lookup.key = key;
-   lookup.key_size = key_size;
-   hash = hash_key(&lookup);
-   lookup.hash = hash;
+      lookup.cache_id = cache_id;
+      lookup.key = key;
+      lookup.key_size = key_size;
+      hash = hash_key(&lookup);
+      lookup.hash = hash;
 
-   item = search_cache(cache, hash, &lookup);
+      item = search_cache(cache, hash, &lookup);
 
-   if (item == NULL)
-      return false;
+      if (item == NULL)
+         return false;
+
+      cache->last_item[cache_id] = item;
+   }
 
    void *prog_data = ((char *) item->key) + item->key_size;
 
@@ -358,6 +364,7 @@ brw_upload_cache(struct brw_cache *cache,
    item->next = cache->items[hash];
    cache->items[hash] = item;
    cache->n_items++;
+   cache->last_item[cache_id] = item;
 
    *out_offset = item->offset;
    *(void **)out_prog_data = (void *)((char *)item->key + item->key_size);
@@ -412,6 +419,7 @@ brw_clear_cache(struct brw_context *brw, struct brw_cache *cache)
    }
 
    cache->n_items = 0;
+   memset(cache->last_item, 0, sizeof(cache->last_item));
 
    /* Start putting programs into the start of the BO again, since
     * we'll never find the old results.
@@ -1323,6 +1323,12 @@ _mesa_free_context_data(struct gl_context *ctx, bool destroy_debug_output)
       _mesa_make_current(ctx, NULL, NULL);
    }
 
+   /* Compiles running on other threads still use the context. */
+   if (util_queue_is_initialized(&ctx->ShaderCompileQueue)) {
+      util_queue_finish(&ctx->ShaderCompileQueue);
+      util_queue_destroy(&ctx->ShaderCompileQueue);
+   }
+
    /* unreference WinSysDraw/Read buffers */
    _mesa_reference_framebuffer(&ctx->WinSysDrawBuffer, NULL);
    _mesa_reference_framebuffer(&ctx->WinSysReadBuffer, NULL);
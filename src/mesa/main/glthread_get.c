@@ -67,6 +67,21 @@ _mesa_marshal_GetIntegerv(GLenum pname, GLint *p)
    case GL_DRAW_INDIRECT_BUFFER_BINDING:
       *p = ctx->GLThread.CurrentDrawIndirectBufferName;
       return;
+   case GL_ELEMENT_ARRAY_BUFFER_BINDING:
+      *p = ctx->GLThread.CurrentVAO->CurrentElementBufferName;
+      return;
+   case GL_PIXEL_PACK_BUFFER_BINDING:
+      *p = ctx->GLThread.CurrentPixelPackBufferName;
+      return;
+   case GL_PIXEL_UNPACK_BUFFER_BINDING:
+      *p = ctx->GLThread.CurrentPixelUnpackBufferName;
+      return;
+   case GL_VERTEX_ARRAY_BINDING:
+      *p = ctx->GLThread.CurrentVAO->Name;
+      return;
+   case GL_PRIMITIVE_RESTART_INDEX:
+      *p = ctx->GLThread.RestartIndex;
+      return;
 
    case GL_MATRIX_MODE:
       *p = ctx->GLThread.MatrixMode;
@@ -30,6 +30,7 @@
 #include "hint.h"
 
 #include "mtypes.h"
+#include "util/u_cpu_detect.h"
 
 
 
@@ -138,6 +139,23 @@ _mesa_MaxShaderCompilerThreadsKHR(GLuint count)
 
    ctx->Hint.MaxShaderCompilerThreads = count;
 
+   /* Run the GLSL compiler on other threads once the application has opted
+    * in.  A count of 0 makes compiles synchronous again.
+    */
+   if (count) {
+      util_cpu_detect();
+      unsigned num_threads = MIN2(count, util_get_cpu_caps()->nr_cpus);
+
+      if (!util_queue_is_initialized(&ctx->ShaderCompileQueue)) {
+         util_queue_init(&ctx->ShaderCompileQueue, "glsl", 64,
+                         util_get_cpu_caps()->nr_cpus,
+                         UTIL_QUEUE_INIT_RESIZE_IF_FULL |
+                         UTIL_QUEUE_INIT_SHARED_THREADS);
+      }
+      if (util_queue_is_initialized(&ctx->ShaderCompileQueue))
+         util_queue_adjust_num_threads(&ctx->ShaderCompileQueue, num_threads);
+   }
+
    if (ctx->Driver.SetMaxShaderCompilerThreads)
       ctx->Driver.SetMaxShaderCompilerThreads(ctx, count);
 }
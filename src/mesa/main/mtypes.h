@@ -2709,6 +2709,12 @@ struct gl_shader
 
    enum gl_compile_status CompileStatus;
 
+   /**
+    * Signalled once a compile running on gl_context::ShaderCompileQueue
+    * (GL_KHR_parallel_shader_compile) has finished.
+    */
+   struct util_queue_fence CompileFence;
+
 #ifdef DEBUG
    unsigned SourceChecksum;       /**< for debug/logging purposes */
 #endif
@@ -5576,6 +5582,12 @@ struct gl_context
    /*@}*/
 
    bool shader_builtin_ref;
+
+   /**
+    * GL_KHR_parallel_shader_compile: threads running the GLSL compiler.
+    * Only initialized once the application has asked for compiler threads.
+    */
+   struct util_queue ShaderCompileQueue;
 };
 
 /**
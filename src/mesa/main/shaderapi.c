@@ -1028,13 +1028,14 @@ get_shaderiv(struct gl_context *ctx, GLuint name, GLenum pname, GLint *params)
       *params = shader->DeletePending;
       break;
    case GL_COMPLETION_STATUS_ARB:
-      /* _mesa_glsl_compile_shader is not offloaded to other threads. */
-      *params = GL_TRUE;
+      *params = util_queue_fence_is_signalled(&shader->CompileFence);
       return;
    case GL_COMPILE_STATUS:
+      _mesa_wait_shader_compile(shader);
       *params = shader->CompileStatus ? GL_TRUE : GL_FALSE;
       break;
    case GL_INFO_LOG_LENGTH:
+      _mesa_wait_shader_compile(shader);
       *params = (shader->InfoLog && shader->InfoLog[0] != '\0') ?
          strlen(shader->InfoLog) + 1 : 0;
       break;
@@ -1100,6 +1101,7 @@ get_shader_info_log(struct gl_context *ctx, GLuint shader, GLsizei bufSize,
       return;
    }
 
+   _mesa_wait_shader_compile(sh);
    _mesa_copy_string(infoLog, bufSize, length, sh->InfoLog);
 }
 
@@ -1135,6 +1137,9 @@ set_shader_source(struct gl_shader *sh, const GLchar *source)
 {
    assert(sh);
 
+   /* A pending compile still reads the old source. */
+   _mesa_wait_shader_compile(sh);
+
    /* The GL_ARB_gl_spirv spec adds the following to the end of the description
     * of ShaderSource:
     *
@@ -1171,15 +1176,97 @@ ensure_builtin_types(struct gl_context *ctx)
    }
 }
 
+static void
+report_compile_errors(struct gl_context *ctx, struct gl_shader *sh)
+{
+   if (!sh->CompileStatus) {
+      if (ctx->_Shader->Flags & GLSL_DUMP_ON_ERROR) {
+         _mesa_log("GLSL source for %s shader %d:\n",
+                 _mesa_shader_stage_to_string(sh->Stage), sh->Name);
+         _mesa_log("%s\n", sh->Source);
+         _mesa_log("Info Log:\n%s\n", sh->InfoLog);
+      }
+
+      if (ctx->_Shader->Flags & GLSL_REPORT_ERRORS) {
+         _mesa_debug(ctx, "Error compiling shader %u:\n%s\n",
+                     sh->Name, sh->InfoLog);
+      }
+   }
+}
+
 /**
- * Compile a shader.
+ * Run the GLSL compiler on the shader source.  This only reads constant
+ * context state, so it may run on one of the ShaderCompileQueue threads.
  */
-void
-_mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
+static void
+compile_shader_source(struct gl_context *ctx, struct gl_shader *sh)
+{
+   if (ctx->_Shader->Flags & GLSL_DUMP) {
+      _mesa_log("GLSL source for %s shader %d:\n",
+              _mesa_shader_stage_to_string(sh->Stage), sh->Name);
+      _mesa_log("%s\n", sh->Source);
+   }
+
+   /* this call will set the shader->CompileStatus field to indicate if
+    * compilation was successful.
+    */
+   _mesa_glsl_compile_shader(ctx, sh, false, false, false);
+
+   if (ctx->_Shader->Flags & GLSL_LOG) {
+      _mesa_write_shader_to_file(sh);
+   }
+
+   if (ctx->_Shader->Flags & GLSL_DUMP) {
+      if (sh->CompileStatus) {
+         if (sh->ir) {
+            _mesa_log("GLSL IR for shader %d:\n", sh->Name);
+            _mesa_print_ir(_mesa_get_log_file(), sh->ir, NULL);
+         } else {
+            _mesa_log("No GLSL IR for shader %d (shader may be from "
+                      "cache)\n", sh->Name);
+         }
+         _mesa_log("\n\n");
+      } else {
+         _mesa_log("GLSL shader %d failed to compile.\n", sh->Name);
+      }
+      if (sh->InfoLog && sh->InfoLog[0] != 0) {
+         _mesa_log("GLSL shader %d info log:\n", sh->Name);
+         _mesa_log("%s\n", sh->InfoLog);
+      }
+   }
+
+   report_compile_errors(ctx, sh);
+}
+
+struct compile_shader_job
+{
+   struct gl_context *ctx;
+   struct gl_shader *sh;
+};
+
+static void
+compile_shader_execute(void *data, int thread_index)
+{
+   struct compile_shader_job *job = (struct compile_shader_job *) data;
+
+   compile_shader_source(job->ctx, job->sh);
+}
+
+static void
+compile_shader_cleanup(void *data, int thread_index)
+{
+   free(data);
+}
+
+static void
+compile_shader(struct gl_context *ctx, struct gl_shader *sh, bool allow_async)
 {
    if (!sh)
       return;
 
+   /* Only one compile of a shader can be in flight. */
+   _mesa_wait_shader_compile(sh);
+
    /* The GL_ARB_gl_spirv spec says:
     *
     *    "Add a new error for the CompileShader command:
@@ -1197,57 +1284,49 @@ _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
        * glShaderSource, we should fail to compile, but not raise a GL_ERROR.
        */
       sh->CompileStatus = COMPILE_FAILURE;
-   } else {
-      if (ctx->_Shader->Flags & GLSL_DUMP) {
-         _mesa_log("GLSL source for %s shader %d:\n",
-                 _mesa_shader_stage_to_string(sh->Stage), sh->Name);
-         _mesa_log("%s\n", sh->Source);
-      }
-
-      ensure_builtin_types(ctx);
-
-      /* this call will set the shader->CompileStatus field to indicate if
-       * compilation was successful.
-       */
-      _mesa_glsl_compile_shader(ctx, sh, false, false, false);
+      report_compile_errors(ctx, sh);
+      return;
+   }
 
-      if (ctx->_Shader->Flags & GLSL_LOG) {
-         _mesa_write_shader_to_file(sh);
-      }
+   ensure_builtin_types(ctx);
 
-      if (ctx->_Shader->Flags & GLSL_DUMP) {
-         if (sh->CompileStatus) {
-            if (sh->ir) {
-               _mesa_log("GLSL IR for shader %d:\n", sh->Name);
-               _mesa_print_ir(_mesa_get_log_file(), sh->ir, NULL);
-            } else {
-               _mesa_log("No GLSL IR for shader %d (shader may be from "
-                         "cache)\n", sh->Name);
-            }
-            _mesa_log("\n\n");
-         } else {
-            _mesa_log("GLSL shader %d failed to compile.\n", sh->Name);
-         }
-         if (sh->InfoLog && sh->InfoLog[0] != 0) {
-            _mesa_log("GLSL shader %d info log:\n", sh->Name);
-            _mesa_log("%s\n", sh->InfoLog);
-         }
+   /* Shader includes are looked up in the shared state while preprocessing,
+    * which isn't safe to do from another thread.
+    */
+   if (allow_async && ctx->Hint.MaxShaderCompilerThreads &&
+       util_queue_is_initialized(&ctx->ShaderCompileQueue) &&
+       !strstr(sh->Source, "#include")) {
+      struct compile_shader_job *job = malloc(sizeof(*job));
+
+      if (job) {
+         job->ctx = ctx;
+         job->sh = sh;
+         util_queue_add_job(&ctx->ShaderCompileQueue, job, &sh->CompileFence,
+                            compile_shader_execute, compile_shader_cleanup, 0);
+         return;
       }
    }
 
-   if (!sh->CompileStatus) {
-      if (ctx->_Shader->Flags & GLSL_DUMP_ON_ERROR) {
-         _mesa_log("GLSL source for %s shader %d:\n",
-                 _mesa_shader_stage_to_string(sh->Stage), sh->Name);
-         _mesa_log("%s\n", sh->Source);
-         _mesa_log("Info Log:\n%s\n", sh->InfoLog);
-      }
+   compile_shader_source(ctx, sh);
+}
 
-      if (ctx->_Shader->Flags & GLSL_REPORT_ERRORS) {
-         _mesa_debug(ctx, "Error compiling shader %u:\n%s\n",
-                     sh->Name, sh->InfoLog);
-      }
-   }
+/**
+ * Compile a shader.
+ */
+void
+_mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh)
+{
+   compile_shader(ctx, sh, false);
+}
+
+/**
+ * Wait for all compiles offloaded to ctx->ShaderCompileQueue.
+ */
+void
+_mesa_finish_shader_compiles(struct gl_context *ctx)
+{
+   if (util_queue_is_initialized(&ctx->ShaderCompileQueue))
+      util_queue_finish(&ctx->ShaderCompileQueue);
 }
 
 
@@ -1306,6 +1385,9 @@ link_program(struct gl_context *ctx, struct gl_shader_program *shProg,
          }
       }
 
+   for (unsigned i = 0; i < shProg->NumShaders; i++)
+      _mesa_wait_shader_compile(shProg->Shaders[i]);
+
    ensure_builtin_types(ctx);
 
    FLUSH_VERTICES(ctx, 0, 0);
@@ -1614,8 +1696,8 @@ _mesa_CompileShader(GLuint shaderObj)
    GET_CURRENT_CONTEXT(ctx);
    if (MESA_VERBOSE & VERBOSE_API)
       _mesa_debug(ctx, "glCompileShader %u\n", shaderObj);
-   _mesa_compile_shader(ctx, _mesa_lookup_shader_err(ctx, shaderObj,
-                                                     "glCompileShader"));
+   compile_shader(ctx, _mesa_lookup_shader_err(ctx, shaderObj,
+                                               "glCompileShader"), true);
 }
 
 
@@ -2300,6 +2382,8 @@ _mesa_ReleaseShaderCompiler(void)
 {
    GET_CURRENT_CONTEXT(ctx);
 
+   _mesa_finish_shader_compiles(ctx);
+
    if (ctx->shader_builtin_ref) {
       _mesa_glsl_builtin_functions_decref();
       ctx->shader_builtin_ref = false;
@@ -67,6 +67,9 @@ _mesa_active_program(struct gl_context *ctx, struct gl_shader_program *shProg,
 extern void
 _mesa_compile_shader(struct gl_context *ctx, struct gl_shader *sh);
 
+extern void
+_mesa_finish_shader_compiles(struct gl_context *ctx);
+
 extern void
 _mesa_link_program(struct gl_context *ctx, struct gl_shader_program *sh_prog);
 
@@ -91,6 +91,7 @@ static void
 _mesa_init_shader(struct gl_shader *shader)
 {
    shader->RefCount = 1;
+   util_queue_fence_init(&shader->CompileFence);
    shader->info.Geom.VerticesOut = -1;
    shader->info.Geom.InputType = GL_TRIANGLES;
    shader->info.Geom.OutputType = GL_TRIANGLE_STRIP;
@@ -122,6 +123,8 @@ _mesa_new_shader(GLuint name, gl_shader_stage stage)
 void
 _mesa_delete_shader(struct gl_context *ctx, struct gl_shader *sh)
 {
+   _mesa_wait_shader_compile(sh);
+   util_queue_fence_destroy(&sh->CompileFence);
    _mesa_shader_spirv_data_reference(&sh->spirv_data, NULL);
    free((void *)sh->Source);
    free((void *)sh->FallbackSource);
@@ -143,6 +146,18 @@ _mesa_delete_linked_shader(struct gl_context *ctx,
 }
 
 
+/**
+ * Wait for a compile of the shader that was offloaded to
+ * ctx->ShaderCompileQueue to finish.  Anything reading the results of the
+ * compile or changing the inputs of it has to call this first.
+ */
+void
+_mesa_wait_shader_compile(struct gl_shader *sh)
+{
+   util_queue_fence_wait(&sh->CompileFence);
+}
+
+
 /**
  * Lookup a GLSL shader object.
  */
@@ -90,6 +90,9 @@ _mesa_new_shader(GLuint name, gl_shader_stage type);
 extern void
 _mesa_delete_shader(struct gl_context *ctx, struct gl_shader *sh);
 
+extern void
+_mesa_wait_shader_compile(struct gl_shader *sh);
+
 extern void
 _mesa_delete_linked_shader(struct gl_context *ctx,
                            struct gl_linked_shader *sh);
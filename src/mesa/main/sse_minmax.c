@@ -31,7 +31,8 @@
 
 void
 _mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count)
+                         unsigned *max_index, const unsigned count,
+                         bool restart, unsigned restart_index)
 {
    unsigned max_ui = 0;
    unsigned min_ui = ~0U;
@@ -40,10 +41,12 @@ _mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
 
    /* handle the first few values without SSE until the pointer is aligned */
    while (((uintptr_t)ui_indices & 15) && aligned_count) {
-      if (*ui_indices > max_ui)
-         max_ui = *ui_indices;
-      if (*ui_indices < min_ui)
-         min_ui = *ui_indices;
+      if (!restart || *ui_indices != restart_index) {
+         if (*ui_indices > max_ui)
+            max_ui = *ui_indices;
+         if (*ui_indices < min_ui)
+            min_ui = *ui_indices;
+      }
 
       aligned_count--;
       ui_indices++;
@@ -59,21 +62,39 @@ _mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
       unsigned vec_count;
       __m128i max_ui4 = _mm_setzero_si128();
       __m128i min_ui4 = _mm_set1_epi32(~0U);
+      __m128i restart4 = _mm_set1_epi32(restart_index);
       __m128i ui_indices4;
       __m128i *ui_indices_ptr;
 
       vec_count = aligned_count & ~0x3;
       ui_indices_ptr = (__m128i *)ui_indices;
-      for (i = 0; i < vec_count / 4; i++) {
-         ui_indices4 = _mm_load_si128(&ui_indices_ptr[i]);
-         max_ui4 = _mm_max_epu32(ui_indices4, max_ui4);
-         min_ui4 = _mm_min_epu32(ui_indices4, min_ui4);
+      if (restart) {
+         /* Replace restart indices by 0 for max and by ~0 for min, so that
+          * they don't affect the result.
+          */
+         for (i = 0; i < vec_count / 4; i++) {
+            ui_indices4 = _mm_load_si128(&ui_indices_ptr[i]);
+            __m128i is_restart4 = _mm_cmpeq_epi32(ui_indices4, restart4);
+            max_ui4 = _mm_max_epu32(_mm_andnot_si128(is_restart4, ui_indices4),
+                                    max_ui4);
+            min_ui4 = _mm_min_epu32(_mm_or_si128(is_restart4, ui_indices4),
+                                    min_ui4);
+         }
+      } else {
+         for (i = 0; i < vec_count / 4; i++) {
+            ui_indices4 = _mm_load_si128(&ui_indices_ptr[i]);
+            max_ui4 = _mm_max_epu32(ui_indices4, max_ui4);
+            min_ui4 = _mm_min_epu32(ui_indices4, min_ui4);
+         }
       }
 
       _mm_store_si128((__m128i *)max_arr, max_ui4);
       _mm_store_si128((__m128i *)min_arr, min_ui4);
 
       for (i = 0; i < 4; i++) {
+         /* Lanes that only saw restart indices end up with min > max. */
+         if (min_arr[i] > max_arr[i])
+            continue;
          if (max_arr[i] > max_ui)
             max_ui = max_arr[i];
          if (min_arr[i] < min_ui)
@@ -83,6 +104,8 @@ _mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
    }
 
    for (; i < aligned_count; i++) {
+      if (restart && ui_indices[i] == restart_index)
+         continue;
       if (ui_indices[i] > max_ui)
          max_ui = ui_indices[i];
       if (ui_indices[i] < min_ui)
@@ -92,3 +115,87 @@ _mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
    *min_index = min_ui;
    *max_index = max_ui;
 }
+
+void
+_mesa_ushort_array_min_max(const uint16_t *us_indices, unsigned *min_index,
+                           unsigned *max_index, const unsigned count,
+                           bool restart, unsigned restart_index)
+{
+   unsigned max_us = 0;
+   unsigned min_us = ~0U;
+   unsigned i = 0;
+   unsigned aligned_count = count;
+
+   /* Restart indices that don't fit in 16 bits can never match. */
+   if (restart_index > 0xffff)
+      restart = false;
+
+   /* handle the first few values without SSE until the pointer is aligned */
+   while (((uintptr_t)us_indices & 15) && aligned_count) {
+      if (!restart || *us_indices != restart_index) {
+         if (*us_indices > max_us)
+            max_us = *us_indices;
+         if (*us_indices < min_us)
+            min_us = *us_indices;
+      }
+
+      aligned_count--;
+      us_indices++;
+   }
+
+   if (aligned_count >= 16) {
+      uint16_t max_arr[8] __attribute__ ((aligned (16)));
+      uint16_t min_arr[8] __attribute__ ((aligned (16)));
+      unsigned vec_count;
+      __m128i max_us8 = _mm_setzero_si128();
+      __m128i min_us8 = _mm_set1_epi16(-1);
+      __m128i restart8 = _mm_set1_epi16(restart_index);
+      __m128i us_indices8;
+      __m128i *us_indices_ptr;
+
+      vec_count = aligned_count & ~0x7;
+      us_indices_ptr = (__m128i *)us_indices;
+      if (restart) {
+         for (i = 0; i < vec_count / 8; i++) {
+            us_indices8 = _mm_load_si128(&us_indices_ptr[i]);
+            __m128i is_restart8 = _mm_cmpeq_epi16(us_indices8, restart8);
+            max_us8 = _mm_max_epu16(_mm_andnot_si128(is_restart8, us_indices8),
+                                    max_us8);
+            min_us8 = _mm_min_epu16(_mm_or_si128(is_restart8, us_indices8),
+                                    min_us8);
+         }
+      } else {
+         for (i = 0; i < vec_count / 8; i++) {
+            us_indices8 = _mm_load_si128(&us_indices_ptr[i]);
+            max_us8 = _mm_max_epu16(us_indices8, max_us8);
+            min_us8 = _mm_min_epu16(us_indices8, min_us8);
+         }
+      }
+
+      _mm_store_si128((__m128i *)max_arr, max_us8);
+      _mm_store_si128((__m128i *)min_arr, min_us8);
+
+      for (i = 0; i < 8; i++) {
+         /* Lanes that only saw restart indices end up with min > max. */
+         if (min_arr[i] > max_arr[i])
+            continue;
+         if (max_arr[i] > max_us)
+            max_us = max_arr[i];
+         if (min_arr[i] < min_us)
+            min_us = min_arr[i];
+      }
+      i = vec_count;
+   }
+
+   for (; i < aligned_count; i++) {
+      if (restart && us_indices[i] == restart_index)
+         continue;
+      if (us_indices[i] > max_us)
+         max_us = us_indices[i];
+      if (us_indices[i] < min_us)
+         min_us = us_indices[i];
+   }
+
+   *min_index = min_us;
+   *max_index = max_us;
+}
@@ -28,8 +28,17 @@
 #ifndef SSE_MINMAX_H
 #define SSE_MINMAX_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 void
 _mesa_uint_array_min_max(const unsigned *ui_indices, unsigned *min_index,
-                         unsigned *max_index, const unsigned count);
+                         unsigned *max_index, const unsigned count,
+                         bool restart, unsigned restart_index);
+
+void
+_mesa_ushort_array_min_max(const uint16_t *us_indices, unsigned *min_index,
+                           unsigned *max_index, const unsigned count,
+                           bool restart, unsigned restart_index);
 
 #endif /* SSE_MINMAX_H */
@@ -0,0 +1,74 @@
+/*
+ * Copyright © 2021 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "main/sse_swizzle.h"
+#include <smmintrin.h>
+#include <stdint.h>
+
+/* Matches MESA_FORMAT_SWIZZLE_ONE in formats.h. */
+#define SWIZZLE_ONE 5
+
+void
+_mesa_ubyte_swizzle_to_rgba_sse41(uint8_t *dst, const uint8_t *src,
+                                  int num_src_channels,
+                                  const uint8_t swizzle[4], bool normalized,
+                                  int count)
+{
+   const uint8_t one = normalized ? UINT8_MAX : 1;
+   uint8_t shuffle[16] __attribute__ ((aligned (16)));
+   uint8_t fill[16] __attribute__ ((aligned (16)));
+   uint8_t tail[4];
+   int i = 0;
+
+   /* Source channels go through the shuffle. ZERO, ONE and NONE are zeroed
+    * by it (PSHUFB clears bytes whose index has the top bit set), and ONE
+    * is then ORed in.
+    */
+   for (int c = 0; c < 4; c++) {
+      tail[c] = swizzle[c] == SWIZZLE_ONE ? one : 0;
+      for (int p = 0; p < 4; p++) {
+         shuffle[p * 4 + c] = swizzle[c] < num_src_channels ?
+                              p * num_src_channels + swizzle[c] : 0x80;
+         fill[p * 4 + c] = tail[c];
+      }
+   }
+
+   const __m128i vshuffle = _mm_load_si128((const __m128i *)shuffle);
+   const __m128i vfill = _mm_load_si128((const __m128i *)fill);
+
+   /* Each iteration loads 16 source bytes but only consumes four pixels,
+    * so stop while a full load still stays within the source.
+    */
+   for (; i * num_src_channels + 16 <= count * num_src_channels; i += 4) {
+      __m128i pixels = _mm_loadu_si128((const __m128i *)
+                                       (src + i * num_src_channels));
+      pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, vshuffle), vfill);
+      _mm_storeu_si128((__m128i *)(dst + i * 4), pixels);
+   }
+
+   for (; i < count; i++) {
+      const uint8_t *s = src + i * num_src_channels;
+      for (int c = 0; c < 4; c++)
+         dst[i * 4 + c] = swizzle[c] < num_src_channels ? s[swizzle[c]] : tail[c];
+   }
+}
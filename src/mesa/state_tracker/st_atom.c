@@ -186,6 +186,17 @@ void st_validate_state( struct st_context *st, enum st_pipeline pipeline )
    /* Get pipeline state. */
    switch (pipeline) {
    case ST_PIPELINE_RENDER:
+      /* If only constant buffers changed since the previous draw (usually
+       * because the application set uniforms in between), nothing that the
+       * checks below look at can have changed either.  Skip them, the same
+       * way prepare_draw skips validation when nothing changed at all.
+       */
+      if (!st->gfx_shaders_may_be_dirty &&
+          !(st->dirty & ST_PIPELINE_RENDER_STATE_MASK & ~ST_NEW_CONSTANTS)) {
+         pipeline_mask = ST_PIPELINE_RENDER_STATE_MASK;
+         break;
+      }
+
       if (st->ctx->API == API_OPENGL_COMPAT)
          check_attrib_edgeflag(st);
 
@@ -363,6 +363,54 @@ st_MapTextureImage(struct gl_context *ctx,
 }
 
 
+struct st_decompress_rect {
+   mesa_format format;
+   bool bgra;
+};
+
+static void
+decompress_rect(void *data,
+                uint8_t *dst_row, unsigned dst_stride,
+                const uint8_t *src_row, unsigned src_stride,
+                unsigned width, unsigned height)
+{
+   const struct st_decompress_rect *rect = data;
+
+   if (rect->format == MESA_FORMAT_ETC1_RGB8) {
+      _mesa_etc1_unpack_rgba8888(dst_row, dst_stride, src_row, src_stride,
+                                 width, height);
+   } else if (_mesa_is_format_etc2(rect->format)) {
+      _mesa_unpack_etc2_format(dst_row, dst_stride, src_row, src_stride,
+                               width, height, rect->format, rect->bgra);
+   } else if (_mesa_is_format_astc_2d(rect->format)) {
+      _mesa_unpack_astc_2d_ldr(dst_row, dst_stride, src_row, src_stride,
+                               width, height, rect->format);
+   } else {
+      unreachable("unexpected format for a compressed format fallback");
+   }
+}
+
+/**
+ * Decompress an image of a compressed format that the driver doesn't
+ * support to RGBA8. Large images are decompressed in bands on the shared
+ * thread pool.
+ */
+static void
+decompress_image(mesa_format format, bool bgra,
+                 uint8_t *dst, unsigned dst_stride,
+                 const uint8_t *src, unsigned src_stride,
+                 unsigned width, unsigned height)
+{
+   struct st_decompress_rect rect = { format, bgra };
+   GLuint bw, bh;
+
+   _mesa_get_format_block_size(format, &bw, &bh);
+   util_format_unpack_rect_parallel(decompress_rect, &rect, bh,
+                                    dst, dst_stride, src, src_stride,
+                                    width, height);
+}
+
+
 /** called via ctx->Driver.UnmapTextureImage() */
 static void
 st_UnmapTextureImage(struct gl_context *ctx,
@@ -391,26 +439,14 @@ st_UnmapTextureImage(struct gl_context *ctx,
             void *tmp = malloc(size);
 
             /* Decompress to tmp. */
-            if (texImage->TexFormat == MESA_FORMAT_ETC1_RGB8) {
-               _mesa_etc1_unpack_rgba8888(tmp, transfer->box.width * 4,
-                                          itransfer->temp_data,
-                                          itransfer->temp_stride,
-                                          transfer->box.width,
-                                          transfer->box.height);
-            } else if (_mesa_is_format_etc2(texImage->TexFormat)) {
-               bool bgra = stImage->pt->format == PIPE_FORMAT_B8G8R8A8_SRGB;
-
-               _mesa_unpack_etc2_format(tmp, transfer->box.width * 4,
-                                        itransfer->temp_data,
-                                        itransfer->temp_stride,
-                                        transfer->box.width,
-                                        transfer->box.height,
-                                        texImage->TexFormat,
-                                        bgra);
-            } else {
-               /* TODO: We could transcode ASTC too. */
-               unreachable("unexpected format for a compressed format fallback");
-            }
+            /* TODO: We could transcode ASTC too. */
+            assert(texImage->TexFormat == MESA_FORMAT_ETC1_RGB8 ||
+                   _mesa_is_format_etc2(texImage->TexFormat));
+            decompress_image(texImage->TexFormat,
+                             stImage->pt->format == PIPE_FORMAT_B8G8R8A8_SRGB,
+                             tmp, transfer->box.width * 4,
+                             itransfer->temp_data, itransfer->temp_stride,
+                             transfer->box.width, transfer->box.height);
 
             /* Compress it to the target format. */
             struct gl_pixelstore_attrib pack = {0};
@@ -424,30 +460,11 @@ st_UnmapTextureImage(struct gl_context *ctx,
             free(tmp);
          } else {
             /* Decompress into an uncompressed format. */
-            if (texImage->TexFormat == MESA_FORMAT_ETC1_RGB8) {
-               _mesa_etc1_unpack_rgba8888(itransfer->map, transfer->stride,
-                                          itransfer->temp_data,
-                                          itransfer->temp_stride,
-                                          transfer->box.width,
-                                          transfer->box.height);
-            } else if (_mesa_is_format_etc2(texImage->TexFormat)) {
-               bool bgra = stImage->pt->format == PIPE_FORMAT_B8G8R8A8_SRGB;
-
-               _mesa_unpack_etc2_format(itransfer->map, transfer->stride,
-                                        itransfer->temp_data,
-                                        itransfer->temp_stride,
-                                        transfer->box.width, transfer->box.height,
-                                        texImage->TexFormat,
-                                        bgra);
-            } else if (_mesa_is_format_astc_2d(texImage->TexFormat)) {
-               _mesa_unpack_astc_2d_ldr(itransfer->map, transfer->stride,
-                                        itransfer->temp_data,
-                                        itransfer->temp_stride,
-                                        transfer->box.width, transfer->box.height,
-                                        texImage->TexFormat);
-            } else {
-               unreachable("unexpected format for a compressed format fallback");
-            }
+            decompress_image(texImage->TexFormat,
+                             stImage->pt->format == PIPE_FORMAT_B8G8R8A8_SRGB,
+                             itransfer->map, transfer->stride,
+                             itransfer->temp_data, itransfer->temp_stride,
+                             transfer->box.width, transfer->box.height);
          }
       }
 
@@ -1429,6 +1446,7 @@ try_pbo_upload(struct gl_context *ctx, GLuint dims,
    struct pipe_context *pipe = st->pipe;
    struct pipe_screen *screen = st->screen;
    struct pipe_surface *surface = NULL;
+   struct pipe_resource *upload_buf = NULL;
    struct st_pbo_addresses addr;
    enum pipe_format src_format;
    const struct util_format_description *desc;
@@ -1496,9 +1514,65 @@ try_pbo_upload(struct gl_context *ctx, GLuint dims,
    addr.depth = depth;
    addr.bytes_per_pixel = desc->block.bits / 8;
 
-   if (!st_pbo_addresses_pixelstore(st, gl_target, dims == 3, unpack, pixels,
-                                    &addr))
-      return false;
+   if (unpack->BufferObj) {
+      if (!st_pbo_addresses_pixelstore(st, gl_target, dims == 3, unpack,
+                                       pixels, &addr))
+         return false;
+   } else {
+      /* Client memory: copy the pixels tightly packed into the stream
+       * uploader, so that we don't have to create a staging texture for
+       * every upload.
+       */
+      const unsigned bytes_per_row = width * addr.bytes_per_pixel;
+      unsigned offset;
+      GLubyte *map = NULL;
+      GLuint row, slice;
+
+      util_throttle_memory_usage(pipe, &st->throttle,
+                                 (uint64_t) bytes_per_row * height * depth);
+
+      u_upload_alloc(pipe->stream_uploader, 0, bytes_per_row * height * depth,
+                     ctx->Const.TextureBufferOffsetAlignment,
+                     &offset, &upload_buf, (void **) &map);
+      if (!upload_buf)
+         return false;
+
+      if (offset % addr.bytes_per_pixel) {
+         u_upload_unmap(pipe->stream_uploader);
+         pipe_resource_reference(&upload_buf, NULL);
+         return false;
+      }
+
+      for (slice = 0; slice < (unsigned) depth; slice++) {
+         if (gl_target == GL_TEXTURE_1D_ARRAY) {
+            /* We need to convert gallium coords to GL coords. */
+            const void *src = _mesa_image_address2d(unpack, pixels,
+                                                    width, depth, format,
+                                                    type, slice, 0);
+            memcpy(map, src, bytes_per_row);
+            map += bytes_per_row;
+         } else {
+            for (row = 0; row < (unsigned) height; row++) {
+               const void *src = _mesa_image_address(dims, unpack, pixels,
+                                                     width, height, format,
+                                                     type, slice, row, 0);
+               memcpy(map, src, bytes_per_row);
+               map += bytes_per_row;
+            }
+         }
+      }
+
+      u_upload_unmap(pipe->stream_uploader);
+
+      addr.pixels_per_row = width;
+      addr.image_height = height;
+
+      if (!st_pbo_addresses_setup(st, upload_buf,
+                                  offset / addr.bytes_per_pixel, &addr)) {
+         pipe_resource_reference(&upload_buf, NULL);
+         return false;
+      }
+   }
 
    /* Set up the surface */
    {
@@ -1516,13 +1590,16 @@ try_pbo_upload(struct gl_context *ctx, GLuint dims,
       templ.u.tex.last_layer = MIN2(zoffset + depth - 1, max_layer);
 
       surface = pipe->create_surface(pipe, texture, &templ);
-      if (!surface)
+      if (!surface) {
+         pipe_resource_reference(&upload_buf, NULL);
          return false;
+      }
    }
 
    success = try_pbo_upload_common(ctx, surface, &addr, src_format);
 
    pipe_surface_reference(&surface, NULL);
+   pipe_resource_reference(&upload_buf, NULL);
 
    return success;
 }
@@ -1673,6 +1750,15 @@ st_TexSubImage(struct gl_context *ctx, GLuint dims,
       goto fallback;
    }
 
+   /* Upload through a streaming buffer and the PBO upload shader rather
+    * than through a temporary texture. */
+   if (pixels && !unpack->BufferObj) {
+      if (try_pbo_upload(ctx, dims, texImage, format, type, dst_format,
+                         xoffset, yoffset, zoffset,
+                         width, height, depth, pixels, unpack))
+         return;
+   }
+
    /* TexSubImage only sets a single cubemap face. */
    if (gl_target == GL_TEXTURE_CUBE_MAP) {
       gl_target = GL_TEXTURE_2D;
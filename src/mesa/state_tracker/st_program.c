@@ -55,6 +55,7 @@
 #include "tgsi/tgsi_ureg.h"
 #include "nir/nir_to_tgsi.h"
 
+#include "util/mesa-sha1.h"
 #include "util/u_memory.h"
 
 #include "st_debug.h"
@@ -709,6 +710,36 @@ get_nir_shader(struct st_context *st, struct st_program *stp)
    return nir_deserialize(NULL, options, &blob_reader);
 }
 
+/**
+ * Identify the NIR of the first variant of a GLSL or SPIR-V program by the
+ * program's SHA1, so that drivers can look up their shader cache without
+ * hashing the NIR.
+ *
+ * That NIR only depends on what the program SHA1 covers, the same way the
+ * NIR loaded from the disk cache does. Other variants are left alone,
+ * because their lowering depends on the state references that previous
+ * variants added to the parameter list.
+ */
+static void
+st_set_nir_source_sha1(struct st_program *stp, nir_shader *nir,
+                       bool default_key)
+{
+   static const uint8_t zero[20] = {0};
+   uint32_t stage = stp->Base.info.stage;
+   struct mesa_sha1 ctx;
+
+   if (!default_key || stp->variants || !stp->shader_program ||
+       !stp->Base.sh.data ||
+       memcmp(stp->Base.sh.data->sha1, zero, sizeof(zero)) == 0)
+      return;
+
+   _mesa_sha1_init(&ctx);
+   _mesa_sha1_update(&ctx, stp->Base.sh.data->sha1,
+                     sizeof(stp->Base.sh.data->sha1));
+   _mesa_sha1_update(&ctx, &stage, sizeof(stage));
+   _mesa_sha1_final(&ctx, nir->info.source_sha1);
+}
+
 static void
 lower_ucp(struct st_context *st,
           struct nir_shader *nir,
@@ -772,8 +803,16 @@ st_create_common_variant(struct st_context *st,
    if (stp->state.type == PIPE_SHADER_IR_NIR) {
       bool finalize = false;
 
+      struct st_common_variant_key default_key;
+
+      memset(&default_key, 0, sizeof(default_key));
+      default_key.st = key->st;
+
       state.type = PIPE_SHADER_IR_NIR;
       state.ir.nir = get_nir_shader(st, stp);
+      st_set_nir_source_sha1(stp, state.ir.nir,
+                             memcmp(key, &default_key, sizeof(*key)) == 0);
+
       if (key->clamp_color) {
          NIR_PASS_V(state.ir.nir, nir_lower_clamp_color_outputs);
          finalize = true;
@@ -1348,8 +1387,16 @@ st_create_fp_variant(struct st_context *st,
       state.type = PIPE_SHADER_IR_NIR;
       state.ir.nir = s;
    } else if (stfp->state.type == PIPE_SHADER_IR_NIR) {
+      struct st_fp_variant_key default_key;
+
+      memset(&default_key, 0, sizeof(default_key));
+      default_key.st = key->st;
+      default_key.lower_alpha_func = COMPARE_FUNC_ALWAYS;
+
       state.type = PIPE_SHADER_IR_NIR;
       state.ir.nir = get_nir_shader(st, stfp);
+      st_set_nir_source_sha1(stfp, state.ir.nir,
+                             memcmp(key, &default_key, sizeof(*key)) == 0);
    }
 
    if (state.type == PIPE_SHADER_IR_NIR) {
@@ -240,6 +240,13 @@ vbo_get_minmax_index_mapped(unsigned count, unsigned index_size,
       const GLuint *ui_indices = (const GLuint *)indices;
       GLuint max_ui = 0;
       GLuint min_ui = ~0U;
+#if defined(USE_SSE41)
+      if (cpu_has_sse4_1) {
+         _mesa_uint_array_min_max(ui_indices, &min_ui, &max_ui, count,
+                                  restart, restartIndex);
+      }
+      else
+#endif
       if (restart) {
          for (unsigned i = 0; i < count; i++) {
             if (ui_indices[i] != restartIndex) {
@@ -249,16 +256,10 @@ vbo_get_minmax_index_mapped(unsigned count, unsigned index_size,
          }
       }
       else {
-#if defined(USE_SSE41)
-         if (cpu_has_sse4_1) {
-            _mesa_uint_array_min_max(ui_indices, &min_ui, &max_ui, count);
+         for (unsigned i = 0; i < count; i++) {
+            if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
+            if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
          }
-         else
-#endif
-            for (unsigned i = 0; i < count; i++) {
-               if (ui_indices[i] > max_ui) max_ui = ui_indices[i];
-               if (ui_indices[i] < min_ui) min_ui = ui_indices[i];
-            }
       }
       *min_index = min_ui;
       *max_index = max_ui;
@@ -268,6 +269,13 @@ vbo_get_minmax_index_mapped(unsigned count, unsigned index_size,
       const GLushort *us_indices = (const GLushort *)indices;
       GLuint max_us = 0;
       GLuint min_us = ~0U;
+#if defined(USE_SSE41)
+      if (cpu_has_sse4_1) {
+         _mesa_ushort_array_min_max(us_indices, &min_us, &max_us, count,
+                                    restart, restartIndex);
+      }
+      else
+#endif
       if (restart) {
          for (unsigned i = 0; i < count; i++) {
             if (us_indices[i] != restartIndex) {
@@ -52,6 +52,9 @@ USE OR OTHER DEALINGS IN THE SOFTWARE.
  * Eval and other commands that don't fit into these vertex lists are
  * compiled using the fallback opcode mechanism provided by dlist.c.
  */
+/* Restart index used to merge primitives that can't be concatenated. */
+#define VBO_SAVE_RESTART_INDEX 0xffffffff
+
 struct vbo_save_vertex_list {
    struct gl_vertex_array_object *VAO[VP_MODE_MAX];
 
@@ -73,6 +76,7 @@ struct vbo_save_vertex_list {
       struct _mesa_index_buffer ib;
       GLuint prim_count;
       GLuint min_index, max_index;
+      bool primitive_restart; /**< prims are separated by VBO_SAVE_RESTART_INDEX */
    } merged;
 
    struct vbo_save_primitive_store *prim_store;
@@ -577,6 +577,7 @@ compile_vertex_list(struct gl_context *ctx)
    node->merged.prims = NULL;
    node->merged.ib.obj = NULL;
    node->merged.prim_count = 0;
+   node->merged.primitive_restart = false;
    node->prim_count = save->prim_count;
    node->prim_store = save->prim_store;
 
@@ -666,6 +667,14 @@ compile_vertex_list(struct gl_context *ctx)
       int max_indices_count = MAX2(total_vert_count * 2 - (node->prim_count * 2) + 1,
                                    total_vert_count);
 
+      /* Primitives that can't simply be concatenated (fans, polygons, ...)
+       * are merged using primitive restart if the driver supports it. This
+       * needs one more index per primitive.
+       */
+      const bool use_restart = ctx->Extensions.NV_primitive_restart;
+      if (use_restart)
+         max_indices_count += node->prim_count;
+
       int indices_offset = 0;
       int available = save->previous_ib ? (save->previous_ib->Size / 4 - save->ib_first_free_index) : 0;
       if (available >= max_indices_count) {
@@ -695,9 +704,19 @@ compile_vertex_list(struct gl_context *ctx)
          /* If 2 consecutive prims use the same mode => merge them. */
          bool merge_prims = last_valid_prim >= 0 &&
                             mode == node->merged.prims[last_valid_prim].mode &&
-                            mode != GL_LINE_LOOP && mode != GL_TRIANGLE_FAN &&
-                            mode != GL_QUAD_STRIP && mode != GL_POLYGON &&
                             mode != GL_PATCHES;
+         bool restart = merge_prims &&
+                        (mode == GL_LINE_LOOP || mode == GL_TRIANGLE_FAN ||
+                         mode == GL_QUAD_STRIP || mode == GL_POLYGON);
+
+         if (restart && !use_restart)
+            merge_prims = restart = false;
+
+         if (restart) {
+            indices[idx++] = VBO_SAVE_RESTART_INDEX;
+            node->merged.prims[last_valid_prim].count++;
+            node->merged.primitive_restart = true;
+         }
 
          /* To be able to merge consecutive triangle strips we need to insert
           * a degenerate triangle.
@@ -233,7 +233,8 @@ vbo_save_playback_vertex_list(struct gl_context *ctx, void *data)
          } else {
             ctx->Driver.Draw(ctx, node->merged.prims, node->merged.prim_count,
                              &node->merged.ib, true,
-                             false, 0, node->merged.min_index, node->merged.max_index, 1, 0);
+                             node->merged.primitive_restart, VBO_SAVE_RESTART_INDEX,
+                             node->merged.min_index, node->merged.max_index, 1, 0);
          }
       }
    }
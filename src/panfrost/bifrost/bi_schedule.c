@@ -38,6 +38,12 @@ struct bi_worklist {
 
         /* Bitset of instructions in the block ready for scheduling */
         BITSET_WORD *worklist;
+
+        /* Dependency graph. For each instruction, the number of unscheduled
+         * instructions depending on it, and the list of instructions it
+         * depends on. NULL when scheduling in order for debug. */
+        unsigned *dep_counts;
+        struct util_dynarray *dependencies;
 };
 
 /* State of a single tuple and clause under construction */
@@ -268,19 +274,181 @@ bi_flatten_block(bi_block *block, unsigned *len)
         return instructions;
 }
 
-/* The worklist would track instructions without outstanding dependencies. For
- * debug, force in-order scheduling (no dependency graph is constructed).
+/* Register-file state used to build the dependency graph. Accesses to
+ * precoloured registers (BI_INDEX_REGISTER) are tracked as a single
+ * conservative location, since they may overlap in arbitrary ways. */
+
+struct bi_dep_state {
+        /* Last instruction writing each node, or -1 */
+        int *last_write;
+
+        /* Instructions reading each node since its last write */
+        struct util_dynarray *last_reads;
+
+        int reg_write;
+        struct util_dynarray reg_reads;
+};
+
+static void
+bi_add_dep(struct bi_worklist *st, unsigned earlier, unsigned later)
+{
+        if (earlier == later)
+                return;
+
+        util_dynarray_foreach(&st->dependencies[later], unsigned, dep) {
+                if (*dep == earlier)
+                        return;
+        }
+
+        util_dynarray_append(&st->dependencies[later], unsigned, earlier);
+        st->dep_counts[earlier]++;
+}
+
+static void
+bi_add_read_deps(struct bi_worklist *st, int last_write,
+                struct util_dynarray *reads, unsigned i)
+{
+        if (last_write >= 0)
+                bi_add_dep(st, last_write, i);
+
+        util_dynarray_append(reads, unsigned, i);
+}
+
+static void
+bi_add_write_deps(struct bi_worklist *st, int *last_write,
+                struct util_dynarray *reads, unsigned i)
+{
+        if (*last_write >= 0)
+                bi_add_dep(st, *last_write, i);
+
+        util_dynarray_foreach(reads, unsigned, read)
+                bi_add_dep(st, *read, i);
+
+        util_dynarray_clear(reads);
+        *last_write = i;
+}
+
+/* Instructions without a destination (branches, discards, barriers) and
+ * instructions that must terminate their clause have effects beyond the
+ * register file, so everything is kept on its side of them */
+
+static bool
+bi_is_sched_barrier(bi_instr *ins)
+{
+        return bi_opcode_props[ins->op].last ||
+                (bi_is_null(ins->dest[0]) && bi_is_null(ins->dest[1]) &&
+                 bi_message_type_for_instr(ins) == BIFROST_MESSAGE_NONE);
+}
+
+static void
+bi_create_dependency_graph(bi_context *ctx, struct bi_worklist *st)
+{
+        unsigned node_count = bi_max_temp(ctx);
+        struct bi_dep_state deps = {
+                .last_write = malloc(sizeof(int) * node_count),
+                .last_reads = calloc(node_count, sizeof(struct util_dynarray)),
+                .reg_write = -1,
+        };
+
+        for (unsigned n = 0; n < node_count; ++n) {
+                deps.last_write[n] = -1;
+                util_dynarray_init(&deps.last_reads[n], NULL);
+        }
+
+        util_dynarray_init(&deps.reg_reads, NULL);
+
+        int last_message = -1;
+        int last_barrier = -1;
+
+        for (unsigned i = 0; i < st->count; ++i) {
+                bi_instr *ins = st->instructions[i];
+
+                bi_foreach_src(ins, s) {
+                        bi_index src = ins->src[s];
+
+                        if (src.type == BI_INDEX_NORMAL) {
+                                unsigned node = bi_get_node(src);
+                                bi_add_read_deps(st, deps.last_write[node],
+                                                &deps.last_reads[node], i);
+                        } else if (src.type == BI_INDEX_REGISTER) {
+                                bi_add_read_deps(st, deps.reg_write,
+                                                &deps.reg_reads, i);
+                        }
+                }
+
+                bi_foreach_dest(ins, d) {
+                        bi_index dest = ins->dest[d];
+
+                        if (dest.type == BI_INDEX_NORMAL) {
+                                unsigned node = bi_get_node(dest);
+                                bi_add_write_deps(st, &deps.last_write[node],
+                                                &deps.last_reads[node], i);
+                        } else if (dest.type == BI_INDEX_REGISTER) {
+                                bi_add_write_deps(st, &deps.reg_write,
+                                                &deps.reg_reads, i);
+                        }
+                }
+
+                /* Keep messages (memory access, texturing, varyings) in order
+                 * with respect to each other */
+                if (bi_message_type_for_instr(ins) != BIFROST_MESSAGE_NONE) {
+                        if (last_message >= 0)
+                                bi_add_dep(st, last_message, i);
+
+                        last_message = i;
+                }
+
+                if (bi_is_sched_barrier(ins)) {
+                        for (unsigned j = MAX2(last_barrier, 0); j < i; ++j)
+                                bi_add_dep(st, j, i);
+
+                        last_barrier = i;
+                } else if (last_barrier >= 0) {
+                        bi_add_dep(st, last_barrier, i);
+                }
+        }
+
+        for (unsigned n = 0; n < node_count; ++n)
+                util_dynarray_fini(&deps.last_reads[n]);
+
+        util_dynarray_fini(&deps.reg_reads);
+        free(deps.last_reads);
+        free(deps.last_write);
+}
+
+/* The worklist tracks instructions without outstanding dependencies. Since
+ * we schedule bottom-up, those are the instructions all of whose successors
+ * have already been scheduled. For debug, force in-order scheduling (no
+ * dependency graph is constructed).
  */
 
 static struct bi_worklist
-bi_initialize_worklist(bi_block *block)
+bi_initialize_worklist(bi_context *ctx, bi_block *block)
 {
         struct bi_worklist st = { };
         st.instructions = bi_flatten_block(block, &st.count);
 
-        if (st.count) {
-                st.worklist = calloc(BITSET_WORDS(st.count), sizeof(BITSET_WORD));
+        if (!st.count)
+                return st;
+
+        st.worklist = calloc(BITSET_WORDS(st.count), sizeof(BITSET_WORD));
+
+        if (bifrost_debug & BIFROST_DBG_NOSCHED) {
                 BITSET_SET(st.worklist, st.count - 1);
+                return st;
+        }
+
+        st.dep_counts = calloc(st.count, sizeof(unsigned));
+        st.dependencies = calloc(st.count, sizeof(struct util_dynarray));
+
+        for (unsigned i = 0; i < st.count; ++i)
+                util_dynarray_init(&st.dependencies[i], NULL);
+
+        bi_create_dependency_graph(ctx, &st);
+
+        for (unsigned i = 0; i < st.count; ++i) {
+                if (!st.dep_counts[i])
+                        BITSET_SET(st.worklist, i);
         }
 
         return st;
@@ -289,6 +457,13 @@ bi_initialize_worklist(bi_block *block)
 static void
 bi_free_worklist(struct bi_worklist st)
 {
+        if (st.dependencies) {
+                for (unsigned i = 0; i < st.count; ++i)
+                        util_dynarray_fini(&st.dependencies[i]);
+        }
+
+        free(st.dep_counts);
+        free(st.dependencies);
         free(st.instructions);
         free(st.worklist);
 }
@@ -296,8 +471,21 @@ bi_free_worklist(struct bi_worklist st)
 static void
 bi_update_worklist(struct bi_worklist st, unsigned idx)
 {
-        if (idx >= 1)
-                BITSET_SET(st.worklist, idx - 1);
+        if (!st.dependencies) {
+                if (idx >= 1)
+                        BITSET_SET(st.worklist, idx - 1);
+
+                return;
+        }
+
+        /* Once all of an instruction's successors are scheduled, it is
+         * ready to be scheduled itself */
+        util_dynarray_foreach(&st.dependencies[idx], unsigned, dep) {
+                assert(st.dep_counts[*dep] > 0);
+
+                if (--st.dep_counts[*dep] == 0)
+                        BITSET_SET(st.worklist, *dep);
+        }
 }
 
 /* To work out the back-to-back flag, we need to detect branches and
@@ -1478,7 +1666,7 @@ bi_schedule_block(bi_context *ctx, bi_block *block)
         list_inithead(&block->clauses);
 
         /* Copy list to dynamic array */
-        struct bi_worklist st = bi_initialize_worklist(block);
+        struct bi_worklist st = bi_initialize_worklist(ctx, block);
 
         if (!st.count) {
                 bi_free_worklist(st);
@@ -1498,6 +1686,17 @@ bi_schedule_block(bi_context *ctx, bi_block *block)
                         last_clause->flow_control = BIFROST_FLOW_NBTB_UNCONDITIONAL;
         }
 
+        /* Instructions may have been reordered, so relink the block in
+         * execution order for the passes iterating clauses after us */
+        list_inithead(&block->base.instructions);
+
+        bi_foreach_clause_in_block(block, clause) {
+                for (unsigned i = 0; i < clause->tuple_count; ++i) {
+                        bi_foreach_instr_in_tuple(&clause->tuples[i], ins)
+                                list_addtail(&ins->link, &block->base.instructions);
+                }
+        }
+
         block->scheduled = true;
 
 #ifndef NDEBUG
@@ -26,6 +26,67 @@
 #include "pan_bo.h"
 #include "pan_pool.h"
 
+void
+pan_slab_ring_init(struct pan_slab_ring *ring)
+{
+        memset(ring, 0, sizeof(*ring));
+}
+
+void
+pan_slab_ring_cleanup(struct pan_slab_ring *ring)
+{
+        for (unsigned i = 0; i < ring->count; ++i) {
+                unsigned idx = (ring->head + i) % PAN_SLAB_RING_SIZE;
+                panfrost_bo_unreference(ring->slabs[idx]);
+        }
+
+        ring->count = 0;
+}
+
+/* Takes the oldest slab out of the ring if the GPU is done with it. Only
+ * standard-sized, CPU-visible slabs go through the ring, so any slab fits. */
+
+static struct panfrost_bo *
+pan_slab_ring_get(struct pan_slab_ring *ring)
+{
+        if (!ring->count)
+                return NULL;
+
+        struct panfrost_bo *bo = ring->slabs[ring->head];
+
+        if (!panfrost_bo_wait(bo, 0, true))
+                return NULL;
+
+        ring->head = (ring->head + 1) % PAN_SLAB_RING_SIZE;
+        ring->count--;
+
+        return bo;
+}
+
+/* Takes ownership of the caller's reference. If the ring is full, the oldest
+ * slab goes back to the BO cache */
+
+static void
+pan_slab_ring_put(struct pan_slab_ring *ring, struct panfrost_bo *bo)
+{
+        if (ring->count == PAN_SLAB_RING_SIZE) {
+                panfrost_bo_unreference(ring->slabs[ring->head]);
+                ring->head = (ring->head + 1) % PAN_SLAB_RING_SIZE;
+                ring->count--;
+        }
+
+        unsigned idx = (ring->head + ring->count) % PAN_SLAB_RING_SIZE;
+        ring->slabs[idx] = bo;
+        ring->count++;
+}
+
+static bool
+panfrost_pool_uses_ring(struct pan_pool *pool, size_t bo_sz)
+{
+        return pool->ring && bo_sz == TRANSIENT_SLAB_SIZE &&
+               !(pool->create_flags & (PAN_BO_INVISIBLE | PAN_BO_DELAY_MMAP));
+}
+
 /* Transient command stream pooling: command stream uploads try to simply copy
  * into whereever we left off. If there isn't space, we allocate a new entry
  * into the pool and copy there */
@@ -33,14 +94,21 @@
 static struct panfrost_bo *
 panfrost_pool_alloc_backing(struct pan_pool *pool, size_t bo_sz)
 {
+        struct panfrost_bo *bo = NULL;
+
+        if (panfrost_pool_uses_ring(pool, bo_sz))
+                bo = pan_slab_ring_get(pool->ring);
+
         /* We don't know what the BO will be used for, so let's flag it
          * RW and attach it to both the fragment and vertex/tiler jobs.
          * TODO: if we want fine grained BO assignment we should pass
          * flags to this function and keep the read/write,
          * fragment/vertex+tiler pools separate.
          */
-        struct panfrost_bo *bo = panfrost_bo_create(pool->dev, bo_sz,
-                        pool->create_flags);
+        if (!bo) {
+                bo = panfrost_bo_create(pool->dev, bo_sz,
+                                        pool->create_flags);
+        }
 
         util_dynarray_append(&pool->bos, struct panfrost_bo *, bo);
         pool->transient_bo = bo;
@@ -51,11 +119,12 @@ panfrost_pool_alloc_backing(struct pan_pool *pool, size_t bo_sz)
 
 void
 panfrost_pool_init(struct pan_pool *pool, void *memctx,
-                   struct panfrost_device *dev,
+                   struct panfrost_device *dev, struct pan_slab_ring *ring,
                    unsigned create_flags, bool prealloc)
 {
         memset(pool, 0, sizeof(*pool));
         pool->dev = dev;
+        pool->ring = ring;
         pool->create_flags = create_flags;
         util_dynarray_init(&pool->bos, memctx);
 
@@ -66,8 +135,12 @@ panfrost_pool_init(struct pan_pool *pool, void *memctx,
 void
 panfrost_pool_cleanup(struct pan_pool *pool)
 {
-        util_dynarray_foreach(&pool->bos, struct panfrost_bo *, bo)
-                panfrost_bo_unreference(*bo);
+        util_dynarray_foreach(&pool->bos, struct panfrost_bo *, bo) {
+                if (panfrost_pool_uses_ring(pool, (*bo)->size))
+                        pan_slab_ring_put(pool->ring, *bo);
+                else
+                        panfrost_bo_unreference(*bo);
+        }
 
         util_dynarray_fini(&pool->bos);
 }
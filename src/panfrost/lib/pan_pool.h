@@ -31,6 +31,29 @@
 
 #include "util/u_dynarray.h"
 
+/* Transient slabs recycled between pools, in the order they were released.
+ * In OpenGL, a ring is owned by the context, and every batch's pool takes its
+ * slabs from it and gives them back when the batch is freed. A slab is only
+ * handed out again once the GPU is done with it. Since batches of a context
+ * complete in order, only the oldest slab needs to be checked. This avoids
+ * going through the device-wide BO cache (and its madvise ioctls) for every
+ * batch. */
+
+#define PAN_SLAB_RING_SIZE (32)
+
+struct pan_slab_ring {
+        struct panfrost_bo *slabs[PAN_SLAB_RING_SIZE];
+
+        /* Index of the oldest slab, and number of slabs in the ring */
+        unsigned head, count;
+};
+
+void
+pan_slab_ring_init(struct pan_slab_ring *ring);
+
+void
+pan_slab_ring_cleanup(struct pan_slab_ring *ring);
+
 /* Represents a pool of memory that can only grow, used to allocate objects
  * with the same lifetime as the pool itself. In OpenGL, a pool is owned by the
  * batch for transient structures. In Vulkan, it may be owned by e.g. the
@@ -40,6 +63,9 @@ struct pan_pool {
         /* Parent device for allocation */
         struct panfrost_device *dev;
 
+        /* Ring to take slabs from and return them to, or NULL */
+        struct pan_slab_ring *ring;
+
         /* BOs allocated by this pool */
         struct util_dynarray bos;
 
@@ -55,8 +81,8 @@ struct pan_pool {
 
 void
 panfrost_pool_init(struct pan_pool *pool, void *memctx,
-                   struct panfrost_device *dev, unsigned create_flags,
-                   bool prealloc);
+                   struct panfrost_device *dev, struct pan_slab_ring *ring,
+                   unsigned create_flags, bool prealloc);
 
 void
 panfrost_pool_cleanup(struct pan_pool *pool);
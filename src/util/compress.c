@@ -69,14 +69,21 @@ util_compress_max_compressed_len(size_t in_data_size)
 #endif
 }
 
-/* Compress data and return the size of the compressed data */
+/* Compress data and return the size of the compressed data. A level of 0
+ * selects the default level of the compression library in use, higher
+ * levels are clamped to its maximum.
+ */
 size_t
 util_compress_deflate(const uint8_t *in_data, size_t in_data_size,
-                      uint8_t *out_data, size_t out_buff_size)
+                      uint8_t *out_data, size_t out_buff_size,
+                      unsigned level)
 {
 #ifdef HAVE_ZSTD
+   if (level == 0)
+      level = ZSTD_COMPRESSION_LEVEL;
+
    size_t ret = ZSTD_compress(out_data, out_buff_size, in_data, in_data_size,
-                              ZSTD_COMPRESSION_LEVEL);
+                              MIN2(level, (unsigned)ZSTD_maxCLevel()));
    if (ZSTD_isError(ret))
       return 0;
 
@@ -94,7 +101,10 @@ util_compress_deflate(const uint8_t *in_data, size_t in_data_size,
    strm.avail_in = in_data_size;
    strm.avail_out = out_buff_size;
 
-   int ret = deflateInit(&strm, Z_BEST_COMPRESSION);
+   if (level == 0)
+      level = Z_BEST_COMPRESSION;
+
+   int ret = deflateInit(&strm, MIN2(level, Z_BEST_COMPRESSION));
    if (ret != Z_OK) {
        (void) deflateEnd(&strm);
        return 0;
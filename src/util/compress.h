@@ -35,6 +35,7 @@ util_compress_inflate(const uint8_t *in_data, size_t in_data_size,
 
 size_t
 util_compress_deflate(const uint8_t *in_data, size_t in_data_size,
-                      uint8_t *out_data, size_t out_buff_size);
+                      uint8_t *out_data, size_t out_buff_size,
+                      unsigned level);
 
 #endif
@@ -111,11 +111,6 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
    if (cache->path == NULL)
       goto path_fail;
 
-   if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false)) {
-      if (!disk_cache_load_cache_index(local, cache))
-         goto path_fail;
-   }
-
    if (!disk_cache_mmap_cache_index(local, cache, path))
       goto path_fail;
 
@@ -161,6 +156,19 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
 
    cache->max_size = max_size;
 
+   /* Lower levels trade cache size for faster puts, higher levels fit more
+    * items within the maximum cache size.
+    */
+   cache->compression_level =
+      env_var_as_unsigned("MESA_DISK_CACHE_COMPRESSION_LEVEL", 0);
+
+   if (disk_cache_use_single_file()) {
+      if (!disk_cache_load_cache_index(local, cache)) {
+         disk_cache_destroy_mmap(cache);
+         goto path_fail;
+      }
+   }
+
    /* 4 threads were chosen below because just about all modern CPUs currently
     * available that run Mesa have *at least* 4 cores. For these CPUs allowing
     * more threads can result in the queue being processed faster, thus
@@ -174,9 +182,12 @@ disk_cache_create(const char *gpu_name, const char *driver_id,
    if (!util_queue_init(&cache->cache_queue, "disk$", 32, 4,
                         UTIL_QUEUE_INIT_RESIZE_IF_FULL |
                         UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY |
-                        UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY))
+                        UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY |
+                        UTIL_QUEUE_INIT_SHARED_THREADS))
       goto fail;
 
+   simple_mtx_init(&cache->get_queue_mtx, mtx_plain);
+
    cache->path_init_failed = false;
 
  path_fail:
@@ -230,10 +241,16 @@ void
 disk_cache_destroy(struct disk_cache *cache)
 {
    if (cache && !cache->path_init_failed) {
+      if (util_queue_is_initialized(&cache->get_queue)) {
+         util_queue_finish(&cache->get_queue);
+         util_queue_destroy(&cache->get_queue);
+      }
+      simple_mtx_destroy(&cache->get_queue_mtx);
+
       util_queue_finish(&cache->cache_queue);
       util_queue_destroy(&cache->cache_queue);
 
-      if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false))
+      if (disk_cache_use_single_file())
          foz_destroy(&cache->foz_db);
 
       disk_cache_destroy_mmap(cache);
@@ -245,6 +262,8 @@ disk_cache_destroy(struct disk_cache *cache)
 void
 disk_cache_wait_for_idle(struct disk_cache *cache)
 {
+   if (util_queue_is_initialized(&cache->get_queue))
+      util_queue_finish(&cache->get_queue);
    util_queue_finish(&cache->cache_queue);
 }
 
@@ -324,7 +343,7 @@ cache_put(void *job, int thread_index)
    char *filename = NULL;
    struct disk_cache_put_job *dc_job = (struct disk_cache_put_job *) job;
 
-   if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false)) {
+   if (disk_cache_use_single_file()) {
       disk_cache_write_item_to_disk_foz(dc_job);
    } else {
       filename = disk_cache_get_cache_filename(dc_job->cache, dc_job->key);
@@ -396,7 +415,7 @@ disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
       return blob;
    }
 
-   if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false)) {
+   if (disk_cache_use_single_file()) {
       return disk_cache_load_item_foz(cache, key, size);
    } else {
       char *filename = disk_cache_get_cache_filename(cache, key);
@@ -407,6 +426,105 @@ disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
    }
 }
 
+/* The put queue runs at minimum priority, which is fine for writes but not
+ * for lookups something is waiting on, so lookups get their own queue. Most
+ * processes never use it, so it's only created on first use.
+ */
+static struct util_queue *
+get_get_queue(struct disk_cache *cache)
+{
+   if (cache->blob_get_cb || cache->path_init_failed)
+      return NULL;
+
+   simple_mtx_lock(&cache->get_queue_mtx);
+   if (!util_queue_is_initialized(&cache->get_queue)) {
+      util_queue_init(&cache->get_queue, "disk_get$", 32, 4,
+                      UTIL_QUEUE_INIT_RESIZE_IF_FULL |
+                      UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY |
+                      UTIL_QUEUE_INIT_SHARED_THREADS);
+   }
+   simple_mtx_unlock(&cache->get_queue_mtx);
+
+   return util_queue_is_initialized(&cache->get_queue) ?
+          &cache->get_queue : NULL;
+}
+
+static void
+cache_get(void *job, int thread_index)
+{
+   struct disk_cache_get_job *dc_job = (struct disk_cache_get_job *) job;
+
+   dc_job->data = disk_cache_get(dc_job->cache, dc_job->key, &dc_job->size);
+   if (dc_job->cb)
+      dc_job->cb(dc_job->key, dc_job->data, dc_job->size, dc_job->cb_data);
+}
+
+static void
+destroy_get_job(void *job, int thread_index)
+{
+   free(job);
+}
+
+void
+disk_cache_get_async(struct disk_cache *cache, const cache_key key,
+                     disk_cache_get_cb_async cb, void *cb_data)
+{
+   struct util_queue *queue = get_get_queue(cache);
+   struct disk_cache_get_job *dc_job = queue ?
+      (struct disk_cache_get_job *) calloc(1, sizeof(*dc_job)) : NULL;
+
+   if (!dc_job) {
+      size_t size;
+      void *data = disk_cache_get(cache, key, &size);
+      cb(key, data, size, cb_data);
+      return;
+   }
+
+   dc_job->cache = cache;
+   memcpy(dc_job->key, key, sizeof(cache_key));
+   dc_job->cb = cb;
+   dc_job->cb_data = cb_data;
+
+   util_queue_fence_init(&dc_job->fence);
+   util_queue_add_job(queue, dc_job, &dc_job->fence,
+                      cache_get, destroy_get_job, 0);
+}
+
+void
+disk_cache_get_batch(struct disk_cache *cache, unsigned count,
+                     const cache_key *keys, void **data, size_t *sizes)
+{
+   struct util_queue *queue = count > 1 ? get_get_queue(cache) : NULL;
+   struct disk_cache_get_job *jobs = queue ?
+      (struct disk_cache_get_job *) calloc(count, sizeof(*jobs)) : NULL;
+
+   if (!jobs) {
+      for (unsigned i = 0; i < count; i++)
+         data[i] = disk_cache_get(cache, keys[i], sizes ? &sizes[i] : NULL);
+      return;
+   }
+
+   for (unsigned i = 0; i < count; i++) {
+      jobs[i].cache = cache;
+      memcpy(jobs[i].key, keys[i], sizeof(cache_key));
+
+      util_queue_fence_init(&jobs[i].fence);
+      util_queue_add_job(queue, &jobs[i], &jobs[i].fence,
+                         cache_get, NULL, 0);
+   }
+
+   for (unsigned i = 0; i < count; i++) {
+      util_queue_fence_wait(&jobs[i].fence);
+      util_queue_fence_destroy(&jobs[i].fence);
+
+      data[i] = jobs[i].data;
+      if (sizes)
+         sizes[i] = jobs[i].size;
+   }
+
+   free(jobs);
+}
+
 void
 disk_cache_put_key(struct disk_cache *cache, const cache_key key)
 {
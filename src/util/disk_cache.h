@@ -62,6 +62,10 @@ typedef signed long
 (*disk_cache_get_cb) (const void *key, signed long keySize,
                       void *value, signed long valueSize);
 
+typedef void
+(*disk_cache_get_cb_async) (const uint8_t *key, void *data, size_t size,
+                            void *cb_data);
+
 struct cache_item_metadata {
    /**
     * The cache item type. This could be used to identify a GLSL cache item,
@@ -223,6 +227,29 @@ disk_cache_put(struct disk_cache *cache, const cache_key key,
 void *
 disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size);
 
+/**
+ * Retrieve an item previously stored in the cache with the name <key> from a
+ * cache thread.
+ *
+ * \cb is called from that thread with the result of disk_cache_get() for
+ * the key, data is NULL and size is 0 if the item was not found. The data is
+ * malloc'ed and owned by the callback.
+ */
+void
+disk_cache_get_async(struct disk_cache *cache, const cache_key key,
+                     disk_cache_get_cb_async cb, void *cb_data);
+
+/**
+ * Retrieve the items stored under \count keys in parallel, and wait for all
+ * of them.
+ *
+ * On return data[i] and sizes[i] hold what disk_cache_get() returns for
+ * keys[i]. \sizes may be NULL.
+ */
+void
+disk_cache_get_batch(struct disk_cache *cache, unsigned count,
+                     const cache_key *keys, void **data, size_t *sizes);
+
 /**
  * Store the name \key within the cache, (without any associated data).
  *
@@ -293,6 +320,24 @@ disk_cache_get(struct disk_cache *cache, const cache_key key, size_t *size)
    return NULL;
 }
 
+static inline void
+disk_cache_get_async(struct disk_cache *cache, const cache_key key,
+                     disk_cache_get_cb_async cb, void *cb_data)
+{
+   cb(key, NULL, 0, cb_data);
+}
+
+static inline void
+disk_cache_get_batch(struct disk_cache *cache, unsigned count,
+                     const cache_key *keys, void **data, size_t *sizes)
+{
+   for (unsigned i = 0; i < count; i++) {
+      data[i] = NULL;
+      if (sizes)
+         sizes[i] = 0;
+   }
+}
+
 static inline void
 disk_cache_put_key(struct disk_cache *cache, const cache_key key)
 {
@@ -516,45 +516,55 @@ static bool
 create_cache_item_header_and_blob(struct disk_cache_put_job *dc_job,
                                   struct blob *cache_blob)
 {
-
-   /* Compress the cache item data */
-   size_t max_buf = util_compress_max_compressed_len(dc_job->size);
-   void *compressed_data = malloc(max_buf);
-   if (compressed_data == NULL)
-      return false;
-
-   size_t compressed_size =
-      util_compress_deflate(dc_job->data, dc_job->size,
-                            compressed_data, max_buf);
-   if (compressed_size == 0)
-      goto fail;
-
    /* Copy the driver_keys_blob, this can be used find information about the
     * mesa version that produced the entry or deal with hash collisions,
     * should that ever become a real problem.
     */
    if (!blob_write_bytes(cache_blob, dc_job->cache->driver_keys_blob,
                          dc_job->cache->driver_keys_blob_size))
-      goto fail;
+      return false;
 
    /* Write the cache item metadata. This data can be used to deal with
     * hash collisions, as well as providing useful information to 3rd party
     * tools reading the cache files.
     */
    if (!blob_write_uint32(cache_blob, dc_job->cache_item_metadata.type))
-      goto fail;
+      return false;
 
    if (dc_job->cache_item_metadata.type == CACHE_ITEM_TYPE_GLSL) {
       if (!blob_write_uint32(cache_blob, dc_job->cache_item_metadata.num_keys))
-         goto fail;
+         return false;
 
       size_t metadata_keys_size =
          dc_job->cache_item_metadata.num_keys * sizeof(cache_key);
       if (!blob_write_bytes(cache_blob, dc_job->cache_item_metadata.keys[0],
                             metadata_keys_size))
-         goto fail;
+         return false;
    }
 
+   intptr_t cf_data_offset =
+      blob_reserve_bytes(cache_blob, sizeof(struct cache_entry_file_data));
+   if (cf_data_offset < 0)
+      return false;
+
+   /* Compress the cache item data straight into the blob, then drop the
+    * part of the worst case reservation that wasn't needed.
+    */
+   size_t max_buf = util_compress_max_compressed_len(dc_job->size);
+   intptr_t data_offset = blob_reserve_bytes(cache_blob, max_buf);
+   if (data_offset < 0)
+      return false;
+
+   uint8_t *compressed_data = cache_blob->data + data_offset;
+   size_t compressed_size =
+      util_compress_deflate(dc_job->data, dc_job->size,
+                            compressed_data, max_buf,
+                            dc_job->cache->compression_level);
+   if (compressed_size == 0)
+      return false;
+
+   cache_blob->size = data_offset + compressed_size;
+
    /* Create CRC of the compressed data. We will read this when restoring the
     * cache and use it to check for corruption.
     */
@@ -562,19 +572,8 @@ create_cache_item_header_and_blob(struct disk_cache_put_job *dc_job,
    cf_data.crc32 = util_hash_crc32(compressed_data, compressed_size);
    cf_data.uncompressed_size = dc_job->size;
 
-   if (!blob_write_bytes(cache_blob, &cf_data, sizeof(cf_data)))
-      goto fail;
-
-   /* Finally copy the compressed cache blob */
-   if (!blob_write_bytes(cache_blob, compressed_data, compressed_size))
-      goto fail;
-
-   free(compressed_data);
-   return true;
-
- fail:
-   free(compressed_data);
-   return false;
+   return blob_overwrite_bytes(cache_blob, cf_data_offset, &cf_data,
+                               sizeof(cf_data));
 }
 
 void
@@ -695,7 +694,7 @@ disk_cache_generate_cache_dir(void *mem_ctx, const char *gpu_name,
                               const char *driver_id)
 {
    char *cache_dir_name = CACHE_DIR_NAME;
-   if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false))
+   if (disk_cache_use_single_file())
       cache_dir_name = CACHE_DIR_NAME_SF;
 
    char *path = getenv("MESA_GLSL_CACHE_DIR");
@@ -756,7 +755,7 @@ disk_cache_generate_cache_dir(void *mem_ctx, const char *gpu_name,
          return NULL;
    }
 
-   if (env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE", false)) {
+   if (disk_cache_use_single_file()) {
       path = concatenate_and_mkdir(mem_ctx, path, driver_id);
       if (!path)
          return NULL;
@@ -788,6 +787,21 @@ disk_cache_enabled()
    return true;
 }
 
+/* The single file cache is the default wherever Mesa was built with support
+ * for it, MESA_DISK_CACHE_SINGLE_FILE=false selects the multi file cache.
+ */
+bool
+disk_cache_use_single_file(void)
+{
+#ifdef FOZ_DB_UTIL
+   bool single_file_by_default = true;
+#else
+   bool single_file_by_default = false;
+#endif
+   return env_var_as_boolean("MESA_DISK_CACHE_SINGLE_FILE",
+                             single_file_by_default);
+}
+
 void *
 disk_cache_load_item_foz(struct disk_cache *cache, const cache_key key,
                          size_t *size)
@@ -824,7 +838,7 @@ bool
 disk_cache_load_cache_index(void *mem_ctx, struct disk_cache *cache)
 {
    /* Load cache index into a hash map (from fossilise files) */
-   return foz_prepare(&cache->foz_db, cache->path);
+   return foz_prepare(&cache->foz_db, cache->path, cache->max_size);
 }
 
 bool
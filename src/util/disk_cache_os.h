@@ -51,6 +51,10 @@ struct disk_cache {
    /* Thread queue for compressing and writing cache entries to disk */
    struct util_queue cache_queue;
 
+   /* Thread queue for disk_cache_get_async(), created on first use */
+   struct util_queue get_queue;
+   simple_mtx_t get_queue_mtx;
+
    struct foz_db foz_db;
 
    /* Seed for rand, which is used to pick a random directory */
@@ -69,6 +73,9 @@ struct disk_cache {
    /* Maximum size of all cached objects (in bytes). */
    uint64_t max_size;
 
+   /* Compression level for new cache items, 0 for the default. */
+   unsigned compression_level;
+
    /* Driver cache keys. */
    uint8_t *driver_keys_blob;
    size_t driver_keys_blob_size;
@@ -93,6 +100,21 @@ struct disk_cache_put_job {
    struct cache_item_metadata cache_item_metadata;
 };
 
+struct disk_cache_get_job {
+   struct util_queue_fence fence;
+
+   struct disk_cache *cache;
+
+   cache_key key;
+
+   disk_cache_get_cb_async cb;
+   void *cb_data;
+
+   /* Result of the lookup, for disk_cache_get_batch(). */
+   void *data;
+   size_t size;
+};
+
 char *
 disk_cache_generate_cache_dir(void *mem_ctx, const char *gpu_name,
                               const char *driver_id);
@@ -123,6 +145,9 @@ disk_cache_write_item_to_disk(struct disk_cache_put_job *dc_job,
 bool
 disk_cache_enabled(void);
 
+bool
+disk_cache_use_single_file(void);
+
 bool
 disk_cache_load_cache_index(void *mem_ctx, struct disk_cache *cache);
 
@@ -425,6 +425,22 @@
    DRI_CONF_OPT_B(radeonsi_zerovram, def, \
                   "Zero all vram allocations")
 
+#define DRI_CONF_RADEONSI_PRIM_DISCARD_CS(def) \
+   DRI_CONF_OPT_B(radeonsi_prim_discard_cs, def, \
+                  "Cull primitives of large draw calls with a compute shader before rasterization")
+
+#define DRI_CONF_RADEONSI_PRIM_DISCARD_CS_MIN_TRIANGLES(def) \
+   DRI_CONF_OPT_I(radeonsi_prim_discard_cs_min_triangles, def, 0, 10000000, \
+                  "Minimum number of triangles of a draw call culled by the compute shader (0 = derive it from the number of compute units)")
+
+#define DRI_CONF_RADEONSI_NGG_CULL_VERT_THRESHOLD(def) \
+   DRI_CONF_OPT_I(radeonsi_ngg_cull_vert_threshold, def, -1, 10000000, \
+                  "Enable NGG culling in vertex shaders for draw calls with more vertices than this (-1 = chip default)")
+
+#define DRI_CONF_RADEONSI_NGG_CULL_TESS(def) \
+   DRI_CONF_OPT_B(radeonsi_ngg_cull_tess, def, \
+                  "Enable NGG culling in tessellation evaluation shaders")
+
 #define DRI_CONF_V3D_NONMSAA_TEXTURE_SIZE_LIMIT(def) \
    DRI_CONF_OPT_B(v3d_nonmsaa_texture_size_limit, def, \
                   "Report the non-MSAA-only texture size limit")
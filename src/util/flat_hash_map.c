@@ -0,0 +1,204 @@
+/*
+ * Copyright © 2021 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "flat_hash_map.h"
+#include "ralloc.h"
+
+static bool
+flat_hash_map_alloc(struct flat_hash_map *map, uint32_t num_groups)
+{
+   uint32_t num_slots = num_groups * FLAT_HASH_MAP_GROUP_SIZE;
+
+   uint8_t *ctrl = ralloc_array(map, uint8_t, num_slots);
+   struct flat_hash_map_entry *table =
+      ralloc_array(map, struct flat_hash_map_entry, num_slots);
+   if (!ctrl || !table) {
+      ralloc_free(ctrl);
+      ralloc_free(table);
+      return false;
+   }
+
+   memset(ctrl, FLAT_HASH_MAP_CTRL_EMPTY, num_slots);
+
+   map->ctrl = ctrl;
+   map->table = table;
+   map->num_groups = num_groups;
+   map->entries = 0;
+   map->deleted_entries = 0;
+   return true;
+}
+
+struct flat_hash_map *
+flat_hash_map_create(void *mem_ctx)
+{
+   struct flat_hash_map *map = ralloc(mem_ctx, struct flat_hash_map);
+   if (!map)
+      return NULL;
+
+   if (!flat_hash_map_alloc(map, 1)) {
+      ralloc_free(map);
+      return NULL;
+   }
+
+   return map;
+}
+
+void
+flat_hash_map_destroy(struct flat_hash_map *map)
+{
+   ralloc_free(map);
+}
+
+void
+flat_hash_map_clear(struct flat_hash_map *map)
+{
+   memset(map->ctrl, FLAT_HASH_MAP_CTRL_EMPTY,
+          map->num_groups * FLAT_HASH_MAP_GROUP_SIZE);
+   map->entries = 0;
+   map->deleted_entries = 0;
+}
+
+/* Returns the index of the first empty or deleted slot along the probe
+ * sequence of hash. There always is one, as the map is never full.
+ */
+static uint32_t
+find_free_slot(struct flat_hash_map *map, uint64_t hash)
+{
+   uint32_t mask = map->num_groups - 1;
+   uint32_t group = (hash >> 7) & mask;
+
+   for (uint32_t i = 0; ; i++) {
+      uint32_t base = group * FLAT_HASH_MAP_GROUP_SIZE;
+      const uint8_t *ctrl = map->ctrl + base;
+
+      /* Empty and deleted are the only control bytes with the top bit set. */
+      uint32_t free_slots = 0;
+      for (unsigned j = 0; j < FLAT_HASH_MAP_GROUP_SIZE; j++)
+         free_slots |= (uint32_t)(ctrl[j] >> 7) << j;
+
+      if (free_slots)
+         return base + u_bit_scan(&free_slots);
+
+      group = (group + i + 1) & mask;
+   }
+}
+
+static void
+rehash(struct flat_hash_map *map, uint32_t num_groups)
+{
+   uint8_t *old_ctrl = map->ctrl;
+   struct flat_hash_map_entry *old_table = map->table;
+   uint32_t old_slots = map->num_groups * FLAT_HASH_MAP_GROUP_SIZE;
+
+   if (!flat_hash_map_alloc(map, num_groups))
+      return;
+
+   for (uint32_t i = 0; i < old_slots; i++) {
+      if (old_ctrl[i] & FLAT_HASH_MAP_CTRL_EMPTY)
+         continue;
+
+      uint64_t hash = flat_hash_map_hash(old_table[i].key);
+      uint32_t slot = find_free_slot(map, hash);
+      map->ctrl[slot] = hash & 0x7f;
+      map->table[slot] = old_table[i];
+      map->entries++;
+   }
+
+   ralloc_free(old_ctrl);
+   ralloc_free(old_table);
+}
+
+void
+flat_hash_map_insert(struct flat_hash_map *map, uint64_t key, void *data)
+{
+   struct flat_hash_map_entry *entry = flat_hash_map_search_entry(map, key);
+   if (entry) {
+      entry->data = data;
+      return;
+   }
+
+   /* Keep at least 1/8 of the slots empty so probing terminates early. If
+    * the map is mostly deleted entries, rehash at the same size to drop them.
+    */
+   uint32_t num_slots = map->num_groups * FLAT_HASH_MAP_GROUP_SIZE;
+   if ((uint64_t)(map->entries + map->deleted_entries + 1) * 8 >
+       (uint64_t)num_slots * 7) {
+      if ((uint64_t)(map->entries + 1) * 16 > (uint64_t)num_slots * 7)
+         rehash(map, map->num_groups * 2);
+      else
+         rehash(map, map->num_groups);
+   }
+
+   uint64_t hash = flat_hash_map_hash(key);
+   uint32_t slot = find_free_slot(map, hash);
+   if (map->ctrl[slot] == FLAT_HASH_MAP_CTRL_DELETED)
+      map->deleted_entries--;
+
+   map->ctrl[slot] = hash & 0x7f;
+   map->table[slot].key = key;
+   map->table[slot].data = data;
+   map->entries++;
+}
+
+bool
+flat_hash_map_remove(struct flat_hash_map *map, uint64_t key)
+{
+   struct flat_hash_map_entry *entry = flat_hash_map_search_entry(map, key);
+   if (!entry)
+      return false;
+
+   uint32_t slot = entry - map->table;
+   const uint8_t *group_ctrl =
+      map->ctrl + slot / FLAT_HASH_MAP_GROUP_SIZE * FLAT_HASH_MAP_GROUP_SIZE;
+
+   /* Lookups stop at the first group with an empty slot, so if this group
+    * already has one no probe sequence continues past it, and the slot can
+    * simply be emptied.
+    */
+   if (flat_hash_map_group_match(group_ctrl, FLAT_HASH_MAP_CTRL_EMPTY)) {
+      map->ctrl[slot] = FLAT_HASH_MAP_CTRL_EMPTY;
+   } else {
+      map->ctrl[slot] = FLAT_HASH_MAP_CTRL_DELETED;
+      map->deleted_entries++;
+   }
+   map->entries--;
+
+   return true;
+}
+
+struct flat_hash_map_entry *
+flat_hash_map_next_entry(struct flat_hash_map *map,
+                         struct flat_hash_map_entry *entry)
+{
+   uint32_t num_slots = map->num_groups * FLAT_HASH_MAP_GROUP_SIZE;
+   uint32_t slot = entry ? entry - map->table + 1 : 0;
+
+   for (; slot < num_slots; slot++) {
+      if (!(map->ctrl[slot] & FLAT_HASH_MAP_CTRL_EMPTY))
+         return &map->table[slot];
+   }
+
+   return NULL;
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright © 2021 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * Open addressing hash map from 64-bit integer keys to pointers.
+ *
+ * Unlike struct hash_table, keys are compared and hashed inline instead of
+ * through function pointers, and any key value can be stored. Slots are
+ * split into groups of 16 with one control byte per slot: either empty,
+ * deleted, or the low 7 bits of the key's hash. A lookup compares the
+ * control bytes of a whole group at once (with SSE2 or NEON where
+ * available), and only looks at the keys of slots whose bits match.
+ *
+ * Pointer and 32-bit keys are supported through the _ptr and _u32 wrappers.
+ */
+
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bitscan.h"
+#include "macros.h"
+
+#if defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || (defined(_M_X64) && !defined(_M_ARM64EC))
+#include <emmintrin.h>
+#define FLAT_HASH_MAP_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FLAT_HASH_MAP_NEON 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLAT_HASH_MAP_GROUP_SIZE 16
+#define FLAT_HASH_MAP_CTRL_EMPTY 0x80
+#define FLAT_HASH_MAP_CTRL_DELETED 0xfe
+
+struct flat_hash_map_entry {
+   uint64_t key;
+   void *data;
+};
+
+struct flat_hash_map {
+   /* One control byte per slot. */
+   uint8_t *ctrl;
+   struct flat_hash_map_entry *table;
+   /* Number of groups of FLAT_HASH_MAP_GROUP_SIZE slots, a power of two. */
+   uint32_t num_groups;
+   uint32_t entries;
+   uint32_t deleted_entries;
+};
+
+struct flat_hash_map *
+flat_hash_map_create(void *mem_ctx);
+
+void
+flat_hash_map_destroy(struct flat_hash_map *map);
+
+void
+flat_hash_map_clear(struct flat_hash_map *map);
+
+void
+flat_hash_map_insert(struct flat_hash_map *map, uint64_t key, void *data);
+
+bool
+flat_hash_map_remove(struct flat_hash_map *map, uint64_t key);
+
+struct flat_hash_map_entry *
+flat_hash_map_next_entry(struct flat_hash_map *map,
+                         struct flat_hash_map_entry *entry);
+
+/**
+ * This foreach function is safe against deletion, but not against insertion
+ * (which may rehash the map, making entry a dangling pointer).
+ */
+#define flat_hash_map_foreach(map, entry)                                    \
+   for (struct flat_hash_map_entry *entry =                                  \
+           flat_hash_map_next_entry(map, NULL);                              \
+        entry != NULL;                                                       \
+        entry = flat_hash_map_next_entry(map, entry))
+
+/* The murmur3 64-bit finalizer, every bit of the key affects every bit of
+ * the hash.
+ */
+static inline uint64_t
+flat_hash_map_hash(uint64_t key)
+{
+   key ^= key >> 33;
+   key *= 0xff51afd7ed558ccdull;
+   key ^= key >> 33;
+   key *= 0xc4ceb9fe1a85ec53ull;
+   key ^= key >> 33;
+   return key;
+}
+
+/* Returns a mask with bit i set if control byte i of the group equals v. */
+static inline uint32_t
+flat_hash_map_group_match(const uint8_t *ctrl, uint8_t v)
+{
+#if defined(FLAT_HASH_MAP_SSE2)
+   __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+   return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)v)));
+#elif defined(FLAT_HASH_MAP_NEON)
+   static const uint8_t bits[16] = {
+      1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128,
+   };
+   uint8x16_t match = vandq_u8(vceqq_u8(vld1q_u8(ctrl), vdupq_n_u8(v)),
+                               vld1q_u8(bits));
+   return vaddv_u8(vget_low_u8(match)) |
+          (vaddv_u8(vget_high_u8(match)) << 8);
+#else
+   uint32_t mask = 0;
+   for (unsigned i = 0; i < FLAT_HASH_MAP_GROUP_SIZE; i++)
+      mask |= (uint32_t)(ctrl[i] == v) << i;
+   return mask;
+#endif
+}
+
+static inline struct flat_hash_map_entry *
+flat_hash_map_search_entry(struct flat_hash_map *map, uint64_t key)
+{
+   uint64_t hash = flat_hash_map_hash(key);
+   uint8_t h2 = hash & 0x7f;
+   uint32_t mask = map->num_groups - 1;
+   uint32_t group = (hash >> 7) & mask;
+
+   for (uint32_t i = 0; i < map->num_groups; i++) {
+      uint32_t base = group * FLAT_HASH_MAP_GROUP_SIZE;
+      const uint8_t *ctrl = map->ctrl + base;
+
+      uint32_t match = flat_hash_map_group_match(ctrl, h2);
+      while (match) {
+         struct flat_hash_map_entry *entry = &map->table[base + u_bit_scan(&match)];
+         if (likely(entry->key == key))
+            return entry;
+      }
+
+      if (likely(flat_hash_map_group_match(ctrl, FLAT_HASH_MAP_CTRL_EMPTY)))
+         return NULL;
+
+      /* Triangular probing visits every group of a power of two table. */
+      group = (group + i + 1) & mask;
+   }
+
+   return NULL;
+}
+
+static inline void *
+flat_hash_map_search(struct flat_hash_map *map, uint64_t key)
+{
+   struct flat_hash_map_entry *entry = flat_hash_map_search_entry(map, key);
+   return entry ? entry->data : NULL;
+}
+
+static inline void
+flat_hash_map_insert_ptr(struct flat_hash_map *map, const void *key,
+                         void *data)
+{
+   flat_hash_map_insert(map, (uintptr_t)key, data);
+}
+
+static inline void *
+flat_hash_map_search_ptr(struct flat_hash_map *map, const void *key)
+{
+   return flat_hash_map_search(map, (uintptr_t)key);
+}
+
+static inline bool
+flat_hash_map_remove_ptr(struct flat_hash_map *map, const void *key)
+{
+   return flat_hash_map_remove(map, (uintptr_t)key);
+}
+
+static inline void
+flat_hash_map_insert_u32(struct flat_hash_map *map, uint32_t key, void *data)
+{
+   flat_hash_map_insert(map, key, data);
+}
+
+static inline void *
+flat_hash_map_search_u32(struct flat_hash_map *map, uint32_t key)
+{
+   return flat_hash_map_search(map, key);
+}
+
+static inline bool
+flat_hash_map_remove_u32(struct flat_hash_map *map, uint32_t key)
+{
+   return flat_hash_map_remove(map, key);
+}
+
+#ifdef __cplusplus
+} /* extern C */
+#endif
+
+#endif /* FLAT_HASH_MAP_H */
@@ -34,7 +34,11 @@
 
 #include "util/format/u_format.h"
 #include "util/format/u_format_s3tc.h"
+#include "util/u_atomic.h"
+#include "util/u_cpu_detect.h"
 #include "util/u_math.h"
+#include "util/u_queue.h"
+#include "c11/threads.h"
 
 #include "pipe/p_defines.h"
 #include "pipe/p_screen.h"
@@ -450,6 +454,199 @@ util_format_write_4ub(enum pipe_format format, const uint8_t *src, unsigned src_
    pack->pack_rgba_8unorm(dst_row, dst_stride, src_row, src_stride, w, h);
 }
 
+
+/* Rects with fewer pixels are unpacked on the calling thread. */
+#define UNPACK_PARALLEL_MIN_PIXELS (256 * 256)
+/* Minimum number of pixel rows per band. */
+#define UNPACK_PARALLEL_MIN_ROWS 32
+#define UNPACK_PARALLEL_MAX_JOBS 16
+
+struct unpack_rect {
+   util_format_unpack_rect_func func;
+   void *data;
+   unsigned block_height;
+   uint8_t *dst;
+   unsigned dst_stride;
+   const uint8_t *src;
+   unsigned src_stride;
+   unsigned width, height;
+   unsigned band_height;
+   int num_bands;
+
+   int next_band;
+   int bands_done;
+   struct util_queue_fence done;
+
+   /* One reference per queued job and one for the caller. */
+   int refcount;
+   struct util_queue_fence fences[UNPACK_PARALLEL_MAX_JOBS];
+};
+
+static struct util_queue unpack_queue;
+static once_flag unpack_queue_once = ONCE_FLAG_INIT;
+static bool unpack_queue_initialized;
+
+static void
+unpack_queue_init(void)
+{
+   util_cpu_detect();
+   unpack_queue_initialized =
+      util_queue_init(&unpack_queue, "unpack",
+                      UNPACK_PARALLEL_MAX_JOBS * 2,
+                      util_get_cpu_caps()->nr_cpus,
+                      UTIL_QUEUE_INIT_RESIZE_IF_FULL |
+                      UTIL_QUEUE_INIT_SHARED_THREADS);
+}
+
+static void
+unpack_rect_unref(struct unpack_rect *rect)
+{
+   if (p_atomic_dec_zero(&rect->refcount)) {
+      for (unsigned i = 0; i < UNPACK_PARALLEL_MAX_JOBS; i++)
+         util_queue_fence_destroy(&rect->fences[i]);
+      util_queue_fence_destroy(&rect->done);
+      free(rect);
+   }
+}
+
+/* Unpacks bands until there are none left. Pool threads and the caller
+ * all run this, so the caller never waits on a band nobody started.
+ */
+static void
+unpack_rect_bands(struct unpack_rect *rect)
+{
+   int band;
+
+   while ((band = p_atomic_inc_return(&rect->next_band) - 1) < rect->num_bands) {
+      unsigned y = band * rect->band_height;
+
+      rect->func(rect->data,
+                 rect->dst + y * rect->dst_stride, rect->dst_stride,
+                 rect->src + y / rect->block_height * rect->src_stride,
+                 rect->src_stride,
+                 rect->width, MIN2(rect->band_height, rect->height - y));
+
+      if (p_atomic_inc_return(&rect->bands_done) == rect->num_bands)
+         util_queue_fence_signal(&rect->done);
+   }
+}
+
+static void
+unpack_rect_execute(void *job, UNUSED int thread_index)
+{
+   unpack_rect_bands(job);
+}
+
+static void
+unpack_rect_cleanup(void *job, UNUSED int thread_index)
+{
+   unpack_rect_unref(job);
+}
+
+void
+util_format_unpack_rect_parallel(util_format_unpack_rect_func func, void *data,
+                                 unsigned block_height,
+                                 uint8_t *dst, unsigned dst_stride,
+                                 const uint8_t *src, unsigned src_stride,
+                                 unsigned width, unsigned height)
+{
+   unsigned band_height = align(MAX2(UNPACK_PARALLEL_MIN_ROWS, block_height),
+                                block_height);
+   unsigned num_bands = DIV_ROUND_UP(height, band_height);
+
+   if ((uint64_t)width * height < UNPACK_PARALLEL_MIN_PIXELS || num_bands < 2) {
+      func(data, dst, dst_stride, src, src_stride, width, height);
+      return;
+   }
+
+   call_once(&unpack_queue_once, unpack_queue_init);
+   if (!unpack_queue_initialized) {
+      func(data, dst, dst_stride, src, src_stride, width, height);
+      return;
+   }
+
+   /* Jobs that start after the caller took the last band only drop their
+    * reference, so the state is refcounted instead of living on the stack.
+    */
+   struct unpack_rect *rect = calloc(1, sizeof(*rect));
+   if (!rect) {
+      func(data, dst, dst_stride, src, src_stride, width, height);
+      return;
+   }
+
+   unsigned num_jobs = MIN3(num_bands, util_get_cpu_caps()->nr_cpus,
+                            UNPACK_PARALLEL_MAX_JOBS + 1) - 1;
+
+   rect->func = func;
+   rect->data = data;
+   rect->block_height = block_height;
+   rect->dst = dst;
+   rect->dst_stride = dst_stride;
+   rect->src = src;
+   rect->src_stride = src_stride;
+   rect->width = width;
+   rect->height = height;
+   rect->band_height = band_height;
+   rect->num_bands = num_bands;
+   rect->refcount = num_jobs + 1;
+   util_queue_fence_init(&rect->done);
+   util_queue_fence_reset(&rect->done);
+   for (unsigned i = 0; i < UNPACK_PARALLEL_MAX_JOBS; i++)
+      util_queue_fence_init(&rect->fences[i]);
+
+   for (unsigned i = 0; i < num_jobs; i++) {
+      util_queue_add_job(&unpack_queue, rect, &rect->fences[i],
+                         unpack_rect_execute, unpack_rect_cleanup, 0);
+   }
+
+   unpack_rect_bands(rect);
+   util_queue_fence_wait(&rect->done);
+
+   /* Fences are read relaxed. This acquire pairs with the increments of
+    * bands_done, so that the writes of the pool threads are visible.
+    */
+   ASSERTED int bands_done = p_atomic_read(&rect->bands_done);
+   assert(bands_done == rect->num_bands);
+
+   unpack_rect_unref(rect);
+}
+
+static void
+unpack_rgba_8unorm_rect(void *data,
+                        uint8_t *dst_row, unsigned dst_stride,
+                        const uint8_t *src_row, unsigned src_stride,
+                        unsigned width, unsigned height)
+{
+   const struct util_format_unpack_description *unpack = data;
+
+   unpack->unpack_rgba_8unorm(dst_row, dst_stride, src_row, src_stride,
+                              width, height);
+}
+
+void
+util_format_unpack_rgba_8unorm_parallel(enum pipe_format format,
+                                        uint8_t *dst, unsigned dst_stride,
+                                        const void *src, unsigned src_stride,
+                                        unsigned width, unsigned height)
+{
+   const struct util_format_description *format_desc =
+      util_format_description(format);
+   const struct util_format_unpack_description *unpack =
+      util_format_unpack_description(format);
+
+   /* Plain formats are cheap enough that threads don't pay off. */
+   if (!util_format_is_compressed(format)) {
+      unpack->unpack_rgba_8unorm(dst, dst_stride, src, src_stride,
+                                 width, height);
+      return;
+   }
+
+   util_format_unpack_rect_parallel(unpack_rgba_8unorm_rect, (void *)unpack,
+                                    format_desc->block.height,
+                                    dst, dst_stride, src, src_stride,
+                                    width, height);
+}
+
 /**
  * Check if we can safely memcopy from the source format to the dest format.
  * This basically covers the cases of a "used" channel copied to a typeless
@@ -1558,6 +1558,35 @@ util_format_write_4ub(enum pipe_format format,
                       void *dst, unsigned dst_stride, 
                       unsigned x, unsigned y, unsigned w, unsigned h);
 
+typedef void
+(*util_format_unpack_rect_func)(void *data,
+                                uint8_t *dst_row, unsigned dst_stride,
+                                const uint8_t *src_row, unsigned src_stride,
+                                unsigned width, unsigned height);
+
+/**
+ * Calls func on horizontal bands of the rect, in parallel on the shared
+ * thread pool if the rect is large enough. src_stride is the stride of a
+ * row of blocks, and every band but the last one is a multiple of
+ * block_height rows. Returns once all bands are done.
+ */
+void
+util_format_unpack_rect_parallel(util_format_unpack_rect_func func, void *data,
+                                 unsigned block_height,
+                                 uint8_t *dst, unsigned dst_stride,
+                                 const uint8_t *src, unsigned src_stride,
+                                 unsigned width, unsigned height);
+
+/**
+ * Unpacks a rect to RGBA8 unorm, in parallel for large rects of
+ * compressed formats.
+ */
+void
+util_format_unpack_rgba_8unorm_parallel(enum pipe_format format,
+                                        uint8_t *dst, unsigned dst_stride,
+                                        const void *src, unsigned src_stride,
+                                        unsigned width, unsigned height);
+
 /*
  * Generic format conversion;
  */
@@ -115,6 +115,108 @@ util_format_dxt5_rgba_fetch_rgba(void *restrict in_dst, const uint8_t *restrict
 }
 
 
+/*
+ * Block decoding.
+ *
+ * Decodes all 16 texels of a block at once, in row order, building the
+ * palettes only once per block. Gives the same results as the fetch
+ * functions.
+ */
+
+typedef void (*util_format_dxtn_decode_t)(const uint8_t *blksrc, uint8_t rgba[16][4]);
+
+static void
+dxt135_decode_block(const uint8_t *img_block_src, unsigned dxt_type,
+                    uint8_t rgba[16][4])
+{
+   const uint16_t color0 = img_block_src[0] | (img_block_src[1] << 8);
+   const uint16_t color1 = img_block_src[2] | (img_block_src[3] << 8);
+   const unsigned bits = img_block_src[4] | (img_block_src[5] << 8) |
+      (img_block_src[6] << 16) | ((unsigned)img_block_src[7] << 24);
+   const int r0 = EXP5TO8R(color0), g0 = EXP6TO8G(color0), b0 = EXP5TO8B(color0);
+   const int r1 = EXP5TO8R(color1), g1 = EXP6TO8G(color1), b1 = EXP5TO8B(color1);
+   uint8_t palette[4][4] = {
+      { r0, g0, b0, CHAN_MAX },
+      { r1, g1, b1, CHAN_MAX },
+   };
+   unsigned i, k;
+
+   if ((dxt_type > 1) || (color0 > color1)) {
+      palette[2][RCOMP] = (r0 * 2 + r1) / 3;
+      palette[2][GCOMP] = (g0 * 2 + g1) / 3;
+      palette[2][BCOMP] = (b0 * 2 + b1) / 3;
+      palette[3][RCOMP] = (r0 + r1 * 2) / 3;
+      palette[3][GCOMP] = (g0 + g1 * 2) / 3;
+      palette[3][BCOMP] = (b0 + b1 * 2) / 3;
+      palette[3][ACOMP] = CHAN_MAX;
+   }
+   else {
+      palette[2][RCOMP] = (r0 + r1) / 2;
+      palette[2][GCOMP] = (g0 + g1) / 2;
+      palette[2][BCOMP] = (b0 + b1) / 2;
+      palette[3][ACOMP] = dxt_type == 1 ? 0 : CHAN_MAX;
+   }
+   palette[2][ACOMP] = CHAN_MAX;
+
+   for (i = 0; i < 16; i++) {
+      const unsigned code = (bits >> (2 * i)) & 3;
+      for (k = 0; k < 4; k++)
+         rgba[i][k] = palette[code][k];
+   }
+}
+
+static void
+decode_block_rgb_dxt1(const uint8_t *blksrc, uint8_t rgba[16][4])
+{
+   dxt135_decode_block(blksrc, 0, rgba);
+}
+
+static void
+decode_block_rgba_dxt1(const uint8_t *blksrc, uint8_t rgba[16][4])
+{
+   dxt135_decode_block(blksrc, 1, rgba);
+}
+
+static void
+decode_block_rgba_dxt3(const uint8_t *blksrc, uint8_t rgba[16][4])
+{
+   unsigned i;
+
+   dxt135_decode_block(blksrc + 8, 2, rgba);
+   for (i = 0; i < 16; i++) {
+      const uint8_t anibble = (blksrc[i / 2] >> (4 * (i & 1))) & 0xf;
+      rgba[i][ACOMP] = EXP4TO8(anibble);
+   }
+}
+
+static void
+decode_block_rgba_dxt5(const uint8_t *blksrc, uint8_t rgba[16][4])
+{
+   const int alpha0 = blksrc[0];
+   const int alpha1 = blksrc[1];
+   const uint64_t codes = (uint64_t)blksrc[2] | ((uint64_t)blksrc[3] << 8) |
+      ((uint64_t)blksrc[4] << 16) | ((uint64_t)blksrc[5] << 24) |
+      ((uint64_t)blksrc[6] << 32) | ((uint64_t)blksrc[7] << 40);
+   uint8_t alpha[8];
+   unsigned i;
+
+   alpha[0] = alpha0;
+   alpha[1] = alpha1;
+   for (i = 2; i < 8; i++) {
+      if (alpha0 > alpha1)
+         alpha[i] = (alpha0 * (8 - i) + (alpha1 * (i - 1))) / 7;
+      else if (i < 6)
+         alpha[i] = (alpha0 * (6 - i) + (alpha1 * (i - 1))) / 5;
+      else
+         alpha[i] = i == 6 ? 0 : CHAN_MAX;
+   }
+
+   dxt135_decode_block(blksrc + 8, 2, rgba);
+   for (i = 0; i < 16; i++)
+      rgba[i][ACOMP] = alpha[(codes >> (3 * i)) & 0x7];
+}
+
+
 /*
  * Block decompression.
  */
@@ -123,7 +225,7 @@ static inline void
 util_format_dxtn_rgb_unpack_rgba_8unorm(uint8_t *restrict dst_row, unsigned dst_stride,
                                         const uint8_t *restrict src_row, unsigned src_stride,
                                         unsigned width, unsigned height,
-                                        util_format_dxtn_fetch_t fetch,
+                                        util_format_dxtn_decode_t decode,
                                         unsigned block_size, boolean srgb)
 {
    const unsigned bw = 4, bh = 4, comps = 4;
@@ -131,16 +233,21 @@ util_format_dxtn_rgb_unpack_rgba_8unorm(uint8_t *restrict dst_row, unsigned dst_
    for(y = 0; y < height; y += bh) {
       const uint8_t *src = src_row;
       for(x = 0; x < width; x += bw) {
-         for(j = 0; j < bh; ++j) {
-            for(i = 0; i < bw; ++i) {
-               uint8_t *dst = dst_row + (y + j)*dst_stride/sizeof(*dst_row) + (x + i)*comps;
-               fetch(0, src, i, j, dst);
-               if (srgb) {
-                  dst[0] = util_format_srgb_to_linear_8unorm(dst[0]);
-                  dst[1] = util_format_srgb_to_linear_8unorm(dst[1]);
-                  dst[2] = util_format_srgb_to_linear_8unorm(dst[2]);
+         uint8_t texels[16][4];
+         decode(src, texels);
+         for(j = 0; j < MIN2(bh, height - y); ++j) {
+            uint8_t *dst = dst_row + (y + j)*dst_stride/sizeof(*dst_row) + x*comps;
+            if (srgb) {
+               for(i = 0; i < MIN2(bw, width - x); ++i) {
+                  dst[i*comps + 0] = util_format_srgb_to_linear_8unorm(texels[j*bw + i][0]);
+                  dst[i*comps + 1] = util_format_srgb_to_linear_8unorm(texels[j*bw + i][1]);
+                  dst[i*comps + 2] = util_format_srgb_to_linear_8unorm(texels[j*bw + i][2]);
+                  dst[i*comps + 3] = texels[j*bw + i][3];
                }
             }
+            else {
+               memcpy(dst, texels[j*bw], MIN2(bw, width - x)*comps);
+            }
          }
          src += block_size;
       }
@@ -156,7 +263,7 @@ util_format_dxt1_rgb_unpack_rgba_8unorm(uint8_t *restrict dst_row, unsigned dst_
    util_format_dxtn_rgb_unpack_rgba_8unorm(dst_row, dst_stride,
                                            src_row, src_stride,
                                            width, height,
-                                           util_format_dxt1_rgb_fetch,
+                                           decode_block_rgb_dxt1,
                                            8, FALSE);
 }
 
@@ -168,7 +275,7 @@ util_format_dxt1_rgba_unpack_rgba_8unorm(uint8_t *restrict dst_row, unsigned dst
    util_format_dxtn_rgb_unpack_rgba_8unorm(dst_row, dst_stride,
                                            src_row, src_stride,
                                            width, height,
-                                           util_format_dxt1_rgba_fetch,
+                                           decode_block_rgba_dxt1,
                                            8, FALSE);
 }
 
@@ -180,7 +287,7 @@ util_format_dxt3_rgba_unpack_rgba_8unorm(uint8_t *restrict dst_row, unsigned dst
    util_format_dxtn_rgb_unpack_rgba_8unorm(dst_row, dst_stride,
                                            src_row, src_stride,
                                            width, height,
-                                           util_format_dxt3_rgba_fetch,
+                                           decode_block_rgba_dxt3,
                                            16, FALSE);
 }
 
@@ -192,7 +299,7 @@ util_format_dxt5_rgba_unpack_rgba_8unorm(uint8_t *restrict dst_row, unsigned dst
    util_format_dxtn_rgb_unpack_rgba_8unorm(dst_row, dst_stride,
                                            src_row, src_stride,
                                            width, height,
-                                           util_format_dxt5_rgba_fetch,
+                                           decode_block_rgba_dxt5,
                                            16, FALSE);
 }
 
@@ -200,18 +307,19 @@ static inline void
 util_format_dxtn_rgb_unpack_rgba_float(float *restrict dst_row, unsigned dst_stride,
                                        const uint8_t *restrict src_row, unsigned src_stride,
                                        unsigned width, unsigned height,
-                                       util_format_dxtn_fetch_t fetch,
+                                       util_format_dxtn_decode_t decode,
                                        unsigned block_size, boolean srgb)
 {
    unsigned x, y, i, j;
    for(y = 0; y < height; y += 4) {
       const uint8_t *src = src_row;
       for(x = 0; x < width; x += 4) {
-         for(j = 0; j < 4; ++j) {
-            for(i = 0; i < 4; ++i) {
+         uint8_t texels[16][4];
+         decode(src, texels);
+         for(j = 0; j < MIN2(4, height - y); ++j) {
+            for(i = 0; i < MIN2(4, width - x); ++i) {
                float *dst = dst_row + (y + j)*dst_stride/sizeof(*dst_row) + (x + i)*4;
-               uint8_t tmp[4];
-               fetch(0, src, i, j, tmp);
+               const uint8_t *tmp = texels[j*4 + i];
                if (srgb) {
                   dst[0] = util_format_srgb_8unorm_to_linear_float(tmp[0]);
                   dst[1] = util_format_srgb_8unorm_to_linear_float(tmp[1]);
@@ -239,7 +347,7 @@ util_format_dxt1_rgb_unpack_rgba_float(void *restrict dst_row, unsigned dst_stri
    util_format_dxtn_rgb_unpack_rgba_float(dst_row, dst_stride,
                                           src_row, src_stride,
                                           width, height,
-                                          util_format_dxt1_rgb_fetch,
+                                          decode_block_rgb_dxt1,
                                           8, FALSE);
 }
 
@@ -251,7 +359,7 @@ util_format_dxt1_rgba_unpack_rgba_float(void *restrict dst_row, unsigned dst_str
    util_format_dxtn_rgb_unpack_rgba_float(dst_row, dst_stride,
                                           src_row, src_stride,
                                           width, height,
-                                          util_format_dxt1_rgba_fetch,
+                                          decode_block_rgba_dxt1,
                                           8, FALSE);
 }
 
@@ -263,7 +371,7 @@ util_format_dxt3_rgba_unpack_rgba_float(void *restrict dst_row, unsigned dst_str
    util_format_dxtn_rgb_unpack_rgba_float(dst_row, dst_stride,
                                           src_row, src_stride,
                                           width, height,
-                                          util_format_dxt3_rgba_fetch,
+                                          decode_block_rgba_dxt3,
                                           16, FALSE);
 }
 
@@ -275,7 +383,7 @@ util_format_dxt5_rgba_unpack_rgba_float(void *restrict dst_row, unsigned dst_str
    util_format_dxtn_rgb_unpack_rgba_float(dst_row, dst_stride,
                                           src_row, src_stride,
                                           width, height,
-                                          util_format_dxt5_rgba_fetch,
+                                          decode_block_rgba_dxt5,
                                           16, FALSE);
 }
 
@@ -541,7 +649,7 @@ util_format_dxt1_srgb_unpack_rgba_8unorm(uint8_t *restrict dst_row, unsigned dst
    util_format_dxtn_rgb_unpack_rgba_8unorm(dst_row, dst_stride,
                                            src_row, src_stride,
                                            width, height,
-                                           util_format_dxt1_rgb_fetch,
+                                           decode_block_rgb_dxt1,
                                            8, TRUE);
 }
 
@@ -551,7 +659,7 @@ util_format_dxt1_srgba_unpack_rgba_8unorm(uint8_t *restrict dst_row, unsigned ds
    util_format_dxtn_rgb_unpack_rgba_8unorm(dst_row, dst_stride,
                                            src_row, src_stride,
                                            width, height,
-                                           util_format_dxt1_rgba_fetch,
+                                           decode_block_rgba_dxt1,
                                            8, TRUE);
 }
 
@@ -561,7 +669,7 @@ util_format_dxt3_srgba_unpack_rgba_8unorm(uint8_t *restrict dst_row, unsigned ds
    util_format_dxtn_rgb_unpack_rgba_8unorm(dst_row, dst_stride,
                                            src_row, src_stride,
                                            width, height,
-                                           util_format_dxt3_rgba_fetch,
+                                           decode_block_rgba_dxt3,
                                            16, TRUE);
 }
 
@@ -571,7 +679,7 @@ util_format_dxt5_srgba_unpack_rgba_8unorm(uint8_t *restrict dst_row, unsigned ds
    util_format_dxtn_rgb_unpack_rgba_8unorm(dst_row, dst_stride,
                                            src_row, src_stride,
                                            width, height,
-                                           util_format_dxt5_rgba_fetch,
+                                           decode_block_rgba_dxt5,
                                            16, TRUE);
 }
 
@@ -581,7 +689,7 @@ util_format_dxt1_srgb_unpack_rgba_float(void *restrict dst_row, unsigned dst_str
    util_format_dxtn_rgb_unpack_rgba_float(dst_row, dst_stride,
                                           src_row, src_stride,
                                           width, height,
-                                          util_format_dxt1_rgb_fetch,
+                                          decode_block_rgb_dxt1,
                                           8, TRUE);
 }
 
@@ -591,7 +699,7 @@ util_format_dxt1_srgba_unpack_rgba_float(void *restrict dst_row, unsigned dst_st
    util_format_dxtn_rgb_unpack_rgba_float(dst_row, dst_stride,
                                           src_row, src_stride,
                                           width, height,
-                                          util_format_dxt1_rgba_fetch,
+                                          decode_block_rgba_dxt1,
                                           8, TRUE);
 }
 
@@ -601,7 +709,7 @@ util_format_dxt3_srgba_unpack_rgba_float(void *restrict dst_row, unsigned dst_st
    util_format_dxtn_rgb_unpack_rgba_float(dst_row, dst_stride,
                                           src_row, src_stride,
                                           width, height,
-                                          util_format_dxt3_rgba_fetch,
+                                          decode_block_rgba_dxt3,
                                           16, TRUE);
 }
 
@@ -611,7 +719,7 @@ util_format_dxt5_srgba_unpack_rgba_float(void *restrict dst_row, unsigned dst_st
    util_format_dxtn_rgb_unpack_rgba_float(dst_row, dst_stride,
                                           src_row, src_stride,
                                           width, height,
-                                          util_format_dxt5_rgba_fetch,
+                                          decode_block_rgba_dxt5,
                                           16, TRUE);
 }
 
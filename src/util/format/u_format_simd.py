@@ -0,0 +1,679 @@
+
+'''
+/*
+ * Copyright © 2021 Google LLC
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * SIMD pack and unpack functions for the most common four channel formats.
+ *
+ * The kernels convert several pixels per iteration and hand the remainder
+ * of each row to the scalar functions generated by u_format_pack.py, so
+ * the results are bit for bit the same as the scalar ones. The variant to
+ * use is picked at runtime from util_cpu_caps, formats without a SIMD
+ * variant keep using the scalar description.
+ */
+'''
+
+
+from __future__ import division, print_function
+
+from u_format_parse import *
+import u_format_pack
+
+
+ISAS = ['sse2', 'avx2', 'neon']
+
+ISA_GUARDS = {
+    'sse2': 'UTIL_FORMAT_SSE2',
+    'avx2': 'UTIL_FORMAT_AVX2',
+    'neon': 'UTIL_FORMAT_NEON',
+}
+
+# Functions of struct util_format_unpack_description and
+# util_format_pack_description that can have SIMD variants, mapped to the
+# suffix of the scalar function generated by u_format_pack.py.
+UNPACK_FUNCS = [
+    ('unpack_rgba_8unorm', 'unpack_rgba_8unorm'),
+    ('unpack_rgba', 'unpack_rgba_float'),
+]
+
+PACK_FUNCS = [
+    ('pack_rgba_8unorm', 'pack_rgba_8unorm'),
+    ('pack_rgba_float', 'pack_rgba_float'),
+]
+
+# The SIMD functions available for each class of format.
+KERNELS = {
+    'unorm8': {
+        'sse2': ['unpack_rgba_8unorm', 'unpack_rgba_float',
+                 'pack_rgba_8unorm', 'pack_rgba_float'],
+        'avx2': ['unpack_rgba_8unorm', 'unpack_rgba_float',
+                 'pack_rgba_8unorm'],
+        'neon': ['unpack_rgba_8unorm', 'unpack_rgba_float',
+                 'pack_rgba_8unorm', 'pack_rgba_float'],
+    },
+    'unorm16': {
+        'sse2': ['unpack_rgba_float'],
+        'avx2': ['unpack_rgba_float'],
+        'neon': ['unpack_rgba_float'],
+    },
+    'float16': {
+        'sse2': [],
+        'avx2': ['unpack_rgba_float'],
+        'neon': ['unpack_rgba_float'],
+    },
+}
+
+
+def simd_class(format):
+    '''Return the class of SIMD kernels that apply to the format, if any.
+
+    Only plain RGB formats with four channels of the same size are handled,
+    so that a pixel is a vector of 4 bytes or 4 halfwords and swizzling is a
+    permutation within it.'''
+
+    if format.layout != PLAIN or format.colorspace != RGB:
+        return None
+    if format.block_width != 1 or format.block_height != 1:
+        return None
+
+    channels = format.le_channels
+    size = channels[0].size
+    if size not in (8, 16) or any(c.size != size for c in channels):
+        return None
+
+    channels = [c for c in channels if c.type != VOID]
+    if all(c.type == UNSIGNED and c.norm and not c.pure for c in channels):
+        return 'unorm%u' % size
+    if size == 16 and all(c.type == FLOAT for c in channels):
+        return 'float16'
+    return None
+
+
+def simd_funcs(format, isa):
+    '''Return the SIMD functions generated for the format and ISA.'''
+
+    cls = simd_class(format)
+    if cls is None:
+        return []
+    return KERNELS[cls][isa]
+
+
+def unpack_selects(format):
+    '''For each destination component, the source channel or a constant.'''
+
+    selects = []
+    for swizzle in format.le_swizzles:
+        if swizzle < 4:
+            selects.append(swizzle)
+        elif swizzle == SWIZZLE_1:
+            selects.append('one')
+        else:
+            selects.append('zero')
+    return selects
+
+
+def pack_selects(format):
+    '''For each destination channel, the source component or zero.'''
+
+    selects = []
+    for i, src in enumerate(u_format_pack.inv_swizzles(format.le_swizzles)):
+        if src is None or format.le_channels[i].type == VOID:
+            selects.append('zero')
+        else:
+            selects.append(src)
+    return selects
+
+
+def has_constants(selects):
+    return any(not isinstance(s, int) for s in selects)
+
+
+def constant_value(select, one):
+    if select == 'one':
+        return one
+    return '0'
+
+
+def proto_args(func):
+    if func == 'unpack_rgba_float':
+        return ('void *restrict dst_row, unsigned dst_stride, '
+                'const uint8_t *restrict src_row, unsigned src_stride, '
+                'unsigned width, unsigned height')
+    if func == 'unpack_rgba_8unorm':
+        return ('uint8_t *restrict dst_row, unsigned dst_stride, '
+                'const uint8_t *restrict src_row, unsigned src_stride, '
+                'unsigned width, unsigned height')
+    if func == 'pack_rgba_float':
+        return ('uint8_t *restrict dst_row, unsigned dst_stride, '
+                'const float *restrict src_row, unsigned src_stride, '
+                'unsigned width, unsigned height')
+    if func == 'pack_rgba_8unorm':
+        return ('uint8_t *restrict dst_row, unsigned dst_stride, '
+                'const uint8_t *restrict src_row, unsigned src_stride, '
+                'unsigned width, unsigned height')
+    assert False
+
+
+def simd_name(format, func, isa):
+    return 'util_format_%s_%s_%s' % (format.short_name(), func, isa)
+
+
+def generate_row_function(format, func, isa, pixels, decls, kernel):
+    '''Generate the loop over rows and pixels around a kernel converting
+    the given number of pixels, with the scalar function doing the tail.'''
+
+    name = format.short_name()
+    src_bytes = format.block_size() // 8
+
+    if isa == 'avx2':
+        print('static UTIL_FORMAT_TARGET_AVX2 void')
+    else:
+        print('static void')
+    print('%s(%s)' % (simd_name(format, func, isa), proto_args(func)))
+    print('{')
+    for decl in decls:
+        print('   %s' % decl)
+    print('   for (unsigned y = 0; y < height; y++) {')
+    if func.startswith('unpack'):
+        dst_type = 'float' if func == 'unpack_rgba_float' else 'uint8_t'
+        print('      %s *dst = (%s *)dst_row;' % (dst_type, dst_type))
+        print('      const uint8_t *src = src_row;')
+        dst_step = '%u' % (pixels * 4)
+        src_step = '%u' % (pixels * src_bytes)
+    else:
+        src_type = 'float' if func == 'pack_rgba_float' else 'uint8_t'
+        print('      uint8_t *dst = dst_row;')
+        print('      const %s *src = src_row;' % src_type)
+        dst_step = '%u' % (pixels * src_bytes)
+        src_step = '%u' % (pixels * 4)
+    print('      unsigned x = 0;')
+    print('      for (; x + %u <= width; x += %u) {' % (pixels, pixels))
+    kernel()
+    print('         src += %s;' % src_step)
+    print('         dst += %s;' % dst_step)
+    print('      }')
+    print('      if (x < width)')
+    print('         util_format_%s_%s(dst, 0, src, 0, width - x, 1);' % (name, func))
+    if func == 'unpack_rgba_float':
+        print('      src_row += src_stride;')
+        print('      dst_row = (uint8_t *)dst_row + dst_stride;')
+    elif func == 'pack_rgba_float':
+        print('      dst_row += dst_stride;')
+        print('      src_row = (const float *)((const uint8_t *)src_row + src_stride);')
+    else:
+        print('      src_row += src_stride;')
+        print('      dst_row += dst_stride;')
+    print('   }')
+    print('}')
+    print()
+
+
+def sse2_swizzle_ps(var, selects):
+    '''Return an expression swizzling the 4 floats of var.'''
+
+    if selects == [0, 1, 2, 3]:
+        return var
+
+    index = [s if isinstance(s, int) else 0 for s in selects]
+    if index == [0, 1, 2, 3]:
+        expr = var
+    else:
+        expr = '_mm_shuffle_ps(%s, %s, _MM_SHUFFLE(%u, %u, %u, %u))' % (
+            var, var, index[3], index[2], index[1], index[0])
+
+    if has_constants(selects):
+        keep = ', '.join('0' if not isinstance(s, int) else '-1' for s in selects)
+        expr = '_mm_and_ps(%s, _mm_castsi128_ps(_mm_setr_epi32(%s)))' % (expr, keep)
+        if 'one' in selects:
+            consts = ', '.join(constant_value(s, '1.0f') for s in selects)
+            expr = '_mm_or_ps(%s, _mm_setr_ps(%s))' % (expr, consts)
+    return expr
+
+
+def avx2_swizzle_ps(var, selects):
+    '''Return an expression swizzling the 4 floats of each lane of var.'''
+
+    if selects == [0, 1, 2, 3]:
+        return var
+
+    index = [s if isinstance(s, int) else 0 for s in selects]
+    if index == [0, 1, 2, 3]:
+        expr = var
+    else:
+        expr = '_mm256_permute_ps(%s, _MM_SHUFFLE(%u, %u, %u, %u))' % (
+            var, index[3], index[2], index[1], index[0])
+
+    if has_constants(selects):
+        keep = ', '.join('0' if not isinstance(s, int) else '-1' for s in selects)
+        expr = '_mm256_and_ps(%s, _mm256_castsi256_ps(_mm256_setr_epi32(%s, %s)))' % (expr, keep, keep)
+        if 'one' in selects:
+            consts = ', '.join(constant_value(s, '1.0f') for s in selects)
+            expr = '_mm256_or_ps(%s, _mm256_setr_ps(%s, %s))' % (expr, consts, consts)
+    return expr
+
+
+def sse2_permute_bytes(var, selects):
+    '''Return an expression permuting the 4 bytes of each dword of var.'''
+
+    if selects == [0, 1, 2, 3]:
+        return var
+
+    # Group the destination bytes by how far they move, each group is one
+    # shift and one mask.
+    shifts = {}
+    for i, s in enumerate(selects):
+        if isinstance(s, int):
+            shifts.setdefault(8 * (i - s), []).append(i)
+
+    terms = []
+    for shift in sorted(shifts):
+        mask = 0
+        for i in shifts[shift]:
+            mask |= 0xff << (8 * i)
+        if shift > 0:
+            term = '_mm_slli_epi32(%s, %u)' % (var, shift)
+            unshifted = (0xffffffff << shift) & 0xffffffff
+        elif shift < 0:
+            term = '_mm_srli_epi32(%s, %u)' % (var, -shift)
+            unshifted = 0xffffffff >> -shift
+        else:
+            term = var
+            unshifted = 0xffffffff
+        if mask != unshifted:
+            term = '_mm_and_si128(%s, _mm_set1_epi32((int)0x%08x))' % (term, mask)
+        terms.append(term)
+
+    ones = 0
+    for i, s in enumerate(selects):
+        if s == 'one':
+            ones |= 0xff << (8 * i)
+    if ones:
+        terms.append('_mm_set1_epi32((int)0x%08x)' % ones)
+
+    if not terms:
+        return '_mm_setzero_si128()'
+
+    expr = terms[0]
+    for term in terms[1:]:
+        expr = '_mm_or_si128(%s, %s)' % (expr, term)
+    return expr
+
+
+def avx2_permute_bytes(var, selects):
+    '''Return an expression permuting the 4 bytes of each dword of var.'''
+
+    if selects == [0, 1, 2, 3]:
+        return var
+
+    control = []
+    for pixel in range(4):
+        for s in selects:
+            control.append('%d' % (4 * pixel + s) if isinstance(s, int) else '-1')
+    control = ', '.join(control + control)
+    expr = '_mm256_shuffle_epi8(%s, _mm256_setr_epi8(%s))' % (var, control)
+
+    ones = 0
+    for i, s in enumerate(selects):
+        if s == 'one':
+            ones |= 0xff << (8 * i)
+    if ones:
+        expr = '_mm256_or_si256(%s, _mm256_set1_epi32((int)0x%08x))' % (expr, ones)
+    return expr
+
+
+def neon_select(var, select, zero, one):
+    if select == 'one':
+        return one
+    if select == 'zero':
+        return zero
+    return '%s.val[%u]' % (var, select)
+
+
+def generate_sse2(format, cls, func):
+    sel_unpack = unpack_selects(format)
+    sel_pack = pack_selects(format)
+
+    if cls == 'unorm8' and func in ('unpack_rgba_8unorm', 'pack_rgba_8unorm'):
+        selects = sel_unpack if func.startswith('unpack') else sel_pack
+        def kernel():
+            print('         __m128i p = _mm_loadu_si128((const __m128i *)src);')
+            print('         _mm_storeu_si128((__m128i *)dst, %s);' % sse2_permute_bytes('p', selects))
+        generate_row_function(format, func, 'sse2', 4, [], kernel)
+
+    elif cls == 'unorm8' and func == 'unpack_rgba_float':
+        decls = [
+            'const __m128i zero = _mm_setzero_si128();',
+            'const __m128 scale = _mm_set1_ps(1.0f / 255.0f);',
+        ]
+        def kernel():
+            print('         __m128i p = _mm_loadu_si128((const __m128i *)src);')
+            print('         __m128i lo = _mm_unpacklo_epi8(p, zero);')
+            print('         __m128i hi = _mm_unpackhi_epi8(p, zero);')
+            print('         __m128i c[4] = {')
+            print('            _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),')
+            print('            _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero),')
+            print('         };')
+            print('         for (unsigned i = 0; i < 4; i++) {')
+            print('            __m128 v = _mm_mul_ps(_mm_cvtepi32_ps(c[i]), scale);')
+            print('            _mm_storeu_ps(dst + 4 * i, %s);' % sse2_swizzle_ps('v', sel_unpack))
+            print('         }')
+        generate_row_function(format, func, 'sse2', 4, decls, kernel)
+
+    elif cls == 'unorm8' and func == 'pack_rgba_float':
+        # Same rounding as float_to_ubyte(): once clamped, the low byte of
+        # f * 255/256 + 32768 is f * 255 rounded to nearest even. max_ps
+        # returns its second operand if the first one is NaN, which maps
+        # NaN to 0 like float_to_ubyte() does.
+        decls = [
+            'const __m128 zero = _mm_setzero_ps();',
+            'const __m128 one = _mm_set1_ps(1.0f);',
+            'const __m128 scale = _mm_set1_ps(255.0f / 256.0f);',
+            'const __m128 bias = _mm_set1_ps(32768.0f);',
+            'const __m128i byte_mask = _mm_set1_epi32(0xff);',
+        ]
+        def kernel():
+            print('         __m128i c[4];')
+            print('         for (unsigned i = 0; i < 4; i++) {')
+            print('            __m128 v = _mm_loadu_ps(src + 4 * i);')
+            print('            v = %s;' % sse2_swizzle_ps('v', sel_pack))
+            print('            v = _mm_min_ps(_mm_max_ps(v, zero), one);')
+            print('            v = _mm_add_ps(_mm_mul_ps(v, scale), bias);')
+            print('            c[i] = _mm_and_si128(_mm_castps_si128(v), byte_mask);')
+            print('         }')
+            print('         __m128i p = _mm_packus_epi16(_mm_packs_epi32(c[0], c[1]),')
+            print('                                      _mm_packs_epi32(c[2], c[3]));')
+            print('         _mm_storeu_si128((__m128i *)dst, p);')
+        generate_row_function(format, func, 'sse2', 4, decls, kernel)
+
+    elif cls == 'unorm16' and func == 'unpack_rgba_float':
+        decls = [
+            'const __m128i zero = _mm_setzero_si128();',
+            'const __m128 scale = _mm_set1_ps(1.0f / 65535.0f);',
+        ]
+        def kernel():
+            print('         for (unsigned i = 0; i < 2; i++) {')
+            print('            __m128i p = _mm_loadu_si128((const __m128i *)src + i);')
+            print('            __m128 v0 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(p, zero)), scale);')
+            print('            __m128 v1 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(p, zero)), scale);')
+            print('            _mm_storeu_ps(dst + 8 * i, %s);' % sse2_swizzle_ps('v0', sel_unpack))
+            print('            _mm_storeu_ps(dst + 8 * i + 4, %s);' % sse2_swizzle_ps('v1', sel_unpack))
+            print('         }')
+        generate_row_function(format, func, 'sse2', 4, decls, kernel)
+
+    else:
+        assert False
+
+
+def generate_avx2(format, cls, func):
+    sel_unpack = unpack_selects(format)
+    sel_pack = pack_selects(format)
+
+    if cls == 'unorm8' and func in ('unpack_rgba_8unorm', 'pack_rgba_8unorm'):
+        selects = sel_unpack if func.startswith('unpack') else sel_pack
+        def kernel():
+            print('         __m256i p = _mm256_loadu_si256((const __m256i *)src);')
+            print('         _mm256_storeu_si256((__m256i *)dst, %s);' % avx2_permute_bytes('p', selects))
+        generate_row_function(format, func, 'avx2', 8, [], kernel)
+
+    elif cls in ('unorm8', 'unorm16', 'float16') and func == 'unpack_rgba_float':
+        # Two pixels per 256-bit vector, one per lane.
+        if cls == 'unorm8':
+            decls = ['const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);']
+            load = '_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(src + 8 * i)))), scale)'
+        elif cls == 'unorm16':
+            decls = ['const __m256 scale = _mm256_set1_ps(1.0f / 65535.0f);']
+            load = '_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(src + 16 * i)))), scale)'
+        else:
+            decls = []
+            load = '_mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + 16 * i)))'
+        def kernel():
+            print('         for (unsigned i = 0; i < 2; i++) {')
+            print('            __m256 v = %s;' % load)
+            print('            _mm256_storeu_ps(dst + 8 * i, %s);' % avx2_swizzle_ps('v', sel_unpack))
+            print('         }')
+        generate_row_function(format, func, 'avx2', 4, decls, kernel)
+
+    else:
+        assert False
+
+
+def generate_neon(format, cls, func):
+    sel_unpack = unpack_selects(format)
+    sel_pack = pack_selects(format)
+
+    if cls == 'unorm8' and func in ('unpack_rgba_8unorm', 'pack_rgba_8unorm'):
+        selects = sel_unpack if func.startswith('unpack') else sel_pack
+        decls = []
+        if 'zero' in selects:
+            decls.append('const uint8x8_t zero = vdup_n_u8(0);')
+        if 'one' in selects:
+            decls.append('const uint8x8_t one = vdup_n_u8(0xff);')
+        def kernel():
+            print('         uint8x8x4_t p = vld4_u8(src);')
+            print('         uint8x8x4_t d;')
+            for i, s in enumerate(selects):
+                print('         d.val[%u] = %s;' % (i, neon_select('p', s, 'zero', 'one')))
+            print('         vst4_u8(dst, d);')
+        generate_row_function(format, func, 'neon', 8, decls, kernel)
+
+    elif cls == 'unorm8' and func == 'unpack_rgba_float':
+        decls = ['const float32x4_t scale = vdupq_n_f32(1.0f / 255.0f);']
+        if 'zero' in sel_unpack:
+            decls.append('const float32x4_t zero = vdupq_n_f32(0.0f);')
+        if 'one' in sel_unpack:
+            decls.append('const float32x4_t one = vdupq_n_f32(1.0f);')
+        def kernel():
+            print('         uint8x8x4_t p = vld4_u8(src);')
+            print('         float32x4x4_t lo, hi;')
+            for c in sorted(set(s for s in sel_unpack if isinstance(s, int))):
+                print('         uint16x8_t c%u = vmovl_u8(p.val[%u]);' % (c, c))
+                print('         lo.val[%u] = vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(c%u))), scale);' % (c, c))
+                print('         hi.val[%u] = vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(c%u))), scale);' % (c, c))
+            generate_neon_store_f32(sel_unpack, ['lo', 'hi'])
+        generate_row_function(format, func, 'neon', 8, decls, kernel)
+
+    elif cls == 'unorm8' and func == 'pack_rgba_float':
+        # See the SSE2 variant for the rounding. vmaxnmq_f32 returns the
+        # number if the other operand is NaN.
+        decls = [
+            'const float32x4_t zero = vdupq_n_f32(0.0f);',
+            'const float32x4_t one = vdupq_n_f32(1.0f);',
+            'const float32x4_t scale = vdupq_n_f32(255.0f / 256.0f);',
+            'const float32x4_t bias = vdupq_n_f32(32768.0f);',
+        ]
+        if 'zero' in sel_pack:
+            decls.append('const uint8x8_t zero8 = vdup_n_u8(0);')
+        def kernel():
+            print('         float32x4x4_t s[2] = { vld4q_f32(src), vld4q_f32(src + 16) };')
+            print('         uint8x8x4_t d;')
+            for i, s in enumerate(sel_pack):
+                if not isinstance(s, int):
+                    print('         d.val[%u] = zero8;' % i)
+                    continue
+                print('         {')
+                print('            uint16x4_t h[2];')
+                print('            for (unsigned j = 0; j < 2; j++) {')
+                print('               float32x4_t v = vminq_f32(vmaxnmq_f32(s[j].val[%u], zero), one);' % s)
+                print('               v = vaddq_f32(vmulq_f32(v, scale), bias);')
+                print('               h[j] = vmovn_u32(vreinterpretq_u32_f32(v));')
+                print('            }')
+                print('            d.val[%u] = vmovn_u16(vcombine_u16(h[0], h[1]));' % i)
+                print('         }')
+            print('         vst4_u8(dst, d);')
+        generate_row_function(format, func, 'neon', 8, decls, kernel)
+
+    elif cls in ('unorm16', 'float16') and func == 'unpack_rgba_float':
+        decls = []
+        if cls == 'unorm16':
+            decls.append('const float32x4_t scale = vdupq_n_f32(1.0f / 65535.0f);')
+        if 'zero' in sel_unpack:
+            decls.append('const float32x4_t zero = vdupq_n_f32(0.0f);')
+        if 'one' in sel_unpack:
+            decls.append('const float32x4_t one = vdupq_n_f32(1.0f);')
+        def kernel():
+            print('         uint16x4x4_t p = vld4_u16((const uint16_t *)src);')
+            print('         float32x4x4_t v;')
+            for c in sorted(set(s for s in sel_unpack if isinstance(s, int))):
+                if cls == 'unorm16':
+                    print('         v.val[%u] = vmulq_f32(vcvtq_f32_u32(vmovl_u16(p.val[%u])), scale);' % (c, c))
+                else:
+                    print('         v.val[%u] = vcvt_f32_f16(vreinterpret_f16_u16(p.val[%u]));' % (c, c))
+            generate_neon_store_f32(sel_unpack, ['v'])
+        generate_row_function(format, func, 'neon', 4, decls, kernel)
+
+    else:
+        assert False
+
+
+def generate_neon_store_f32(selects, vars):
+    '''Store 4 pixels of floats from each of the deinterleaved vars.'''
+
+    for n, var in enumerate(vars):
+        if selects == [0, 1, 2, 3]:
+            print('         vst4q_f32(dst + %u, %s);' % (16 * n, var))
+            continue
+        print('         {')
+        print('            float32x4x4_t d;')
+        for i, s in enumerate(selects):
+            print('            d.val[%u] = %s;' % (i, neon_select(var, s, 'zero', 'one')))
+        print('            vst4q_f32(dst + %u, d);' % (16 * n))
+        print('         }')
+
+
+def generate_description_getter(formats, isa, kind):
+    '''Generate the descriptions made of the SIMD functions of an ISA, with
+    the scalar (or for AVX2, SSE2) functions filling the gaps, and a getter
+    returning NULL for the formats without any.'''
+
+    funcs = UNPACK_FUNCS if kind == 'unpack' else PACK_FUNCS
+
+    cases = []
+    for format in formats:
+        own = simd_funcs(format, isa)
+        if not any(f in own for field, f in funcs):
+            continue
+
+        sn = format.short_name()
+        print('static const struct util_format_%s_description' % kind)
+        print('util_format_%s_%s_description_%s = {' % (sn, kind, isa))
+        for field, f in funcs:
+            if f in own:
+                print('   .%s = &%s,' % (field, simd_name(format, f, isa)))
+            elif isa == 'avx2' and f in simd_funcs(format, 'sse2'):
+                print('   .%s = &%s,' % (field, simd_name(format, f, 'sse2')))
+            else:
+                print('   .%s = &util_format_%s_%s,' % (field, sn, f))
+        print('};')
+        print()
+        cases.append(format)
+
+    print('static const struct util_format_%s_description *' % kind)
+    print('util_format_%s_description_%s(enum pipe_format format)' % (kind, isa))
+    print('{')
+    print('   switch (format) {')
+    for format in cases:
+        print('   case %s:' % format.name)
+        print('      return &util_format_%s_%s_description_%s;' % (format.short_name(), kind, isa))
+    print('   default:')
+    print('      return NULL;')
+    print('   }')
+    print('}')
+    print()
+
+
+def generate_simd_getter(kind):
+    '''Generate util_format_{un,}pack_description_simd(), which returns the
+    SIMD description of the best ISA of this CPU, or NULL.'''
+
+    print('static const struct util_format_%s_description *' % kind)
+    print('util_format_%s_description_simd(enum pipe_format format)' % kind)
+    print('{')
+    print('   util_cpu_detect();')
+    print('   const struct util_cpu_caps_t *caps = util_get_cpu_caps();')
+    print()
+    print('#if defined(UTIL_FORMAT_AVX2)')
+    print('   if (caps->has_avx2 && caps->has_f16c)')
+    print('      return util_format_%s_description_avx2(format);' % kind)
+    print('#endif')
+    print('#if defined(UTIL_FORMAT_SSE2)')
+    print('   if (caps->has_sse2)')
+    print('      return util_format_%s_description_sse2(format);' % kind)
+    print('#endif')
+    print('#if defined(UTIL_FORMAT_NEON)')
+    print('   if (caps->has_neon)')
+    print('      return util_format_%s_description_neon(format);' % kind)
+    print('#endif')
+    print('   return NULL;')
+    print('}')
+    print()
+
+
+def generate(formats):
+    '''Generate the SIMD functions, descriptions and getters. This goes
+    after the scalar functions the kernels fall back to.'''
+
+    print('#if UTIL_ARCH_LITTLE_ENDIAN && (defined(__SSE2__) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || (defined(_M_X64) && !defined(_M_ARM64EC)))')
+    print('#include <immintrin.h>')
+    print('#define UTIL_FORMAT_SSE2 1')
+    print('#if defined(__GNUC__)')
+    print('#define UTIL_FORMAT_AVX2 1')
+    print('#define UTIL_FORMAT_TARGET_AVX2 __attribute__((target("avx2,f16c")))')
+    print('#elif defined(_MSC_VER)')
+    print('#define UTIL_FORMAT_AVX2 1')
+    print('#define UTIL_FORMAT_TARGET_AVX2')
+    print('#endif')
+    print('#elif UTIL_ARCH_LITTLE_ENDIAN && defined(__aarch64__) && defined(__ARM_NEON)')
+    print('#include <arm_neon.h>')
+    print('#define UTIL_FORMAT_NEON 1')
+    print('#endif')
+    print()
+    print('#if defined(UTIL_FORMAT_SSE2) || defined(UTIL_FORMAT_NEON)')
+    print('#define UTIL_FORMAT_SIMD 1')
+    print('#endif')
+    print()
+
+    generators = {
+        'sse2': generate_sse2,
+        'avx2': generate_avx2,
+        'neon': generate_neon,
+    }
+
+    for isa in ISAS:
+        print('#if defined(%s)' % ISA_GUARDS[isa])
+        print()
+        for format in formats:
+            for func in simd_funcs(format, isa):
+                generators[isa](format, simd_class(format), func)
+        generate_description_getter(formats, isa, 'unpack')
+        generate_description_getter(formats, isa, 'pack')
+        print('#endif /* %s */' % ISA_GUARDS[isa])
+        print()
+
+    print('#if defined(UTIL_FORMAT_SIMD)')
+    print()
+    generate_simd_getter('unpack')
+    generate_simd_getter('pack')
+    print('#endif /* UTIL_FORMAT_SIMD */')
+    print()
@@ -34,6 +34,7 @@ import sys, os
 
 from u_format_parse import *
 import u_format_pack
+import u_format_simd
 
 
 def layout_map(layout):
@@ -130,12 +131,14 @@ def write_format_table(formats):
     print('#include "u_format_rgtc.h"')
     print('#include "u_format_latc.h"')
     print('#include "u_format_etc.h"')
+    print('#include "util/u_cpu_detect.h"')
     print()
 
     write_format_table_header(sys.stdout2)
     
     u_format_pack.generate(formats)
-    
+    u_format_simd.generate(formats)
+
     def do_channel_array(channels, swizzles):
         print("   {")
         for i in range(4):
@@ -172,6 +175,14 @@ def write_format_table(formats):
         print("   if (format >= ARRAY_SIZE(util_format_%sdescriptions))" % (type))
         print("      return NULL;")
         print()
+        if type in ("pack_", "unpack_"):
+            print("#if defined(UTIL_FORMAT_SIMD)")
+            print("   const struct util_format_%sdescription *simd =" % type)
+            print("      util_format_%sdescription_simd(format);" % type)
+            print("   if (simd)")
+            print("      return simd;")
+            print("#endif")
+            print()
         print("   return &util_format_%sdescriptions[format];" % (type))
         print("}")
         print()
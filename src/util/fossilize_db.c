@@ -33,17 +33,22 @@
 #ifdef FOZ_DB_UTIL
 
 #include <assert.h>
+#include <fcntl.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "bitscan.h"
 #include "crc32.h"
 #include "hash_table.h"
 #include "mesa-sha1.h"
 #include "ralloc.h"
+#include "u_atomic.h"
 
 #define FOZ_REF_MAGIC_SIZE 16
 
@@ -104,128 +109,437 @@ create_foz_db_filenames(char *cache_path, char *name, char **filename,
    return true;
 }
 
+/* Every record in the index db is the same size: the hex hash of the cache
+ * key, a payload header and a 64bit offset into the foz db.
+ */
+#define FOZ_INDEX_ENTRY_SIZE \
+   (FOSSILIZE_BLOB_HASH_LENGTH + sizeof(struct foz_payload_header) + \
+    sizeof(uint64_t))
+
+/* The writable db keeps an open addressing hash table of its entries next to
+ * the index db. It is mapped shared and searched in place, so opening the db
+ * doesn't need to parse the index db, and entries written by other processes
+ * show up as soon as they are inserted. The index db stays the reference
+ * copy: the table records how much of it is covered, anything past that is
+ * inserted when the db is opened or written, and a table that is missing,
+ * invalid or full is rebuilt from the index db.
+ *
+ * The table is only modified while holding the index db lock. Readers don't
+ * lock, a slot's offset is stored before its hash is published, and every
+ * hit is checked against the full key stored in the foz db.
+ */
+#define FOZ_HASH_MAGIC 0x48534f46 /* "FOSH" */
+#define FOZ_HASH_VERSION 1
+#define FOZ_HASH_MIN_SLOTS 4096
+
+struct foz_hash_header {
+   uint32_t magic;
+   uint32_t version;
+   uint32_t num_slots;     /* Always a power of two */
+   uint32_t num_entries;
+   uint64_t idx_size;      /* Bytes of the index db covered by the table */
+};
+
+struct foz_hash_slot {
+   uint64_t hash;          /* Truncated cache key, 0 for an empty slot */
+   uint64_t offset;        /* Offset of the entry header in the foz db */
+};
+
+static inline struct foz_hash_slot *
+foz_hash_slots(struct foz_hash_header *table)
+{
+   return (struct foz_hash_slot *)(table + 1);
+}
+
+/* 0 marks empty slots, so it can't be used as a hash. */
+static inline uint64_t
+foz_hash_slot_hash(uint64_t hash)
+{
+   return hash ? hash : 1;
+}
+
 static bool
-load_foz_dbs(struct foz_db *foz_db, FILE *db_idx, uint8_t file_idx,
-             bool read_only)
+foz_hash_find(struct foz_hash_header *table, uint64_t hash, uint64_t *offset)
 {
-   int err = flock(fileno(foz_db->file[file_idx]), LOCK_EX | LOCK_NB);
-   if (err == -1)
-      goto fail;
+   struct foz_hash_slot *slots = foz_hash_slots(table);
+   uint32_t mask = table->num_slots - 1;
+
+   hash = foz_hash_slot_hash(hash);
+   for (uint32_t i = 0; i < table->num_slots; i++) {
+      struct foz_hash_slot *slot = &slots[(hash + i) & mask];
+      uint64_t slot_hash = p_atomic_read(&slot->hash);
+      if (slot_hash == 0)
+         return false;
+
+      if (slot_hash == hash) {
+         *offset = slot->offset;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/* Returns false if the table is too full to take another entry. */
+static bool
+foz_hash_insert(struct foz_hash_header *table, uint64_t hash, uint64_t offset)
+{
+   struct foz_hash_slot *slots = foz_hash_slots(table);
+   uint32_t mask = table->num_slots - 1;
+
+   if ((uint64_t)(table->num_entries + 1) * 4 > (uint64_t)table->num_slots * 3)
+      return false;
+
+   hash = foz_hash_slot_hash(hash);
+   for (uint32_t i = 0; i < table->num_slots; i++) {
+      struct foz_hash_slot *slot = &slots[(hash + i) & mask];
+      if (slot->hash == hash)
+         return true;
+
+      if (slot->hash == 0) {
+         slot->offset = offset;
+         p_atomic_set(&slot->hash, hash);
+         table->num_entries++;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/* Parse the index db record at \record, returns false if it is corrupt. */
+static bool
+parse_index_record(const uint8_t *record, char *hash_str,
+                   struct foz_payload_header *header, uint64_t *offset)
+{
+   memcpy(header, record + FOSSILIZE_BLOB_HASH_LENGTH, sizeof(*header));
+   if (header->payload_size != sizeof(uint64_t))
+      return false;
+
+   memcpy(hash_str, record, FOSSILIZE_BLOB_HASH_LENGTH);
+   hash_str[FOSSILIZE_BLOB_HASH_LENGTH] = '\0';
+
+   /* read cache item offset from the index record */
+   memcpy(offset, record + FOSSILIZE_BLOB_HASH_LENGTH + sizeof(*header),
+          sizeof(*offset));
+   return true;
+}
+
+/* Truncate the entry's hash string to a 64bit hash for use with a 64bit hash
+ * table for looking up file offsets.
+ */
+static uint64_t
+truncate_hash_str_to_64bits(const char *hash_str)
+{
+   char str[17];
+   memcpy(str, hash_str, 16);
+   str[16] = '\0';
+   return strtoull(str, NULL, 16);
+}
+
+/* Insert the index db records in [begin, end) into the hash table. Returns
+ * the offset of the first record that wasn't inserted, either because it is
+ * corrupt or because the table is full.
+ */
+static size_t
+foz_hash_insert_records(struct foz_hash_header *table, const uint8_t *idx_map,
+                        size_t begin, size_t end)
+{
+   size_t offset;
+   for (offset = begin; offset + FOZ_INDEX_ENTRY_SIZE <= end;
+        offset += FOZ_INDEX_ENTRY_SIZE) {
+      char hash_str[FOSSILIZE_BLOB_HASH_LENGTH + 1];
+      struct foz_payload_header header;
+      uint64_t cache_offset;
+      if (!parse_index_record(idx_map + offset, hash_str, &header,
+                              &cache_offset))
+         break;
+
+      if (!foz_hash_insert(table, truncate_hash_str_to_64bits(hash_str),
+                           cache_offset))
+         break;
+   }
 
-   err = flock(fileno(db_idx), LOCK_EX | LOCK_NB);
-   if (err == -1)
+   return offset;
+}
+
+static struct foz_hash_header *
+map_hash_table(int fd, size_t *size)
+{
+   struct stat sb;
+   if (fstat(fd, &sb) == -1 || sb.st_size < sizeof(struct foz_hash_header))
+      return NULL;
+
+   struct foz_hash_header *table =
+      mmap(NULL, sb.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (table == MAP_FAILED)
+      return NULL;
+
+   if (table->magic != FOZ_HASH_MAGIC ||
+       table->version != FOZ_HASH_VERSION ||
+       table->num_slots == 0 ||
+       !util_is_power_of_two_nonzero(table->num_slots) ||
+       sb.st_size != sizeof(struct foz_hash_header) +
+                     (uint64_t)table->num_slots * sizeof(struct foz_hash_slot)) {
+      munmap(table, sb.st_size);
+      return NULL;
+   }
+
+   *size = sb.st_size;
+   return table;
+}
+
+static void
+unmap_hash_table(struct foz_db *foz_db)
+{
+   if (foz_db->hash_table)
+      munmap(foz_db->hash_table, foz_db->hash_table_size);
+   foz_db->hash_table = NULL;
+}
+
+/* Make the mapped hash table the one currently in the cache directory, in
+ * case another process replaced it.
+ */
+static void
+remap_hash_table(struct foz_db *foz_db)
+{
+   struct stat sb;
+   if (foz_db->hash_table && stat(foz_db->hash_filename, &sb) == 0 &&
+       sb.st_ino == foz_db->hash_table_ino)
+      return;
+
+   unmap_hash_table(foz_db);
+
+   int fd = open(foz_db->hash_filename, O_RDWR | O_CLOEXEC);
+   if (fd == -1)
+      return;
+
+   foz_db->hash_table = map_hash_table(fd, &foz_db->hash_table_size);
+   if (foz_db->hash_table && fstat(fd, &sb) == 0)
+      foz_db->hash_table_ino = sb.st_ino;
+
+   close(fd);
+}
+
+/* Build a new hash table covering the whole index db and atomically replace
+ * the current one with it.
+ */
+static bool
+rebuild_hash_table(struct foz_db *foz_db, const uint8_t *idx_map,
+                   size_t idx_len)
+{
+   size_t num_records = (idx_len - FOZ_REF_MAGIC_SIZE) / FOZ_INDEX_ENTRY_SIZE;
+   uint32_t num_slots = FOZ_HASH_MIN_SLOTS;
+   while (num_slots < num_records * 2)
+      num_slots *= 2;
+
+   char *tmp_filename = ralloc_asprintf(NULL, "%s.tmp",
+                                        foz_db->hash_filename);
+   if (!tmp_filename)
+      return false;
+
+   int fd = open(tmp_filename, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+   if (fd == -1)
       goto fail;
 
-   /* Scan through the archive and get the list of cache entries. */
-   fseek(db_idx, 0, SEEK_END);
-   size_t len = ftell(db_idx);
-   rewind(db_idx);
+   size_t size = sizeof(struct foz_hash_header) +
+                 (size_t)num_slots * sizeof(struct foz_hash_slot);
+   if (ftruncate(fd, size) == -1)
+      goto fail_close;
+
+   struct foz_hash_header *table =
+      mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   if (table == MAP_FAILED)
+      goto fail_close;
+
+   table->magic = FOZ_HASH_MAGIC;
+   table->version = FOZ_HASH_VERSION;
+   table->num_slots = num_slots;
+   table->num_entries = 0;
+   table->idx_size = foz_hash_insert_records(table, idx_map,
+                                             FOZ_REF_MAGIC_SIZE, idx_len);
+
+   struct stat sb;
+   if (fstat(fd, &sb) == -1 ||
+       rename(tmp_filename, foz_db->hash_filename) == -1) {
+      munmap(table, size);
+      goto fail_close;
+   }
 
-   if (!read_only)
-       fseek(foz_db->file[file_idx], 0, SEEK_END);
+   unmap_hash_table(foz_db);
+   foz_db->hash_table = table;
+   foz_db->hash_table_size = size;
+   foz_db->hash_table_ino = sb.st_ino;
 
-   if (len != 0) {
-      uint8_t magic[FOZ_REF_MAGIC_SIZE];
-      if (fread(magic, 1, FOZ_REF_MAGIC_SIZE, db_idx) != FOZ_REF_MAGIC_SIZE)
-         goto fail;
+   close(fd);
+   ralloc_free(tmp_filename);
+   return true;
 
-      if (memcmp(magic, stream_reference_magic_and_version,
-                 FOZ_REF_MAGIC_SIZE - 1))
-         goto fail;
+fail_close:
+   close(fd);
+   unlink(tmp_filename);
+fail:
+   ralloc_free(tmp_filename);
+   return false;
+}
 
-      int version = magic[FOZ_REF_MAGIC_SIZE - 1];
-      if (version > FOSSILIZE_FORMAT_VERSION ||
-          version < FOSSILIZE_FORMAT_MIN_COMPAT_VERSION)
-         goto fail;
+/* Bring the hash table up to date with the first \idx_len bytes of the index
+ * db. Must be called with the index db locked exclusively.
+ */
+static bool
+sync_hash_table(struct foz_db *foz_db, size_t idx_len)
+{
+   remap_hash_table(foz_db);
 
-      size_t offset = FOZ_REF_MAGIC_SIZE;
-      size_t begin_append_offset = len;
-
-      while (offset < len) {
-         begin_append_offset = offset;
-
-         char bytes_to_read[FOSSILIZE_BLOB_HASH_LENGTH + sizeof(struct foz_payload_header)];
-         struct foz_payload_header *header;
-
-         /* Corrupt entry. Our process might have been killed before we
-          * could write all data.
-          */
-         if (offset + sizeof(bytes_to_read) > len)
-            break;
-
-         /* NAME + HEADER in one read */
-         if (fread(bytes_to_read, 1, sizeof(bytes_to_read), db_idx) !=
-             sizeof(bytes_to_read))
-            goto fail;
-
-         offset += sizeof(bytes_to_read);
-         header = (struct foz_payload_header*)&bytes_to_read[FOSSILIZE_BLOB_HASH_LENGTH];
-
-         /* Corrupt entry. Our process might have been killed before we
-          * could write all data.
-          */
-         if (offset + header->payload_size > len ||
-             header->payload_size != sizeof(uint64_t))
-            break;
-
-         char hash_str[FOSSILIZE_BLOB_HASH_LENGTH + 1] = {0};
-         memcpy(hash_str, bytes_to_read, FOSSILIZE_BLOB_HASH_LENGTH);
-
-         struct foz_db_entry *entry = ralloc(foz_db->mem_ctx,
-                                             struct foz_db_entry);
-         entry->header = *header;
-         entry->file_idx = file_idx;
-         _mesa_sha1_hex_to_sha1(entry->key, hash_str);
-
-         /* read cache item offset from index file */
-         uint64_t cache_offset;
-         if (fread(&cache_offset, 1, sizeof(cache_offset), db_idx) !=
-             sizeof(cache_offset))
-            return false;
-
-         entry->offset = cache_offset;
-
-         /* Truncate the entry's hash string to a 64bit hash for use with a
-          * 64bit hash table for looking up file offsets.
-          */
-         hash_str[16] = '\0';
-         uint64_t key = strtoull(hash_str, NULL, 16);
-         _mesa_hash_table_u64_insert(foz_db->index_db, key, entry);
-
-         offset += header->payload_size;
-      }
+   struct foz_hash_header *table = foz_db->hash_table;
+   if (table && table->idx_size == idx_len)
+      return true;
+
+   int fd = fileno(foz_db->db_idx);
+   const uint8_t *idx_map = mmap(NULL, idx_len, PROT_READ, MAP_SHARED, fd, 0);
+   if (idx_map == MAP_FAILED)
+      return false;
+
+   bool ok = true;
+   if (table && table->idx_size >= FOZ_REF_MAGIC_SIZE &&
+       table->idx_size < idx_len) {
+      /* Records appended without updating the table. */
+      table->idx_size = foz_hash_insert_records(table, idx_map,
+                                                table->idx_size, idx_len);
+
+      /* Rebuild if the table is full, not if a record is corrupt. */
+      if (idx_len - table->idx_size >= FOZ_INDEX_ENTRY_SIZE &&
+          (uint64_t)(table->num_entries + 1) * 4 > (uint64_t)table->num_slots * 3)
+         ok = rebuild_hash_table(foz_db, idx_map, idx_len);
+   } else if (!table || table->idx_size != idx_len) {
+      ok = rebuild_hash_table(foz_db, idx_map, idx_len);
+   }
+
+   munmap((void *)idx_map, idx_len);
+   return ok;
+}
+
+static bool
+write_magic_if_empty(FILE *file)
+{
+   if (fseek(file, 0, SEEK_END) < 0)
+      return false;
+
+   if (ftell(file) != 0)
+      return true;
+
+   return fwrite(stream_reference_magic_and_version, 1,
+                 sizeof(stream_reference_magic_and_version), file) ==
+          sizeof(stream_reference_magic_and_version);
+}
+
+/* Load the entries of a read only db into the in memory index hash table. */
+static void
+load_index_records(struct foz_db *foz_db, const uint8_t *idx_map,
+                   size_t len, uint8_t file_idx)
+{
+   /* A trailing partial record means a process was killed before it could
+    * write all data, it is skipped here and dropped by the next writer.
+    */
+   for (size_t offset = FOZ_REF_MAGIC_SIZE;
+        offset + FOZ_INDEX_ENTRY_SIZE <= len;
+        offset += FOZ_INDEX_ENTRY_SIZE) {
+      char hash_str[FOSSILIZE_BLOB_HASH_LENGTH + 1];
+      struct foz_payload_header header;
+      uint64_t cache_offset;
+      if (!parse_index_record(idx_map + offset, hash_str, &header,
+                              &cache_offset))
+         break;
+
+      struct foz_db_entry *entry = ralloc(foz_db->mem_ctx,
+                                          struct foz_db_entry);
+      entry->header = header;
+      entry->file_idx = file_idx;
+      entry->offset = cache_offset;
+      _mesa_sha1_hex_to_sha1(entry->key, hash_str);
+
+      _mesa_hash_table_u64_insert(foz_db->index_db,
+                                  truncate_hash_str_to_64bits(hash_str),
+                                  entry);
+   }
+}
+
+/* Open a db. The writable db is locked exclusively while its hash table is
+ * brought up to date, so a new db gets its magic written exactly once. Read
+ * only dbs only take a shared lock while their index is loaded into memory.
+ * The locks are dropped again before returning so any number of processes
+ * can share the same cache.
+ */
+static bool
+load_foz_dbs(struct foz_db *foz_db, FILE *db_idx, uint8_t file_idx,
+             bool read_only)
+{
+   int fd = fileno(db_idx);
+   if (flock(fd, read_only ? LOCK_SH : LOCK_EX) == -1)
+      goto fail;
+
+   struct stat sb;
+   if (fstat(fd, &sb) == -1)
+      goto fail_unlock;
+
+   size_t len = sb.st_size;
+   if (len == 0) {
+      if (read_only)
+         goto fail_unlock;
 
-      if (!read_only && offset != len) {
-         if (fseek(db_idx, begin_append_offset, SEEK_SET) < 0)
-            goto fail;
-      }
-   } else {
       /* Appending to a fresh file. Make sure we have the magic. */
-      if (fwrite(stream_reference_magic_and_version, 1,
-                 sizeof(stream_reference_magic_and_version), foz_db->file[file_idx]) !=
-          sizeof(stream_reference_magic_and_version))
-         goto fail;
+      if (!write_magic_if_empty(foz_db->file[file_idx]) ||
+          !write_magic_if_empty(db_idx))
+         goto fail_unlock;
 
-      if (fwrite(stream_reference_magic_and_version, 1,
-                 sizeof(stream_reference_magic_and_version), db_idx) !=
-          sizeof(stream_reference_magic_and_version))
-         goto fail;
+      fflush(foz_db->file[file_idx]);
+      fflush(db_idx);
+      len = FOZ_REF_MAGIC_SIZE;
    }
 
+   if (len < FOZ_REF_MAGIC_SIZE)
+      goto fail_unlock;
+
+   const uint8_t *idx_map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+   if (idx_map == MAP_FAILED)
+      goto fail_unlock;
+
+   const uint8_t *magic = idx_map;
+   int version = magic[FOZ_REF_MAGIC_SIZE - 1];
+   bool valid = !memcmp(magic, stream_reference_magic_and_version,
+                        FOZ_REF_MAGIC_SIZE - 1) &&
+                version <= FOSSILIZE_FORMAT_VERSION &&
+                version >= FOSSILIZE_FORMAT_MIN_COMPAT_VERSION;
+
+   if (valid && read_only)
+      load_index_records(foz_db, idx_map, len, file_idx);
+
+   munmap((void *)idx_map, len);
+
+   if (!valid)
+      goto fail_unlock;
+
+   if (!read_only && !sync_hash_table(foz_db, len))
+      goto fail_unlock;
+
+   flock(fd, LOCK_UN);
    foz_db->alive = true;
    return true;
 
+fail_unlock:
+   flock(fd, LOCK_UN);
 fail:
    foz_destroy(foz_db);
    return false;
 }
 
-/* Here we open mesa cache foz dbs files. If the files exist we load the index
- * db into a hash table. The index db contains the offsets needed to later
+/* Here we open mesa cache foz dbs files. If the files exist we map the hash
+ * table of the default db, and load the index db of any read only db into an
+ * in memory hash table. The index db contains the offsets needed to later
  * read cache entries from the foz db containing the actual cache entries.
  */
 bool
-foz_prepare(struct foz_db *foz_db, char *cache_path)
+foz_prepare(struct foz_db *foz_db, char *cache_path, uint64_t max_size)
 {
    char *filename = NULL;
    char *idx_filename = NULL;
@@ -245,8 +559,12 @@ foz_prepare(struct foz_db *foz_db, char *cache_path)
       return false;
 
    simple_mtx_init(&foz_db->mtx, mtx_plain);
+   foz_db->max_size = max_size;
    foz_db->mem_ctx = ralloc_context(NULL);
    foz_db->index_db = _mesa_hash_table_u64_create(NULL);
+   foz_db->hash_filename = ralloc_asprintf(foz_db->mem_ctx,
+                                           "%s/foz_cache_idx.hash",
+                                           cache_path);
 
    if (!load_foz_dbs(foz_db, foz_db->db_idx, 0, false))
       return false;
@@ -303,6 +621,8 @@ foz_destroy(struct foz_db *foz_db)
          fclose(foz_db->file[i]);
    }
 
+   unmap_hash_table(foz_db);
+
    if (foz_db->mem_ctx) {
       _mesa_hash_table_u64_destroy(foz_db->index_db, NULL);
       ralloc_free(foz_db->mem_ctx);
@@ -310,8 +630,9 @@ foz_destroy(struct foz_db *foz_db)
    }
 }
 
-/* Here we lookup a cache entry in the index hash table. If an entry is found
- * we use the retrieved offset to read the cache entry from disk.
+/* Here we lookup a cache entry in the default db's hash table, and then in
+ * the index hash table of the read only dbs. If an entry is found we use the
+ * retrieved offset to read the cache entry from disk.
  */
 void *
 foz_read_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
@@ -326,39 +647,53 @@ foz_read_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
 
    simple_mtx_lock(&foz_db->mtx);
 
-   struct foz_db_entry *entry =
-      _mesa_hash_table_u64_search(foz_db->index_db, hash);
-   if (!entry) {
-      simple_mtx_unlock(&foz_db->mtx);
-      return NULL;
+   uint8_t file_idx = 0;
+   uint64_t entry_offset;
+   if (!foz_db->hash_table ||
+       !foz_hash_find(foz_db->hash_table, hash, &entry_offset)) {
+      struct foz_db_entry *entry =
+         _mesa_hash_table_u64_search(foz_db->index_db, hash);
+      if (!entry) {
+         simple_mtx_unlock(&foz_db->mtx);
+         return NULL;
+      }
+
+      file_idx = entry->file_idx;
+      entry_offset = entry->offset;
    }
 
-   uint8_t file_idx = entry->file_idx;
    off_t offset = ftell(foz_db->file[file_idx]);
-   if (fseek(foz_db->file[file_idx], entry->offset, SEEK_SET) < 0)
+   if (entry_offset < FOSSILIZE_BLOB_HASH_LENGTH ||
+       fseek(foz_db->file[file_idx],
+             entry_offset - FOSSILIZE_BLOB_HASH_LENGTH, SEEK_SET) < 0)
       goto fail;
 
+   /* Check for collision using full 160bit hash for increased assurance
+    * against potential collisions. The hash is stored right before the
+    * entry header.
+    */
+   char hash_str[FOSSILIZE_BLOB_HASH_LENGTH + 1];
+   char entry_hash_str[FOSSILIZE_BLOB_HASH_LENGTH];
+   _mesa_sha1_format(hash_str, cache_key_160bit);
+   if (fread(entry_hash_str, 1, FOSSILIZE_BLOB_HASH_LENGTH,
+             foz_db->file[file_idx]) != FOSSILIZE_BLOB_HASH_LENGTH ||
+       memcmp(hash_str, entry_hash_str, FOSSILIZE_BLOB_HASH_LENGTH))
+      goto fail;
+
+   struct foz_payload_header header;
    uint32_t header_size = sizeof(struct foz_payload_header);
-   if (fread(&entry->header, 1, header_size, foz_db->file[file_idx]) !=
+   if (fread(&header, 1, header_size, foz_db->file[file_idx]) !=
        header_size)
       goto fail;
 
-   /* Check for collision using full 160bit hash for increased assurance
-    * against potential collisions.
-    */
-   for (int i = 0; i < 20; i++) {
-      if (cache_key_160bit[i] != entry->key[i])
-         goto fail;
-   }
-
-   uint32_t data_sz = entry->header.payload_size;
+   uint32_t data_sz = header.payload_size;
    data = malloc(data_sz);
    if (fread(data, 1, data_sz, foz_db->file[file_idx]) != data_sz)
       goto fail;
 
    /* verify checksum */
-   if (entry->header.crc != 0) {
-      if (util_hash_crc32(data, data_sz) != entry->header.crc)
+   if (header.crc != 0) {
+      if (util_hash_crc32(data, data_sz) != header.crc)
          goto fail;
    }
 
@@ -382,26 +717,63 @@ fail:
    return NULL;
 }
 
-/* Here we write the cache entry to disk and store its offset in the index db.
+/* Here we write the cache entry to disk, store its offset in the index db and
+ * insert it into the hash table. Other processes may be appending to the same
+ * dbs, so the index db is locked for the duration of the write.
  */
 bool
 foz_write_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
                 const void *blob, size_t blob_size)
 {
    uint64_t hash = truncate_hash_to_64bits(cache_key_160bit);
+   uint64_t entry_offset;
 
    if (!foz_db->alive)
       return false;
 
    simple_mtx_lock(&foz_db->mtx);
 
-   struct foz_db_entry *entry =
-      _mesa_hash_table_u64_search(foz_db->index_db, hash);
-   if (entry) {
-      simple_mtx_unlock(&foz_db->mtx);
-      return NULL;
+   int idx_fd = fileno(foz_db->db_idx);
+   if (flock(idx_fd, LOCK_EX) == -1)
+      goto fail;
+
+   /* Drop a partial index record left behind by a process that was killed
+    * mid-write, otherwise every record we append would be misaligned.
+    */
+   if (fseek(foz_db->db_idx, 0, SEEK_END) < 0)
+      goto fail_unlock;
+
+   long idx_len = ftell(foz_db->db_idx);
+   if (idx_len < FOZ_REF_MAGIC_SIZE)
+      goto fail_unlock;
+
+   long idx_tail = (idx_len - FOZ_REF_MAGIC_SIZE) % FOZ_INDEX_ENTRY_SIZE;
+   if (idx_tail != 0) {
+      idx_len -= idx_tail;
+      if (ftruncate(idx_fd, idx_len) == -1)
+         goto fail_unlock;
    }
 
+   /* Pick up whatever other processes wrote, they may have written this
+    * entry too.
+    */
+   if (!sync_hash_table(foz_db, idx_len))
+      goto fail_unlock;
+
+   if (foz_hash_find(foz_db->hash_table, hash, &entry_offset))
+      goto fail_unlock;
+
+   if (fseek(foz_db->file[0], 0, SEEK_END) < 0)
+      goto fail_unlock;
+
+   /* The single file cache has no eviction, stop adding entries once the
+    * foz db has reached the maximum cache size.
+    */
+   uint64_t db_size = ftell(foz_db->file[0]);
+   if (db_size + FOSSILIZE_BLOB_HASH_LENGTH +
+       sizeof(struct foz_payload_header) + blob_size > foz_db->max_size)
+      goto fail_unlock;
+
    /* Prepare db entry header and blob ready for writing */
    struct foz_payload_header header;
    header.uncompressed_size = blob_size;
@@ -414,17 +786,17 @@ foz_write_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
    _mesa_sha1_format(hash_str, cache_key_160bit);
    if (fwrite(hash_str, 1, FOSSILIZE_BLOB_HASH_LENGTH, foz_db->file[0]) !=
        FOSSILIZE_BLOB_HASH_LENGTH)
-      goto fail;
+      goto fail_unlock;
 
    off_t offset = ftell(foz_db->file[0]);
 
    /* Write db entry header */
    if (fwrite(&header, 1, sizeof(header), foz_db->file[0]) != sizeof(header))
-      goto fail;
+      goto fail_unlock;
 
    /* Now write the db entry blob */
    if (fwrite(blob, 1, blob_size, foz_db->file[0]) != blob_size)
-      goto fail;
+      goto fail_unlock;
 
    /* Flush everything to file to reduce chance of cache corruption */
    fflush(foz_db->file[0]);
@@ -432,7 +804,7 @@ foz_write_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
    /* Write hash header to index db */
    if (fwrite(hash_str, 1, FOSSILIZE_BLOB_HASH_LENGTH, foz_db->db_idx) !=
        FOSSILIZE_BLOB_HASH_LENGTH)
-      goto fail;
+      goto fail_unlock;
 
    header.uncompressed_size = sizeof(uint64_t);
    header.format = FOSSILIZE_COMPRESSION_NONE;
@@ -441,26 +813,35 @@ foz_write_entry(struct foz_db *foz_db, const uint8_t *cache_key_160bit,
 
    if (fwrite(&header, 1, sizeof(header), foz_db->db_idx) !=
        sizeof(header))
-      goto fail;
+      goto fail_unlock;
 
    if (fwrite(&offset, 1, sizeof(uint64_t), foz_db->db_idx) !=
        sizeof(uint64_t))
-      goto fail;
+      goto fail_unlock;
 
    /* Flush everything to file to reduce chance of cache corruption */
    fflush(foz_db->db_idx);
 
-   entry = ralloc(foz_db->mem_ctx, struct foz_db_entry);
-   entry->header = header;
-   entry->offset = offset;
-   entry->file_idx = 0;
-   _mesa_sha1_hex_to_sha1(entry->key, hash_str);
-   _mesa_hash_table_u64_insert(foz_db->index_db, hash, entry);
+   idx_len += FOZ_INDEX_ENTRY_SIZE;
+   if (foz_db->hash_table->idx_size + FOZ_INDEX_ENTRY_SIZE == idx_len &&
+       foz_hash_insert(foz_db->hash_table, hash, offset))
+      foz_db->hash_table->idx_size = idx_len;
+   else
+      sync_hash_table(foz_db, idx_len);
+
+   flock(idx_fd, LOCK_UN);
 
    simple_mtx_unlock(&foz_db->mtx);
 
    return true;
 
+fail_unlock:
+   /* Push out anything left in the stdio buffers while we still hold the
+    * lock, a partial index record is dropped by the next writer.
+    */
+   fflush(foz_db->file[0]);
+   fflush(foz_db->db_idx);
+   flock(idx_fd, LOCK_UN);
 fail:
    simple_mtx_unlock(&foz_db->mtx);
    return false;
@@ -468,7 +849,7 @@ fail:
 #else
 
 bool
-foz_prepare(struct foz_db *foz_db, char *filename)
+foz_prepare(struct foz_db *foz_db, char *filename, uint64_t max_size)
 {
    fprintf(stderr, "Warning: Mesa single file cache selected but Mesa wasn't "
            "built with single cache file support. Shader cache will be disabled"
@@ -65,6 +65,8 @@ struct foz_payload_header {
    uint32_t uncompressed_size;
 };
 
+struct foz_hash_header;
+
 struct foz_db_entry {
    uint8_t file_idx;
    uint8_t key[20];
@@ -78,11 +80,16 @@ struct foz_db {
    simple_mtx_t mtx;                 /* Mutex for file/hash table read/writes */
    void *mem_ctx;
    struct hash_table_u64 *index_db;  /* Hash table of all foz db entries */
+   uint64_t max_size;                /* Max size of the writable foz db */
+   char *hash_filename;              /* Hash table of the default db */
+   struct foz_hash_header *hash_table;
+   size_t hash_table_size;
+   uint64_t hash_table_ino;
    bool alive;
 };
 
 bool
-foz_prepare(struct foz_db *foz_db, char *cache_path);
+foz_prepare(struct foz_db *foz_db, char *cache_path, uint64_t max_size);
 
 void
 foz_destroy(struct foz_db *foz_db);
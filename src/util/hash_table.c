@@ -54,25 +54,6 @@
 #define XXH_INLINE_ALL
 #include "xxhash.h"
 
-/**
- * Magic number that gets stored outside of the struct hash_table.
- *
- * The hash table needs a particular pointer to be the marker for a key that
- * was deleted from the table, along with NULL for the "never allocated in the
- * table" marker.  Legacy GL allows any GLuint to be used as a GL object name,
- * and we use a 1:1 mapping from GLuints to key pointers, so we need to be
- * able to track a GLuint that happens to match the deleted key outside of
- * struct hash_table.  We tell the hash table to use "1" as the deleted key
- * value, so that we test the deleted-key-in-the-table path as best we can.
- */
-#define DELETED_KEY_VALUE 1
-
-static inline void *
-uint_key(unsigned id)
-{
-   return (void *)(uintptr_t) id;
-}
-
 static const uint32_t deleted_key_value;
 
 /**
@@ -699,51 +680,26 @@ _mesa_hash_table_reserve(struct hash_table *ht, unsigned size)
 /**
  * Hash table wrapper which supports 64-bit keys.
  *
- * TODO: unify all hash table implementations.
+ * This is backed by a flat_hash_map, which stores the keys inline and so
+ * needs neither a reserved deleted key nor allocated keys on 32-bit
+ * platforms.
  */
 
-struct hash_key_u64 {
-   uint64_t value;
-};
-
-static uint32_t
-key_u64_hash(const void *key)
-{
-   return _mesa_hash_data(key, sizeof(struct hash_key_u64));
-}
-
-static bool
-key_u64_equals(const void *a, const void *b)
-{
-   const struct hash_key_u64 *aa = a;
-   const struct hash_key_u64 *bb = b;
-
-   return aa->value == bb->value;
-}
-
-#define FREED_KEY_VALUE 0
-
 struct hash_table_u64 *
 _mesa_hash_table_u64_create(void *mem_ctx)
 {
-   STATIC_ASSERT(FREED_KEY_VALUE != DELETED_KEY_VALUE);
    struct hash_table_u64 *ht;
 
    ht = CALLOC_STRUCT(hash_table_u64);
    if (!ht)
       return NULL;
 
-   if (sizeof(void *) == 8) {
-      ht->table = _mesa_hash_table_create(mem_ctx, _mesa_hash_pointer,
-                                          _mesa_key_pointer_equal);
-   } else {
-      ht->table = _mesa_hash_table_create(mem_ctx, key_u64_hash,
-                                          key_u64_equals);
+   ht->map = flat_hash_map_create(mem_ctx);
+   if (!ht->map) {
+      free(ht);
+      return NULL;
    }
 
-   if (ht->table)
-      _mesa_hash_table_set_deleted_key(ht->table, uint_key(DELETED_KEY_VALUE));
-
    return ht;
 }
 
@@ -754,47 +710,19 @@ _mesa_hash_table_u64_clear(struct hash_table_u64 *ht,
    if (!ht)
       return;
 
-   if (ht->deleted_key_data) {
-      if (delete_function) {
-         struct hash_table *table = ht->table;
-         struct hash_entry entry;
-
+   if (delete_function) {
+      flat_hash_map_foreach(ht->map, map_entry) {
          /* Create a fake entry for the delete function. */
-         if (sizeof(void *) == 8) {
-            entry.hash = table->key_hash_function(table->deleted_key);
-         } else {
-            struct hash_key_u64 _key = { .value = (uintptr_t)table->deleted_key };
-            entry.hash = table->key_hash_function(&_key);
-         }
-         entry.key = table->deleted_key;
-         entry.data = ht->deleted_key_data;
-
-         delete_function(&entry);
-      }
-      ht->deleted_key_data = NULL;
-   }
-
-   if (ht->freed_key_data) {
-      if (delete_function) {
-         struct hash_table *table = ht->table;
          struct hash_entry entry;
-
-         /* Create a fake entry for the delete function. */
-         if (sizeof(void *) == 8) {
-            entry.hash = table->key_hash_function(uint_key(FREED_KEY_VALUE));
-         } else {
-            struct hash_key_u64 _key = { .value = (uintptr_t)FREED_KEY_VALUE };
-            entry.hash = table->key_hash_function(&_key);
-         }
-         entry.key = uint_key(FREED_KEY_VALUE);
-         entry.data = ht->freed_key_data;
+         entry.hash = (uint32_t)flat_hash_map_hash(map_entry->key);
+         entry.key = (const void *)(uintptr_t)map_entry->key;
+         entry.data = map_entry->data;
 
          delete_function(&entry);
       }
-      ht->freed_key_data = NULL;
    }
 
-   _mesa_hash_table_clear(ht->table, delete_function);
+   flat_hash_map_clear(ht->map);
 }
 
 void
@@ -805,7 +733,7 @@ _mesa_hash_table_u64_destroy(struct hash_table_u64 *ht,
       return;
 
    _mesa_hash_table_u64_clear(ht, delete_function);
-   _mesa_hash_table_destroy(ht->table, delete_function);
+   flat_hash_map_destroy(ht->map);
    free(ht);
 }
 
@@ -813,83 +741,17 @@ void
 _mesa_hash_table_u64_insert(struct hash_table_u64 *ht, uint64_t key,
                             void *data)
 {
-   if (key == FREED_KEY_VALUE) {
-      ht->freed_key_data = data;
-      return;
-   }
-
-   if (key == DELETED_KEY_VALUE) {
-      ht->deleted_key_data = data;
-      return;
-   }
-
-   if (sizeof(void *) == 8) {
-      _mesa_hash_table_insert(ht->table, (void *)(uintptr_t)key, data);
-   } else {
-      struct hash_key_u64 *_key = CALLOC_STRUCT(hash_key_u64);
-
-      if (!_key)
-         return;
-      _key->value = key;
-
-      _mesa_hash_table_insert(ht->table, _key, data);
-   }
-}
-
-static struct hash_entry *
-hash_table_u64_search(struct hash_table_u64 *ht, uint64_t key)
-{
-   if (sizeof(void *) == 8) {
-      return _mesa_hash_table_search(ht->table, (void *)(uintptr_t)key);
-   } else {
-      struct hash_key_u64 _key = { .value = key };
-      return _mesa_hash_table_search(ht->table, &_key);
-   }
+   flat_hash_map_insert(ht->map, key, data);
 }
 
 void *
 _mesa_hash_table_u64_search(struct hash_table_u64 *ht, uint64_t key)
 {
-   struct hash_entry *entry;
-
-   if (key == FREED_KEY_VALUE)
-      return ht->freed_key_data;
-
-   if (key == DELETED_KEY_VALUE)
-      return ht->deleted_key_data;
-
-   entry = hash_table_u64_search(ht, key);
-   if (!entry)
-      return NULL;
-
-   return entry->data;
+   return flat_hash_map_search(ht->map, key);
 }
 
 void
 _mesa_hash_table_u64_remove(struct hash_table_u64 *ht, uint64_t key)
 {
-   struct hash_entry *entry;
-
-   if (key == FREED_KEY_VALUE) {
-      ht->freed_key_data = NULL;
-      return;
-   }
-
-   if (key == DELETED_KEY_VALUE) {
-      ht->deleted_key_data = NULL;
-      return;
-   }
-
-   entry = hash_table_u64_search(ht, key);
-   if (!entry)
-      return;
-
-   if (sizeof(void *) == 8) {
-      _mesa_hash_table_remove(ht->table, entry);
-   } else {
-      struct hash_key *_key = (struct hash_key *)entry->key;
-
-      _mesa_hash_table_remove(ht->table, entry);
-      free(_key);
-   }
+   flat_hash_map_remove(ht->map, key);
 }
@@ -32,6 +32,7 @@
 #include <inttypes.h>
 #include <stdbool.h>
 #include "c99_compat.h"
+#include "flat_hash_map.h"
 #include "macros.h"
 
 #ifdef __cplusplus
@@ -152,9 +153,7 @@ hash_table_call_foreach(struct hash_table *ht,
  * Hash table wrapper which supports 64-bit keys.
  */
 struct hash_table_u64 {
-   struct hash_table *table;
-   void *freed_key_data;
-   void *deleted_key_data;
+   struct flat_hash_map *map;
 };
 
 struct hash_table_u64 *
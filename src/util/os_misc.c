@@ -29,6 +29,7 @@
 #include "os_misc.h"
 #include "os_file.h"
 #include "macros.h"
+#include "debug.h"
 
 #include <stdarg.h>
 
@@ -59,6 +60,7 @@
 #  include <cutils/properties.h>
 #elif DETECT_OS_LINUX || DETECT_OS_CYGWIN || DETECT_OS_SOLARIS || DETECT_OS_HURD
 #  include <unistd.h>
+#  include <sys/mman.h>
 #elif DETECT_OS_OPENBSD || DETECT_OS_FREEBSD
 #  include <sys/resource.h>
 #  include <sys/sysctl.h>
@@ -360,3 +362,81 @@ os_get_page_size(uint64_t *size)
    return false;
 #endif
 }
+
+
+#if DETECT_OS_LINUX && defined(MADV_HUGEPAGE)
+
+#define OS_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+static bool
+os_huge_pages_enabled(void)
+{
+   static int enabled = -1;
+
+   if (enabled < 0)
+      enabled = env_var_as_boolean("MESA_HUGEPAGES", false);
+
+   return enabled;
+}
+
+#endif
+
+
+/**
+ * Allocate zeroed memory for a large, long-lived and randomly accessed
+ * buffer.  If MESA_HUGEPAGES is set, the memory comes from an anonymous
+ * mapping aligned to and advised for transparent huge pages, to cut down
+ * on TLB misses.  Otherwise this is a plain calloc().
+ *
+ * \return the allocation, which must be released with os_free_huge()
+ *         passing the same size, or NULL on failure
+ */
+void *
+os_malloc_huge(size_t size)
+{
+#if DETECT_OS_LINUX && defined(MADV_HUGEPAGE)
+   if (os_huge_pages_enabled()) {
+      size_t map_size = ALIGN_POT(size, OS_HUGE_PAGE_SIZE);
+
+      /* Over-allocate by one huge page so that the start can be aligned,
+       * then give back the unused head and tail.
+       */
+      uint8_t *map = mmap(NULL, map_size + OS_HUGE_PAGE_SIZE,
+                          PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (map == MAP_FAILED)
+         return NULL;
+
+      uint8_t *ptr = (uint8_t *)ALIGN_POT((uintptr_t)map, OS_HUGE_PAGE_SIZE);
+      if (ptr != map)
+         munmap(map, ptr - map);
+      if (ptr + map_size != map + map_size + OS_HUGE_PAGE_SIZE)
+         munmap(ptr + map_size, map + OS_HUGE_PAGE_SIZE - ptr);
+
+      madvise(ptr, map_size, MADV_HUGEPAGE);
+      return ptr;
+   }
+#endif
+
+   return calloc(1, size);
+}
+
+
+/**
+ * Free memory returned by os_malloc_huge().
+ */
+void
+os_free_huge(void *ptr, size_t size)
+{
+   if (!ptr)
+      return;
+
+#if DETECT_OS_LINUX && defined(MADV_HUGEPAGE)
+   if (os_huge_pages_enabled()) {
+      munmap(ptr, ALIGN_POT(size, OS_HUGE_PAGE_SIZE));
+      return;
+   }
+#endif
+
+   free(ptr);
+}
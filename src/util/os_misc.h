@@ -34,6 +34,7 @@
 #ifndef _OS_MISC_H_
 #define _OS_MISC_H_
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -107,6 +108,15 @@ os_get_available_system_memory(uint64_t *size);
 bool
 os_get_page_size(uint64_t *size);
 
+/*
+ * Zeroed allocation that is backed by huge pages when MESA_HUGEPAGES is set.
+ */
+void *
+os_malloc_huge(size_t size);
+
+void
+os_free_huge(void *ptr, size_t size);
+
 
 #ifdef	__cplusplus
 }
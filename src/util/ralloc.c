@@ -48,6 +48,14 @@ _CRTIMP int _vscprintf(const char *format, va_list argptr);
 #endif
 
 #define CANARY 0x5A1106
+#define CANARY_SHIFT 8
+
+/* The block is a bump context created by ralloc_bump_context. */
+#define RALLOC_FLAG_BUMP_CONTEXT (1 << 0)
+/* The block was allocated from a bump context. */
+#define RALLOC_FLAG_BUMP         (1 << 1)
+/* The bump allocation has an entry in the destructor list of its context. */
+#define RALLOC_FLAG_DESTRUCTOR   (1 << 2)
 
 /* Align the header's size so that ralloc() allocations will return with the
  * same alignment as a libc malloc would have (8 on 32-bit GLIBC, 16 on
@@ -68,13 +76,6 @@ __declspec(align(16))
 #endif
    ralloc_header
 {
-#ifndef NDEBUG
-   /* A canary value used to determine whether a pointer is ralloc'd. */
-   unsigned canary;
-#endif
-
-   struct ralloc_header *parent;
-
    /* The first child (head of a linked list) */
    struct ralloc_header *child;
 
@@ -83,10 +84,65 @@ __declspec(align(16))
    struct ralloc_header *next;
 
    void (*destructor)(void *);
+
+   /* Allocations from a bump context only store the fields from here on, so
+    * the fields above overlap the previous allocation and must not be used
+    * for them.
+    */
+   struct ralloc_header *parent;
+
+   /* Size of the allocation, only set for bump allocations. */
+   uint32_t size;
+
+   /* RALLOC_FLAG_*, and a canary value in the upper bits used to determine
+    * whether a pointer is ralloc'd.
+    */
+   uint32_t flags;
 };
 
 typedef struct ralloc_header ralloc_header;
 
+/* Size of the header of a bump allocation. */
+#define BUMP_HEADER_SIZE \
+   (sizeof(ralloc_header) - offsetof(ralloc_header, parent))
+
+/* Chunks of memory that bump allocations are carved from. The first header
+ * starts right after the chunk header, at offsetof(ralloc_header, parent),
+ * so that the full header of every allocation is still inside the chunk.
+ */
+struct ralloc_bump_chunk {
+   struct ralloc_bump_chunk *next;
+};
+
+#define BUMP_CHUNK_HEADER_SIZE offsetof(ralloc_header, parent)
+#define MIN_BUMP_CHUNK_SIZE 4096
+#define MAX_BUMP_CHUNK_SIZE (256 * 1024)
+
+struct ralloc_bump_destructor {
+   void *ptr;
+   void (*destructor)(void *);
+   struct ralloc_bump_destructor *next;
+};
+
+/* Stored in the memory of the bump context block. */
+struct ralloc_bump_context {
+   struct ralloc_bump_chunk *chunks;
+
+   /* Free space in the current chunk. */
+   char *next;
+   char *end;
+
+   /* Size of the next chunk, chunks grow up to MAX_BUMP_CHUNK_SIZE. */
+   size_t chunk_size;
+
+   struct ralloc_bump_destructor *destructors;
+};
+
+static_assert(sizeof(struct ralloc_bump_chunk) <= BUMP_CHUNK_HEADER_SIZE,
+              "the chunk header must fit before the first allocation");
+static_assert(BUMP_HEADER_SIZE % alignof(ralloc_header) == 0,
+              "bump allocations must be aligned like ralloc allocations");
+
 static void unlink_block(ralloc_header *info);
 static void unsafe_free(ralloc_header *info);
 
@@ -95,16 +151,30 @@ get_header(const void *ptr)
 {
    ralloc_header *info = (ralloc_header *) (((char *) ptr) -
 					    sizeof(ralloc_header));
-   assert(info->canary == CANARY);
+   assert(info->flags >> CANARY_SHIFT == CANARY);
    return info;
 }
 
 #define PTR_FROM_HEADER(info) (((char *) info) + sizeof(ralloc_header))
 
+static ralloc_header *
+get_bump_context(ralloc_header *info)
+{
+   while (!(info->flags & RALLOC_FLAG_BUMP_CONTEXT))
+      info = info->parent;
+   return info;
+}
+
 static void
 add_child(ralloc_header *parent, ralloc_header *info)
 {
    if (parent != NULL) {
+      /* Bump allocations have no list of children, so regular blocks moved
+       * below one are owned by its context instead.
+       */
+      if (unlikely(parent->flags & RALLOC_FLAG_BUMP))
+         parent = get_bump_context(parent);
+
       info->parent = parent;
       info->next = parent->child;
       parent->child = info;
@@ -120,8 +190,77 @@ ralloc_context(const void *ctx)
    return ralloc_size(ctx, 0);
 }
 
-void *
-ralloc_size(const void *ctx, size_t size)
+static char *
+bump_add_chunk(struct ralloc_bump_context *bump, size_t full_size)
+{
+   struct ralloc_bump_chunk *chunk;
+
+   /* Allocations bigger than a chunk get a chunk of their own, which goes
+    * behind the current one so that the rest of the current one is still
+    * used.
+    */
+   if (full_size > bump->chunk_size) {
+      chunk = malloc(BUMP_CHUNK_HEADER_SIZE + full_size);
+      if (unlikely(chunk == NULL))
+         return NULL;
+
+      if (bump->chunks) {
+         chunk->next = bump->chunks->next;
+         bump->chunks->next = chunk;
+      } else {
+         chunk->next = NULL;
+         bump->chunks = chunk;
+      }
+      return (char *)chunk + BUMP_CHUNK_HEADER_SIZE;
+   }
+
+   chunk = malloc(BUMP_CHUNK_HEADER_SIZE + bump->chunk_size);
+   if (unlikely(chunk == NULL))
+      return NULL;
+
+   chunk->next = bump->chunks;
+   bump->chunks = chunk;
+   bump->next = (char *)chunk + BUMP_CHUNK_HEADER_SIZE;
+   bump->end = bump->next + bump->chunk_size;
+   bump->chunk_size = MIN2(bump->chunk_size * 2, MAX_BUMP_CHUNK_SIZE);
+
+   char *block = bump->next;
+   bump->next += full_size;
+   return block;
+}
+
+static void *
+bump_alloc(ralloc_header *parent, size_t size)
+{
+   struct ralloc_bump_context *bump = (struct ralloc_bump_context *)
+      PTR_FROM_HEADER(get_bump_context(parent));
+   size_t full_size = BUMP_HEADER_SIZE + align64(size, alignof(ralloc_header));
+   ralloc_header *info;
+   char *block;
+
+   if (unlikely(size > UINT32_MAX))
+      return NULL;
+
+   if (likely(full_size <= (size_t)(bump->end - bump->next))) {
+      block = bump->next;
+      bump->next += full_size;
+   } else {
+      block = bump_add_chunk(bump, full_size);
+      if (unlikely(block == NULL))
+         return NULL;
+   }
+
+   info = (ralloc_header *)(block - offsetof(ralloc_header, parent));
+   info->parent = parent;
+   info->size = size;
+   info->flags = (CANARY << CANARY_SHIFT) | RALLOC_FLAG_BUMP;
+
+   return PTR_FROM_HEADER(info);
+}
+
+/* Allocate a block with malloc, even if the parent is a bump context. */
+static void *
+alloc_block(ralloc_header *parent, size_t size)
 {
    /* Some malloc allocation doesn't always align to 16 bytes even on 64 bits
     * system, from Android bionic/tests/malloc_test.cpp:
@@ -133,7 +272,6 @@ ralloc_size(const void *ctx, size_t size)
    void *block = malloc(align64(size + sizeof(ralloc_header),
                                 alignof(ralloc_header)));
    ralloc_header *info;
-   ralloc_header *parent;
 
    if (unlikely(block == NULL))
       return NULL;
@@ -148,18 +286,42 @@ ralloc_size(const void *ctx, size_t size)
    info->prev = NULL;
    info->next = NULL;
    info->destructor = NULL;
-
-   parent = ctx != NULL ? get_header(ctx) : NULL;
+   info->size = 0;
+   info->flags = CANARY << CANARY_SHIFT;
 
    add_child(parent, info);
 
-#ifndef NDEBUG
-   info->canary = CANARY;
-#endif
-
    return PTR_FROM_HEADER(info);
 }
 
+void *
+ralloc_size(const void *ctx, size_t size)
+{
+   ralloc_header *parent = ctx != NULL ? get_header(ctx) : NULL;
+
+   if (parent != NULL &&
+       (parent->flags & (RALLOC_FLAG_BUMP | RALLOC_FLAG_BUMP_CONTEXT)))
+      return bump_alloc(parent, size);
+
+   return alloc_block(parent, size);
+}
+
+void *
+ralloc_bump_context(const void *ctx)
+{
+   struct ralloc_bump_context *bump =
+      alloc_block(ctx != NULL ? get_header(ctx) : NULL,
+                  sizeof(struct ralloc_bump_context));
+
+   if (unlikely(bump == NULL))
+      return NULL;
+
+   memset(bump, 0, sizeof(*bump));
+   bump->chunk_size = MIN_BUMP_CHUNK_SIZE;
+   get_header(bump)->flags |= RALLOC_FLAG_BUMP_CONTEXT;
+   return bump;
+}
+
 void *
 rzalloc_size(const void *ctx, size_t size)
 {
@@ -171,6 +333,59 @@ rzalloc_size(const void *ctx, size_t size)
    return ptr;
 }
 
+static struct ralloc_bump_destructor **
+find_bump_destructor(ralloc_header *info)
+{
+   struct ralloc_bump_context *bump = (struct ralloc_bump_context *)
+      PTR_FROM_HEADER(get_bump_context(info));
+   struct ralloc_bump_destructor **iter;
+
+   for (iter = &bump->destructors; *iter; iter = &(*iter)->next) {
+      if ((*iter)->ptr == PTR_FROM_HEADER(info))
+         return iter;
+   }
+
+   unreachable("bump allocation without its destructor");
+}
+
+static void *
+bump_resize(ralloc_header *old, size_t size)
+{
+   struct ralloc_bump_context *bump = (struct ralloc_bump_context *)
+      PTR_FROM_HEADER(get_bump_context(old));
+   char *block = (char *)old + offsetof(ralloc_header, parent);
+   size_t old_full_size = BUMP_HEADER_SIZE +
+                          align64(old->size, alignof(ralloc_header));
+   size_t full_size = BUMP_HEADER_SIZE + align64(size, alignof(ralloc_header));
+   void *ptr;
+
+   if (unlikely(size > UINT32_MAX))
+      return NULL;
+
+   /* The last allocation can grow or shrink in place, others only shrink. */
+   if ((block + old_full_size == bump->next &&
+        full_size <= (size_t)(bump->end - block)) ||
+       size <= old->size) {
+      if (block + old_full_size == bump->next)
+         bump->next = block + full_size;
+      old->size = size;
+      return PTR_FROM_HEADER(old);
+   }
+
+   ptr = bump_alloc(old->parent, size);
+   if (unlikely(ptr == NULL))
+      return NULL;
+
+   memcpy(ptr, PTR_FROM_HEADER(old), old->size);
+
+   if (old->flags & RALLOC_FLAG_DESTRUCTOR) {
+      (*find_bump_destructor(old))->ptr = ptr;
+      get_header(ptr)->flags |= RALLOC_FLAG_DESTRUCTOR;
+   }
+
+   return ptr;
+}
+
 /* helper function - assumes ptr != NULL */
 static void *
 resize(void *ptr, size_t size)
@@ -178,6 +393,9 @@ resize(void *ptr, size_t size)
    ralloc_header *child, *old, *info;
 
    old = get_header(ptr);
+   if (old->flags & RALLOC_FLAG_BUMP)
+      return bump_resize(old, size);
+
    info = realloc(old, align64(size + sizeof(ralloc_header),
                                alignof(ralloc_header)));
 
@@ -265,6 +483,30 @@ rerzalloc_array_size(const void *ctx, void *ptr, size_t size,
    return rerzalloc_size(ctx, ptr, size * old_count, size * new_count);
 }
 
+static void
+bump_free(ralloc_header *info)
+{
+   struct ralloc_bump_context *bump = (struct ralloc_bump_context *)
+      PTR_FROM_HEADER(get_bump_context(info));
+   char *block = (char *)info + offsetof(ralloc_header, parent);
+
+   if (info->flags & RALLOC_FLAG_DESTRUCTOR) {
+      struct ralloc_bump_destructor **entry = find_bump_destructor(info);
+      void (*destructor)(void *) = (*entry)->destructor;
+
+      *entry = (*entry)->next;
+      info->flags &= ~RALLOC_FLAG_DESTRUCTOR;
+      destructor(PTR_FROM_HEADER(info));
+   }
+
+   /* The memory is only given back when the context is freed, except for the
+    * last allocation.
+    */
+   if (block + BUMP_HEADER_SIZE + align64(info->size, alignof(ralloc_header)) ==
+       bump->next)
+      bump->next = block;
+}
+
 void
 ralloc_free(void *ptr)
 {
@@ -274,6 +516,11 @@ ralloc_free(void *ptr)
       return;
 
    info = get_header(ptr);
+   if (info->flags & RALLOC_FLAG_BUMP) {
+      bump_free(info);
+      return;
+   }
+
    unlink_block(info);
    unsafe_free(info);
 }
@@ -308,6 +555,24 @@ unsafe_free(ralloc_header *info)
       unsafe_free(temp);
    }
 
+   /* Bump allocations are freed together with their chunks, after their
+    * destructors.
+    */
+   if (info->flags & RALLOC_FLAG_BUMP_CONTEXT) {
+      struct ralloc_bump_context *bump =
+         (struct ralloc_bump_context *)PTR_FROM_HEADER(info);
+
+      for (struct ralloc_bump_destructor *iter = bump->destructors; iter;
+           iter = iter->next)
+         iter->destructor(iter->ptr);
+
+      while (bump->chunks != NULL) {
+         struct ralloc_bump_chunk *chunk = bump->chunks;
+         bump->chunks = chunk->next;
+         free(chunk);
+      }
+   }
+
    /* Free the block itself.  Call the destructor first, if any. */
    if (info->destructor != NULL)
       info->destructor(PTR_FROM_HEADER(info));
@@ -326,6 +591,15 @@ ralloc_steal(const void *new_ctx, void *ptr)
    info = get_header(ptr);
    parent = new_ctx ? get_header(new_ctx) : NULL;
 
+   /* Bump allocations can't leave the context that owns their memory. */
+   if (info->flags & RALLOC_FLAG_BUMP) {
+      assert(parent != NULL &&
+             (parent->flags & (RALLOC_FLAG_BUMP | RALLOC_FLAG_BUMP_CONTEXT)) &&
+             get_bump_context(parent) == get_bump_context(info));
+      info->parent = parent;
+      return;
+   }
+
    unlink_block(info);
 
    add_child(parent, info);
@@ -342,6 +616,13 @@ ralloc_adopt(const void *new_ctx, void *old_ctx)
    old_info = get_header(old_ctx);
    new_info = get_header(new_ctx);
 
+   /* The children of bump allocations aren't tracked, so they can't be moved.
+    * Regular blocks given to a bump allocation belong to its context.
+    */
+   assert(!(old_info->flags & (RALLOC_FLAG_BUMP | RALLOC_FLAG_BUMP_CONTEXT)));
+   if (new_info->flags & RALLOC_FLAG_BUMP)
+      new_info = get_bump_context(new_info);
+
    /* If there are no children, bail. */
    if (unlikely(old_info->child == NULL))
       return;
@@ -376,7 +657,40 @@ void
 ralloc_set_destructor(const void *ptr, void(*destructor)(void *))
 {
    ralloc_header *info = get_header(ptr);
-   info->destructor = destructor;
+
+   if (!(info->flags & RALLOC_FLAG_BUMP)) {
+      info->destructor = destructor;
+      return;
+   }
+
+   /* Bump allocations have no room for a destructor in their header, so
+    * their context keeps a list of them.
+    */
+   if (info->flags & RALLOC_FLAG_DESTRUCTOR) {
+      struct ralloc_bump_destructor **entry = find_bump_destructor(info);
+
+      if (destructor) {
+         (*entry)->destructor = destructor;
+      } else {
+         *entry = (*entry)->next;
+         info->flags &= ~RALLOC_FLAG_DESTRUCTOR;
+      }
+   } else if (destructor) {
+      ralloc_header *ctx_info = get_bump_context(info);
+      struct ralloc_bump_context *bump =
+         (struct ralloc_bump_context *)PTR_FROM_HEADER(ctx_info);
+      struct ralloc_bump_destructor *entry =
+         bump_alloc(ctx_info, sizeof(struct ralloc_bump_destructor));
+
+      if (unlikely(entry == NULL))
+         return;
+
+      entry->ptr = (void *)ptr;
+      entry->destructor = destructor;
+      entry->next = bump->destructors;
+      bump->destructors = entry;
+      info->flags |= RALLOC_FLAG_DESTRUCTOR;
+   }
 }
 
 char *
@@ -91,6 +91,29 @@ extern "C" {
  */
 void *ralloc_context(const void *ctx);
 
+/**
+ * Allocate a new ralloc context for temporary allocations.
+ *
+ * Allocations that use the returned context or any of its descendants as
+ * the parent don't call malloc. They are carved out of large chunks owned by
+ * the context, with a 16 byte header instead of a full ralloc header.
+ * Freeing the context frees all of them at once, with one free per chunk.
+ *
+ * All ralloc functions can be used with these allocations, with the
+ * following differences:
+ * - ralloc_free only calls the destructor of the allocation. The memory is
+ *   given back when the context is freed, unless it was the most recent
+ *   allocation. Children of the allocation aren't freed either.
+ * - Allocations can't be moved out of their context with ralloc_steal or
+ *   ralloc_adopt.
+ * - Resizing an allocation may move it without updating the ralloc_parent
+ *   of the allocations made with it as the parent.
+ *
+ * This is meant for short-lived contexts with many small allocations that
+ * are freed together, such as the temporary data of a compiler pass.
+ */
+void *ralloc_bump_context(const void *ctx);
+
 /**
  * Allocate memory chained off of the given context.
  *
@@ -802,16 +802,33 @@ ra_simplify(struct ra_graph *g)
    g->tmp.stack_optimistic_start = stack_optimistic_start;
 }
 
-static bool
-ra_any_neighbors_conflict(struct ra_graph *g, unsigned int n, unsigned int r)
+/* Gathers the registers assigned to the already colored neighbors of n, so
+ * that testing a candidate register is a word-wise AND against its conflict
+ * set instead of a walk over the adjacency list per candidate.
+ */
+static void
+ra_compute_neighbor_regs(struct ra_graph *g, unsigned int n,
+                         BITSET_WORD *neighbor_regs)
 {
+   memset(neighbor_regs, 0, BITSET_WORDS(g->regs->count) * sizeof(BITSET_WORD));
+
    util_dynarray_foreach(&g->nodes[n].adjacency_list, unsigned int, n2p) {
       unsigned int n2 = *n2p;
 
-      if (!BITSET_TEST(g->tmp.in_stack, n2) &&
-          BITSET_TEST(g->regs->regs[r].conflicts, g->nodes[n2].reg)) {
+      if (!BITSET_TEST(g->tmp.in_stack, n2))
+         BITSET_SET(neighbor_regs, g->nodes[n2].reg);
+   }
+}
+
+static bool
+ra_any_neighbors_conflict(struct ra_graph *g, const BITSET_WORD *neighbor_regs,
+                          unsigned int r)
+{
+   const BITSET_WORD *conflicts = g->regs->regs[r].conflicts;
+
+   for (int i = 0; i < BITSET_WORDS(g->regs->count); i++) {
+      if (conflicts[i] & neighbor_regs[i])
          return true;
-      }
    }
 
    return false;
@@ -863,10 +880,8 @@ static bool
 ra_select(struct ra_graph *g)
 {
    int start_search_reg = 0;
-   BITSET_WORD *select_regs = NULL;
-
-   if (g->select_reg_callback)
-      select_regs = malloc(BITSET_WORDS(g->regs->count) * sizeof(BITSET_WORD));
+   BITSET_WORD *select_regs =
+      malloc(BITSET_WORDS(g->regs->count) * sizeof(BITSET_WORD));
 
    while (g->tmp.stack_count != 0) {
       unsigned int ri;
@@ -891,17 +906,21 @@ ra_select(struct ra_graph *g)
          /* Find the lowest-numbered reg which is not used by a member
           * of the graph adjacent to us.
           */
+         ra_compute_neighbor_regs(g, n, select_regs);
+
          for (ri = 0; ri < g->regs->count; ri++) {
             r = (start_search_reg + ri) % g->regs->count;
             if (!reg_belongs_to_class(r, c))
                continue;
 
-            if (!ra_any_neighbors_conflict(g, n, r))
+            if (!ra_any_neighbors_conflict(g, select_regs, r))
                break;
          }
 
-         if (ri >= g->regs->count)
+         if (ri >= g->regs->count) {
+            free(select_regs);
             return false;
+         }
       }
 
       g->nodes[n].reg = r;
@@ -19,6 +19,10 @@
 #include "u_endian.h"
 #include "sha1.h"
 
+#ifdef USE_SHA_NI
+#include "util/u_cpu_detect.h"
+#endif
+
 #define rol(value, bits) (((value) << (bits)) | ((value) >> (32 - (bits))))
 
 /*
@@ -101,6 +105,25 @@ SHA1Transform(uint32_t state[5], const uint8_t buffer[SHA1_BLOCK_LENGTH])
 }
 
 
+/*
+ * Hash consecutive 512-bit blocks, with the CPU's SHA instructions if it
+ * has them.
+ */
+static void
+SHA1TransformBlocks(uint32_t state[5], const uint8_t *data, size_t blocks)
+{
+#ifdef USE_SHA_NI
+	util_cpu_detect();
+	if (util_get_cpu_caps()->has_sha) {
+		SHA1TransformBlocks_shani(state, data, blocks);
+		return;
+	}
+#endif
+	for (; blocks; blocks--, data += SHA1_BLOCK_LENGTH)
+		SHA1Transform(state, data);
+}
+
+
 /*
  * SHA1Init - Initialize new context
  */
@@ -130,9 +153,9 @@ SHA1Update(SHA1_CTX *context, const uint8_t *data, size_t len)
 	context->count += (len << 3);
 	if ((j + len) > 63) {
 		(void)memcpy(&context->buffer[j], data, (i = 64-j));
-		SHA1Transform(context->state, context->buffer);
-		for ( ; i + 63 < len; i += 64)
-			SHA1Transform(context->state, (uint8_t *)&data[i]);
+		SHA1TransformBlocks(context->state, context->buffer, 1);
+		SHA1TransformBlocks(context->state, &data[i], (len - i) / 64);
+		i += (len - i) & ~(size_t)63;
 		j = 0;
 	} else {
 		i = 0;
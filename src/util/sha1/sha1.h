@@ -32,6 +32,10 @@ void SHA1Transform(uint32_t [5], const uint8_t [SHA1_BLOCK_LENGTH]);
 void SHA1Update(SHA1_CTX *, const uint8_t *, size_t);
 void SHA1Final(uint8_t [SHA1_DIGEST_LENGTH], SHA1_CTX *);
 
+#ifdef USE_SHA_NI
+void SHA1TransformBlocks_shani(uint32_t [5], const uint8_t *, size_t);
+#endif
+
 #define HTONDIGEST(x) do {                                              \
         x[0] = htonl(x[0]);                                             \
         x[1] = htonl(x[1]);                                             \
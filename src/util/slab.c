@@ -39,17 +39,16 @@
 #define CHECK_MAGIC(element, value)
 #endif
 
+/* The migrated list of a page whose child pool has been destroyed. */
+#define SLAB_PAGE_ORPHANED ((struct slab_element_header *)(intptr_t)1)
+
 /* One array element within a big buffer. */
 struct slab_element_header {
    /* The next element in the free or migrated list. */
    struct slab_element_header *next;
 
-   /* This is either
-    * - a pointer to the child pool to which this element belongs, or
-    * - a pointer to the orphaned page of the element, with the least
-    *   significant bit set to 1.
-    */
-   intptr_t owner;
+   /* The page that contains this element. */
+   struct slab_page_header *page;
 
 #ifndef NDEBUG
    intptr_t magic;
@@ -58,13 +57,35 @@ struct slab_element_header {
 
 /* The page is an array of allocations in one block. */
 struct slab_page_header {
-   union {
-      /* Next page in the same child pool. */
-      struct slab_page_header *next;
+   /* Next page in the same child pool. */
+   struct slab_page_header *next;
+
+   /* The child pool that allocates from this page, or NULL when it has been
+    * destroyed.
+    */
+   struct slab_child_pool *owner;
+
+   /* Elements of this page that were freed with a different child pool as
+    * the argument to slab_free. Other threads push to it with a
+    * compare-and-swap and the owner takes the whole list with an exchange,
+    * so no lock is needed. It is SLAB_PAGE_ORPHANED once the owner is
+    * destroyed.
+    *
+    * The list lives in the page rather than in the child pool because the
+    * page can't go away while one of its elements is being freed, while the
+    * child pool can be destroyed at any time.
+    */
+   struct slab_element_header *migrated;
+
+   /* Number of remaining, non-freed elements (for orphaned pages). Elements
+    * freed after the page was orphaned but before the count was set make it
+    * negative for a moment.
+    */
+   int num_remaining;
+
+   /* Number of free elements, only used while orphaning the page. */
+   unsigned num_free;
 
-      /* Number of remaining, non-freed elements (for orphaned pages). */
-      unsigned num_remaining;
-   } u;
    /* Memory after the last member is dedicated to the page itself.
     * The allocated size is always larger than this structure.
     */
@@ -79,6 +100,22 @@ slab_get_element(struct slab_parent_pool *parent,
           ((uint8_t*)&page[1] + (parent->element_size * index));
 }
 
+/* Take the migrated list of the page and replace it with new_list. */
+static struct slab_element_header *
+slab_page_take_migrated(struct slab_page_header *page,
+                        struct slab_element_header *new_list)
+{
+   struct slab_element_header *migrated = p_atomic_read(&page->migrated);
+
+   for (;;) {
+      struct slab_element_header *old =
+         p_atomic_cmpxchg(&page->migrated, migrated, new_list);
+      if (old == migrated)
+         return migrated;
+      migrated = old;
+   }
+}
+
 /* The given object/element belongs to an orphaned page (i.e. the owning child
  * pool has been destroyed). Mark the element as freed and free the whole page
  * when no elements are left in it.
@@ -86,12 +123,11 @@ slab_get_element(struct slab_parent_pool *parent,
 static void
 slab_free_orphaned(struct slab_element_header *elt)
 {
-   struct slab_page_header *page;
+   struct slab_page_header *page = elt->page;
 
-   assert(elt->owner & 1);
+   assert(p_atomic_read(&page->migrated) == SLAB_PAGE_ORPHANED);
 
-   page = (struct slab_page_header *)(elt->owner & ~(intptr_t)1);
-   if (!p_atomic_dec_return(&page->u.num_remaining))
+   if (!p_atomic_dec_return(&page->num_remaining))
       free(page);
 }
 
@@ -106,7 +142,6 @@ slab_create_parent(struct slab_parent_pool *parent,
                    unsigned item_size,
                    unsigned num_items)
 {
-   mtx_init(&parent->mutex, mtx_plain);
    parent->element_size = ALIGN_POT(sizeof(struct slab_element_header) + item_size,
                                     sizeof(intptr_t));
    parent->num_elements = num_items;
@@ -115,7 +150,6 @@ slab_create_parent(struct slab_parent_pool *parent,
 void
 slab_destroy_parent(struct slab_parent_pool *parent)
 {
-   mtx_destroy(&parent->mutex);
 }
 
 /**
@@ -127,7 +161,6 @@ void slab_create_child(struct slab_child_pool *pool,
    pool->parent = parent;
    pool->pages = NULL;
    pool->free = NULL;
-   pool->migrated = NULL;
 }
 
 /**
@@ -141,31 +174,33 @@ void slab_destroy_child(struct slab_child_pool *pool)
    if (!pool->parent)
       return; /* the slab probably wasn't even created */
 
-   mtx_lock(&pool->parent->mutex);
-
-   while (pool->pages) {
-      struct slab_page_header *page = pool->pages;
-      pool->pages = page->u.next;
-      p_atomic_set(&page->u.num_remaining, pool->parent->num_elements);
-
-      for (unsigned i = 0; i < pool->parent->num_elements; ++i) {
-         struct slab_element_header *elt = slab_get_element(pool->parent, page, i);
-         p_atomic_set(&elt->owner, (intptr_t)page | 1);
-      }
-   }
-
-   while (pool->migrated) {
-      struct slab_element_header *elt = pool->migrated;
-      pool->migrated = elt->next;
-      slab_free_orphaned(elt);
+   /* Orphan the pages. From now on, other threads account elements they free
+    * in num_remaining instead of pushing them to the migrated list, and the
+    * elements that were already pushed are counted as free.
+    */
+   for (struct slab_page_header *page = pool->pages; page; page = page->next) {
+      struct slab_element_header *migrated =
+         slab_page_take_migrated(page, SLAB_PAGE_ORPHANED);
+
+      p_atomic_set(&page->owner, NULL);
+      page->num_free = 0;
+      for (; migrated; migrated = migrated->next)
+         page->num_free++;
    }
 
-   mtx_unlock(&pool->parent->mutex);
-
    while (pool->free) {
       struct slab_element_header *elt = pool->free;
       pool->free = elt->next;
-      slab_free_orphaned(elt);
+      elt->page->num_free++;
+   }
+
+   while (pool->pages) {
+      struct slab_page_header *page = pool->pages;
+      int num_remaining = pool->parent->num_elements - page->num_free;
+
+      pool->pages = page->next;
+      if (!p_atomic_add_return(&page->num_remaining, num_remaining))
+         free(page);
    }
 
    /* Guard against use-after-free. */
@@ -183,15 +218,17 @@ slab_add_new_page(struct slab_child_pool *pool)
 
    for (unsigned i = 0; i < pool->parent->num_elements; ++i) {
       struct slab_element_header *elt = slab_get_element(pool->parent, page, i);
-      elt->owner = (intptr_t)pool;
-      assert(!(elt->owner & 1));
+      elt->page = page;
 
       elt->next = pool->free;
       pool->free = elt;
       SET_MAGIC(elt, SLAB_MAGIC_FREE);
    }
 
-   page->u.next = pool->pages;
+   page->owner = pool;
+   page->migrated = NULL;
+   page->num_remaining = 0;
+   page->next = pool->pages;
    pool->pages = page;
 
    return true;
@@ -211,10 +248,19 @@ slab_alloc(struct slab_child_pool *pool)
       /* First, collect elements that belong to us but were freed from a
        * different child pool.
        */
-      mtx_lock(&pool->parent->mutex);
-      pool->free = pool->migrated;
-      pool->migrated = NULL;
-      mtx_unlock(&pool->parent->mutex);
+      for (struct slab_page_header *page = pool->pages; page; page = page->next) {
+         if (!p_atomic_read_relaxed(&page->migrated))
+            continue;
+
+         struct slab_element_header *migrated =
+            slab_page_take_migrated(page, NULL);
+         while (migrated) {
+            struct slab_element_header *elt = migrated;
+            migrated = elt->next;
+            elt->next = pool->free;
+            pool->free = elt;
+         }
+      }
 
       /* Now allocate a new page. */
       if (!pool->free && !slab_add_new_page(pool))
@@ -242,12 +288,13 @@ slab_alloc(struct slab_child_pool *pool)
 void slab_free(struct slab_child_pool *pool, void *ptr)
 {
    struct slab_element_header *elt = ((struct slab_element_header*)ptr - 1);
-   intptr_t owner_int;
+   struct slab_page_header *page = elt->page;
+   struct slab_element_header *migrated;
 
    CHECK_MAGIC(elt, SLAB_MAGIC_ALLOCATED);
    SET_MAGIC(elt, SLAB_MAGIC_FREE);
 
-   if (p_atomic_read(&elt->owner) == (intptr_t)pool) {
+   if (p_atomic_read(&page->owner) == pool) {
       /* This is the simple case: The caller guarantees that we can safely
        * access the free list.
        */
@@ -256,27 +303,22 @@ void slab_free(struct slab_child_pool *pool, void *ptr)
       return;
    }
 
-   /* The slow case: migration or an orphaned page. */
-   if (pool->parent)
-      mtx_lock(&pool->parent->mutex);
-
-   /* Note: we _must_ re-read elt->owner here because the owning child pool
-    * may have been destroyed by another thread in the meantime.
+   /* The slow case: migration or an orphaned page. Push the element to the
+    * migrated list of its page, unless the owning child pool has been
+    * destroyed by another thread in the meantime.
     */
-   owner_int = p_atomic_read(&elt->owner);
-
-   if (!(owner_int & 1)) {
-      struct slab_child_pool *owner = (struct slab_child_pool *)owner_int;
-      elt->next = owner->migrated;
-      owner->migrated = elt;
-      if (pool->parent)
-         mtx_unlock(&pool->parent->mutex);
-   } else {
-      if (pool->parent)
-         mtx_unlock(&pool->parent->mutex);
-
-      slab_free_orphaned(elt);
+   migrated = p_atomic_read(&page->migrated);
+   while (migrated != SLAB_PAGE_ORPHANED) {
+      struct slab_element_header *old;
+
+      elt->next = migrated;
+      old = p_atomic_cmpxchg(&page->migrated, migrated, elt);
+      if (old == migrated)
+         return;
+      migrated = old;
    }
+
+   slab_free_orphaned(elt);
 }
 
 /**
@@ -32,8 +32,9 @@
  *
  * Allocations obtained from one child pool should usually be freed in the
  * same child pool. Freeing an allocation in a different child pool associated
- * to the same parent is allowed (and requires no locking by the caller), but
- * it is discouraged because it implies a performance penalty.
+ * to the same parent is allowed (and requires no locking by the caller). It
+ * costs an atomic push to a list of the page the allocation came from, and the
+ * owning child pool takes the list back when it runs out of free elements.
  *
  * For convenience and to ease the transition, there is also a set of wrapper
  * functions around a single parent-child pair.
@@ -52,7 +53,6 @@ struct slab_element_header;
 struct slab_page_header;
 
 struct slab_parent_pool {
-   mtx_t mutex;
    unsigned element_size;
    unsigned num_elements;
 };
@@ -64,13 +64,6 @@ struct slab_child_pool {
 
    /* Free elements. */
    struct slab_element_header *free;
-
-   /* Elements that are owned by this pool but were freed with a different
-    * pool as the argument to slab_free.
-    *
-    * This list is protected by the parent mutex.
-    */
-   struct slab_element_header *migrated;
 };
 
 void slab_create_parent(struct slab_parent_pool *parent,
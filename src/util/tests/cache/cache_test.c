@@ -461,6 +461,150 @@ test_put_and_get(void)
    disk_cache_destroy(cache);
 }
 
+static void
+test_put_and_get_single_file(void)
+{
+   struct disk_cache *cache;
+   char blob[] = "This is a blob of thirty-seven bytes";
+   uint8_t blob_key[20];
+   char string[] = "While this string has thirty-four";
+   uint8_t string_key[20];
+   char *result;
+   size_t size;
+   uint8_t *one_KB;
+   uint8_t one_KB_key[20];
+
+#ifdef SHADER_CACHE_DISABLE_BY_DEFAULT
+   setenv("MESA_GLSL_CACHE_DISABLE", "false", 1);
+#endif /* SHADER_CACHE_DISABLE_BY_DEFAULT */
+
+   setenv("MESA_DISK_CACHE_SINGLE_FILE", "true", 1);
+   setenv("MESA_GLSL_CACHE_MAX_SIZE", "1K", 1);
+
+   cache = disk_cache_create("test", "make_check", 0);
+
+   /* Nothing to test if Mesa was built without single file cache support. */
+   if (!cache_exists(cache)) {
+      disk_cache_destroy(cache);
+      goto done;
+   }
+
+   disk_cache_compute_key(cache, blob, sizeof(blob), blob_key);
+   disk_cache_compute_key(cache, string, sizeof(string), string_key);
+
+   result = disk_cache_get(cache, blob_key, &size);
+   expect_null(result, "single file disk_cache_get with non-existent item");
+
+   disk_cache_put(cache, blob_key, blob, sizeof(blob), NULL);
+   disk_cache_put(cache, string_key, string, sizeof(string), NULL);
+
+   /* disk_cache_put() hands things off to a thread so wait for it. */
+   disk_cache_wait_for_idle(cache);
+
+   /* A fresh cache loads both items back from the index db. */
+   disk_cache_destroy(cache);
+   cache = disk_cache_create("test", "make_check", 0);
+
+   result = disk_cache_get(cache, blob_key, &size);
+   expect_equal_str(blob, result, "single file disk_cache_get after reload");
+   expect_equal(size, sizeof(blob), "single file disk_cache_get size");
+   free(result);
+
+   result = disk_cache_get(cache, string_key, &size);
+   expect_equal_str(string, result, "2nd single file disk_cache_get after reload");
+   free(result);
+
+   /* There is no eviction, items that don't fit are not stored. Cache items
+    * are compressed so use data that doesn't compress well.
+    */
+   one_KB = malloc(1024);
+   for (unsigned i = 0; i < 1024; i++)
+      one_KB[i] = rand();
+
+   disk_cache_compute_key(cache, one_KB, 1024, one_KB_key);
+   disk_cache_put(cache, one_KB_key, one_KB, 1024, NULL);
+   free(one_KB);
+
+   disk_cache_wait_for_idle(cache);
+
+   expect_false(does_cache_contain(cache, one_KB_key),
+                "single file disk_cache_put beyond MAX_SIZE (1KB)");
+   expect_true(does_cache_contain(cache, blob_key),
+               "single file disk_cache_put beyond MAX_SIZE keeps old items");
+
+   disk_cache_destroy(cache);
+
+done:
+   setenv("MESA_DISK_CACHE_SINGLE_FILE", "false", 1);
+   unsetenv("MESA_GLSL_CACHE_MAX_SIZE");
+}
+
+struct get_async_result {
+   void *data;
+   size_t size;
+};
+
+static void
+get_async_cb(const uint8_t *key, void *data, size_t size, void *cb_data)
+{
+   struct get_async_result *result = (struct get_async_result *) cb_data;
+
+   result->data = data;
+   result->size = size;
+}
+
+static void
+test_get_batch_and_async(void)
+{
+   struct disk_cache *cache;
+   char blob[] = "This is a blob of thirty-seven bytes";
+   char string[] = "While this string has thirty-four";
+   cache_key keys[3];
+   void *data[3];
+   size_t sizes[3];
+
+#ifdef SHADER_CACHE_DISABLE_BY_DEFAULT
+   setenv("MESA_GLSL_CACHE_DISABLE", "false", 1);
+#endif /* SHADER_CACHE_DISABLE_BY_DEFAULT */
+
+   cache = disk_cache_create("test", "make_check", 0);
+
+   disk_cache_compute_key(cache, blob, sizeof(blob), keys[0]);
+   disk_cache_compute_key(cache, string, sizeof(string), keys[1]);
+   disk_cache_compute_key(cache, keys, sizeof(keys[0]) * 2, keys[2]);
+
+   disk_cache_put(cache, keys[0], blob, sizeof(blob), NULL);
+   disk_cache_put(cache, keys[1], string, sizeof(string), NULL);
+
+   /* disk_cache_put() hands things off to a thread so wait for it. */
+   disk_cache_wait_for_idle(cache);
+
+   disk_cache_get_batch(cache, 3, (const cache_key *) keys, data, sizes);
+   expect_equal_str(blob, data[0], "disk_cache_get_batch 1st item (pointer)");
+   expect_equal(sizes[0], sizeof(blob), "disk_cache_get_batch 1st item (size)");
+   expect_equal_str(string, data[1], "disk_cache_get_batch 2nd item (pointer)");
+   expect_equal(sizes[1], sizeof(string), "disk_cache_get_batch 2nd item (size)");
+   expect_null(data[2], "disk_cache_get_batch with non-existent item");
+   free(data[0]);
+   free(data[1]);
+
+   struct get_async_result results[2] = {0};
+   disk_cache_get_async(cache, keys[1], get_async_cb, &results[0]);
+   disk_cache_get_async(cache, keys[2], get_async_cb, &results[1]);
+
+   /* disk_cache_get_async() hands things off to a thread so wait for it. */
+   disk_cache_wait_for_idle(cache);
+
+   expect_equal_str(string, results[0].data,
+                    "disk_cache_get_async of existing item (pointer)");
+   expect_equal(results[0].size, sizeof(string),
+                "disk_cache_get_async of existing item (size)");
+   expect_null(results[1].data, "disk_cache_get_async with non-existent item");
+   free(results[0].data);
+
+   disk_cache_destroy(cache);
+}
+
 static void
 test_put_key_and_get_key(void)
 {
@@ -524,10 +668,17 @@ main(void)
 #ifdef ENABLE_SHADER_CACHE
    int err;
 
+   /* The tests below exercise the multi file cache layout and eviction. */
+   setenv("MESA_DISK_CACHE_SINGLE_FILE", "false", 1);
+
    test_disk_cache_create();
 
    test_put_and_get();
 
+   test_get_batch_and_async();
+
+   test_put_and_get_single_file();
+
    test_put_key_and_get_key();
 
    err = rmrf_local(CACHE_TEST_TMP);
@@ -694,6 +694,90 @@ test_format_pack_s_8uint(const struct util_format_description *format_desc,
 }
 
 
+#define ROW_WIDTH 37
+
+static boolean
+compare_float_bits(float x, float y)
+{
+   return memcmp(&x, &y, sizeof x) == 0 || (isnan(x) && isnan(y));
+}
+
+/* Converts a row of copies of the test pixel, which goes through the SIMD
+ * functions where there are any, and checks that every pixel matches a
+ * conversion of the pixel alone.
+ */
+static boolean
+test_format_rows(const struct util_format_description *format_desc,
+                 const struct util_format_test_case *test)
+{
+   const struct util_format_unpack_description *unpack =
+      util_format_unpack_description(format_desc->format);
+   const struct util_format_pack_description *pack =
+      util_format_pack_description(format_desc->format);
+   unsigned bytes = format_desc->block.bits / 8;
+   uint8_t packed[ROW_WIDTH * UTIL_FORMAT_MAX_PACKED_BYTES];
+   uint8_t packed_one[UTIL_FORMAT_MAX_PACKED_BYTES];
+   float unpacked[ROW_WIDTH][4], unpacked_one[4];
+   uint8_t unpacked_8unorm[ROW_WIDTH][4], unpacked_8unorm_one[4];
+   unsigned i, k;
+   boolean success = TRUE;
+
+   for (i = 0; i < ROW_WIDTH; ++i)
+      memcpy(packed + i * bytes, test->packed, bytes);
+
+   if (unpack->unpack_rgba) {
+      unpack->unpack_rgba(&unpacked[0][0], 0, packed, 0, ROW_WIDTH, 1);
+      unpack->unpack_rgba(unpacked_one, 0, packed, 0, 1, 1);
+      for (i = 0; i < ROW_WIDTH; ++i) {
+         for (k = 0; k < 4; ++k) {
+            if (!compare_float_bits(unpacked[i][k], unpacked_one[k]))
+               success = FALSE;
+         }
+      }
+   }
+
+   if (unpack->unpack_rgba_8unorm) {
+      unpack->unpack_rgba_8unorm(&unpacked_8unorm[0][0], 0, packed, 0, ROW_WIDTH, 1);
+      unpack->unpack_rgba_8unorm(unpacked_8unorm_one, 0, packed, 0, 1, 1);
+      for (i = 0; i < ROW_WIDTH; ++i) {
+         if (memcmp(unpacked_8unorm[i], unpacked_8unorm_one, 4))
+            success = FALSE;
+      }
+   }
+
+   if (pack->pack_rgba_float) {
+      for (i = 0; i < ROW_WIDTH; ++i) {
+         for (k = 0; k < 4; ++k)
+            unpacked[i][k] = (float) test->unpacked[0][0][k];
+      }
+      pack->pack_rgba_float(packed, 0, &unpacked[0][0], 0, ROW_WIDTH, 1);
+      pack->pack_rgba_float(packed_one, 0, &unpacked[0][0], 0, 1, 1);
+      for (i = 0; i < ROW_WIDTH; ++i) {
+         if (memcmp(packed + i * bytes, packed_one, bytes))
+            success = FALSE;
+      }
+   }
+
+   if (pack->pack_rgba_8unorm) {
+      for (i = 0; i < ROW_WIDTH; ++i) {
+         for (k = 0; k < 4; ++k)
+            unpacked_8unorm[i][k] = 17 * (i + k);
+      }
+      pack->pack_rgba_8unorm(packed, 0, &unpacked_8unorm[0][0], 0, ROW_WIDTH, 1);
+      for (i = 0; i < ROW_WIDTH; ++i) {
+         pack->pack_rgba_8unorm(packed_one, 0, unpacked_8unorm[i], 0, 1, 1);
+         if (memcmp(packed + i * bytes, packed_one, bytes))
+            success = FALSE;
+      }
+   }
+
+   if (!success)
+      printf("FAILED: %s rows differ from single pixels\n", format_desc->short_name);
+
+   return success;
+}
+
+
 /* Touch-test that the unorm/snorm flags are set up right by codegen. */
 static boolean
 test_format_norm_flags(const struct util_format_description *format_desc)
@@ -836,6 +920,13 @@ test_all(void)
       TEST_ONE_UNPACK_FUNC(unpack_s_8uint);
       TEST_ONE_PACK_FUNC(pack_s_8uint);
 
+      if (format_desc->layout == UTIL_FORMAT_LAYOUT_PLAIN &&
+          format_desc->block.width == 1 && format_desc->block.height == 1 &&
+          format_desc->colorspace != UTIL_FORMAT_COLORSPACE_ZS) {
+         if (!test_one_func(format_desc, &test_format_rows, "rows"))
+            success = FALSE;
+      }
+
       TEST_FORMAT_METADATA(norm_flags);
 
 #     undef TEST_ONE_FUNC
@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2021 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#undef NDEBUG
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "flat_hash_map.h"
+#include "hash_table.h"
+
+#define SIZE 10000
+
+static uint64_t
+key_for(uint32_t i)
+{
+   /* Spread the keys over the whole 64-bit range, including 0 and ~0. */
+   return i == 1 ? ~0ull : (uint64_t)i * 0x9e3779b97f4a7c15ull;
+}
+
+static void
+delete_callback(struct hash_entry *entry)
+{
+   (*(uint32_t *)entry->data)++;
+}
+
+int
+main(int argc, char **argv)
+{
+   struct flat_hash_map *map;
+   uint32_t values[SIZE];
+   uint32_t i;
+
+   (void) argc;
+   (void) argv;
+
+   map = flat_hash_map_create(NULL);
+
+   for (i = 0; i < SIZE; i++) {
+      values[i] = i;
+      flat_hash_map_insert(map, key_for(i), &values[i]);
+   }
+   assert(map->entries == SIZE);
+
+   for (i = 0; i < SIZE; i++)
+      assert(flat_hash_map_search(map, key_for(i)) == &values[i]);
+   assert(flat_hash_map_search(map, 1) == NULL);
+
+   /* Replacing keeps the entry count. */
+   flat_hash_map_insert(map, key_for(0), &values[1]);
+   assert(flat_hash_map_search(map, key_for(0)) == &values[1]);
+   assert(map->entries == SIZE);
+
+   /* Remove every other key and churn through deleted slots. */
+   for (i = 0; i < SIZE; i += 2)
+      assert(flat_hash_map_remove(map, key_for(i)));
+   assert(!flat_hash_map_remove(map, key_for(0)));
+   assert(map->entries == SIZE / 2);
+
+   for (i = 0; i < SIZE; i++) {
+      void *data = flat_hash_map_search(map, key_for(i));
+      assert(data == (i % 2 ? &values[i] : NULL));
+   }
+
+   for (uint32_t round = 0; round < 4; round++) {
+      for (i = 0; i < SIZE; i += 2)
+         flat_hash_map_insert(map, key_for(i), &values[i]);
+      for (i = 0; i < SIZE; i += 2)
+         assert(flat_hash_map_remove(map, key_for(i)));
+   }
+   assert(map->entries == SIZE / 2);
+
+   uint32_t count = 0;
+   flat_hash_map_foreach(map, entry) {
+      uint32_t v = *(uint32_t *)entry->data;
+      assert(v % 2 == 1 && entry->key == key_for(v));
+      count++;
+   }
+   assert(count == SIZE / 2);
+
+   /* Deleting while iterating. */
+   flat_hash_map_foreach(map, entry)
+      flat_hash_map_remove(map, entry->key);
+   assert(map->entries == 0);
+   assert(flat_hash_map_next_entry(map, NULL) == NULL);
+
+   /* Pointer and 32-bit keys. */
+   flat_hash_map_insert_ptr(map, &values[3], &values[4]);
+   flat_hash_map_insert_u32(map, 0xffffffffu, &values[5]);
+   assert(flat_hash_map_search_ptr(map, &values[3]) == &values[4]);
+   assert(flat_hash_map_search_u32(map, 0xffffffffu) == &values[5]);
+   assert(flat_hash_map_remove_ptr(map, &values[3]));
+   assert(flat_hash_map_remove_u32(map, 0xffffffffu));
+
+   flat_hash_map_insert(map, 42, &values[42]);
+   flat_hash_map_clear(map);
+   assert(map->entries == 0);
+   assert(flat_hash_map_search(map, 42) == NULL);
+
+   flat_hash_map_destroy(map);
+
+   /* The u64 hash table wrapper accepts every key, and calls the delete
+    * callback once per entry.
+    */
+   struct hash_table_u64 *ht = _mesa_hash_table_u64_create(NULL);
+   uint32_t deleted = 0;
+   _mesa_hash_table_u64_insert(ht, 0, &deleted);
+   _mesa_hash_table_u64_insert(ht, 1, &deleted);
+   _mesa_hash_table_u64_insert(ht, ~0ull, &deleted);
+   assert(_mesa_hash_table_u64_search(ht, 0) == &deleted);
+   assert(_mesa_hash_table_u64_search(ht, 1) == &deleted);
+   _mesa_hash_table_u64_remove(ht, ~0ull);
+   assert(_mesa_hash_table_u64_search(ht, ~0ull) == NULL);
+   _mesa_hash_table_u64_destroy(ht, delete_callback);
+   assert(deleted == 2);
+
+   return 0;
+}
@@ -0,0 +1,250 @@
+/*
+ * Copyright © 2021 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#undef NDEBUG
+
+#include "util/u_queue.h"
+#include "util/os_time.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#define NUM_JOBS 256
+
+struct test_job {
+   struct util_queue_fence fence;
+   unsigned index;
+   unsigned *counter;
+   unsigned *running;
+   unsigned *max_running;
+   unsigned sequence;
+   int thread_index;
+};
+
+static void
+test_job_execute(void *data, int thread_index)
+{
+   struct test_job *job = data;
+
+   if (job->running) {
+      unsigned running = p_atomic_inc_return(job->running);
+      unsigned max = p_atomic_read(job->max_running);
+      while (running > max) {
+         unsigned old = p_atomic_cmpxchg(job->max_running, max, running);
+         if (old == max)
+            break;
+         max = old;
+      }
+      os_time_sleep(100);
+      p_atomic_dec(job->running);
+   }
+
+   job->thread_index = thread_index;
+   job->sequence = p_atomic_inc_return(job->counter);
+}
+
+static void
+test_concurrency_limit(void)
+{
+   struct util_queue queue;
+   struct test_job jobs[NUM_JOBS];
+   unsigned counter = 0, running = 0, max_running = 0;
+
+   bool ret = util_queue_init(&queue, "test", 8, 2,
+                              UTIL_QUEUE_INIT_SHARED_THREADS);
+   assert(ret);
+
+   for (unsigned i = 0; i < NUM_JOBS; i++) {
+      jobs[i] = (struct test_job) {
+         .index = i,
+         .counter = &counter,
+         .running = &running,
+         .max_running = &max_running,
+      };
+      util_queue_fence_init(&jobs[i].fence);
+      util_queue_add_job(&queue, &jobs[i], &jobs[i].fence,
+                         test_job_execute, NULL, 0);
+   }
+
+   util_queue_finish(&queue);
+   assert(counter == NUM_JOBS);
+   assert(max_running <= 2);
+
+   for (unsigned i = 0; i < NUM_JOBS; i++) {
+      assert(util_queue_fence_is_signalled(&jobs[i].fence));
+      assert(jobs[i].thread_index >= 0 && jobs[i].thread_index < 2);
+      util_queue_fence_destroy(&jobs[i].fence);
+   }
+
+   util_queue_destroy(&queue);
+}
+
+/* Jobs of a queue with a single thread run in order, and several queues can
+ * share the pool.
+ */
+static void
+test_in_order(void)
+{
+   struct util_queue queues[4];
+   struct test_job jobs[4][NUM_JOBS];
+   unsigned counters[4] = {0};
+
+   for (unsigned q = 0; q < 4; q++) {
+      bool ret = util_queue_init(&queues[q], "test", 32, 1,
+                                 UTIL_QUEUE_INIT_SHARED_THREADS |
+                                 UTIL_QUEUE_INIT_RESIZE_IF_FULL |
+                                 (q & 1 ? UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY : 0));
+      assert(ret);
+   }
+
+   for (unsigned i = 0; i < NUM_JOBS; i++) {
+      for (unsigned q = 0; q < 4; q++) {
+         jobs[q][i] = (struct test_job) {
+            .index = i,
+            .counter = &counters[q],
+         };
+         util_queue_fence_init(&jobs[q][i].fence);
+         util_queue_add_job(&queues[q], &jobs[q][i], &jobs[q][i].fence,
+                            test_job_execute, NULL, 0);
+      }
+   }
+
+   for (unsigned q = 0; q < 4; q++) {
+      util_queue_finish(&queues[q]);
+      for (unsigned i = 0; i < NUM_JOBS; i++) {
+         assert(jobs[q][i].sequence == i + 1);
+         assert(jobs[q][i].thread_index == 0);
+         util_queue_fence_destroy(&jobs[q][i].fence);
+      }
+      util_queue_destroy(&queues[q]);
+   }
+}
+
+static void
+test_dependencies(unsigned flags)
+{
+   struct util_queue first, second;
+   struct test_job job_a, job_b, job_c;
+   struct util_queue_fence external;
+   unsigned counter = 0;
+
+   bool ret = util_queue_init(&first, "test", 8, 4, flags);
+   assert(ret);
+   ret = util_queue_init(&second, "test", 8, 4, flags);
+   assert(ret);
+
+   job_a = (struct test_job) { .counter = &counter };
+   job_b = (struct test_job) { .counter = &counter };
+   job_c = (struct test_job) { .counter = &counter };
+   util_queue_fence_init(&job_a.fence);
+   util_queue_fence_init(&job_b.fence);
+   util_queue_fence_init(&job_c.fence);
+   util_queue_fence_init(&external);
+   util_queue_fence_reset(&external);
+
+   /* c waits for a fence signalled outside of the queues, b waits for c,
+    * and a waits for b on the other queue.
+    */
+   util_queue_add_job_after(&second, &job_c, &job_c.fence, &external,
+                            test_job_execute, NULL, 0);
+   util_queue_add_job_after(&first, &job_b, &job_b.fence, &job_c.fence,
+                            test_job_execute, NULL, 0);
+   util_queue_add_job_after(&second, &job_a, &job_a.fence, &job_b.fence,
+                            test_job_execute, NULL, 0);
+
+   os_time_sleep(1000);
+   assert(!util_queue_fence_is_signalled(&job_a.fence));
+   assert(!util_queue_fence_is_signalled(&job_b.fence));
+   assert(!util_queue_fence_is_signalled(&job_c.fence));
+
+   util_queue_fence_signal(&external);
+   util_queue_fence_wait(&job_a.fence);
+   assert(job_c.sequence == 1);
+   assert(job_b.sequence == 2);
+   assert(job_a.sequence == 3);
+
+   /* Jobs still waiting when the queue is destroyed are signalled. */
+   util_queue_fence_reset(&external);
+   util_queue_add_job_after(&second, &job_c, &job_c.fence, &external,
+                            test_job_execute, NULL, 0);
+   if (flags & UTIL_QUEUE_INIT_SHARED_THREADS) {
+      util_queue_destroy(&second);
+      assert(util_queue_fence_is_signalled(&job_c.fence));
+      assert(counter == 3);
+      util_queue_fence_signal(&external);
+   } else {
+      /* Owned threads wait for the fence before they check for exit. */
+      util_queue_fence_signal(&external);
+      util_queue_destroy(&second);
+   }
+
+   util_queue_destroy(&first);
+   util_queue_fence_destroy(&job_a.fence);
+   util_queue_fence_destroy(&job_b.fence);
+   util_queue_fence_destroy(&job_c.fence);
+   util_queue_fence_destroy(&external);
+}
+
+static void
+test_drop_job(void)
+{
+   struct util_queue queue;
+   struct test_job job;
+   struct util_queue_fence external;
+   unsigned counter = 0;
+
+   bool ret = util_queue_init(&queue, "test", 8, 1,
+                              UTIL_QUEUE_INIT_SHARED_THREADS);
+   assert(ret);
+
+   job = (struct test_job) { .counter = &counter };
+   util_queue_fence_init(&job.fence);
+   util_queue_fence_init(&external);
+   util_queue_fence_reset(&external);
+
+   util_queue_add_job_after(&queue, &job, &job.fence, &external,
+                            test_job_execute, NULL, 0);
+   util_queue_drop_job(&queue, &job.fence);
+   assert(util_queue_fence_is_signalled(&job.fence));
+
+   /* The queue is idle again once the only job was dropped. */
+   util_queue_finish(&queue);
+   assert(counter == 0);
+
+   util_queue_fence_signal(&external);
+   util_queue_destroy(&queue);
+   util_queue_fence_destroy(&job.fence);
+   util_queue_fence_destroy(&external);
+}
+
+int
+main(int argc, char **argv)
+{
+   test_concurrency_limit();
+   test_in_order();
+   test_dependencies(UTIL_QUEUE_INIT_SHARED_THREADS);
+   test_dependencies(0);
+   test_drop_job();
+
+   return 0;
+}
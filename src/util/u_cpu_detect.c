@@ -424,10 +424,35 @@ check_os_arm_support(void)
 }
 
 #elif defined(PIPE_ARCH_AARCH64)
+#ifndef HWCAP_SVE
+#define HWCAP_SVE (1 << 22)
+#endif
+
 static void
 check_os_arm_support(void)
 {
-    util_cpu_caps.has_neon = true;
+   /* Advanced SIMD is mandatory on AArch64, SVE is optional */
+   util_cpu_caps.has_neon = true;
+
+#if defined(PIPE_OS_FREEBSD) && defined(HAVE_ELF_AUX_INFO)
+   unsigned long hwcap = 0;
+   elf_aux_info(AT_HWCAP, &hwcap, sizeof(hwcap));
+   util_cpu_caps.has_sve = !!(hwcap & HWCAP_SVE);
+#elif defined(PIPE_OS_LINUX)
+   Elf64_auxv_t aux;
+   int fd;
+
+   fd = open("/proc/self/auxv", O_RDONLY | O_CLOEXEC);
+   if (fd >= 0) {
+      while (read(fd, &aux, sizeof(Elf64_auxv_t)) == sizeof(Elf64_auxv_t)) {
+         if (aux.a_type == AT_HWCAP) {
+            util_cpu_caps.has_sve = !!(aux.a_un.a_val & HWCAP_SVE);
+            break;
+         }
+      }
+      close(fd);
+   }
+#endif
 }
 #endif /* PIPE_ARCH_ARM || PIPE_ARCH_AARCH64 */
 
@@ -641,6 +666,11 @@ util_cpu_detect_once(void)
          cpuid_count(0x00000007, 0x00000000, regs7);
          util_cpu_caps.has_avx2 = (regs7[1] >> 5) & 1;
       }
+      if (regs[0] >= 0x00000007) {
+         uint32_t regs7[4];
+         cpuid_count(0x00000007, 0x00000000, regs7);
+         util_cpu_caps.has_sha = (regs7[1] >> 29) & 1;
+      }
 
       // check for avx512
       if (((regs2[2] >> 27) & 1) && // OSXSAVE
@@ -694,6 +724,9 @@ util_cpu_detect_once(void)
          util_cpu_caps.has_ssse3 = 0;
          util_cpu_caps.has_sse4_1 = 0;
       }
+      /* The SHA-1 path also uses SSSE3/SSE4.1 instructions */
+      if (!util_cpu_caps.has_sse4_1)
+         util_cpu_caps.has_sha = 0;
    }
 #endif /* PIPE_ARCH_X86 || PIPE_ARCH_X86_64 */
 
@@ -726,12 +759,14 @@ util_cpu_detect_once(void)
       debug_printf("util_cpu_caps.has_avx2 = %u\n", util_cpu_caps.has_avx2);
       debug_printf("util_cpu_caps.has_f16c = %u\n", util_cpu_caps.has_f16c);
       debug_printf("util_cpu_caps.has_popcnt = %u\n", util_cpu_caps.has_popcnt);
+      debug_printf("util_cpu_caps.has_sha = %u\n", util_cpu_caps.has_sha);
       debug_printf("util_cpu_caps.has_3dnow = %u\n", util_cpu_caps.has_3dnow);
       debug_printf("util_cpu_caps.has_3dnow_ext = %u\n", util_cpu_caps.has_3dnow_ext);
       debug_printf("util_cpu_caps.has_xop = %u\n", util_cpu_caps.has_xop);
       debug_printf("util_cpu_caps.has_altivec = %u\n", util_cpu_caps.has_altivec);
       debug_printf("util_cpu_caps.has_vsx = %u\n", util_cpu_caps.has_vsx);
       debug_printf("util_cpu_caps.has_neon = %u\n", util_cpu_caps.has_neon);
+      debug_printf("util_cpu_caps.has_sve = %u\n", util_cpu_caps.has_sve);
       debug_printf("util_cpu_caps.has_daz = %u\n", util_cpu_caps.has_daz);
       debug_printf("util_cpu_caps.has_avx512f = %u\n", util_cpu_caps.has_avx512f);
       debug_printf("util_cpu_caps.has_avx512dq = %u\n", util_cpu_caps.has_avx512dq);
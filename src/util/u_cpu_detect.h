@@ -78,6 +78,7 @@ struct util_cpu_caps_t {
    unsigned has_avx2:1;
    unsigned has_f16c:1;
    unsigned has_fma:1;
+   unsigned has_sha:1;
    unsigned has_3dnow:1;
    unsigned has_3dnow_ext:1;
    unsigned has_xop:1;
@@ -85,6 +86,7 @@ struct util_cpu_caps_t {
    unsigned has_vsx:1;
    unsigned has_daz:1;
    unsigned has_neon:1;
+   unsigned has_sve:1;
 
    unsigned has_avx512f:1;
    unsigned has_avx512dq:1;
@@ -47,6 +47,12 @@ static void
 util_queue_kill_threads(struct util_queue *queue, unsigned keep_num_threads,
                         bool finish_locked);
 
+static inline bool
+util_queue_is_shared(struct util_queue *queue)
+{
+   return queue->flags & UTIL_QUEUE_INIT_SHARED_THREADS;
+}
+
 /****************************************************************************
  * Wait for all queues to assert idle when exit() is called.
  *
@@ -310,6 +316,8 @@ util_queue_thread_func(void *input)
       mtx_unlock(&queue->lock);
 
       if (job.job) {
+         if (job.wait_fence)
+            util_queue_fence_wait(job.wait_fence);
          job.execute(job.job, thread_index);
          util_queue_fence_signal(job.fence);
          if (job.cleanup)
@@ -366,6 +374,300 @@ util_queue_create_thread(struct util_queue *queue, unsigned index)
    return true;
 }
 
+/****************************************************************************
+ * Process-wide thread pool for UTIL_QUEUE_INIT_SHARED_THREADS queues
+ *
+ * Every pool thread runs the jobs of every shared queue, so drivers creating
+ * several queues don't end up with more busy threads than CPUs. An idle
+ * thread takes the first job that can start, looking at the normal priority
+ * queues before the UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY ones, and moves the
+ * queue it took the job from to the end of its list, so that queues of the
+ * same priority take turns.
+ *
+ * Jobs are added from threads outside of the pool, so per-thread job lists
+ * with work stealing wouldn't help: there would be nothing to steal from.
+ */
+
+enum util_queue_pool_priority {
+   UTIL_QUEUE_POOL_PRIORITY_NORMAL,
+   UTIL_QUEUE_POOL_PRIORITY_LOW,
+   UTIL_QUEUE_POOL_NUM_PRIORITIES,
+};
+
+/* How often idle threads look for jobs whose wait_fence was signalled
+ * outside of the pool.
+ */
+#define UTIL_QUEUE_POOL_POLL_NS (10 * 1000 * 1000)
+
+static struct {
+   /* Protects the fields below and the pool_link of the queues. It must be
+    * locked before the lock of a queue.
+    */
+   mtx_t lock;
+   cnd_t has_work;
+   struct list_head queues[UTIL_QUEUE_POOL_NUM_PRIORITIES];
+   /* A job waiting for its wait_fence was seen by the last search. */
+   bool has_blocked_jobs;
+   bool exit;
+
+   /* Protected by pool_ref_mutex. Threads are created for the first shared
+    * queue and joined with the last one, so that none of them outlives the
+    * driver that created it.
+    */
+   unsigned num_refs;
+   unsigned num_threads;
+   thrd_t *threads;
+} pool;
+
+static once_flag pool_once_flag = ONCE_FLAG_INIT;
+static mtx_t pool_ref_mutex = _MTX_INITIALIZER_NP;
+
+static void
+util_queue_pool_init_once(void)
+{
+   (void) mtx_init(&pool.lock, mtx_plain);
+   cnd_init(&pool.has_work);
+   for (unsigned i = 0; i < UTIL_QUEUE_POOL_NUM_PRIORITIES; i++)
+      list_inithead(&pool.queues[i]);
+}
+
+static enum util_queue_pool_priority
+util_queue_pool_priority(struct util_queue *queue)
+{
+   return queue->flags & UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY ?
+             UTIL_QUEUE_POOL_PRIORITY_LOW : UTIL_QUEUE_POOL_PRIORITY_NORMAL;
+}
+
+/* Remove the slots of dropped and already started jobs from the head of the
+ * ring buffer.
+ */
+static void
+shared_queue_skip_empty_slots(struct util_queue *queue)
+{
+   while (queue->num_queued && !queue->jobs[queue->read_idx].job) {
+      queue->read_idx = (queue->read_idx + 1) % queue->max_jobs;
+      queue->num_queued--;
+      cnd_signal(&queue->has_space_cond);
+   }
+}
+
+/* Take a job of the queue that can start, if the queue isn't already running
+ * num_threads jobs. The jobs of a queue with one thread start in order,
+ * other queues start any job whose wait_fence is signalled.
+ */
+static bool
+shared_queue_take_job(struct util_queue *queue, struct util_queue_job *job,
+                      int *thread_index, bool *blocked)
+{
+   bool found = false;
+
+   mtx_lock(&queue->lock);
+   shared_queue_skip_empty_slots(queue);
+
+   if (queue->num_running < queue->num_threads) {
+      unsigned i = queue->read_idx;
+
+      for (int n = 0; n < queue->num_queued;
+           n++, i = (i + 1) % queue->max_jobs) {
+         struct util_queue_job *slot = &queue->jobs[i];
+
+         if (!slot->job)
+            continue;
+
+         if (slot->wait_fence &&
+             !util_queue_fence_is_signalled(slot->wait_fence)) {
+            *blocked = true;
+            if (queue->num_threads == 1)
+               break;
+            continue;
+         }
+
+         *job = *slot;
+         memset(slot, 0, sizeof(*slot));
+         queue->total_jobs_size -= job->job_size;
+         shared_queue_skip_empty_slots(queue);
+
+         /* Use the lowest thread index that no running job of the queue
+          * has, so that it is below num_threads like with owned threads.
+          */
+         for (unsigned t = 0; t < queue->num_threads; t++) {
+            if (!(queue->busy_threads[t / 32] & (1u << (t % 32)))) {
+               queue->busy_threads[t / 32] |= 1u << (t % 32);
+               *thread_index = t;
+               break;
+            }
+         }
+         queue->num_running++;
+         found = true;
+         break;
+      }
+   }
+   mtx_unlock(&queue->lock);
+   return found;
+}
+
+static void
+shared_queue_job_done(struct util_queue *queue, int thread_index)
+{
+   mtx_lock(&queue->lock);
+   queue->busy_threads[thread_index / 32] &= ~(1u << (thread_index % 32));
+   queue->num_running--;
+   if (!queue->num_running)
+      cnd_broadcast(&queue->idle_cond);
+   mtx_unlock(&queue->lock);
+}
+
+static void
+util_queue_pool_timed_wait(int64_t timeout_ns)
+{
+   struct timespec ts;
+
+#if defined(HAVE_TIMESPEC_GET) || defined(_WIN32)
+   timespec_get(&ts, TIME_UTC);
+#else
+   clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+
+   ts.tv_sec += timeout_ns / (1000*1000*1000);
+   ts.tv_nsec += timeout_ns % (1000*1000*1000);
+   if (ts.tv_nsec >= (1000*1000*1000)) {
+      ts.tv_sec++;
+      ts.tv_nsec -= (1000*1000*1000);
+   }
+
+   cnd_timedwait(&pool.has_work, &pool.lock, &ts);
+}
+
+static int
+util_queue_pool_thread_func(void *input)
+{
+   unsigned index = (uintptr_t)input;
+   uint32_t mask[UTIL_MAX_CPUS / 32];
+   char name[16];
+
+   /* The threads run jobs for every queue, so don't inherit the affinity of
+    * the thread that happened to create them.
+    */
+   memset(mask, 0xff, sizeof(mask));
+   util_cpu_detect();
+   util_set_current_thread_affinity(mask, NULL,
+                                    util_get_cpu_caps()->num_cpu_mask_bits);
+
+   snprintf(name, sizeof(name), "mesa_pool%u", index);
+   u_thread_setname(name);
+
+   mtx_lock(&pool.lock);
+   while (!pool.exit) {
+      struct util_queue *queue = NULL;
+      struct util_queue_job job;
+      int thread_index = 0;
+      bool blocked = false;
+
+      for (unsigned p = 0; p < UTIL_QUEUE_POOL_NUM_PRIORITIES && !queue; p++) {
+         struct util_queue *iter;
+
+         LIST_FOR_EACH_ENTRY(iter, &pool.queues[p], pool_link) {
+            if (shared_queue_take_job(iter, &job, &thread_index, &blocked)) {
+               queue = iter;
+               break;
+            }
+         }
+      }
+
+      if (!queue) {
+         pool.has_blocked_jobs = blocked;
+
+         /* Jobs only become ready when they are added, when a job of the
+          * pool finishes, or when their wait_fence is signalled by another
+          * thread, which the pool can't see, so poll for the last case.
+          */
+         if (blocked)
+            util_queue_pool_timed_wait(UTIL_QUEUE_POOL_POLL_NS);
+         else
+            cnd_wait(&pool.has_work, &pool.lock);
+         continue;
+      }
+
+      pool.has_blocked_jobs |= blocked;
+      list_del(&queue->pool_link);
+      list_addtail(&queue->pool_link,
+                   &pool.queues[util_queue_pool_priority(queue)]);
+
+      /* More jobs may be waiting, let another thread look for them. */
+      cnd_signal(&pool.has_work);
+      mtx_unlock(&pool.lock);
+
+      job.execute(job.job, thread_index);
+      util_queue_fence_signal(job.fence);
+      if (job.cleanup)
+         job.cleanup(job.job, thread_index);
+      shared_queue_job_done(queue, thread_index);
+
+      mtx_lock(&pool.lock);
+      if (pool.has_blocked_jobs)
+         cnd_broadcast(&pool.has_work);
+   }
+   mtx_unlock(&pool.lock);
+   return 0;
+}
+
+static bool
+util_queue_pool_ref(void)
+{
+   bool ret = true;
+
+   call_once(&pool_once_flag, util_queue_pool_init_once);
+
+   mtx_lock(&pool_ref_mutex);
+   if (!pool.num_refs) {
+      util_cpu_detect();
+      unsigned num_threads = MAX2(util_get_cpu_caps()->nr_cpus, 1);
+
+      pool.exit = false;
+      pool.num_threads = 0;
+      pool.threads = (thrd_t*) calloc(num_threads, sizeof(thrd_t));
+      for (unsigned i = 0; pool.threads && i < num_threads; i++) {
+         pool.threads[i] = u_thread_create(util_queue_pool_thread_func,
+                                           (void*)(uintptr_t)i);
+         if (!pool.threads[i])
+            break;
+         pool.num_threads++;
+      }
+
+      if (!pool.num_threads) {
+         free(pool.threads);
+         pool.threads = NULL;
+         ret = false;
+      }
+   }
+   if (ret)
+      pool.num_refs++;
+   mtx_unlock(&pool_ref_mutex);
+
+   return ret;
+}
+
+static void
+util_queue_pool_unref(void)
+{
+   mtx_lock(&pool_ref_mutex);
+   assert(pool.num_refs);
+   if (!--pool.num_refs) {
+      mtx_lock(&pool.lock);
+      pool.exit = true;
+      cnd_broadcast(&pool.has_work);
+      mtx_unlock(&pool.lock);
+
+      for (unsigned i = 0; i < pool.num_threads; i++)
+         thrd_join(pool.threads[i], NULL);
+
+      free(pool.threads);
+      pool.threads = NULL;
+      pool.num_threads = 0;
+   }
+   mtx_unlock(&pool_ref_mutex);
+}
+
 void
 util_queue_adjust_num_threads(struct util_queue *queue, unsigned num_threads)
 {
@@ -380,6 +682,19 @@ util_queue_adjust_num_threads(struct util_queue *queue, unsigned num_threads)
       return;
    }
 
+   if (util_queue_is_shared(queue)) {
+      mtx_lock(&queue->lock);
+      queue->num_threads = num_threads;
+      mtx_unlock(&queue->lock);
+
+      mtx_lock(&pool.lock);
+      cnd_broadcast(&pool.has_work);
+      mtx_unlock(&pool.lock);
+
+      mtx_unlock(&queue->finish_lock);
+      return;
+   }
+
    if (num_threads < old_num_threads) {
       util_queue_kill_threads(queue, num_threads, true);
       mtx_unlock(&queue->finish_lock);
@@ -452,6 +767,22 @@ util_queue_init(struct util_queue *queue,
    queue->num_queued = 0;
    cnd_init(&queue->has_queued_cond);
    cnd_init(&queue->has_space_cond);
+   cnd_init(&queue->idle_cond);
+
+   if (util_queue_is_shared(queue)) {
+      queue->busy_threads = (uint32_t*)
+         calloc(DIV_ROUND_UP(MAX2(num_threads, 1), 32), sizeof(uint32_t));
+      if (!queue->busy_threads || !util_queue_pool_ref())
+         goto fail;
+
+      mtx_lock(&pool.lock);
+      list_addtail(&queue->pool_link,
+                   &pool.queues[util_queue_pool_priority(queue)]);
+      mtx_unlock(&pool.lock);
+
+      add_to_atexit_list(queue);
+      return true;
+   }
 
    queue->threads = (thrd_t*) calloc(num_threads, sizeof(thrd_t));
    if (!queue->threads)
@@ -476,8 +807,10 @@ util_queue_init(struct util_queue *queue,
 
 fail:
    free(queue->threads);
+   free(queue->busy_threads);
 
    if (queue->jobs) {
+      cnd_destroy(&queue->idle_cond);
       cnd_destroy(&queue->has_space_cond);
       cnd_destroy(&queue->has_queued_cond);
       mtx_destroy(&queue->lock);
@@ -509,11 +842,33 @@ util_queue_kill_threads(struct util_queue *queue, unsigned keep_num_threads,
     * Then cnd_broadcast wakes them up and they will exit their function.
     */
    queue->num_threads = keep_num_threads;
-   cnd_broadcast(&queue->has_queued_cond);
-   mtx_unlock(&queue->lock);
 
-   for (i = keep_num_threads; i < old_num_threads; i++)
-      thrd_join(queue->threads[i], NULL);
+   if (util_queue_is_shared(queue)) {
+      /* The pool doesn't start jobs beyond num_threads. If it is now 0, wait
+       * for the running jobs and signal the others, like owned threads do.
+       */
+      if (!keep_num_threads) {
+         while (queue->num_running)
+            cnd_wait(&queue->idle_cond, &queue->lock);
+
+         for (i = queue->read_idx; i != queue->write_idx;
+              i = (i + 1) % queue->max_jobs) {
+            if (queue->jobs[i].job) {
+               util_queue_fence_signal(queue->jobs[i].fence);
+               queue->jobs[i].job = NULL;
+            }
+         }
+         queue->read_idx = queue->write_idx;
+         queue->num_queued = 0;
+      }
+      mtx_unlock(&queue->lock);
+   } else {
+      cnd_broadcast(&queue->has_queued_cond);
+      mtx_unlock(&queue->lock);
+
+      for (i = keep_num_threads; i < old_num_threads; i++)
+         thrd_join(queue->threads[i], NULL);
+   }
 
    if (!finish_locked)
       mtx_unlock(&queue->finish_lock);
@@ -525,12 +880,21 @@ util_queue_destroy(struct util_queue *queue)
    util_queue_kill_threads(queue, 0, false);
    remove_from_atexit_list(queue);
 
+   if (util_queue_is_shared(queue)) {
+      mtx_lock(&pool.lock);
+      list_del(&queue->pool_link);
+      mtx_unlock(&pool.lock);
+      util_queue_pool_unref();
+   }
+
+   cnd_destroy(&queue->idle_cond);
    cnd_destroy(&queue->has_space_cond);
    cnd_destroy(&queue->has_queued_cond);
    mtx_destroy(&queue->finish_lock);
    mtx_destroy(&queue->lock);
    free(queue->jobs);
    free(queue->threads);
+   free(queue->busy_threads);
 }
 
 void
@@ -540,6 +904,19 @@ util_queue_add_job(struct util_queue *queue,
                    util_queue_execute_func execute,
                    util_queue_execute_func cleanup,
                    const size_t job_size)
+{
+   util_queue_add_job_after(queue, job, fence, NULL, execute, cleanup,
+                            job_size);
+}
+
+void
+util_queue_add_job_after(struct util_queue *queue,
+                         void *job,
+                         struct util_queue_fence *fence,
+                         struct util_queue_fence *wait_fence,
+                         util_queue_execute_func execute,
+                         util_queue_execute_func cleanup,
+                         const size_t job_size)
 {
    struct util_queue_job *ptr;
 
@@ -595,6 +972,7 @@ util_queue_add_job(struct util_queue *queue,
    assert(ptr->job == NULL);
    ptr->job = job;
    ptr->fence = fence;
+   ptr->wait_fence = wait_fence;
    ptr->execute = execute;
    ptr->cleanup = cleanup;
    ptr->job_size = job_size;
@@ -603,8 +981,17 @@ util_queue_add_job(struct util_queue *queue,
    queue->total_jobs_size += ptr->job_size;
 
    queue->num_queued++;
-   cnd_signal(&queue->has_queued_cond);
-   mtx_unlock(&queue->lock);
+
+   if (util_queue_is_shared(queue)) {
+      mtx_unlock(&queue->lock);
+
+      mtx_lock(&pool.lock);
+      cnd_signal(&pool.has_work);
+      mtx_unlock(&pool.lock);
+   } else {
+      cnd_signal(&queue->has_queued_cond);
+      mtx_unlock(&queue->lock);
+   }
 }
 
 /**
@@ -638,6 +1025,9 @@ util_queue_drop_job(struct util_queue *queue, struct util_queue_fence *fence)
          break;
       }
    }
+   /* util_queue_finish may be waiting for this job on a shared queue. */
+   if (removed && util_queue_is_shared(queue))
+      cnd_broadcast(&queue->idle_cond);
    mtx_unlock(&queue->lock);
 
    if (removed)
@@ -674,6 +1064,22 @@ util_queue_finish(struct util_queue *queue)
       return;
    }
 
+   /* Pool threads also run other queues, so they can't all be blocked on a
+    * barrier. Wait for the jobs of the queue to drain instead.
+    */
+   if (util_queue_is_shared(queue)) {
+      mtx_lock(&queue->lock);
+      while (queue->num_threads) {
+         shared_queue_skip_empty_slots(queue);
+         if (!queue->num_queued && !queue->num_running)
+            break;
+         cnd_wait(&queue->idle_cond, &queue->lock);
+      }
+      mtx_unlock(&queue->lock);
+      mtx_unlock(&queue->finish_lock);
+      return;
+   }
+
    fences = malloc(queue->num_threads * sizeof(*fences));
    util_barrier_init(&barrier, queue->num_threads);
 
@@ -698,7 +1104,7 @@ int64_t
 util_queue_get_thread_time_nano(struct util_queue *queue, unsigned thread_index)
 {
    /* Allow some flexibility by not raising an error. */
-   if (thread_index >= queue->num_threads)
+   if (thread_index >= queue->num_threads || !queue->threads)
       return 0;
 
    return util_thread_get_time_nano(queue->threads[thread_index]);
@@ -49,6 +49,14 @@ extern "C" {
 #define UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY      (1 << 0)
 #define UTIL_QUEUE_INIT_RESIZE_IF_FULL            (1 << 1)
 #define UTIL_QUEUE_INIT_SET_FULL_THREAD_AFFINITY  (1 << 2)
+/* Run the jobs on the process-wide thread pool instead of threads owned by
+ * the queue. num_threads then only limits how many jobs of the queue run at
+ * the same time, and UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY makes the pool
+ * prefer the jobs of all other queues. The queue has no threads of its own,
+ * so queue->threads can't be used, and jobs must not wait for jobs of other
+ * shared queues (use util_queue_add_job_after instead).
+ */
+#define UTIL_QUEUE_INIT_SHARED_THREADS            (1 << 3)
 
 #if UTIL_FUTEX_SUPPORTED
 #define UTIL_QUEUE_FENCE_FUTEX
@@ -195,6 +203,7 @@ struct util_queue_job {
    void *job;
    size_t job_size;
    struct util_queue_fence *fence;
+   struct util_queue_fence *wait_fence;
    util_queue_execute_func execute;
    util_queue_execute_func cleanup;
 };
@@ -216,8 +225,16 @@ struct util_queue {
    size_t total_jobs_size;  /* memory use of all jobs in the queue */
    struct util_queue_job *jobs;
 
+   /* UTIL_QUEUE_INIT_SHARED_THREADS only, protected by lock */
+   unsigned num_running;
+   uint32_t *busy_threads; /* thread indices used by the running jobs */
+   cnd_t idle_cond;
+
    /* for cleanup at exit(), protected by exit_mutex */
    struct list_head head;
+
+   /* link in the thread pool, protected by the pool lock */
+   struct list_head pool_link;
 };
 
 bool util_queue_init(struct util_queue *queue,
@@ -234,6 +251,18 @@ void util_queue_add_job(struct util_queue *queue,
                         util_queue_execute_func execute,
                         util_queue_execute_func cleanup,
                         const size_t job_size);
+
+/* Like util_queue_add_job, but the job isn't started before wait_fence is
+ * signalled. wait_fence must belong to a job that was added earlier, or be
+ * signalled by another thread, otherwise the queue stalls.
+ */
+void util_queue_add_job_after(struct util_queue *queue,
+                              void *job,
+                              struct util_queue_fence *fence,
+                              struct util_queue_fence *wait_fence,
+                              util_queue_execute_func execute,
+                              util_queue_execute_func cleanup,
+                              const size_t job_size);
 void util_queue_drop_job(struct util_queue *queue,
                          struct util_queue_fence *fence);
 
@@ -253,7 +282,7 @@ int64_t util_queue_get_thread_time_nano(struct util_queue *queue,
 static inline bool
 util_queue_is_initialized(struct util_queue *queue)
 {
-   return queue->threads != NULL;
+   return queue->jobs != NULL;
 }
 
 /* Convenient structure for monitoring the queue externally and passing
@@ -59,6 +59,8 @@ inline void regfree(regex_t* r) {}
 #include "strndup.h"
 #include "u_process.h"
 #include "os_file.h"
+#include "hash_table.h"
+#include "simple_mtx.h"
 
 /* For systems like Hurd */
 #ifndef PATH_MAX
@@ -669,6 +671,85 @@ parseDeviceAttr(struct OptConfData *data, const char **attr)
    }
 }
 
+/* The executable's SHA1 and the compiled application/engine name regexes
+ * do not change over the life of the process, but the config files are
+ * parsed again for every screen. Keep them around so they are only computed
+ * once.
+ */
+static simple_mtx_t match_cache_lock = _SIMPLE_MTX_INITIALIZER_NP;
+static struct hash_table *regex_cache;
+static bool exec_sha1_computed;
+static char exec_sha1[SHA1_DIGEST_STRING_LENGTH];
+
+static void
+regex_cache_fini(void)
+{
+   hash_table_foreach(regex_cache, entry) {
+      regex_t *re = entry->data;
+      if (re) {
+         regfree(re);
+         free(re);
+      }
+      free((void *)entry->key);
+   }
+   _mesa_hash_table_destroy(regex_cache, NULL);
+   regex_cache = NULL;
+}
+
+/** \brief Returns the compiled regex for a pattern, or NULL if invalid. */
+static regex_t *
+getCachedRegex(const char *pattern)
+{
+   regex_t *re = NULL;
+
+   simple_mtx_lock(&match_cache_lock);
+   if (!regex_cache) {
+      regex_cache = _mesa_hash_table_create(NULL, _mesa_hash_string,
+                                            _mesa_key_string_equal);
+      atexit(regex_cache_fini);
+   }
+
+   struct hash_entry *entry = _mesa_hash_table_search(regex_cache, pattern);
+   if (entry) {
+      re = entry->data;
+   } else {
+      re = malloc(sizeof(*re));
+      if (re && regcomp(re, pattern, REG_EXTENDED|REG_NOSUB) != 0) {
+         free(re);
+         re = NULL;
+      }
+      char *key = strdup(pattern);
+      if (key)
+         _mesa_hash_table_insert(regex_cache, key, re);
+   }
+   simple_mtx_unlock(&match_cache_lock);
+
+   return re;
+}
+
+/** \brief Returns the SHA1 of the running executable, or NULL on failure. */
+static const char *
+getExecSha1(void)
+{
+   simple_mtx_lock(&match_cache_lock);
+   if (!exec_sha1_computed) {
+      size_t len;
+      char* content;
+      char path[PATH_MAX];
+      if (util_get_process_exec_path(path, ARRAY_SIZE(path)) > 0 &&
+          (content = os_read_file(path, &len))) {
+         uint8_t sha1x[SHA1_DIGEST_LENGTH];
+         _mesa_sha1_compute(content, len, sha1x);
+         _mesa_sha1_format(exec_sha1, sha1x);
+         free(content);
+      }
+      exec_sha1_computed = true;
+   }
+   simple_mtx_unlock(&match_cache_lock);
+
+   return exec_sha1[0] ? exec_sha1 : NULL;
+}
+
 /** \brief Parse attributes of an application element. */
 static void
 parseAppAttr(struct OptConfData *data, const char **attr)
@@ -700,31 +781,16 @@ parseAppAttr(struct OptConfData *data, const char **attr)
          XML_WARNING("Incorrect sha1 application attribute");
          data->ignoringApp = data->inApp;
       } else {
-         size_t len;
-         char* content;
-         char path[PATH_MAX];
-         if (util_get_process_exec_path(path, ARRAY_SIZE(path)) > 0 &&
-             (content = os_read_file(path, &len))) {
-            uint8_t sha1x[SHA1_DIGEST_LENGTH];
-            char sha1s[SHA1_DIGEST_STRING_LENGTH];
-            _mesa_sha1_compute(content, len, sha1x);
-            _mesa_sha1_format((char*) sha1s, sha1x);
-            free(content);
-
-            if (strcmp(sha1, sha1s)) {
-               data->ignoringApp = data->inApp;
-            }
-         } else {
+         const char *sha1s = getExecSha1();
+         if (!sha1s || strcmp(sha1, sha1s))
             data->ignoringApp = data->inApp;
-         }
       }
    } else if (application_name_match) {
-      regex_t re;
+      regex_t *re = getCachedRegex(application_name_match);
 
-      if (regcomp(&re, application_name_match, REG_EXTENDED|REG_NOSUB) == 0) {
-         if (regexec(&re, data->applicationName, 0, NULL, 0) == REG_NOMATCH)
+      if (re) {
+         if (regexec(re, data->applicationName, 0, NULL, 0) == REG_NOMATCH)
             data->ignoringApp = data->inApp;
-         regfree(&re);
       } else
          XML_WARNING("Invalid application_name_match=\"%s\".", application_name_match);
    }
@@ -756,12 +822,11 @@ parseEngineAttr(struct OptConfData *data, const char **attr)
       else XML_WARNING("unknown application attribute: %s.", attr[i]);
    }
    if (engine_name_match) {
-      regex_t re;
+      regex_t *re = getCachedRegex(engine_name_match);
 
-      if (regcomp(&re, engine_name_match, REG_EXTENDED|REG_NOSUB) == 0) {
-         if (regexec(&re, data->engineName, 0, NULL, 0) == REG_NOMATCH)
+      if (re) {
+         if (regexec(re, data->engineName, 0, NULL, 0) == REG_NOMATCH)
             data->ignoringApp = data->inApp;
-         regfree(&re);
       } else
          XML_WARNING("Invalid engine_name_match=\"%s\".", engine_name_match);
    }
@@ -13,6 +13,7 @@ TIMEOUT = 1.0 # seconds
 VERSION_HEADER = bytearray('MesaOverlayControlVersion', 'utf-8')
 DEVICE_NAME_HEADER = bytearray('DeviceName', 'utf-8')
 MESA_VERSION_HEADER = bytearray('MesaVersion', 'utf-8')
+STATS_HEADER = bytearray('stats', 'utf-8')
 
 DEFAULT_SERVER_ADDRESS = "\0mesa_overlay"
 
@@ -188,6 +189,15 @@ def control(args):
         conn.send(bytearray(':capture=1;', 'utf-8'))
     elif args.cmd == 'stop-capture':
         conn.send(bytearray(':capture=0;', 'utf-8'))
+    elif args.cmd == 'stream-stats':
+        conn.send(bytearray(':capture=1;', 'utf-8'))
+        while True:
+            msgs = msgparser.readCmd(1)
+            if msgs == None:
+                break
+            for cmd, param in msgs:
+                if cmd == STATS_HEADER:
+                    print(param.decode('utf-8'), flush=True)
 
 if __name__ == '__main__':
     parser = argparse.ArgumentParser(description='MESA_overlay control client')
@@ -197,6 +207,7 @@ if __name__ == '__main__':
     commands = parser.add_subparsers(help='commands to run', dest='cmd')
     commands.add_parser('start-capture')
     commands.add_parser('stop-capture')
+    commands.add_parser('stream-stats')
 
     args = parser.parse_args()
 
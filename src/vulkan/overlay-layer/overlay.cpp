@@ -768,6 +768,38 @@ static void process_control_socket(struct instance_data *instance_data)
    }
 }
 
+/**
+ * Send the stats of the last sampling period to the control client, as a
+ * ":stats=<name> <value>,<name> <value>...;" message.
+ */
+static void control_send_stats(struct swapchain_data *data)
+{
+   struct instance_data *instance_data = data->device->instance;
+   char param[BUFSIZE];
+   unsigned paramlen = 0;
+
+   for (int s = 0; s < OVERLAY_PARAM_ENABLED_MAX; s++) {
+      if (!instance_data->params.enabled[s])
+         continue;
+
+      int n;
+      if (s == OVERLAY_PARAM_ENABLED_fps) {
+         n = snprintf(&param[paramlen], sizeof(param) - paramlen, "%s%s %.2f",
+                      paramlen ? "," : "", overlay_param_names[s], data->fps);
+      } else {
+         n = snprintf(&param[paramlen], sizeof(param) - paramlen,
+                      "%s%s %" PRIu64, paramlen ? "," : "",
+                      overlay_param_names[s], data->accumulated_stats.stats[s]);
+      }
+      if (n < 0 || paramlen + n >= sizeof(param) - 16)
+         break;
+      paramlen += n;
+   }
+
+   if (paramlen)
+      control_send(instance_data, "stats", strlen("stats"), param, paramlen);
+}
+
 static void snapshot_swapchain_frame(struct swapchain_data *data)
 {
    struct device_data *device_data = data->device;
@@ -810,7 +842,12 @@ static void snapshot_swapchain_frame(struct swapchain_data *data)
       if (capture_begin ||
           elapsed >= instance_data->params.fps_sampling_period) {
          data->fps = 1000000.0f * data->n_frames_since_update / elapsed;
-         if (instance_data->capture_started) {
+         if (instance_data->capture_started &&
+             instance_data->control_client >= 0)
+            control_send_stats(data);
+
+         if (instance_data->capture_started &&
+             instance_data->params.output_file) {
             if (!instance_data->first_line_printed) {
                bool first_column = true;
 
@@ -0,0 +1,425 @@
+/*
+ * Copyright © 2021 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "vk_pipeline_cache.h"
+
+#include "vk_alloc.h"
+#include "vk_device.h"
+#include "vk_util.h"
+
+#include "compiler/nir/nir_serialize.h"
+#include "util/blob.h"
+#include "util/disk_cache.h"
+#include "util/hash_table.h"
+#include "util/ralloc.h"
+#include "util/u_dynarray.h"
+
+struct vk_pipeline_cache_entry {
+   uint8_t key[20];
+   uint32_t size;
+   char data[0];
+};
+
+static uint32_t
+entry_key_hash(const void *key)
+{
+   /* Keys are SHA1 hashes already */
+   uint32_t hash;
+   memcpy(&hash, key, sizeof(hash));
+   return hash;
+}
+
+static bool
+entry_key_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, 20) == 0;
+}
+
+static inline struct vk_pipeline_cache_shard *
+cache_shard(struct vk_pipeline_cache *cache, const uint8_t key[20])
+{
+   return &cache->shards[key[0] % VK_PIPELINE_CACHE_NUM_SHARDS];
+}
+
+static inline void
+shard_lock(struct vk_pipeline_cache *cache,
+           struct vk_pipeline_cache_shard *shard)
+{
+   if (!cache->externally_synchronized)
+      simple_mtx_lock(&shard->lock);
+}
+
+static inline void
+shard_unlock(struct vk_pipeline_cache *cache,
+             struct vk_pipeline_cache_shard *shard)
+{
+   if (!cache->externally_synchronized)
+      simple_mtx_unlock(&shard->lock);
+}
+
+/* Inserts a copy of data unless the key is already present, and returns the
+ * entry that ends up in the cache.  *added tells whether it is the new one.
+ */
+static struct vk_pipeline_cache_entry *
+cache_insert(struct vk_pipeline_cache *cache, const uint8_t key[20],
+             const void *data, size_t size, bool *added)
+{
+   struct vk_pipeline_cache_shard *shard = cache_shard(cache, key);
+
+   *added = false;
+   if (size > UINT32_MAX)
+      return NULL;
+
+   struct vk_pipeline_cache_entry *entry =
+      vk_alloc(&cache->alloc, sizeof(*entry) + size, 8,
+               VK_SYSTEM_ALLOCATION_SCOPE_CACHE);
+   if (entry == NULL)
+      return NULL;
+
+   memcpy(entry->key, key, sizeof(entry->key));
+   entry->size = size;
+   memcpy(entry->data, data, size);
+
+   shard_lock(cache, shard);
+
+   struct hash_entry *he = _mesa_hash_table_search(shard->entries, key);
+   if (he) {
+      shard_unlock(cache, shard);
+      vk_free(&cache->alloc, entry);
+      return he->data;
+   }
+
+   _mesa_hash_table_insert(shard->entries, entry->key, entry);
+
+   shard_unlock(cache, shard);
+
+   *added = true;
+   return entry;
+}
+
+static void
+cache_load(struct vk_pipeline_cache *cache, const void *data, size_t size)
+{
+   struct blob_reader blob;
+   blob_reader_init(&blob, data, size);
+
+   struct vk_pipeline_cache_header header;
+   blob_copy_bytes(&blob, &header, sizeof(header));
+   uint32_t count = blob_read_uint32(&blob);
+   if (blob.overrun)
+      return;
+
+   if (header.header_size < sizeof(header))
+      return;
+   if (header.header_version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+      return;
+   if (header.vendor_id != cache->vendor_id)
+      return;
+   if (header.device_id != cache->device_id)
+      return;
+   if (memcmp(header.uuid, cache->uuid, VK_UUID_SIZE) != 0)
+      return;
+
+   for (uint32_t i = 0; i < count; i++) {
+      const uint8_t *key = blob_read_bytes(&blob, 20);
+      uint32_t entry_size = blob_read_uint32(&blob);
+      const void *entry_data = blob_read_bytes(&blob, entry_size);
+      if (blob.overrun)
+         break;
+
+      bool added;
+      if (!cache_insert(cache, key, entry_data, entry_size, &added))
+         break;
+   }
+}
+
+struct vk_pipeline_cache *
+vk_pipeline_cache_create(struct vk_device *device,
+                         const struct vk_pipeline_cache_create_info *info,
+                         const VkAllocationCallbacks *pAllocator)
+{
+   const VkPipelineCacheCreateInfo *pCreateInfo = info->pCreateInfo;
+   struct vk_pipeline_cache *cache;
+
+   assert(pCreateInfo->sType == VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO);
+
+   cache = vk_object_zalloc(device, pAllocator, sizeof(*cache),
+                            VK_OBJECT_TYPE_PIPELINE_CACHE);
+   if (cache == NULL)
+      return NULL;
+
+   cache->alloc = pAllocator ? *pAllocator : device->alloc;
+   cache->vendor_id = info->vendor_id;
+   cache->device_id = info->device_id;
+   memcpy(cache->uuid, info->uuid, VK_UUID_SIZE);
+   cache->disk_cache = info->disk_cache;
+   cache->externally_synchronized =
+      pCreateInfo->flags &
+      VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT_EXT;
+
+   for (unsigned i = 0; i < VK_PIPELINE_CACHE_NUM_SHARDS; i++) {
+      struct vk_pipeline_cache_shard *shard = &cache->shards[i];
+
+      simple_mtx_init(&shard->lock, mtx_plain);
+      shard->entries = _mesa_hash_table_create(NULL, entry_key_hash,
+                                               entry_key_equal);
+      if (shard->entries == NULL) {
+         vk_pipeline_cache_destroy(cache, pAllocator);
+         return NULL;
+      }
+   }
+
+   if (pCreateInfo->initialDataSize > 0)
+      cache_load(cache, pCreateInfo->pInitialData,
+                 pCreateInfo->initialDataSize);
+
+   return cache;
+}
+
+void
+vk_pipeline_cache_destroy(struct vk_pipeline_cache *cache,
+                          const VkAllocationCallbacks *pAllocator)
+{
+   for (unsigned i = 0; i < VK_PIPELINE_CACHE_NUM_SHARDS; i++) {
+      struct vk_pipeline_cache_shard *shard = &cache->shards[i];
+
+      if (shard->entries) {
+         hash_table_foreach(shard->entries, he)
+            vk_free(&cache->alloc, he->data);
+         _mesa_hash_table_destroy(shard->entries, NULL);
+      }
+      simple_mtx_destroy(&shard->lock);
+   }
+
+   vk_object_free(cache->base.device, pAllocator, cache);
+}
+
+/**
+ * Look up a blob by key.  Misses fall through to the disk cache, if any,
+ * and disk hits are kept in memory for later lookups.  Returns NULL if the
+ * key isn't found.
+ */
+const void *
+vk_pipeline_cache_lookup(struct vk_pipeline_cache *cache,
+                         const uint8_t key[20], size_t *size_out)
+{
+   struct vk_pipeline_cache_shard *shard = cache_shard(cache, key);
+
+   shard_lock(cache, shard);
+   struct hash_entry *he = _mesa_hash_table_search(shard->entries, key);
+   shard_unlock(cache, shard);
+
+   if (he) {
+      struct vk_pipeline_cache_entry *entry = he->data;
+      *size_out = entry->size;
+      return entry->data;
+   }
+
+   if (cache->disk_cache == NULL)
+      return NULL;
+
+   cache_key disk_key;
+   disk_cache_compute_key(cache->disk_cache, key, 20, disk_key);
+
+   size_t size;
+   void *data = disk_cache_get(cache->disk_cache, disk_key, &size);
+   if (data == NULL)
+      return NULL;
+
+   bool added;
+   struct vk_pipeline_cache_entry *entry =
+      cache_insert(cache, key, data, size, &added);
+   free(data);
+   if (entry == NULL)
+      return NULL;
+
+   *size_out = entry->size;
+   return entry->data;
+}
+
+/**
+ * Add a copy of data under key and write it through to the disk cache.  If
+ * another thread added the same key first, its entry is kept and returned.
+ */
+const void *
+vk_pipeline_cache_add(struct vk_pipeline_cache *cache,
+                      const uint8_t key[20], const void *data, size_t size)
+{
+   bool added;
+   struct vk_pipeline_cache_entry *entry =
+      cache_insert(cache, key, data, size, &added);
+   if (entry == NULL)
+      return NULL;
+
+   if (added && cache->disk_cache) {
+      cache_key disk_key;
+      disk_cache_compute_key(cache->disk_cache, key, 20, disk_key);
+      disk_cache_put(cache->disk_cache, disk_key, data, size, NULL);
+   }
+
+   return entry->data;
+}
+
+struct nir_shader *
+vk_pipeline_cache_lookup_nir(struct vk_pipeline_cache *cache,
+                             const uint8_t key[20],
+                             const struct nir_shader_compiler_options *options,
+                             void *mem_ctx)
+{
+   size_t size;
+   const void *data = vk_pipeline_cache_lookup(cache, key, &size);
+   if (data == NULL)
+      return NULL;
+
+   struct blob_reader blob;
+   blob_reader_init(&blob, data, size);
+
+   nir_shader *nir = nir_deserialize(mem_ctx, options, &blob);
+   if (blob.overrun) {
+      ralloc_free(nir);
+      return NULL;
+   }
+
+   return nir;
+}
+
+void
+vk_pipeline_cache_add_nir(struct vk_pipeline_cache *cache,
+                          const uint8_t key[20],
+                          const struct nir_shader *nir)
+{
+   struct blob blob;
+   blob_init(&blob);
+
+   nir_serialize(&blob, nir, false);
+   if (!blob.out_of_memory)
+      vk_pipeline_cache_add(cache, key, blob.data, blob.size);
+
+   blob_finish(&blob);
+}
+
+VkResult
+vk_pipeline_cache_get_data(struct vk_pipeline_cache *cache,
+                           size_t *pDataSize, void *pData)
+{
+   struct blob blob;
+   if (pData) {
+      blob_init_fixed(&blob, pData, *pDataSize);
+   } else {
+      blob_init_fixed(&blob, NULL, SIZE_MAX);
+   }
+
+   struct vk_pipeline_cache_header header = {
+      .header_size = sizeof(struct vk_pipeline_cache_header),
+      .header_version = VK_PIPELINE_CACHE_HEADER_VERSION_ONE,
+      .vendor_id = cache->vendor_id,
+      .device_id = cache->device_id,
+   };
+   memcpy(header.uuid, cache->uuid, VK_UUID_SIZE);
+   blob_write_bytes(&blob, &header, sizeof(header));
+
+   uint32_t count = 0;
+   intptr_t count_offset = blob_reserve_uint32(&blob);
+   if (count_offset < 0) {
+      *pDataSize = 0;
+      blob_finish(&blob);
+      return VK_INCOMPLETE;
+   }
+
+   VkResult result = VK_SUCCESS;
+   for (unsigned i = 0; i < VK_PIPELINE_CACHE_NUM_SHARDS; i++) {
+      struct vk_pipeline_cache_shard *shard = &cache->shards[i];
+
+      shard_lock(cache, shard);
+      hash_table_foreach(shard->entries, he) {
+         struct vk_pipeline_cache_entry *entry = he->data;
+
+         size_t save_size = blob.size;
+         blob_write_bytes(&blob, entry->key, sizeof(entry->key));
+         blob_write_uint32(&blob, entry->size);
+         if (!blob_write_bytes(&blob, entry->data, entry->size)) {
+            /* If it fails reset to the previous size and bail */
+            blob.size = save_size;
+            result = VK_INCOMPLETE;
+            break;
+         }
+
+         count++;
+      }
+      shard_unlock(cache, shard);
+
+      if (result != VK_SUCCESS)
+         break;
+   }
+
+   blob_overwrite_uint32(&blob, count_offset, count);
+
+   *pDataSize = blob.size;
+
+   blob_finish(&blob);
+
+   return result;
+}
+
+VkResult
+vk_pipeline_cache_merge(struct vk_pipeline_cache *dst,
+                        uint32_t src_count,
+                        struct vk_pipeline_cache *const *srcs)
+{
+   struct util_dynarray entries;
+   util_dynarray_init(&entries, NULL);
+
+   for (uint32_t s = 0; s < src_count; s++) {
+      struct vk_pipeline_cache *src = srcs[s];
+      if (src == dst)
+         continue;
+
+      for (unsigned i = 0; i < VK_PIPELINE_CACHE_NUM_SHARDS; i++) {
+         struct vk_pipeline_cache_shard *shard = &src->shards[i];
+
+         /* Entries are immutable and outlive the merge, so collect them
+          * first and insert without holding two shard locks at once.
+          */
+         util_dynarray_clear(&entries);
+         shard_lock(src, shard);
+         hash_table_foreach(shard->entries, he)
+            util_dynarray_append(&entries, struct vk_pipeline_cache_entry *,
+                                 he->data);
+         shard_unlock(src, shard);
+
+         util_dynarray_foreach(&entries, struct vk_pipeline_cache_entry *,
+                               entry) {
+            bool added;
+            if (!cache_insert(dst, (*entry)->key, (*entry)->data,
+                              (*entry)->size, &added)) {
+               util_dynarray_fini(&entries);
+               return VK_ERROR_OUT_OF_HOST_MEMORY;
+            }
+         }
+      }
+   }
+
+   util_dynarray_fini(&entries);
+
+   return VK_SUCCESS;
+}
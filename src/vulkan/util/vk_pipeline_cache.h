@@ -0,0 +1,127 @@
+/*
+ * Copyright © 2021 Intel Corporation
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+#ifndef VK_PIPELINE_CACHE_H
+#define VK_PIPELINE_CACHE_H
+
+#include "vk_object.h"
+
+#include "util/simple_mtx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct disk_cache;
+struct hash_table;
+struct nir_shader;
+struct nir_shader_compiler_options;
+
+/* Entries are spread over the shards by the first byte of their SHA1 key so
+ * that pipeline compiles on several threads rarely contend on a lock.
+ */
+#define VK_PIPELINE_CACHE_NUM_SHARDS 16
+
+struct vk_pipeline_cache_shard {
+   simple_mtx_t lock;
+   struct hash_table *entries;
+};
+
+/* Common VkPipelineCache implementation storing opaque driver blobs keyed
+ * by 20-byte SHA1 keys.  Entries are immutable once added and live until
+ * the cache is destroyed, so pointers returned by lookups stay valid for
+ * the cache lifetime.
+ */
+struct vk_pipeline_cache {
+   struct vk_object_base base;
+
+   VkAllocationCallbacks alloc;
+
+   /* Used to validate and write the VkPipelineCacheHeaderVersionOne. */
+   uint32_t vendor_id;
+   uint32_t device_id;
+   uint8_t uuid[VK_UUID_SIZE];
+
+   /* Optional on-disk backing store, owned by the driver. */
+   struct disk_cache *disk_cache;
+
+   /* VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT_EXT */
+   bool externally_synchronized;
+
+   struct vk_pipeline_cache_shard shards[VK_PIPELINE_CACHE_NUM_SHARDS];
+};
+
+VK_DEFINE_NONDISP_HANDLE_CASTS(vk_pipeline_cache, base, VkPipelineCache,
+                               VK_OBJECT_TYPE_PIPELINE_CACHE)
+
+struct vk_pipeline_cache_create_info {
+   const VkPipelineCacheCreateInfo *pCreateInfo;
+
+   uint32_t vendor_id;
+   uint32_t device_id;
+   const uint8_t *uuid;
+
+   struct disk_cache *disk_cache;
+};
+
+struct vk_pipeline_cache *
+vk_pipeline_cache_create(struct vk_device *device,
+                         const struct vk_pipeline_cache_create_info *info,
+                         const VkAllocationCallbacks *pAllocator);
+
+void
+vk_pipeline_cache_destroy(struct vk_pipeline_cache *cache,
+                          const VkAllocationCallbacks *pAllocator);
+
+const void *
+vk_pipeline_cache_lookup(struct vk_pipeline_cache *cache,
+                         const uint8_t key[20], size_t *size_out);
+
+const void *
+vk_pipeline_cache_add(struct vk_pipeline_cache *cache,
+                      const uint8_t key[20], const void *data, size_t size);
+
+struct nir_shader *
+vk_pipeline_cache_lookup_nir(struct vk_pipeline_cache *cache,
+                             const uint8_t key[20],
+                             const struct nir_shader_compiler_options *options,
+                             void *mem_ctx);
+
+void
+vk_pipeline_cache_add_nir(struct vk_pipeline_cache *cache,
+                          const uint8_t key[20],
+                          const struct nir_shader *nir);
+
+VkResult
+vk_pipeline_cache_get_data(struct vk_pipeline_cache *cache,
+                           size_t *pDataSize, void *pData);
+
+VkResult
+vk_pipeline_cache_merge(struct vk_pipeline_cache *dst,
+                        uint32_t src_count,
+                        struct vk_pipeline_cache *const *srcs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VK_PIPELINE_CACHE_H */
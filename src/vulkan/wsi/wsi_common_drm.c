@@ -62,15 +62,24 @@ wsi_device_matches_drm_fd(const struct wsi_device *wsi, int drm_fd)
 
 static uint32_t
 select_memory_type(const struct wsi_device *wsi,
-                   VkMemoryPropertyFlags props,
+                   VkMemoryPropertyFlags req_props,
+                   VkMemoryPropertyFlags deny_props,
                    uint32_t type_bits)
 {
    for (uint32_t i = 0; i < wsi->memory_props.memoryTypeCount; i++) {
        const VkMemoryType type = wsi->memory_props.memoryTypes[i];
-       if ((type_bits & (1 << i)) && (type.propertyFlags & props) == props)
+       if ((type_bits & (1 << i)) &&
+           (type.propertyFlags & req_props) == req_props &&
+           (type.propertyFlags & deny_props) == 0)
          return i;
    }
 
+   /* Denied properties are only a preference, e.g. integrated GPUs may have
+    * nothing but DEVICE_LOCAL memory.
+    */
+   if (deny_props)
+      return select_memory_type(wsi, req_props, 0, type_bits);
+
    unreachable("No memory type found");
 }
 
@@ -304,7 +313,7 @@ wsi_create_native_image(const struct wsi_swapchain *chain,
       .pNext = &memory_dedicated_info,
       .allocationSize = reqs.size,
       .memoryTypeIndex = select_memory_type(wsi, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                            reqs.memoryTypeBits),
+                                            0, reqs.memoryTypeBits),
    };
    result = wsi->AllocateMemory(chain->device, &memory_info,
                                 &chain->alloc, &image->memory);
@@ -475,7 +484,12 @@ wsi_create_prime_image(const struct wsi_swapchain *chain,
       .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
       .pNext = &prime_memory_dedicated_info,
       .allocationSize = linear_size,
-      .memoryTypeIndex = select_memory_type(wsi, 0, reqs.memoryTypeBits),
+      /* The display GPU scans out of this buffer, so keep it out of the
+       * render GPU's VRAM to avoid a migration when the buffer is imported.
+       */
+      .memoryTypeIndex = select_memory_type(wsi, 0,
+                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                            reqs.memoryTypeBits),
    };
    result = wsi->AllocateMemory(chain->device, &prime_memory_info,
                                 &chain->alloc, &image->prime.memory);
@@ -526,7 +540,7 @@ wsi_create_prime_image(const struct wsi_swapchain *chain,
       .pNext = &memory_dedicated_info,
       .allocationSize = reqs.size,
       .memoryTypeIndex = select_memory_type(wsi, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                                            reqs.memoryTypeBits),
+                                            0, reqs.memoryTypeBits),
    };
    result = wsi->AllocateMemory(chain->device, &memory_info,
                                 &chain->alloc, &image->memory);
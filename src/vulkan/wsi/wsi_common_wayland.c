@@ -44,6 +44,9 @@
 #include <util/timespec.h>
 #include <util/u_vector.h>
 
+/* Longest time a FIFO present waits for the previous frame callback. */
+#define WSI_WL_FIFO_MAX_WAIT_MS 100
+
 struct wsi_wayland;
 
 struct wsi_wl_display_drm {
@@ -761,47 +764,32 @@ wsi_wl_swapchain_get_wsi_image(struct wsi_swapchain *wsi_chain,
    return &chain->images[image_index].base;
 }
 
+/* Dispatches events on the display queue, reading from the server if nothing
+ * is pending yet. Returns VK_TIMEOUT if no event arrived before end_time.
+ */
 static VkResult
-wsi_wl_swapchain_acquire_next_image(struct wsi_swapchain *wsi_chain,
-                                    const VkAcquireNextImageInfoKHR *info,
-                                    uint32_t *image_index)
+wsi_wl_display_dispatch_queue_with_timeout(struct wsi_wl_display *display,
+                                           const struct timespec *end_time)
 {
-   struct wsi_wl_swapchain *chain = (struct wsi_wl_swapchain *)wsi_chain;
-   struct timespec start_time, end_time;
-   struct timespec rel_timeout;
-   int wl_fd = wl_display_get_fd(chain->display->wl_display);
-
-   timespec_from_nsec(&rel_timeout, info->timeout);
-
-   clock_gettime(CLOCK_MONOTONIC, &start_time);
-   timespec_add(&end_time, &rel_timeout, &start_time);
+   int wl_fd = wl_display_get_fd(display->wl_display);
 
    while (1) {
       /* Try to dispatch potential events. */
-      int ret = wl_display_dispatch_queue_pending(chain->display->wl_display,
-                                                  chain->display->queue);
+      int ret = wl_display_dispatch_queue_pending(display->wl_display,
+                                                  display->queue);
       if (ret < 0)
          return VK_ERROR_OUT_OF_DATE_KHR;
-
-      /* Try to find a free image. */
-      for (uint32_t i = 0; i < chain->base.image_count; i++) {
-         if (!chain->images[i].busy) {
-            /* We found a non-busy image */
-            *image_index = i;
-            chain->images[i].busy = true;
-            return VK_SUCCESS;
-         }
-      }
+      if (ret > 0)
+         return VK_SUCCESS;
 
       /* Check for timeout. */
       struct timespec current_time;
       clock_gettime(CLOCK_MONOTONIC, &current_time);
-      if (timespec_after(&current_time, &end_time))
-         return VK_NOT_READY;
+      if (timespec_after(&current_time, end_time))
+         return VK_TIMEOUT;
 
       /* Try to read events from the server. */
-      ret = wl_display_prepare_read_queue(chain->display->wl_display,
-                                          chain->display->queue);
+      ret = wl_display_prepare_read_queue(display->wl_display, display->queue);
       if (ret < 0) {
          /* Another thread might have read events for our queue already. Go
           * back to dispatch them.
@@ -815,11 +803,12 @@ wsi_wl_swapchain_acquire_next_image(struct wsi_swapchain *wsi_chain,
          .fd = wl_fd,
          .events = POLLIN
       };
-      timespec_sub(&rel_timeout, &end_time, &current_time);
+      struct timespec rel_timeout;
+      timespec_sub(&rel_timeout, end_time, &current_time);
       ret = ppoll(&pollfd, 1, &rel_timeout, NULL);
       if (ret <= 0) {
          int lerrno = errno;
-         wl_display_cancel_read(chain->display->wl_display);
+         wl_display_cancel_read(display->wl_display);
          if (ret < 0) {
             /* If ppoll() was interrupted, try again. */
             if (lerrno == EINTR || lerrno == EAGAIN)
@@ -830,12 +819,52 @@ wsi_wl_swapchain_acquire_next_image(struct wsi_swapchain *wsi_chain,
          continue;
       }
 
-      ret = wl_display_read_events(chain->display->wl_display);
+      ret = wl_display_read_events(display->wl_display);
       if (ret < 0)
          return VK_ERROR_OUT_OF_DATE_KHR;
    }
 }
 
+static VkResult
+wsi_wl_swapchain_acquire_next_image(struct wsi_swapchain *wsi_chain,
+                                    const VkAcquireNextImageInfoKHR *info,
+                                    uint32_t *image_index)
+{
+   struct wsi_wl_swapchain *chain = (struct wsi_wl_swapchain *)wsi_chain;
+   struct timespec start_time, end_time;
+   struct timespec rel_timeout;
+
+   timespec_from_nsec(&rel_timeout, info->timeout);
+
+   clock_gettime(CLOCK_MONOTONIC, &start_time);
+   timespec_add(&end_time, &rel_timeout, &start_time);
+
+   while (1) {
+      /* Try to dispatch potential events. */
+      int ret = wl_display_dispatch_queue_pending(chain->display->wl_display,
+                                                  chain->display->queue);
+      if (ret < 0)
+         return VK_ERROR_OUT_OF_DATE_KHR;
+
+      /* Try to find a free image. */
+      for (uint32_t i = 0; i < chain->base.image_count; i++) {
+         if (!chain->images[i].busy) {
+            /* We found a non-busy image */
+            *image_index = i;
+            chain->images[i].busy = true;
+            return VK_SUCCESS;
+         }
+      }
+
+      VkResult result =
+         wsi_wl_display_dispatch_queue_with_timeout(chain->display, &end_time);
+      if (result == VK_TIMEOUT)
+         return VK_NOT_READY;
+      if (result != VK_SUCCESS)
+         return result;
+   }
+}
+
 static void
 frame_handle_done(void *data, struct wl_callback *callback, uint32_t serial)
 {
@@ -859,11 +888,25 @@ wsi_wl_swapchain_queue_present(struct wsi_swapchain *wsi_chain,
    struct wsi_wl_swapchain *chain = (struct wsi_wl_swapchain *)wsi_chain;
 
    if (chain->base.present_mode == VK_PRESENT_MODE_FIFO_KHR) {
+      struct timespec end_time;
+      clock_gettime(CLOCK_MONOTONIC, &end_time);
+      timespec_add_msec(&end_time, &end_time, WSI_WL_FIFO_MAX_WAIT_MS);
+
       while (!chain->fifo_ready) {
-         int ret = wl_display_dispatch_queue(chain->display->wl_display,
-                                             chain->display->queue);
-         if (ret < 0)
-            return VK_ERROR_OUT_OF_DATE_KHR;
+         VkResult result =
+            wsi_wl_display_dispatch_queue_with_timeout(chain->display,
+                                                       &end_time);
+         if (result == VK_TIMEOUT) {
+            /* Compositors stop sending frame callbacks for hidden surfaces.
+             * Don't block the application forever in that case, just drop
+             * the stale callback and keep presenting at a low rate.
+             */
+            wl_callback_destroy(chain->frame);
+            chain->frame = NULL;
+            chain->fifo_ready = true;
+         } else if (result != VK_SUCCESS) {
+            return result;
+         }
       }
    }
 